@@ -471,6 +471,8 @@ public:
 
         WA_AlwaysStackOnTop = 128,
 
+        WA_ConcurrentPaintEvent = 129,
+
         // Add new attributes before this line
         WA_AttributeCount
     };
@@ -35,6 +35,11 @@
 #include <qbuffer.h>
 #include <qdebug.h>
 #include <qfile.h>
+#include <qplatformdefs.h>
+
+#ifdef Q_OS_UNIX
+#include "private/qcore_unix_p.h"
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -399,6 +404,82 @@ qint64 QNonContiguousByteDeviceIoDeviceImpl::pos()
     return device->pos();
 }
 
+// How much is read ahead of the consumer at a time
+static const qint64 fileReadBufferSize = 256 * 1024;
+
+QNonContiguousByteDeviceFileImpl::QNonContiguousByteDeviceFileImpl(int fd, qint64 offset, qint64 size)
+    : QNonContiguousByteDevice(), fd(fd), bufferPosition(0), initialPosition(offset),
+      totalSize(size), currentPosition(0)
+{
+}
+
+QNonContiguousByteDeviceFileImpl::~QNonContiguousByteDeviceFileImpl()
+{
+#ifdef Q_OS_UNIX
+    qt_safe_close(fd);
+#endif
+}
+
+const char* QNonContiguousByteDeviceFileImpl::readPointer(qint64 maximumLength, qint64 &len)
+{
+    if (atEnd()) {
+        len = -1;
+        return 0;
+    }
+
+    if (currentPosition < bufferPosition || currentPosition >= bufferPosition + buffer.size()) {
+        // pread() leaves the offset that the descriptor shares with the QFile alone
+        const qint64 readSize = qMin(fileReadBufferSize, totalSize - currentPosition);
+        buffer.resize(int(readSize));
+        qint64 readBytes = -1;
+#ifdef Q_OS_UNIX
+        EINTR_LOOP(readBytes, ::pread(fd, buffer.data(), size_t(readSize),
+                                      QT_OFF_T(initialPosition + currentPosition)));
+#endif
+        if (readBytes <= 0) {
+            // the file shrank or cannot be read any more
+            buffer.clear();
+            len = -1;
+            return 0;
+        }
+        buffer.resize(int(readBytes));
+        bufferPosition = currentPosition;
+    }
+
+    len = bufferPosition + buffer.size() - currentPosition;
+    if (maximumLength != -1)
+        len = qMin(maximumLength, len);
+    return buffer.constData() + (currentPosition - bufferPosition);
+}
+
+bool QNonContiguousByteDeviceFileImpl::advanceReadPointer(qint64 amount)
+{
+    currentPosition += amount;
+    emit readProgress(currentPosition, totalSize);
+    return true;
+}
+
+bool QNonContiguousByteDeviceFileImpl::atEnd()
+{
+    return currentPosition >= totalSize;
+}
+
+bool QNonContiguousByteDeviceFileImpl::reset()
+{
+    currentPosition = 0;
+    return true;
+}
+
+qint64 QNonContiguousByteDeviceFileImpl::size()
+{
+    return totalSize;
+}
+
+qint64 QNonContiguousByteDeviceFileImpl::pos()
+{
+    return currentPosition;
+}
+
 QByteDeviceWrappingIoDevice::QByteDeviceWrappingIoDevice(QNonContiguousByteDevice *bd) : QIODevice((QObject*)0)
 {
     byteDevice = bd;
@@ -468,6 +549,43 @@ qint64 QByteDeviceWrappingIoDevice::writeData( const char* data, qint64 maxSize)
     \internal
 */
 
+/*
+    Returns a device reading the file behind \a device through a descriptor
+    of its own, or 0 if \a device is not a regular file with a descriptor,
+    opened for reading in binary mode, with at least
+    QNonContiguousByteDeviceFileImpl::minimumFileSize bytes left.
+*/
+static QNonContiguousByteDevice *createFileDevice(QIODevice *device)
+{
+#ifdef Q_OS_UNIX
+    QFile *file = qobject_cast<QFile *>(device);
+    if (!file || !file->isReadable() || file->isSequential() || file->isTextModeEnabled())
+        return 0;
+
+    // resources and files of custom engines have no descriptor to read from
+    const int handle = file->handle();
+    if (handle == -1)
+        return 0;
+    const qint64 offset = file->pos();
+    const qint64 size = file->size() - offset;
+    if (size < QNonContiguousByteDeviceFileImpl::minimumFileSize)
+        return 0;
+    QT_STATBUF statBuffer;
+    if (QT_FSTAT(handle, &statBuffer) != 0 || !S_ISREG(statBuffer.st_mode))
+        return 0;
+
+    // a duplicate of the open descriptor, rather than the file opened again
+    // by name, is certain to refer to the same file
+    const int fd = qt_safe_dup(handle);
+    if (fd == -1)
+        return 0;
+    return new QNonContiguousByteDeviceFileImpl(fd, offset, size);
+#else
+    Q_UNUSED(device);
+    return 0;
+#endif
+}
+
 /*!
     \fn static QNonContiguousByteDevice* QNonContiguousByteDeviceFactory::create(QIODevice *device)
 
@@ -483,8 +601,9 @@ QNonContiguousByteDevice* QNonContiguousByteDeviceFactory::create(QIODevice *dev
         return new QNonContiguousByteDeviceBufferImpl(buffer);
     }
 
-    // ### FIXME special case if device is a QFile that supports map()
-    // then we can actually deal with the file without using read/peek
+    // shortcut if it is a regular QFile
+    if (QNonContiguousByteDevice *fileDevice = createFileDevice(device))
+        return fileDevice;
 
     // generic QIODevice
     return new QNonContiguousByteDeviceIoDeviceImpl(device); // FIXME
@@ -502,8 +621,10 @@ QSharedPointer<QNonContiguousByteDevice> QNonContiguousByteDeviceFactory::create
     if (QBuffer *buffer = qobject_cast<QBuffer*>(device))
         return QSharedPointer<QNonContiguousByteDeviceBufferImpl>::create(buffer);
 
-    // ### FIXME special case if device is a QFile that supports map()
-    // then we can actually deal with the file without using read/peek
+    // shortcut if it is a regular QFile; deleted with
+    // deleteLater() as it may have been moved to the thread consuming it
+    if (QNonContiguousByteDevice *fileDevice = createFileDevice(device))
+        return QSharedPointer<QNonContiguousByteDevice>(fileDevice, &QObject::deleteLater);
 
     // generic QIODevice
     return QSharedPointer<QNonContiguousByteDeviceIoDeviceImpl>::create(device); // FIXME
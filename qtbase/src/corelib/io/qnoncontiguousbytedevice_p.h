@@ -150,6 +150,38 @@ protected:
     qint64 initialPosition;
 };
 
+// Serves a QFile by pread() on a duplicate of its descriptor, which leaves
+// the offset of the QFile alone. The device does not touch the QFile it was
+// created for after construction, and may be used from a thread other than
+// the one the file lives in. Only created on Unix.
+class Q_CORE_EXPORT QNonContiguousByteDeviceFileImpl : public QNonContiguousByteDevice
+{
+    Q_OBJECT
+public:
+    // takes ownership of fd
+    QNonContiguousByteDeviceFileImpl(int fd, qint64 offset, qint64 size);
+    ~QNonContiguousByteDeviceFileImpl();
+    const char* readPointer(qint64 maximumLength, qint64 &len) Q_DECL_OVERRIDE;
+    bool advanceReadPointer(qint64 amount) Q_DECL_OVERRIDE;
+    bool atEnd() Q_DECL_OVERRIDE;
+    bool reset() Q_DECL_OVERRIDE;
+    qint64 size() Q_DECL_OVERRIDE;
+    qint64 pos() Q_DECL_OVERRIDE;
+
+    // for consumers that can transfer straight from the file, e.g. sendfile()
+    int handle() const { return fd; }
+    qint64 fileOffset() const { return initialPosition + currentPosition; }
+
+    static const qint64 minimumFileSize = 64 * 1024;
+protected:
+    int fd;
+    QByteArray buffer;
+    qint64 bufferPosition;
+    qint64 initialPosition;
+    qint64 totalSize;
+    qint64 currentPosition;
+};
+
 class QNonContiguousByteDeviceBufferImpl : public QNonContiguousByteDevice
 {
     Q_OBJECT
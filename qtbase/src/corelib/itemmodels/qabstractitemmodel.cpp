@@ -43,6 +43,7 @@
 #include <qbitarray.h>
 
 #include <limits.h>
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -58,6 +59,7 @@ QPersistentModelIndexData *QPersistentModelIndexData::create(const QModelIndex &
     } else {
         d = new QPersistentModelIndexData(index);
         indexes.insert(index, d);
+        model->d_func()->addToPersistentLevel(d);
     }
     Q_ASSERT(d);
     return d;
@@ -482,6 +484,7 @@ Q_GLOBAL_STATIC(QEmptyItemModel, qEmptyModel)
 
 QAbstractItemModelPrivate::~QAbstractItemModelPrivate()
 {
+    qDeleteAll(persistent.levels);
 }
 
 QAbstractItemModel *QAbstractItemModelPrivate::staticEmptyModel()
@@ -489,6 +492,26 @@ QAbstractItemModel *QAbstractItemModelPrivate::staticEmptyModel()
     return qEmptyModel();
 }
 
+/*!
+    \internal
+
+    Fetches the data of the item at \a index for the \a count roles in
+    \a roles at once, storing the value for \c{roles[i]} in \c{values[i]}.
+
+    Views and delegates call this when they need several roles of the same
+    item, for instance to paint it. The default implementation calls data()
+    once for each role. Private classes of models where finding the item is
+    expensive can reimplement it, as long as the values are the same as the
+    ones returned by data(), including for subclasses that reimplement data().
+*/
+void QAbstractItemModelPrivate::multiData(const QModelIndex &index, const int *roles,
+                                          QVariant *values, int count) const
+{
+    Q_Q(const QAbstractItemModel);
+    for (int i = 0; i < count; ++i)
+        values[i] = q->data(index, roles[i]);
+}
+
 namespace {
     struct DefaultRoleNames : public QHash<int, QByteArray>
     {
@@ -554,8 +577,357 @@ bool QAbstractItemModelPrivate::variantLessThan(const QVariant &v1, const QVaria
     }
 }
 
+static inline bool qt_persistentEntryLessThan(const QPersistentModelIndexLevel::Entry &e1,
+                                              const QPersistentModelIndexLevel::Entry &e2)
+{
+    return e1.row < e2.row || (e1.row == e2.row && e1.column < e2.column);
+}
+
+static inline bool qt_persistentEntryErased(const QPersistentModelIndexLevel::Entry &entry)
+{
+    return !entry.data && !entry.child;
+}
+
+void QPersistentModelIndexLevel::insert(int row, int column, QPersistentModelIndexData *data,
+                                        QPersistentModelIndexLevel *child)
+{
+    const Entry entry = { row, column, data, child };
+    if (sorted && !entries.isEmpty() && qt_persistentEntryLessThan(entry, entries.last()))
+        sorted = false;
+    entries.append(entry);
+    ++live;
+    if (data)
+        data->level = this;
+}
+
+void QPersistentModelIndexLevel::erase(int row, int column, QPersistentModelIndexData *data,
+                                       QPersistentModelIndexLevel *child)
+{
+    int i = lowerBound(row, column);
+    const int count = entries.count();
+    for (; i < count; ++i) {
+        const Entry &entry = entries.at(i);
+        if (entry.row != row || entry.column != column)
+            break;
+        if (entry.data == data && entry.child == child) {
+            eraseAt(i);
+            return;
+        }
+    }
+    // the key was out of date, look for the entry itself
+    for (i = 0; i < count; ++i) {
+        const Entry &entry = entries.at(i);
+        if (entry.data == data && entry.child == child) {
+            eraseAt(i);
+            return;
+        }
+    }
+}
+
+void QPersistentModelIndexLevel::sort()
+{
+    if (sorted && erased * 2 <= entries.count())
+        return;
+    if (erased) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), qt_persistentEntryErased),
+                      entries.end());
+        erased = 0;
+    }
+    if (!sorted) {
+        std::stable_sort(entries.begin(), entries.end(), qt_persistentEntryLessThan);
+        sorted = true;
+    }
+}
+
+int QPersistentModelIndexLevel::lowerBound(int row, int column)
+{
+    sort();
+    const Entry key = { row, column, 0, 0 };
+    return std::lower_bound(entries.constBegin(), entries.constEnd(), key, qt_persistentEntryLessThan)
+        - entries.constBegin();
+}
+
+// brings the key of the entry at \a i back in line with its persistent index
+static inline void qt_updatePersistentEntry(QPersistentModelIndexLevel *level, int i)
+{
+    QPersistentModelIndexLevel::Entry &entry = level->entries[i];
+    const QModelIndex &index = entry.data->index;
+    if (!index.isValid()) {
+        level->eraseAt(i);
+    } else if (index.row() != entry.row || index.column() != entry.column) {
+        entry.row = index.row();
+        entry.column = index.column();
+        level->sorted = false;
+    }
+}
+
+static void qt_collectPersistentData(const QPersistentModelIndexLevel *level,
+                                     QVector<QPersistentModelIndexData *> &result)
+{
+    for (int i = 0; i < level->entries.count(); ++i) {
+        const QPersistentModelIndexLevel::Entry &entry = level->entries.at(i);
+        if (entry.data)
+            result.append(entry.data);
+        else if (entry.child)
+            qt_collectPersistentData(entry.child, result);
+    }
+}
+
+/*!
+  \internal
+
+  Returns the level holding the persistent indexes that are children of \a parent,
+  or 0 if there are none. The levels are built on first use.
+*/
+QPersistentModelIndexLevel *QAbstractItemModelPrivate::persistentLevel(const QModelIndex &parent)
+{
+    if (persistent.indexes.isEmpty())
+        return 0;
+    if (!persistent.levelsValid) {
+        Q_Q(QAbstractItemModel);
+        if (!persistent.levelsConnected) {
+            // a layout change can move the parents without telling us where to
+            QObjectPrivate::connect(q, &QAbstractItemModel::layoutAboutToBeChanged,
+                                    this, &QAbstractItemModelPrivate::invalidatePersistentLevels);
+            QObjectPrivate::connect(q, &QAbstractItemModel::layoutChanged,
+                                    this, &QAbstractItemModelPrivate::invalidatePersistentLevels);
+            persistent.levelsConnected = true;
+        }
+        persistent.levelsValid = true;
+        for (QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it = persistent.indexes.constBegin();
+             it != persistent.indexes.constEnd(); ++it) {
+            addToPersistentLevel(*it);
+        }
+    }
+    return persistent.levels.value(parent);
+}
+
+QPersistentModelIndexLevel *QAbstractItemModelPrivate::createPersistentLevel(const QModelIndex &parent)
+{
+    QPersistentModelIndexLevel *level = persistent.levels.value(parent);
+    if (!level) {
+        QPersistentModelIndexLevel *parentLevel = parent.isValid() ? createPersistentLevel(parent.parent()) : 0;
+        level = new QPersistentModelIndexLevel(parent, parentLevel);
+        persistent.levels.insert(parent, level);
+        if (parentLevel)
+            parentLevel->insert(parent.row(), parent.column(), 0, level);
+    }
+    return level;
+}
+
+void QAbstractItemModelPrivate::addToPersistentLevel(QPersistentModelIndexData *data)
+{
+    if (!persistent.levelsValid || data->level || !data->index.isValid())
+        return;
+    const QModelIndex &index = data->index;
+    createPersistentLevel(index.parent())->insert(index.row(), index.column(), data, 0);
+}
+
+void QAbstractItemModelPrivate::removeFromPersistentLevel(QPersistentModelIndexData *data)
+{
+    if (QPersistentModelIndexLevel *level = data->level) {
+        level->erase(data->index.row(), data->index.column(), data, 0);
+        releasePersistentLevel(level);
+    }
+}
+
+/*!
+  \internal
+
+  Deletes \a level and the levels above it for as long as they are empty.
+*/
+void QAbstractItemModelPrivate::releasePersistentLevel(QPersistentModelIndexLevel *level)
+{
+    while (level && level->live == 0) {
+        QPersistentModelIndexLevel *parentLevel = level->parentLevel;
+        if (persistent.levels.value(level->parent) == level)
+            persistent.levels.remove(level->parent);
+        if (parentLevel)
+            parentLevel->erase(level->parent.row(), level->parent.column(), 0, level);
+        delete level;
+        level = parentLevel;
+    }
+}
+
+/*!
+  \internal
+
+  Deletes \a level and all the levels below it, after its entry in the parent
+  level has been erased.
+*/
+void QAbstractItemModelPrivate::destroyPersistentLevel(QPersistentModelIndexLevel *level)
+{
+    if (persistent.levels.value(level->parent) == level)
+        persistent.levels.remove(level->parent);
+    for (int i = 0; i < level->entries.count(); ++i) {
+        const QPersistentModelIndexLevel::Entry &entry = level->entries.at(i);
+        if (entry.data)
+            entry.data->level = 0;
+        else if (entry.child)
+            destroyPersistentLevel(entry.child);
+    }
+    delete level;
+}
+
+void QAbstractItemModelPrivate::invalidatePersistentLevels()
+{
+    if (!persistent.levelsValid)
+        return;
+    for (QHash<QModelIndex, QPersistentModelIndexLevel *>::const_iterator it = persistent.levels.constBegin();
+         it != persistent.levels.constEnd(); ++it) {
+        const QPersistentModelIndexLevel *level = *it;
+        for (int i = 0; i < level->entries.count(); ++i) {
+            if (QPersistentModelIndexData *data = level->entries.at(i).data)
+                data->level = 0;
+        }
+    }
+    qDeleteAll(persistent.levels);
+    persistent.levels.clear();
+    persistent.levelsValid = false;
+}
+
+/*!
+  \internal
+
+  Updates the keys of the level under \a parent after rows or columns have been
+  inserted or removed: the entries between \a first and \a last are erased,
+  together with the levels below them, and the entries after \a last are moved
+  by \a change. Only the entries from \a first on are visited for rows.
+*/
+void QAbstractItemModelPrivate::shiftPersistentLevel(const QModelIndex &parent, int first, int last, int change,
+                                                     Qt::Orientation orientation)
+{
+    if (!persistent.levelsValid)
+        return;
+    QPersistentModelIndexLevel *level = persistent.levels.value(parent);
+    if (!level)
+        return;
+    const bool vertical = (orientation == Qt::Vertical);
+    QVector<int> moved_levels;
+    for (int i = vertical ? level->lowerBound(first, 0) : 0; i < level->entries.count(); ++i) {
+        QPersistentModelIndexLevel::Entry &entry = level->entries[i];
+        int &position = vertical ? entry.row : entry.column;
+        if (position < first)
+            continue;
+        if (position <= last) {
+            // keep the erased entry ahead of the ones that are moved
+            position = first;
+            if (vertical)
+                entry.column = 0;
+            if (QPersistentModelIndexLevel *child = entry.child) {
+                level->eraseAt(i);
+                destroyPersistentLevel(child);
+            } else if (entry.data) {
+                level->eraseAt(i);
+            }
+            continue;
+        }
+        position += change;
+        if (entry.data)
+            qt_updatePersistentEntry(level, i);
+        else if (entry.child)
+            moved_levels.append(i);
+    }
+    if (!moved_levels.isEmpty() && !rekeyPersistentLevels(level, moved_levels))
+        return;
+    releasePersistentLevel(level);
+}
+
+/*!
+  \internal
+
+  Updates the parents of the child levels of \a level found at \a positions,
+  after their entries got new keys. Returns \c false if a parent could not be
+  found, in which case all the levels have been dropped.
+*/
+bool QAbstractItemModelPrivate::rekeyPersistentLevels(QPersistentModelIndexLevel *level, const QVector<int> &positions)
+{
+    Q_Q(QAbstractItemModel);
+    // a new key may still be used by one of the other levels, so take them all out first
+    for (int i = 0; i < positions.count(); ++i) {
+        const QPersistentModelIndexLevel *child = level->entries.at(positions.at(i)).child;
+        if (persistent.levels.value(child->parent) == child)
+            persistent.levels.remove(child->parent);
+    }
+    for (int i = 0; i < positions.count(); ++i) {
+        const QPersistentModelIndexLevel::Entry &entry = level->entries.at(positions.at(i));
+        const QModelIndex parent = q->index(entry.row, entry.column, level->parent);
+        if (!parent.isValid()) {
+            invalidatePersistentLevels();
+            return false;
+        }
+        entry.child->parent = parent;
+        persistent.levels.insert(parent, entry.child);
+    }
+    return true;
+}
+
+/*!
+  \internal
+
+  Updates the keys of the level under \a srcParent after the items from \a srcFirst
+  to \a srcLast have been moved in front of \a destinationChild. A move to another
+  parent can leave the keys of the parents themselves out of date, so in that case
+  the levels are dropped and built again when they are needed.
+*/
+void QAbstractItemModelPrivate::movePersistentLevels(const QModelIndex &srcParent, int srcFirst, int srcLast,
+                                                     const QModelIndex &destinationParent, int destinationChild,
+                                                     Qt::Orientation orientation)
+{
+    if (!persistent.levelsValid)
+        return;
+    if (srcParent != destinationParent) {
+        invalidatePersistentLevels();
+        return;
+    }
+    QPersistentModelIndexLevel *level = persistent.levels.value(srcParent);
+    if (!level)
+        return;
+
+    const bool vertical = (orientation == Qt::Vertical);
+    const bool movingUp = (srcFirst > destinationChild);
+    const int count = srcLast - srcFirst + 1;
+    const int explicit_change = movingUp ? destinationChild - srcFirst : destinationChild - srcLast - 1;
+    const int lowest = movingUp ? destinationChild : srcFirst;
+    const int highest = movingUp ? srcLast : destinationChild - 1;
+
+    int begin = 0;
+    int end = level->entries.count();
+    if (vertical) {
+        // the rows in the range keep their order once the two blocks are swapped
+        level->sort();
+        begin = level->lowerBound(lowest, 0);
+        const int middle = level->lowerBound(movingUp ? srcFirst : srcLast + 1, 0);
+        end = level->lowerBound(highest + 1, 0);
+        std::rotate(level->entries.begin() + begin, level->entries.begin() + middle,
+                    level->entries.begin() + end);
+    } else {
+        level->sorted = false;
+    }
+
+    QVector<int> moved_levels;
+    for (int i = begin; i < end; ++i) {
+        QPersistentModelIndexLevel::Entry &entry = level->entries[i];
+        int &position = vertical ? entry.row : entry.column;
+        if (position < lowest || position > highest)
+            continue;
+        if (position >= srcFirst && position <= srcLast)
+            position += explicit_change;
+        else
+            position += movingUp ? count : -count;
+        if (entry.data)
+            qt_updatePersistentEntry(level, i);
+        else if (entry.child)
+            moved_levels.append(i);
+    }
+    if (!moved_levels.isEmpty() && !rekeyPersistentLevels(level, moved_levels))
+        return;
+    releasePersistentLevel(level);
+}
+
 void QAbstractItemModelPrivate::removePersistentIndexData(QPersistentModelIndexData *data)
 {
+    removeFromPersistentLevel(data);
     if (data->index.isValid()) {
         int removed = persistent.indexes.remove(data->index);
         Q_ASSERT_X(removed == 1, "QPersistentModelIndex::~QPersistentModelIndex",
@@ -586,12 +958,11 @@ void QAbstractItemModelPrivate::rowsAboutToBeInserted(const QModelIndex &parent,
     Q_UNUSED(last);
     QVector<QPersistentModelIndexData *> persistent_moved;
     if (first < q->rowCount(parent)) {
-        for (QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it = persistent.indexes.constBegin();
-             it != persistent.indexes.constEnd(); ++it) {
-            QPersistentModelIndexData *data = *it;
-            const QModelIndex &index = data->index;
-            if (index.row() >= first && index.isValid() && index.parent() == parent) {
-                persistent_moved.append(data);
+        if (QPersistentModelIndexLevel *level = persistentLevel(parent)) {
+            for (int i = level->lowerBound(first, 0); i < level->entries.count(); ++i) {
+                QPersistentModelIndexData *data = level->entries.at(i).data;
+                if (data && data->index.isValid())
+                    persistent_moved.append(data);
             }
         }
     }
@@ -615,6 +986,7 @@ void QAbstractItemModelPrivate::rowsInserted(const QModelIndex &parent,
             qWarning() << "QAbstractItemModel::endInsertRows:  Invalid index (" << old.row() + count << ',' << old.column() << ") in model" << q_func();
         }
     }
+    shiftPersistentLevel(parent, first, first - 1, count, Qt::Vertical);
 }
 
 void QAbstractItemModelPrivate::itemsAboutToBeMoved(const QModelIndex &srcParent, int srcFirst, int srcLast, const QModelIndex &destinationParent, int destinationChild, Qt::Orientation orientation)
@@ -623,19 +995,33 @@ void QAbstractItemModelPrivate::itemsAboutToBeMoved(const QModelIndex &srcParent
     QVector<QPersistentModelIndexData *> persistent_moved_in_source;
     QVector<QPersistentModelIndexData *> persistent_moved_in_destination;
 
-    QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it;
-    const QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator begin = persistent.indexes.constBegin();
-    const QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator end = persistent.indexes.constEnd();
-
     const bool sameParent = (srcParent == destinationParent);
     const bool movingUp = (srcFirst > destinationChild);
+    const bool vertical = (orientation == Qt::Vertical);
+
+    // only the indexes under the two parents can be affected
+    QPersistentModelIndexLevel *source = persistentLevel(srcParent);
+    QPersistentModelIndexLevel *destination = sameParent ? 0 : persistentLevel(destinationParent);
+
+    if (destination) {
+        for (int i = vertical ? destination->lowerBound(destinationChild, 0) : 0;
+             i < destination->entries.count(); ++i) {
+            QPersistentModelIndexData *data = destination->entries.at(i).data;
+            if (!data || !data->index.isValid())
+                continue;
+            const int childPosition = vertical ? data->index.row() : data->index.column();
+            if (childPosition >= destinationChild)
+                persistent_moved_in_destination.append(data);
+        }
+    }
 
-    for ( it = begin; it != end; ++it) {
-        QPersistentModelIndexData *data = *it;
+    const int lowest = (sameParent && movingUp) ? destinationChild : srcFirst;
+    for (int i = (source && vertical) ? source->lowerBound(lowest, 0) : 0;
+         source && i < source->entries.count(); ++i) {
+        QPersistentModelIndexData *data = source->entries.at(i).data;
+        if (!data || !data->index.isValid())
+            continue;
         const QModelIndex &index = data->index;
-        const QModelIndex &parent = index.parent();
-        const bool isSourceIndex = (parent == srcParent);
-        const bool isDestinationIndex = (parent == destinationParent);
 
         int childPosition;
         if (orientation == Qt::Vertical)
@@ -643,15 +1029,6 @@ void QAbstractItemModelPrivate::itemsAboutToBeMoved(const QModelIndex &srcParent
         else
             childPosition = index.column();
 
-        if (!index.isValid() || !(isSourceIndex || isDestinationIndex ) )
-            continue;
-
-        if (!sameParent && isDestinationIndex) {
-            if (childPosition >= destinationChild)
-                persistent_moved_in_destination.append(data);
-            continue;
-        }
-
         if (sameParent && movingUp && childPosition < destinationChild)
             continue;
 
@@ -726,6 +1103,7 @@ void QAbstractItemModelPrivate::itemsMoved(const QModelIndex &sourceParent, int
     movePersistentIndexes(moved_explicitly, explicit_change, destinationParent, orientation);
     movePersistentIndexes(moved_in_source, source_change, sourceParent, orientation);
     movePersistentIndexes(moved_in_destination, destination_change, destinationParent, orientation);
+    movePersistentLevels(sourceParent, sourceFirst, sourceLast, destinationParent, destinationChild, orientation);
 }
 
 void QAbstractItemModelPrivate::rowsAboutToBeRemoved(const QModelIndex &parent,
@@ -735,22 +1113,17 @@ void QAbstractItemModelPrivate::rowsAboutToBeRemoved(const QModelIndex &parent,
     QVector<QPersistentModelIndexData *>  persistent_invalidated;
     // find the persistent indexes that are affected by the change, either by being in the removed subtree
     // or by being on the same level and below the removed rows
-    for (QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it = persistent.indexes.constBegin();
-         it != persistent.indexes.constEnd(); ++it) {
-        QPersistentModelIndexData *data = *it;
-        bool level_changed = false;
-        QModelIndex current = data->index;
-        while (current.isValid()) {
-            QModelIndex current_parent = current.parent();
-            if (current_parent == parent) { // on the same level as the change
-                if (!level_changed && current.row() > last) // below the removed rows
-                    persistent_moved.append(data);
-                else if (current.row() <= last && current.row() >= first) // in the removed subtree
-                    persistent_invalidated.append(data);
-                break;
+    if (QPersistentModelIndexLevel *level = persistentLevel(parent)) {
+        for (int i = level->lowerBound(first, 0); i < level->entries.count(); ++i) {
+            const QPersistentModelIndexLevel::Entry &entry = level->entries.at(i);
+            if (entry.row > last) { // below the removed rows
+                if (entry.data && entry.data->index.isValid())
+                    persistent_moved.append(entry.data);
+            } else if (entry.data) { // in the removed subtree
+                persistent_invalidated.append(entry.data);
+            } else if (entry.child) {
+                qt_collectPersistentData(entry.child, persistent_invalidated);
             }
-            current = current_parent;
-            level_changed = true;
         }
     }
 
@@ -775,6 +1148,7 @@ void QAbstractItemModelPrivate::rowsRemoved(const QModelIndex &parent,
             qWarning() << "QAbstractItemModel::endRemoveRows:  Invalid index (" << old.row() - count << ',' << old.column() << ") in model" << q_func();
         }
     }
+    shiftPersistentLevel(parent, first, last, -count, Qt::Vertical);
     QVector<QPersistentModelIndexData *> persistent_invalidated = persistent.invalidated.pop();
     for (QVector<QPersistentModelIndexData *>::const_iterator it = persistent_invalidated.constBegin();
          it != persistent_invalidated.constEnd(); ++it) {
@@ -792,12 +1166,12 @@ void QAbstractItemModelPrivate::columnsAboutToBeInserted(const QModelIndex &pare
     Q_UNUSED(last);
     QVector<QPersistentModelIndexData *> persistent_moved;
     if (first < q->columnCount(parent)) {
-        for (QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it = persistent.indexes.constBegin();
-             it != persistent.indexes.constEnd(); ++it) {
-            QPersistentModelIndexData *data = *it;
-            const QModelIndex &index = data->index;
-            if (index.column() >= first && index.isValid() && index.parent() == parent)
-                persistent_moved.append(data);
+        if (QPersistentModelIndexLevel *level = persistentLevel(parent)) {
+            for (int i = 0; i < level->entries.count(); ++i) {
+                QPersistentModelIndexData *data = level->entries.at(i).data;
+                if (data && data->index.isValid() && data->index.column() >= first)
+                    persistent_moved.append(data);
+            }
         }
     }
     persistent.moved.push(persistent_moved);
@@ -820,6 +1194,7 @@ void QAbstractItemModelPrivate::columnsInserted(const QModelIndex &parent,
             qWarning() << "QAbstractItemModel::endInsertColumns:  Invalid index (" << old.row() << ',' << old.column() + count << ") in model" << q_func();
         }
      }
+    shiftPersistentLevel(parent, first, first - 1, count, Qt::Horizontal);
 }
 
 void QAbstractItemModelPrivate::columnsAboutToBeRemoved(const QModelIndex &parent,
@@ -829,22 +1204,19 @@ void QAbstractItemModelPrivate::columnsAboutToBeRemoved(const QModelIndex &paren
     QVector<QPersistentModelIndexData *> persistent_invalidated;
     // find the persistent indexes that are affected by the change, either by being in the removed subtree
     // or by being on the same level and to the right of the removed columns
-    for (QHash<QModelIndex, QPersistentModelIndexData *>::const_iterator it = persistent.indexes.constBegin();
-         it != persistent.indexes.constEnd(); ++it) {
-        QPersistentModelIndexData *data = *it;
-        bool level_changed = false;
-        QModelIndex current = data->index;
-        while (current.isValid()) {
-            QModelIndex current_parent = current.parent();
-            if (current_parent == parent) { // on the same level as the change
-                if (!level_changed && current.column() > last) // right of the removed columns
-                    persistent_moved.append(data);
-                else if (current.column() <= last && current.column() >= first) // in the removed subtree
-                    persistent_invalidated.append(data);
-                break;
+    if (QPersistentModelIndexLevel *level = persistentLevel(parent)) {
+        for (int i = 0; i < level->entries.count(); ++i) {
+            const QPersistentModelIndexLevel::Entry &entry = level->entries.at(i);
+            if (entry.column < first)
+                continue;
+            if (entry.column > last) { // right of the removed columns
+                if (entry.data && entry.data->index.isValid())
+                    persistent_moved.append(entry.data);
+            } else if (entry.data) { // in the removed subtree
+                persistent_invalidated.append(entry.data);
+            } else if (entry.child) {
+                qt_collectPersistentData(entry.child, persistent_invalidated);
             }
-            current = current_parent;
-            level_changed = true;
         }
     }
 
@@ -870,6 +1242,7 @@ void QAbstractItemModelPrivate::columnsRemoved(const QModelIndex &parent,
             qWarning() << "QAbstractItemModel::endRemoveColumns:  Invalid index (" << old.row() << ',' << old.column() - count << ") in model" << q_func();
         }
     }
+    shiftPersistentLevel(parent, first, last, -count, Qt::Horizontal);
     QVector<QPersistentModelIndexData *> persistent_invalidated = persistent.invalidated.pop();
     for (QVector<QPersistentModelIndexData *>::const_iterator it = persistent_invalidated.constBegin();
          it != persistent_invalidated.constEnd(); ++it) {
@@ -3163,12 +3536,15 @@ void QAbstractItemModel::changePersistentIndex(const QModelIndex &from, const QM
     const QHash<QModelIndex, QPersistentModelIndexData *>::iterator it = d->persistent.indexes.find(from);
     if (it != d->persistent.indexes.end()) {
         QPersistentModelIndexData *data = *it;
+        d->removeFromPersistentLevel(data);
         d->persistent.indexes.erase(it);
         data->index = to;
-        if (to.isValid())
+        if (to.isValid()) {
             d->persistent.insertMultiAtEnd(to, data);
-        else
+            d->addToPersistentLevel(data);
+        } else {
             data->model = 0;
+        }
     }
 }
 
@@ -3197,6 +3573,7 @@ void QAbstractItemModel::changePersistentIndexList(const QModelIndexList &from,
         const QHash<QModelIndex, QPersistentModelIndexData *>::iterator it = d->persistent.indexes.find(from.at(i));
         if (it != d->persistent.indexes.end()) {
             QPersistentModelIndexData *data = *it;
+            d->removeFromPersistentLevel(data);
             d->persistent.indexes.erase(it);
             data->index = to.at(i);
             if (data->index.isValid())
@@ -3210,6 +3587,7 @@ void QAbstractItemModel::changePersistentIndexList(const QModelIndexList &from,
          it != toBeReinserted.constEnd() ; ++it) {
         QPersistentModelIndexData *data = *it;
         d->persistent.insertMultiAtEnd(data->index, data);
+        d->addToPersistentLevel(data);
     }
 }
 
@@ -50,21 +50,72 @@
 #include "QtCore/qstack.h"
 #include "QtCore/qset.h"
 #include "QtCore/qhash.h"
+#include "QtCore/qvector.h"
 
 QT_BEGIN_NAMESPACE
 
+class QPersistentModelIndexLevel;
+
 class QPersistentModelIndexData
 {
 public:
-    QPersistentModelIndexData() : model(0) {}
-    QPersistentModelIndexData(const QModelIndex &idx) : index(idx), model(idx.model()) {}
+    QPersistentModelIndexData() : model(0), level(0) {}
+    QPersistentModelIndexData(const QModelIndex &idx) : index(idx), model(idx.model()), level(0) {}
     QModelIndex index;
     QAtomicInt ref;
     const QAbstractItemModel *model;
+    QPersistentModelIndexLevel *level;
     static QPersistentModelIndexData *create(const QModelIndex &index);
     static void destroy(QPersistentModelIndexData *data);
 };
 
+/*
+  The persistent indexes of a model that share the same parent, ordered by
+  (row, column), so that inserting, removing and moving rows only has to
+  touch the entries at and after the changed range. A level also holds an
+  entry for every child level, which keeps the key of the child level up to
+  date when its parent row or column moves.
+
+  Entries are erased by clearing their pointers; the gaps are squeezed out
+  the next time the level is sorted.
+*/
+class QPersistentModelIndexLevel
+{
+public:
+    struct Entry {
+        int row;
+        int column;
+        QPersistentModelIndexData *data;
+        QPersistentModelIndexLevel *child;
+    };
+
+    QPersistentModelIndexLevel(const QModelIndex &parent, QPersistentModelIndexLevel *parentLevel)
+        : parent(parent), parentLevel(parentLevel), live(0), erased(0), sorted(true) {}
+
+    void insert(int row, int column, QPersistentModelIndexData *data, QPersistentModelIndexLevel *child);
+    void erase(int row, int column, QPersistentModelIndexData *data, QPersistentModelIndexLevel *child);
+    inline void eraseAt(int i)
+    {
+        Entry &entry = entries[i];
+        if (entry.data)
+            entry.data->level = 0;
+        entry.data = 0;
+        entry.child = 0;
+        --live;
+        ++erased;
+    }
+    void sort();
+    int lowerBound(int row, int column);
+
+    QModelIndex parent;
+    QPersistentModelIndexLevel *parentLevel;
+    QVector<Entry> entries;
+    int live;
+    int erased;
+    bool sorted;
+};
+Q_DECLARE_TYPEINFO(QPersistentModelIndexLevel::Entry, Q_PRIMITIVE_TYPE);
+
 class Q_CORE_EXPORT QAbstractItemModelPrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QAbstractItemModel)
@@ -74,6 +125,19 @@ public:
     ~QAbstractItemModelPrivate();
 
     void removePersistentIndexData(QPersistentModelIndexData *data);
+    QPersistentModelIndexLevel *persistentLevel(const QModelIndex &parent);
+    QPersistentModelIndexLevel *createPersistentLevel(const QModelIndex &parent);
+    void addToPersistentLevel(QPersistentModelIndexData *data);
+    void removeFromPersistentLevel(QPersistentModelIndexData *data);
+    void releasePersistentLevel(QPersistentModelIndexLevel *level);
+    void destroyPersistentLevel(QPersistentModelIndexLevel *level);
+    void invalidatePersistentLevels();
+    void shiftPersistentLevel(const QModelIndex &parent, int first, int last, int change,
+                              Qt::Orientation orientation);
+    bool rekeyPersistentLevels(QPersistentModelIndexLevel *level, const QVector<int> &positions);
+    void movePersistentLevels(const QModelIndex &srcParent, int srcFirst, int srcLast,
+                              const QModelIndex &destinationParent, int destinationChild,
+                              Qt::Orientation orientation);
     void movePersistentIndexes(const QVector<QPersistentModelIndexData *> &indexes, int change, const QModelIndex &parent, Qt::Orientation orientation);
     void rowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
     void rowsInserted(const QModelIndex &parent, int first, int last);
@@ -84,6 +148,9 @@ public:
     void columnsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
     void columnsRemoved(const QModelIndex &parent, int first, int last);
     static QAbstractItemModel *staticEmptyModel();
+    static const QAbstractItemModelPrivate *get(const QAbstractItemModel *model)
+    { return static_cast<const QAbstractItemModelPrivate *>(QObjectPrivate::get(const_cast<QAbstractItemModel *>(model))); }
+    virtual void multiData(const QModelIndex &index, const int *roles, QVariant *values, int count) const;
     static bool variantLessThan(const QVariant &v1, const QVariant &v2);
 
     void itemsAboutToBeMoved(const QModelIndex &srcParent, int srcFirst, int srcLast, const QModelIndex &destinationParent, int destinationChild, Qt::Orientation);
@@ -103,6 +170,7 @@ public:
     }
 
     inline void invalidatePersistentIndexes() {
+        invalidatePersistentLevels();
         foreach (QPersistentModelIndexData *data, persistent.indexes) {
             data->index = QModelIndex();
             data->model = 0;
@@ -119,6 +187,7 @@ public:
         QHash<QModelIndex, QPersistentModelIndexData *>::iterator it = persistent.indexes.find(index);
         if(it != persistent.indexes.end()) {
             QPersistentModelIndexData *data = *it;
+            removeFromPersistentLevel(data);
             persistent.indexes.erase(it);
             data->index = QModelIndex();
             data->model = 0;
@@ -152,10 +221,15 @@ public:
     QStack<Change> changes;
 
     struct Persistent {
-        Persistent() {}
+        Persistent() : levelsValid(false), levelsConnected(false) {}
         QHash<QModelIndex, QPersistentModelIndexData *> indexes;
+        // the indexes grouped by parent; only built once rows or columns
+        // are inserted, removed or moved, and dropped on layout changes
+        QHash<QModelIndex, QPersistentModelIndexLevel *> levels;
         QStack<QVector<QPersistentModelIndexData *> > moved;
         QStack<QVector<QPersistentModelIndexData *> > invalidated;
+        bool levelsValid;
+        bool levelsConnected;
         void insertMultiAtEnd(const QModelIndex& key, QPersistentModelIndexData *data);
     } persistent;
 
@@ -41,6 +41,11 @@
 #include <qdatetime.h>
 #include <qpair.h>
 #include <qstringlist.h>
+#ifndef QT_NO_THREAD
+#include <qrunnable.h>
+#include <qsemaphore.h>
+#include <qthreadpool.h>
+#endif
 #include <private/qabstractitemmodel_p.h>
 #include <private/qabstractproxymodel_p.h>
 
@@ -59,6 +64,45 @@ static inline QSet<int> qVectorToSet(const QVector<int> &vector)
     return set;
 }
 
+static bool qt_sortFilterProxyModelLessThan(const QVariant &l, const QVariant &r,
+                                            Qt::CaseSensitivity cs, bool localeAware)
+{
+    // Duplicated in QStandardItem::operator<()
+    if (l.userType() == QVariant::Invalid)
+        return false;
+    if (r.userType() == QVariant::Invalid)
+        return true;
+    switch (l.userType()) {
+    case QVariant::Int:
+        return l.toInt() < r.toInt();
+    case QVariant::UInt:
+        return l.toUInt() < r.toUInt();
+    case QVariant::LongLong:
+        return l.toLongLong() < r.toLongLong();
+    case QVariant::ULongLong:
+        return l.toULongLong() < r.toULongLong();
+    case QMetaType::Float:
+        return l.toFloat() < r.toFloat();
+    case QVariant::Double:
+        return l.toDouble() < r.toDouble();
+    case QVariant::Char:
+        return l.toChar() < r.toChar();
+    case QVariant::Date:
+        return l.toDate() < r.toDate();
+    case QVariant::Time:
+        return l.toTime() < r.toTime();
+    case QVariant::DateTime:
+        return l.toDateTime() < r.toDateTime();
+    case QVariant::String:
+    default:
+        if (localeAware)
+            return l.toString().localeAwareCompare(r.toString()) < 0;
+        else
+            return l.toString().compare(r.toString(), cs) < 0;
+    }
+    return false;
+}
+
 class QSortFilterProxyModelLessThan
 {
 public:
@@ -104,6 +148,54 @@ private:
     const QSortFilterProxyModel *proxy_model;
 };
 
+class QSortFilterProxyModelKeyLessThan
+{
+public:
+    inline QSortFilterProxyModelKeyLessThan(const QVector<QVariant> *keys, Qt::SortOrder order,
+                                          Qt::CaseSensitivity cs, bool localeAware)
+        : sort_keys(keys), sort_order(order), sort_casesensitivity(cs), sort_localeaware(localeAware) {}
+
+    inline bool operator()(int r1, int r2) const
+    {
+        if (sort_order == Qt::AscendingOrder)
+            return qt_sortFilterProxyModelLessThan(sort_keys->at(r1), sort_keys->at(r2),
+                                                   sort_casesensitivity, sort_localeaware);
+        return qt_sortFilterProxyModelLessThan(sort_keys->at(r2), sort_keys->at(r1),
+                                               sort_casesensitivity, sort_localeaware);
+    }
+
+private:
+    const QVector<QVariant> *sort_keys;
+    Qt::SortOrder sort_order;
+    Qt::CaseSensitivity sort_casesensitivity;
+    bool sort_localeaware;
+};
+
+#ifndef QT_NO_THREAD
+class QSortFilterProxyModelFilterTask : public QRunnable
+{
+public:
+    inline QSortFilterProxyModelFilterTask(const QSortFilterProxyModel *proxy, const QModelIndex &parent,
+                                         int start, int end, bool *accepted, QSemaphore *done)
+        : proxy_model(proxy), source_parent(parent), first(start), last(end),
+          result(accepted), semaphore(done) {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        for (int row = first; row <= last; ++row)
+            result[row - first] = proxy_model->filterAcceptsRow(row, source_parent);
+        semaphore->release();
+    }
+
+private:
+    const QSortFilterProxyModel *proxy_model;
+    QModelIndex source_parent;
+    int first;
+    int last;
+    bool *result;
+    QSemaphore *semaphore;
+};
+#endif // QT_NO_THREAD
 
 //this struct is used to store what are the rows that are removed
 //between a call to rowsAboutToBeRemoved and rowsRemoved
@@ -145,9 +237,12 @@ public:
         QVector<int> proxy_rows;
         QVector<int> proxy_columns;
         QVector<QModelIndex> mapped_children;
+        QVector<QVariant> sort_keys; // indexed by source row; empty unless CacheSortKeys is set
         QHash<QModelIndex, Mapping *>::const_iterator map_iter;
     };
 
+    enum { ParallelFilterChunkSize = 1024 };
+
     mutable QHash<QModelIndex, Mapping*> source_index_mapping;
 
     int source_sort_column;
@@ -164,6 +259,8 @@ public:
     bool dynamic_sortfilter;
     QRowsRemoval itemsBeingRemoved;
 
+    QSortFilterProxyModel::OptimizationFlags optimization_flags;
+
     QModelIndexPairList saved_persistent_indexes;
 
     QHash<QModelIndex, Mapping *>::const_iterator create_mapping(
@@ -239,7 +336,16 @@ public:
     void sort();
     bool update_source_sort_column();
     void sort_source_rows(QVector<int> &source_rows,
-                          const QModelIndex &source_parent) const;
+                          const QModelIndex &source_parent, Mapping *m = 0) const;
+    const QVector<QVariant> *sort_keys(const QModelIndex &source_parent, Mapping *m = 0) const;
+    void update_sort_keys(Mapping *m, const QModelIndex &source_parent, int start, int end) const;
+    void clear_sort_keys();
+    QVector<bool> filter_accepts_rows(int start, int end, const QModelIndex &source_parent) const;
+    inline bool parallel_filtering(int count) const
+    {
+        return (optimization_flags & QSortFilterProxyModel::ParallelFiltering)
+            && count >= 2 * ParallelFilterChunkSize;
+    }
     QVector<QPair<int, QVector<int > > > proxy_intervals_for_source_items_to_add(
         const QVector<int> &proxy_to_source, const QVector<int> &source_items,
         const QModelIndex &source_parent, Qt::Orientation orient) const;
@@ -259,6 +365,8 @@ public:
         Qt::Orientation orient, bool emit_signal = true);
     void build_source_to_proxy_mapping(
         const QVector<int> &proxy_to_source, QVector<int> &source_to_proxy) const;
+    void build_source_to_proxy_mapping(
+        const QVector<int> &proxy_to_source, QVector<int> &source_to_proxy, int proxy_start) const;
     void source_items_inserted(const QModelIndex &source_parent,
                                int start, int end, Qt::Orientation orient);
     void source_items_about_to_be_removed(const QModelIndex &source_parent,
@@ -332,9 +440,12 @@ IndexMap::const_iterator QSortFilterProxyModelPrivate::create_mapping(
 
     int source_rows = model->rowCount(source_parent);
     m->source_rows.reserve(source_rows);
-    for (int i = 0; i < source_rows; ++i) {
-        if (q->filterAcceptsRow(i, source_parent))
-            m->source_rows.append(i);
+    if (source_rows > 0) {
+        const QVector<bool> accepted = filter_accepts_rows(0, source_rows - 1, source_parent);
+        for (int i = 0; i < source_rows; ++i) {
+            if (accepted.at(i))
+                m->source_rows.append(i);
+        }
     }
     int source_cols = model->columnCount(source_parent);
     m->source_columns.reserve(source_cols);
@@ -343,8 +454,8 @@ IndexMap::const_iterator QSortFilterProxyModelPrivate::create_mapping(
             m->source_columns.append(i);
     }
 
-    sort_source_rows(m->source_rows, source_parent);
     m->proxy_rows.resize(source_rows);
+    sort_source_rows(m->source_rows, source_parent, m);
     build_source_to_proxy_mapping(m->source_rows, m->proxy_rows);
     m->proxy_columns.resize(source_cols);
     build_source_to_proxy_mapping(m->source_columns, m->proxy_columns);
@@ -437,7 +548,7 @@ void QSortFilterProxyModelPrivate::sort()
     for (; it != source_index_mapping.constEnd(); ++it) {
         QModelIndex source_parent = it.key();
         Mapping *m = it.value();
-        sort_source_rows(m->source_rows, source_parent);
+        sort_source_rows(m->source_rows, source_parent, m);
         build_source_to_proxy_mapping(m->source_rows, m->proxy_rows);
     }
     update_persistent_indexes(source_indexes);
@@ -467,7 +578,10 @@ bool QSortFilterProxyModelPrivate::update_source_sort_column()
             source_sort_column = -1;
     }
 
-    return old_source_sort_column != source_sort_column;
+    if (old_source_sort_column == source_sort_column)
+        return false;
+    clear_sort_keys();
+    return true;
 }
 
 
@@ -477,11 +591,14 @@ bool QSortFilterProxyModelPrivate::update_source_sort_column()
   Sorts the given \a source_rows according to current sort column and order.
 */
 void QSortFilterProxyModelPrivate::sort_source_rows(
-    QVector<int> &source_rows, const QModelIndex &source_parent) const
+    QVector<int> &source_rows, const QModelIndex &source_parent, Mapping *m) const
 {
     Q_Q(const QSortFilterProxyModel);
     if (source_sort_column >= 0) {
-        if (sort_order == Qt::AscendingOrder) {
+        if (const QVector<QVariant> *keys = sort_keys(source_parent, m)) {
+            QSortFilterProxyModelKeyLessThan lt(keys, sort_order, sort_casesensitivity, sort_localeaware);
+            std::stable_sort(source_rows.begin(), source_rows.end(), lt);
+        } else if (sort_order == Qt::AscendingOrder) {
             QSortFilterProxyModelLessThan lt(source_sort_column, source_parent, model, q);
             std::stable_sort(source_rows.begin(), source_rows.end(), lt);
         } else {
@@ -493,6 +610,105 @@ void QSortFilterProxyModelPrivate::sort_source_rows(
     }
 }
 
+/*!
+  \internal
+
+  Returns the sort keys of all the source rows of \a source_parent, or 0
+  if sort keys are not cached. Missing keys are fetched from the source
+  model, so that sorting only queries each row once.
+*/
+const QVector<QVariant> *QSortFilterProxyModelPrivate::sort_keys(
+    const QModelIndex &source_parent, Mapping *m) const
+{
+    if (!(optimization_flags & QSortFilterProxyModel::CacheSortKeys) || source_sort_column < 0)
+        return 0;
+    if (!m)
+        m = source_index_mapping.value(source_parent);
+    if (!m)
+        return 0;
+    const int source_count = m->proxy_rows.size();
+    if (m->sort_keys.size() != source_count) {
+        m->sort_keys.resize(source_count);
+        update_sort_keys(m, source_parent, 0, source_count - 1);
+    }
+    return &m->sort_keys;
+}
+
+/*!
+  \internal
+
+  Refetches the cached sort keys of the source rows \a start to \a end.
+*/
+void QSortFilterProxyModelPrivate::update_sort_keys(
+    Mapping *m, const QModelIndex &source_parent, int start, int end) const
+{
+    end = qMin(end, m->sort_keys.size() - 1);
+    for (int row = start; row <= end; ++row) {
+        const QModelIndex source_index = model->index(row, source_sort_column, source_parent);
+        m->sort_keys[row] = model->data(source_index, sort_role);
+    }
+}
+
+/*!
+  \internal
+
+  Drops the cached sort keys, e.g. because the sort column or role changed.
+*/
+void QSortFilterProxyModelPrivate::clear_sort_keys()
+{
+    IndexMap::const_iterator it = source_index_mapping.constBegin();
+    for (; it != source_index_mapping.constEnd(); ++it)
+        it.value()->sort_keys.clear();
+}
+
+/*!
+  \internal
+
+  Returns whether filterAcceptsRow() accepts each of the source rows \a start
+  to \a end of \a source_parent. With QSortFilterProxyModel::ParallelFiltering
+  the rows are split into chunks that are evaluated on the global thread pool.
+*/
+QVector<bool> QSortFilterProxyModelPrivate::filter_accepts_rows(
+    int start, int end, const QModelIndex &source_parent) const
+{
+    Q_Q(const QSortFilterProxyModel);
+    const int count = end - start + 1;
+    QVector<bool> accepted(count);
+    bool *result = accepted.data();
+    int first = start;
+#ifndef QT_NO_THREAD
+    if (parallel_filtering(count)) {
+        QThreadPool *pool = QThreadPool::globalInstance();
+        const int chunks = qMin(qMax(pool->maxThreadCount(), 1), count / ParallelFilterChunkSize);
+        const int chunk_size = (count + chunks - 1) / chunks;
+        // The default filterAcceptsRow() matches on copies of filter_regexp.
+        // Copying compiles the shared engine, which must not happen concurrently.
+        const QRegExp prepared_regexp(filter_regexp);
+        Q_UNUSED(prepared_regexp);
+        QSemaphore done;
+        int dispatched = 0;
+        for (int chunk_start = start + chunk_size; chunk_start <= end; chunk_start += chunk_size) {
+            const int chunk_end = qMin(chunk_start + chunk_size - 1, end);
+            QSortFilterProxyModelFilterTask *task = new QSortFilterProxyModelFilterTask(
+                q, source_parent, chunk_start, chunk_end, result + (chunk_start - start), &done);
+            if (!pool->tryStart(task)) {
+                // no idle thread; evaluate the chunk here instead of queuing behind other work
+                task->run();
+                delete task;
+            }
+            ++dispatched;
+        }
+        for (; first < start + chunk_size; ++first)
+            result[first - start] = q->filterAcceptsRow(first, source_parent);
+        done.acquire(dispatched);
+        return accepted;
+    }
+#endif
+    for (; first <= end; ++first)
+        result[first - start] = q->filterAcceptsRow(first, source_parent);
+    return accepted;
+}
+
 /*!
   \internal
 
@@ -580,9 +796,11 @@ void QSortFilterProxyModelPrivate::remove_proxy_interval(
     }
 
     // Remove items from proxy-to-source mapping
+    for (int proxy_item = proxy_start; proxy_item <= proxy_end; ++proxy_item)
+        source_to_proxy[proxy_to_source.at(proxy_item)] = -1;
     proxy_to_source.remove(proxy_start, proxy_end - proxy_start + 1);
 
-    build_source_to_proxy_mapping(proxy_to_source, source_to_proxy);
+    build_source_to_proxy_mapping(proxy_to_source, source_to_proxy, proxy_start);
 
     if (emit_signal) {
         if (orient == Qt::Vertical)
@@ -618,6 +836,9 @@ QVector<QPair<int, QVector<int > > > QSortFilterProxyModelPrivate::proxy_interva
     int source_items_index = 0;
     QVector<int> source_items_in_interval;
     bool compare = (orient == Qt::Vertical && source_sort_column >= 0 && dynamic_sortfilter);
+    const QVector<QVariant> *keys = compare ? sort_keys(source_parent) : 0;
+    const QSortFilterProxyModelKeyLessThan key_less_than(keys, sort_order,
+                                                         sort_casesensitivity, sort_localeaware);
     while (source_items_index < source_items.size()) {
         source_items_in_interval.clear();
         int first_new_source_item = source_items.at(source_items_index);
@@ -626,10 +847,15 @@ QVector<QPair<int, QVector<int > > > QSortFilterProxyModelPrivate::proxy_interva
 
         // Find proxy item at which insertion should be started
         int proxy_high = proxy_to_source.size() - 1;
-        QModelIndex i1 = compare ? model->index(first_new_source_item, source_sort_column, source_parent) : QModelIndex();
+        QModelIndex i1 = (compare && !keys) ? model->index(first_new_source_item, source_sort_column, source_parent) : QModelIndex();
         while (proxy_low <= proxy_high) {
             proxy_item = (proxy_low + proxy_high) / 2;
-            if (compare) {
+            if (keys) {
+                if (key_less_than(first_new_source_item, proxy_to_source.at(proxy_item)))
+                    proxy_high = proxy_item - 1;
+                else
+                    proxy_low = proxy_item + 1;
+            } else if (compare) {
                 QModelIndex i2 = model->index(proxy_to_source.at(proxy_item), source_sort_column, source_parent);
                 if ((sort_order == Qt::AscendingOrder) ? q->lessThan(i1, i2) : q->lessThan(i2, i1))
                     proxy_high = proxy_item - 1;
@@ -649,10 +875,13 @@ QVector<QPair<int, QVector<int > > > QSortFilterProxyModelPrivate::proxy_interva
             for ( ; source_items_index < source_items.size(); ++source_items_index)
                 source_items_in_interval.append(source_items.at(source_items_index));
         } else {
-            i1 = compare ? model->index(proxy_to_source.at(proxy_item), source_sort_column, source_parent) : QModelIndex();
+            i1 = (compare && !keys) ? model->index(proxy_to_source.at(proxy_item), source_sort_column, source_parent) : QModelIndex();
             for ( ; source_items_index < source_items.size(); ++source_items_index) {
                 int new_source_item = source_items.at(source_items_index);
-                if (compare) {
+                if (keys) {
+                    if (key_less_than(proxy_to_source.at(proxy_item), new_source_item))
+                        break;
+                } else if (compare) {
                     QModelIndex i2 = model->index(new_source_item, source_sort_column, source_parent);
                     if ((sort_order == Qt::AscendingOrder) ? q->lessThan(i1, i2) : q->lessThan(i2, i1))
                         break;
@@ -705,10 +934,10 @@ void QSortFilterProxyModelPrivate::insert_source_items(
                 q->beginInsertColumns(proxy_parent, proxy_start, proxy_end);
         }
 
-        for (int i = 0; i < source_items.size(); ++i)
-            proxy_to_source.insert(proxy_start + i, source_items.at(i));
+        proxy_to_source.insert(proxy_start, source_items.size(), 0);
+        std::copy(source_items.constBegin(), source_items.constEnd(), proxy_to_source.begin() + proxy_start);
 
-        build_source_to_proxy_mapping(proxy_to_source, source_to_proxy);
+        build_source_to_proxy_mapping(proxy_to_source, source_to_proxy, proxy_start);
 
         if (emit_signal) {
             if (orient == Qt::Vertical)
@@ -771,6 +1000,14 @@ void QSortFilterProxyModelPrivate::source_items_inserted(
         return;
     }
     source_to_proxy.insert(start, delta_item_count, -1);
+    if (orient == Qt::Vertical && !m->sort_keys.isEmpty()) {
+        if (m->sort_keys.size() == old_item_count) {
+            m->sort_keys.insert(start, delta_item_count, QVariant());
+            update_sort_keys(m, source_parent, start, end);
+        } else {
+            m->sort_keys.clear();
+        }
+    }
 
     if (start < old_item_count) {
         // Adjust existing "stale" indexes in proxy-to-source mapping
@@ -785,11 +1022,16 @@ void QSortFilterProxyModelPrivate::source_items_inserted(
 
     // Figure out which items to add to mapping based on filter
     QVector<int> source_items;
-    for (int i = start; i <= end; ++i) {
-        if ((orient == Qt::Vertical)
-            ? q->filterAcceptsRow(i, source_parent)
-            : q->filterAcceptsColumn(i, source_parent)) {
-            source_items.append(i);
+    if (orient == Qt::Vertical) {
+        const QVector<bool> accepted = filter_accepts_rows(start, end, source_parent);
+        for (int i = start; i <= end; ++i) {
+            if (accepted.at(i - start))
+                source_items.append(i);
+        }
+    } else {
+        for (int i = start; i <= end; ++i) {
+            if (q->filterAcceptsColumn(i, source_parent))
+                source_items.append(i);
         }
     }
 
@@ -814,7 +1056,7 @@ void QSortFilterProxyModelPrivate::source_items_inserted(
             }
             if (orient == Qt::Horizontal) {
                 // We're reacting to columnsInserted, but we've just inserted new rows. Sort them.
-                sort_source_rows(orthogonal_proxy_to_source, source_parent);
+                sort_source_rows(orthogonal_proxy_to_source, source_parent, m);
             }
             build_source_to_proxy_mapping(orthogonal_proxy_to_source, orthogonal_source_to_proxy);
         }
@@ -822,7 +1064,7 @@ void QSortFilterProxyModelPrivate::source_items_inserted(
 
     // Sort and insert the items
     if (orient == Qt::Vertical) // Only sort rows
-        sort_source_rows(source_items, source_parent);
+        sort_source_rows(source_items, source_parent, m);
     insert_source_items(source_to_proxy, proxy_to_source, source_items, source_parent, orient);
 }
 
@@ -886,6 +1128,12 @@ void QSortFilterProxyModelPrivate::source_items_removed(
     // Shrink the source-to-proxy mapping to reflect the new item count
     int delta_item_count = end - start + 1;
     source_to_proxy.remove(start, delta_item_count);
+    if (orient == Qt::Vertical && !m->sort_keys.isEmpty()) {
+        if (m->sort_keys.size() > end)
+            m->sort_keys.remove(start, delta_item_count);
+        else
+            m->sort_keys.clear();
+    }
 
     int proxy_count = proxy_to_source.size();
     if (proxy_count > source_to_proxy.size()) {
@@ -1002,6 +1250,20 @@ void QSortFilterProxyModelPrivate::build_source_to_proxy_mapping(
         source_to_proxy[proxy_to_source.at(i)] = i;
 }
 
+/*!
+  \internal
+
+  Renumbers the source-to-proxy mapping from \a proxy_start onwards. Entries
+  before \a proxy_start must already be up to date.
+*/
+void QSortFilterProxyModelPrivate::build_source_to_proxy_mapping(
+    const QVector<int> &proxy_to_source, QVector<int> &source_to_proxy, int proxy_start) const
+{
+    int proxy_count = proxy_to_source.size();
+    for (int i = proxy_start; i < proxy_count; ++i)
+        source_to_proxy[proxy_to_source.at(i)] = i;
+}
+
 /*!
   \internal
 
@@ -1113,27 +1375,41 @@ QSet<int> QSortFilterProxyModelPrivate::handle_filter_changed(
     const QModelIndex &source_parent, Qt::Orientation orient)
 {
     Q_Q(QSortFilterProxyModel);
-    // Figure out which mapped items to remove
     QVector<int> source_items_remove;
-    for (int i = 0; i < proxy_to_source.count(); ++i) {
-        const int source_item = proxy_to_source.at(i);
-        if ((orient == Qt::Vertical)
-            ? !q->filterAcceptsRow(source_item, source_parent)
-            : !q->filterAcceptsColumn(source_item, source_parent)) {
-            // This source item does not satisfy the filter, so it must be removed
-            source_items_remove.append(source_item);
-        }
-    }
-    // Figure out which non-mapped items to insert
     QVector<int> source_items_insert;
-    int source_count = source_to_proxy.size();
-    for (int source_item = 0; source_item < source_count; ++source_item) {
-        if (source_to_proxy.at(source_item) == -1) {
-            if ((orient == Qt::Vertical)
-                ? q->filterAcceptsRow(source_item, source_parent)
-                : q->filterAcceptsColumn(source_item, source_parent)) {
-                // This source item satisfies the filter, so it must be added
+    const int source_count = source_to_proxy.size();
+    if (orient == Qt::Vertical && parallel_filtering(source_count)) {
+        // Evaluate the filter for all rows in one go, then split the result
+        const QVector<bool> accepted = filter_accepts_rows(0, source_count - 1, source_parent);
+        for (int i = 0; i < proxy_to_source.count(); ++i) {
+            const int source_item = proxy_to_source.at(i);
+            if (!accepted.at(source_item))
+                source_items_remove.append(source_item);
+        }
+        for (int source_item = 0; source_item < source_count; ++source_item) {
+            if (source_to_proxy.at(source_item) == -1 && accepted.at(source_item))
                 source_items_insert.append(source_item);
+        }
+    } else {
+        // Figure out which mapped items to remove
+        for (int i = 0; i < proxy_to_source.count(); ++i) {
+            const int source_item = proxy_to_source.at(i);
+            if ((orient == Qt::Vertical)
+                ? !q->filterAcceptsRow(source_item, source_parent)
+                : !q->filterAcceptsColumn(source_item, source_parent)) {
+                // This source item does not satisfy the filter, so it must be removed
+                source_items_remove.append(source_item);
+            }
+        }
+        // Figure out which non-mapped items to insert
+        for (int source_item = 0; source_item < source_count; ++source_item) {
+            if (source_to_proxy.at(source_item) == -1) {
+                if ((orient == Qt::Vertical)
+                    ? q->filterAcceptsRow(source_item, source_parent)
+                    : q->filterAcceptsColumn(source_item, source_parent)) {
+                    // This source item satisfies the filter, so it must be added
+                    source_items_insert.append(source_item);
+                }
             }
         }
     }
@@ -1164,6 +1440,11 @@ void QSortFilterProxyModelPrivate::_q_sourceDataChanged(const QModelIndex &sourc
     }
     Mapping *m = it.value();
 
+    if (!m->sort_keys.isEmpty() && source_sort_column >= source_top_left.column()
+        && source_sort_column <= source_bottom_right.column()) {
+        update_sort_keys(m, source_parent, source_top_left.row(), source_bottom_right.row());
+    }
+
     // Figure out how the source changes affect us
     QVector<int> source_rows_remove;
     QVector<int> source_rows_insert;
@@ -1218,7 +1499,7 @@ void QSortFilterProxyModelPrivate::_q_sourceDataChanged(const QModelIndex &sourc
         QModelIndexPairList source_indexes = store_persistent_indexes();
         remove_source_items(m->proxy_rows, m->source_rows, source_rows_resort,
                             source_parent, Qt::Vertical, false);
-        sort_source_rows(source_rows_resort, source_parent);
+        sort_source_rows(source_rows_resort, source_parent, m);
         insert_source_items(m->proxy_rows, m->source_rows, source_rows_resort,
                             source_parent, Qt::Vertical, false);
         update_persistent_indexes(source_indexes);
@@ -1253,7 +1534,7 @@ void QSortFilterProxyModelPrivate::_q_sourceDataChanged(const QModelIndex &sourc
     }
 
     if (!source_rows_insert.isEmpty()) {
-        sort_source_rows(source_rows_insert, source_parent);
+        sort_source_rows(source_rows_insert, source_parent, m);
         insert_source_items(m->proxy_rows, m->source_rows,
                             source_rows_insert, source_parent, Qt::Vertical);
     }
@@ -1732,6 +2013,7 @@ QSortFilterProxyModel::QSortFilterProxyModel(QObject *parent)
     d->filter_column = 0;
     d->filter_role = Qt::DisplayRole;
     d->dynamic_sortfilter = true;
+    d->optimization_flags = 0;
     connect(this, SIGNAL(modelReset()), this, SLOT(_q_clearMapping()));
 }
 
@@ -2523,6 +2805,7 @@ void QSortFilterProxyModel::setSortRole(int role)
     if (d->sort_role == role)
         return;
     d->sort_role = role;
+    d->clear_sort_keys();
     d->sort();
 }
 
@@ -2551,6 +2834,74 @@ void QSortFilterProxyModel::setFilterRole(int role)
     d->filter_changed();
 }
 
+/*!
+    \enum QSortFilterProxyModel::OptimizationFlag
+    \since 5.6
+
+    This enum describes flags that you can enable to improve the performance
+    of QSortFilterProxyModel on large source models. Each flag relaxes a
+    guarantee that the model otherwise gives, so only enable the flags that
+    match how the proxy model is used.
+
+    \value ParallelFiltering When a large number of rows has to be filtered
+    at once, for instance when the filter changes or when many rows are
+    inserted, filterAcceptsRow() is called concurrently from threads of the
+    global QThreadPool. Enable this flag only if filterAcceptsRow() is
+    thread-safe, and if the source model's index(), columnCount() and data()
+    can be called from multiple threads while the model is not modified. The
+    default implementation of filterAcceptsRow() is thread-safe under those
+    conditions.
+
+    \value CacheSortKeys The data of the sort column is queried once per
+    source row for the sortRole and kept until the source model reports a
+    change for that row, instead of being queried for every comparison.
+    The cached values are compared like the default implementation of
+    lessThan() does; reimplementations of lessThan() are not called. Do not
+    enable this flag if you reimplement lessThan(), or if the source model
+    changes its data without emitting \l{QAbstractItemModel::}{dataChanged()}.
+*/
+
+/*!
+    \since 5.6
+    \property QSortFilterProxyModel::optimizationFlags
+    \brief flags that can be used to tune QSortFilterProxyModel's performance
+
+    By default, no flags are set.
+
+    \sa setOptimizationFlag(), OptimizationFlag
+*/
+QSortFilterProxyModel::OptimizationFlags QSortFilterProxyModel::optimizationFlags() const
+{
+    Q_D(const QSortFilterProxyModel);
+    return d->optimization_flags;
+}
+
+void QSortFilterProxyModel::setOptimizationFlags(OptimizationFlags flags)
+{
+    Q_D(QSortFilterProxyModel);
+    if (d->optimization_flags == flags)
+        return;
+    d->optimization_flags = flags;
+    if (!(flags & CacheSortKeys))
+        d->clear_sort_keys();
+}
+
+/*!
+    \since 5.6
+
+    Enables \a flag if \a enabled is true; otherwise disables \a flag.
+
+    \sa optimizationFlags
+*/
+void QSortFilterProxyModel::setOptimizationFlag(OptimizationFlag flag, bool enabled)
+{
+    Q_D(QSortFilterProxyModel);
+    if (enabled)
+        setOptimizationFlags(d->optimization_flags | flag);
+    else
+        setOptimizationFlags(d->optimization_flags & ~flag);
+}
+
 /*!
     \obsolete
 
@@ -2648,40 +2999,7 @@ bool QSortFilterProxyModel::lessThan(const QModelIndex &source_left, const QMode
     Q_D(const QSortFilterProxyModel);
     QVariant l = (source_left.model() ? source_left.model()->data(source_left, d->sort_role) : QVariant());
     QVariant r = (source_right.model() ? source_right.model()->data(source_right, d->sort_role) : QVariant());
-    // Duplicated in QStandardItem::operator<()
-    if (l.userType() == QVariant::Invalid)
-        return false;
-    if (r.userType() == QVariant::Invalid)
-        return true;
-    switch (l.userType()) {
-    case QVariant::Int:
-        return l.toInt() < r.toInt();
-    case QVariant::UInt:
-        return l.toUInt() < r.toUInt();
-    case QVariant::LongLong:
-        return l.toLongLong() < r.toLongLong();
-    case QVariant::ULongLong:
-        return l.toULongLong() < r.toULongLong();
-    case QMetaType::Float:
-        return l.toFloat() < r.toFloat();
-    case QVariant::Double:
-        return l.toDouble() < r.toDouble();
-    case QVariant::Char:
-        return l.toChar() < r.toChar();
-    case QVariant::Date:
-        return l.toDate() < r.toDate();
-    case QVariant::Time:
-        return l.toTime() < r.toTime();
-    case QVariant::DateTime:
-        return l.toDateTime() < r.toDateTime();
-    case QVariant::String:
-    default:
-        if (d->sort_localeaware)
-            return l.toString().localeAwareCompare(r.toString()) < 0;
-        else
-            return l.toString().compare(r.toString(), d->sort_casesensitivity) < 0;
-    }
-    return false;
+    return qt_sortFilterProxyModelLessThan(l, r, d->sort_casesensitivity, d->sort_localeaware);
 }
 
 /*!
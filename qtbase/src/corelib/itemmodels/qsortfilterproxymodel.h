@@ -46,11 +46,13 @@ QT_BEGIN_NAMESPACE
 class QSortFilterProxyModelPrivate;
 class QSortFilterProxyModelLessThan;
 class QSortFilterProxyModelGreaterThan;
+class QSortFilterProxyModelFilterTask;
 
 class Q_CORE_EXPORT QSortFilterProxyModel : public QAbstractProxyModel
 {
     friend class QSortFilterProxyModelLessThan;
     friend class QSortFilterProxyModelGreaterThan;
+    friend class QSortFilterProxyModelFilterTask;
 
     Q_OBJECT
     Q_PROPERTY(QRegExp filterRegExp READ filterRegExp WRITE setFilterRegExp)
@@ -61,8 +63,16 @@ class Q_CORE_EXPORT QSortFilterProxyModel : public QAbstractProxyModel
     Q_PROPERTY(bool isSortLocaleAware READ isSortLocaleAware WRITE setSortLocaleAware)
     Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole)
     Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole)
+    Q_PROPERTY(OptimizationFlags optimizationFlags READ optimizationFlags WRITE setOptimizationFlags)
 
 public:
+    enum OptimizationFlag {
+        ParallelFiltering = 0x1,
+        CacheSortKeys = 0x2
+    };
+    Q_DECLARE_FLAGS(OptimizationFlags, OptimizationFlag)
+    Q_FLAG(OptimizationFlags)
+
     explicit QSortFilterProxyModel(QObject *parent = Q_NULLPTR);
     ~QSortFilterProxyModel();
 
@@ -101,6 +111,10 @@ public:
     int filterRole() const;
     void setFilterRole(int role);
 
+    OptimizationFlags optimizationFlags() const;
+    void setOptimizationFlag(OptimizationFlag flag, bool enabled = true);
+    void setOptimizationFlags(OptimizationFlags flags);
+
 public Q_SLOTS:
     void setFilterRegExp(const QString &pattern);
     void setFilterWildcard(const QString &pattern);
@@ -182,6 +196,8 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_clearMapping())
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QSortFilterProxyModel::OptimizationFlags)
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_SORTFILTERPROXYMODEL
@@ -481,6 +481,27 @@ bool QStandardItemPrivate::insertColumns(int column, int count, const QList<QSta
     return true;
 }
 
+/*!
+  \internal
+
+  Looks up the item at \a index once for all \a roles instead of once
+  per role. The values still come from QStandardItem::data(), which item
+  subclasses may reimplement. Subclasses of the model may reimplement
+  data() as well, so they get the default implementation.
+*/
+void QStandardItemModelPrivate::multiData(const QModelIndex &index, const int *roles,
+                                          QVariant *values, int count) const
+{
+    Q_Q(const QStandardItemModel);
+    if (q->metaObject() != &QStandardItemModel::staticMetaObject) {
+        QAbstractItemModelPrivate::multiData(index, roles, values, count);
+        return;
+    }
+    const QStandardItem *item = itemFromIndex(index);
+    for (int i = 0; i < count; ++i)
+        values[i] = item ? item->data(roles[i]) : QVariant();
+}
+
 /*!
   \internal
 */
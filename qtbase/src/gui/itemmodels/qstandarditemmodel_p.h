@@ -181,6 +181,7 @@ public:
         return parent->child(index.row(), index.column());
     }
 
+    void multiData(const QModelIndex &index, const int *roles, QVariant *values, int count) const Q_DECL_OVERRIDE;
     void sort(QStandardItem *parent, int column, Qt::SortOrder order);
     void itemChanged(QStandardItem *item);
     void rowsAboutToBeInserted(QStandardItem *parent, int start, int end);
@@ -1776,14 +1776,58 @@ quint64 Selector::pseudoClass(quint64 *negated) const
 
 ///////////////////////////////////////////////////////////////////////////////
 // StyleSheet
+static void collectSelectorDependencies(const Selector &selector, QStringList *attributeNames,
+                                        bool *hasRelations)
+{
+    for (int i = 0; i < selector.basicSelectors.count(); ++i) {
+        const BasicSelector &basicSelector = selector.basicSelectors.at(i);
+        if (basicSelector.relationToNext != BasicSelector::NoRelation)
+            *hasRelations = true;
+        for (int j = 0; j < basicSelector.attributeSelectors.count(); ++j) {
+            const QString &name = basicSelector.attributeSelectors.at(j).name;
+            if (!attributeNames->contains(name))
+                attributeNames->append(name);
+        }
+    }
+}
+
+// Returns the attribute selector that a rule can be looked up by, if any:
+// [name="value"] is preferred over [name~="value"] and .value
+static const AttributeSelector *indexedAttributeSelector(const BasicSelector &sel)
+{
+    const AttributeSelector *result = 0;
+    for (int i = 0; i < sel.attributeSelectors.count(); ++i) {
+        const AttributeSelector &a = sel.attributeSelectors.at(i);
+        if (a.valueMatchCriterium == AttributeSelector::MatchEqual)
+            return &a;
+        if (a.valueMatchCriterium == AttributeSelector::MatchContains && !result)
+            result = &a;
+    }
+    return result;
+}
+
+static inline QString attributeIndexKey(const QString &name, QChar op, const QString &value)
+{
+    return name + op + value;
+}
+
 void StyleSheet::buildIndexes(Qt::CaseSensitivity nameCaseSensitivity)
 {
+    for (int i = 0; i < mediaRules.count(); ++i) {
+        const QVector<StyleRule> &rules = mediaRules.at(i).styleRules;
+        for (int j = 0; j < rules.count(); ++j) {
+            for (int k = 0; k < rules.at(j).selectors.count(); ++k)
+                collectSelectorDependencies(rules.at(j).selectors.at(k), &attributeNames, &hasRelations);
+        }
+    }
+
     QVector<StyleRule> universals;
     for (int i = 0; i < styleRules.count(); ++i) {
         const StyleRule &rule = styleRules.at(i);
         QVector<Selector> universalsSelectors;
         for (int j = 0; j < rule.selectors.count(); ++j) {
             const Selector& selector = rule.selectors.at(j);
+            collectSelectorDependencies(selector, &attributeNames, &hasRelations);
 
             if (selector.basicSelectors.isEmpty())
                 continue;
@@ -1812,6 +1856,16 @@ void StyleSheet::buildIndexes(Qt::CaseSensitivity nameCaseSensitivity)
                 if (nameCaseSensitivity == Qt::CaseInsensitive)
                     name=name.toLower();
                 nameIndex.insert(name, nr);
+            } else if (const AttributeSelector *attributeSelector = indexedAttributeSelector(sel)) {
+                StyleRule nr;
+                nr.selectors += selector;
+                nr.declarations = rule.declarations;
+                nr.order = i;
+                const QChar op = attributeSelector->valueMatchCriterium == AttributeSelector::MatchEqual
+                    ? QLatin1Char('=') : QLatin1Char('~');
+                attributeIndex.insert(attributeIndexKey(attributeSelector->name, op, attributeSelector->value), nr);
+                if (!attributeIndexNames.contains(attributeSelector->name))
+                    attributeIndexNames += attributeSelector->name;
             } else {
                 universalsSelectors += selector;
             }
@@ -1999,6 +2053,27 @@ QVector<StyleRule> StyleSelector::styleRulesForNode(NodePtr node)
                 }
             }
         }
+        if (!styleSheet.attributeIndex.isEmpty() && hasAttributes(node)) {
+            for (int i = 0; i < styleSheet.attributeIndexNames.count(); ++i) {
+                const QString &name = styleSheet.attributeIndexNames.at(i);
+                const QString value = attribute(node, name);
+                if (value.isNull())
+                    continue;
+                QStringList keys(attributeIndexKey(name, QLatin1Char('='), value));
+                QStringList words = value.split(QLatin1Char(' '));
+                words.removeDuplicates();
+                for (int j = 0; j < words.count(); ++j)
+                    keys += attributeIndexKey(name, QLatin1Char('~'), words.at(j));
+                for (int j = 0; j < keys.count(); ++j) {
+                    const QString &key = keys.at(j);
+                    QMultiHash<QString, StyleRule>::const_iterator it = styleSheet.attributeIndex.constFind(key);
+                    while (it != styleSheet.attributeIndex.constEnd() && it.key() == key) {
+                        matchRule(node, it.value(), styleSheet.origin, styleSheet.depth, &weightedRules);
+                        ++it;
+                    }
+                }
+            }
+        }
         if (!medium.isEmpty()) {
             for (int i = 0; i < styleSheet.mediaRules.count(); ++i) {
                 if (styleSheet.mediaRules.at(i).media.contains(medium, Qt::CaseInsensitive)) {
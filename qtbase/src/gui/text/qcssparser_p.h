@@ -612,7 +612,7 @@ enum StyleSheetOrigin {
 
 struct StyleSheet
 {
-    StyleSheet() : origin(StyleSheetOrigin_Unspecified), depth(0) { }
+    StyleSheet() : origin(StyleSheetOrigin_Unspecified), depth(0), hasRelations(false) { }
     QVector<StyleRule> styleRules;  //only contains rules that are not indexed
     QVector<MediaRule> mediaRules;
     QVector<PageRule> pageRules;
@@ -621,6 +621,10 @@ struct StyleSheet
     int depth; // applicable only for inline style sheets
     QMultiHash<QString, StyleRule> nameIndex;
     QMultiHash<QString, StyleRule> idIndex;
+    QMultiHash<QString, StyleRule> attributeIndex; // keyed by "name=value" or "name~value"
+    QStringList attributeIndexNames;
+    QStringList attributeNames; // all attributes tested by the selectors
+    bool hasRelations; // whether any selector also tests other nodes
 
     Q_GUI_EXPORT void buildIndexes(Qt::CaseSensitivity nameCaseSensitivity = Qt::CaseSensitive);
 };
@@ -10,6 +10,8 @@ HEADERS += \
     access/qabstractprotocolhandler_p.h \
     access/qhttpprotocolhandler_p.h \
     access/qspdyprotocolhandler_p.h \
+    access/qhttp2protocolhandler_p.h \
+    access/qhpack_p.h \
     access/qnetworkaccessauthenticationmanager_p.h \
     access/qnetworkaccessmanager.h \
     access/qnetworkaccessmanager_p.h \
@@ -37,7 +39,13 @@ HEADERS += \
     access/qnetworkdiskcache.h \
     access/qhttpthreaddelegate_p.h \
     access/qhttpmultipart.h \
-    access/qhttpmultipart_p.h
+    access/qhttpmultipart_p.h \
+    access/qhttpmultipartreader.h \
+    access/qhttpmultipartreader_p.h \
+    access/qnetworkcontentdecoder.h \
+    access/qnetworkcontentdecoder_p.h \
+    access/qnetworkreplymetrics.h \
+    access/qnetworkreplymetrics_p.h
 
 SOURCES += \
     access/qftp.cpp \
@@ -49,6 +57,8 @@ SOURCES += \
     access/qabstractprotocolhandler.cpp \
     access/qhttpprotocolhandler.cpp \
     access/qspdyprotocolhandler.cpp \
+    access/qhttp2protocolhandler.cpp \
+    access/qhpack.cpp \
     access/qnetworkaccessauthenticationmanager.cpp \
     access/qnetworkaccessmanager.cpp \
     access/qnetworkaccesscache.cpp \
@@ -68,7 +78,10 @@ SOURCES += \
     access/qabstractnetworkcache.cpp \
     access/qnetworkdiskcache.cpp \
     access/qhttpthreaddelegate.cpp \
-    access/qhttpmultipart.cpp
+    access/qhttpmultipart.cpp \
+    access/qhttpmultipartreader.cpp \
+    access/qnetworkcontentdecoder.cpp \
+    access/qnetworkreplymetrics.cpp
 
 mac: LIBS_PRIVATE += -framework Security
 
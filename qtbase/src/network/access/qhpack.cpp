@@ -0,0 +1,596 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qhpack_p.h"
+
+#include <QtCore/qglobalstatic.h>
+
+#ifndef QT_NO_HTTP
+
+QT_BEGIN_NAMESPACE
+
+struct QHPackStaticEntry
+{
+    const char *name;
+    const char *value;
+};
+
+// RFC 7541, Appendix A
+static const QHPackStaticEntry staticTable[QHPackTable::StaticTableSize] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""}
+};
+
+struct QHPackHuffmanCode
+{
+    quint32 code; // left-aligned
+    quint32 bitLength;
+};
+
+// RFC 7541, Appendix B; the last entry is EOS
+static const QHPackHuffmanCode huffmanTable[257] = {
+    {0xffc00000, 13}, {0xffffb000, 23}, {0xfffffe20, 28}, {0xfffffe30, 28},
+    {0xfffffe40, 28}, {0xfffffe50, 28}, {0xfffffe60, 28}, {0xfffffe70, 28},
+    {0xfffffe80, 28}, {0xffffea00, 24}, {0xfffffff0, 30}, {0xfffffe90, 28},
+    {0xfffffea0, 28}, {0xfffffff4, 30}, {0xfffffeb0, 28}, {0xfffffec0, 28},
+    {0xfffffed0, 28}, {0xfffffee0, 28}, {0xfffffef0, 28}, {0xffffff00, 28},
+    {0xffffff10, 28}, {0xffffff20, 28}, {0xfffffff8, 30}, {0xffffff30, 28},
+    {0xffffff40, 28}, {0xffffff50, 28}, {0xffffff60, 28}, {0xffffff70, 28},
+    {0xffffff80, 28}, {0xffffff90, 28}, {0xffffffa0, 28}, {0xffffffb0, 28},
+    {0x50000000,  6}, {0xfe000000, 10}, {0xfe400000, 10}, {0xffa00000, 12},
+    {0xffc80000, 13}, {0x54000000,  6}, {0xf8000000,  8}, {0xff400000, 11},
+    {0xfe800000, 10}, {0xfec00000, 10}, {0xf9000000,  8}, {0xff600000, 11},
+    {0xfa000000,  8}, {0x58000000,  6}, {0x5c000000,  6}, {0x60000000,  6},
+    {0x00000000,  5}, {0x08000000,  5}, {0x10000000,  5}, {0x64000000,  6},
+    {0x68000000,  6}, {0x6c000000,  6}, {0x70000000,  6}, {0x74000000,  6},
+    {0x78000000,  6}, {0x7c000000,  6}, {0xb8000000,  7}, {0xfb000000,  8},
+    {0xfff80000, 15}, {0x80000000,  6}, {0xffb00000, 12}, {0xff000000, 10},
+    {0xffd00000, 13}, {0x84000000,  6}, {0xba000000,  7}, {0xbc000000,  7},
+    {0xbe000000,  7}, {0xc0000000,  7}, {0xc2000000,  7}, {0xc4000000,  7},
+    {0xc6000000,  7}, {0xc8000000,  7}, {0xca000000,  7}, {0xcc000000,  7},
+    {0xce000000,  7}, {0xd0000000,  7}, {0xd2000000,  7}, {0xd4000000,  7},
+    {0xd6000000,  7}, {0xd8000000,  7}, {0xda000000,  7}, {0xdc000000,  7},
+    {0xde000000,  7}, {0xe0000000,  7}, {0xe2000000,  7}, {0xe4000000,  7},
+    {0xfc000000,  8}, {0xe6000000,  7}, {0xfd000000,  8}, {0xffd80000, 13},
+    {0xfffe0000, 19}, {0xffe00000, 13}, {0xfff00000, 14}, {0x88000000,  6},
+    {0xfffa0000, 15}, {0x18000000,  5}, {0x8c000000,  6}, {0x20000000,  5},
+    {0x90000000,  6}, {0x28000000,  5}, {0x94000000,  6}, {0x98000000,  6},
+    {0x9c000000,  6}, {0x30000000,  5}, {0xe8000000,  7}, {0xea000000,  7},
+    {0xa0000000,  6}, {0xa4000000,  6}, {0xa8000000,  6}, {0x38000000,  5},
+    {0xac000000,  6}, {0xec000000,  7}, {0xb0000000,  6}, {0x40000000,  5},
+    {0x48000000,  5}, {0xb4000000,  6}, {0xee000000,  7}, {0xf0000000,  7},
+    {0xf2000000,  7}, {0xf4000000,  7}, {0xf6000000,  7}, {0xfffc0000, 15},
+    {0xff800000, 11}, {0xfff40000, 14}, {0xffe80000, 13}, {0xffffffc0, 28},
+    {0xfffe6000, 20}, {0xffff4800, 22}, {0xfffe7000, 20}, {0xfffe8000, 20},
+    {0xffff4c00, 22}, {0xffff5000, 22}, {0xffff5400, 22}, {0xffffb200, 23},
+    {0xffff5800, 22}, {0xffffb400, 23}, {0xffffb600, 23}, {0xffffb800, 23},
+    {0xffffba00, 23}, {0xffffbc00, 23}, {0xffffeb00, 24}, {0xffffbe00, 23},
+    {0xffffec00, 24}, {0xffffed00, 24}, {0xffff5c00, 22}, {0xffffc000, 23},
+    {0xffffee00, 24}, {0xffffc200, 23}, {0xffffc400, 23}, {0xffffc600, 23},
+    {0xffffc800, 23}, {0xfffee000, 21}, {0xffff6000, 22}, {0xffffca00, 23},
+    {0xffff6400, 22}, {0xffffcc00, 23}, {0xffffce00, 23}, {0xffffef00, 24},
+    {0xffff6800, 22}, {0xfffee800, 21}, {0xfffe9000, 20}, {0xffff6c00, 22},
+    {0xffff7000, 22}, {0xffffd000, 23}, {0xffffd200, 23}, {0xfffef000, 21},
+    {0xffffd400, 23}, {0xffff7400, 22}, {0xffff7800, 22}, {0xfffff000, 24},
+    {0xfffef800, 21}, {0xffff7c00, 22}, {0xffffd600, 23}, {0xffffd800, 23},
+    {0xffff0000, 21}, {0xffff0800, 21}, {0xffff8000, 22}, {0xffff1000, 21},
+    {0xffffda00, 23}, {0xffff8400, 22}, {0xffffdc00, 23}, {0xffffde00, 23},
+    {0xfffea000, 20}, {0xffff8800, 22}, {0xffff8c00, 22}, {0xffff9000, 22},
+    {0xffffe000, 23}, {0xffff9400, 22}, {0xffff9800, 22}, {0xffffe200, 23},
+    {0xfffff800, 26}, {0xfffff840, 26}, {0xfffeb000, 20}, {0xfffe2000, 19},
+    {0xffff9c00, 22}, {0xffffe400, 23}, {0xffffa000, 22}, {0xfffff600, 25},
+    {0xfffff880, 26}, {0xfffff8c0, 26}, {0xfffff900, 26}, {0xfffffbc0, 27},
+    {0xfffffbe0, 27}, {0xfffff940, 26}, {0xfffff100, 24}, {0xfffff680, 25},
+    {0xfffe4000, 19}, {0xffff1800, 21}, {0xfffff980, 26}, {0xfffffc00, 27},
+    {0xfffffc20, 27}, {0xfffff9c0, 26}, {0xfffffc40, 27}, {0xfffff200, 24},
+    {0xffff2000, 21}, {0xffff2800, 21}, {0xfffffa00, 26}, {0xfffffa40, 26},
+    {0xffffffd0, 28}, {0xfffffc60, 27}, {0xfffffc80, 27}, {0xfffffca0, 27},
+    {0xfffec000, 20}, {0xfffff300, 24}, {0xfffed000, 20}, {0xffff3000, 21},
+    {0xffffa400, 22}, {0xffff3800, 21}, {0xffff4000, 21}, {0xffffe600, 23},
+    {0xffffa800, 22}, {0xffffac00, 22}, {0xfffff700, 25}, {0xfffff780, 25},
+    {0xfffff400, 24}, {0xfffff500, 24}, {0xfffffa80, 26}, {0xffffe800, 23},
+    {0xfffffac0, 26}, {0xfffffcc0, 27}, {0xfffffb00, 26}, {0xfffffb40, 26},
+    {0xfffffce0, 27}, {0xfffffd00, 27}, {0xfffffd20, 27}, {0xfffffd40, 27},
+    {0xfffffd60, 27}, {0xffffffe0, 28}, {0xfffffd80, 27}, {0xfffffda0, 27},
+    {0xfffffdc0, 27}, {0xfffffde0, 27}, {0xfffffe00, 27}, {0xfffffb80, 26},
+    {0xfffffffc, 30},
+};
+
+enum {
+    HuffmanMinLength = 5,
+    HuffmanMaxLength = 30,
+    HuffmanEOS = 256
+};
+
+// The HPACK code is canonical: ordering the symbols by (code length,
+// symbol) orders them by code, and the codes of one length are
+// consecutive. Decoding then only needs the first code and the number
+// of symbols of every length.
+struct QHPackHuffmanDecodeTable
+{
+    QHPackHuffmanDecodeTable();
+
+    quint32 first[HuffmanMaxLength + 1];
+    quint16 count[HuffmanMaxLength + 1];
+    quint16 offset[HuffmanMaxLength + 1];
+    quint16 symbols[257];
+};
+
+QHPackHuffmanDecodeTable::QHPackHuffmanDecodeTable()
+{
+    quint16 next = 0;
+    for (int length = 0; length <= HuffmanMaxLength; ++length) {
+        first[length] = 0;
+        count[length] = 0;
+        offset[length] = next;
+        for (int symbol = 0; symbol < 257; ++symbol) {
+            if (huffmanTable[symbol].bitLength != quint32(length))
+                continue;
+            if (!count[length])
+                first[length] = huffmanTable[symbol].code >> (32 - length);
+            ++count[length];
+            symbols[next++] = symbol;
+        }
+    }
+    Q_ASSERT(next == 257);
+}
+
+Q_GLOBAL_STATIC(QHPackHuffmanDecodeTable, huffmanDecodeTable)
+
+namespace QHPack {
+
+void encodeInteger(quint32 value, int prefixBits, uchar prefixMask, QByteArray *output)
+{
+    const quint32 maxPrefix = (1u << prefixBits) - 1;
+    if (value < maxPrefix) {
+        output->append(char(prefixMask | value));
+        return;
+    }
+    output->append(char(prefixMask | maxPrefix));
+    value -= maxPrefix;
+    while (value >= 0x80) {
+        output->append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    output->append(char(value));
+}
+
+bool decodeInteger(const uchar *&data, const uchar *end, int prefixBits, quint32 *value)
+{
+    if (data == end)
+        return false;
+    const quint32 maxPrefix = (1u << prefixBits) - 1;
+    quint64 result = *data++ & maxPrefix;
+    if (result < maxPrefix) {
+        *value = quint32(result);
+        return true;
+    }
+    for (int shift = 0; data != end && shift <= 28; shift += 7) {
+        const uchar byte = *data++;
+        result += quint64(byte & 0x7f) << shift;
+        if (result > 0xffffffffu)
+            return false;
+        if (!(byte & 0x80)) {
+            *value = quint32(result);
+            return true;
+        }
+    }
+    return false; // truncated or overlong
+}
+
+int huffmanEncodedSize(const QByteArray &input)
+{
+    quint64 bits = 0;
+    const uchar *data = reinterpret_cast<const uchar *>(input.constData());
+    for (int i = 0; i < input.size(); ++i)
+        bits += huffmanTable[data[i]].bitLength;
+    return int((bits + 7) / 8);
+}
+
+void huffmanEncode(const QByteArray &input, QByteArray *output)
+{
+    quint64 bits = 0;
+    int bitCount = 0;
+    const uchar *data = reinterpret_cast<const uchar *>(input.constData());
+    for (int i = 0; i < input.size(); ++i) {
+        const QHPackHuffmanCode &code = huffmanTable[data[i]];
+        bits = (bits << code.bitLength) | (code.code >> (32 - code.bitLength));
+        bitCount += code.bitLength;
+        while (bitCount >= 8) {
+            bitCount -= 8;
+            output->append(char(bits >> bitCount));
+        }
+        bits &= (quint64(1) << bitCount) - 1;
+    }
+    // pad with the most significant bits of EOS
+    if (bitCount)
+        output->append(char((bits << (8 - bitCount)) | (0xff >> bitCount)));
+}
+
+bool huffmanDecode(const uchar *data, int size, QByteArray *output)
+{
+    const QHPackHuffmanDecodeTable *table = huffmanDecodeTable();
+    const uchar *end = data + size;
+    quint64 bits = 0;
+    int bitCount = 0;
+
+    output->reserve(output->size() + size * 8 / HuffmanMinLength);
+    forever {
+        while (bitCount <= 56 && data != end) {
+            bits = (bits << 8) | *data++;
+            bitCount += 8;
+        }
+
+        int length = HuffmanMinLength;
+        for (; length <= HuffmanMaxLength && length <= bitCount; ++length) {
+            const quint32 code = quint32(bits >> (bitCount - length));
+            const quint32 delta = code - table->first[length];
+            if (delta < table->count[length])
+                break;
+        }
+        if (length > HuffmanMaxLength)
+            return false;
+        if (length > bitCount) {
+            // out of input: what is left must be at most 7 bits of EOS padding
+            return bitCount <= 7 && bits == (quint64(1) << bitCount) - 1;
+        }
+
+        const quint32 code = quint32(bits >> (bitCount - length));
+        const quint16 symbol = table->symbols[table->offset[length] + code - table->first[length]];
+        if (symbol == HuffmanEOS)
+            return false;
+        output->append(char(symbol));
+        bitCount -= length;
+        bits &= (quint64(1) << bitCount) - 1;
+    }
+}
+
+} // namespace QHPack
+
+QHPackTable::QHPackTable(quint32 maxSize)
+    : m_maxSize(maxSize), m_dataSize(0)
+{
+}
+
+void QHPackTable::setMaxSize(quint32 size)
+{
+    m_maxSize = size;
+    evictTo(size);
+}
+
+void QHPackTable::evictTo(quint32 size)
+{
+    while (m_dataSize > size && !m_entries.isEmpty()) {
+        const QHPackHeaderField &oldest = m_entries.last();
+        m_dataSize -= entrySize(oldest.first, oldest.second);
+        m_entries.removeLast();
+    }
+}
+
+void QHPackTable::prepend(const QByteArray &name, const QByteArray &value)
+{
+    const quint32 size = entrySize(name, value);
+    if (size > m_maxSize) {
+        // an entry larger than the table empties it (RFC 7541, 4.4)
+        m_entries.clear();
+        m_dataSize = 0;
+        return;
+    }
+    evictTo(m_maxSize - size);
+    m_entries.prepend(qMakePair(name, value));
+    m_dataSize += size;
+}
+
+bool QHPackTable::field(quint32 index, QHPackHeaderField *field) const
+{
+    if (index == 0)
+        return false;
+    if (index <= StaticTableSize) {
+        const QHPackStaticEntry &entry = staticTable[index - 1];
+        field->first = QByteArray::fromRawData(entry.name, int(qstrlen(entry.name)));
+        field->second = QByteArray::fromRawData(entry.value, int(qstrlen(entry.value)));
+        return true;
+    }
+    index -= StaticTableSize + 1;
+    if (index >= quint32(m_entries.size()))
+        return false;
+    *field = m_entries.at(index);
+    return true;
+}
+
+quint32 QHPackTable::indexOf(const QByteArray &name, const QByteArray &value, bool *valueMatches) const
+{
+    quint32 nameIndex = 0;
+    for (int i = 0; i < StaticTableSize; ++i) {
+        if (name != staticTable[i].name)
+            continue;
+        if (value == staticTable[i].value) {
+            *valueMatches = true;
+            return i + 1;
+        }
+        if (!nameIndex)
+            nameIndex = i + 1;
+    }
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const QHPackHeaderField &entry = m_entries.at(i);
+        if (entry.first != name)
+            continue;
+        if (entry.second == value) {
+            *valueMatches = true;
+            return StaticTableSize + 1 + i;
+        }
+        if (!nameIndex)
+            nameIndex = StaticTableSize + 1 + i;
+    }
+    *valueMatches = false;
+    return nameIndex;
+}
+
+QHPackEncoder::QHPackEncoder(quint32 maxTableSize, bool compressStrings)
+    : m_table(maxTableSize),
+      m_preferredTableSize(maxTableSize),
+      m_compressStrings(compressStrings),
+      m_tableSizeChanged(false)
+{
+}
+
+void QHPackEncoder::setMaxTableSize(quint32 size)
+{
+    const quint32 newSize = qMin(size, m_preferredTableSize);
+    if (newSize == m_table.maxSize())
+        return;
+    m_table.setMaxSize(newSize);
+    m_tableSizeChanged = true;
+}
+
+static bool isNeverIndexed(const QByteArray &name, const QByteArray &value)
+{
+    // keep credentials and short (guessable) cookies out of any
+    // intermediary's table, see RFC 7541, 7.1.3
+    return name == "authorization" || name == "proxy-authorization"
+            || (name == "cookie" && value.size() < 20);
+}
+
+static bool isWorthIndexing(const QByteArray &name)
+{
+    // values that change with every request would only churn the table
+    return name != ":path" && name != "content-length" && name != "range"
+            && name != "if-modified-since" && name != "if-none-match";
+}
+
+void QHPackEncoder::encode(const QHPackHeaderList &headers, QByteArray *output)
+{
+    if (m_tableSizeChanged) {
+        QHPack::encodeInteger(m_table.maxSize(), 5, 0x20, output);
+        m_tableSizeChanged = false;
+    }
+
+    for (int i = 0; i < headers.size(); ++i) {
+        const QByteArray &name = headers.at(i).first;
+        const QByteArray &value = headers.at(i).second;
+
+        bool valueMatches = false;
+        const quint32 index = m_table.indexOf(name, value, &valueMatches);
+        if (valueMatches) {
+            QHPack::encodeInteger(index, 7, 0x80, output);
+            continue;
+        }
+
+        bool addToTable = false;
+        if (isNeverIndexed(name, value)) {
+            QHPack::encodeInteger(index, 4, 0x10, output);
+        } else if (isWorthIndexing(name)
+                   && QHPackTable::entrySize(name, value) <= m_table.maxSize() / 2) {
+            QHPack::encodeInteger(index, 6, 0x40, output);
+            addToTable = true;
+        } else {
+            QHPack::encodeInteger(index, 4, 0x00, output);
+        }
+        if (!index)
+            encodeString(name, output);
+        encodeString(value, output);
+
+        if (addToTable)
+            m_table.prepend(name, value);
+    }
+}
+
+void QHPackEncoder::encodeString(const QByteArray &string, QByteArray *output)
+{
+    if (m_compressStrings) {
+        const int huffmanSize = QHPack::huffmanEncodedSize(string);
+        if (huffmanSize < string.size()) {
+            QHPack::encodeInteger(huffmanSize, 7, 0x80, output);
+            QHPack::huffmanEncode(string, output);
+            return;
+        }
+    }
+    QHPack::encodeInteger(string.size(), 7, 0x00, output);
+    output->append(string);
+}
+
+QHPackDecoder::QHPackDecoder(quint32 maxTableSize)
+    : m_table(maxTableSize),
+      m_maxTableSizeLimit(maxTableSize),
+      m_maxHeaderListSize(0xffffffff) // unlimited, as for a peer that sets nothing
+{
+}
+
+static bool decodeString(const uchar *&data, const uchar *end, QByteArray *output)
+{
+    if (data == end)
+        return false;
+    const bool huffman = *data & 0x80;
+    quint32 length = 0;
+    if (!QHPack::decodeInteger(data, end, 7, &length) || length > quint32(end - data))
+        return false;
+    output->clear();
+    bool ok = true;
+    if (huffman)
+        ok = QHPack::huffmanDecode(data, int(length), output);
+    else
+        output->append(reinterpret_cast<const char *>(data), int(length));
+    data += length;
+    return ok;
+}
+
+bool QHPackDecoder::decode(const QByteArray &headerBlock, QHPackHeaderList *headers, bool *listTooLarge)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(headerBlock.constData());
+    const uchar *end = data + headerBlock.size();
+    bool fieldSeen = false;
+    // counted as in SETTINGS_MAX_HEADER_LIST_SIZE, with the same overhead
+    // per field as the table entries; indexed fields make a small block
+    // expand to a large list
+    quint64 listSize = 0;
+    if (listTooLarge)
+        *listTooLarge = false;
+
+    while (data != end) {
+        const uchar byte = *data;
+        if (byte & 0x80) {
+            // indexed header field
+            quint32 index = 0;
+            QHPackHeaderField field;
+            if (!QHPack::decodeInteger(data, end, 7, &index) || !m_table.field(index, &field))
+                return false;
+            listSize += QHPackTable::entrySize(field.first, field.second);
+            if (listSize > m_maxHeaderListSize) {
+                if (listTooLarge)
+                    *listTooLarge = true;
+                return false;
+            }
+            headers->append(field);
+            fieldSeen = true;
+        } else if ((byte & 0xe0) == 0x20) {
+            // dynamic table size update, only allowed at the start of a block
+            quint32 size = 0;
+            if (fieldSeen || !QHPack::decodeInteger(data, end, 5, &size)
+                    || size > m_maxTableSizeLimit) {
+                return false;
+            }
+            m_table.setMaxSize(size);
+        } else {
+            // literal header field: with incremental indexing (01xxxxxx),
+            // without indexing (0000xxxx) or never indexed (0001xxxx)
+            const bool addToTable = byte & 0x40;
+            quint32 nameIndex = 0;
+            if (!QHPack::decodeInteger(data, end, addToTable ? 6 : 4, &nameIndex))
+                return false;
+            QHPackHeaderField field;
+            if (nameIndex) {
+                if (!m_table.field(nameIndex, &field))
+                    return false;
+            } else if (!decodeString(data, end, &field.first)) {
+                return false;
+            }
+            if (!decodeString(data, end, &field.second))
+                return false;
+            listSize += QHPackTable::entrySize(field.first, field.second);
+            if (listSize > m_maxHeaderListSize) {
+                if (listTooLarge)
+                    *listTooLarge = true;
+                return false;
+            }
+            if (addToTable)
+                m_table.prepend(field.first, field.second);
+            headers->append(field);
+            fieldSeen = true;
+        }
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_HTTP
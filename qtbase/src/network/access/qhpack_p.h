@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QHPACK_P_H
+#define QHPACK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qvector.h>
+
+#ifndef QT_NO_HTTP
+
+QT_BEGIN_NAMESPACE
+
+// HPACK header compression for HTTP/2 (RFC 7541)
+
+typedef QPair<QByteArray, QByteArray> QHPackHeaderField;
+typedef QVector<QHPackHeaderField> QHPackHeaderList;
+
+class Q_AUTOTEST_EXPORT QHPackTable
+{
+public:
+    enum {
+        DefaultMaxSize = 4096,
+        StaticTableSize = 61,
+        EntryOverhead = 32
+    };
+
+    explicit QHPackTable(quint32 maxSize = DefaultMaxSize);
+
+    quint32 maxSize() const { return m_maxSize; }
+    quint32 dataSize() const { return m_dataSize; }
+    int dynamicCount() const { return m_entries.size(); }
+    void setMaxSize(quint32 size);
+
+    void prepend(const QByteArray &name, const QByteArray &value);
+
+    // indexes are 1-based and span the static table followed by the dynamic one
+    bool field(quint32 index, QHPackHeaderField *field) const;
+    quint32 indexOf(const QByteArray &name, const QByteArray &value, bool *valueMatches) const;
+
+    static quint32 entrySize(const QByteArray &name, const QByteArray &value)
+    { return quint32(name.size() + value.size()) + EntryOverhead; }
+
+private:
+    void evictTo(quint32 size);
+
+    QList<QHPackHeaderField> m_entries; // newest first
+    quint32 m_maxSize;
+    quint32 m_dataSize;
+};
+
+class Q_AUTOTEST_EXPORT QHPackEncoder
+{
+public:
+    explicit QHPackEncoder(quint32 maxTableSize = QHPackTable::DefaultMaxSize,
+                           bool compressStrings = true);
+
+    // applies SETTINGS_HEADER_TABLE_SIZE from the peer; the size update
+    // is signalled at the start of the next header block
+    void setMaxTableSize(quint32 size);
+
+    void encode(const QHPackHeaderList &headers, QByteArray *output);
+
+private:
+    void encodeString(const QByteArray &string, QByteArray *output);
+
+    QHPackTable m_table;
+    quint32 m_preferredTableSize;
+    bool m_compressStrings;
+    bool m_tableSizeChanged;
+};
+
+class Q_AUTOTEST_EXPORT QHPackDecoder
+{
+public:
+    explicit QHPackDecoder(quint32 maxTableSize = QHPackTable::DefaultMaxSize);
+
+    // our own SETTINGS_HEADER_TABLE_SIZE, the upper bound for size updates
+    void setMaxTableSize(quint32 size) { m_maxTableSizeLimit = size; }
+
+    // our own SETTINGS_MAX_HEADER_LIST_SIZE; decoding stops, and sets
+    // *listTooLarge, once the fields of a block add up to more
+    quint32 maxHeaderListSize() const { return m_maxHeaderListSize; }
+    void setMaxHeaderListSize(quint32 size) { m_maxHeaderListSize = size; }
+
+    bool decode(const QByteArray &headerBlock, QHPackHeaderList *headers, bool *listTooLarge = 0);
+
+private:
+    QHPackTable m_table;
+    quint32 m_maxTableSizeLimit;
+    quint32 m_maxHeaderListSize;
+};
+
+namespace QHPack {
+    Q_AUTOTEST_EXPORT void encodeInteger(quint32 value, int prefixBits, uchar prefixMask, QByteArray *output);
+    Q_AUTOTEST_EXPORT bool decodeInteger(const uchar *&data, const uchar *end, int prefixBits, quint32 *value);
+    Q_AUTOTEST_EXPORT int huffmanEncodedSize(const QByteArray &input);
+    Q_AUTOTEST_EXPORT void huffmanEncode(const QByteArray &input, QByteArray *output);
+    Q_AUTOTEST_EXPORT bool huffmanDecode(const uchar *data, int size, QByteArray *output);
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_HTTP
+
+#endif // QHPACK_P_H
@@ -0,0 +1,1056 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <private/qhttp2protocolhandler_p.h>
+#include <private/qnoncontiguousbytedevice_p.h>
+#include <private/qhttpnetworkconnectionchannel_p.h>
+#include <QtCore/QtEndian>
+
+#ifndef QT_NO_SSL
+#include <QtNetwork/qsslsocket.h>
+#endif
+
+#ifndef QT_NO_HTTP
+
+QT_BEGIN_NAMESPACE
+
+static const char connectionPreface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+static quint32 fourBytesToInt(const char *bytes)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(bytes));
+}
+
+static void appendIntToFourBytes(char *output, quint32 number)
+{
+    qToBigEndian<quint32>(number, reinterpret_cast<uchar *>(output));
+}
+
+static bool stripPadding(bool padded, QByteArray *payload)
+{
+    if (!padded)
+        return true;
+    if (payload->isEmpty())
+        return false;
+    const int padLength = uchar(payload->at(0));
+    if (padLength >= payload->size())
+        return false;
+    *payload = payload->mid(1, payload->size() - 1 - padLength);
+    return true;
+}
+
+static QNetworkReply::NetworkError errorCodeToNetworkError(quint32 errorCode, const char **errorMessage)
+{
+    switch (errorCode) {
+    case 0x1: // PROTOCOL_ERROR
+        *errorMessage = "HTTP/2 protocol error";
+        return QNetworkReply::ProtocolFailure;
+    case 0x2: // INTERNAL_ERROR
+        *errorMessage = "Internal server error";
+        return QNetworkReply::InternalServerError;
+    case 0x3: // FLOW_CONTROL_ERROR
+        *errorMessage = "peer violated the flow control protocol";
+        return QNetworkReply::ProtocolFailure;
+    case 0x5: // STREAM_CLOSED
+        *errorMessage = "server received a frame for an already half-closed stream";
+        return QNetworkReply::ProtocolFailure;
+    case 0x6: // FRAME_SIZE_ERROR
+        *errorMessage = "server cannot process the frame because of its size";
+        return QNetworkReply::ProtocolFailure;
+    case 0x7: // REFUSED_STREAM
+        *errorMessage = "HTTP/2 stream was refused";
+        return QNetworkReply::ProtocolFailure;
+    case 0x8: // CANCEL
+        *errorMessage = "HTTP/2 stream is no longer needed";
+        return QNetworkReply::ProtocolFailure;
+    case 0x9: // COMPRESSION_ERROR
+        *errorMessage = "HTTP/2 header compression state could not be maintained";
+        return QNetworkReply::ProtocolFailure;
+    case 0xb: // ENHANCE_YOUR_CALM
+        *errorMessage = "server is limiting the load generated by this client";
+        return QNetworkReply::ServiceUnavailableError;
+    case 0xc: // INADEQUATE_SECURITY
+        *errorMessage = "server requires stronger transport security";
+        return QNetworkReply::SslHandshakeFailedError;
+    case 0xd: // HTTP_1_1_REQUIRED
+        *errorMessage = "server requires HTTP/1.1 for this request";
+        return QNetworkReply::ProtocolFailure;
+    default:
+        *errorMessage = "got HTTP/2 error code unknown to the client";
+        return QNetworkReply::ProtocolUnknownError;
+    }
+}
+
+QHttp2ProtocolHandler::QHttp2ProtocolHandler(QHttpNetworkConnectionChannel *channel)
+    : QObject(0), QAbstractProtocolHandler(channel),
+      m_nextStreamID(1),
+      m_maxConcurrentStreams(100), // unlimited until the server says otherwise, 100 is recommended
+      m_initialSendWindow(DefaultWindowSize),
+      m_maxFrameSize(DefaultMaxFrameSize),
+      m_maxHeaderListSize(0xffffffff), // unlimited until the server says otherwise
+      m_sessionSendWindow(DefaultWindowSize),
+      m_sessionRecvWindow(DefaultWindowSize),
+      m_readOffset(0),
+      m_headerBlockStreamID(0),
+      m_headerBlockEndStream(false),
+      m_sessionStarted(false),
+      m_goingAway(false)
+{
+    m_decoder.setMaxHeaderListSize(MaxHeaderListSize);
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(_q_socketDisconnected()));
+
+    // over TLS the handler is created once ALPN picked "h2", for cleartext
+    // connections once the socket is connected; either way the connection
+    // preface goes out before anything else
+    if (m_socket->state() == QAbstractSocket::ConnectedState) {
+#ifndef QT_NO_SSL
+        QSslSocket *sslSocket = qobject_cast<QSslSocket *>(m_socket);
+        if (sslSocket && !sslSocket->isEncrypted())
+            return;
+#endif
+        startSession();
+    }
+}
+
+QHttp2ProtocolHandler::~QHttp2ProtocolHandler()
+{
+}
+
+void QHttp2ProtocolHandler::startSession()
+{
+    if (m_sessionStarted)
+        return;
+    m_sessionStarted = true;
+
+    m_socket->write(connectionPreface, sizeof(connectionPreface) - 1);
+
+    // we never accept pushed streams, open up the stream windows right away
+    // and limit the size of the response headers
+    char settings[18];
+    qToBigEndian<quint16>(SETTINGS_ENABLE_PUSH, reinterpret_cast<uchar *>(settings));
+    appendIntToFourBytes(settings + 2, 0);
+    qToBigEndian<quint16>(SETTINGS_INITIAL_WINDOW_SIZE, reinterpret_cast<uchar *>(settings + 6));
+    appendIntToFourBytes(settings + 8, StreamReceiveWindow);
+    qToBigEndian<quint16>(SETTINGS_MAX_HEADER_LIST_SIZE, reinterpret_cast<uchar *>(settings + 12));
+    appendIntToFourBytes(settings + 14, MaxHeaderListSize);
+    sendFrame(FrameType_SETTINGS, 0, 0, settings, sizeof(settings));
+
+    // the session window can only be changed with WINDOW_UPDATE
+    sendWINDOW_UPDATE(0, SessionReceiveWindow - DefaultWindowSize);
+    m_sessionRecvWindow = SessionReceiveWindow;
+}
+
+bool QHttp2ProtocolHandler::sendRequest()
+{
+    Q_ASSERT(!m_reply);
+
+    if (m_goingAway)
+        return true; // the requests will be sent on the next connection
+
+    startSession();
+
+    m_channel->state = QHttpNetworkConnectionChannel::WritingState;
+
+    QMultiMap<int, HttpMessagePair>::iterator it = m_channel->spdyRequestsToSend.begin();
+    // requests will be ordered by priority (see QMultiMap doc)
+    while (it != m_channel->spdyRequestsToSend.end()
+           && quint32(m_inFlightStreams.count()) < m_maxConcurrentStreams) {
+        HttpMessagePair currentPair = *it;
+        it = m_channel->spdyRequestsToSend.erase(it);
+        QHttpNetworkRequest currentRequest = currentPair.first;
+        QHttpNetworkReply *currentReply = currentPair.second;
+
+        const QString scheme = currentRequest.url().scheme();
+        if (scheme == QLatin1String("preconnect-http")
+            || scheme == QLatin1String("preconnect-https")) {
+            // we have a working session and are done
+            currentReply->d_func()->state = QHttpNetworkReplyPrivate::AllDoneState;
+            m_connection->preConnectFinished(); // will only decrease the counter
+            emit currentReply->finished();
+            continue;
+        }
+
+        currentReply->setHttp2WasUsed(true);
+        const quint32 streamID = generateNextStreamID();
+        currentReply->setProperty("HTTP2StreamID", streamID);
+
+        currentReply->setRequest(currentRequest);
+        currentReply->d_func()->connection = m_connection;
+        currentReply->d_func()->connectionChannel = m_channel;
+
+        Stream stream;
+        stream.pair = currentPair;
+        stream.sendWindow = m_initialSendWindow;
+        stream.recvWindow = StreamReceiveWindow;
+        m_inFlightStreams.insert(streamID, stream);
+        connect(currentReply, SIGNAL(destroyed(QObject*)), this, SLOT(_q_replyDestroyed(QObject*)));
+
+        m_channel->recordRequestStart(currentReply, QByteArrayLiteral("h2"));
+        sendHEADERS(currentPair, streamID);
+    }
+    m_channel->state = QHttpNetworkConnectionChannel::IdleState;
+    return true;
+}
+
+void QHttp2ProtocolHandler::_q_replyDestroyed(QObject* reply)
+{
+    quint32 streamID = reply->property("HTTP2StreamID").toUInt();
+    if (m_inFlightStreams.remove(streamID)) {
+        sendRST_STREAM(streamID, ErrorCode_CANCEL);
+        if (!m_channel->spdyRequestsToSend.isEmpty())
+            sendRequest();
+    }
+}
+
+void QHttp2ProtocolHandler::_q_socketDisconnected()
+{
+    m_readBuffer.clear();
+    m_readOffset = 0;
+    m_headerBlock.clear();
+    m_headerBlockStreamID = 0;
+    m_goingAway = true;
+    finishAllStreams(QNetworkReply::RemoteHostClosedError, "Connection closed");
+}
+
+void QHttp2ProtocolHandler::_q_receiveReply()
+{
+    Q_ASSERT(m_socket);
+
+    // only run when the QHttpNetworkConnection is not currently being destructed, e.g.
+    // this function is called from _q_disconnected which is called because
+    // of ~QHttpNetworkConnectionPrivate
+    if (!qobject_cast<QHttpNetworkConnection*>(m_connection)) {
+        return;
+    }
+
+    startSession();
+
+    m_readBuffer.append(m_socket->readAll());
+
+    while (m_socket->state() == QAbstractSocket::ConnectedState) {
+        const int available = m_readBuffer.size() - m_readOffset;
+        if (available < FrameHeaderSize)
+            break;
+
+        const uchar *header = reinterpret_cast<const uchar *>(m_readBuffer.constData()) + m_readOffset;
+        const quint32 length = (quint32(header[0]) << 16) | (quint32(header[1]) << 8) | header[2];
+        if (length > DefaultMaxFrameSize) {
+            // we never announce a larger SETTINGS_MAX_FRAME_SIZE
+            connectionError(ErrorCode_FRAME_SIZE_ERROR, "server sent a frame that is too large");
+            break;
+        }
+        if (quint32(available) < FrameHeaderSize + length)
+            break; // wait for the rest of the frame
+
+        const FrameType type = static_cast<FrameType>(header[3]);
+        const uchar flags = header[4];
+        const quint32 streamID = fourBytesToInt(reinterpret_cast<const char *>(header) + 5) & 0x7fffffff;
+        // handling the frame emits signals, so do not keep pointers into the buffer
+        const QByteArray payload = m_readBuffer.mid(m_readOffset + FrameHeaderSize, length);
+        m_readOffset += FrameHeaderSize + length;
+
+        handleFrame(type, flags, streamID, payload);
+    }
+
+    if (m_readOffset > 0) {
+        m_readBuffer.remove(0, qMin(m_readOffset, m_readBuffer.size()));
+        m_readOffset = 0;
+    }
+
+    // finished streams make room for the requests still waiting
+    if (!m_goingAway && !m_channel->spdyRequestsToSend.isEmpty()
+        && m_socket->state() == QAbstractSocket::ConnectedState)
+        sendRequest();
+}
+
+void QHttp2ProtocolHandler::_q_readyRead()
+{
+    _q_receiveReply();
+}
+
+QHPackHeaderList QHttp2ProtocolHandler::composeHeader(const QHttpNetworkRequest &request)
+{
+    const QList<QPair<QByteArray, QByteArray> > fields = request.header();
+
+    QHPackHeaderList headers;
+    headers.reserve(fields.count() + 4);
+
+    // pseudo-header fields must come first
+    headers.append(qMakePair(QByteArray(":method"), request.methodName()));
+    headers.append(qMakePair(QByteArray(":scheme"), request.url().scheme().toLatin1()));
+    headers.append(qMakePair(QByteArray(":authority"),
+                             request.url().authority(QUrl::FullyEncoded | QUrl::RemoveUserInfo).toLatin1()));
+    headers.append(qMakePair(QByteArray(":path"), request.uri(false)));
+
+    for (int a = 0; a < fields.count(); ++a) {
+        const QByteArray name = fields.at(a).first.toLower();
+        // connection-specific header fields are not valid (RFC 7540, section 8.1.2.2);
+        // the host is carried in :authority
+        if (name == "connection" || name == "host" || name == "keep-alive"
+                || name == "proxy-connection" || name == "transfer-encoding"
+                || name == "upgrade")
+            continue;
+        if (name == "te" && fields.at(a).second.toLower() != "trailers")
+            continue;
+        headers.append(qMakePair(name, fields.at(a).second));
+    }
+    return headers;
+}
+
+void QHttp2ProtocolHandler::sendFrame(FrameType type, uchar flags, quint32 streamID,
+                                      const char *data, quint32 length)
+{
+    Q_ASSERT(m_socket);
+    Q_ASSERT(length <= MaxFrameSizeLimit);
+
+    char header[FrameHeaderSize];
+    header[0] = char(length >> 16);
+    header[1] = char(length >> 8);
+    header[2] = char(length);
+    header[3] = char(type);
+    header[4] = char(flags);
+    appendIntToFourBytes(header + 5, streamID & 0x7fffffff);
+
+    m_socket->write(header, FrameHeaderSize);
+    if (length)
+        m_socket->write(data, length);
+}
+
+void QHttp2ProtocolHandler::sendSETTINGS_ACK()
+{
+    sendFrame(FrameType_SETTINGS, FrameFlag_ACK, 0, 0, 0);
+}
+
+void QHttp2ProtocolHandler::sendRST_STREAM(quint32 streamID, ErrorCode errorCode)
+{
+    char wireData[4];
+    appendIntToFourBytes(wireData, errorCode);
+    sendFrame(FrameType_RST_STREAM, 0, streamID, wireData, sizeof(wireData));
+}
+
+void QHttp2ProtocolHandler::sendGOAWAY(ErrorCode errorCode)
+{
+    // we never accept streams initiated by the server
+    char wireData[8];
+    appendIntToFourBytes(wireData, 0);
+    appendIntToFourBytes(wireData + 4, errorCode);
+    sendFrame(FrameType_GOAWAY, 0, 0, wireData, sizeof(wireData));
+}
+
+void QHttp2ProtocolHandler::sendWINDOW_UPDATE(quint32 streamID, quint32 delta)
+{
+    char wireData[4];
+    appendIntToFourBytes(wireData, delta & 0x7fffffff);
+    sendFrame(FrameType_WINDOW_UPDATE, 0, streamID, wireData, sizeof(wireData));
+}
+
+void QHttp2ProtocolHandler::sendHEADERS(const HttpMessagePair &pair, quint32 streamID)
+{
+    QHttpNetworkRequest request = pair.first;
+    QHttpNetworkReply *reply = pair.second;
+
+    // the server would only reject headers larger than it announced; the
+    // stream is never opened, so the encoder's table stays in sync
+    const QHPackHeaderList headers = composeHeader(request);
+    quint64 headerListSize = 0;
+    for (int i = 0; i < headers.size(); ++i)
+        headerListSize += QHPackTable::entrySize(headers.at(i).first, headers.at(i).second);
+    if (headerListSize > m_maxHeaderListSize) {
+        replyFinishedWithError(reply, streamID, QNetworkReply::ProtocolFailure,
+                               "request headers are larger than the server accepts");
+        return;
+    }
+
+    uchar flags = FrameFlag_PRIORITY;
+
+    if (!request.uploadByteDevice()) {
+        // no upload -> this is the last frame, send the END_STREAM flag
+        flags |= FrameFlag_END_STREAM;
+        reply->d_func()->state = QHttpNetworkReplyPrivate::SPDYHalfClosed;
+    } else {
+        reply->d_func()->state = QHttpNetworkReplyPrivate::SPDYUploading;
+
+        // set the stream ID on the device directly, so when we get
+        // the signal for uploading we know which stream we are sending on
+        request.uploadByteDevice()->setProperty("HTTP2StreamID", streamID);
+
+        QObject::connect(request.uploadByteDevice(), SIGNAL(readyRead()), this,
+                         SLOT(_q_uploadDataReadyRead()), Qt::QueuedConnection);
+    }
+
+    // exclusive flag and stream dependency (none), then the weight minus one
+    QByteArray block(5, 0);
+    switch (request.priority()) {
+    case QHttpNetworkRequest::HighPriority:
+        block[4] = char(255);
+        break;
+    case QHttpNetworkRequest::NormalPriority:
+        block[4] = char(15); // the default weight of 16
+        break;
+    case QHttpNetworkRequest::LowPriority:
+        block[4] = char(0);
+        break;
+    }
+    m_encoder.encode(headers, &block);
+
+    // header blocks larger than a frame continue in CONTINUATION frames,
+    // which must follow the HEADERS frame without anything in between
+    QNetworkReplyMetricsPrivate *metrics = reply->d_func()->metricsData();
+    const char *data = block.constData();
+    quint32 remaining = block.size();
+    quint32 chunk = qMin(remaining, m_maxFrameSize);
+    if (chunk == remaining)
+        flags |= FrameFlag_END_HEADERS;
+    sendFrame(FrameType_HEADERS, flags, streamID, data, chunk);
+    metrics->bytesSent += FrameHeaderSize + chunk;
+    data += chunk;
+    remaining -= chunk;
+    while (remaining > 0) {
+        chunk = qMin(remaining, m_maxFrameSize);
+        remaining -= chunk;
+        sendFrame(FrameType_CONTINUATION, remaining ? 0 : FrameFlag_END_HEADERS,
+                  streamID, data, chunk);
+        metrics->bytesSent += FrameHeaderSize + chunk;
+        data += chunk;
+    }
+
+    if (reply->d_func()->state == QHttpNetworkReplyPrivate::SPDYUploading)
+        uploadData(streamID);
+}
+
+bool QHttp2ProtocolHandler::uploadData(quint32 streamID)
+{
+    QHash<quint32, Stream>::iterator it = m_inFlightStreams.find(streamID);
+    if (it == m_inFlightStreams.end())
+        return false;
+
+    QHttpNetworkRequest request = it->pair.first;
+    QHttpNetworkReply *reply = it->pair.second;
+    Q_ASSERT(reply);
+    QHttpNetworkReplyPrivate *replyPrivate = reply->d_func();
+
+    if (replyPrivate->state != QHttpNetworkReplyPrivate::SPDYUploading)
+        return false;
+
+    QNonContiguousByteDevice *device = request.uploadByteDevice();
+    bool wroteData = false;
+
+    // both the stream and the session window limit what we may send
+    while (!device->atEnd()) {
+        const qint64 allowed = qMin(qMin(it->sendWindow, m_sessionSendWindow), qint32(m_maxFrameSize));
+        if (allowed <= 0)
+            break; // wait for WINDOW_UPDATE
+
+        qint64 currentReadSize = 0;
+        const char *readPointer = device->readPointer(allowed, currentReadSize);
+
+        if (currentReadSize == -1) {
+            // premature eof happened
+            sendRST_STREAM(streamID, ErrorCode_CANCEL);
+            replyFinishedWithError(reply, streamID, QNetworkReply::UnknownNetworkError,
+                                   "upload data ended prematurely");
+            return false;
+        } else if (readPointer == 0 || currentReadSize == 0) {
+            // nothing to read currently, break the loop
+            break;
+        }
+
+        sendFrame(FrameType_DATA, 0, streamID, readPointer, currentReadSize);
+        it->sendWindow -= currentReadSize;
+        m_sessionSendWindow -= currentReadSize;
+        replyPrivate->totallyUploadedData += currentReadSize;
+        replyPrivate->metricsData()->bytesSent += FrameHeaderSize + currentReadSize;
+        device->advanceReadPointer(currentReadSize);
+        wroteData = true;
+    }
+
+    if (device->atEnd()) {
+        sendFrame(FrameType_DATA, FrameFlag_END_STREAM, streamID, 0, 0);
+        replyPrivate->metricsData()->bytesSent += FrameHeaderSize;
+        replyPrivate->state = QHttpNetworkReplyPrivate::SPDYHalfClosed;
+        device->disconnect(this);
+    }
+
+    if (wroteData)
+        emit reply->dataSendProgress(replyPrivate->totallyUploadedData, request.contentLength());
+    return true;
+}
+
+void QHttp2ProtocolHandler::resumeUploads()
+{
+    const QList<quint32> streamIDs = m_inFlightStreams.keys();
+    for (int a = 0; a < streamIDs.count(); ++a) {
+        if (m_sessionSendWindow <= 0)
+            break;
+        QHash<quint32, Stream>::const_iterator it = m_inFlightStreams.constFind(streamIDs.at(a));
+        if (it != m_inFlightStreams.constEnd()
+            && it->pair.second->d_func()->state == QHttpNetworkReplyPrivate::SPDYUploading)
+            uploadData(streamIDs.at(a));
+    }
+}
+
+void QHttp2ProtocolHandler::_q_uploadDataReadyRead()
+{
+    QNonContiguousByteDevice *device = qobject_cast<QNonContiguousByteDevice *>(sender());
+    Q_ASSERT(device);
+    quint32 streamID = device->property("HTTP2StreamID").toUInt();
+    Q_ASSERT(streamID > 0);
+    uploadData(streamID);
+}
+
+void QHttp2ProtocolHandler::handleFrame(FrameType type, uchar flags, quint32 streamID,
+                                        const QByteArray &payload)
+{
+    // a header block must not be interleaved with any other frame
+    if (m_headerBlockStreamID && type != FrameType_CONTINUATION) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "header block was interrupted");
+        return;
+    }
+
+    switch (type) {
+    case FrameType_DATA:
+        handleDATA(flags, streamID, payload);
+        break;
+    case FrameType_HEADERS:
+        handleHEADERS(flags, streamID, payload);
+        break;
+    case FrameType_PRIORITY:
+        // we do not act on priorities of the server
+        if (payload.size() != 5)
+            connectionError(ErrorCode_FRAME_SIZE_ERROR, "got PRIORITY frame with invalid size");
+        break;
+    case FrameType_RST_STREAM:
+        handleRST_STREAM(streamID, payload);
+        break;
+    case FrameType_SETTINGS:
+        handleSETTINGS(flags, streamID, payload);
+        break;
+    case FrameType_PUSH_PROMISE:
+        connectionError(ErrorCode_PROTOCOL_ERROR, "server push was disabled");
+        break;
+    case FrameType_PING:
+        handlePING(flags, streamID, payload);
+        break;
+    case FrameType_GOAWAY:
+        handleGOAWAY(streamID, payload);
+        break;
+    case FrameType_WINDOW_UPDATE:
+        handleWINDOW_UPDATE(streamID, payload);
+        break;
+    case FrameType_CONTINUATION:
+        handleCONTINUATION(flags, streamID, payload);
+        break;
+    default:
+        // frames of unknown types must be ignored
+        break;
+    }
+}
+
+void QHttp2ProtocolHandler::handleDATA(uchar flags, quint32 streamID, const QByteArray &payload)
+{
+    if (streamID == 0) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got DATA frame on stream 0");
+        return;
+    }
+
+    // flow control covers the whole frame including the padding
+    const qint32 frameLength = payload.size();
+    m_sessionRecvWindow -= frameLength;
+    if (m_sessionRecvWindow < 0) {
+        connectionError(ErrorCode_FLOW_CONTROL_ERROR, "server exceeded the session window");
+        return;
+    }
+    if (m_sessionRecvWindow < SessionReceiveWindow / 2) {
+        sendWINDOW_UPDATE(0, SessionReceiveWindow - m_sessionRecvWindow);
+        m_sessionRecvWindow = SessionReceiveWindow;
+    }
+
+    QHash<quint32, Stream>::iterator it = m_inFlightStreams.find(streamID);
+    if (it == m_inFlightStreams.end()) {
+        // frames for streams we have reset may still be in flight
+        if (streamID >= m_nextStreamID)
+            connectionError(ErrorCode_PROTOCOL_ERROR, "got DATA frame on an idle stream");
+        return;
+    }
+
+    QHttpNetworkRequest httpRequest = it->pair.first;
+    QHttpNetworkReply *httpReply = it->pair.second;
+    Q_ASSERT(httpReply != 0);
+    QHttpNetworkReplyPrivate *replyPrivate = httpReply->d_func();
+    replyPrivate->metricsData()->bytesReceived += FrameHeaderSize + frameLength;
+
+    if (!it->headersReceived) {
+        sendRST_STREAM(streamID, ErrorCode_PROTOCOL_ERROR);
+        replyFinishedWithError(httpReply, streamID, QNetworkReply::ProtocolFailure,
+                               "got DATA frame before the response headers");
+        return;
+    }
+
+    it->recvWindow -= frameLength;
+    if (it->recvWindow < 0) {
+        sendRST_STREAM(streamID, ErrorCode_FLOW_CONTROL_ERROR);
+        replyFinishedWithError(httpReply, streamID, QNetworkReply::ProtocolFailure,
+                               "server exceeded the stream window");
+        return;
+    }
+
+    const bool endStream = flags & FrameFlag_END_STREAM;
+    if (!endStream && it->recvWindow < StreamReceiveWindow / 2) {
+        sendWINDOW_UPDATE(streamID, StreamReceiveWindow - it->recvWindow);
+        it->recvWindow = StreamReceiveWindow;
+    }
+
+    QByteArray data = payload;
+    if (!stripPadding(flags & FrameFlag_PADDED, &data)) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got DATA frame with invalid padding");
+        return;
+    }
+
+    if (!data.isEmpty()) {
+        replyPrivate->compressedData.append(data);
+        replyPrivate->totalProgress += data.size();
+
+        if (httpRequest.d->autoDecompress && replyPrivate->isCompressed()) {
+            QByteDataBuffer inDataBuffer;
+            inDataBuffer.append(data);
+            qint64 compressedCount = replyPrivate->uncompressBodyData(&inDataBuffer,
+                                                                      &replyPrivate->responseData);
+            Q_ASSERT(compressedCount >= 0);
+            Q_UNUSED(compressedCount); // silence -Wunused-variable
+        } else {
+            replyPrivate->responseData.append(data);
+        }
+
+        if (replyPrivate->shouldEmitSignals()) {
+            emit httpReply->readyRead();
+            emit httpReply->dataReadProgress(replyPrivate->totalProgress, replyPrivate->bodyLength);
+        }
+    }
+
+    // the reply might have been destroyed by a slot connected to the signals above
+    if (endStream && m_inFlightStreams.contains(streamID))
+        replyFinished(httpReply, streamID);
+}
+
+void QHttp2ProtocolHandler::handleHEADERS(uchar flags, quint32 streamID, const QByteArray &payload)
+{
+    if (streamID == 0) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got HEADERS frame on stream 0");
+        return;
+    }
+
+    QByteArray block = payload;
+    if (!stripPadding(flags & FrameFlag_PADDED, &block)) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got HEADERS frame with invalid padding");
+        return;
+    }
+    if (flags & FrameFlag_PRIORITY) {
+        if (block.size() < 5) {
+            connectionError(ErrorCode_FRAME_SIZE_ERROR, "got HEADERS frame with invalid size");
+            return;
+        }
+        block.remove(0, 5);
+    }
+    // a header block is at most as large as the header list it encodes
+    if (block.size() > MaxHeaderListSize) {
+        connectionError(ErrorCode_ENHANCE_YOUR_CALM, "header block is too large");
+        return;
+    }
+
+    m_headerBlock = block;
+    m_headerBlockStreamID = streamID;
+    m_headerBlockEndStream = flags & FrameFlag_END_STREAM;
+
+    if (flags & FrameFlag_END_HEADERS)
+        parseHeaderBlock(streamID, m_headerBlockEndStream);
+}
+
+void QHttp2ProtocolHandler::handleCONTINUATION(uchar flags, quint32 streamID, const QByteArray &payload)
+{
+    if (!m_headerBlockStreamID || streamID != m_headerBlockStreamID) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got unexpected CONTINUATION frame");
+        return;
+    }
+
+    if (m_headerBlock.size() + payload.size() > MaxHeaderListSize) {
+        connectionError(ErrorCode_ENHANCE_YOUR_CALM, "header block is too large");
+        return;
+    }
+    m_headerBlock.append(payload);
+    if (flags & FrameFlag_END_HEADERS)
+        parseHeaderBlock(streamID, m_headerBlockEndStream);
+}
+
+void QHttp2ProtocolHandler::parseHeaderBlock(quint32 streamID, bool endStream)
+{
+    const QByteArray block = m_headerBlock;
+    m_headerBlock.clear();
+    m_headerBlockStreamID = 0;
+
+    // the block must be decoded even for streams we have reset,
+    // otherwise the dynamic table goes out of sync with the server
+    QHPackHeaderList headers;
+    bool listTooLarge = false;
+    if (!m_decoder.decode(block, &headers, &listTooLarge)) {
+        if (listTooLarge)
+            connectionError(ErrorCode_ENHANCE_YOUR_CALM, "header list is too large");
+        else
+            connectionError(ErrorCode_COMPRESSION_ERROR, "could not decode header block");
+        return;
+    }
+
+    QHash<quint32, Stream>::iterator it = m_inFlightStreams.find(streamID);
+    if (it == m_inFlightStreams.end()) {
+        if (streamID >= m_nextStreamID)
+            connectionError(ErrorCode_PROTOCOL_ERROR, "got HEADERS frame on an idle stream");
+        return;
+    }
+
+    QHttpNetworkReply *httpReply = it->pair.second;
+    Q_ASSERT(httpReply != 0);
+    QHttpNetworkReplyPrivate *replyPrivate = httpReply->d_func();
+    QNetworkReplyMetricsPrivate *metrics = replyPrivate->metricsData();
+    if (metrics->responseStart < 0)
+        metrics->responseStart = QNetworkReplyMetricsPrivate::now();
+    metrics->bytesReceived += FrameHeaderSize + block.size();
+
+    if (it->headersReceived) {
+        // trailers; pseudo-header fields are not allowed here
+        for (int a = 0; a < headers.size(); ++a) {
+            if (!headers.at(a).first.startsWith(':'))
+                replyPrivate->fields.append(headers.at(a));
+        }
+    } else {
+        int statusCode = 0;
+        for (int a = 0; a < headers.size(); ++a) {
+            if (headers.at(a).first == ":status") {
+                statusCode = headers.at(a).second.toInt();
+                break;
+            }
+        }
+        if (statusCode < 100 || statusCode > 999) {
+            sendRST_STREAM(streamID, ErrorCode_PROTOCOL_ERROR);
+            replyFinishedWithError(httpReply, streamID, QNetworkReply::ProtocolFailure,
+                                   "got response without a valid :status");
+            return;
+        }
+        if (statusCode < 200) {
+            // informational responses are followed by the final one
+            if (endStream) {
+                sendRST_STREAM(streamID, ErrorCode_PROTOCOL_ERROR);
+                replyFinishedWithError(httpReply, streamID, QNetworkReply::ProtocolFailure,
+                                       "stream ended with an informational response");
+            }
+            return;
+        }
+
+        it->headersReceived = true;
+        httpReply->setStatusCode(statusCode);
+        replyPrivate->majorVersion = 2;
+        replyPrivate->minorVersion = 0;
+        replyPrivate->reasonPhrase.clear(); // HTTP/2 has no reason phrase
+
+        // repeated fields are merged by QNetworkReplyHttpImpl like for HTTP/1
+        for (int a = 0; a < headers.size(); ++a) {
+            const QHPackHeaderField &field = headers.at(a);
+            if (field.first.startsWith(':'))
+                continue;
+            if (field.first == "content-length")
+                replyPrivate->bodyLength = field.second.toLongLong();
+            replyPrivate->fields.append(field);
+        }
+
+        emit httpReply->headerChanged();
+    }
+
+    // the reply might have been destroyed by a slot connected to headerChanged()
+    if (endStream && m_inFlightStreams.contains(streamID))
+        replyFinished(httpReply, streamID);
+}
+
+void QHttp2ProtocolHandler::handleRST_STREAM(quint32 streamID, const QByteArray &payload)
+{
+    if (streamID == 0) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got RST_STREAM frame on stream 0");
+        return;
+    }
+    if (payload.size() != 4) {
+        connectionError(ErrorCode_FRAME_SIZE_ERROR, "got RST_STREAM frame with invalid size");
+        return;
+    }
+
+    QHash<quint32, Stream>::iterator it = m_inFlightStreams.find(streamID);
+    if (it == m_inFlightStreams.end())
+        return;
+
+    const quint32 errorCode = fourBytesToInt(payload.constData());
+    if (errorCode == ErrorCode_REFUSED_STREAM) {
+        // the server did not process the request, so it is safe to try again
+        requeueStream(streamID);
+        return;
+    }
+
+    const char *errorMessage = 0;
+    QNetworkReply::NetworkError networkError = errorCodeToNetworkError(errorCode, &errorMessage);
+    replyFinishedWithError(it->pair.second, streamID, networkError, errorMessage);
+}
+
+void QHttp2ProtocolHandler::handleSETTINGS(uchar flags, quint32 streamID, const QByteArray &payload)
+{
+    if (streamID != 0) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got SETTINGS frame on a stream");
+        return;
+    }
+    if (flags & FrameFlag_ACK) {
+        if (!payload.isEmpty())
+            connectionError(ErrorCode_FRAME_SIZE_ERROR, "got SETTINGS acknowledgement with payload");
+        return;
+    }
+    if (payload.size() % 6) {
+        connectionError(ErrorCode_FRAME_SIZE_ERROR, "got SETTINGS frame with invalid size");
+        return;
+    }
+
+    for (int offset = 0; offset < payload.size(); offset += 6) {
+        const quint16 identifier = qFromBigEndian<quint16>(
+                    reinterpret_cast<const uchar *>(payload.constData() + offset));
+        const quint32 value = fourBytesToInt(payload.constData() + offset + 2);
+        switch (identifier) {
+        case SETTINGS_HEADER_TABLE_SIZE:
+            m_encoder.setMaxTableSize(value);
+            break;
+        case SETTINGS_ENABLE_PUSH:
+            if (value > 1) {
+                connectionError(ErrorCode_PROTOCOL_ERROR, "got invalid SETTINGS_ENABLE_PUSH value");
+                return;
+            }
+            break;
+        case SETTINGS_MAX_CONCURRENT_STREAMS:
+            m_maxConcurrentStreams = value;
+            break;
+        case SETTINGS_INITIAL_WINDOW_SIZE: {
+            if (value > MaxWindowSize) {
+                connectionError(ErrorCode_FLOW_CONTROL_ERROR, "got invalid SETTINGS_INITIAL_WINDOW_SIZE value");
+                return;
+            }
+            // the change applies to the windows of all open streams
+            const qint64 delta = qint64(value) - m_initialSendWindow;
+            QHash<quint32, Stream>::iterator it = m_inFlightStreams.begin();
+            for (; it != m_inFlightStreams.end(); ++it) {
+                const qint64 window = it->sendWindow + delta;
+                if (window > MaxWindowSize) {
+                    connectionError(ErrorCode_FLOW_CONTROL_ERROR, "stream window became too large");
+                    return;
+                }
+                it->sendWindow = qint32(window);
+            }
+            m_initialSendWindow = qint32(value);
+            break;
+        }
+        case SETTINGS_MAX_FRAME_SIZE:
+            if (value < DefaultMaxFrameSize || value > MaxFrameSizeLimit) {
+                connectionError(ErrorCode_PROTOCOL_ERROR, "got invalid SETTINGS_MAX_FRAME_SIZE value");
+                return;
+            }
+            m_maxFrameSize = value;
+            break;
+        case SETTINGS_MAX_HEADER_LIST_SIZE:
+            m_maxHeaderListSize = value;
+            break;
+        default:
+            // settings of unknown identifiers must be ignored
+            break;
+        }
+    }
+
+    sendSETTINGS_ACK();
+
+    resumeUploads();
+    if (!m_channel->spdyRequestsToSend.isEmpty())
+        sendRequest();
+}
+
+void QHttp2ProtocolHandler::handlePING(uchar flags, quint32 streamID, const QByteArray &payload)
+{
+    if (streamID != 0) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got PING frame on a stream");
+        return;
+    }
+    if (payload.size() != 8) {
+        connectionError(ErrorCode_FRAME_SIZE_ERROR, "got PING frame with invalid size");
+        return;
+    }
+    if (!(flags & FrameFlag_ACK))
+        sendFrame(FrameType_PING, FrameFlag_ACK, 0, payload.constData(), payload.size());
+}
+
+void QHttp2ProtocolHandler::handleGOAWAY(quint32 streamID, const QByteArray &payload)
+{
+    if (streamID != 0 || payload.size() < 8) {
+        connectionError(ErrorCode_PROTOCOL_ERROR, "got invalid GOAWAY frame");
+        return;
+    }
+
+    const quint32 lastStreamID = fourBytesToInt(payload.constData()) & 0x7fffffff;
+    const quint32 errorCode = fourBytesToInt(payload.constData() + 4);
+
+    m_goingAway = true;
+
+    // streams the server did not process go out again on a new connection
+    const QList<quint32> streamIDs = m_inFlightStreams.keys();
+    for (int a = 0; a < streamIDs.count(); ++a) {
+        if (streamIDs.at(a) > lastStreamID)
+            requeueStream(streamIDs.at(a));
+    }
+
+    if (errorCode != ErrorCode_NO_ERROR) {
+        const char *errorMessage = 0;
+        QNetworkReply::NetworkError networkError = errorCodeToNetworkError(errorCode, &errorMessage);
+        finishAllStreams(networkError, errorMessage);
+    }
+
+    // otherwise the remaining streams complete before we close the connection
+    if (m_inFlightStreams.isEmpty())
+        m_channel->close();
+}
+
+void QHttp2ProtocolHandler::handleWINDOW_UPDATE(quint32 streamID, const QByteArray &payload)
+{
+    if (payload.size() != 4) {
+        connectionError(ErrorCode_FRAME_SIZE_ERROR, "got WINDOW_UPDATE frame with invalid size");
+        return;
+    }
+    const quint32 delta = fourBytesToInt(payload.constData()) & 0x7fffffff;
+
+    if (streamID == 0) {
+        if (delta == 0 || qint64(m_sessionSendWindow) + delta > MaxWindowSize) {
+            connectionError(delta ? ErrorCode_FLOW_CONTROL_ERROR : ErrorCode_PROTOCOL_ERROR,
+                            "got invalid session WINDOW_UPDATE");
+            return;
+        }
+        m_sessionSendWindow += delta;
+        resumeUploads();
+        return;
+    }
+
+    QHash<quint32, Stream>::iterator it = m_inFlightStreams.find(streamID);
+    if (it == m_inFlightStreams.end())
+        return; // the stream is closed already
+
+    if (delta == 0 || qint64(it->sendWindow) + delta > MaxWindowSize) {
+        sendRST_STREAM(streamID, delta ? ErrorCode_FLOW_CONTROL_ERROR : ErrorCode_PROTOCOL_ERROR);
+        replyFinishedWithError(it->pair.second, streamID, QNetworkReply::ProtocolFailure,
+                               "got invalid stream WINDOW_UPDATE");
+        return;
+    }
+    it->sendWindow += delta;
+    uploadData(streamID); // we hopefully can continue to upload
+}
+
+void QHttp2ProtocolHandler::requeueStream(quint32 streamID)
+{
+    HttpMessagePair pair = m_inFlightStreams.take(streamID).pair;
+    QHttpNetworkReply *httpReply = pair.second;
+    httpReply->disconnect(this);
+    QHttpNetworkReplyPrivate *replyPrivate = httpReply->d_func();
+    replyPrivate->state = QHttpNetworkReplyPrivate::NothingDoneState;
+    replyPrivate->totallyUploadedData = 0;
+    if (QNonContiguousByteDevice *device = pair.first.uploadByteDevice()) {
+        device->disconnect(this);
+        device->reset();
+    }
+    m_channel->spdyRequestsToSend.insertMulti(pair.first.priority(), pair);
+    QMetaObject::invokeMethod(m_connection, "_q_startNextRequest", Qt::QueuedConnection);
+}
+
+void QHttp2ProtocolHandler::replyFinished(QHttpNetworkReply *httpReply, quint32 streamID)
+{
+    httpReply->d_func()->state = QHttpNetworkReplyPrivate::SPDYClosed;
+    httpReply->disconnect(this);
+    if (httpReply->request().uploadByteDevice())
+        httpReply->request().uploadByteDevice()->disconnect(this);
+    int streamsRemoved = m_inFlightStreams.remove(streamID);
+    Q_ASSERT(streamsRemoved == 1);
+    Q_UNUSED(streamsRemoved); // silence -Wunused-variable
+    emit httpReply->finished();
+
+    if (m_goingAway && m_inFlightStreams.isEmpty()
+        && m_socket->state() == QAbstractSocket::ConnectedState)
+        m_channel->close();
+}
+
+void QHttp2ProtocolHandler::replyFinishedWithError(QHttpNetworkReply *httpReply, quint32 streamID,
+                                                   QNetworkReply::NetworkError errorCode, const char *errorMessage)
+{
+    Q_ASSERT(httpReply);
+    httpReply->d_func()->state = QHttpNetworkReplyPrivate::SPDYClosed;
+    httpReply->disconnect(this);
+    if (httpReply->request().uploadByteDevice())
+        httpReply->request().uploadByteDevice()->disconnect(this);
+    int streamsRemoved = m_inFlightStreams.remove(streamID);
+    Q_ASSERT(streamsRemoved == 1);
+    Q_UNUSED(streamsRemoved); // silence -Wunused-variable
+    emit httpReply->finishedWithError(errorCode, QHttp2ProtocolHandler::tr(errorMessage));
+}
+
+void QHttp2ProtocolHandler::finishAllStreams(QNetworkReply::NetworkError errorCode, const char *errorMessage)
+{
+    const QList<quint32> streamIDs = m_inFlightStreams.keys();
+    for (int a = 0; a < streamIDs.count(); ++a) {
+        QHash<quint32, Stream>::const_iterator it = m_inFlightStreams.constFind(streamIDs.at(a));
+        if (it != m_inFlightStreams.constEnd())
+            replyFinishedWithError(it->pair.second, streamIDs.at(a), errorCode, errorMessage);
+    }
+}
+
+void QHttp2ProtocolHandler::connectionError(ErrorCode errorCode, const char *errorMessage)
+{
+    qWarning("HTTP/2 connection error: %s", errorMessage);
+    m_goingAway = true;
+    sendGOAWAY(errorCode);
+    finishAllStreams(QNetworkReply::ProtocolFailure, errorMessage);
+    m_channel->close();
+}
+
+quint32 QHttp2ProtocolHandler::generateNextStreamID()
+{
+    // stream IDs initiated by the client must be odd
+    const quint32 streamID = m_nextStreamID;
+    m_nextStreamID += 2;
+    return streamID;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_HTTP
@@ -0,0 +1,604 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qhttpmultipartreader.h"
+#include "qhttpmultipartreader_p.h"
+#include "qnetworkreply.h"
+
+QT_BEGIN_NAMESPACE
+
+// Limits for the parts of the message that are buffered until they are
+// complete; the part bodies themselves are never buffered.
+static const int MaxDelimiterLineLength = 1024;
+static const int MaxHeaderBytes = 64 * 1024;
+
+/*!
+    \class QHttpMultiPartReader
+    \brief The QHttpMultiPartReader class reads a multipart MIME message
+           as it arrives, one body part after the other.
+    \since 5.6
+
+    \ingroup network
+    \inmodule QtNetwork
+
+    HTTP servers use multipart messages for replies that consist of several
+    entities, for instance the \c multipart/byteranges replies to requests
+    for several byte ranges, or \c multipart/mixed replies. QHttpMultiPartReader
+    parses such a message incrementally: it never holds more than the
+    headers of the current part in memory, and hands the body of each part
+    on in pieces, as it receives them.
+
+    The data either comes from a device set with setDevice(), typically a
+    QNetworkReply, or is passed in with addData(). If the device is a
+    QNetworkReply and no boundary was set, the reader takes it from the
+    \c Content-Type header of the reply.
+
+    The reader emits partStarted() once the headers of a part have been
+    read; they are available from partRawHeader() and partRawHeaderList()
+    until the next part starts. partData() then delivers the body of the
+    part, and partFinished() is emitted at its end. finished() is emitted
+    once the closing delimiter of the message has been read, or when an
+    error occurred.
+
+    \code
+    QNetworkReply *reply = manager->get(request);
+    QHttpMultiPartReader *reader = new QHttpMultiPartReader(reply, reply);
+    connect(reader, SIGNAL(partStarted()), this, SLOT(startPart()));
+    connect(reader, SIGNAL(partData(QByteArray)), this, SLOT(writePartData(QByteArray)));
+    connect(reader, SIGNAL(partFinished()), this, SLOT(finishPart()));
+    \endcode
+
+    \sa QHttpMultiPart
+*/
+
+/*!
+    \enum QHttpMultiPartReader::Error
+
+    This enum describes the errors the reader can report.
+
+    \value NoError No error occurred.
+    \value MissingBoundaryError No boundary was set, and none could be found
+           in the \c Content-Type header of the device.
+    \value MalformedPartError The headers of a part, or the line following a
+           delimiter, could not be parsed.
+    \value PrematureEndError The device reached its end before the closing
+           delimiter of the message.
+*/
+
+/*!
+    \fn void QHttpMultiPartReader::partStarted()
+
+    This signal is emitted when the headers of a part have been read, and
+    before any of its body is delivered through partData().
+
+    \sa partRawHeader(), partRawHeaderList()
+*/
+
+/*!
+    \fn void QHttpMultiPartReader::partData(const QByteArray &data)
+
+    This signal is emitted with the next piece of \a data from the body of
+    the current part. The body of a part is delivered in as many pieces as
+    the data arrives in, and possibly in more.
+*/
+
+/*!
+    \fn void QHttpMultiPartReader::partFinished()
+
+    This signal is emitted at the end of the body of the current part.
+*/
+
+/*!
+    \fn void QHttpMultiPartReader::finished()
+
+    This signal is emitted once the closing delimiter of the message has
+    been read, or when an error occurred. Use error() to tell the two
+    apart.
+*/
+
+QHttpMultiPartReaderPrivate::QHttpMultiPartReaderPrivate()
+    : buffer("\r\n"), // so that a delimiter at the very beginning is found, too
+      position(0), headerBytes(0), state(PreambleState), partCount(0),
+      errorCode(QHttpMultiPartReader::NoError)
+{
+}
+
+/*!
+    Constructs a QHttpMultiPartReader object with parent \a parent. Set a
+    device or a boundary before passing it any data.
+*/
+QHttpMultiPartReader::QHttpMultiPartReader(QObject *parent)
+    : QObject(*new QHttpMultiPartReaderPrivate, parent)
+{
+}
+
+/*!
+    Constructs a QHttpMultiPartReader object reading from \a device, with
+    parent \a parent.
+
+    \sa setDevice()
+*/
+QHttpMultiPartReader::QHttpMultiPartReader(QIODevice *device, QObject *parent)
+    : QObject(*new QHttpMultiPartReaderPrivate, parent)
+{
+    setDevice(device);
+}
+
+/*!
+    Destroys the reader.
+*/
+QHttpMultiPartReader::~QHttpMultiPartReader()
+{
+}
+
+/*!
+    Makes the reader read the message from \a device, which must be open
+    for reading. The reader reads whatever the device has available, and
+    more whenever it emits readyRead(). It does not take ownership of the
+    device.
+
+    \sa device(), addData()
+*/
+void QHttpMultiPartReader::setDevice(QIODevice *device)
+{
+    Q_D(QHttpMultiPartReader);
+    if (d->device)
+        d->device->disconnect(this);
+    d->device = device;
+    if (!device)
+        return;
+    connect(device, SIGNAL(readyRead()), this, SLOT(_q_readyRead()));
+    connect(device, SIGNAL(readChannelFinished()), this, SLOT(_q_readChannelFinished()));
+    // let the caller connect to the signals before the first part is reported
+    if (device->bytesAvailable())
+        QMetaObject::invokeMethod(this, "_q_readyRead", Qt::QueuedConnection);
+}
+
+/*!
+    Returns the device the reader reads from, or 0 if it has none.
+
+    \sa setDevice()
+*/
+QIODevice *QHttpMultiPartReader::device() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->device;
+}
+
+/*!
+    Returns the boundary that separates the parts of the message.
+
+    \sa setBoundary(), boundaryFromContentType()
+*/
+QByteArray QHttpMultiPartReader::boundary() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->boundary;
+}
+
+/*!
+    Sets the boundary that separates the parts of the message to
+    \a boundary. This has to be done before the reader receives any data.
+
+    \sa boundary(), boundaryFromContentType()
+*/
+void QHttpMultiPartReader::setBoundary(const QByteArray &boundary)
+{
+    Q_D(QHttpMultiPartReader);
+    d->boundary = boundary;
+    d->delimiter = "\r\n--" + boundary;
+    d->delimiterMatcher.setPattern(d->delimiter);
+}
+
+/*!
+    Returns the value of the \c boundary parameter of the \c Content-Type
+    header value \a contentType, or an empty QByteArray if there is none.
+*/
+QByteArray QHttpMultiPartReader::boundaryFromContentType(const QByteArray &contentType)
+{
+    const QList<QByteArray> parameters = contentType.split(';');
+    for (int i = 1; i < parameters.size(); ++i) {
+        const QByteArray parameter = parameters.at(i).trimmed();
+        const int equals = parameter.indexOf('=');
+        if (equals == -1 || parameter.left(equals).trimmed().toLower() != "boundary")
+            continue;
+        QByteArray value = parameter.mid(equals + 1).trimmed();
+        if (value.size() >= 2 && value.startsWith('"') && value.endsWith('"'))
+            value = value.mid(1, value.size() - 2);
+        return value;
+    }
+    return QByteArray();
+}
+
+/*!
+    Passes the next piece of the message, \a data, to the reader, which
+    emits the signals for everything it can parse right away.
+
+    Use this function instead of setDevice() when the message does not
+    come from a QIODevice.
+*/
+void QHttpMultiPartReader::addData(const QByteArray &data)
+{
+    Q_D(QHttpMultiPartReader);
+    if (d->state == QHttpMultiPartReaderPrivate::EpilogueState
+        || d->state == QHttpMultiPartReaderPrivate::ErrorState || data.isEmpty()) {
+        return;
+    }
+    if (d->boundary.isEmpty()) {
+        d->setError(MissingBoundaryError, tr("The multipart message has no boundary"));
+        return;
+    }
+    if (d->position == d->buffer.size())
+        d->buffer = data; // no copy unless something was left over
+    else
+        d->buffer.append(data);
+    d->parse();
+}
+
+/*!
+    Returns \c true once the closing delimiter of the message has been read.
+*/
+bool QHttpMultiPartReader::atEnd() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->state == QHttpMultiPartReaderPrivate::EpilogueState;
+}
+
+/*!
+    Returns the number of parts that have been started so far.
+*/
+int QHttpMultiPartReader::partCount() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->partCount;
+}
+
+/*!
+    Returns the error that stopped the reader, or NoError.
+
+    \sa errorString()
+*/
+QHttpMultiPartReader::Error QHttpMultiPartReader::error() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->errorCode;
+}
+
+/*!
+    Returns a human-readable description of the error that stopped the
+    reader, or an empty string.
+
+    \sa error()
+*/
+QString QHttpMultiPartReader::errorString() const
+{
+    Q_D(const QHttpMultiPartReader);
+    return d->errorString;
+}
+
+/*!
+    Returns the names of the headers of the current part, in the order in
+    which they were received.
+
+    \sa partRawHeader()
+*/
+QList<QByteArray> QHttpMultiPartReader::partRawHeaderList() const
+{
+    Q_D(const QHttpMultiPartReader);
+    QList<QByteArray> names;
+    names.reserve(d->headers.size());
+    for (int i = 0; i < d->headers.size(); ++i)
+        names << d->headers.at(i).first;
+    return names;
+}
+
+/*!
+    Returns \c true if the current part has a header called \a headerName.
+    The comparison is case-insensitive.
+*/
+bool QHttpMultiPartReader::hasPartRawHeader(const QByteArray &headerName) const
+{
+    Q_D(const QHttpMultiPartReader);
+    for (int i = 0; i < d->headers.size(); ++i) {
+        if (qstricmp(d->headers.at(i).first.constData(), headerName.constData()) == 0)
+            return true;
+    }
+    return false;
+}
+
+/*!
+    Returns the value of the header \a headerName of the current part, or
+    an empty QByteArray if it has no such header. The comparison is
+    case-insensitive. If the header occurs more than once, the values are
+    joined with commas.
+*/
+QByteArray QHttpMultiPartReader::partRawHeader(const QByteArray &headerName) const
+{
+    Q_D(const QHttpMultiPartReader);
+    QByteArray value;
+    for (int i = 0; i < d->headers.size(); ++i) {
+        if (qstricmp(d->headers.at(i).first.constData(), headerName.constData()) != 0)
+            continue;
+        if (!value.isEmpty())
+            value += ", ";
+        value += d->headers.at(i).second;
+    }
+    return value;
+}
+
+/*!
+    Parses the \c Content-Range header of the current part, as found in the
+    parts of a \c multipart/byteranges reply. On success, stores the first
+    and last byte positions of the part in \a first and \a last, the length
+    of the complete entity in \a completeLength, or -1 if it is unknown, and
+    returns \c true. Returns \c false if the part has no valid byte range.
+*/
+bool QHttpMultiPartReader::partContentRange(qint64 *first, qint64 *last, qint64 *completeLength) const
+{
+    // bytes first-last/complete-length, where complete-length may be "*"
+    const QByteArray range = partRawHeader("Content-Range").trimmed();
+    if (!range.toLower().startsWith("bytes "))
+        return false;
+    const int dash = range.indexOf('-');
+    const int slash = range.indexOf('/');
+    if (dash == -1 || slash < dash)
+        return false;
+    bool ok1, ok2;
+    const qint64 firstPosition = range.mid(6, dash - 6).trimmed().toLongLong(&ok1);
+    const qint64 lastPosition = range.mid(dash + 1, slash - dash - 1).trimmed().toLongLong(&ok2);
+    if (!ok1 || !ok2 || firstPosition > lastPosition)
+        return false;
+    qint64 length = -1;
+    const QByteArray lengthField = range.mid(slash + 1).trimmed();
+    if (lengthField != "*") {
+        bool ok;
+        length = lengthField.toLongLong(&ok);
+        if (!ok || length <= lastPosition)
+            return false;
+    }
+    if (first)
+        *first = firstPosition;
+    if (last)
+        *last = lastPosition;
+    if (completeLength)
+        *completeLength = length;
+    return true;
+}
+
+/*!
+    \internal
+
+    Returns the number of bytes at the end of the buffer that could be the
+    beginning of a delimiter, and thus cannot be passed on as body data yet.
+*/
+int QHttpMultiPartReaderPrivate::heldBackBytes() const
+{
+    const int end = buffer.size();
+    for (int length = qMin(delimiter.size() - 1, end - position); length > 0; --length) {
+        if (buffer.at(end - length) == '\r'
+            && memcmp(buffer.constData() + end - length, delimiter.constData(), length) == 0) {
+            return length;
+        }
+    }
+    return 0;
+}
+
+/*!
+    \internal
+
+    Adds the header in \a line to the headers of the current part. Returns
+    \c false if it is malformed.
+*/
+bool QHttpMultiPartReaderPrivate::parseHeaderLine(const QByteArray &line)
+{
+    if ((line.startsWith(' ') || line.startsWith('\t')) && !headers.isEmpty()) {
+        // obsolete line folding
+        headers.last().second += ' ' + line.trimmed();
+        return true;
+    }
+    const int colon = line.indexOf(':');
+    if (colon <= 0)
+        return false;
+    headers.append(qMakePair(line.left(colon).trimmed(), line.mid(colon + 1).trimmed()));
+    return true;
+}
+
+void QHttpMultiPartReaderPrivate::setError(QHttpMultiPartReader::Error code, const QString &message)
+{
+    Q_Q(QHttpMultiPartReader);
+    state = ErrorState;
+    errorCode = code;
+    errorString = message;
+    buffer.clear();
+    position = 0;
+    emit q->finished();
+}
+
+/*!
+    \internal
+
+    Parses as much of the buffer as possible, leaving what has to wait for
+    more data in it.
+*/
+void QHttpMultiPartReaderPrivate::parse()
+{
+    Q_Q(QHttpMultiPartReader);
+    bool needMoreData = false;
+    while (!needMoreData && position < buffer.size()) {
+        switch (state) {
+        case PreambleState: {
+            const int index = delimiterMatcher.indexIn(buffer, position);
+            if (index == -1) {
+                // the preamble is ignored
+                position = qMax(position, buffer.size() - delimiter.size() + 1);
+                needMoreData = true;
+            } else {
+                position = index + delimiter.size();
+                state = DelimiterState;
+            }
+            break;
+        }
+        case DelimiterState: {
+            if (buffer.size() - position < 2) {
+                needMoreData = true;
+                break;
+            }
+            if (buffer.at(position) == '-' && buffer.at(position + 1) == '-') {
+                // the closing delimiter; the epilogue is ignored
+                buffer.clear();
+                position = 0;
+                state = EpilogueState;
+                emit q->finished();
+                return;
+            }
+            const int lineEnd = buffer.indexOf('\n', position);
+            if (lineEnd == -1) {
+                if (buffer.size() - position > MaxDelimiterLineLength) {
+                    setError(QHttpMultiPartReader::MalformedPartError,
+                             QHttpMultiPartReader::tr("Malformed multipart delimiter"));
+                    return;
+                }
+                needMoreData = true;
+                break;
+            }
+            // nothing but transport padding may follow the boundary
+            for (int i = position; i < lineEnd; ++i) {
+                const char c = buffer.at(i);
+                if (c != ' ' && c != '\t' && !(c == '\r' && i == lineEnd - 1)) {
+                    setError(QHttpMultiPartReader::MalformedPartError,
+                             QHttpMultiPartReader::tr("Malformed multipart delimiter"));
+                    return;
+                }
+            }
+            position = lineEnd + 1;
+            headers.clear();
+            headerBytes = 0;
+            state = HeaderState;
+            break;
+        }
+        case HeaderState: {
+            const int lineEnd = buffer.indexOf('\n', position);
+            if (lineEnd == -1) {
+                needMoreData = true;
+            } else {
+                QByteArray line = buffer.mid(position, lineEnd - position);
+                headerBytes += line.size() + 1;
+                position = lineEnd + 1;
+                if (line.endsWith('\r'))
+                    line.chop(1);
+                if (line.isEmpty()) {
+                    state = BodyState;
+                    ++partCount;
+                    emit q->partStarted();
+                    break;
+                }
+                if (!parseHeaderLine(line)) {
+                    setError(QHttpMultiPartReader::MalformedPartError,
+                             QHttpMultiPartReader::tr("Malformed header in part %1").arg(partCount + 1));
+                    return;
+                }
+            }
+            if (headerBytes + buffer.size() - position > MaxHeaderBytes && needMoreData) {
+                setError(QHttpMultiPartReader::MalformedPartError,
+                         QHttpMultiPartReader::tr("The headers of part %1 are too large").arg(partCount + 1));
+                return;
+            }
+            break;
+        }
+        case BodyState: {
+            const int index = delimiterMatcher.indexIn(buffer, position);
+            if (index != -1) {
+                if (index > position)
+                    emit q->partData(buffer.mid(position, index - position));
+                position = index + delimiter.size();
+                state = DelimiterState;
+                emit q->partFinished();
+                break;
+            }
+            // pass everything on that cannot be part of a delimiter
+            const int end = buffer.size() - heldBackBytes();
+            if (end > position) {
+                // mid() does not copy when it returns the whole buffer
+                emit q->partData(buffer.mid(position, end - position));
+                position = end;
+            }
+            needMoreData = true;
+            break;
+        }
+        case EpilogueState:
+        case ErrorState:
+            position = buffer.size();
+            break;
+        }
+    }
+
+    // keep only what was not parsed yet
+    if (state == ErrorState)
+        return;
+    if (position >= buffer.size())
+        buffer.clear();
+    else if (position > 0)
+        buffer = buffer.mid(position);
+    position = 0;
+}
+
+void QHttpMultiPartReaderPrivate::_q_readyRead()
+{
+    Q_Q(QHttpMultiPartReader);
+    if (!device)
+        return;
+    if (boundary.isEmpty()) {
+        if (QNetworkReply *reply = qobject_cast<QNetworkReply *>(device.data()))
+            q->setBoundary(QHttpMultiPartReader::boundaryFromContentType(reply->rawHeader("Content-Type")));
+    }
+    const qint64 available = device->bytesAvailable();
+    if (available > 0)
+        q->addData(device->read(available));
+    else
+        q->addData(device->readAll());
+}
+
+void QHttpMultiPartReaderPrivate::_q_readChannelFinished()
+{
+    Q_Q(QHttpMultiPartReader);
+    _q_readyRead();
+    if (state != EpilogueState && state != ErrorState) {
+        setError(QHttpMultiPartReader::PrematureEndError,
+                 QHttpMultiPartReader::tr("The multipart message ended prematurely"));
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qhttpmultipartreader.cpp"
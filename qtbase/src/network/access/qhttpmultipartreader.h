@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QHTTPMULTIPARTREADER_H
+#define QHTTPMULTIPARTREADER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+
+QT_BEGIN_NAMESPACE
+
+
+class QIODevice;
+class QHttpMultiPartReaderPrivate;
+
+class Q_NETWORK_EXPORT QHttpMultiPartReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Error {
+        NoError,
+        MissingBoundaryError,
+        MalformedPartError,
+        PrematureEndError
+    };
+
+    explicit QHttpMultiPartReader(QObject *parent = Q_NULLPTR);
+    explicit QHttpMultiPartReader(QIODevice *device, QObject *parent = Q_NULLPTR);
+    ~QHttpMultiPartReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    QByteArray boundary() const;
+    void setBoundary(const QByteArray &boundary);
+    static QByteArray boundaryFromContentType(const QByteArray &contentType);
+
+    void addData(const QByteArray &data);
+
+    bool atEnd() const;
+    int partCount() const;
+    Error error() const;
+    QString errorString() const;
+
+    QList<QByteArray> partRawHeaderList() const;
+    bool hasPartRawHeader(const QByteArray &headerName) const;
+    QByteArray partRawHeader(const QByteArray &headerName) const;
+    bool partContentRange(qint64 *first, qint64 *last, qint64 *completeLength = Q_NULLPTR) const;
+
+Q_SIGNALS:
+    void partStarted();
+    void partData(const QByteArray &data);
+    void partFinished();
+    void finished();
+
+private:
+    Q_DECLARE_PRIVATE(QHttpMultiPartReader)
+    Q_DISABLE_COPY(QHttpMultiPartReader)
+    Q_PRIVATE_SLOT(d_func(), void _q_readyRead())
+    Q_PRIVATE_SLOT(d_func(), void _q_readChannelFinished())
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPMULTIPARTREADER_H
@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QHTTPMULTIPARTREADER_P_H
+#define QHTTPMULTIPARTREADER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qhttpmultipartreader.h"
+#include "QtCore/qbytearraymatcher.h"
+#include "QtCore/qpair.h"
+#include "QtCore/qpointer.h"
+#include "private/qobject_p.h"
+
+QT_BEGIN_NAMESPACE
+
+
+class QHttpMultiPartReaderPrivate: public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QHttpMultiPartReader)
+public:
+    enum State {
+        PreambleState,
+        DelimiterState,
+        HeaderState,
+        BodyState,
+        EpilogueState,
+        ErrorState
+    };
+
+    QHttpMultiPartReaderPrivate();
+
+    void parse();
+    int heldBackBytes() const;
+    bool parseHeaderLine(const QByteArray &line);
+    void setError(QHttpMultiPartReader::Error code, const QString &message);
+    void _q_readyRead();
+    void _q_readChannelFinished();
+
+    QPointer<QIODevice> device;
+    QByteArray boundary;
+    QByteArray delimiter; // "\r\n--" followed by the boundary
+    QByteArrayMatcher delimiterMatcher;
+
+    // the data that has not been parsed yet starts at position in buffer
+    QByteArray buffer;
+    int position;
+    int headerBytes;
+
+    State state;
+    int partCount;
+    QList<QPair<QByteArray, QByteArray> > headers;
+    QHttpMultiPartReader::Error errorCode;
+    QString errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTPMULTIPARTREADER_P_H
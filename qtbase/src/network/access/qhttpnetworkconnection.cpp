@@ -39,6 +39,7 @@
 #include <private/qobject_p.h>
 #include <private/qauthenticator_p.h>
 #include "private/qhostinfo_p.h"
+#include "private/qnetworkcontentdecoder_p.h"
 #include <qnetworkproxy.h>
 #include <qauthenticator.h>
 #include <qcoreapplication.h>
@@ -74,12 +75,10 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(const QString &host
                                                              QHttpNetworkConnection::ConnectionType type)
 : state(RunningState),
   networkLayerState(Unknown),
-  hostName(hostName), port(port), encrypt(encrypt), delayIpv4(true)
-#ifndef QT_NO_SSL
-, channelCount((type == QHttpNetworkConnection::ConnectionTypeSPDY) ? 1 : defaultHttpChannelCount)
-#else
-, channelCount(defaultHttpChannelCount)
-#endif // QT_NO_SSL
+  hostName(hostName), port(port), encrypt(encrypt), delayIpv4(true),
+  hostLookupStart(-1), hostLookupEnd(-1)
+, channelCount((type == QHttpNetworkConnection::ConnectionTypeSPDY
+                || type == QHttpNetworkConnection::ConnectionTypeHTTP2) ? 1 : defaultHttpChannelCount)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
@@ -94,6 +93,7 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(quint16 channelCoun
                                                              QHttpNetworkConnection::ConnectionType type)
 : state(RunningState), networkLayerState(Unknown),
   hostName(hostName), port(port), encrypt(encrypt), delayIpv4(true),
+  hostLookupStart(-1), hostLookupEnd(-1),
   channelCount(channelCount)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
@@ -283,19 +283,20 @@ void QHttpNetworkConnectionPrivate::prepareRequest(HttpMessagePair &messagePair)
 #endif
 
     // If the request had a accept-encoding set, we better not mess
-    // with it. If it was not set, we announce that we understand gzip
-    // and remember this fact in request.d->autoDecompress so that
-    // we can later decompress the HTTP reply if it has such an
+    // with it. If it was not set, we announce the content codings we
+    // have decoders for and remember this fact in request.d->autoDecompress
+    // so that we can later decompress the HTTP reply if it has such an
     // encoding.
     value = request.headerField("accept-encoding");
     if (value.isEmpty()) {
-#ifndef QT_NO_COMPRESS
-        request.setHeaderField("Accept-Encoding", "gzip, deflate");
-        request.d->autoDecompress = true;
-#else
-        // if zlib is not available set this to false always
-        request.d->autoDecompress = false;
-#endif
+        const QByteArray acceptEncoding = QNetworkContentDecoderPrivate::acceptEncoding();
+        if (!acceptEncoding.isEmpty()) {
+            request.setHeaderField("Accept-Encoding", acceptEncoding);
+            request.d->autoDecompress = true;
+        } else {
+            // neither zlib nor registered decoders, set this to false always
+            request.d->autoDecompress = false;
+        }
     }
 
     // some websites mandate an accept-language header and fail
@@ -593,6 +594,8 @@ QHttpNetworkReply* QHttpNetworkConnectionPrivate::queueRequest(const QHttpNetwor
     reply->setRequest(request);
     reply->d_func()->connection = q;
     reply->d_func()->connectionChannel = &channels[0]; // will have the correct one set later
+    reply->d_func()->metricsData()->startTime = request.startTime() >= 0
+            ? request.startTime() : QNetworkReplyMetricsPrivate::now();
     HttpMessagePair pair = qMakePair(request, reply);
 
     if (request.isPreConnect())
@@ -609,13 +612,11 @@ QHttpNetworkReply* QHttpNetworkConnectionPrivate::queueRequest(const QHttpNetwor
             break;
         }
     }
-#ifndef QT_NO_SSL
-    else { // SPDY
+    else { // SPDY, HTTP/2
         if (!pair.second->d_func()->requestIsPrepared)
             prepareRequest(pair);
         channels[0].spdyRequestsToSend.insertMulti(request.priority(), pair);
     }
-#endif // QT_NO_SSL
 
     // For Happy Eyeballs the networkLayerState is set to Unknown
     // untill we have started the first connection attempt. So no
@@ -926,8 +927,7 @@ void QHttpNetworkConnectionPrivate::removeReply(QHttpNetworkReply *reply)
                return;
             }
         }
-#ifndef QT_NO_SSL
-        // is the reply inside the SPDY pipeline of this channel already?
+        // is the reply inside the SPDY / HTTP/2 pipeline of this channel already?
         QMultiMap<int, HttpMessagePair>::iterator it = channels[i].spdyRequestsToSend.begin();
         QMultiMap<int, HttpMessagePair>::iterator end = channels[i].spdyRequestsToSend.end();
         for (; it != end; ++it) {
@@ -938,7 +938,6 @@ void QHttpNetworkConnectionPrivate::removeReply(QHttpNetworkReply *reply)
                 return;
             }
         }
-#endif
     }
     // remove from the high priority queue
     if (!highPriorityQueue.isEmpty()) {
@@ -1010,8 +1009,8 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
         }
         break;
     }
-    case QHttpNetworkConnection::ConnectionTypeSPDY: {
-#ifndef QT_NO_SSL
+    case QHttpNetworkConnection::ConnectionTypeSPDY:
+    case QHttpNetworkConnection::ConnectionTypeHTTP2: {
         if (channels[0].spdyRequestsToSend.isEmpty())
             return;
 
@@ -1023,7 +1022,6 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
         if (channels[0].socket && channels[0].socket->state() == QAbstractSocket::ConnectedState
                 && !channels[0].pendingEncrypt)
             channels[0].sendRequest();
-#endif // QT_NO_SSL
         break;
     }
     }
@@ -1124,6 +1122,12 @@ void QHttpNetworkConnectionPrivate::startHostInfoLookup()
             return;
         }
     } else {
+        // queueRequest() calls us again for every request queued while
+        // the lookup is pending; keep the time of the first call
+        if (hostLookupStart < 0 || hostLookupEnd >= 0) {
+            hostLookupStart = QNetworkReplyMetricsPrivate::now();
+            hostLookupEnd = -1;
+        }
         int hostLookupId;
         bool immediateResultValid = false;
         QHostInfo hostInfo = qt_qhostinfo_lookup(lookupHost,
@@ -1146,6 +1150,9 @@ void QHttpNetworkConnectionPrivate::_q_hostLookupFinished(QHostInfo info)
     if (networkLayerState == IPv4 || networkLayerState == IPv6 || networkLayerState == IPv4or6)
         return;
 
+    if (hostLookupStart >= 0 && hostLookupEnd < 0)
+        hostLookupEnd = QNetworkReplyMetricsPrivate::now();
+
     foreach (const QHostAddress &address, info.addresses()) {
         if (address.protocol() == QAbstractSocket::IPv4Protocol) {
             if (!foundAddress) {
@@ -1175,8 +1182,7 @@ void QHttpNetworkConnectionPrivate::_q_hostLookupFinished(QHostInfo info)
             emitReplyError(channels[0].socket, channels[0].reply, QNetworkReply::HostNotFoundError);
             networkLayerState = QHttpNetworkConnectionPrivate::Unknown;
         }
-#ifndef QT_NO_SSL
-        else if (connectionType == QHttpNetworkConnection::ConnectionTypeSPDY) {
+        else if (connectionType != QHttpNetworkConnection::ConnectionTypeHTTP) {
             QList<HttpMessagePair> spdyPairs = channels[0].spdyRequestsToSend.values();
             for (int a = 0; a < spdyPairs.count(); ++a) {
                 // emit error for all replies
@@ -1185,7 +1191,6 @@ void QHttpNetworkConnectionPrivate::_q_hostLookupFinished(QHostInfo info)
                 emitReplyError(channels[0].socket, currentReply, QNetworkReply::HostNotFoundError);
             }
         }
-#endif // QT_NO_SSL
         else {
             // Should not happen
             qWarning() << "QHttpNetworkConnectionPrivate::_q_hostLookupFinished could not dequeu request";
@@ -1448,19 +1453,15 @@ void QHttpNetworkConnectionPrivate::emitProxyAuthenticationRequired(const QHttpN
     // dialog is displaying
     pauseConnection();
     QHttpNetworkReply *reply;
-#ifndef QT_NO_SSL
-    if (connectionType == QHttpNetworkConnection::ConnectionTypeSPDY) {
+    if (connectionType != QHttpNetworkConnection::ConnectionTypeHTTP) {
         // we choose the reply to emit the proxyAuth signal from somewhat arbitrarily,
         // but that does not matter because the signal will ultimately be emitted
         // by the QNetworkAccessManager.
         Q_ASSERT(chan->spdyRequestsToSend.count() > 0);
         reply = chan->spdyRequestsToSend.cbegin().value().second;
     } else { // HTTP
-#endif // QT_NO_SSL
         reply = chan->reply;
-#ifndef QT_NO_SSL
     }
-#endif // QT_NO_SSL
 
     Q_ASSERT(reply);
     emit reply->proxyAuthenticationRequired(proxy, auth);
@@ -43,6 +43,7 @@
 
 #include <private/qhttpprotocolhandler_p.h>
 #include <private/qspdyprotocolhandler_p.h>
+#include <private/qhttp2protocolhandler_p.h>
 
 #ifndef QT_NO_SSL
 #    include <QtNetwork/qsslkey.h>
@@ -74,6 +75,10 @@ QHttpNetworkConnectionChannel::QHttpNetworkConnectionChannel()
     , resendCurrent(false)
     , lastStatus(0)
     , pendingEncrypt(false)
+    , connectStart(-1)
+    , secureConnectionStart(-1)
+    , connectEnd(-1)
+    , requestsOnConnection(0)
     , reconnectAttempts(reconnectAttemptsDefault)
     , authMethod(QAuthenticatorPrivate::None)
     , proxyAuthMethod(QAuthenticatorPrivate::None)
@@ -172,7 +177,10 @@ void QHttpNetworkConnectionChannel::init()
            sslSocket->setSslConfiguration(sslConfiguration);
     } else {
 #endif // QT_NO_SSL
-        protocolHandler.reset(new QHttpProtocolHandler(this));
+        if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeHTTP2)
+            protocolHandler.reset(new QHttp2ProtocolHandler(this));
+        else
+            protocolHandler.reset(new QHttpProtocolHandler(this));
 #ifndef QT_NO_SSL
     }
 #endif
@@ -299,6 +307,10 @@ bool QHttpNetworkConnectionChannel::ensureConnection()
         // connect to the host if not already connected.
         state = QHttpNetworkConnectionChannel::ConnectingState;
         pendingEncrypt = ssl;
+        connectStart = QNetworkReplyMetricsPrivate::now();
+        secureConnectionStart = -1;
+        connectEnd = -1;
+        requestsOnConnection = 0;
 
         // reset state
         pipeliningSupported = PipeliningSupportUnknown;
@@ -665,17 +677,47 @@ void QHttpNetworkConnectionChannel::pipelineInto(HttpMessagePair &pair)
     reply->d_func()->pipeliningUsed = true;
 
 #ifndef QT_NO_NETWORKPROXY
-    pipeline.append(QHttpNetworkRequestPrivate::header(request,
-                                                           (connection->d_func()->networkProxy.type() != QNetworkProxy::NoProxy)));
+    const QByteArray header = QHttpNetworkRequestPrivate::header(request,
+                                                                 (connection->d_func()->networkProxy.type() != QNetworkProxy::NoProxy));
 #else
-    pipeline.append(QHttpNetworkRequestPrivate::header(request, false));
+    const QByteArray header = QHttpNetworkRequestPrivate::header(request, false);
 #endif
+    pipeline.append(header);
+    recordRequestStart(reply, QByteArrayLiteral("http/1.1"));
+    reply->d_func()->metricsData()->bytesSent += header.size();
 
     alreadyPipelinedRequests.append(pair);
 
     // pipelineFlush() needs to be called at some point afterwards
 }
 
+void QHttpNetworkConnectionChannel::recordRequestStart(QHttpNetworkReply *reply, const QByteArray &protocol)
+{
+    QNetworkReplyMetricsPrivate *metrics = reply->d_func()->metricsData();
+    const QHttpNetworkConnectionPrivate *d = connection->d_func();
+
+    metrics->requestStart = QNetworkReplyMetricsPrivate::now();
+    metrics->protocol = protocol;
+    metrics->peerAddress = socket->peerAddress();
+    metrics->peerPort = socket->peerPort();
+    metrics->connectionReused = requestsOnConnection++ > 0;
+    metrics->responseStart = -1;
+
+    // Only report the phases that the reply had to wait for. A lookup or
+    // connection that was already under way when the reply was queued is
+    // reported from the time the reply was queued.
+    if (d->hostLookupStart >= 0 && d->hostLookupEnd >= metrics->startTime) {
+        metrics->domainLookupStart = qMax(d->hostLookupStart, metrics->startTime);
+        metrics->domainLookupEnd = d->hostLookupEnd;
+    }
+    if (!metrics->connectionReused && connectStart >= 0 && connectEnd >= metrics->startTime) {
+        metrics->connectStart = qMax(connectStart, metrics->startTime);
+        metrics->secureConnectionStart = secureConnectionStart < 0
+                ? -1 : qMax(secureConnectionStart, metrics->startTime);
+        metrics->connectEnd = connectEnd;
+    }
+}
+
 void QHttpNetworkConnectionChannel::pipelineFlush()
 {
     if (pipeline.isEmpty())
@@ -773,6 +815,11 @@ void QHttpNetworkConnectionChannel::_q_disconnected()
 
 void QHttpNetworkConnectionChannel::_q_connected()
 {
+    if (pendingEncrypt)
+        secureConnectionStart = QNetworkReplyMetricsPrivate::now();
+    else
+        connectEnd = QNetworkReplyMetricsPrivate::now();
+
     // For the Happy Eyeballs we need to check if this is the first channel to connect.
     if (connection->d_func()->networkLayerState == QHttpNetworkConnectionPrivate::HostLookupPending || connection->d_func()->networkLayerState == QHttpNetworkConnectionPrivate::IPv4or6) {
         if (connection->d_func()->delayedConnectionTimer.isActive())
@@ -825,6 +872,12 @@ void QHttpNetworkConnectionChannel::_q_connected()
                 connection->setSslContext(socketSslContext);
         }
 #endif
+    } else if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeHTTP2) {
+        // cleartext HTTP/2 with prior knowledge: every connection starts a new session
+        state = QHttpNetworkConnectionChannel::IdleState;
+        protocolHandler.reset(new QHttp2ProtocolHandler(this));
+        if (spdyRequestsToSend.count() > 0)
+            sendRequest();
     } else {
         state = QHttpNetworkConnectionChannel::IdleState;
         if (!reply)
@@ -964,8 +1017,7 @@ void QHttpNetworkConnectionChannel::_q_error(QAbstractSocket::SocketError socket
         }
     } while (!connection->d_func()->highPriorityQueue.isEmpty()
              || !connection->d_func()->lowPriorityQueue.isEmpty());
-#ifndef QT_NO_SSL
-    if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeSPDY) {
+    if (connection->connectionType() != QHttpNetworkConnection::ConnectionTypeHTTP) {
         QList<HttpMessagePair> spdyPairs = spdyRequestsToSend.values();
         for (int a = 0; a < spdyPairs.count(); ++a) {
             // emit error for all replies
@@ -974,7 +1026,6 @@ void QHttpNetworkConnectionChannel::_q_error(QAbstractSocket::SocketError socket
             emit currentReply->finishedWithError(errorCode, errorString);
         }
     }
-#endif // QT_NO_SSL
 
     // send the next request
     QMetaObject::invokeMethod(that, "_q_startNextRequest", Qt::QueuedConnection);
@@ -996,19 +1047,15 @@ void QHttpNetworkConnectionChannel::_q_error(QAbstractSocket::SocketError socket
 #ifndef QT_NO_NETWORKPROXY
 void QHttpNetworkConnectionChannel::_q_proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator* auth)
 {
-#ifndef QT_NO_SSL
-    if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeSPDY) {
+    if (connection->connectionType() != QHttpNetworkConnection::ConnectionTypeHTTP) {
         connection->d_func()->emitProxyAuthenticationRequired(this, proxy, auth);
     } else { // HTTP
-#endif // QT_NO_SSL
         // Need to dequeue the request before we can emit the error.
         if (!reply)
             connection->d_func()->dequeueRequest(socket);
         if (reply)
             connection->d_func()->emitProxyAuthenticationRequired(this, proxy, auth);
-#ifndef QT_NO_SSL
     }
-#endif // QT_NO_SSL
 }
 #endif
 
@@ -1024,6 +1071,13 @@ void QHttpNetworkConnectionChannel::_q_encrypted()
     QSslSocket *sslSocket = qobject_cast<QSslSocket *>(socket);
     Q_ASSERT(sslSocket);
 
+    if (connectEnd < 0)
+        connectEnd = QNetworkReplyMetricsPrivate::now();
+
+    // an HTTP/2 session does not survive the connection, negotiate again
+    if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeHTTP2)
+        protocolHandler.reset();
+
     if (!protocolHandler) {
         switch (sslSocket->sslConfiguration().nextProtocolNegotiationStatus()) {
         case QSslConfiguration::NextProtocolNegotiationNegotiated: /* fall through */
@@ -1037,6 +1091,11 @@ void QHttpNetworkConnectionChannel::_q_encrypted()
                 // no need to re-queue requests, if SPDY was enabled on the request it
                 // has gone to the SPDY queue already
                 break;
+            } else if (nextProtocol == QSslConfiguration::NextProtocolHttp2) {
+                protocolHandler.reset(new QHttp2ProtocolHandler(this));
+                connection->setConnectionType(QHttpNetworkConnection::ConnectionTypeHTTP2);
+                // requests that allowed HTTP/2 are in the multiplexed queue already
+                break;
             } else {
                 emitFinishedWithError(QNetworkReply::SslHandshakeFailedError,
                                       "detected unknown Next Protocol Negotiation protocol");
@@ -1060,8 +1119,9 @@ void QHttpNetworkConnectionChannel::_q_encrypted()
     state = QHttpNetworkConnectionChannel::IdleState;
     pendingEncrypt = false;
 
-    if (connection->connectionType() == QHttpNetworkConnection::ConnectionTypeSPDY) {
-        // we call setSpdyWasUsed(true) on the replies in the SPDY handler when the request is sent
+    if (connection->connectionType() != QHttpNetworkConnection::ConnectionTypeHTTP) {
+        // we call setSpdyWasUsed(true) / setHttp2WasUsed(true) on the replies
+        // in the protocol handler when the request is sent
         if (spdyRequestsToSend.count() > 0)
             // wait for data from the server first (e.g. initial window, max concurrent requests)
             QMetaObject::invokeMethod(connection, "_q_startNextRequest", Qt::QueuedConnection);
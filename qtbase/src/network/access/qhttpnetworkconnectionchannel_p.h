@@ -105,6 +105,10 @@ public:
     bool resendCurrent;
     int lastStatus; // last status received on this channel
     bool pendingEncrypt; // for https (send after encrypted)
+    qint64 connectStart; // metrics of the current connection, -1 if not reached
+    qint64 secureConnectionStart;
+    qint64 connectEnd;
+    int requestsOnConnection;
     int reconnectAttempts; // maximum 2 reconnection attempts
     QAuthenticatorPrivate::Method authMethod;
     QAuthenticatorPrivate::Method proxyAuthMethod;
@@ -113,11 +117,11 @@ public:
     bool authenticationCredentialsSent;
     bool proxyCredentialsSent;
     QScopedPointer<QAbstractProtocolHandler> protocolHandler;
+    QMultiMap<int, HttpMessagePair> spdyRequestsToSend; // SPDY and HTTP/2, sorted by priority
 #ifndef QT_NO_SSL
     bool ignoreAllSslErrors;
     QList<QSslError> ignoreSslErrorsList;
     QSslConfiguration sslConfiguration;
-    QMultiMap<int, HttpMessagePair> spdyRequestsToSend; // sorted by priority
     void ignoreSslErrors();
     void ignoreSslErrors(const QList<QSslError> &errors);
     void setSslConfiguration(const QSslConfiguration &config);
@@ -163,6 +167,9 @@ public:
 
     bool ensureConnection();
 
+    // stamps the reply's metrics when its request goes out on this channel
+    void recordRequestStart(QHttpNetworkReply *reply, const QByteArray &protocol);
+
     void allDone(); // reply header + body have been read
     void handleStatus(); // called from allDone()
 
@@ -44,10 +44,6 @@
 #    include <QtNetwork/qsslconfiguration.h>
 #endif
 
-#ifndef QT_NO_COMPRESS
-#include <zlib.h>
-#endif
-
 QT_BEGIN_NAMESPACE
 
 QHttpNetworkReply::QHttpNetworkReply(const QUrl &url, QObject *parent)
@@ -61,11 +57,6 @@ QHttpNetworkReply::~QHttpNetworkReply()
     if (d->connection) {
         d->connection->d_func()->removeReply(this);
     }
-
-#ifndef QT_NO_COMPRESS
-    if (d->autoDecompress && d->isCompressed() && d->inflateStrm)
-        inflateEnd(d->inflateStrm);
-#endif
 }
 
 QUrl QHttpNetworkReply::url() const
@@ -295,11 +286,26 @@ void QHttpNetworkReply::setSpdyWasUsed(bool spdy)
     d_func()->spdyUsed = spdy;
 }
 
+bool QHttpNetworkReply::isHttp2Used() const
+{
+    return d_func()->http2Used;
+}
+
+void QHttpNetworkReply::setHttp2WasUsed(bool http2)
+{
+    d_func()->http2Used = http2;
+}
+
 bool QHttpNetworkReply::isRedirecting() const
 {
     return d_func()->isRedirecting();
 }
 
+QNetworkReplyMetrics QHttpNetworkReply::metrics() const
+{
+    return d_func()->metrics;
+}
+
 QHttpNetworkConnection* QHttpNetworkReply::connection()
 {
     return d_func()->connection;
@@ -324,12 +330,8 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
       totallyUploadedData(0),
       connection(0),
       autoDecompress(false), responseData(), requestIsPrepared(false)
-      ,pipeliningUsed(false), spdyUsed(false), downstreamLimited(false)
+      ,pipeliningUsed(false), spdyUsed(false), http2Used(false), downstreamLimited(false)
       ,userProvidedDownloadBuffer(0)
-#ifndef QT_NO_COMPRESS
-      ,inflateStrm(0)
-#endif
-
 {
     QString scheme = newUrl.scheme();
     if (scheme == QLatin1String("preconnect-http")
@@ -340,10 +342,6 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
 
 QHttpNetworkReplyPrivate::~QHttpNetworkReplyPrivate()
 {
-#ifndef QT_NO_COMPRESS
-      if (inflateStrm)
-          delete inflateStrm;
-#endif
 }
 
 void QHttpNetworkReplyPrivate::clearHttpLayerInformation()
@@ -357,10 +355,7 @@ void QHttpNetworkReplyPrivate::clearHttpLayerInformation()
     currentChunkRead = 0;
     lastChunkRead = false;
     connectionCloseEnabled = true;
-#ifndef QT_NO_COMPRESS
-    if (autoDecompress && inflateStrm)
-        inflateEnd(inflateStrm);
-#endif
+    decoder.reset();
     fields.clear();
 }
 
@@ -381,8 +376,9 @@ qint64 QHttpNetworkReplyPrivate::bytesAvailable() const
 
 bool QHttpNetworkReplyPrivate::isCompressed()
 {
-    QByteArray encoding = headerField("content-encoding");
-    return qstricmp(encoding.constData(), "gzip") == 0 || qstricmp(encoding.constData(), "deflate") == 0;
+    if (decoder)
+        return true;
+    return QNetworkContentDecoder::isContentCodingSupported(headerField("content-encoding"));
 }
 
 void QHttpNetworkReplyPrivate::removeAutoDecompressHeader()
@@ -585,16 +581,11 @@ qint64 QHttpNetworkReplyPrivate::readHeader(QAbstractSocket *socket)
             (majorVersion == 1 && minorVersion == 0 &&
             (connectionHeaderField.isEmpty() && !headerField("proxy-connection").toLower().contains("keep-alive")));
 
-#ifndef QT_NO_COMPRESS
         if (autoDecompress && isCompressed()) {
-            // allocate inflate state
-            if (!inflateStrm)
-                inflateStrm = new z_stream;
-            int ret = initializeInflateStream();
-            if (ret != Z_OK)
+            decoder.reset(QNetworkContentDecoder::create(headerField("content-encoding")));
+            if (!decoder)
                 return -1;
         }
-#endif
 
     }
     return bytes;
@@ -699,17 +690,19 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
 {
     qint64 bytes = 0;
 
-#ifndef QT_NO_COMPRESS
-    // for gzip we'll allocate a temporary one that we then decompress
+    // for compressed content we'll allocate a temporary one that we then decompress
     QByteDataBuffer *tempOutDataBuffer = (autoDecompress ? new QByteDataBuffer : out);
-#else
-    QByteDataBuffer *tempOutDataBuffer = out;
-#endif
 
 
     if (isChunked()) {
         // chunked transfer encoding (rfc 2616, sec 3.6)
-        bytes += readReplyBodyChunked(socket, tempOutDataBuffer);
+        const qint64 haveRead = readReplyBodyChunked(socket, tempOutDataBuffer);
+        if (haveRead < 0) {
+            if (autoDecompress)
+                delete tempOutDataBuffer;
+            return -1;
+        }
+        bytes += haveRead;
     } else if (bodyLength > 0) {
         // we have a Content-Length
         bytes += readReplyBodyRaw(socket, tempOutDataBuffer, bodyLength - contentRead);
@@ -720,7 +713,6 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
         bytes += readReplyBodyRaw(socket, tempOutDataBuffer, socket->bytesAvailable());
     }
 
-#ifndef QT_NO_COMPRESS
     // This is true if there is compressed encoding and we're supposed to use it.
     if (autoDecompress) {
         qint64 uncompressRet = uncompressBodyData(tempOutDataBuffer, out);
@@ -728,84 +720,58 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
         if (uncompressRet < 0)
             return -1;
     }
-#endif
 
     contentRead += bytes;
     return bytes;
 }
 
-#ifndef QT_NO_COMPRESS
-int QHttpNetworkReplyPrivate::initializeInflateStream()
-{
-    inflateStrm->zalloc = Z_NULL;
-    inflateStrm->zfree = Z_NULL;
-    inflateStrm->opaque = Z_NULL;
-    inflateStrm->avail_in = 0;
-    inflateStrm->next_in = Z_NULL;
-    // "windowBits can also be greater than 15 for optional gzip decoding.
-    // Add 32 to windowBits to enable zlib and gzip decoding with automatic header detection"
-    // http://www.zlib.net/manual.html
-    int ret = inflateInit2(inflateStrm, MAX_WBITS+32);
-    Q_ASSERT(ret == Z_OK);
-    return ret;
-}
+// Size of the buffer the content decoder writes into
+static const int DecoderBufferSize = 64 * 1024;
 
 qint64 QHttpNetworkReplyPrivate::uncompressBodyData(QByteDataBuffer *in, QByteDataBuffer *out)
 {
-    if (!inflateStrm) { // happens when called from the SPDY protocol handler
-        inflateStrm = new z_stream;
-        initializeInflateStream();
+    if (!decoder) { // happens when called from the SPDY and HTTP/2 protocol handlers
+        decoder.reset(QNetworkContentDecoder::create(headerField("content-encoding")));
+        if (!decoder)
+            return -1;
     }
 
-    if (!inflateStrm)
-        return -1;
-
-    bool triedRawDeflate = false;
-    for (int i = 0; i < in->bufferCount(); i++) {
-        QByteArray &bIn = (*in)[i];
-
-        inflateStrm->avail_in = bIn.size();
-        inflateStrm->next_in = reinterpret_cast<Bytef*>(bIn.data());
-
-        do {
-            QByteArray bOut;
-            // make a wild guess about the uncompressed size.
-            bOut.reserve(inflateStrm->avail_in * 3 + 512);
-            inflateStrm->avail_out = bOut.capacity();
-            inflateStrm->next_out = reinterpret_cast<Bytef*>(bOut.data());
-
-            int ret = inflate(inflateStrm, Z_NO_FLUSH);
-            //All negative return codes are errors, in the context of HTTP compression, Z_NEED_DICT is also an error.
-            // in the case where we get Z_DATA_ERROR this could be because we received raw deflate compressed data.
-            if (ret == Z_DATA_ERROR && !triedRawDeflate) {
-                inflateEnd(inflateStrm);
-                triedRawDeflate = true;
-                inflateStrm->zalloc = Z_NULL;
-                inflateStrm->zfree = Z_NULL;
-                inflateStrm->opaque = Z_NULL;
-                inflateStrm->avail_in = 0;
-                inflateStrm->next_in = Z_NULL;
-                int ret = inflateInit2(inflateStrm, -MAX_WBITS);
-                if (ret != Z_OK) {
-                    return -1;
-                } else {
-                    inflateStrm->avail_in = bIn.size();
-                    inflateStrm->next_in = reinterpret_cast<Bytef*>(bIn.data());
-                    continue;
-                }
-            } else if (ret < 0 || ret == Z_NEED_DICT) {
+    for (int i = 0; i < in->bufferCount() && !decoder->atEnd(); i++) {
+        const QByteArray &bIn = (*in)[i];
+        const char *input = bIn.constData();
+        qint64 inputSize = bIn.size();
+
+        forever {
+            // A completely filled buffer is handed on as it is and replaced,
+            // the data of a partially filled one is copied out so that the
+            // buffer can be reused.
+            if (decoderBuffer.isEmpty())
+                decoderBuffer = QByteArray(DecoderBufferSize, Qt::Uninitialized);
+
+            qint64 inputUsed = 0;
+            qint64 outputUsed = 0;
+            if (!decoder->decode(input, inputSize, &inputUsed,
+                                 decoderBuffer.data(), decoderBuffer.size(), &outputUsed)) {
+                errorString = decoder->errorString();
                 return -1;
             }
-            bOut.resize(bOut.capacity() - inflateStrm->avail_out);
-            out->append(bOut);
-            if (ret == Z_STREAM_END)
-                return out->byteAmount();
-        } while (inflateStrm->avail_in > 0);
+            input += inputUsed;
+            inputSize -= inputUsed;
+
+            if (outputUsed == decoderBuffer.size()) {
+                out->append(decoderBuffer);
+                decoderBuffer.clear();
+                continue;
+            }
+            if (outputUsed > 0)
+                out->append(QByteArray(decoderBuffer.constData(), outputUsed));
+            if (decoder->atEnd() || inputSize == 0 || (inputUsed == 0 && outputUsed == 0))
+                break;
+        }
     }
 
     return out->byteAmount();
 }
-#endif
 
 qint64 QHttpNetworkReplyPrivate::readReplyBodyRaw(QAbstractSocket *socket, QByteDataBuffer *out, qint64 size)
 {
@@ -840,106 +806,107 @@ qint64 QHttpNetworkReplyPrivate::readReplyBodyRaw(QAbstractSocket *socket, QByte
 
 }
 
+// The longest chunk-size or trailer line accepted in a chunked body; the
+// line is short unless it carries chunk extensions or trailer fields.
+static const int MaxChunkLineLength = 8 * 1024;
+
+// Returns the value of the chunk-size \a size, which has to consist of hex
+// digits only, or -1. QByteArray::toLongLong() alone would also accept a
+// sign, a "0x" prefix and blanks.
+static qint64 parseChunkSize(const QByteArray &size)
+{
+    if (size.isEmpty())
+        return -1;
+    for (int i = 0; i < size.size(); ++i) {
+        const char c = size.at(i);
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')))
+            return -1;
+    }
+    bool ok = false;
+    const qint64 value = size.toLongLong(&ok, 16);
+    return ok ? value : -1;
+}
+
 qint64 QHttpNetworkReplyPrivate::readReplyBodyChunked(QAbstractSocket *socket, QByteDataBuffer *out)
 {
+    // Chunked transfer encoding (RFC 7230, section 4.1). Between the chunk
+    // data, everything is a line: the chunk-size line, the CRLF ending the
+    // chunk data and, after the last chunk, the trailer fields. Chunk data
+    // is read in as large blocks as the socket has available.
     qint64 bytes = 0;
     while (socket->bytesAvailable()) {
 
         if (readBufferMaxSize && (bytes > readBufferMaxSize))
             break;
 
-        if (!lastChunkRead && currentChunkRead >= currentChunkSize) {
-            // For the first chunk and when we're done with a chunk
-            currentChunkSize = 0;
-            currentChunkRead = 0;
-            if (bytes) {
-                // After a chunk
-                char crlf[2];
-                // read the "\r\n" after the chunk
-                qint64 haveRead = socket->read(crlf, 2);
-                // FIXME: This code is slightly broken and not optimal. What if the 2 bytes are not available yet?!
-                // For nice reasons (the toLong in getChunkSize accepting \n at the beginning
-                // it right now still works, but we should definitely fix this.
-
-                if (haveRead != 2)
-                    return bytes; // FIXME
-                bytes += haveRead;
-            }
-            // Note that chunk size gets stored in currentChunkSize, what is returned is the bytes read
-            bytes += getChunkSize(socket, &currentChunkSize);
-            if (currentChunkSize == -1)
+        if (currentChunkRead < currentChunkSize) {
+            // try to begin reading this chunk / to read what is missing for this chunk
+            qint64 haveRead = readReplyBodyRaw(socket, out, currentChunkSize - currentChunkRead);
+            if (haveRead <= 0)
                 break;
-        }
-        // if the chunk size is 0, end of the stream
-        if (currentChunkSize == 0 || lastChunkRead) {
-            lastChunkRead = true;
-            // try to read the "\r\n" after the chunk
-            char crlf[2];
-            qint64 haveRead = socket->read(crlf, 2);
-            if (haveRead > 0)
-                bytes += haveRead;
-
-            if ((haveRead == 2 && crlf[0] == '\r' && crlf[1] == '\n') || (haveRead == 1 && crlf[0] == '\n'))
-                state = AllDoneState;
-            else if (haveRead == 1 && crlf[0] == '\r')
-                break; // Still waiting for the last \n
-            else if (haveRead > 0) {
-                // If we read something else then CRLF, we need to close the channel.
-                forceConnectionCloseEnabled = true;
-                state = AllDoneState;
-            }
-            break;
+            currentChunkRead += haveRead;
+            bytes += haveRead;
+            continue;
         }
 
-        // otherwise, try to begin reading this chunk / to read what is missing for this chunk
-        qint64 haveRead = readReplyBodyRaw (socket, out, currentChunkSize - currentChunkRead);
-        currentChunkRead += haveRead;
+        qint64 haveRead = readChunkLine(socket);
+        if (haveRead < 0)
+            return -1;
         bytes += haveRead;
+        if (!fragment.endsWith('\n'))
+            break; // still waiting for the rest of the line
 
-        // ### error checking here
+        const QByteArray line = fragment.trimmed();
+        fragment.clear();
 
+        if (lastChunkRead) {
+            // trailer fields are not used; an empty line ends the body
+            if (line.isEmpty()) {
+                state = AllDoneState;
+                break;
+            }
+        } else if (currentChunkSize > 0) {
+            // the CRLF after the chunk data
+            if (!line.isEmpty())
+                return -1;
+            currentChunkSize = 0;
+            currentChunkRead = 0;
+        } else if (!line.isEmpty()) {
+            // ignore the chunk-extension
+            const int extension = line.indexOf(';');
+            currentChunkSize = parseChunkSize(extension == -1 ? line : line.left(extension).trimmed());
+            if (currentChunkSize < 0)
+                return -1;
+            currentChunkRead = 0;
+            // if the chunk size is 0, end of the stream
+            if (currentChunkSize == 0)
+                lastChunkRead = true;
+        }
     }
     return bytes;
 }
 
-qint64 QHttpNetworkReplyPrivate::getChunkSize(QAbstractSocket *socket, qint64 *chunkSize)
-{
-    qint64 bytes = 0;
-    char crlf[2];
-    *chunkSize = -1;
-
-    int bytesAvailable = socket->bytesAvailable();
-    // FIXME rewrite to permanent loop without bytesAvailable
-    while (bytesAvailable > bytes) {
-        qint64 sniffedBytes = socket->peek(crlf, 2);
-        int fragmentSize = fragment.size();
-
-        // check the next two bytes for a "\r\n", skip blank lines
-        if ((fragmentSize && sniffedBytes == 2 && crlf[0] == '\r' && crlf[1] == '\n')
-           ||(fragmentSize > 1 && fragment.endsWith('\r')  && crlf[0] == '\n'))
-        {
-            bytes += socket->read(crlf, 1);     // read the \r or \n
-            if (crlf[0] == '\r')
-                bytes += socket->read(crlf, 1); // read the \n
-            bool ok = false;
-            // ignore the chunk-extension
-            fragment = fragment.mid(0, fragment.indexOf(';')).trimmed();
-            *chunkSize = fragment.toLong(&ok, 16);
-            fragment.clear();
-            break; // size done
-        } else {
-            // read the fragment to the buffer
-            char c = 0;
-            qint64 haveRead = socket->read(&c, 1);
-            if (haveRead < 0) {
-                return -1; // FIXME
-            }
-            bytes += haveRead;
-            fragment.append(c);
-        }
-    }
+/*!
+    \internal
 
-    return bytes;
+    Appends the next line of a chunked body, or as much of it as is
+    available, to fragment. Returns the number of bytes read, or -1 if the
+    line is too long.
+*/
+qint64 QHttpNetworkReplyPrivate::readChunkLine(QAbstractSocket *socket)
+{
+    // readLine() stops at the end of the line or of the buffered data, so
+    // a line that arrives in pieces is collected across calls.
+    char line[MaxChunkLineLength + 1];
+    const qint64 haveRead = socket->readLine(line, sizeof line);
+    if (haveRead <= 0)
+        return 0;
+    fragment.append(line, int(haveRead));
+    // readLine() only stops short of the end of the line when the data or
+    // the space runs out; in the latter case, the line is too long.
+    if (fragment.size() >= MaxChunkLineLength && !fragment.endsWith('\n'))
+        return -1;
+    return haveRead;
 }
 
 bool QHttpNetworkReplyPrivate::isRedirecting() const
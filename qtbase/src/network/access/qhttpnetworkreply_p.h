@@ -47,10 +47,6 @@
 #include <qplatformdefs.h>
 #ifndef QT_NO_HTTP
 
-#ifndef QT_NO_COMPRESS
-struct z_stream_s;
-#endif
-
 #include <QtNetwork/qtcpsocket.h>
 // it's safe to include these even if SSL support is not enabled
 #include <QtNetwork/qsslsocket.h>
@@ -58,6 +54,8 @@ struct z_stream_s;
 
 #include <QtNetwork/qnetworkrequest.h>
 #include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkcontentdecoder.h>
+#include <QtNetwork/qnetworkreplymetrics.h>
 #include <qbuffer.h>
 
 #include <private/qobject_p.h>
@@ -66,6 +64,7 @@ struct z_stream_s;
 #include <private/qauthenticator_p.h>
 #include <private/qringbuffer_p.h>
 #include <private/qbytedata_p.h>
+#include <private/qnetworkreplymetrics_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -129,6 +128,8 @@ public:
     bool isPipeliningUsed() const;
     bool isSpdyUsed() const;
     void setSpdyWasUsed(bool spdy);
+    bool isHttp2Used() const;
+    void setHttp2WasUsed(bool http2);
 
     bool isRedirecting() const;
 
@@ -139,6 +140,8 @@ public:
 
     static bool isHttpRedirect(int statusCode);
 
+    QNetworkReplyMetrics metrics() const;
+
 #ifndef QT_NO_SSL
     QSslConfiguration sslConfiguration() const;
     void setSslConfiguration(const QSslConfiguration &config);
@@ -172,6 +175,7 @@ private:
     friend class QHttpNetworkConnectionChannel;
     friend class QHttpProtocolHandler;
     friend class QSpdyProtocolHandler;
+    friend class QHttp2ProtocolHandler;
 };
 
 
@@ -194,7 +198,7 @@ public:
 
     qint64 readReplyBodyRaw(QAbstractSocket *in, QByteDataBuffer *out, qint64 size);
     qint64 readReplyBodyChunked(QAbstractSocket *in, QByteDataBuffer *out);
-    qint64 getChunkSize(QAbstractSocket *in, qint64 *chunkSize);
+    qint64 readChunkLine(QAbstractSocket *in);
 
     bool isRedirecting() const;
     bool shouldEmitSignals();
@@ -243,7 +247,7 @@ public:
     qint32 windowSizeUpload; // only for SPDY
     qint32 currentlyReceivedDataInWindow; // only for SPDY
     qint32 currentlyUploadedDataInWindow; // only for SPDY
-    qint64 totallyUploadedData; // only for SPDY
+    qint64 totallyUploadedData; // only for SPDY and HTTP/2
     QPointer<QHttpNetworkConnection> connection;
     QPointer<QHttpNetworkConnectionChannel> connectionChannel;
 
@@ -255,16 +259,19 @@ public:
 
     bool pipeliningUsed;
     bool spdyUsed;
+    bool http2Used;
     bool downstreamLimited;
 
     char* userProvidedDownloadBuffer;
     QUrl redirectUrl;
 
-#ifndef QT_NO_COMPRESS
-    z_stream_s *inflateStrm;
-    int initializeInflateStream();
+    QScopedPointer<QNetworkContentDecoder> decoder;
+    QByteArray decoderBuffer; // reused for the decoded data of all chunks
     qint64 uncompressBodyData(QByteDataBuffer *in, QByteDataBuffer *out);
-#endif
+
+    QNetworkReplyMetrics metrics;
+    inline QNetworkReplyMetricsPrivate *metricsData()
+    { return QNetworkReplyMetricsPrivate::get(metrics); }
 };
 
 
@@ -42,7 +42,9 @@ QHttpNetworkRequestPrivate::QHttpNetworkRequestPrivate(QHttpNetworkRequest::Oper
         QHttpNetworkRequest::Priority pri, const QUrl &newUrl)
     : QHttpNetworkHeaderPrivate(newUrl), operation(op), priority(pri), uploadByteDevice(0),
       autoDecompress(false), pipeliningAllowed(false), spdyAllowed(false),
-      withCredentials(true), preConnect(false), followRedirect(false), redirectCount(0)
+      http2Allowed(false),
+      withCredentials(true), preConnect(false), followRedirect(false), redirectCount(0),
+      startTime(-1)
 {
 }
 
@@ -55,12 +57,14 @@ QHttpNetworkRequestPrivate::QHttpNetworkRequestPrivate(const QHttpNetworkRequest
     autoDecompress = other.autoDecompress;
     pipeliningAllowed = other.pipeliningAllowed;
     spdyAllowed = other.spdyAllowed;
+    http2Allowed = other.http2Allowed;
     customVerb = other.customVerb;
     withCredentials = other.withCredentials;
     ssl = other.ssl;
     preConnect = other.preConnect;
     followRedirect = other.followRedirect;
     redirectCount = other.redirectCount;
+    startTime = other.startTime;
 }
 
 QHttpNetworkRequestPrivate::~QHttpNetworkRequestPrivate()
@@ -76,6 +80,7 @@ bool QHttpNetworkRequestPrivate::operator==(const QHttpNetworkRequestPrivate &ot
         && (autoDecompress == other.autoDecompress)
         && (pipeliningAllowed == other.pipeliningAllowed)
         && (spdyAllowed == other.spdyAllowed)
+        && (http2Allowed == other.http2Allowed)
         // we do not clear the customVerb in setOperation
         && (operation != QHttpNetworkRequest::Custom || (customVerb == other.customVerb))
         && (withCredentials == other.withCredentials)
@@ -239,6 +244,16 @@ void QHttpNetworkRequest::setRedirectCount(int count)
     d->redirectCount = count;
 }
 
+qint64 QHttpNetworkRequest::startTime() const
+{
+    return d->startTime;
+}
+
+void QHttpNetworkRequest::setStartTime(qint64 time)
+{
+    d->startTime = time;
+}
+
 qint64 QHttpNetworkRequest::contentLength() const
 {
     return d->contentLength();
@@ -325,6 +340,16 @@ void QHttpNetworkRequest::setSPDYAllowed(bool b)
     d->spdyAllowed = b;
 }
 
+bool QHttpNetworkRequest::isHTTP2Allowed() const
+{
+    return d->http2Allowed;
+}
+
+void QHttpNetworkRequest::setHTTP2Allowed(bool b)
+{
+    d->http2Allowed = b;
+}
+
 bool QHttpNetworkRequest::withCredentials() const
 {
     return d->withCredentials;
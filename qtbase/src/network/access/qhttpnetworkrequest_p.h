@@ -109,6 +109,9 @@ public:
     bool isSPDYAllowed() const;
     void setSPDYAllowed(bool b);
 
+    bool isHTTP2Allowed() const;
+    void setHTTP2Allowed(bool b);
+
     bool withCredentials() const;
     void setWithCredentials(bool b);
 
@@ -124,6 +127,9 @@ public:
     int redirectCount() const;
     void setRedirectCount(int count);
 
+    qint64 startTime() const;
+    void setStartTime(qint64 time);
+
     void setUploadByteDevice(QNonContiguousByteDevice *bd);
     QNonContiguousByteDevice* uploadByteDevice() const;
 
@@ -137,6 +143,7 @@ private:
     friend class QHttpNetworkConnectionChannel;
     friend class QHttpProtocolHandler;
     friend class QSpdyProtocolHandler;
+    friend class QHttp2ProtocolHandler;
 };
 
 class QHttpNetworkRequestPrivate : public QHttpNetworkHeaderPrivate
@@ -157,11 +164,13 @@ public:
     bool autoDecompress;
     bool pipeliningAllowed;
     bool spdyAllowed;
+    bool http2Allowed;
     bool withCredentials;
     bool ssl;
     bool preConnect;
     bool followRedirect;
     int redirectCount;
+    qint64 startTime;
 };
 
 
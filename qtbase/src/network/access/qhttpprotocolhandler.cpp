@@ -38,8 +38,35 @@
 
 #ifndef QT_NO_HTTP
 
+#if defined(Q_OS_LINUX) && !defined(QT_NO_SENDFILE)
+#  define QHTTP_USE_SENDFILE
+#  include <sys/sendfile.h>
+#  include <errno.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
+#ifdef QHTTP_USE_SENDFILE
+// The most one call to sendRequest() hands to sendfile(), so that a fast
+// peer cannot keep the HTTP thread from serving its other connections
+static const qint64 sendFileBudget = 4 * 1024 * 1024;
+
+static bool canSendFile(QAbstractSocket *socket)
+{
+    // Writing to the descriptor directly is only correct for a plain TCP
+    // connection with nothing queued in front of it
+#ifndef QT_NO_SSL
+    if (qobject_cast<QSslSocket *>(socket))
+        return false;
+#endif
+#ifndef QT_NO_NETWORKPROXY
+    if (socket->proxy().type() != QNetworkProxy::NoProxy)
+        return false;
+#endif
+    return socket->bytesToWrite() == 0 && socket->socketDescriptor() != -1;
+}
+#endif
+
 QHttpProtocolHandler::QHttpProtocolHandler(QHttpNetworkConnectionChannel *channel)
     : QAbstractProtocolHandler(channel)
 {
@@ -103,6 +130,12 @@ void QHttpProtocolHandler::_q_receiveReply()
                 return;
             }
             bytes += statusBytes;
+            if (statusBytes > 0) {
+                QNetworkReplyMetricsPrivate *metrics = m_reply->d_func()->metricsData();
+                if (metrics->responseStart < 0)
+                    metrics->responseStart = QNetworkReplyMetricsPrivate::now();
+                metrics->bytesReceived += statusBytes;
+            }
             m_channel->lastStatus = m_reply->d_func()->statusCode;
             break;
         }
@@ -115,6 +148,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                 return;
             }
             bytes += headerBytes;
+            replyPrivate->metricsData()->bytesReceived += headerBytes;
             // If headers were parsed successfully now it is the ReadingDataState
             if (replyPrivate->state == QHttpNetworkReplyPrivate::ReadingDataState) {
                 if (replyPrivate->isCompressed() && replyPrivate->autoDecompress) {
@@ -165,6 +199,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                if (haveRead > 0) {
                    bytes += haveRead;
                    replyPrivate->totalProgress += haveRead;
+                   replyPrivate->metricsData()->bytesReceived += haveRead;
                    // the user will get notified of it via progress signal
                    emit m_reply->dataReadProgress(replyPrivate->totalProgress, replyPrivate->bodyLength);
                } else if (haveRead == 0) {
@@ -180,6 +215,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                 qint64 haveRead = replyPrivate->readBodyFast(m_socket, &replyPrivate->responseData);
                 bytes += haveRead;
                 replyPrivate->totalProgress += haveRead;
+                replyPrivate->metricsData()->bytesReceived += haveRead;
                 if (replyPrivate->shouldEmitSignals()) {
                     emit m_reply->readyRead();
                     emit m_reply->dataReadProgress(replyPrivate->totalProgress, replyPrivate->bodyLength);
@@ -193,6 +229,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                 if (haveRead > 0) {
                     bytes += haveRead;
                     replyPrivate->totalProgress += haveRead;
+                    replyPrivate->metricsData()->bytesReceived += haveRead;
                     if (replyPrivate->shouldEmitSignals()) {
                         emit m_reply->readyRead();
                         emit m_reply->dataReadProgress(replyPrivate->totalProgress, replyPrivate->bodyLength);
@@ -313,6 +350,8 @@ bool QHttpProtocolHandler::sendRequest()
 #else
         QByteArray header = QHttpNetworkRequestPrivate::header(m_channel->request, false);
 #endif
+        m_channel->recordRequestStart(m_reply, QByteArrayLiteral("http/1.1"));
+        replyPrivate->metricsData()->bytesSent += header.size();
         m_socket->write(header);
         // flushing is dangerous (QSslSocket calls transmit which might read or error)
 //        m_socket->flush();
@@ -344,13 +383,48 @@ bool QHttpProtocolHandler::sendRequest()
             break;
         }
 
-        // only feed the QTcpSocket buffer when there is less than 32 kB in it
-        const qint64 socketBufferFill = 32*1024;
-        const qint64 socketWriteMaxSize = 16*1024;
+#ifndef QT_NO_SSL
+        QSslSocket *sslSocket = qobject_cast<QSslSocket*>(m_socket);
+#endif
+        QNonContiguousByteDeviceFileImpl *fileDevice =
+                qobject_cast<QNonContiguousByteDeviceFileImpl *>(uploadByteDevice);
+
+#ifdef QHTTP_USE_SENDFILE
+        // A file goes from the page cache to a plain TCP socket without
+        // being copied to user space. Once the socket is full, the buffered
+        // writes below take over until bytesWritten() brings us back here.
+        if (fileDevice && canSendFile(m_socket)) {
+            qint64 budget = sendFileBudget;
+            while (budget > 0 && m_channel->written != m_channel->bytesTotal) {
+                off_t offset = fileDevice->fileOffset();
+                const qint64 count = qMin(budget, m_channel->bytesTotal - m_channel->written);
+                const ssize_t sent = ::sendfile(m_socket->socketDescriptor(), fileDevice->handle(),
+                                                &offset, size_t(count));
+                if (sent < 0 && errno == EINTR)
+                    continue;
+                if (sent <= 0)
+                    break; // would block, or an error the buffered path reports
+                m_channel->written += sent;
+                m_reply->d_func()->metricsData()->bytesSent += sent;
+                fileDevice->advanceReadPointer(sent);
+                budget -= sent;
+                emit m_reply->dataSendProgress(m_channel->written, m_channel->bytesTotal);
+            }
+            if (m_channel->written == m_channel->bytesTotal) {
+                m_channel->state = QHttpNetworkConnectionChannel::WaitingState;
+                sendRequest();
+                break;
+            }
+        }
+#endif
 
+        // only feed the QTcpSocket buffer when there is less than 32 kB in it.
+        // Files are fed in larger blocks: they are read ahead in large chunks
+        // anyway, and QSslSocket encrypts larger writes in full-sized records.
+        const qint64 socketBufferFill = fileDevice ? 512*1024 : 32*1024;
+        const qint64 socketWriteMaxSize = fileDevice ? 256*1024 : 16*1024;
 
 #ifndef QT_NO_SSL
-        QSslSocket *sslSocket = qobject_cast<QSslSocket*>(m_socket);
         // if it is really an ssl socket, check more than just bytesToWrite()
         while ((m_socket->bytesToWrite() + (sslSocket ? sslSocket->encryptedBytesToWrite() : 0))
                 <= socketBufferFill && m_channel->bytesTotal != m_channel->written)
@@ -386,6 +460,7 @@ bool QHttpProtocolHandler::sendRequest()
                     return false;
                 } else {
                     m_channel->written += currentWriteSize;
+                    m_reply->d_func()->metricsData()->bytesSent += currentWriteSize;
                     uploadByteDevice->advanceReadPointer(currentWriteSize);
 
                     emit m_reply->dataSendProgress(m_channel->written, m_channel->bytesTotal);
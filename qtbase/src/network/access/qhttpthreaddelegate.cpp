@@ -42,6 +42,9 @@
 #include "private/qhttpnetworkreply_p.h"
 #include "private/qnetworkaccesscache_p.h"
 #include "private/qnoncontiguousbytedevice_p.h"
+#ifndef QT_NO_SSL
+#include "private/qsslconfiguration_p.h"
+#endif
 
 #ifndef QT_NO_HTTP
 
@@ -227,6 +230,7 @@ QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     , incomingStatusCode(0)
     , isPipeliningUsed(false)
     , isSpdyUsed(false)
+    , isHttp2Used(false)
     , incomingContentLength(-1)
     , incomingErrorCode(QNetworkReply::NoError)
     , downloadBuffer(0)
@@ -280,8 +284,23 @@ void QHttpThreadDelegate::startRequest()
 
     QHttpNetworkConnection::ConnectionType connectionType
             = QHttpNetworkConnection::ConnectionTypeHTTP;
+    if (httpRequest.isHTTP2Allowed()) {
+        connectionType = QHttpNetworkConnection::ConnectionTypeHTTP2;
+        // to differentiate HTTP/2 requests from HTTP/1 ones to the same host
+        urlCopy.setScheme(ssl ? QStringLiteral("h2") : QStringLiteral("h2c"));
 #ifndef QT_NO_SSL
-    if (httpRequest.isSPDYAllowed() && ssl) {
+        if (ssl) {
+            QList<QByteArray> nextProtocols;
+            nextProtocols << QSslConfiguration::NextProtocolHttp2;
+            if (httpRequest.isSPDYAllowed())
+                nextProtocols << QSslConfiguration::NextProtocolSpdy3_0;
+            nextProtocols << QSslConfiguration::NextProtocolHttp1_1;
+            incomingSslConfiguration.setAllowedNextProtocols(nextProtocols);
+        }
+#endif // QT_NO_SSL
+    }
+#ifndef QT_NO_SSL
+    else if (httpRequest.isSPDYAllowed() && ssl) {
         connectionType = QHttpNetworkConnection::ConnectionTypeSPDY;
         urlCopy.setScheme(QStringLiteral("spdy")); // to differentiate SPDY requests from HTTPS requests
         QList<QByteArray> nextProtocols;
@@ -299,7 +318,14 @@ void QHttpThreadDelegate::startRequest()
     else
 #endif
         cacheKey = makeCacheKey(urlCopy, 0);
-
+#ifndef QT_NO_SSL
+    // an encrypted connection keeps the certificates it presented and
+    // accepted, so only hand it to requests configured the same way
+    if (ssl)
+        cacheKey += '/' + QSslConfigurationPrivate::digest(incomingSslConfiguration).toHex();
+#endif
+    if (!connectionScope.isEmpty())
+        cacheKey += '/' + connectionScope;
 
     // the http object is actually a QHttpNetworkConnection
     httpConnection = static_cast<QNetworkAccessCachedHttpConnection *>(connections.localData()->requestEntryNow(cacheKey));
@@ -500,6 +526,8 @@ void QHttpThreadDelegate::finishedSlot()
     if (httpRequest.isFollowRedirects() && httpReply->isRedirecting())
         emit redirected(httpReply->redirectUrl(), httpReply->statusCode(), httpReply->request().redirectCount() - 1);
 
+    takeMetrics();
+    emit downloadMetrics(metrics);
     emit downloadFinished();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
@@ -524,6 +552,7 @@ void QHttpThreadDelegate::synchronousFinishedSlot()
     }
 
     synchronousDownloadData = httpReply->readAll();
+    takeMetrics();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
@@ -544,6 +573,8 @@ void QHttpThreadDelegate::finishedWithErrorSlot(QNetworkReply::NetworkError erro
         emit sslConfigurationChanged(httpReply->sslConfiguration());
 #endif
     emit error(errorCode,detail);
+    takeMetrics();
+    emit downloadMetrics(metrics);
     emit downloadFinished();
 
 
@@ -565,12 +596,19 @@ void QHttpThreadDelegate::synchronousFinishedWithErrorSlot(QNetworkReply::Networ
     incomingErrorDetail = detail;
 
     synchronousDownloadData = httpReply->readAll();
+    takeMetrics();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
     httpReply = 0;
 }
 
+void QHttpThreadDelegate::takeMetrics()
+{
+    metrics = httpReply->metrics();
+    QNetworkReplyMetricsPrivate::get(metrics)->responseEnd = QNetworkReplyMetricsPrivate::now();
+}
+
 static void downloadBufferDeleter(char *ptr)
 {
     delete[] ptr;
@@ -611,6 +649,7 @@ void QHttpThreadDelegate::headerChangedSlot()
     isPipeliningUsed = httpReply->isPipeliningUsed();
     incomingContentLength = httpReply->contentLength();
     isSpdyUsed = httpReply->isSpdyUsed();
+    isHttp2Used = httpReply->isHttp2Used();
 
     emit downloadMetaData(incomingHeaders,
                           incomingStatusCode,
@@ -618,7 +657,8 @@ void QHttpThreadDelegate::headerChangedSlot()
                           isPipeliningUsed,
                           downloadBuffer,
                           incomingContentLength,
-                          isSpdyUsed);
+                          isSpdyUsed,
+                          isHttp2Used);
 }
 
 void QHttpThreadDelegate::synchronousHeaderChangedSlot()
@@ -635,6 +675,7 @@ void QHttpThreadDelegate::synchronousHeaderChangedSlot()
     incomingReasonPhrase = httpReply->reasonPhrase();
     isPipeliningUsed = httpReply->isPipeliningUsed();
     isSpdyUsed = httpReply->isSpdyUsed();
+    isHttp2Used = httpReply->isHttp2Used();
     incomingContentLength = httpReply->contentLength();
 }
 
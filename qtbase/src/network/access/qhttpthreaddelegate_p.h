@@ -53,6 +53,7 @@
 #include <QSslError>
 #include <QList>
 #include <QNetworkReply>
+#include <QNetworkReplyMetrics>
 #include "qhttpnetworkrequest_p.h"
 #include "qhttpnetworkconnection_p.h"
 #include <QSharedPointer>
@@ -83,6 +84,8 @@ public:
 #ifndef QT_NO_SSL
     QSslConfiguration incomingSslConfiguration;
 #endif
+    // Keeps connections of different managers apart in the shared pool
+    QByteArray connectionScope;
     QHttpNetworkRequest httpRequest;
     qint64 downloadBufferMaximumSize;
     qint64 readBufferMaxSize;
@@ -95,6 +98,8 @@ public:
     QNetworkProxy transparentProxy;
 #endif
     QSharedPointer<QNetworkAccessAuthenticationManager> authenticationManager;
+    // An upload device read from the HTTP thread directly, see QNonContiguousByteDeviceFileImpl
+    QSharedPointer<QNonContiguousByteDevice> uploadByteDevice;
     bool synchronous;
 
     // outgoing, Retrieved in the synchronous HTTP case
@@ -104,9 +109,11 @@ public:
     QString incomingReasonPhrase;
     bool isPipeliningUsed;
     bool isSpdyUsed;
+    bool isHttp2Used;
     qint64 incomingContentLength;
     QNetworkReply::NetworkError incomingErrorCode;
     QString incomingErrorDetail;
+    QNetworkReplyMetrics metrics;
 #ifndef QT_NO_BEARERMANAGEMENT
     QSharedPointer<QNetworkSession> networkSession;
 #endif
@@ -122,6 +129,9 @@ protected:
     // Used for implementing the synchronous HTTP, see startRequestSynchronously()
     QEventLoop *synchronousRequestLoop;
 
+    // copies the metrics of httpReply and stamps the end of the response
+    void takeMetrics();
+
 signals:
     void authenticationRequired(const QHttpNetworkRequest &request, QAuthenticator *);
 #ifndef QT_NO_NETWORKPROXY
@@ -134,10 +144,11 @@ signals:
     void preSharedKeyAuthenticationRequired(QSslPreSharedKeyAuthenticator *);
 #endif
     void downloadMetaData(QList<QPair<QByteArray,QByteArray> >, int, QString, bool,
-                          QSharedPointer<char>, qint64, bool);
+                          QSharedPointer<char>, qint64, bool, bool);
     void downloadProgress(qint64, qint64);
     void downloadData(QByteArray);
     void error(QNetworkReply::NetworkError, const QString);
+    void downloadMetrics(const QNetworkReplyMetrics &);
     void downloadFinished();
     void redirected(const QUrl &url, int httpStatus, int maxRedirectsRemainig);
 
@@ -51,6 +51,7 @@
 #include "qnetworkreplyfileimpl_p.h"
 
 #include "QtCore/qbuffer.h"
+#include "QtCore/qmutex.h"
 #include "QtCore/qurl.h"
 #include "QtCore/qvector.h"
 #include "QtNetwork/private/qauthenticator_p.h"
@@ -74,6 +75,17 @@ Q_GLOBAL_STATIC(QNetworkAccessFtpBackendFactory, ftpBackend)
 Q_GLOBAL_STATIC(QNetworkAccessDebugPipeBackendFactory, debugpipeBackend)
 #endif
 
+// The HTTP thread shared by all managers with the shared connection pool
+// enabled; the connections live in that thread's QNetworkAccessCache.
+struct QNetworkAccessSharedHttpThread
+{
+    QNetworkAccessSharedHttpThread() : thread(0), users(0) {}
+    QMutex mutex;
+    QThread *thread;
+    int users;
+};
+Q_GLOBAL_STATIC(QNetworkAccessSharedHttpThread, sharedHttpThread)
+
 #if defined(Q_OS_MACX)
 
 #include <CoreServices/CoreServices.h>
@@ -461,6 +473,7 @@ QNetworkAccessManager::QNetworkAccessManager(QObject *parent)
 #endif
     qRegisterMetaType<QNetworkReply::NetworkError>();
     qRegisterMetaType<QSharedPointer<char> >();
+    qRegisterMetaType<QNetworkReplyMetrics>();
 
 #ifndef QT_NO_BEARERMANAGEMENT
     Q_D(QNetworkAccessManager);
@@ -1024,7 +1037,8 @@ QSharedPointer<QNetworkSession> QNetworkAccessManagerPrivate::getNetworkSession(
     on \a sslConfiguration with QSslConfiguration::NextProtocolSpdy3_0 contained in
     the list of allowed protocols. When using SPDY, one single connection per host is
     enough, i.e. calling this method multiple times per host will not result in faster
-    network transactions.
+    network transactions. The same applies to HTTP/2, which is preconnected when
+    QSslConfiguration::NextProtocolHttp2 is among the allowed protocols.
 
     \note This function has no possibility to report errors.
 
@@ -1046,6 +1060,9 @@ void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quin
     if (sslConfiguration.allowedNextProtocols().contains(
                 QSslConfiguration::NextProtocolSpdy3_0))
         request.setAttribute(QNetworkRequest::SpdyAllowedAttribute, true);
+    if (sslConfiguration.allowedNextProtocols().contains(
+                QSslConfiguration::NextProtocolHttp2))
+        request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
 
     get(request);
 }
@@ -1305,12 +1322,97 @@ QStringList QNetworkAccessManager::supportedSchemesImplementation() const
 
     This function is useful for doing auto tests.
 
+    If the shared connection pool is enabled, the pooled connections are
+    only closed once no other QNetworkAccessManager uses the pool.
+
+    \sa setSharedConnectionPoolEnabled()
 */
 void QNetworkAccessManager::clearAccessCache()
 {
     QNetworkAccessManagerPrivate::clearCache(this);
 }
 
+/*!
+    \since 5.6
+
+    If \a enabled is true, HTTP and HTTPS requests of this manager are
+    handled by a thread shared with every other QNetworkAccessManager that
+    has the shared connection pool enabled, so that they reuse each other's
+    idle persistent connections instead of each opening their own. By
+    default every manager keeps its own connections.
+
+    Unencrypted connections are pooled per scheme, host, port and proxy, as
+    they are within a single manager. HTTPS connections are additionally
+    keyed by the QSslConfiguration of the request, so that a connection is
+    only reused by requests that present and accept the same certificates,
+    and they are never handed to another manager: SSL errors ignored on a
+    connection stay ignored for the requests that follow it. Other managers
+    still resume the TLS sessions of those connections where the server
+    allows it, which saves most of the cost of a new handshake.
+
+    Connection-based authentication (such as NTLM) negotiated on a pooled
+    connection is not tied to the manager that performed it, so only enable
+    the pool for managers that may share it.
+
+    This should be set before the first request is made; changing it closes
+    the connections of this manager, as clearAccessCache() does.
+
+    \sa isSharedConnectionPoolEnabled()
+*/
+void QNetworkAccessManager::setSharedConnectionPoolEnabled(bool enabled)
+{
+    Q_D(QNetworkAccessManager);
+    if (d->sharedConnectionPool == enabled)
+        return;
+    d->releaseHttpThread();
+    d->sharedConnectionPool = enabled;
+    if (enabled && !d->connectionPoolScope) {
+        static QBasicAtomicInt nextScope = Q_BASIC_ATOMIC_INITIALIZER(0);
+        d->connectionPoolScope = nextScope.fetchAndAddRelaxed(1) + 1;
+    }
+}
+
+/*!
+    \since 5.6
+
+    Returns true if this manager shares its HTTP connections with other
+    managers.
+
+    \sa setSharedConnectionPoolEnabled()
+*/
+bool QNetworkAccessManager::isSharedConnectionPoolEnabled() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->sharedConnectionPool;
+}
+
+/*!
+    \since 5.6
+
+    Returns the metrics of all HTTP and HTTPS requests that this manager
+    has sent, summed up per host name. A request is added to the metrics
+    of its host when its reply finishes; each request of a redirect chain
+    counts for the host it was sent to.
+
+    \sa clearHostMetrics(), QNetworkReply::metrics()
+*/
+QHash<QString, QNetworkHostMetrics> QNetworkAccessManager::hostMetrics() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->hostMetrics;
+}
+
+/*!
+    \since 5.6
+
+    Resets the metrics returned by hostMetrics().
+*/
+void QNetworkAccessManager::clearHostMetrics()
+{
+    Q_D(QNetworkAccessManager);
+    d->hostMetrics.clear();
+}
+
 void QNetworkAccessManagerPrivate::_q_replyFinished()
 {
     Q_Q(QNetworkAccessManager);
@@ -1510,28 +1612,67 @@ void QNetworkAccessManagerPrivate::clearCache(QNetworkAccessManager *manager)
     manager->d_func()->objectCache.clear();
     manager->d_func()->authenticationManager->clearCache();
 
-    if (manager->d_func()->httpThread) {
-        manager->d_func()->httpThread->quit();
-        manager->d_func()->httpThread->wait(5000);
-        if (manager->d_func()->httpThread->isFinished())
-            delete manager->d_func()->httpThread;
-        else
-            QObject::connect(manager->d_func()->httpThread, SIGNAL(finished()), manager->d_func()->httpThread, SLOT(deleteLater()));
-        manager->d_func()->httpThread = 0;
-    }
+    manager->d_func()->releaseHttpThread();
 }
 
 QNetworkAccessManagerPrivate::~QNetworkAccessManagerPrivate()
 {
-    if (httpThread) {
-        httpThread->quit();
-        httpThread->wait(5000);
-        if (httpThread->isFinished())
-            delete httpThread;
-        else
-            QObject::connect(httpThread, SIGNAL(finished()), httpThread, SLOT(deleteLater()));
-        httpThread = 0;
+    releaseHttpThread();
+}
+
+static void stopHttpThread(QThread *thread)
+{
+    thread->quit();
+    thread->wait(5000);
+    if (thread->isFinished())
+        delete thread;
+    else
+        QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+}
+
+QThread *QNetworkAccessManagerPrivate::acquireHttpThread()
+{
+    if (httpThread)
+        return httpThread;
+
+    if (!sharedConnectionPool) {
+        // We use the manager-global thread.
+        // At some point we could switch to having multiple threads if it makes sense.
+        httpThread = new QThread();
+        httpThread->setObjectName(QStringLiteral("Qt HTTP thread"));
+        httpThread->start();
+        return httpThread;
+    }
+
+    QNetworkAccessSharedHttpThread *shared = sharedHttpThread();
+    QMutexLocker locker(&shared->mutex);
+    if (!shared->thread) {
+        shared->thread = new QThread();
+        shared->thread->setObjectName(QStringLiteral("Qt HTTP shared thread"));
+        shared->thread->start();
+    }
+    ++shared->users;
+    httpThread = shared->thread;
+    return httpThread;
+}
+
+void QNetworkAccessManagerPrivate::releaseHttpThread()
+{
+    if (!httpThread)
+        return;
+
+    QThread *thread = httpThread;
+    httpThread = 0;
+    if (sharedConnectionPool) {
+        QNetworkAccessSharedHttpThread *shared = sharedHttpThread();
+        if (!shared)
+            return;
+        QMutexLocker locker(&shared->mutex);
+        if (--shared->users > 0)
+            return;
+        shared->thread = 0;
     }
+    stopHttpThread(thread);
 }
 
 #ifndef QT_NO_BEARERMANAGEMENT
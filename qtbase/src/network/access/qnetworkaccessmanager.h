@@ -48,10 +48,12 @@ class QAbstractNetworkCache;
 class QAuthenticator;
 class QByteArray;
 template<typename T> class QList;
+template<class Key, class T> class QHash;
 class QNetworkCookie;
 class QNetworkCookieJar;
 class QNetworkRequest;
 class QNetworkReply;
+class QNetworkHostMetrics;
 class QNetworkProxy;
 class QNetworkProxyFactory;
 class QSslError;
@@ -98,6 +100,12 @@ public:
 
     void clearAccessCache();
 
+    void setSharedConnectionPoolEnabled(bool enabled);
+    bool isSharedConnectionPoolEnabled() const;
+
+    QHash<QString, QNetworkHostMetrics> hostMetrics() const;
+    void clearHostMetrics();
+
 #ifndef QT_NO_NETWORKPROXY
     QNetworkProxy proxy() const;
     void setProxy(const QNetworkProxy &proxy);
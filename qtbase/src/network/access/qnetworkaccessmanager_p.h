@@ -52,6 +52,8 @@
 #include "QtNetwork/qnetworkproxy.h"
 #include "QtNetwork/qnetworksession.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
+#include "qnetworkreplymetrics_p.h"
+#include "QtCore/qhash.h"
 #ifndef QT_NO_BEARERMANAGEMENT
 #include "QtNetwork/qnetworkconfigmanager.h"
 #endif
@@ -84,6 +86,8 @@ public:
 #endif
           cookieJarCreated(false),
           defaultAccessControl(true),
+          sharedConnectionPool(false),
+          connectionPoolScope(0),
           authenticationManager(QSharedPointer<QNetworkAccessAuthenticationManager>::create())
     {
 #ifndef QT_NO_BEARERMANAGEMENT
@@ -152,6 +156,9 @@ public:
 
     QNetworkRequest prepareMultipart(const QNetworkRequest &request, QHttpMultiPart *multiPart);
 
+    QThread *acquireHttpThread();
+    void releaseHttpThread();
+
     // this is the cache for storing downloaded files
     QAbstractNetworkCache *networkCache;
 
@@ -183,10 +190,19 @@ public:
 
     bool cookieJarCreated;
     bool defaultAccessControl;
+    // HTTP runs in the process-wide thread shared with other managers
+    bool sharedConnectionPool;
+    // unique per manager, keeps its encrypted connections out of the others' reach
+    int connectionPoolScope;
 
     // The cache with authorization data:
     QSharedPointer<QNetworkAccessAuthenticationManager> authenticationManager;
 
+    // the metrics of all HTTP replies, per host name
+    QHash<QString, QNetworkHostMetrics> hostMetrics;
+    inline void addHostMetrics(const QString &host, const QNetworkReplyMetrics &metrics, bool failed)
+    { QNetworkHostMetricsPrivate::add(&hostMetrics[host], metrics, failed); }
+
     // this cache can be used by individual backends to cache e.g. their TCP connections to a server
     // and use the connections for multiple requests.
     QNetworkAccessCache objectCache;
@@ -0,0 +1,456 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnetworkcontentdecoder.h"
+#include "qnetworkcontentdecoder_p.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpair.h>
+#include <QtCore/private/qringbuffer_p.h>
+
+#ifndef QT_NO_COMPRESS
+#include <zlib.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QNetworkContentDecoder
+    \brief The QNetworkContentDecoder class is the base class for decoders
+           of HTTP content codings.
+    \since 5.6
+
+    \ingroup network
+    \inmodule QtNetwork
+
+    When a request does not set an \c Accept-Encoding header itself, the
+    Network Access API announces every content coding for which a decoder
+    is registered, and transparently decodes replies that use one of them.
+    The \c gzip and \c deflate codings are registered by default if Qt was
+    built with zlib support.
+
+    Further codings, for instance \c br, are added by implementing decode()
+    and atEnd() in a subclass and registering a factory function for the
+    coding name with registerContentCoding():
+
+    \code
+    class BrotliDecoder : public QNetworkContentDecoder
+    {
+        ...
+    };
+
+    static QNetworkContentDecoder *createBrotliDecoder()
+    {
+        return new BrotliDecoder;
+    }
+
+    QNetworkContentDecoder::registerContentCoding("br", createBrotliDecoder);
+    \endcode
+
+    A new decoder is created for every reply. Decoders are used from the
+    thread that handles the HTTP connection, so a decoder must not rely on
+    the thread that registered it. The factory function however may be
+    called from any thread.
+
+    \sa QNetworkRequest::UploadContentEncodingAttribute
+*/
+
+/*!
+    \typedef QNetworkContentDecoder::Factory
+
+    A pointer to a function that creates a new decoder and returns it. The
+    caller takes ownership of the decoder.
+*/
+
+namespace {
+struct ContentCodingRegistry
+{
+    ContentCodingRegistry()
+    {
+#ifndef QT_NO_COMPRESS
+        codings.append(qMakePair(QByteArray("gzip"), &QZlibContentDecoder::create));
+        codings.append(qMakePair(QByteArray("deflate"), &QZlibContentDecoder::create));
+#endif
+    }
+
+    int indexOf(const QByteArray &coding) const
+    {
+        for (int i = 0; i < codings.count(); ++i) {
+            if (qstricmp(codings.at(i).first.constData(), coding.constData()) == 0)
+                return i;
+        }
+        return -1;
+    }
+
+    QMutex mutex;
+    // kept in registration order, which is the order of the Accept-Encoding header
+    QList<QPair<QByteArray, QNetworkContentDecoder::Factory> > codings;
+};
+}
+
+Q_GLOBAL_STATIC(ContentCodingRegistry, contentCodingRegistry)
+
+/*!
+    \internal
+*/
+QNetworkContentDecoder::QNetworkContentDecoder()
+{
+}
+
+/*!
+    Destroys the decoder.
+*/
+QNetworkContentDecoder::~QNetworkContentDecoder()
+{
+}
+
+/*!
+    \fn bool QNetworkContentDecoder::decode(const char *input, qint64 inputSize, qint64 *inputUsed, char *output, qint64 outputSize, qint64 *outputUsed)
+
+    Decodes up to \a inputSize bytes of encoded data from \a input and
+    writes up to \a outputSize bytes of decoded data to \a output. The
+    number of bytes consumed and produced is stored in \a inputUsed and
+    \a outputUsed.
+
+    The decoder keeps whatever state it needs between calls; input it
+    consumed must not be passed again. If the call filled \a output
+    completely, the caller calls decode() again, even without further
+    input, until less than \a outputSize bytes are produced. The output
+    buffer is reused for the next call, so the decoder must not keep
+    pointers into it.
+
+    Returns \c false if the data could not be decoded, in which case the
+    reply fails and errorString() describes the problem.
+*/
+
+/*!
+    \fn bool QNetworkContentDecoder::atEnd() const
+
+    Returns \c true if the decoder has seen the end of the encoded data. Any
+    input that follows is ignored.
+*/
+
+/*!
+    Returns a human-readable description of the last decoding error. The
+    default implementation returns an empty string.
+*/
+QString QNetworkContentDecoder::errorString() const
+{
+    return QString();
+}
+
+/*!
+    Registers \a factory as the function that creates decoders for the
+    content coding \a coding, replacing any previous registration for the
+    same coding. Coding names are compared case-insensitively.
+
+    The coding is announced in the \c Accept-Encoding header of requests
+    sent after the call.
+
+    \sa unregisterContentCoding(), contentCodings()
+*/
+void QNetworkContentDecoder::registerContentCoding(const QByteArray &coding, Factory factory)
+{
+    if (coding.isEmpty() || !factory)
+        return;
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry)
+        return;
+    QMutexLocker locker(&registry->mutex);
+    const int index = registry->indexOf(coding);
+    if (index >= 0)
+        registry->codings[index].second = factory;
+    else
+        registry->codings.append(qMakePair(coding.toLower(), factory));
+}
+
+/*!
+    Removes the decoder registered for the content coding \a coding. This
+    also works for the built-in \c gzip and \c deflate codings.
+
+    \sa registerContentCoding()
+*/
+void QNetworkContentDecoder::unregisterContentCoding(const QByteArray &coding)
+{
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry)
+        return;
+    QMutexLocker locker(&registry->mutex);
+    const int index = registry->indexOf(coding);
+    if (index >= 0)
+        registry->codings.removeAt(index);
+}
+
+/*!
+    Returns the names of the content codings that decoders are registered
+    for, in the order of registration.
+*/
+QList<QByteArray> QNetworkContentDecoder::contentCodings()
+{
+    QList<QByteArray> result;
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry)
+        return result;
+    QMutexLocker locker(&registry->mutex);
+    result.reserve(registry->codings.count());
+    for (int i = 0; i < registry->codings.count(); ++i)
+        result.append(registry->codings.at(i).first);
+    return result;
+}
+
+/*!
+    Returns \c true if a decoder is registered for the content coding
+    \a coding.
+*/
+bool QNetworkContentDecoder::isContentCodingSupported(const QByteArray &coding)
+{
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry || coding.isEmpty())
+        return false;
+    QMutexLocker locker(&registry->mutex);
+    return registry->indexOf(coding) >= 0;
+}
+
+/*!
+    Creates a new decoder for the content coding \a coding and returns it,
+    or returns 0 if no decoder is registered for it. The caller takes
+    ownership of the decoder.
+*/
+QNetworkContentDecoder *QNetworkContentDecoder::create(const QByteArray &coding)
+{
+    Factory factory = 0;
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry)
+        return 0;
+    {
+        QMutexLocker locker(&registry->mutex);
+        const int index = registry->indexOf(coding.trimmed());
+        if (index < 0)
+            return 0;
+        factory = registry->codings.at(index).second;
+    }
+    return factory();
+}
+
+/*!
+    \internal
+
+    Returns the value of the Accept-Encoding header announcing all
+    registered content codings, or an empty byte array if there are none.
+*/
+QByteArray QNetworkContentDecoderPrivate::acceptEncoding()
+{
+    QByteArray result;
+    ContentCodingRegistry *registry = contentCodingRegistry();
+    if (!registry)
+        return result;
+    QMutexLocker locker(&registry->mutex);
+    for (int i = 0; i < registry->codings.count(); ++i) {
+        if (i)
+            result += ", ";
+        result += registry->codings.at(i).first;
+    }
+    return result;
+}
+
+#ifndef QT_NO_COMPRESS
+
+// zlib counts bytes in uInt; larger buffers are handled in several passes
+static const qint64 MaxZlibChunkSize = Q_INT64_C(1) << 30;
+
+// The unit in which compressed request bodies grow
+static const qint64 EncoderOutputChunkSize = 16 * 1024;
+
+QZlibContentDecoder::QZlibContentDecoder()
+    : stream(new z_stream), totalIn(0), initialized(false), triedRawDeflate(false),
+      streamEnd(false)
+{
+}
+
+QZlibContentDecoder::~QZlibContentDecoder()
+{
+    if (initialized)
+        inflateEnd(stream);
+    delete stream;
+}
+
+QNetworkContentDecoder *QZlibContentDecoder::create()
+{
+    return new QZlibContentDecoder;
+}
+
+bool QZlibContentDecoder::initialize(int windowBits)
+{
+    if (initialized)
+        inflateEnd(stream);
+    stream->zalloc = Z_NULL;
+    stream->zfree = Z_NULL;
+    stream->opaque = Z_NULL;
+    stream->avail_in = 0;
+    stream->next_in = Z_NULL;
+    initialized = (inflateInit2(stream, windowBits) == Z_OK);
+    if (!initialized)
+        error = QCoreApplication::translate("QNetworkContentDecoder", "Could not initialize the decompressor");
+    return initialized;
+}
+
+bool QZlibContentDecoder::decode(const char *input, qint64 inputSize, qint64 *inputUsed,
+                                 char *output, qint64 outputSize, qint64 *outputUsed)
+{
+    *inputUsed = 0;
+    *outputUsed = 0;
+    if (streamEnd)
+        return true;
+
+    // "windowBits can also be greater than 15 for optional gzip decoding.
+    // Add 32 to windowBits to enable zlib and gzip decoding with automatic header detection"
+    // http://www.zlib.net/manual.html
+    if (!initialized && !initialize(MAX_WBITS + 32))
+        return false;
+
+    const uInt availIn = uInt(qMin(inputSize, MaxZlibChunkSize));
+    const uInt availOut = uInt(qMin(outputSize, MaxZlibChunkSize));
+
+    forever {
+        stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input));
+        stream->avail_in = availIn;
+        stream->next_out = reinterpret_cast<Bytef *>(output);
+        stream->avail_out = availOut;
+
+        int ret = inflate(stream, Z_NO_FLUSH);
+        // Z_DATA_ERROR right at the start means that the data has no zlib
+        // or gzip header; retry the same input as raw deflate data.
+        if (ret == Z_DATA_ERROR && !triedRawDeflate && totalIn == 0) {
+            triedRawDeflate = true;
+            if (!initialize(-MAX_WBITS))
+                return false;
+            continue;
+        }
+        // no progress was possible, which is not an error in a stream
+        if (ret == Z_BUF_ERROR)
+            ret = Z_OK;
+        // All negative return codes are errors, in the context of HTTP
+        // compression Z_NEED_DICT is also an error.
+        if (ret < 0 || ret == Z_NEED_DICT) {
+            error = QCoreApplication::translate("QNetworkContentDecoder", "Invalid compressed data: %1")
+                    .arg(QString::fromLatin1(stream->msg ? stream->msg : "unknown error"));
+            return false;
+        }
+
+        *inputUsed = availIn - stream->avail_in;
+        *outputUsed = availOut - stream->avail_out;
+        totalIn += *inputUsed;
+        if (ret == Z_STREAM_END)
+            streamEnd = true;
+        return true;
+    }
+}
+
+bool QZlibContentDecoder::atEnd() const
+{
+    return streamEnd;
+}
+
+QString QZlibContentDecoder::errorString() const
+{
+    return error;
+}
+
+QZlibContentEncoder::QZlibContentEncoder(const QByteArray &coding)
+    : stream(new z_stream), initialized(false)
+{
+    stream->zalloc = Z_NULL;
+    stream->zfree = Z_NULL;
+    stream->opaque = Z_NULL;
+    // 16 added to windowBits writes a gzip header instead of a zlib one
+    const int windowBits = qstricmp(coding.constData(), "deflate") == 0 ? MAX_WBITS : MAX_WBITS + 16;
+    initialized = isContentCodingSupported(coding)
+            && deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits,
+                            8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+QZlibContentEncoder::~QZlibContentEncoder()
+{
+    if (initialized)
+        deflateEnd(stream);
+    delete stream;
+}
+
+bool QZlibContentEncoder::isContentCodingSupported(const QByteArray &coding)
+{
+    return qstricmp(coding.constData(), "gzip") == 0 || qstricmp(coding.constData(), "deflate") == 0;
+}
+
+bool QZlibContentEncoder::encode(const char *data, qint64 size, QRingBuffer *out)
+{
+    while (size > 0) {
+        const qint64 chunkSize = qMin(size, MaxZlibChunkSize);
+        if (!deflateInto(data, chunkSize, Z_NO_FLUSH, out))
+            return false;
+        data += chunkSize;
+        size -= chunkSize;
+    }
+    return true;
+}
+
+bool QZlibContentEncoder::finish(QRingBuffer *out)
+{
+    return deflateInto(0, 0, Z_FINISH, out);
+}
+
+bool QZlibContentEncoder::deflateInto(const char *data, qint64 size, int flush, QRingBuffer *out)
+{
+    if (!initialized)
+        return false;
+
+    stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream->avail_in = uInt(size);
+    // compress straight into the free space at the end of the ring buffer
+    do {
+        stream->next_out = reinterpret_cast<Bytef *>(out->reserve(EncoderOutputChunkSize));
+        stream->avail_out = uInt(EncoderOutputChunkSize);
+        const int ret = deflate(stream, flush);
+        out->chop(stream->avail_out);
+        if (ret == Z_STREAM_ERROR)
+            return false;
+        if (ret == Z_STREAM_END)
+            return true;
+    } while (stream->avail_out == 0 || stream->avail_in > 0);
+    return true;
+}
+
+#endif // QT_NO_COMPRESS
+
+QT_END_NAMESPACE
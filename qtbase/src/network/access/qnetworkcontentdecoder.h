@@ -0,0 +1,72 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNETWORKCONTENTDECODER_H
+#define QNETWORKCONTENTDECODER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+QT_BEGIN_NAMESPACE
+
+
+class Q_NETWORK_EXPORT QNetworkContentDecoder
+{
+public:
+    typedef QNetworkContentDecoder *(*Factory)();
+
+    virtual ~QNetworkContentDecoder();
+
+    virtual bool decode(const char *input, qint64 inputSize, qint64 *inputUsed,
+                        char *output, qint64 outputSize, qint64 *outputUsed) = 0;
+    virtual bool atEnd() const = 0;
+    virtual QString errorString() const;
+
+    static void registerContentCoding(const QByteArray &coding, Factory factory);
+    static void unregisterContentCoding(const QByteArray &coding);
+    static QList<QByteArray> contentCodings();
+    static bool isContentCodingSupported(const QByteArray &coding);
+    static QNetworkContentDecoder *create(const QByteArray &coding);
+
+protected:
+    QNetworkContentDecoder();
+
+private:
+    Q_DISABLE_COPY(QNetworkContentDecoder)
+};
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKCONTENTDECODER_H
@@ -0,0 +1,119 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNETWORKCONTENTDECODER_P_H
+#define QNETWORKCONTENTDECODER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qnetworkcontentdecoder.h"
+
+#ifndef QT_NO_COMPRESS
+struct z_stream_s;
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class QRingBuffer;
+
+class QNetworkContentDecoderPrivate
+{
+public:
+    static QByteArray acceptEncoding();
+};
+
+#ifndef QT_NO_COMPRESS
+// Decodes the "gzip" and "deflate" content codings. Servers are known to
+// send raw deflate data for "deflate" instead of the zlib format, so a
+// stream that does not start with a zlib or gzip header is retried as raw
+// deflate data.
+class QZlibContentDecoder : public QNetworkContentDecoder
+{
+public:
+    QZlibContentDecoder();
+    ~QZlibContentDecoder();
+
+    bool decode(const char *input, qint64 inputSize, qint64 *inputUsed,
+                char *output, qint64 outputSize, qint64 *outputUsed) Q_DECL_OVERRIDE;
+    bool atEnd() const Q_DECL_OVERRIDE;
+    QString errorString() const Q_DECL_OVERRIDE;
+
+    static QNetworkContentDecoder *create();
+
+private:
+    bool initialize(int windowBits);
+
+    z_stream_s *stream;
+    qint64 totalIn;
+    bool initialized;
+    bool triedRawDeflate;
+    bool streamEnd;
+    QString error;
+};
+
+// Compresses request bodies with the "gzip" or "deflate" content coding.
+class Q_AUTOTEST_EXPORT QZlibContentEncoder
+{
+public:
+    explicit QZlibContentEncoder(const QByteArray &coding);
+    ~QZlibContentEncoder();
+
+    static bool isContentCodingSupported(const QByteArray &coding);
+
+    bool isValid() const { return initialized; }
+    bool encode(const char *data, qint64 size, QRingBuffer *out);
+    bool finish(QRingBuffer *out);
+
+private:
+    bool deflateInto(const char *data, qint64 size, int flush, QRingBuffer *out);
+
+    z_stream_s *stream;
+    bool initialized;
+
+    Q_DISABLE_COPY(QZlibContentEncoder)
+};
+#endif // QT_NO_COMPRESS
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKCONTENTDECODER_P_H
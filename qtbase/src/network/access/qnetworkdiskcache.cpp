@@ -43,14 +43,18 @@
 #include <qdatastream.h>
 #include <qdatetime.h>
 #include <qdiriterator.h>
+#include <qendian.h>
+#include <qmap.h>
+#include <qsavefile.h>
 #include <qurl.h>
 #include <qcryptographichash.h>
 #include <qdebug.h>
 
 #define CACHE_POSTFIX QLatin1String(".d")
 #define PREPARED_SLASH QLatin1String("prepared/")
-#define CACHE_VERSION 8
+#define CACHE_VERSION 9
 #define DATA_DIR QLatin1String("data")
+#define INDEX_FILE QLatin1String("index")
 
 #define MAX_COMPRESSION_SIZE (1024 * 1024 * 3)
 
@@ -68,7 +72,15 @@ QT_BEGIN_NAMESPACE
     QNetworkDiskCache stores each url in its own file inside of the
     cacheDirectory using QDataStream.  Files with a text MimeType
     are compressed using qCompress.  Data is written to disk only in insert()
-    and updateMetaData().
+    and updateMetaData(); the files are compressed and moved into place on a
+    background thread.
+
+    The cache keeps an index of its files with their size and the time they
+    were last accessed, so that lookups of urls that are not cached do not
+    touch the disk and expire() can remove the least recently used files
+    without scanning the cache directory. The index is saved when the cache
+    is destroyed; if it is missing, for example after a crash, it is rebuilt
+    from the cache directory once.
 
     Currently you cannot share the same cache files with more than
     one disk cache.
@@ -113,6 +125,7 @@ QNetworkDiskCache::~QNetworkDiskCache()
         it.next();
         delete it.value();
     }
+    d->finishWrites();
 }
 
 /*!
@@ -132,6 +145,9 @@ QString QNetworkDiskCache::cacheDirectory() const
     Prepared cache items will be stored in the new cache directory when
     they are inserted.
 
+    Files that earlier versions of QNetworkDiskCache stored in \a cacheDir
+    cannot be read and are removed in the background.
+
     \sa QDesktopServices::CacheLocation
 */
 void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
@@ -142,6 +158,10 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
     Q_D(QNetworkDiskCache);
     if (cacheDir.isEmpty())
         return;
+    d->finishWrites();
+    // the writer's temporary files belong in the new directory
+    d->writer.reset();
+    d->lastItem.reset();
     d->cacheDirectory = cacheDir;
     QDir dir(d->cacheDirectory);
     d->cacheDirectory = dir.absolutePath();
@@ -150,6 +170,8 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
 
     d->dataDirectory = d->cacheDirectory + DATA_DIR + QString::number(CACHE_VERSION) + QLatin1Char('/');
     d->prepareLayout();
+    d->removeOldVersions();
+    d->loadIndex();
 }
 
 /*!
@@ -163,6 +185,7 @@ qint64 QNetworkDiskCache::cacheSize() const
     Q_D(const QNetworkDiskCache);
     if (d->cacheDirectory.isEmpty())
         return 0;
+    const_cast<QNetworkDiskCachePrivate *>(d)->processWriteResults();
     if (d->currentCacheSize < 0) {
         QNetworkDiskCache *that = const_cast<QNetworkDiskCache*>(this);
         that->d_func()->currentCacheSize = that->expire();
@@ -251,53 +274,70 @@ void QNetworkDiskCachePrivate::prepareLayout()
     QDir helper;
     helper.mkpath(cacheDirectory + PREPARED_SLASH);
 
-    //Create directory and subdirectories 0-F
+    //Create directory and subdirectories 00-FF
     helper.mkpath(dataDirectory);
-    for (uint i = 0; i < 16 ; i++) {
-        QString str = QString::number(i, 16);
+    for (uint i = 0; i < 256 ; i++) {
+        QString str = QString::number(i, 16).rightJustified(2, QLatin1Char('0'));
         QString subdir = dataDirectory + str;
         helper.mkdir(subdir);
     }
 }
 
+/*!
+    Removes the data directories of earlier cache versions, whose files are
+    never read, on the writer thread.
+*/
+void QNetworkDiskCachePrivate::removeOldVersions()
+{
+    QVector<QNetworkDiskCacheWriter::Job> jobs;
+    const QStringList dirs = QDir(cacheDirectory).entryList(QStringList() << (DATA_DIR + QLatin1Char('*')),
+                                                            QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < dirs.count(); ++i) {
+        bool ok;
+        const int version = dirs.at(i).midRef(DATA_DIR.size()).toInt(&ok);
+        if (!ok || version >= CACHE_VERSION)
+            continue;
+        QNetworkDiskCacheWriter::Job job;
+        job.type = QNetworkDiskCacheWriter::Job::RemoveDirectory;
+        job.fileName = cacheDirectory + dirs.at(i);
+        jobs.append(job);
+    }
+    if (!jobs.isEmpty())
+        ensureWriter()->enqueue(jobs);
+}
 
 void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
 {
     Q_Q(QNetworkDiskCache);
     Q_ASSERT(cacheItem->metaData.saveToDisk());
 
-    QString fileName = cacheFileName(cacheItem->metaData.url());
-    Q_ASSERT(!fileName.isEmpty());
+    const quint64 key = urlKey(cacheItem->metaData.url());
 
-    if (QFile::exists(fileName)) {
-        if (!QFile::remove(fileName)) {
-            qWarning() << "QNetworkDiskCache: couldn't remove the cache file " << fileName;
+    QNetworkDiskCacheWriter::Job job;
+    job.type = QNetworkDiskCacheWriter::Job::Store;
+    job.key = key;
+    job.fileName = dataDirectory + keyFileName(key);
+
+    qint64 size;
+    if (cacheItem->file) {
+        if (!cacheItem->file->isOpen() || cacheItem->file->error() != QFile::NoError)
             return;
-        }
+        // the writer moves the file into place once it is closed
+        cacheItem->file->setAutoRemove(false);
+        size = cacheItem->file->size();
+        job.tmpFileName = cacheItem->file->fileName();
+        cacheItem->file->close();
+    } else {
+        job.metaData = cacheItem->metaData;
+        job.data = cacheItem->data.data();
+        size = 1024 + job.data.size(); // corrected once the file is written
     }
 
-    if (currentCacheSize > 0)
-        currentCacheSize += 1024 + cacheItem->size();
-    currentCacheSize = q->expire();
-    if (!cacheItem->file) {
-        QString templateName = tmpCacheFileName();
-        cacheItem->file = new QTemporaryFile(templateName, &cacheItem->data);
-        if (cacheItem->file->open()) {
-            cacheItem->writeHeader(cacheItem->file);
-            cacheItem->writeCompressedData(cacheItem->file);
-        }
-    }
+    removeEntry(key);
+    addEntry(key, size, QDateTime::currentMSecsSinceEpoch());
+    ensureWriter()->enqueue(QVector<QNetworkDiskCacheWriter::Job>() << job);
 
-    if (cacheItem->file
-        && cacheItem->file->isOpen()
-        && cacheItem->file->error() == QFile::NoError) {
-        cacheItem->file->setAutoRemove(false);
-        // ### use atomic rename rather then remove & rename
-        if (cacheItem->file->rename(fileName))
-            currentCacheSize += cacheItem->file->size();
-        else
-            cacheItem->file->setAutoRemove(true);
-    }
+    currentCacheSize = q->expire();
     if (cacheItem->metaData.url() == lastItem.metaData.url())
         lastItem.reset();
 }
@@ -326,7 +366,12 @@ bool QNetworkDiskCache::remove(const QUrl &url)
 
     if (d->lastItem.metaData.url() == url)
         d->lastItem.reset();
-    return d->removeFile(d->cacheFileName(url));
+
+    const quint64 key = d->urlKey(url);
+    if (!d->removeEntry(key))
+        return false;
+    d->enqueueRemoval(QVector<quint64>() << key);
+    return true;
 }
 
 /*!
@@ -343,12 +388,12 @@ bool QNetworkDiskCachePrivate::removeFile(const QString &file)
     QString fileName = info.fileName();
     if (!fileName.endsWith(CACHE_POSTFIX))
         return false;
-    qint64 size = info.size();
-    if (QFile::remove(file)) {
-        currentCacheSize -= size;
-        return true;
+    quint64 key;
+    if (file.startsWith(dataDirectory) && keyFromFileName(fileName, &key)) {
+        waitForWrite(key);
+        removeEntry(key);
     }
-    return false;
+    return QFile::remove(file);
 }
 
 /*!
@@ -362,7 +407,14 @@ QNetworkCacheMetaData QNetworkDiskCache::metaData(const QUrl &url)
     Q_D(QNetworkDiskCache);
     if (d->lastItem.metaData.url() == url)
         return d->lastItem.metaData;
-    return fileMetaData(d->cacheFileName(url));
+
+    // urls that are not in the index are not cached, no need to ask the disk
+    const quint64 key = d->urlKey(url);
+    if (!d->index.contains(key))
+        return QNetworkCacheMetaData();
+    d->waitForWrite(key);
+    d->touch(key);
+    return fileMetaData(d->dataDirectory + d->keyFileName(key));
 }
 
 /*!
@@ -403,9 +455,17 @@ QIODevice *QNetworkDiskCache::data(const QUrl &url)
         buffer.reset(new QBuffer);
         buffer->setData(d->lastItem.data.data());
     } else {
-        QScopedPointer<QFile> file(new QFile(d->cacheFileName(url)));
-        if (!file->open(QFile::ReadOnly | QIODevice::Unbuffered))
+        const quint64 key = d->urlKey(url);
+        if (!d->index.contains(key))
             return 0;
+        d->waitForWrite(key);
+        d->touch(key);
+
+        QScopedPointer<QFile> file(new QFile(d->dataDirectory + d->keyFileName(key)));
+        if (!file->open(QFile::ReadOnly | QIODevice::Unbuffered)) {
+            d->removeEntry(key); // the file was removed behind our back
+            return 0;
+        }
 
         if (!d->lastItem.read(file.data(), true)) {
             file->close();
@@ -502,8 +562,9 @@ void QNetworkDiskCache::setMaximumCacheSize(qint64 size)
 
     When the current size of the cache is greater than the maximumCacheSize()
     older cache files are removed until the total size is less then 90% of
-    maximumCacheSize() starting with the oldest ones first using the file
-    creation date to determine how old a cache file is.
+    maximumCacheSize() starting with the least recently used ones, as
+    recorded in the index of the cache. The files are removed on a
+    background thread.
 
     Subclasses can reimplement this function to change the order that cache
     files are removed taking into account information in the application
@@ -517,6 +578,7 @@ void QNetworkDiskCache::setMaximumCacheSize(qint64 size)
 qint64 QNetworkDiskCache::expire()
 {
     Q_D(QNetworkDiskCache);
+    d->processWriteResults();
     if (d->currentCacheSize >= 0 && d->currentCacheSize < maximumCacheSize())
         return d->currentCacheSize;
 
@@ -528,57 +590,23 @@ qint64 QNetworkDiskCache::expire()
     // close file handle to prevent "in use" error when QFile::remove() is called
     d->lastItem.reset();
 
-    QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
-    QDirIterator it(cacheDirectory(), filters, QDirIterator::Subdirectories);
-
-    QMultiMap<QDateTime, QString> cacheItems;
-    qint64 totalSize = 0;
-    while (it.hasNext()) {
-        QString path = it.next();
-        QFileInfo info = it.fileInfo();
-        QString fileName = info.fileName();
-        if (fileName.endsWith(CACHE_POSTFIX)) {
-            cacheItems.insert(info.created(), path);
-            totalSize += info.size();
-        }
-    }
-
-    int removedFiles = 0;
+    QVector<quint64> removedKeys;
     qint64 goal = (maximumCacheSize() * 9) / 10;
-    QMultiMap<QDateTime, QString>::const_iterator i = cacheItems.constBegin();
-    while (i != cacheItems.constEnd()) {
-        if (totalSize < goal)
-            break;
-        QString name = i.value();
-        QFile file(name);
-
-        if (name.contains(PREPARED_SLASH)) {
-            QHashIterator<QIODevice*, QCacheItem*> iterator(d->inserting);
-            while (iterator.hasNext()) {
-                iterator.next();
-                QCacheItem *item = iterator.value();
-                if (item && item->file && item->file->fileName() == name) {
-                    delete item->file;
-                    item->file = 0;
-                    break;
-                }
-            }
-        }
-
-        qint64 size = file.size();
-        file.remove();
-        totalSize -= size;
-        ++removedFiles;
-        ++i;
+    while (d->currentCacheSize >= goal && !d->lru.isEmpty()) {
+        const quint64 key = d->lru.first();
+        d->removeEntry(key);
+        removedKeys.append(key);
     }
+    if (!removedKeys.isEmpty())
+        d->enqueueRemoval(removedKeys);
 #if defined(QNETWORKDISKCACHE_DEBUG)
-    if (removedFiles > 0) {
+    if (!removedKeys.isEmpty()) {
         qDebug() << "QNetworkDiskCache::expire()"
-                << "Removed:" << removedFiles
-                << "Kept:" << cacheItems.count() - removedFiles;
+                << "Removed:" << removedKeys.count()
+                << "Kept:" << d->index.count();
     }
 #endif
-    return totalSize;
+    return d->currentCacheSize;
 }
 
 /*!
@@ -600,21 +628,40 @@ void QNetworkDiskCache::clear()
     Given a URL, generates a unique enough filename (and subdirectory)
  */
 QString QNetworkDiskCachePrivate::uniqueFileName(const QUrl &url)
+{
+    return keyFileName(urlKey(url));
+}
+
+/*!
+    Returns the key of a URL in the index: the first 8 bytes of its sha1.
+ */
+quint64 QNetworkDiskCachePrivate::urlKey(const QUrl &url)
 {
     QUrl cleanUrl = url;
     cleanUrl.setPassword(QString());
     cleanUrl.setFragment(QString());
 
-    QCryptographicHash hash(QCryptographicHash::Sha1);
-    hash.addData(cleanUrl.toEncoded());
-    // convert sha1 to base36 form and return first 8 bytes for use as string
-    QByteArray id =  QByteArray::number(*(qlonglong*)hash.result().data(), 36).left(8);
-    // generates <one-char subdir>/<8-char filname.d>
-    uint code = (uint)id.at(id.length()-1) % 16;
-    QString pathFragment = QString::number(code, 16) + QLatin1Char('/')
-                             + QLatin1String(id) + CACHE_POSTFIX;
+    const QByteArray hash = QCryptographicHash::hash(cleanUrl.toEncoded(), QCryptographicHash::Sha1);
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar *>(hash.constData()));
+}
+
+/*!
+    Generates <two-char subdir>/<16-char filename.d> from an index key, the
+    subdirectory being the first byte of the key.
+ */
+QString QNetworkDiskCachePrivate::keyFileName(quint64 key)
+{
+    const QString id = QString::number(key, 16).rightJustified(16, QLatin1Char('0'));
+    return id.left(2) + QLatin1Char('/') + id + CACHE_POSTFIX;
+}
 
-    return pathFragment;
+bool QNetworkDiskCachePrivate::keyFromFileName(const QString &fileName, quint64 *key)
+{
+    if (fileName.length() != 16 + 2 || !fileName.endsWith(CACHE_POSTFIX))
+        return false;
+    bool ok;
+    *key = fileName.leftRef(16).toULongLong(&ok, 16);
+    return ok;
 }
 
 QString QNetworkDiskCachePrivate::tmpCacheFileName() const
@@ -635,6 +682,11 @@ QString QNetworkDiskCachePrivate::cacheFileName(const QUrl &url) const
     return  fullpath;
 }
 
+QString QNetworkDiskCachePrivate::indexFileName() const
+{
+    return dataDirectory + INDEX_FILE;
+}
+
 /*!
     We compress small text and JavaScript files.
  */
@@ -669,6 +721,7 @@ bool QCacheItem::canCompress() const
 enum
 {
     CacheMagic = 0xe8,
+    IndexMagic = 0xe9,
     CurrentCacheVersion = CACHE_VERSION
 };
 
@@ -737,6 +790,314 @@ bool QCacheItem::read(QFile *device, bool readData)
     return metaData.isValid();
 }
 
+/*!
+    Reads the index saved by the last cache using this directory. The index
+    file is removed while the cache is in use and written back by
+    finishWrites(), so an index that survives a crash is never trusted.
+ */
+void QNetworkDiskCachePrivate::loadIndex()
+{
+    index.clear();
+    lru.clear();
+    currentCacheSize = 0;
+
+    bool ok = false;
+    QFile file(indexFileName());
+    if (file.open(QFile::ReadOnly)) {
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_5_6);
+        qint32 marker;
+        qint32 version;
+        qint64 count;
+        in >> marker >> version >> count;
+        if (marker == IndexMagic && version == CurrentCacheVersion && count >= 0) {
+            index.reserve(int(count));
+            // entries are stored least recently used first
+            for (qint64 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                quint64 key;
+                qint64 size;
+                qint64 lastAccess;
+                in >> key >> size >> lastAccess;
+                addEntry(key, size, lastAccess);
+            }
+            ok = (in.status() == QDataStream::Ok);
+        }
+        file.close();
+        file.remove();
+    }
+
+    if (!ok)
+        rebuildIndex();
+}
+
+void QNetworkDiskCachePrivate::rebuildIndex()
+{
+    index.clear();
+    lru.clear();
+    currentCacheSize = 0;
+
+    QMultiMap<qint64, QPair<quint64, qint64> > files;
+    QDirIterator it(dataDirectory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        quint64 key;
+        if (keyFromFileName(info.fileName(), &key))
+            files.insert(info.lastModified().toMSecsSinceEpoch(), qMakePair(key, info.size()));
+    }
+    QMultiMap<qint64, QPair<quint64, qint64> >::const_iterator i = files.constBegin();
+    for (; i != files.constEnd(); ++i)
+        addEntry(i.value().first, i.value().second, i.key());
+
+    // remove files of insertions that never finished
+    QDirIterator prepared(cacheDirectory + PREPARED_SLASH, QDir::Files);
+    while (prepared.hasNext())
+        QFile::remove(prepared.next());
+}
+
+void QNetworkDiskCachePrivate::saveIndex()
+{
+    QSaveFile file(indexFileName());
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+    out << qint32(IndexMagic) << qint32(CurrentCacheVersion) << qint64(index.count());
+    QLinkedList<quint64>::const_iterator it = lru.constBegin();
+    for (; it != lru.constEnd(); ++it) {
+        const IndexEntry &entry = index[*it];
+        out << *it << entry.size << entry.lastAccess;
+    }
+    file.commit();
+}
+
+void QNetworkDiskCachePrivate::addEntry(quint64 key, qint64 size, qint64 lastAccess)
+{
+    removeEntry(key);
+    IndexEntry entry;
+    entry.size = size;
+    entry.lastAccess = lastAccess;
+    entry.lru = lru.insert(lru.end(), key);
+    index.insert(key, entry);
+    currentCacheSize += size;
+}
+
+bool QNetworkDiskCachePrivate::removeEntry(quint64 key)
+{
+    QHash<quint64, IndexEntry>::iterator it = index.find(key);
+    if (it == index.end())
+        return false;
+    lru.erase(it->lru);
+    currentCacheSize -= it->size;
+    index.erase(it);
+    return true;
+}
+
+void QNetworkDiskCachePrivate::touch(quint64 key)
+{
+    QHash<quint64, IndexEntry>::iterator it = index.find(key);
+    if (it == index.end())
+        return;
+    lru.erase(it->lru);
+    it->lru = lru.insert(lru.end(), key);
+    it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+}
+
+QNetworkDiskCacheWriter *QNetworkDiskCachePrivate::ensureWriter()
+{
+    if (!writer) {
+        writer.reset(new QNetworkDiskCacheWriter(tmpCacheFileName()));
+        writer->start(QThread::LowPriority);
+    }
+    return writer.data();
+}
+
+void QNetworkDiskCachePrivate::enqueueRemoval(const QVector<quint64> &keys)
+{
+    QVector<QNetworkDiskCacheWriter::Job> jobs;
+    jobs.reserve(keys.count());
+    for (int i = 0; i < keys.count(); ++i) {
+        QNetworkDiskCacheWriter::Job job;
+        job.type = QNetworkDiskCacheWriter::Job::Remove;
+        job.key = keys.at(i);
+        job.fileName = dataDirectory + keyFileName(keys.at(i));
+        jobs.append(job);
+    }
+    ensureWriter()->enqueue(jobs);
+}
+
+/*!
+    Applies the sizes of the files the writer has stored to the index.
+ */
+void QNetworkDiskCachePrivate::processWriteResults()
+{
+    if (!writer)
+        return;
+    const QVector<QNetworkDiskCacheWriter::Result> results = writer->takeResults();
+    for (int i = 0; i < results.count(); ++i) {
+        const QNetworkDiskCacheWriter::Result &result = results.at(i);
+        QHash<quint64, IndexEntry>::iterator it = index.find(result.key);
+        if (it == index.end())
+            continue; // removed in the meantime
+        if (result.size < 0) {
+            removeEntry(result.key);
+        } else {
+            currentCacheSize += result.size - it->size;
+            it->size = result.size;
+        }
+    }
+}
+
+/*!
+    Waits until a queued write or removal of the file of \a key has been
+    carried out, so that it can be read.
+ */
+void QNetworkDiskCachePrivate::waitForWrite(quint64 key)
+{
+    if (writer && writer->isPending(key))
+        writer->waitForDone();
+    processWriteResults();
+}
+
+void QNetworkDiskCachePrivate::finishWrites()
+{
+    if (writer) {
+        writer->waitForDone();
+        processWriteResults();
+    }
+    if (!dataDirectory.isEmpty())
+        saveIndex();
+}
+
+QNetworkDiskCacheWriter::QNetworkDiskCacheWriter(const QString &tmpFileTemplate)
+    : tmpFileTemplate(tmpFileTemplate), busy(false), abort(false)
+{
+}
+
+QNetworkDiskCacheWriter::~QNetworkDiskCacheWriter()
+{
+    {
+        QMutexLocker locker(&mutex);
+        abort = true;
+        condition.wakeAll();
+    }
+    wait();
+}
+
+void QNetworkDiskCacheWriter::enqueue(const QVector<Job> &jobs)
+{
+    QMutexLocker locker(&mutex);
+    queue += jobs;
+    for (int i = 0; i < jobs.count(); ++i) {
+        if (jobs.at(i).type != Job::RemoveDirectory)
+            ++pending[jobs.at(i).key];
+    }
+    condition.wakeAll();
+}
+
+bool QNetworkDiskCacheWriter::isPending(quint64 key) const
+{
+    QMutexLocker locker(&mutex);
+    return pending.contains(key);
+}
+
+void QNetworkDiskCacheWriter::waitForDone()
+{
+    QMutexLocker locker(&mutex);
+    while (busy || !queue.isEmpty())
+        doneCondition.wait(&mutex);
+}
+
+QVector<QNetworkDiskCacheWriter::Result> QNetworkDiskCacheWriter::takeResults()
+{
+    QMutexLocker locker(&mutex);
+    QVector<Result> taken;
+    taken.swap(results);
+    return taken;
+}
+
+void QNetworkDiskCacheWriter::run()
+{
+    forever {
+        QVector<Job> batch;
+        {
+            QMutexLocker locker(&mutex);
+            while (queue.isEmpty() && !abort)
+                condition.wait(&mutex);
+            // finish the queued jobs even when aborting, the index relies on them
+            if (queue.isEmpty())
+                return;
+            batch.swap(queue);
+            busy = true;
+        }
+
+        QVector<Result> batchResults;
+        for (int i = 0; i < batch.count(); ++i) {
+            const Job &job = batch.at(i);
+            if (job.type == Job::Store)
+                batchResults.append(process(job));
+            else if (job.type == Job::RemoveDirectory)
+                QDir(job.fileName).removeRecursively();
+            else
+                QFile::remove(job.fileName);
+        }
+
+        QMutexLocker locker(&mutex);
+        results += batchResults;
+        for (int i = 0; i < batch.count(); ++i) {
+            if (batch.at(i).type == Job::RemoveDirectory)
+                continue;
+            QHash<quint64, int>::iterator it = pending.find(batch.at(i).key);
+            if (--it.value() == 0)
+                pending.erase(it);
+        }
+        busy = false;
+        if (queue.isEmpty())
+            doneCondition.wakeAll();
+    }
+}
+
+QNetworkDiskCacheWriter::Result QNetworkDiskCacheWriter::process(const Job &job)
+{
+    Result result;
+    result.key = job.key;
+    result.size = -1;
+
+    if (QFile::exists(job.fileName) && !QFile::remove(job.fileName)) {
+        qWarning() << "QNetworkDiskCache: couldn't remove the cache file " << job.fileName;
+        if (!job.tmpFileName.isEmpty())
+            QFile::remove(job.tmpFileName);
+        return result;
+    }
+
+    if (!job.tmpFileName.isEmpty()) {
+        if (QFile::rename(job.tmpFileName, job.fileName))
+            result.size = QFileInfo(job.fileName).size();
+        else
+            QFile::remove(job.tmpFileName);
+        return result;
+    }
+
+    QCacheItem item;
+    item.metaData = job.metaData;
+    item.data.setData(job.data);
+    QTemporaryFile file(tmpFileTemplate);
+    if (file.open()) {
+        item.writeHeader(&file);
+        item.writeCompressedData(&file);
+        if (file.error() == QFile::NoError) {
+            file.setAutoRemove(false);
+            // ### use atomic rename rather then remove & rename
+            if (file.rename(job.fileName))
+                result.size = file.size();
+            else
+                file.setAutoRemove(true);
+        }
+    }
+    return result;
+}
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_NETWORKDISKCACHE
@@ -49,7 +49,13 @@
 
 #include <qbuffer.h>
 #include <qhash.h>
+#include <qlinkedlist.h>
+#include <qmutex.h>
+#include <qscopedpointer.h>
 #include <qtemporaryfile.h>
+#include <qthread.h>
+#include <qvector.h>
+#include <qwaitcondition.h>
 
 #ifndef QT_NO_NETWORKDISKCACHE
 
@@ -87,6 +93,59 @@ public:
     bool canCompress() const;
 };
 
+/*
+  Moves cache files into place and removes evicted ones on a background
+  thread. Jobs are queued by the cache and processed in batches, in the
+  order they were queued; the final sizes of stored files are handed back
+  through takeResults().
+*/
+class QNetworkDiskCacheWriter : public QThread
+{
+public:
+    struct Job {
+        enum Type { Store, Remove, RemoveDirectory };
+        Job() : type(Store), key(0) {}
+
+        Type type;
+        quint64 key;
+        QString fileName;
+        // Store: the file written by prepare(), or empty to write
+        // metaData and the compressed data to a new file
+        QString tmpFileName;
+        QNetworkCacheMetaData metaData;
+        QByteArray data;
+    };
+    struct Result {
+        quint64 key;
+        qint64 size; // -1 if the file could not be stored
+    };
+
+    explicit QNetworkDiskCacheWriter(const QString &tmpFileTemplate);
+    ~QNetworkDiskCacheWriter();
+
+    void enqueue(const QVector<Job> &jobs);
+    bool isPending(quint64 key) const;
+    void waitForDone();
+    QVector<Result> takeResults();
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    Result process(const Job &job);
+
+    const QString tmpFileTemplate;
+    mutable QMutex mutex;
+    QWaitCondition condition;
+    QWaitCondition doneCondition;
+    QVector<Job> queue;
+    QHash<quint64, int> pending;
+    QVector<Result> results;
+    bool busy;
+    bool abort;
+};
+Q_DECLARE_TYPEINFO(QNetworkDiskCacheWriter::Result, Q_PRIMITIVE_TYPE);
+
 class QNetworkDiskCachePrivate : public QAbstractNetworkCachePrivate
 {
 public:
@@ -96,20 +155,48 @@ public:
         , currentCacheSize(-1)
         {}
 
+    static quint64 urlKey(const QUrl &url);
+    static QString keyFileName(quint64 key);
+    static bool keyFromFileName(const QString &fileName, quint64 *key);
     static QString uniqueFileName(const QUrl &url);
     QString cacheFileName(const QUrl &url) const;
     QString tmpCacheFileName() const;
+    QString indexFileName() const;
     bool removeFile(const QString &file);
     void storeItem(QCacheItem *item);
     void prepareLayout();
+    void removeOldVersions();
     static quint32 crc32(const char *data, uint len);
 
+    // the index of all files in the cache, in least recently used order
+    struct IndexEntry {
+        qint64 size;
+        qint64 lastAccess;
+        QLinkedList<quint64>::iterator lru;
+    };
+    void loadIndex();
+    void rebuildIndex();
+    void saveIndex();
+    void addEntry(quint64 key, qint64 size, qint64 lastAccess);
+    bool removeEntry(quint64 key);
+    void touch(quint64 key);
+
+    QNetworkDiskCacheWriter *ensureWriter();
+    void enqueueRemoval(const QVector<quint64> &keys);
+    void processWriteResults();
+    void waitForWrite(quint64 key);
+    void finishWrites();
+
     mutable QCacheItem lastItem;
     QString cacheDirectory;
     QString dataDirectory;
     qint64 maximumCacheSize;
     qint64 currentCacheSize;
 
+    QHash<quint64, IndexEntry> index;
+    QLinkedList<quint64> lru;
+    QScopedPointer<QNetworkDiskCacheWriter> writer;
+
     QHash<QIODevice*, QCacheItem*> inserting;
     Q_DECLARE_PUBLIC(QNetworkDiskCache)
 };
@@ -667,6 +667,22 @@ QVariant QNetworkReply::attribute(QNetworkRequest::Attribute code) const
     return d_func()->attributes.value(code);
 }
 
+/*!
+    \since 5.6
+
+    Returns the timing and transfer metrics of the reply. They are
+    complete once the reply has finished. The metrics are only recorded
+    for replies whose request was sent over HTTP or HTTPS; for all other
+    replies, including replies loaded from the cache, the returned
+    object is not valid.
+
+    \sa QNetworkReplyMetrics::isValid(), QNetworkAccessManager::hostMetrics()
+*/
+QNetworkReplyMetrics QNetworkReply::metrics() const
+{
+    return d_func()->metrics;
+}
+
 #ifndef QT_NO_SSL
 /*!
     Returns the SSL configuration and state associated with this
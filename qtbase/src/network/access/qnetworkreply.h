@@ -50,6 +50,7 @@ class QAuthenticator;
 class QSslConfiguration;
 class QSslError;
 class QSslPreSharedKeyAuthenticator;
+class QNetworkReplyMetrics;
 
 class QNetworkReplyPrivate;
 class Q_NETWORK_EXPORT QNetworkReply: public QIODevice
@@ -136,6 +137,8 @@ public:
     // attributes
     QVariant attribute(QNetworkRequest::Attribute code) const;
 
+    QNetworkReplyMetrics metrics() const;
+
 #ifndef QT_NO_SSL
     QSslConfiguration sslConfiguration() const;
     void setSslConfiguration(const QSslConfiguration &configuration);
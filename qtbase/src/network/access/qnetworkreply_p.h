@@ -48,6 +48,7 @@
 #include "qnetworkrequest.h"
 #include "qnetworkrequest_p.h"
 #include "qnetworkreply.h"
+#include "qnetworkreplymetrics.h"
 #include "QtCore/qpointer.h"
 #include <QtCore/QElapsedTimer>
 #include "private/qiodevice_p.h"
@@ -79,6 +80,7 @@ public:
     const static int progressSignalInterval;
     QNetworkAccessManager::Operation operation;
     QNetworkReply::NetworkError errorCode;
+    QNetworkReplyMetrics metrics;
     bool isFinished;
 
     static inline void setManager(QNetworkReply *reply, QNetworkAccessManager *manager)
@@ -46,6 +46,8 @@
 #include "QtCore/qelapsedtimer.h"
 #include "QtNetwork/qsslconfiguration.h"
 #include "qhttpthreaddelegate_p.h"
+#include "qnetworkcontentdecoder_p.h"
+#include "qnetworkreplymetrics_p.h"
 #include "qthread.h"
 #include "QtCore/qcoreapplication.h"
 
@@ -175,10 +177,20 @@ QNetworkReplyHttpImpl::QNetworkReplyHttpImpl(QNetworkAccessManager* const manage
 #ifndef QT_NO_SSL
     d->sslConfiguration = request.sslConfiguration();
 #endif
+    QNetworkReplyMetricsPrivate::get(d->metrics)->startTime = QNetworkReplyMetricsPrivate::now();
 
     // FIXME Later maybe set to Unbuffered, especially if it is zerocopy or from cache?
     QIODevice::open(QIODevice::ReadOnly);
 
+#ifndef QT_NO_COMPRESS
+    // A body that is to be compressed is always buffered completely
+    // first, see compressOutgoingData().
+    if (outgoingData && !request.hasRawHeader("Content-Encoding")) {
+        const QByteArray coding = request.attribute(QNetworkRequest::UploadContentEncodingAttribute).toByteArray();
+        if (QZlibContentEncoder::isContentCodingSupported(coding))
+            d->uploadContentEncoding = coding;
+    }
+#endif
 
     // Internal code that does a HTTP reply for the synchronous Ajax
     // in Qt WebKit.
@@ -195,6 +207,8 @@ QNetworkReplyHttpImpl::QNetworkReplyHttpImpl(QNetworkAccessManager* const manage
                 previousDataSize = d->outgoingDataBuffer->size();
                 d->outgoingDataBuffer->append(d->outgoingData->readAll());
             } while (d->outgoingDataBuffer->size() != previousDataSize);
+            if (!d->uploadContentEncoding.isEmpty())
+                d->compressOutgoingData();
             d->_q_startOperation();
             return;
         }
@@ -204,7 +218,12 @@ QNetworkReplyHttpImpl::QNetworkReplyHttpImpl(QNetworkAccessManager* const manage
     if (outgoingData) {
         // there is data to be uploaded, e.g. HTTP POST.
 
-        if (!d->outgoingData->isSequential()) {
+        if (!d->uploadContentEncoding.isEmpty()) {
+            // _q_startOperation will be called when the buffered data has
+            // been compressed.
+            d->state = d->Buffering;
+            QMetaObject::invokeMethod(this, "_q_bufferOutgoingData", Qt::QueuedConnection);
+        } else if (!d->outgoingData->isSequential()) {
             // fixed size non-sequential (random-access)
             // just start the operation
             QMetaObject::invokeMethod(this, "_q_startOperation", Qt::QueuedConnection);
@@ -431,6 +450,7 @@ QNetworkReplyHttpImplPrivate::QNetworkReplyHttpImplPrivate()
     , uploadByteDevicePosition(false)
     , uploadDeviceChoking(false)
     , outgoingData(0)
+    , outgoingDataStart(-1)
     , bytesUploaded(-1)
     , cacheLoadDevice(0)
     , loadingFromCache(false)
@@ -609,17 +629,10 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         thread->setObjectName(QStringLiteral("Qt HTTP synchronous thread"));
         QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
         thread->start();
-    } else if (!managerPrivate->httpThread) {
-        // We use the manager-global thread.
-        // At some point we could switch to having multiple threads if it makes sense.
-        managerPrivate->httpThread = new QThread();
-        managerPrivate->httpThread->setObjectName(QStringLiteral("Qt HTTP thread"));
-        managerPrivate->httpThread->start();
-
-        thread = managerPrivate->httpThread;
     } else {
-        // Asynchronous request, thread already exists
-        thread = managerPrivate->httpThread;
+        // Asynchronous request: the manager's own thread, or the thread
+        // shared by all managers with the shared connection pool enabled
+        thread = managerPrivate->acquireHttpThread();
     }
 
     QUrl url = newHttpRequest.url();
@@ -751,6 +764,9 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     if (request.attribute(QNetworkRequest::SpdyAllowedAttribute).toBool())
         httpRequest.setSPDYAllowed(true);
 
+    if (request.attribute(QNetworkRequest::HTTP2AllowedAttribute).toBool())
+        httpRequest.setHTTP2Allowed(true);
+
     if (static_cast<QNetworkRequest::LoadControl>
         (newHttpRequest.attribute(QNetworkRequest::AuthenticationReuseAttribute,
                              QNetworkRequest::Automatic).toInt()) == QNetworkRequest::Manual)
@@ -771,6 +787,7 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     QObject::connect(thread, SIGNAL(finished()), delegate, SLOT(deleteLater()));
 
     // Set the properties it needs
+    httpRequest.setStartTime(QNetworkReplyMetricsPrivate::get(metrics)->startTime);
     delegate->httpRequest = httpRequest;
 #ifndef QT_NO_NETWORKPROXY
     delegate->cacheProxy = cacheProxy;
@@ -781,6 +798,10 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     if (ssl)
         delegate->incomingSslConfiguration = newHttpRequest.sslConfiguration();
 #endif
+    // SSL errors ignored on a connection stay ignored for its later requests,
+    // so encrypted connections are not shared with other managers
+    if (ssl && managerPrivate->sharedConnectionPool)
+        delegate->connectionScope = QByteArray::number(managerPrivate->connectionPoolScope);
 
     // Do we use synchronous HTTP?
     delegate->synchronous = synchronous;
@@ -810,15 +831,18 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         QObject::connect(delegate, SIGNAL(downloadData(QByteArray)),
                 q, SLOT(replyDownloadData(QByteArray)),
                 Qt::QueuedConnection);
+        QObject::connect(delegate, SIGNAL(downloadMetrics(QNetworkReplyMetrics)),
+                q, SLOT(replyMetrics(QNetworkReplyMetrics)),
+                Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadFinished()),
                 q, SLOT(replyFinished()),
                 Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadMetaData(QList<QPair<QByteArray,QByteArray> >,
                                                            int, QString, bool,
-                                                           QSharedPointer<char>, qint64, bool)),
+                                                           QSharedPointer<char>, qint64, bool, bool)),
                 q, SLOT(replyDownloadMetaData(QList<QPair<QByteArray,QByteArray> >,
                                               int, QString, bool,
-                                              QSharedPointer<char>, qint64, bool)),
+                                              QSharedPointer<char>, qint64, bool, bool)),
                 Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
                 q, SLOT(replyDownloadProgressSlot(qint64,qint64)),
@@ -861,7 +885,15 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         QObject::connect(q, SIGNAL(readBufferSizeChanged(qint64)), delegate, SLOT(readBufferSizeChanged(qint64)));
         QObject::connect(q, SIGNAL(readBufferFreed(qint64)), delegate, SLOT(readBufferFreed(qint64)));
 
-        if (uploadByteDevice) {
+        if (QNonContiguousByteDeviceFileImpl *fileDevice =
+                qobject_cast<QNonContiguousByteDeviceFileImpl *>(uploadByteDevice.data())) {
+            // A file device can be read from the HTTP thread directly, saving the
+            // copies into QByteArrays that QNonContiguousByteDeviceThreadForwardImpl
+            // makes. The delegate keeps it alive until the HTTP thread is done with it.
+            fileDevice->moveToThread(thread);
+            delegate->uploadByteDevice = uploadByteDevice;
+            delegate->httpRequest.setUploadByteDevice(fileDevice);
+        } else if (uploadByteDevice) {
             QNonContiguousByteDeviceThreadForwardImpl *forwardUploadDevice =
                     new QNonContiguousByteDeviceThreadForwardImpl(uploadByteDevice->atEnd(), uploadByteDevice->size());
             forwardUploadDevice->setParent(delegate); // needed to make sure it is moved on moveToThread()
@@ -923,7 +955,8 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                      delegate->isPipeliningUsed,
                      QSharedPointer<char>(),
                      delegate->incomingContentLength,
-                     delegate->isSpdyUsed);
+                     delegate->isSpdyUsed,
+                     delegate->isHttp2Used);
             replyDownloadData(delegate->synchronousDownloadData);
             httpError(delegate->incomingErrorCode, delegate->incomingErrorDetail);
         } else {
@@ -934,9 +967,11 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                      delegate->isPipeliningUsed,
                      QSharedPointer<char>(),
                      delegate->incomingContentLength,
-                     delegate->isSpdyUsed);
+                     delegate->isSpdyUsed,
+                     delegate->isHttp2Used);
             replyDownloadData(delegate->synchronousDownloadData);
         }
+        replyMetrics(delegate->metrics);
 
         thread->quit();
         thread->wait(5000);
@@ -1080,20 +1115,38 @@ void QNetworkReplyHttpImplPrivate::replyFinished()
     finished();
 }
 
+void QNetworkReplyHttpImplPrivate::replyMetrics(const QNetworkReplyMetrics &replyMetrics)
+{
+    if (loadingFromCache)
+        return;
+
+    metrics = replyMetrics;
+    // the metrics of a redirect arrive before the request for its target starts,
+    // so httpRequest still holds the URL they belong to
+    if (manager)
+        managerPrivate->addHostMetrics(httpRequest.url().host(), metrics,
+                                       errorCode != QNetworkReply::NoError);
+}
+
 QNetworkAccessManager::Operation QNetworkReplyHttpImplPrivate::getRedirectOperation(QNetworkAccessManager::Operation currentOp, int httpStatus)
 {
     // HTTP status code can be used to decide if we can redirect with a GET
     // operation or not. See http://www.ietf.org/rfc/rfc2616.txt [Sec 10.3] for
     // more details
-    Q_UNUSED(httpStatus);
-
     switch (currentOp) {
     case QNetworkAccessManager::HeadOperation:
         return QNetworkAccessManager::HeadOperation;
     default:
         break;
     }
-    // For now, we're always returning GET for anything other than HEAD
+
+    // A 307 repeats the request, body included, at the new location. That
+    // takes a body that can be read again from its start.
+    if (httpStatus == 307
+        && (!outgoingData || outgoingDataBuffer || !outgoingData->isSequential()))
+        return currentOp;
+
+    // Otherwise we're always returning GET for anything other than HEAD
     return QNetworkAccessManager::GetOperation;
 }
 
@@ -1128,7 +1181,8 @@ void QNetworkReplyHttpImplPrivate::onRedirected(const QUrl &redirectUrl, int htt
 
     cookedHeaders.clear();
 
-    if (managerPrivate->httpThread)
+    // the shared thread also carries the connections of other managers
+    if (managerPrivate->httpThread && !managerPrivate->sharedConnectionPool)
         managerPrivate->httpThread->disconnect();
 
     // Recurse
@@ -1161,7 +1215,7 @@ void QNetworkReplyHttpImplPrivate::replyDownloadMetaData
         (QList<QPair<QByteArray,QByteArray> > hm,
          int sc,QString rp,bool pu,
          QSharedPointer<char> db,
-         qint64 contentLength, bool spdyWasUsed)
+         qint64 contentLength, bool spdyWasUsed, bool http2WasUsed)
 {
     Q_Q(QNetworkReplyHttpImpl);
     Q_UNUSED(contentLength);
@@ -1179,6 +1233,7 @@ void QNetworkReplyHttpImplPrivate::replyDownloadMetaData
 
     q->setAttribute(QNetworkRequest::HttpPipeliningWasUsedAttribute, pu);
     q->setAttribute(QNetworkRequest::SpdyWasUsedAttribute, spdyWasUsed);
+    q->setAttribute(QNetworkRequest::HTTP2WasUsedAttribute, http2WasUsed);
 
     // reconstruct the HTTP header
     QList<QPair<QByteArray, QByteArray> > headerMap = hm;
@@ -1860,6 +1915,9 @@ void QNetworkReplyHttpImplPrivate::_q_bufferOutgoingDataFinished()
     QObject::disconnect(outgoingData, SIGNAL(readyRead()), q, SLOT(_q_bufferOutgoingData()));
     QObject::disconnect(outgoingData, SIGNAL(readChannelFinished()), q, SLOT(_q_bufferOutgoingDataFinished()));
 
+    if (!uploadContentEncoding.isEmpty())
+        compressOutgoingData();
+
     // finally, start the request
     QMetaObject::invokeMethod(q, "_q_startOperation", Qt::QueuedConnection);
 }
@@ -1914,6 +1972,35 @@ void QNetworkReplyHttpImplPrivate::_q_bufferOutgoingData()
     }
 }
 
+void QNetworkReplyHttpImplPrivate::compressOutgoingData()
+{
+#ifndef QT_NO_COMPRESS
+    // Compress the buffered body as a whole, so that the request can carry
+    // a Content-Length header and be resent after a redirect or an
+    // authentication challenge. If compression fails, the body is sent
+    // as it is.
+    QZlibContentEncoder encoder(uploadContentEncoding);
+    if (!encoder.isValid())
+        return;
+
+    QSharedPointer<QRingBuffer> compressedBuffer = QSharedPointer<QRingBuffer>::create();
+    qint64 pos = 0;
+    while (pos < outgoingDataBuffer->size()) {
+        qint64 length = 0;
+        const char *block = outgoingDataBuffer->readPointerAtPosition(pos, length);
+        if (!encoder.encode(block, length, compressedBuffer.data()))
+            return;
+        pos += length;
+    }
+    if (!encoder.finish(compressedBuffer.data()))
+        return;
+
+    outgoingDataBuffer = compressedBuffer;
+    request.setRawHeader("Content-Encoding", uploadContentEncoding);
+    request.setHeader(QNetworkRequest::ContentLengthHeader, outgoingDataBuffer->size());
+#endif
+}
+
 #ifndef QT_NO_BEARERMANAGEMENT
 void QNetworkReplyHttpImplPrivate::_q_networkSessionConnected()
 {
@@ -2020,10 +2107,16 @@ QNonContiguousByteDevice* QNetworkReplyHttpImplPrivate::createUploadByteDevice()
     if (outgoingDataBuffer)
         uploadByteDevice = QNonContiguousByteDeviceFactory::createShared(outgoingDataBuffer);
     else if (outgoingData) {
+        // a body sent again after a redirect starts where the first one did
+        if (outgoingDataStart == -1)
+            outgoingDataStart = outgoingData->pos();
+        else if (!outgoingData->isSequential())
+            outgoingData->seek(outgoingDataStart);
         uploadByteDevice = QNonContiguousByteDeviceFactory::createShared(outgoingData);
     } else {
         return 0;
     }
+    uploadByteDevicePosition = 0;
 
     // We want signal emissions only for normal asynchronous uploads
     if (!synchronous)
@@ -105,9 +105,10 @@ public:
     // From reply
     Q_PRIVATE_SLOT(d_func(), void replyDownloadData(QByteArray))
     Q_PRIVATE_SLOT(d_func(), void replyFinished())
+    Q_PRIVATE_SLOT(d_func(), void replyMetrics(const QNetworkReplyMetrics &))
     Q_PRIVATE_SLOT(d_func(), void replyDownloadMetaData(QList<QPair<QByteArray,QByteArray> >,
                                                         int, QString, bool, QSharedPointer<char>,
-                                                        qint64, bool))
+                                                        qint64, bool, bool))
     Q_PRIVATE_SLOT(d_func(), void replyDownloadProgressSlot(qint64,qint64))
     Q_PRIVATE_SLOT(d_func(), void httpAuthenticationRequired(const QHttpNetworkRequest &, QAuthenticator *))
     Q_PRIVATE_SLOT(d_func(), void httpError(QNetworkReply::NetworkError, const QString &))
@@ -202,7 +203,10 @@ public:
     qint64 uploadByteDevicePosition;
     bool uploadDeviceChoking; // if we couldn't readPointer() any data at the moment
     QIODevice *outgoingData;
+    qint64 outgoingDataStart; // where the body starts in outgoingData, -1 until it is read
     QSharedPointer<QRingBuffer> outgoingDataBuffer;
+    QByteArray uploadContentEncoding;
+    void compressOutgoingData();
     void emitReplyUploadProgress(qint64 bytesSent, qint64 bytesTotal); // dup?
     void onRedirected(const QUrl &redirectUrl, int httpStatus, int maxRedirectsRemainig);
     qint64 bytesUploaded;
@@ -273,8 +277,9 @@ public:
     // From HTTP thread:
     void replyDownloadData(QByteArray);
     void replyFinished();
+    void replyMetrics(const QNetworkReplyMetrics &replyMetrics);
     void replyDownloadMetaData(QList<QPair<QByteArray,QByteArray> >, int, QString, bool,
-                               QSharedPointer<char>, qint64, bool);
+                               QSharedPointer<char>, qint64, bool, bool);
     void replyDownloadProgressSlot(qint64,qint64);
     void httpAuthenticationRequired(const QHttpNetworkRequest &request, QAuthenticator *auth);
     void httpError(QNetworkReply::NetworkError error, const QString &errorString);
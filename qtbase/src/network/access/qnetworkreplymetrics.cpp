@@ -0,0 +1,480 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnetworkreplymetrics.h"
+#include "qnetworkreplymetrics_p.h"
+
+#include <QtCore/qelapsedtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QNetworkReplyMetrics
+    \brief The QNetworkReplyMetrics class holds the timing and transfer
+           figures of a network reply.
+    \since 5.6
+
+    \ingroup network
+    \ingroup shared
+    \inmodule QtNetwork
+
+    The HTTP implementation of QNetworkAccessManager records when each phase
+    of a request took place: the host name lookup, the connection set-up
+    including the TLS handshake, sending the request and receiving the
+    response. The phases follow the model of the W3C Resource Timing
+    specification. QNetworkReply::metrics() returns them once the reply has
+    finished.
+
+    All times are in nanoseconds since the request was handed to
+    QNetworkAccessManager, or -1 if the phase did not take place for the
+    reply; for instance, no connection is set up for a request that is sent
+    on a connection that is already open. In that case isConnectionReused()
+    returns \c true.
+
+    \code
+    QNetworkReplyMetrics metrics = reply->metrics();
+    qint64 timeToFirstByte = metrics.responseStart() - metrics.requestStart();
+    \endcode
+
+    For HTTP/1, bytesSent() and bytesReceived() count the bytes of the
+    request and the response as they were transferred, before content
+    decoding. For HTTP/2 and SPDY they count the frames of the reply's
+    stream. They do not include the overhead of TLS.
+
+    When a reply follows redirects, the metrics describe the last request.
+
+    \sa QNetworkHostMetrics, QNetworkAccessManager::hostMetrics()
+*/
+
+namespace {
+struct MetricsClock
+{
+    MetricsClock() { timer.start(); }
+    QElapsedTimer timer;
+};
+}
+
+Q_GLOBAL_STATIC(MetricsClock, metricsClock)
+
+QNetworkReplyMetricsPrivate::QNetworkReplyMetricsPrivate()
+    : startTime(-1), domainLookupStart(-1), domainLookupEnd(-1), connectStart(-1),
+      secureConnectionStart(-1), connectEnd(-1), requestStart(-1), responseStart(-1),
+      responseEnd(-1), bytesSent(0), bytesReceived(0), peerPort(0), connectionReused(false)
+{
+}
+
+qint64 QNetworkReplyMetricsPrivate::now()
+{
+    return metricsClock()->timer.nsecsElapsed();
+}
+
+/*!
+    Constructs an empty metrics object.
+*/
+QNetworkReplyMetrics::QNetworkReplyMetrics()
+    : d(new QNetworkReplyMetricsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QNetworkReplyMetrics::QNetworkReplyMetrics(const QNetworkReplyMetrics &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this object.
+*/
+QNetworkReplyMetrics &QNetworkReplyMetrics::operator=(const QNetworkReplyMetrics &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Destroys the metrics object.
+*/
+QNetworkReplyMetrics::~QNetworkReplyMetrics()
+{
+}
+
+/*!
+    \fn void QNetworkReplyMetrics::swap(QNetworkReplyMetrics &other)
+
+    Swaps this metrics object with \a other. This function is very fast and
+    never fails.
+*/
+
+/*!
+    Returns \c true if a request was sent for the reply, that is, if the
+    reply was not loaded from the cache or by a protocol other than HTTP.
+*/
+bool QNetworkReplyMetrics::isValid() const
+{
+    return d->requestStart >= 0;
+}
+
+/*!
+    Returns the time at which the host name lookup for the connection
+    started, or -1 if the host name did not have to be looked up for the
+    reply.
+*/
+qint64 QNetworkReplyMetrics::domainLookupStart() const
+{
+    return d->relative(d->domainLookupStart);
+}
+
+/*!
+    Returns the time at which the host name lookup finished, or -1.
+*/
+qint64 QNetworkReplyMetrics::domainLookupEnd() const
+{
+    return d->relative(d->domainLookupEnd);
+}
+
+/*!
+    Returns the time at which the connection to the server or proxy was
+    initiated, or -1 if the request was sent on a connection that had been
+    opened before the reply started.
+*/
+qint64 QNetworkReplyMetrics::connectStart() const
+{
+    return d->relative(d->connectStart);
+}
+
+/*!
+    Returns the time at which the TLS handshake started, or -1 for
+    unencrypted connections and reused connections.
+*/
+qint64 QNetworkReplyMetrics::secureConnectionStart() const
+{
+    return d->relative(d->secureConnectionStart);
+}
+
+/*!
+    Returns the time at which the connection was established, including
+    the TLS handshake, or -1.
+*/
+qint64 QNetworkReplyMetrics::connectEnd() const
+{
+    return d->relative(d->connectEnd);
+}
+
+/*!
+    Returns the time at which the request was written to the connection,
+    or -1 if it was never sent. If the request had to be sent again, for
+    instance to answer an authentication challenge, this is the time of
+    the last attempt.
+*/
+qint64 QNetworkReplyMetrics::requestStart() const
+{
+    return d->relative(d->requestStart);
+}
+
+/*!
+    Returns the time at which the first byte of the response arrived, or -1.
+*/
+qint64 QNetworkReplyMetrics::responseStart() const
+{
+    return d->relative(d->responseStart);
+}
+
+/*!
+    Returns the time at which the response was complete, or the request
+    failed, or -1.
+*/
+qint64 QNetworkReplyMetrics::responseEnd() const
+{
+    return d->relative(d->responseEnd);
+}
+
+/*!
+    Returns the number of bytes of the request that were written to the
+    connection.
+*/
+qint64 QNetworkReplyMetrics::bytesSent() const
+{
+    return d->bytesSent;
+}
+
+/*!
+    Returns the number of bytes of the response that were read from the
+    connection.
+*/
+qint64 QNetworkReplyMetrics::bytesReceived() const
+{
+    return d->bytesReceived;
+}
+
+/*!
+    Returns \c true if the request was sent on a connection that had
+    carried other requests before.
+*/
+bool QNetworkReplyMetrics::isConnectionReused() const
+{
+    return d->connectionReused;
+}
+
+/*!
+    Returns the protocol that the request was sent with: "http/1.1", "h2"
+    or "spdy/3", or an empty byte array if no request was sent.
+*/
+QByteArray QNetworkReplyMetrics::protocol() const
+{
+    return d->protocol;
+}
+
+/*!
+    Returns the address of the server or proxy that the request was sent
+    to.
+*/
+QHostAddress QNetworkReplyMetrics::peerAddress() const
+{
+    return d->peerAddress;
+}
+
+/*!
+    Returns the port of the server or proxy that the request was sent to.
+*/
+quint16 QNetworkReplyMetrics::peerPort() const
+{
+    return d->peerPort;
+}
+
+/*!
+    \class QNetworkHostMetrics
+    \brief The QNetworkHostMetrics class holds the metrics of all replies
+           that a QNetworkAccessManager received from one host.
+    \since 5.6
+
+    \ingroup network
+    \ingroup shared
+    \inmodule QtNetwork
+
+    QNetworkAccessManager adds the QNetworkReplyMetrics of every HTTP
+    request to the counters of the request's host, see
+    QNetworkAccessManager::hostMetrics(). The times are totals in
+    nanoseconds; divide them by the matching count for an average:
+    totalDomainLookupTime() by domainLookupCount(), totalConnectTime() and
+    totalSecureConnectionTime() by connectionCount(), and
+    totalTimeToFirstByte() and totalResponseTime() by requestCount().
+
+    \sa QNetworkReplyMetrics
+*/
+
+QNetworkHostMetricsPrivate::QNetworkHostMetricsPrivate()
+    : requestCount(0), failedRequestCount(0), connectionCount(0), reusedConnectionCount(0),
+      domainLookupCount(0), bytesSent(0), bytesReceived(0), domainLookupTime(0),
+      connectTime(0), secureConnectionTime(0), timeToFirstByte(0), responseTime(0)
+{
+}
+
+void QNetworkHostMetricsPrivate::add(QNetworkHostMetrics *host, const QNetworkReplyMetrics &reply,
+                                     bool failed)
+{
+    if (!reply.isValid())
+        return;
+
+    QNetworkHostMetricsPrivate *d = host->d.data();
+    ++d->requestCount;
+    if (failed)
+        ++d->failedRequestCount;
+    d->bytesSent += reply.bytesSent();
+    d->bytesReceived += reply.bytesReceived();
+
+    if (reply.isConnectionReused())
+        ++d->reusedConnectionCount;
+    else
+        ++d->connectionCount;
+    if (reply.connectStart() >= 0 && reply.connectEnd() >= 0) {
+        if (reply.secureConnectionStart() >= 0) {
+            d->connectTime += reply.secureConnectionStart() - reply.connectStart();
+            d->secureConnectionTime += reply.connectEnd() - reply.secureConnectionStart();
+        } else {
+            d->connectTime += reply.connectEnd() - reply.connectStart();
+        }
+    }
+    if (reply.domainLookupStart() >= 0 && reply.domainLookupEnd() >= 0) {
+        ++d->domainLookupCount;
+        d->domainLookupTime += reply.domainLookupEnd() - reply.domainLookupStart();
+    }
+    if (reply.responseStart() >= 0)
+        d->timeToFirstByte += reply.responseStart() - reply.requestStart();
+    if (reply.responseEnd() >= 0)
+        d->responseTime += reply.responseEnd();
+}
+
+/*!
+    Constructs an empty metrics object.
+*/
+QNetworkHostMetrics::QNetworkHostMetrics()
+    : d(new QNetworkHostMetricsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QNetworkHostMetrics::QNetworkHostMetrics(const QNetworkHostMetrics &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this object.
+*/
+QNetworkHostMetrics &QNetworkHostMetrics::operator=(const QNetworkHostMetrics &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Destroys the metrics object.
+*/
+QNetworkHostMetrics::~QNetworkHostMetrics()
+{
+}
+
+/*!
+    \fn void QNetworkHostMetrics::swap(QNetworkHostMetrics &other)
+
+    Swaps this metrics object with \a other. This function is very fast and
+    never fails.
+*/
+
+/*!
+    Returns the number of requests sent to the host.
+*/
+int QNetworkHostMetrics::requestCount() const
+{
+    return d->requestCount;
+}
+
+/*!
+    Returns the number of requests that finished with an error, including
+    HTTP error status codes.
+*/
+int QNetworkHostMetrics::failedRequestCount() const
+{
+    return d->failedRequestCount;
+}
+
+/*!
+    Returns the number of requests that were the first on a new connection.
+*/
+int QNetworkHostMetrics::connectionCount() const
+{
+    return d->connectionCount;
+}
+
+/*!
+    Returns the number of requests that were sent on a connection that had
+    carried other requests before.
+*/
+int QNetworkHostMetrics::reusedConnectionCount() const
+{
+    return d->reusedConnectionCount;
+}
+
+/*!
+    Returns the number of requests that waited for a host name lookup.
+*/
+int QNetworkHostMetrics::domainLookupCount() const
+{
+    return d->domainLookupCount;
+}
+
+/*!
+    Returns the total number of bytes sent to the host.
+*/
+qint64 QNetworkHostMetrics::bytesSent() const
+{
+    return d->bytesSent;
+}
+
+/*!
+    Returns the total number of bytes received from the host.
+*/
+qint64 QNetworkHostMetrics::bytesReceived() const
+{
+    return d->bytesReceived;
+}
+
+/*!
+    Returns the total time spent in host name lookups.
+*/
+qint64 QNetworkHostMetrics::totalDomainLookupTime() const
+{
+    return d->domainLookupTime;
+}
+
+/*!
+    Returns the total time spent in establishing TCP connections, not
+    counting TLS handshakes.
+*/
+qint64 QNetworkHostMetrics::totalConnectTime() const
+{
+    return d->connectTime;
+}
+
+/*!
+    Returns the total time spent in TLS handshakes.
+*/
+qint64 QNetworkHostMetrics::totalSecureConnectionTime() const
+{
+    return d->secureConnectionTime;
+}
+
+/*!
+    Returns the total time between sending requests and receiving the
+    first byte of their responses.
+*/
+qint64 QNetworkHostMetrics::totalTimeToFirstByte() const
+{
+    return d->timeToFirstByte;
+}
+
+/*!
+    Returns the total time from the start of the requests until their
+    responses were complete.
+*/
+qint64 QNetworkHostMetrics::totalResponseTime() const
+{
+    return d->responseTime;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNETWORKREPLYMETRICS_H
+#define QNETWORKREPLYMETRICS_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMetaType>
+#include <QtCore/QSharedDataPointer>
+#include <QtNetwork/QHostAddress>
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkReplyMetricsPrivate;
+class QNetworkHostMetricsPrivate;
+
+class Q_NETWORK_EXPORT QNetworkReplyMetrics
+{
+public:
+    QNetworkReplyMetrics();
+    QNetworkReplyMetrics(const QNetworkReplyMetrics &other);
+    QNetworkReplyMetrics &operator=(const QNetworkReplyMetrics &other);
+    ~QNetworkReplyMetrics();
+
+    void swap(QNetworkReplyMetrics &other) Q_DECL_NOTHROW { qSwap(d, other.d); }
+
+    bool isValid() const;
+
+    qint64 domainLookupStart() const;
+    qint64 domainLookupEnd() const;
+    qint64 connectStart() const;
+    qint64 secureConnectionStart() const;
+    qint64 connectEnd() const;
+    qint64 requestStart() const;
+    qint64 responseStart() const;
+    qint64 responseEnd() const;
+
+    qint64 bytesSent() const;
+    qint64 bytesReceived() const;
+
+    bool isConnectionReused() const;
+    QByteArray protocol() const;
+    QHostAddress peerAddress() const;
+    quint16 peerPort() const;
+
+private:
+    friend class QNetworkReplyMetricsPrivate;
+    QSharedDataPointer<QNetworkReplyMetricsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNetworkReplyMetrics)
+
+class Q_NETWORK_EXPORT QNetworkHostMetrics
+{
+public:
+    QNetworkHostMetrics();
+    QNetworkHostMetrics(const QNetworkHostMetrics &other);
+    QNetworkHostMetrics &operator=(const QNetworkHostMetrics &other);
+    ~QNetworkHostMetrics();
+
+    void swap(QNetworkHostMetrics &other) Q_DECL_NOTHROW { qSwap(d, other.d); }
+
+    int requestCount() const;
+    int failedRequestCount() const;
+    int connectionCount() const;
+    int reusedConnectionCount() const;
+    int domainLookupCount() const;
+
+    qint64 bytesSent() const;
+    qint64 bytesReceived() const;
+
+    qint64 totalDomainLookupTime() const;
+    qint64 totalConnectTime() const;
+    qint64 totalSecureConnectionTime() const;
+    qint64 totalTimeToFirstByte() const;
+    qint64 totalResponseTime() const;
+
+private:
+    friend class QNetworkHostMetricsPrivate;
+    QSharedDataPointer<QNetworkHostMetricsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNetworkHostMetrics)
+
+QT_END_NAMESPACE
+
+Q_DECLARE_METATYPE(QNetworkReplyMetrics)
+
+#endif // QNETWORKREPLYMETRICS_H
@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNETWORKREPLYMETRICS_P_H
+#define QNETWORKREPLYMETRICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qnetworkreplymetrics.h"
+#include "QtCore/qshareddata.h"
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkReplyMetricsPrivate : public QSharedData
+{
+public:
+    QNetworkReplyMetricsPrivate();
+
+    // Nanoseconds on a monotonic clock that is shared by all threads, so
+    // that the HTTP thread and the user thread can stamp the same reply.
+    static qint64 now();
+
+    static QNetworkReplyMetricsPrivate *get(QNetworkReplyMetrics &metrics)
+    { return metrics.d.data(); }
+    static const QNetworkReplyMetricsPrivate *get(const QNetworkReplyMetrics &metrics)
+    { return metrics.d.constData(); }
+
+    inline qint64 relative(qint64 time) const
+    { return (time < 0 || startTime < 0) ? -1 : time - startTime; }
+
+    // All times are values of now(), or -1 if the phase did not happen.
+    qint64 startTime;
+    qint64 domainLookupStart;
+    qint64 domainLookupEnd;
+    qint64 connectStart;
+    qint64 secureConnectionStart;
+    qint64 connectEnd;
+    qint64 requestStart;
+    qint64 responseStart;
+    qint64 responseEnd;
+
+    qint64 bytesSent;
+    qint64 bytesReceived;
+
+    QByteArray protocol;
+    QHostAddress peerAddress;
+    quint16 peerPort;
+    bool connectionReused;
+};
+
+class QNetworkHostMetricsPrivate : public QSharedData
+{
+public:
+    QNetworkHostMetricsPrivate();
+
+    static void add(QNetworkHostMetrics *host, const QNetworkReplyMetrics &reply, bool failed);
+
+    int requestCount;
+    int failedRequestCount;
+    int connectionCount;
+    int reusedConnectionCount;
+    int domainLookupCount;
+    qint64 bytesSent;
+    qint64 bytesReceived;
+    qint64 domainLookupTime;
+    qint64 connectTime;
+    qint64 secureConnectionTime;
+    qint64 timeToFirstByte;
+    qint64 responseTime;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKREPLYMETRICS_P_H
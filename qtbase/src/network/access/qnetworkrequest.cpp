@@ -266,6 +266,31 @@ QT_BEGIN_NAMESPACE
         that is redirecting from "https" to "http" protocol, are not allowed.
         (This value was introduced in 5.6.)
 
+    \value HTTP2AllowedAttribute
+        Requests only, type: QMetaType::Bool (default: false)
+        Indicates whether the QNetworkAccessManager code is
+        allowed to use HTTP/2 with this request. For "https" URLs HTTP/2
+        is negotiated via ALPN and HTTP/1.1 is used if the server does not
+        agree. For "http" URLs the connection starts HTTP/2 directly
+        ("h2c" with prior knowledge), so the server must be known to
+        support it. All requests to one host share a single connection.
+        (This value was introduced in 5.6.)
+
+    \value HTTP2WasUsedAttribute
+        Replies only, type: QMetaType::Bool (default: false)
+        Indicates whether HTTP/2 was used for receiving this reply.
+        (This value was introduced in 5.6.)
+
+    \value UploadContentEncodingAttribute
+        Requests only, type: QMetaType::QByteArray (default: empty)
+        The content coding, either "gzip" or "deflate", with which the
+        body of an HTTP request is compressed before it is sent. The
+        Content-Encoding and Content-Length headers are set accordingly;
+        the body is always buffered completely for this, regardless of
+        DoNotBufferUploadDataAttribute. Requests that already carry a
+        Content-Encoding header are sent unchanged.
+        (This value was introduced in 5.6.)
+
     \value User
         Special type. Additional information can be passed in
         QVariants with types ranging from User to UserMax. The default
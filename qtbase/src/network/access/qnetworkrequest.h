@@ -82,6 +82,9 @@ public:
         SpdyWasUsedAttribute,
         EmitAllUploadProgressSignalsAttribute,
         FollowRedirectsAttribute,
+        HTTP2AllowedAttribute,
+        HTTP2WasUsedAttribute,
+        UploadContentEncodingAttribute,
 
         User = 1000,
         UserMax = 32767
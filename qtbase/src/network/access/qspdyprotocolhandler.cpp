@@ -307,6 +307,7 @@ bool QSpdyProtocolHandler::sendRequest()
         m_inFlightStreams.insert(streamID, currentPair);
         connect(currentReply, SIGNAL(destroyed(QObject*)), this, SLOT(_q_replyDestroyed(QObject*)));
 
+        m_channel->recordRequestStart(currentReply, QByteArrayLiteral("spdy/3"));
         sendSYN_STREAM(currentPair, streamID, /* associatedToStreamID = */ 0);
         m_channel->spdyRequestsToSend.erase(it++);
     }
@@ -652,6 +653,7 @@ void QSpdyProtocolHandler::sendSYN_STREAM(HttpMessagePair messagePair,
     wireData.append(namesAndValues);
 
     sendControlFrame(FrameType_SYN_STREAM, flags, wireData.constData(), length);
+    reply->d_func()->metricsData()->bytesSent += 8 + length; // 8 == frame header
 
     if (reply->d_func()->state == QHttpNetworkReplyPrivate::SPDYUploading)
         uploadData(streamID);
@@ -722,6 +724,7 @@ bool QSpdyProtocolHandler::uploadData(qint32 streamID)
             } else {
                 replyPrivate->currentlyUploadedDataInWindow += currentWriteSize;
                 replyPrivate->totallyUploadedData += currentWriteSize;
+                replyPrivate->metricsData()->bytesSent += 8 + currentWriteSize;
                 dataLeftInWindow = replyPrivate->windowSizeUpload
                         - replyPrivate->currentlyUploadedDataInWindow;
                 request.uploadByteDevice()->advanceReadPointer(currentWriteSize);
@@ -885,6 +888,11 @@ void QSpdyProtocolHandler::parseHttpHeaders(char flags, const QByteArray &frameD
         return;
     }
 
+    QNetworkReplyMetricsPrivate *metrics = httpReply->d_func()->metricsData();
+    if (metrics->responseStart < 0)
+        metrics->responseStart = QNetworkReplyMetricsPrivate::now();
+    metrics->bytesReceived += 8 + frameData.size(); // 8 == frame header
+
     QByteArray uncompressedHeader;
     if (!uncompressHeader(headerValuePairs, &uncompressedHeader)) {
         qWarning("error reading header from SYN_REPLY message");
@@ -1204,6 +1212,8 @@ void QSpdyProtocolHandler::handleDataFrame(const QByteArray &frameHeaders)
         return;
     }
 
+    replyPrivate->metricsData()->bytesReceived += frameHeaders.size() + length;
+
     // check whether we need to send WINDOW_UPDATE (i.e. tell the sender it can send more)
     replyPrivate->currentlyReceivedDataInWindow += length;
     qint32 dataLeftInWindow = replyPrivate->windowSizeDownload - replyPrivate->currentlyReceivedDataInWindow;
@@ -0,0 +1,954 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+// for rand_s, _CRT_RAND_S must be #defined before #including stdlib.h.
+// put it at the beginning so some indirect inclusion doesn't break it
+#ifndef _CRT_RAND_S
+#define _CRT_RAND_S
+#endif
+#include <stdlib.h>
+
+#include "qdnsresolver_p.h"
+#include "qhostinfo_p.h"
+
+#include <qcoreapplication.h>
+#include <qdatetime.h>
+#include <qendian.h>
+#include <qfile.h>
+#include <qsemaphore.h>
+#include <qtcpsocket.h>
+#include <qthread.h>
+#include <qudpsocket.h>
+#include <qurl.h>
+#include <qvector.h>
+
+#ifdef Q_OS_UNIX
+#include "private/qcore_unix_p.h"
+#endif
+
+QT_BEGIN_NAMESPACE
+
+// the largest answer we accept over UDP; anything longer comes back
+// truncated and is retried over TCP
+static const int maxUdpMessageSize = 4096;
+// each socket expects one answer, anything else is read and dropped
+static const int datagramBatchSize = 4;
+// how many random bytes are read from the system at a time
+static const int randomPoolSize = 512;
+
+class QDnsResolverThread : public QThread
+{
+public:
+    QDnsResolverThread() : resolver(0)
+    {
+        setObjectName(QStringLiteral("Qt DNS resolver"));
+        start();
+        ready.acquire();
+    }
+
+    ~QDnsResolverThread()
+    {
+        quit();
+        wait();
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        qsrand(uint(QDateTime::currentMSecsSinceEpoch()) ^ uint(quintptr(this)));
+        QDnsResolver dnsResolver;
+        dnsResolver.setConfiguration(QDnsResolver::systemConfiguration());
+        resolver = &dnsResolver;
+        ready.release();
+        exec();
+        resolver = 0;
+    }
+
+    QDnsResolver *resolver;
+    QSemaphore ready;
+};
+
+Q_GLOBAL_STATIC(QDnsResolverThread, theResolverThread)
+
+QDnsResolver::QDnsResolver(QObject *parent)
+    : QObject(parent), processScheduled(false), randomPoolPosition(0)
+{
+    clock.start();
+}
+
+QDnsResolver::~QDnsResolver()
+{
+    // nobody will answer any more; let the waiters know
+    processIncoming();
+    QHostInfo info;
+    info.setError(QHostInfo::UnknownError);
+    info.setErrorString(QCoreApplication::translate("QHostInfo", "Host lookup aborted"));
+    waiting.clear();
+    const QList<Query *> pending = queries.values();
+    foreach (Query *query, pending)
+        finish(query, info, 0);
+}
+
+/*
+    Returns the resolver shared by all QHostInfo lookups, which runs in a
+    thread of its own, or 0 once the application is shutting down.
+*/
+QDnsResolver *QDnsResolver::instance()
+{
+    QDnsResolverThread *thread = theResolverThread();
+    return thread ? thread->resolver : 0;
+}
+
+/*
+    Reads the name servers, search domains and options from
+    /etc/resolv.conf and the static host names from /etc/hosts.
+*/
+QDnsResolver::Configuration QDnsResolver::systemConfiguration()
+{
+    Configuration configuration;
+#ifdef Q_OS_UNIX
+    QFile resolvConf(QStringLiteral("/etc/resolv.conf"));
+    if (resolvConf.open(QIODevice::ReadOnly))
+        parseResolvConf(resolvConf.readAll(), &configuration);
+    // like the C library, fall back to a server on this host
+    if (configuration.nameservers.isEmpty())
+        configuration.nameservers << Nameserver(QHostAddress(QHostAddress::LocalHost));
+
+    QFile hosts(QStringLiteral("/etc/hosts"));
+    if (hosts.open(QIODevice::ReadOnly))
+        parseHosts(hosts.readAll(), &configuration);
+#endif
+    return configuration;
+}
+
+void QDnsResolver::parseResolvConf(const QByteArray &data, Configuration *configuration)
+{
+    QStringList domain;
+    foreach (const QByteArray &rawLine, data.split('\n')) {
+        QByteArray line = rawLine;
+        const int comment = line.indexOf('#');
+        if (comment >= 0)
+            line.truncate(comment);
+        const int semicolon = line.indexOf(';');
+        if (semicolon >= 0)
+            line.truncate(semicolon);
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2)
+            continue;
+
+        const QByteArray &keyword = fields.at(0);
+        if (keyword == "nameserver") {
+            QHostAddress address;
+            if (address.setAddress(QString::fromLatin1(fields.at(1))))
+                configuration->nameservers << Nameserver(address);
+        } else if (keyword == "search") {
+            configuration->searchDomains.clear();
+            for (int i = 1; i < fields.size(); ++i)
+                configuration->searchDomains << QString::fromLatin1(fields.at(i));
+        } else if (keyword == "domain") {
+            domain = QStringList(QString::fromLatin1(fields.at(1)));
+        } else if (keyword == "options") {
+            for (int i = 1; i < fields.size(); ++i) {
+                const QByteArray &option = fields.at(i);
+                const int colon = option.indexOf(':');
+                if (colon < 0)
+                    continue;
+                bool ok;
+                const int value = option.mid(colon + 1).toInt(&ok);
+                if (!ok)
+                    continue;
+                const QByteArray name = option.left(colon);
+                if (name == "ndots")
+                    configuration->ndots = qBound(0, value, 15);
+                else if (name == "timeout")
+                    configuration->timeout = qBound(1, value, 30) * 1000;
+                else if (name == "attempts")
+                    configuration->attempts = qBound(1, value, 5);
+            }
+        }
+    }
+
+    // "domain" only applies when there is no "search" line
+    if (configuration->searchDomains.isEmpty())
+        configuration->searchDomains = domain;
+}
+
+void QDnsResolver::parseHosts(const QByteArray &data, Configuration *configuration)
+{
+    foreach (const QByteArray &rawLine, data.split('\n')) {
+        QByteArray line = rawLine;
+        const int comment = line.indexOf('#');
+        if (comment >= 0)
+            line.truncate(comment);
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2)
+            continue;
+
+        QHostAddress address;
+        if (!address.setAddress(QString::fromLatin1(fields.at(0))))
+            continue;
+        for (int i = 1; i < fields.size(); ++i) {
+            QList<QHostAddress> &addresses = configuration->hosts[QString::fromLatin1(fields.at(i)).toLower()];
+            if (!addresses.contains(address))
+                addresses << address;
+        }
+    }
+}
+
+QDnsResolver::Configuration QDnsResolver::configuration() const
+{
+    QMutexLocker locker(&mutex);
+    return config;
+}
+
+void QDnsResolver::setConfiguration(const Configuration &configuration)
+{
+    QMutexLocker locker(&mutex);
+    config = configuration;
+}
+
+bool QDnsResolver::isUsable() const
+{
+    QMutexLocker locker(&mutex);
+    return !config.nameservers.isEmpty();
+}
+
+/*
+    Starts looking up \a name and emits the result through \a result,
+    tagged with the lookup \a id. Can be called from any thread.
+*/
+void QDnsResolver::lookup(const QString &name, int id, QHostInfoResult *result)
+{
+    Waiter waiter;
+    waiter.id = id;
+    waiter.result = result;
+
+    QMutexLocker locker(&mutex);
+    if (id >= 0)
+        pendingIds.insert(id);
+    incoming << qMakePair(name, waiter);
+    if (!processScheduled) {
+        processScheduled = true;
+        QMetaObject::invokeMethod(this, "processIncoming", Qt::QueuedConnection);
+    }
+}
+
+QHostInfo QDnsResolver::lookupBlocking(const QString &name)
+{
+    Q_ASSERT(QThread::currentThread() != thread());
+
+    QSemaphore done;
+    QHostInfo info;
+    QHostInfoResult *result = new QHostInfoResult;
+    result->moveToThread(thread());
+    connect(result, &QHostInfoResult::resultsReady, [&](const QHostInfo &resultInfo) {
+        info = resultInfo;
+        done.release();
+    });
+    lookup(name, -1, result);
+    done.acquire();
+    return info;
+}
+
+void QDnsResolver::abort(int id)
+{
+    // ignore lookups that are not ours or already answered, which would
+    // otherwise stay in the set for good
+    QMutexLocker locker(&mutex);
+    if (pendingIds.contains(id))
+        aborted.insert(id);
+}
+
+void QDnsResolver::processIncoming()
+{
+    QList<QPair<QString, Waiter> > newLookups;
+    {
+        QMutexLocker locker(&mutex);
+        newLookups.swap(incoming);
+        processScheduled = false;
+        active = config;
+    }
+
+    for (int i = 0; i < newLookups.size(); ++i) {
+        const QString &name = newLookups.at(i).first;
+        const Waiter &waiter = newLookups.at(i).second;
+        const QString key = name.toLower();
+
+        // static host names
+        QHash<QString, QList<QHostAddress> >::const_iterator host = active.hosts.constFind(key);
+        if (host != active.hosts.constEnd()) {
+            QHostInfo info;
+            info.setHostName(name);
+            info.setAddresses(host.value());
+            emitResult(waiter, info);
+            continue;
+        }
+
+        // another lookup may have filled the cache in the meantime
+        bool valid = false;
+        QHostInfo cached = qt_qhostinfo_cache_get(name, &valid);
+        if (valid) {
+            emitResult(waiter, cached);
+            continue;
+        }
+
+        // share the query of a lookup for the same name in progress
+        if (Query *query = queries.value(key)) {
+            query->waiters << waiter;
+            continue;
+        }
+
+        Query *query = new Query;
+        query->name = name;
+        query->candidate = 0;
+        query->waiters << waiter;
+        query->ids[0] = query->ids[1] = 0;
+        query->sockets[0] = query->sockets[1] = 0;
+        query->ttl = -1;
+        query->negativeTtl = -1;
+        query->attempt = 0;
+        query->deadline = 0;
+        queries.insert(key, query);
+
+        if (queries.size() - waiting.size() > active.maxPendingQueries)
+            waiting.enqueue(query);
+        else
+            startQuery(query);
+    }
+}
+
+void QDnsResolver::startQuery(Query *query)
+{
+    if (active.nameservers.isEmpty()) {
+        QHostInfo info;
+        info.setHostName(query->name);
+        info.setError(QHostInfo::UnknownError);
+        info.setErrorString(QCoreApplication::translate("QHostInfo", "No name servers configured"));
+        finish(query, info, -1);
+        return;
+    }
+
+    const QByteArray ace = QUrl::toAce(query->name);
+    if (ace.isEmpty() || ace.size() > 253) {
+        QHostInfo info;
+        info.setHostName(query->name);
+        info.setError(QHostInfo::HostNotFound);
+        info.setErrorString(QCoreApplication::translate("QHostInfoAgent", "Invalid hostname"));
+        finish(query, info, -1);
+        return;
+    }
+
+    // the search list, in the order the C library uses
+    if (ace.endsWith('.')) {
+        query->candidates << ace.left(ace.size() - 1);
+    } else {
+        QList<QByteArray> searched;
+        foreach (const QString &domain, active.searchDomains) {
+            const QByteArray aceDomain = QUrl::toAce(domain);
+            if (!aceDomain.isEmpty())
+                searched << ace + '.' + aceDomain;
+        }
+        if (ace.count('.') >= active.ndots)
+            query->candidates << ace << searched;
+        else
+            query->candidates << searched << ace;
+    }
+
+    sendCandidate(query);
+}
+
+void QDnsResolver::sendCandidate(Query *query)
+{
+    query->addresses[0].clear();
+    query->addresses[1].clear();
+    query->ttl = -1;
+    query->attempt = 0;
+    if (send(query, 0))
+        send(query, 1);
+}
+
+const QDnsResolver::Nameserver &QDnsResolver::currentServer(const Query *query) const
+{
+    return active.nameservers.at(query->attempt % active.nameservers.size());
+}
+
+// Fills \a buffer with \a size bytes from the system's cryptographically
+// secure random number generator. Returns false if there is none.
+static bool fillRandom(char *buffer, int size)
+{
+#if defined(Q_OS_UNIX)
+    int randomfd = qt_safe_open("/dev/urandom", O_RDONLY);
+    if (randomfd == -1)
+        return false;
+    qint64 total = 0;
+    while (total < size) {
+        const qint64 r = qt_safe_read(randomfd, buffer + total, size - total);
+        if (r <= 0)
+            break;
+        total += r;
+    }
+    qt_safe_close(randomfd);
+    return total == size;
+#elif defined(Q_OS_WIN32) && !defined(Q_CC_GNU)
+    for (int i = 0; i + int(sizeof(uint)) <= size; i += sizeof(uint)) {
+        uint value;
+        if (rand_s(&value) != 0)
+            return false;
+        memcpy(buffer + i, &value, sizeof(uint));
+    }
+    return size % sizeof(uint) == 0;
+#else
+    Q_UNUSED(buffer);
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+/*
+    Returns a transaction ID an off-path attacker cannot predict, drawn
+    from the system's random number generator. Falls back to qrand() on
+    platforms without one.
+*/
+quint16 QDnsResolver::randomId()
+{
+    quint16 id;
+    do {
+        if (randomPoolPosition + int(sizeof(quint16)) > randomPool.size()) {
+            randomPool.resize(randomPoolSize);
+            randomPoolPosition = 0;
+            if (!fillRandom(randomPool.data(), randomPool.size())) {
+                for (int i = 0; i < randomPool.size(); ++i)
+                    randomPool[i] = char(qrand());
+            }
+        }
+        memcpy(&id, randomPool.constData() + randomPoolPosition, sizeof(quint16));
+        randomPoolPosition += sizeof(quint16);
+    } while (id == 0);
+    return id;
+}
+
+/*
+    Sends the A (\a index 0) or AAAA (\a index 1) query of \a query from
+    a new socket, replacing any earlier transaction. Fails the query and
+    returns false if no socket can be bound.
+*/
+bool QDnsResolver::send(Query *query, int index)
+{
+    closeTransaction(query, index);
+
+    const Nameserver &server = currentServer(query);
+    QUdpSocket *socket = new QUdpSocket(this);
+    // port 0 lets the system pick a random ephemeral port
+    if (!socket->bind(QHostAddress(server.address.protocol() == QAbstractSocket::IPv6Protocol
+                                   ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4))) {
+        const QString errorString = socket->errorString();
+        delete socket;
+        fail(query, errorString);
+        return false;
+    }
+    connect(socket, SIGNAL(readyRead()), SLOT(readDatagrams()));
+
+    const quint16 id = randomId();
+    query->ids[index] = id;
+    query->sockets[index] = socket;
+    transactions.insert(socket, qMakePair(query, index));
+
+    const QByteArray message = buildQuery(id, query->candidates.at(query->candidate),
+                                          index == 0 ? A : AAAA);
+    socket->writeDatagram(message, server.address, server.port);
+
+    query->deadline = clock.elapsed() + active.timeout;
+    if (!timer.isActive())
+        timer.start(50, this);
+
+#if defined(QDNSRESOLVER_DEBUG)
+    qDebug("QDnsResolver: query %04x for %s (%s) to %s from port %d", id,
+           query->candidates.at(query->candidate).constData(), index == 0 ? "A" : "AAAA",
+           qPrintable(server.address.toString()), socket->localPort());
+#endif
+    return true;
+}
+
+void QDnsResolver::retry(Query *query)
+{
+    foreach (QTcpSocket *socket, query->tcpSockets) {
+        tcpTransactions.remove(socket);
+        socket->disconnect(this);
+        socket->deleteLater();
+    }
+    query->tcpSockets.clear();
+
+    if (++query->attempt >= active.attempts * active.nameservers.size()) {
+        dropTransactions(query);
+        QHostInfo info;
+        info.setHostName(query->name);
+        if (!query->addresses[0].isEmpty() || !query->addresses[1].isEmpty()) {
+            // settle for what we have
+            info.setAddresses(query->addresses[0] + query->addresses[1]);
+            finish(query, info, query->ttl);
+        } else {
+            info.setError(QHostInfo::UnknownError);
+            info.setErrorString(QCoreApplication::translate("QHostInfo", "Name server did not respond"));
+            finish(query, info, -1);
+        }
+        return;
+    }
+
+    for (int index = 0; index < 2; ++index) {
+        if (query->ids[index] && !send(query, index))
+            return;
+    }
+}
+
+void QDnsResolver::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != timer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    if (queries.size() == waiting.size()) {
+        timer.stop();
+        return;
+    }
+
+    const qint64 now = clock.elapsed();
+    QList<Query *> expired;
+    foreach (Query *query, queries) {
+        if (query->deadline && query->deadline <= now)
+            expired << query;
+    }
+    foreach (Query *query, expired)
+        retry(query);
+}
+
+void QDnsResolver::readDatagrams()
+{
+    QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
+    if (!socket)
+        return;
+
+    QVector<QUdpSocket::Datagram> datagrams;
+    int count;
+    while ((count = socket->readDatagrams(datagrams, datagramBatchSize, maxUdpMessageSize)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            // an answer may finish the query and close this socket
+            const QPair<Query *, int> transaction = transactions.value(socket);
+            if (!transaction.first)
+                return;
+            const QUdpSocket::Datagram &datagram = datagrams.at(i);
+            handleResponse(transaction.first, transaction.second,
+                           datagram.data, datagram.address, datagram.port);
+        }
+    }
+}
+
+void QDnsResolver::handleResponse(Query *query, int index, const QByteArray &message,
+                                  const QHostAddress &from, quint16 port)
+{
+    Response response;
+    if (!parseResponse(message, &response))
+        return;
+
+    // only accept answers that match what we asked, and whom
+    if (response.id != query->ids[index])
+        return;
+    const Nameserver &server = currentServer(query);
+    if (!from.isNull() && (from != server.address || port != server.port))
+        return;
+    if (response.type != (index == 0 ? A : AAAA)
+        || qstricmp(response.name.constData(), query->candidates.at(query->candidate).constData()) != 0)
+        return;
+
+    if (response.truncated) {
+        // ask again over TCP
+        QTcpSocket *socket = new QTcpSocket(this);
+        TcpTransaction &tcp = tcpTransactions[socket];
+        tcp.query = query;
+        tcp.index = index;
+        const QByteArray request = buildQuery(response.id, query->candidates.at(query->candidate),
+                                              response.type);
+        tcp.request.resize(2);
+        qToBigEndian<quint16>(quint16(request.size()), reinterpret_cast<uchar *>(tcp.request.data()));
+        tcp.request += request;
+        query->tcpSockets << socket;
+        connect(socket, SIGNAL(connected()), SLOT(tcpConnected()));
+        connect(socket, SIGNAL(readyRead()), SLOT(tcpReadyRead()));
+        connect(socket, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(tcpFailed()));
+        socket->connectToHost(server.address, server.port);
+        query->deadline = clock.elapsed() + active.timeout;
+        return;
+    }
+
+    processResponse(query, index, response);
+}
+
+void QDnsResolver::tcpConnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (tcpTransactions.contains(socket))
+        socket->write(tcpTransactions.value(socket).request);
+}
+
+void QDnsResolver::tcpReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    QHash<QTcpSocket *, TcpTransaction>::iterator it = tcpTransactions.find(socket);
+    if (it == tcpTransactions.end())
+        return;
+
+    it->buffer += socket->readAll();
+    if (it->buffer.size() < 2)
+        return;
+    const int size = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(it->buffer.constData()));
+    if (it->buffer.size() < size + 2)
+        return;
+
+    const QByteArray message = it->buffer.mid(2, size);
+    Query *query = it->query;
+    const int index = it->index;
+    tcpTransactions.erase(it);
+    query->tcpSockets.removeOne(socket);
+    socket->disconnect(this);
+    socket->deleteLater();
+
+    // the address check does not apply to the connection we made ourselves
+    handleResponse(query, index, message, QHostAddress(), 0);
+}
+
+void QDnsResolver::tcpFailed()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    Query *query = tcpTransactions.value(socket).query;
+    if (query)
+        retry(query);
+}
+
+void QDnsResolver::processResponse(Query *query, int index, const Response &response)
+{
+    if (response.rcode != 0 && response.rcode != 3) {
+        // SERVFAIL, REFUSED and the like: try the next server
+        retry(query);
+        return;
+    }
+
+    closeTransaction(query, index);
+
+    // NOERROR with or without addresses, or NXDOMAIN
+    query->addresses[index] = response.addresses;
+    if (!response.addresses.isEmpty()) {
+        query->ttl = query->ttl < 0 ? response.ttl : qMin(query->ttl, response.ttl);
+    } else if (response.negativeTtl >= 0) {
+        query->negativeTtl = query->negativeTtl < 0 ? response.negativeTtl
+                                                    : qMin(query->negativeTtl, response.negativeTtl);
+    }
+
+    if (query->ids[0] || query->ids[1])
+        return;
+
+    QHostInfo info;
+    info.setHostName(query->name);
+    if (!query->addresses[0].isEmpty() || !query->addresses[1].isEmpty()) {
+        info.setAddresses(query->addresses[0] + query->addresses[1]);
+        finish(query, info, query->ttl);
+    } else if (++query->candidate < query->candidates.size()) {
+        sendCandidate(query);
+    } else {
+        info.setError(QHostInfo::HostNotFound);
+        info.setErrorString(QCoreApplication::translate("QHostInfoAgent", "Host not found"));
+        finish(query, info, query->negativeTtl);
+    }
+}
+
+void QDnsResolver::closeTransaction(Query *query, int index)
+{
+    query->ids[index] = 0;
+    if (QUdpSocket *socket = query->sockets[index]) {
+        transactions.remove(socket);
+        socket->disconnect(this);
+        socket->deleteLater();
+        query->sockets[index] = 0;
+    }
+}
+
+void QDnsResolver::dropTransactions(Query *query)
+{
+    for (int index = 0; index < 2; ++index)
+        closeTransaction(query, index);
+    foreach (QTcpSocket *socket, query->tcpSockets) {
+        tcpTransactions.remove(socket);
+        socket->disconnect(this);
+        socket->deleteLater();
+    }
+    query->tcpSockets.clear();
+}
+
+void QDnsResolver::fail(Query *query, const QString &errorString)
+{
+    QHostInfo info;
+    info.setHostName(query->name);
+    info.setError(QHostInfo::UnknownError);
+    info.setErrorString(errorString);
+    finish(query, info, -1);
+}
+
+void QDnsResolver::finish(Query *query, const QHostInfo &info, int ttl)
+{
+#if defined(QDNSRESOLVER_DEBUG)
+    qDebug("QDnsResolver: %s resolved to %d addresses, error %d, ttl %d", qPrintable(query->name),
+           info.addresses().size(), int(info.error()), ttl);
+#endif
+    dropTransactions(query);
+    queries.remove(query->name.toLower());
+    qt_qhostinfo_cache_put(query->name, info, ttl);
+
+    foreach (const Waiter &waiter, query->waiters)
+        emitResult(waiter, info);
+    delete query;
+
+    // start the next queued lookup
+    while (!waiting.isEmpty()) {
+        Query *next = waiting.dequeue();
+        if (queries.value(next->name.toLower()) == next) {
+            startQuery(next);
+            break;
+        }
+    }
+}
+
+void QDnsResolver::emitResult(const Waiter &waiter, QHostInfo info)
+{
+    bool wasAborted;
+    {
+        QMutexLocker locker(&mutex);
+        pendingIds.remove(waiter.id);
+        wasAborted = aborted.remove(waiter.id);
+    }
+    if (!wasAborted) {
+        info.setLookupId(waiter.id);
+        waiter.result->emitResultsReady(info);
+    }
+    delete waiter.result;
+}
+
+static void appendName(QByteArray *message, const QByteArray &name)
+{
+    foreach (const QByteArray &label, name.split('.')) {
+        if (label.isEmpty())
+            continue;
+        message->append(char(qMin(label.size(), 63)));
+        message->append(label.constData(), qMin(label.size(), 63));
+    }
+    message->append('\0');
+}
+
+static inline void appendUInt16(QByteArray *message, quint16 value)
+{
+    message->append(char(value >> 8));
+    message->append(char(value & 0xff));
+}
+
+/*
+    Returns a recursive query for the \a type records of \a name, with the
+    transaction ID \a id.
+*/
+QByteArray QDnsResolver::buildQuery(quint16 id, const QByteArray &name, quint16 type)
+{
+    QByteArray message;
+    message.reserve(18 + name.size());
+    appendUInt16(&message, id);
+    appendUInt16(&message, 0x0100); // standard query, recursion desired
+    appendUInt16(&message, 1); // one question
+    appendUInt16(&message, 0);
+    appendUInt16(&message, 0);
+    appendUInt16(&message, 0);
+    appendName(&message, name);
+    appendUInt16(&message, type);
+    appendUInt16(&message, 1); // IN
+    return message;
+}
+
+static inline quint16 readUInt16(const QByteArray &message, int offset)
+{
+    return qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(message.constData()) + offset);
+}
+
+static inline quint32 readUInt32(const QByteArray &message, int offset)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(message.constData()) + offset);
+}
+
+// Reads the possibly compressed name at *offset into *name and advances
+// *offset past it. Returns false if the name is malformed.
+static bool readName(const QByteArray &message, int *offset, QByteArray *name)
+{
+    int position = *offset;
+    int jumps = 0;
+    bool jumped = false;
+    if (name)
+        name->clear();
+
+    for (;;) {
+        if (position >= message.size())
+            return false;
+        const uchar length = uchar(message.at(position));
+        if (length == 0) {
+            ++position;
+            break;
+        }
+        if ((length & 0xc0) == 0xc0) {
+            if (position + 1 >= message.size() || ++jumps > 32)
+                return false;
+            if (!jumped)
+                *offset = position + 2;
+            jumped = true;
+            position = readUInt16(message, position) & 0x3fff;
+            continue;
+        }
+        if ((length & 0xc0) || position + 1 + length > message.size())
+            return false;
+        if (name) {
+            if (!name->isEmpty())
+                name->append('.');
+            name->append(message.constData() + position + 1, length);
+        }
+        position += 1 + length;
+    }
+
+    if (!jumped)
+        *offset = position;
+    if (name)
+        *name = name->toLower();
+    return true;
+}
+
+/*
+    Parses the DNS response in \a message into \a response, following
+    CNAME records from the question name to its addresses. Returns false
+    if \a message is not a well-formed response.
+*/
+bool QDnsResolver::parseResponse(const QByteArray &message, Response *response)
+{
+    if (message.size() < 12)
+        return false;
+    const quint16 flags = readUInt16(message, 2);
+    if (!(flags & 0x8000)) // not a response
+        return false;
+    response->id = readUInt16(message, 0);
+    response->truncated = flags & 0x0200;
+    response->rcode = flags & 0x000f;
+
+    const int questions = readUInt16(message, 4);
+    const int answers = readUInt16(message, 6);
+    const int authorities = readUInt16(message, 8);
+    if (questions != 1)
+        return false;
+
+    int offset = 12;
+    if (!readName(message, &offset, &response->name) || offset + 4 > message.size())
+        return false;
+    response->type = readUInt16(message, offset);
+    offset += 4;
+
+    struct Record {
+        QByteArray name;
+        quint16 type;
+        quint32 ttl;
+        int data;
+        int length;
+    };
+    QList<Record> records;
+    for (int i = 0; i < answers + authorities; ++i) {
+        Record record;
+        if (!readName(message, &offset, &record.name) || offset + 10 > message.size())
+            return false;
+        record.type = readUInt16(message, offset);
+        record.ttl = qMin<quint32>(readUInt32(message, offset + 4), 0x7fffffff);
+        record.length = readUInt16(message, offset + 8);
+        record.data = offset + 10;
+        offset = record.data + record.length;
+        if (offset > message.size())
+            return false;
+        if (i < answers) {
+            records << record;
+        } else if (record.type == SOA) {
+            // the negative caching TTL is the lower of the record's TTL
+            // and its MINIMUM field (RFC 2308)
+            int position = record.data;
+            if (readName(message, &position, 0) && readName(message, &position, 0)
+                && position + 20 <= record.data + record.length) {
+                response->negativeTtl = int(qMin(record.ttl, readUInt32(message, position + 16)));
+            }
+        }
+    }
+
+    // follow the CNAME chain from the question name
+    QByteArray owner = response->name;
+    int chainTtl = -1;
+    for (int hops = 0; hops < 16; ++hops) {
+        bool followed = false;
+        foreach (const Record &record, records) {
+            if (record.type == CNAME && record.name == owner) {
+                int position = record.data;
+                if (!readName(message, &position, &owner))
+                    return false;
+                chainTtl = chainTtl < 0 ? int(record.ttl) : qMin(chainTtl, int(record.ttl));
+                followed = true;
+                break;
+            }
+        }
+        if (!followed)
+            break;
+    }
+
+    foreach (const Record &record, records) {
+        if (record.name != owner || record.type != response->type)
+            continue;
+        QHostAddress address;
+        if (record.type == A && record.length == 4)
+            address.setAddress(readUInt32(message, record.data));
+        else if (record.type == AAAA && record.length == 16)
+            address.setAddress(reinterpret_cast<const quint8 *>(message.constData() + record.data));
+        else
+            continue;
+        if (!response->addresses.contains(address))
+            response->addresses << address;
+        response->ttl = response->ttl < 0 ? int(record.ttl) : qMin(response->ttl, int(record.ttl));
+    }
+    if (response->ttl >= 0 && chainTtl >= 0)
+        response->ttl = qMin(response->ttl, chainTtl);
+
+    return true;
+}
+
+QT_END_NAMESPACE
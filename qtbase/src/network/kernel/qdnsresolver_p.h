@@ -0,0 +1,222 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QDNSRESOLVER_P_H
+#define QDNSRESOLVER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QHostInfo class.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "QtCore/qbasictimer.h"
+#include "QtCore/qelapsedtimer.h"
+#include "QtCore/qhash.h"
+#include "QtCore/qlist.h"
+#include "QtCore/qmutex.h"
+#include "QtCore/qobject.h"
+#include "QtCore/qqueue.h"
+#include "QtCore/qset.h"
+#include "QtCore/qstringlist.h"
+#include "QtNetwork/qhostaddress.h"
+#include "QtNetwork/qhostinfo.h"
+
+QT_BEGIN_NAMESPACE
+
+//#define QDNSRESOLVER_DEBUG
+
+class QHostInfoResult;
+class QTcpSocket;
+class QUdpSocket;
+
+/*
+  A stub resolver that talks to the configured name servers itself, over
+  UDP and, for truncated answers, TCP. All lookups share one thread, so
+  thousands of names can be in flight at once instead of one per QHostInfo
+  thread pool thread. Every transaction has a random ID and a socket of its
+  own, bound to a port of the system's choosing, so that a forged answer
+  has to guess both (RFC 5452).
+*/
+class Q_NETWORK_EXPORT QDnsResolver : public QObject
+{
+    Q_OBJECT
+public:
+    struct Nameserver
+    {
+        Nameserver(const QHostAddress &serverAddress = QHostAddress(), quint16 serverPort = 53)
+            : address(serverAddress), port(serverPort) {}
+        QHostAddress address;
+        quint16 port;
+    };
+
+    struct Configuration
+    {
+        Configuration() : ndots(1), timeout(5000), attempts(2), maxPendingQueries(256) {}
+
+        QList<Nameserver> nameservers;
+        QStringList searchDomains;
+        QHash<QString, QList<QHostAddress> > hosts; // lower case name -> addresses
+        int ndots;
+        int timeout; // msecs per attempt
+        int attempts; // per name server
+        int maxPendingQueries;
+    };
+
+    struct Response
+    {
+        Response() : id(0), rcode(0), type(0), truncated(false), ttl(-1), negativeTtl(-1) {}
+
+        quint16 id;
+        int rcode;
+        quint16 type;
+        bool truncated;
+        QByteArray name;
+        QList<QHostAddress> addresses;
+        int ttl; // lowest TTL of the records leading to the addresses
+        int negativeTtl; // from the SOA record of a negative answer
+    };
+
+    enum RecordType {
+        A = 1,
+        CNAME = 5,
+        SOA = 6,
+        AAAA = 28
+    };
+
+    explicit QDnsResolver(QObject *parent = 0);
+    ~QDnsResolver();
+
+    static QDnsResolver *instance();
+
+    static Configuration systemConfiguration();
+    static void parseResolvConf(const QByteArray &data, Configuration *configuration);
+    static void parseHosts(const QByteArray &data, Configuration *configuration);
+
+    Configuration configuration() const;
+    void setConfiguration(const Configuration &configuration);
+    bool isUsable() const;
+
+    // thread-safe; the resolver takes ownership of result
+    void lookup(const QString &name, int id, QHostInfoResult *result);
+    QHostInfo lookupBlocking(const QString &name);
+    void abort(int id);
+
+    static QByteArray buildQuery(quint16 id, const QByteArray &name, quint16 type);
+    static bool parseResponse(const QByteArray &message, Response *response);
+
+protected:
+    void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void processIncoming();
+    void readDatagrams();
+    void tcpConnected();
+    void tcpReadyRead();
+    void tcpFailed();
+
+private:
+    struct Waiter
+    {
+        int id;
+        QHostInfoResult *result;
+    };
+
+    struct Query
+    {
+        QString name;
+        QList<QByteArray> candidates;
+        int candidate;
+        QList<Waiter> waiters;
+        quint16 ids[2]; // A and AAAA transactions, 0 once answered
+        QUdpSocket *sockets[2];
+        QList<QHostAddress> addresses[2];
+        int ttl;
+        int negativeTtl;
+        int attempt;
+        qint64 deadline;
+        QList<QTcpSocket *> tcpSockets;
+    };
+
+    struct TcpTransaction
+    {
+        Query *query;
+        int index;
+        QByteArray request;
+        QByteArray buffer;
+    };
+
+    void startQuery(Query *query);
+    void sendCandidate(Query *query);
+    bool send(Query *query, int index);
+    void retry(Query *query);
+    void handleResponse(Query *query, int index, const QByteArray &message,
+                        const QHostAddress &from, quint16 port);
+    void processResponse(Query *query, int index, const Response &response);
+    void fail(Query *query, const QString &errorString);
+    void finish(Query *query, const QHostInfo &info, int ttl);
+    void emitResult(const Waiter &waiter, QHostInfo info);
+    void closeTransaction(Query *query, int index);
+    void dropTransactions(Query *query);
+    quint16 randomId();
+    const Nameserver &currentServer(const Query *query) const;
+
+    // guarded by mutex, written from any thread
+    mutable QMutex mutex;
+    Configuration config;
+    QList<QPair<QString, Waiter> > incoming;
+    QSet<int> pendingIds; // lookups not answered yet
+    QSet<int> aborted; // a subset of pendingIds
+    bool processScheduled;
+
+    // only used in the resolver's thread
+    Configuration active;
+    QHash<QString, Query *> queries;
+    QHash<QUdpSocket *, QPair<Query *, int> > transactions;
+    QQueue<Query *> waiting;
+    QHash<QTcpSocket *, TcpTransaction> tcpTransactions;
+    QByteArray randomPool;
+    int randomPoolPosition;
+    QElapsedTimer clock;
+    QBasicTimer timer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QDNSRESOLVER_P_H
@@ -33,6 +33,7 @@
 
 #include "qhostinfo.h"
 #include "qhostinfo_p.h"
+#include "qdnsresolver_p.h"
 
 #include "QtCore/qscopedpointer.h"
 #include <qabstracteventdispatcher.h>
@@ -53,6 +54,21 @@ QT_BEGIN_NAMESPACE
 
 Q_GLOBAL_STATIC(QHostInfoLookupManager, theHostInfoLookupManager)
 
+static QBasicAtomicInt theResolverBackend = Q_BASIC_ATOMIC_INITIALIZER(QHostInfo::SystemResolver);
+
+// Returns the built-in resolver if it should handle \a name. Reverse
+// lookups are always left to the system.
+static QDnsResolver *builtInResolver(const QString &name)
+{
+    if (theResolverBackend.load() != QHostInfo::BuiltInResolver)
+        return 0;
+    QHostAddress address;
+    if (address.setAddress(name))
+        return 0;
+    QDnsResolver *resolver = QDnsResolver::instance();
+    return resolver && resolver->isUsable() ? resolver : 0;
+}
+
 /*!
     \class QHostInfo
     \brief The QHostInfo class provides static functions for host name lookups.
@@ -102,7 +118,16 @@ Q_GLOBAL_STATIC(QHostInfoLookupManager, theHostInfoLookupManager)
     but also changes the order of signal emissions when using lookupHost()
     compared to previous versions of Qt.
     \note Since Qt 4.6.3 QHostInfo is using a small internal 60 second DNS cache
-    for performance improvements.
+    for performance improvements. Its size and the age of its entries can be
+    changed with setCacheSize(), setMaximumCacheAge() and
+    setNegativeCacheAge().
+
+    Applications that resolve many names at once can switch to a built-in
+    resolver with setResolverBackend(). It queries the name servers itself
+    instead of calling the operating system's resolver from a pool of
+    threads, so the number of lookups in flight is not bounded by the
+    number of threads, and it caches results for as long as the name
+    server allows.
 
     \sa QAbstractSocket, {http://www.rfc-editor.org/rfc/rfc3492.txt}{RFC 3492}
 */
@@ -189,6 +214,15 @@ int QHostInfo::lookupHost(const QString &name, QObject *receiver,
             }
         }
 
+        if (QDnsResolver *resolver = builtInResolver(name)) {
+            QHostInfoResult *result = new QHostInfoResult;
+            if (receiver)
+                QObject::connect(result, SIGNAL(resultsReady(QHostInfo)), receiver, member, Qt::QueuedConnection);
+            result->moveToThread(resolver->thread());
+            resolver->lookup(name, id, result);
+            return id;
+        }
+
         // cache is not enabled or it was not in the cache, do normal lookup
         QHostInfoRunnable* runnable = new QHostInfoRunnable(name, id);
         if (receiver)
@@ -206,6 +240,10 @@ int QHostInfo::lookupHost(const QString &name, QObject *receiver,
 void QHostInfo::abortHostLookup(int id)
 {
     theHostInfoLookupManager()->abortLookup(id);
+    if (theResolverBackend.load() == BuiltInResolver) {
+        if (QDnsResolver *resolver = QDnsResolver::instance())
+            resolver->abort(id);
+    }
 }
 
 /*!
@@ -227,6 +265,10 @@ QHostInfo QHostInfo::fromName(const QString &name)
     qDebug("QHostInfo::fromName(\"%s\")",name.toLatin1().constData());
 #endif
 
+    // the built-in resolver fills the cache itself
+    if (QDnsResolver *resolver = builtInResolver(name))
+        return resolver->lookupBlocking(name);
+
     QHostInfo hostInfo = QHostInfoAgent::fromName(name);
     QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
     manager->cache.put(name, hostInfo);
@@ -443,6 +485,131 @@ QString QHostInfo::localHostName()
     \sa hostName()
 */
 
+/*!
+    \enum QHostInfo::ResolverBackend
+    \since 5.6
+
+    This enum describes how QHostInfo resolves host names.
+
+    \value SystemResolver The operating system's resolver is called from a
+    pool of up to 20 threads. This is the default.
+
+    \value BuiltInResolver Queries are sent to the name servers directly,
+    over UDP and, for large answers, TCP, from a single thread that can
+    have hundreds of lookups in flight. The name servers, search domains
+    and static host names are read from \c /etc/resolv.conf and
+    \c /etc/hosts. Results are cached for the time to live given by the
+    name server, but no longer than maximumCacheAge(). Reverse lookups and
+    platforms without \c /etc/resolv.conf keep using the system resolver.
+*/
+
+/*!
+    \since 5.6
+
+    Sets the resolver used for subsequent lookups to \a backend.
+
+    \sa resolverBackend()
+*/
+void QHostInfo::setResolverBackend(ResolverBackend backend)
+{
+    theResolverBackend.store(backend);
+}
+
+/*!
+    \since 5.6
+
+    Returns the resolver used for lookups. The default is SystemResolver.
+
+    \sa setResolverBackend()
+*/
+QHostInfo::ResolverBackend QHostInfo::resolverBackend()
+{
+    return ResolverBackend(theResolverBackend.load());
+}
+
+/*!
+    \since 5.6
+
+    Sets the maximum number of host names kept in the lookup cache to
+    \a size. The default is 128; 0 disables caching.
+
+    \sa cacheSize()
+*/
+void QHostInfo::setCacheSize(int size)
+{
+    if (QHostInfoLookupManager *manager = theHostInfoLookupManager())
+        manager->cache.setMaxSize(size);
+}
+
+/*!
+    \since 5.6
+
+    Returns the maximum number of host names kept in the lookup cache.
+
+    \sa setCacheSize()
+*/
+int QHostInfo::cacheSize()
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    return manager ? manager->cache.maxSize() : 0;
+}
+
+/*!
+    \since 5.6
+
+    Sets the longest time, in \a seconds, that a successful lookup is
+    cached. The default is 60. The built-in resolver caches for a shorter
+    time if the name server says so.
+
+    \sa maximumCacheAge(), setNegativeCacheAge()
+*/
+void QHostInfo::setMaximumCacheAge(int seconds)
+{
+    if (QHostInfoLookupManager *manager = theHostInfoLookupManager())
+        manager->cache.setMaxAge(seconds);
+}
+
+/*!
+    \since 5.6
+
+    Returns the maximum number of seconds a successful lookup is cached.
+
+    \sa setMaximumCacheAge()
+*/
+int QHostInfo::maximumCacheAge()
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    return manager ? manager->cache.maxAge() : 0;
+}
+
+/*!
+    \since 5.6
+
+    Sets the number of \a seconds a lookup that failed with HostNotFound is
+    cached for. The default is 0, which means failures are not cached. The
+    built-in resolver caches shorter if the name server says so.
+
+    \sa negativeCacheAge(), setMaximumCacheAge()
+*/
+void QHostInfo::setNegativeCacheAge(int seconds)
+{
+    if (QHostInfoLookupManager *manager = theHostInfoLookupManager())
+        manager->cache.setNegativeMaxAge(seconds);
+}
+
+/*!
+    \since 5.6
+
+    Returns the number of seconds failed lookups are cached.
+
+    \sa setNegativeCacheAge()
+*/
+int QHostInfo::negativeCacheAge()
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    return manager ? manager->cache.negativeMaxAge() : 0;
+}
+
 QHostInfoRunnable::QHostInfoRunnable(const QString &hn, int i) : toBeLookedUp(hn), id(i)
 {
     setAutoDelete(true);
@@ -693,6 +860,22 @@ QHostInfo qt_qhostinfo_lookup(const QString &name, QObject *receiver, const char
     return QHostInfo();
 }
 
+QHostInfo qt_qhostinfo_cache_get(const QString &name, bool *valid)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && manager->cache.isEnabled())
+        return manager->cache.get(name, valid);
+    *valid = false;
+    return QHostInfo();
+}
+
+void qt_qhostinfo_cache_put(const QString &name, const QHostInfo &info, int ttl)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && manager->cache.isEnabled())
+        manager->cache.put(name, info, ttl);
+}
+
 void qt_qhostinfo_clear_cache()
 {
     QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
@@ -722,7 +905,7 @@ void qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolut
 
 // cache for 60 seconds
 // cache 128 items
-QHostInfoCache::QHostInfoCache() : max_age(60), enabled(true), cache(128)
+QHostInfoCache::QHostInfoCache() : enabled(true), max_age(60), negative_max_age(0), cache(128)
 {
 #ifdef QT_QHOSTINFO_CACHE_DISABLED_BY_DEFAULT
     enabled = false;
@@ -741,6 +924,41 @@ void QHostInfoCache::setEnabled(bool e)
     enabled = e;
 }
 
+int QHostInfoCache::maxSize()
+{
+    QMutexLocker locker(&this->mutex);
+    return cache.maxCost();
+}
+
+void QHostInfoCache::setMaxSize(int size)
+{
+    QMutexLocker locker(&this->mutex);
+    cache.setMaxCost(qMax(size, 0));
+}
+
+int QHostInfoCache::maxAge()
+{
+    QMutexLocker locker(&this->mutex);
+    return max_age;
+}
+
+void QHostInfoCache::setMaxAge(int seconds)
+{
+    QMutexLocker locker(&this->mutex);
+    max_age = qMax(seconds, 0);
+}
+
+int QHostInfoCache::negativeMaxAge()
+{
+    QMutexLocker locker(&this->mutex);
+    return negative_max_age;
+}
+
+void QHostInfoCache::setNegativeMaxAge(int seconds)
+{
+    QMutexLocker locker(&this->mutex);
+    negative_max_age = qMax(seconds, 0);
+}
 
 QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
 {
@@ -748,7 +966,7 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
 
     *valid = false;
     if (QHostInfoCacheElement *element = cache.object(name)) {
-        if (element->age.elapsed() < max_age*1000)
+        if (element->age.elapsed() < element->lifetime)
             *valid = true;
         return element->info;
 
@@ -760,18 +978,30 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
     return QHostInfo();
 }
 
-void QHostInfoCache::put(const QString &name, const QHostInfo &info)
+// \a ttl is the time to live in seconds reported by the name server, or
+// -1 if unknown; entries never outlive the configured maximum age
+void QHostInfoCache::put(const QString &name, const QHostInfo &info, int ttl)
 {
-    // if the lookup failed, don't cache
-    if (info.error() != QHostInfo::NoError)
+    QMutexLocker locker(&this->mutex);
+
+    int lifetime;
+    if (info.error() == QHostInfo::NoError)
+        lifetime = max_age;
+    else if (info.error() == QHostInfo::HostNotFound)
+        lifetime = negative_max_age;
+    else
+        lifetime = 0; // transient failure, don't cache
+    if (ttl >= 0)
+        lifetime = qMin(lifetime, ttl);
+    if (lifetime <= 0)
         return;
 
     QHostInfoCacheElement* element = new QHostInfoCacheElement();
     element->info = info;
     element->age = QElapsedTimer();
     element->age.start();
+    element->lifetime = lifetime * qint64(1000);
 
-    QMutexLocker locker(&this->mutex);
     cache.insert(name, element); // cache will take ownership
 }
 
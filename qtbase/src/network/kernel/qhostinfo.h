@@ -53,6 +53,11 @@ public:
         UnknownError
     };
 
+    enum ResolverBackend {
+        SystemResolver,
+        BuiltInResolver
+    };
+
     explicit QHostInfo(int lookupId = -1);
     QHostInfo(const QHostInfo &d);
     QHostInfo &operator=(const QHostInfo &d);
@@ -80,6 +85,15 @@ public:
     static QString localHostName();
     static QString localDomainName();
 
+    static void setResolverBackend(ResolverBackend backend);
+    static ResolverBackend resolverBackend();
+    static void setCacheSize(int size);
+    static int cacheSize();
+    static void setMaximumCacheAge(int seconds);
+    static int maximumCacheAge();
+    static void setNegativeCacheAge(int seconds);
+    static int negativeCacheAge();
+
 private:
     QScopedPointer<QHostInfoPrivate> d;
 };
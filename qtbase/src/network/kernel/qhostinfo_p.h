@@ -67,7 +67,7 @@
 QT_BEGIN_NAMESPACE
 
 
-class QHostInfoResult : public QObject
+class Q_AUTOTEST_EXPORT QHostInfoResult : public QObject
 {
     Q_OBJECT
 public Q_SLOTS:
@@ -118,24 +118,36 @@ QHostInfo Q_NETWORK_EXPORT qt_qhostinfo_lookup(const QString &name, QObject *rec
 void Q_AUTOTEST_EXPORT qt_qhostinfo_clear_cache();
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e);
 void Q_AUTOTEST_EXPORT qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolution);
+QHostInfo qt_qhostinfo_cache_get(const QString &name, bool *valid);
+void qt_qhostinfo_cache_put(const QString &name, const QHostInfo &info, int ttl);
 
 class QHostInfoCache
 {
 public:
     QHostInfoCache();
-    const int max_age; // seconds
 
     QHostInfo get(const QString &name, bool *valid);
-    void put(const QString &name, const QHostInfo &info);
+    void put(const QString &name, const QHostInfo &info, int ttl = -1);
     void clear();
 
     bool isEnabled();
     void setEnabled(bool e);
+
+    int maxSize();
+    void setMaxSize(int size);
+    int maxAge();
+    void setMaxAge(int seconds);
+    int negativeMaxAge();
+    void setNegativeMaxAge(int seconds);
+
 private:
     bool enabled;
+    int max_age; // seconds
+    int negative_max_age; // seconds, 0 disables caching failed lookups
     struct QHostInfoCacheElement {
         QHostInfo info;
         QElapsedTimer age;
+        qint64 lifetime; // msecs
     };
     QCache<QString,QHostInfoCacheElement> cache;
     QMutex mutex;
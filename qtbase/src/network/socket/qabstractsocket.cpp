@@ -429,6 +429,13 @@
     another socket. On Windows and Unix, this is equivalent to the SO_REUSEADDR
     socket option.
 
+    \value ReusePortHint Allow several sockets, typically one per thread or
+    process, to bind the same address and port, with the kernel spreading
+    incoming datagrams and connections between them. This value was
+    introduced in Qt 5.6. On Unix, this is equivalent to the SO_REUSEPORT
+    socket option; elsewhere it is ignored. All sockets sharing the port
+    must pass this flag.
+
     \value DefaultForPlatform The default option for the current platform.
     On Unix and \macos, this is equivalent to (DontShareAddress
     + ReuseAddressHint), and on Windows, its equivalent to ShareAddress.
@@ -877,11 +884,31 @@ bool QAbstractSocketPrivate::flush()
         return false;
     }
 
-    qint64 nextSize = writeBuffer.nextDataBlockSize();
-    const char *ptr = writeBuffer.readPointer();
+    // Collect the buffered blocks, so that a stream socket can hand them
+    // all to the engine in one gathering write. Datagram sockets must
+    // keep each block a datagram of its own.
+    enum { MaxFlushBlocks = 16 };
+    const char *blocks[MaxFlushBlocks];
+    qint64 sizes[MaxFlushBlocks];
+    const int maxBlocks = socketType == QAbstractSocket::TcpSocket ? int(MaxFlushBlocks) : 1;
+    int blockCount = 0;
+    qint64 position = 0;
+    while (blockCount < maxBlocks) {
+        qint64 length;
+        const char *ptr = writeBuffer.readPointerAtPosition(position, length);
+        if (!ptr || length <= 0)
+            break;
+        blocks[blockCount] = ptr;
+        sizes[blockCount++] = length;
+        position += length;
+    }
 
     // Attempt to write it all in one chunk.
-    qint64 written = nextSize ? socketEngine->write(ptr, nextSize) : Q_INT64_C(0);
+    qint64 written = Q_INT64_C(0);
+    if (blockCount > 1)
+        written = socketEngine->writeBlocks(blocks, sizes, blockCount);
+    else if (blockCount == 1)
+        written = socketEngine->write(blocks[0], sizes[0]);
     if (written < 0) {
 #if defined (QABSTRACTSOCKET_DEBUG)
         qDebug() << "QAbstractSocketPrivate::flush() write error, aborting." << socketEngine->errorString();
@@ -1530,6 +1557,8 @@ bool QAbstractSocketPrivate::bind(const QHostAddress &address, quint16 port, QAb
         socketEngine->setOption(QAbstractSocketEngine::AddressReusable, 1);
     else
         socketEngine->setOption(QAbstractSocketEngine::AddressReusable, 0);
+    if (mode & QAbstractSocket::ReusePortHint)
+        socketEngine->setOption(QAbstractSocketEngine::ReusePortOption, 1);
 #endif
 #ifdef Q_OS_WIN
     if (mode & QAbstractSocket::ReuseAddressHint)
@@ -119,7 +119,8 @@ public:
         DefaultForPlatform = 0x0,
         ShareAddress = 0x1,
         DontShareAddress = 0x2,
-        ReuseAddressHint = 0x4
+        ReuseAddressHint = 0x4,
+        ReusePortHint = 0x8
     };
     Q_DECLARE_FLAGS(BindMode, BindFlag)
     enum PauseMode {
@@ -185,6 +185,61 @@ void QAbstractSocketEngine::proxyAuthenticationRequired(const QNetworkProxy &pro
 #endif
 
 
+/*
+    Writes as much as possible of the \a count blocks in \a blocks, whose
+    sizes are given in \a sizes, and returns the number of bytes written,
+    or -1 if an error occurred. Engines that can gather several buffers
+    in one system call reimplement this; the default writes the first
+    block only.
+*/
+qint64 QAbstractSocketEngine::writeBlocks(const char * const *blocks, const qint64 *sizes, int count)
+{
+    if (count <= 0)
+        return 0;
+    return write(blocks[0], sizes[0]);
+}
+
+#ifndef QT_NO_UDPSOCKET
+/*
+    Receives up to \a count pending datagrams of at most \a maxSize bytes
+    each into \a datagrams, filling \a headers according to \a options,
+    and returns the number of datagrams received, or -1 if an error
+    occurred before any datagram was received. The default implementation
+    calls readDatagram() once per datagram.
+*/
+int QAbstractSocketEngine::readDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                                         int maxSize, PacketHeaderOptions options)
+{
+    int received = 0;
+    while (received < count && hasPendingDatagrams()) {
+        QByteArray &datagram = datagrams[received];
+        datagram.resize(maxSize);
+        const qint64 size = readDatagram(datagram.data(), maxSize,
+                                         headers ? &headers[received] : 0, options);
+        if (size < 0)
+            return received ? received : -1;
+        datagram.resize(int(size));
+        ++received;
+    }
+    return received;
+}
+
+/*
+    Sends the \a count datagrams in \a datagrams to the destinations in
+    \a headers and returns the number of datagrams sent, or -1 if an error
+    occurred before any datagram was sent. The default implementation
+    calls writeDatagram() once per datagram.
+*/
+int QAbstractSocketEngine::writeDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (writeDatagram(datagrams[i].constData(), datagrams[i].size(), headers[i]) < 0)
+            return i ? i : -1;
+    }
+    return count;
+}
+#endif // QT_NO_UDPSOCKET
+
 QAbstractSocket::SocketState QAbstractSocketEngine::state() const
 {
     return d_func()->socketState;
@@ -120,7 +120,8 @@ public:
         MulticastLoopbackOption,
         TypeOfServiceOption,
         ReceivePacketInformation,
-        ReceiveHopLimit
+        ReceiveHopLimit,
+        ReusePortOption
     };
 
     enum PacketHeaderOption {
@@ -152,6 +153,7 @@ public:
 
     virtual qint64 read(char *data, qint64 maxlen) = 0;
     virtual qint64 write(const char *data, qint64 len) = 0;
+    virtual qint64 writeBlocks(const char * const *blocks, const qint64 *sizes, int count);
 
 #ifndef QT_NO_UDPSOCKET
 #ifndef QT_NO_NETWORKINTERFACE
@@ -166,6 +168,9 @@ public:
     virtual qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader *header = 0,
                                 PacketHeaderOptions = WantNone) = 0;
     virtual qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &header) = 0;
+    virtual int readDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                              int maxlen, PacketHeaderOptions = WantNone);
+    virtual int writeDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count);
     virtual bool hasPendingDatagrams() const = 0;
     virtual qint64 pendingDatagramSize() const = 0;
 #endif // QT_NO_UDPSOCKET
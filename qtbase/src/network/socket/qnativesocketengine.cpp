@@ -841,6 +841,41 @@ qint64 QNativeSocketEngine::writeDatagram(const char *data, qint64 size, const Q
 
     return d->nativeSendDatagram(data, size, header);
 }
+
+/*!
+    Receives up to \a count datagrams of at most \a maxSize bytes each
+    into \a datagrams and returns the number received, 0 if none were
+    pending, or -1 if an error occurred. On Linux the whole batch is read
+    with a single recvmmsg() call.
+
+    \sa readDatagram(), writeDatagrams()
+*/
+int QNativeSocketEngine::readDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                                       int maxSize, PacketHeaderOptions options)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::readDatagrams(), -1);
+    Q_CHECK_TYPE(QNativeSocketEngine::readDatagrams(), QAbstractSocket::UdpSocket, -1);
+
+    return d->nativeReceiveDatagrams(datagrams, headers, count, maxSize, options);
+}
+
+/*!
+    Sends the \a count datagrams in \a datagrams to the destinations in
+    \a headers and returns the number sent, or -1 if an error occurred
+    before anything was sent. On Linux, datagrams that carry no ancillary
+    data are sent in batches with sendmmsg().
+
+    \sa writeDatagram(), readDatagrams()
+*/
+int QNativeSocketEngine::writeDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::writeDatagrams(), -1);
+    Q_CHECK_TYPE(QNativeSocketEngine::writeDatagrams(), QAbstractSocket::UdpSocket, -1);
+
+    return d->nativeSendDatagrams(datagrams, headers, count);
+}
 #endif // QT_NO_UDPSOCKET
 
 /*!
@@ -859,6 +894,22 @@ qint64 QNativeSocketEngine::write(const char *data, qint64 size)
     return d->nativeWrite(data, size);
 }
 
+/*!
+    Writes the \a count blocks in \a blocks, whose sizes are given in
+    \a sizes, with a single gathering system call. Returns the number of
+    bytes written, which may stop in the middle of a block, or -1 if an
+    error occurred.
+*/
+qint64 QNativeSocketEngine::writeBlocks(const char * const *blocks, const qint64 *sizes, int count)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::writeBlocks(), -1);
+    Q_CHECK_STATE(QNativeSocketEngine::writeBlocks(), QAbstractSocket::ConnectedState, -1);
+    if (count <= 0)
+        return 0;
+    return d->nativeWriteBlocks(blocks, sizes, count);
+}
+
 
 qint64 QNativeSocketEngine::bytesToWrite() const
 {
@@ -128,6 +128,7 @@ public:
 
     qint64 read(char *data, qint64 maxlen) Q_DECL_OVERRIDE;
     qint64 write(const char *data, qint64 len) Q_DECL_OVERRIDE;
+    qint64 writeBlocks(const char * const *blocks, const qint64 *sizes, int count) Q_DECL_OVERRIDE;
 
 #ifndef QT_NO_UDPSOCKET
 #ifndef QT_NO_NETWORKINTERFACE
@@ -142,6 +143,9 @@ public:
     qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader * = 0,
                         PacketHeaderOptions = WantNone) Q_DECL_OVERRIDE;
     qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &) Q_DECL_OVERRIDE;
+    int readDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                      int maxlen, PacketHeaderOptions = WantNone) Q_DECL_OVERRIDE;
+    int writeDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count) Q_DECL_OVERRIDE;
     bool hasPendingDatagrams() const Q_DECL_OVERRIDE;
     qint64 pendingDatagramSize() const Q_DECL_OVERRIDE;
 #endif // QT_NO_UDPSOCKET
@@ -257,8 +261,12 @@ public:
     qint64 nativeReceiveDatagram(char *data, qint64 maxLength, QIpPacketHeader *header,
                                  QAbstractSocketEngine::PacketHeaderOptions options);
     qint64 nativeSendDatagram(const char *data, qint64 length, const QIpPacketHeader &header);
+    int nativeReceiveDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                               int maxLength, QAbstractSocketEngine::PacketHeaderOptions options);
+    int nativeSendDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count);
     qint64 nativeRead(char *data, qint64 maxLength);
     qint64 nativeWrite(const char *data, qint64 length);
+    qint64 nativeWriteBlocks(const char * const *blocks, const qint64 *sizes, int count);
     int nativeSelect(int timeout, bool selectForRead) const;
     int nativeSelect(int timeout, bool checkRead, bool checkWrite,
                      bool *selectForRead, bool *selectForWrite) const;
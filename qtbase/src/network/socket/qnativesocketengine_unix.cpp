@@ -60,6 +60,11 @@
 
 #include <netinet/tcp.h>
 
+#if defined(Q_OS_LINUX) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14))
+// recvmmsg() and sendmmsg() move a whole batch of datagrams per system call
+#  define QT_HAVE_MMSG
+#endif
+
 QT_BEGIN_NAMESPACE
 
 #if defined QNATIVESOCKETENGINE_DEBUG
@@ -231,6 +236,11 @@ static void convertToLevelAndOption(QNativeSocketEngine::SocketOption opt,
 #endif
         }
         break;
+    case QNativeSocketEngine::ReusePortOption:
+#ifdef SO_REUSEPORT
+        n = SO_REUSEPORT;
+#endif
+        break;
     }
 }
 
@@ -379,6 +389,8 @@ bool QNativeSocketEnginePrivate::setOption(QNativeSocketEngine::SocketOption opt
             n = SO_REUSEPORT;
     }
 #endif
+    if (n == -1)
+        return false;
 
     return ::setsockopt(socketDescriptor, level, n, (char *) &v, sizeof(v)) == 0;
 }
@@ -826,15 +838,73 @@ qint64 QNativeSocketEnginePrivate::nativePendingDatagramSize() const
     return qint64(recvResult);
 }
 
+// the ancillary data we ask for when receiving datagrams
+enum {
+    DatagramControlBufferSize = (CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
+#if !defined(IP_PKTINFO) && defined(IP_RECVIF) && defined(Q_OS_BSD4)
+                                 + CMSG_SPACE(sizeof(sockaddr_dl))
+#endif
+                                 + sizeof(quintptr) - 1) / sizeof(quintptr)
+};
+
+/*
+    Fills the destination address, interface index and hop limit of
+    \a header from the ancillary data received in \a msg.
+*/
+static void qt_socket_parseDatagramControl(struct msghdr *msg, QIpPacketHeader *header)
+{
+    struct cmsghdr *cmsgptr;
+    for (cmsgptr = CMSG_FIRSTHDR(msg); cmsgptr != NULL;
+         cmsgptr = CMSG_NXTHDR(msg, cmsgptr)) {
+        if (cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in6_pktinfo))) {
+            in6_pktinfo *info = reinterpret_cast<in6_pktinfo *>(CMSG_DATA(cmsgptr));
+
+            header->destinationAddress.setAddress(reinterpret_cast<quint8 *>(&info->ipi6_addr));
+            header->ifindex = info->ipi6_ifindex;
+            if (header->ifindex)
+                header->destinationAddress.setScopeId(QString::number(info->ipi6_ifindex));
+        }
+
+#ifdef IP_PKTINFO
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_PKTINFO
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_pktinfo))) {
+            in_pktinfo *info = reinterpret_cast<in_pktinfo *>(CMSG_DATA(cmsgptr));
+
+            header->destinationAddress.setAddress(ntohl(info->ipi_addr.s_addr));
+            header->ifindex = info->ipi_ifindex;
+        }
+#else
+#  ifdef IP_RECVDSTADDR
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVDSTADDR
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_addr))) {
+            in_addr *addr = reinterpret_cast<in_addr *>(CMSG_DATA(cmsgptr));
+
+            header->destinationAddress.setAddress(ntohl(addr->s_addr));
+        }
+#  endif
+#  if defined(IP_RECVIF) && defined(Q_OS_BSD4)
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVIF
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sockaddr_dl))) {
+            sockaddr_dl *sdl = reinterpret_cast<sockaddr_dl *>(CMSG_DATA(cmsgptr));
+            header->ifindex = sdl->sdl_index;
+        }
+#  endif
+#endif
+
+        if (cmsgptr->cmsg_len == CMSG_LEN(sizeof(int))
+                && ((cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_HOPLIMIT)
+                    || (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_TTL))) {
+            header->hopLimit = *reinterpret_cast<int *>(CMSG_DATA(cmsgptr));
+        }
+    }
+}
+
 qint64 QNativeSocketEnginePrivate::nativeReceiveDatagram(char *data, qint64 maxSize, QIpPacketHeader *header,
                                                          QAbstractSocketEngine::PacketHeaderOptions options)
 {
     // we use quintptr to force the alignment
-    quintptr cbuf[(CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
-#if !defined(IP_PKTINFO) && defined(IP_RECVIF) && defined(Q_OS_BSD4)
-                   + CMSG_SPACE(sizeof(sockaddr_dl))
-#endif
-                   + sizeof(quintptr) - 1) / sizeof(quintptr)];
+    quintptr cbuf[DatagramControlBufferSize];
 
     struct msghdr msg;
     struct iovec vec;
@@ -871,52 +941,7 @@ qint64 QNativeSocketEnginePrivate::nativeReceiveDatagram(char *data, qint64 maxS
         qt_socket_getPortAndAddress(&aa, &header->senderPort, &header->senderAddress);
         header->destinationPort = localPort;
 
-        // parse the ancillary data
-        struct cmsghdr *cmsgptr;
-        for (cmsgptr = CMSG_FIRSTHDR(&msg); cmsgptr != NULL;
-             cmsgptr = CMSG_NXTHDR(&msg, cmsgptr)) {
-            if (cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in6_pktinfo))) {
-                in6_pktinfo *info = reinterpret_cast<in6_pktinfo *>(CMSG_DATA(cmsgptr));
-
-                header->destinationAddress.setAddress(reinterpret_cast<quint8 *>(&info->ipi6_addr));
-                header->ifindex = info->ipi6_ifindex;
-                if (header->ifindex)
-                    header->destinationAddress.setScopeId(QString::number(info->ipi6_ifindex));
-            }
-
-#ifdef IP_PKTINFO
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_PKTINFO
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_pktinfo))) {
-                in_pktinfo *info = reinterpret_cast<in_pktinfo *>(CMSG_DATA(cmsgptr));
-
-                header->destinationAddress.setAddress(ntohl(info->ipi_addr.s_addr));
-                header->ifindex = info->ipi_ifindex;
-            }
-#else
-#  ifdef IP_RECVDSTADDR
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVDSTADDR
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_addr))) {
-                in_addr *addr = reinterpret_cast<in_addr *>(CMSG_DATA(cmsgptr));
-
-                header->destinationAddress.setAddress(ntohl(addr->s_addr));
-            }
-#  endif
-#  if defined(IP_RECVIF) && defined(Q_OS_BSD4)
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVIF
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sockaddr_dl))) {
-                sockaddr_dl *sdl = reinterpret_cast<sockaddr_dl *>(CMSG_DATA(cmsgptr));
-                header->ifindex = sdl->sdl_index;
-            }
-#  endif
-#endif
-
-            if (cmsgptr->cmsg_len == CMSG_LEN(sizeof(int))
-                    && ((cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_HOPLIMIT)
-                        || (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_TTL))) {
-                header->hopLimit = *reinterpret_cast<int *>(CMSG_DATA(cmsgptr));
-            }
-        }
+        qt_socket_parseDatagramControl(&msg, header);
     }
 
 #if defined (QNATIVESOCKETENGINE_DEBUG)
@@ -1029,6 +1054,157 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
     return qint64(sentBytes);
 }
 
+int QNativeSocketEnginePrivate::nativeReceiveDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                                                       int maxSize, QAbstractSocketEngine::PacketHeaderOptions options)
+{
+#ifdef QT_HAVE_MMSG
+    enum { MaxBatchSize = 64 };
+    // we use quintptr to force the alignment
+    quintptr cbuf[MaxBatchSize][DatagramControlBufferSize];
+    struct mmsghdr msgs[MaxBatchSize];
+    struct iovec vecs[MaxBatchSize];
+    qt_sockaddr addrs[MaxBatchSize];
+
+    const int batchSize = qMin<int>(count, MaxBatchSize);
+    const bool wantControl = options & (QAbstractSocketEngine::WantDatagramHopLimit
+                                        | QAbstractSocketEngine::WantDatagramDestination);
+    memset(msgs, 0, batchSize * sizeof(mmsghdr));
+    for (int i = 0; i < batchSize; ++i) {
+        // reuse the capacity the caller's buffers already have
+        datagrams[i].resize(maxSize);
+        vecs[i].iov_base = datagrams[i].data();
+        vecs[i].iov_len = maxSize;
+        msgs[i].msg_hdr.msg_iov = &vecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (options & QAbstractSocketEngine::WantDatagramSender) {
+            memset(&addrs[i], 0, sizeof(qt_sockaddr));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(qt_sockaddr);
+        }
+        if (wantControl) {
+            msgs[i].msg_hdr.msg_control = cbuf[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(cbuf[i]);
+        }
+    }
+
+    int received;
+    do {
+        received = ::recvmmsg(socketDescriptor, msgs, batchSize, MSG_DONTWAIT, 0);
+    } while (received == -1 && errno == EINTR);
+
+    if (received == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        setError(QAbstractSocket::NetworkError, ReceiveDatagramErrorString);
+        return -1;
+    }
+
+    for (int i = 0; i < received; ++i) {
+        datagrams[i].resize(int(msgs[i].msg_len));
+        if (options != QAbstractSocketEngine::WantNone) {
+            Q_ASSERT(headers);
+            QIpPacketHeader *header = &headers[i];
+            header->clear();
+            qt_socket_getPortAndAddress(&addrs[i], &header->senderPort, &header->senderAddress);
+            header->destinationPort = localPort;
+            qt_socket_parseDatagramControl(&msgs[i].msg_hdr, header);
+        }
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeReceiveDatagrams(%d, %d) == %d", count, maxSize, received);
+#endif
+
+    return received;
+#else
+    int received = 0;
+    while (received < count && nativeHasPendingDatagrams()) {
+        QByteArray &datagram = datagrams[received];
+        datagram.resize(maxSize);
+        const qint64 size = nativeReceiveDatagram(datagram.data(), maxSize,
+                                                  headers ? &headers[received] : 0, options);
+        if (size < 0)
+            return received ? received : -1;
+        datagram.resize(int(size));
+        ++received;
+    }
+    return received;
+#endif
+}
+
+int QNativeSocketEnginePrivate::nativeSendDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count)
+{
+#ifdef QT_HAVE_MMSG
+    enum { MaxBatchSize = 64 };
+    struct mmsghdr msgs[MaxBatchSize];
+    struct iovec vecs[MaxBatchSize];
+    qt_sockaddr addrs[MaxBatchSize];
+
+    int sent = 0;
+    while (sent < count) {
+        // datagrams that carry ancillary data go through sendmsg() one by one
+        const QIpPacketHeader &first = headers[sent];
+        if (first.hopLimit != -1 || first.ifindex != 0 || !first.senderAddress.isNull()) {
+            if (nativeSendDatagram(datagrams[sent].constData(), datagrams[sent].size(), first) < 0)
+                return sent ? sent : -1;
+            ++sent;
+            continue;
+        }
+
+        int batchSize = 0;
+        memset(msgs, 0, sizeof(msgs));
+        while (batchSize < MaxBatchSize && sent + batchSize < count) {
+            const QByteArray &datagram = datagrams[sent + batchSize];
+            const QIpPacketHeader &header = headers[sent + batchSize];
+            if (header.hopLimit != -1 || header.ifindex != 0 || !header.senderAddress.isNull())
+                break;
+            vecs[batchSize].iov_base = const_cast<char *>(datagram.constData());
+            vecs[batchSize].iov_len = datagram.size();
+            msgs[batchSize].msg_hdr.msg_iov = &vecs[batchSize];
+            msgs[batchSize].msg_hdr.msg_iovlen = 1;
+            msgs[batchSize].msg_hdr.msg_name = &addrs[batchSize].a;
+            setPortAndAddress(header.destinationPort, header.destinationAddress,
+                              &addrs[batchSize], &msgs[batchSize].msg_hdr.msg_namelen);
+            ++batchSize;
+        }
+
+        int result;
+        do {
+            result = ::sendmmsg(socketDescriptor, msgs, batchSize, MSG_NOSIGNAL);
+        } while (result == -1 && errno == EINTR);
+
+        if (result == -1) {
+            switch (errno) {
+            case EAGAIN:
+                return sent;
+            case EMSGSIZE:
+                setError(QAbstractSocket::DatagramTooLargeError, DatagramTooLargeErrorString);
+                break;
+            default:
+                setError(QAbstractSocket::NetworkError, SendDatagramErrorString);
+            }
+            return sent ? sent : -1;
+        }
+
+        sent += result;
+        if (result < batchSize)
+            break;
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeSendDatagrams(%d) == %d", count, sent);
+#endif
+
+    return sent;
+#else
+    for (int i = 0; i < count; ++i) {
+        if (nativeSendDatagram(datagrams[i].constData(), datagrams[i].size(), headers[i]) < 0)
+            return i ? i : -1;
+    }
+    return count;
+#endif
+}
+
 bool QNativeSocketEnginePrivate::fetchConnectionParameters()
 {
     localPort = 0;
@@ -1160,6 +1336,56 @@ qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
 
     return qint64(writtenBytes);
 }
+
+qint64 QNativeSocketEnginePrivate::nativeWriteBlocks(const char * const *blocks, const qint64 *sizes, int count)
+{
+    Q_Q(QNativeSocketEngine);
+
+    enum { MaxBlocks = 64 };
+    struct iovec vecs[MaxBlocks];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+
+    count = qMin<int>(count, MaxBlocks);
+    qint64 totalSize = 0;
+    for (int i = 0; i < count; ++i) {
+        vecs[i].iov_base = const_cast<char *>(blocks[i]);
+        vecs[i].iov_len = sizes[i];
+        totalSize += sizes[i];
+    }
+    msg.msg_iov = vecs;
+    msg.msg_iovlen = count;
+
+    // sendmsg() gathers all blocks in one system call and, unlike writev(),
+    // lets us suppress SIGPIPE
+    ssize_t writtenBytes = qt_safe_sendmsg(socketDescriptor, &msg, 0);
+
+    if (writtenBytes < 0) {
+        switch (errno) {
+        case EPIPE:
+        case ECONNRESET:
+            writtenBytes = -1;
+            setError(QAbstractSocket::RemoteHostClosedError, RemoteHostClosedErrorString);
+            q->close();
+            break;
+        case EAGAIN:
+            writtenBytes = 0;
+            break;
+        default:
+            setError(QAbstractSocket::NetworkError, WriteErrorString);
+            break;
+        }
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeWriteBlocks(%d blocks, %lli) == %i",
+           count, totalSize, (int) writtenBytes);
+#else
+    Q_UNUSED(totalSize);
+#endif
+
+    return qint64(writtenBytes);
+}
 /*
 */
 qint64 QNativeSocketEnginePrivate::nativeRead(char *data, qint64 maxSize)
@@ -208,6 +208,7 @@ static void convertToLevelAndOption(QNativeSocketEngine::SocketOption opt,
     switch (opt) {
     case QNativeSocketEngine::NonBlockingSocketOption:      // WSAIoctl
     case QNativeSocketEngine::TypeOfServiceOption:          // not supported
+    case QNativeSocketEngine::ReusePortOption:              // not supported
         Q_UNREACHABLE();
 
     case QNativeSocketEngine::ReceiveBufferSocketOption:
@@ -453,6 +454,7 @@ int QNativeSocketEnginePrivate::option(QNativeSocketEngine::SocketOption opt) co
         break;
     }
     case QNativeSocketEngine::TypeOfServiceOption:
+    case QNativeSocketEngine::ReusePortOption:
         return -1;
 
     default:
@@ -503,6 +505,7 @@ bool QNativeSocketEnginePrivate::setOption(QNativeSocketEngine::SocketOption opt
         break;
         }
     case QNativeSocketEngine::TypeOfServiceOption:
+    case QNativeSocketEngine::ReusePortOption:
         return false;
 
     default:
@@ -1421,6 +1424,32 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
     return ret;
 }
 
+int QNativeSocketEnginePrivate::nativeReceiveDatagrams(QByteArray *datagrams, QIpPacketHeader *headers, int count,
+                                                       int maxLength, QAbstractSocketEngine::PacketHeaderOptions options)
+{
+    int received = 0;
+    while (received < count && nativeHasPendingDatagrams()) {
+        QByteArray &datagram = datagrams[received];
+        datagram.resize(maxLength);
+        const qint64 size = nativeReceiveDatagram(datagram.data(), maxLength,
+                                                  headers ? &headers[received] : 0, options);
+        if (size < 0)
+            return received ? received : -1;
+        datagram.resize(int(size));
+        ++received;
+    }
+    return received;
+}
+
+int QNativeSocketEnginePrivate::nativeSendDatagrams(const QByteArray *datagrams, const QIpPacketHeader *headers, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (nativeSendDatagram(datagrams[i].constData(), datagrams[i].size(), headers[i]) < 0)
+            return i ? i : -1;
+    }
+    return count;
+}
+
 
 qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
 {
@@ -1480,6 +1509,51 @@ qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
     return ret;
 }
 
+qint64 QNativeSocketEnginePrivate::nativeWriteBlocks(const char * const *blocks, const qint64 *sizes, int count)
+{
+    Q_Q(QNativeSocketEngine);
+
+    enum { MaxBlocks = 64 };
+    WSABUF bufs[MaxBlocks];
+    count = qMin<int>(count, MaxBlocks);
+    for (int i = 0; i < count; ++i) {
+        bufs[i].buf = const_cast<char *>(blocks[i]);
+        bufs[i].len = ULONG(sizes[i]);
+    }
+
+    // WSASend() gathers all blocks in one call
+    DWORD bytesWritten = 0;
+    qint64 ret = 0;
+    if (::WSASend(socketDescriptor, bufs, count, &bytesWritten, 0, 0, 0) != SOCKET_ERROR) {
+        ret = qint64(bytesWritten);
+    } else {
+        int err = WSAGetLastError();
+        switch (err) {
+        case WSAEWOULDBLOCK:
+            break;
+        case WSAENOBUFS:
+            // fall back to the single block path, which copes with this
+            return nativeWrite(blocks[0], sizes[0]);
+        case WSAECONNRESET:
+        case WSAECONNABORTED:
+            WS_ERROR_DEBUG(err);
+            ret = -1;
+            setError(QAbstractSocket::NetworkError, WriteErrorString);
+            q->close();
+            break;
+        default:
+            WS_ERROR_DEBUG(err);
+            break;
+        }
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeWriteBlocks(%d blocks) == %lld", count, qint64(ret));
+#endif
+
+    return ret;
+}
+
 qint64 QNativeSocketEnginePrivate::nativeRead(char *data, qint64 maxLength)
 {
     qint64 ret = -1;
@@ -76,6 +76,10 @@
     options. Use setMulticastInterface() to control the outgoing interface for
     multicast datagrams, and multicastInterface() to query it.
 
+    Applications that handle many small datagrams can move them in
+    batches with readDatagrams() and writeDatagrams(), which need far
+    fewer system calls per datagram on platforms that support it.
+
     With QUdpSocket, you can also establish a virtual connection to a
     UDP server using connectToHost() and then use read() and write()
     to exchange datagrams without specifying the receiver for each
@@ -94,11 +98,15 @@
 #include "qhostaddress.h"
 #include "qnetworkinterface.h"
 #include "qabstractsocket_p.h"
+#include "qvarlengtharray.h"
 
 QT_BEGIN_NAMESPACE
 
 #ifndef QT_NO_UDPSOCKET
 
+// the largest datagram readDatagrams() receives
+static const int MaxBatchDatagramSize = 65535;
+
 #define QT_CHECK_BOUND(function, a) do { \
     if (!isValid()) { \
         qWarning(function" called on a QUdpSocket when not in QUdpSocket::BoundState"); \
@@ -117,6 +125,9 @@ public:
 
     inline bool ensureInitialized(const QHostAddress &remoteAddress)
     { return doEnsureInitialized(QHostAddress(), 0, remoteAddress); }
+
+    // kept between batch calls, so that their addresses are not reallocated
+    QVector<QIpPacketHeader> batchHeaders;
 };
 
 bool QUdpSocketPrivate::doEnsureInitialized(const QHostAddress &bindAddress, quint16 bindPort,
@@ -396,6 +407,139 @@ qint64 QUdpSocket::readDatagram(char *data, qint64 maxSize, QHostAddress *addres
         d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
     return readBytes;
 }
+
+/*!
+    \class QUdpSocket::Datagram
+    \inmodule QtNetwork
+    \since 5.6
+
+    \brief The Datagram class holds one datagram for readDatagrams() and
+    writeDatagrams().
+
+    The \c data member holds the payload, while \c address and \c port
+    hold the sender of a received datagram or the destination of one to
+    be sent.
+*/
+
+/*!
+    \since 5.6
+
+    Receives up to \a maxCount pending datagrams of at most \a maxSize
+    bytes each and stores them, together with their senders, in the first
+    entries of \a datagrams. Returns the number of datagrams received,
+    which is 0 if none were pending, or -1 if an error occurred.
+
+    \a datagrams is grown to at least \a maxCount entries but never shrunk,
+    so passing the same vector on every call reuses its buffers instead of
+    allocating new ones. Only the entries before the returned count are
+    valid. As with readDatagram(), the rest of a datagram larger than
+    \a maxSize is lost. \a maxSize is limited to 65535 bytes, the largest
+    datagram UDP can carry without IPv6 jumbograms.
+
+    On Linux, each call reads up to 64 datagrams with a single system call.
+
+    \sa writeDatagrams(), readDatagram()
+*/
+int QUdpSocket::readDatagrams(QVector<Datagram> &datagrams, int maxCount, qint64 maxSize)
+{
+    Q_D(QUdpSocket);
+
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::readDatagrams(%d, %lld)", maxCount, maxSize);
+#endif
+    QT_CHECK_BOUND("QUdpSocket::readDatagrams()", -1);
+
+    if (maxSize < 0) {
+        qWarning("QUdpSocket::readDatagrams: Called with negative maxSize");
+        return -1;
+    }
+    if (maxCount <= 0)
+        return 0;
+    if (datagrams.size() < maxCount)
+        datagrams.resize(maxCount);
+    if (d->batchHeaders.size() < maxCount)
+        d->batchHeaders.resize(maxCount);
+
+    // hand the existing buffers to the engine without copying them
+    QVarLengthArray<QByteArray, 64> buffers(maxCount);
+    Datagram *out = datagrams.data();
+    for (int i = 0; i < maxCount; ++i)
+        buffers[i].swap(out[i].data);
+
+    const int bufferSize = int(qMin(maxSize, qint64(MaxBatchDatagramSize)));
+    const int received = d->socketEngine->readDatagrams(buffers.data(), d->batchHeaders.data(), maxCount,
+                                                        bufferSize, QAbstractSocketEngine::WantDatagramSender);
+
+    for (int i = 0; i < maxCount; ++i) {
+        out[i].data.swap(buffers[i]);
+        if (i < received) {
+            const QIpPacketHeader &header = d->batchHeaders.at(i);
+            out[i].address = header.senderAddress;
+            out[i].port = header.senderPort;
+        }
+    }
+
+    d->socketEngine->setReadNotificationEnabled(true);
+    if (received < 0)
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+    return received;
+}
+
+/*!
+    \since 5.6
+
+    Sends each entry of \a datagrams to its address and port. Returns the
+    number of datagrams sent, which can be smaller than the size of
+    \a datagrams if the socket's send buffer filled up, or -1 if an error
+    occurred before anything was sent. bytesWritten() is emitted once for
+    the whole batch.
+
+    On Linux, the datagrams are sent with as few system calls as possible.
+    The same restrictions as for writeDatagram() apply to each datagram.
+
+    \sa readDatagrams(), writeDatagram()
+*/
+int QUdpSocket::writeDatagrams(const QVector<Datagram> &datagrams)
+{
+    Q_D(QUdpSocket);
+
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::writeDatagrams(%d)", datagrams.size());
+#endif
+    if (datagrams.isEmpty())
+        return 0;
+    if (!d->doEnsureInitialized(QHostAddress::Any, 0, datagrams.first().address))
+        return -1;
+    if (state() == UnconnectedState)
+        bind();
+
+    const int count = datagrams.size();
+    if (d->batchHeaders.size() < count)
+        d->batchHeaders.resize(count);
+    QVarLengthArray<QByteArray, 64> buffers(count);
+    for (int i = 0; i < count; ++i) {
+        const Datagram &datagram = datagrams.at(i);
+        buffers[i] = datagram.data;
+        QIpPacketHeader &header = d->batchHeaders[i];
+        header.clear();
+        header.destinationAddress = datagram.address;
+        header.destinationPort = datagram.port;
+    }
+
+    const int sent = d->socketEngine->writeDatagrams(buffers.constData(), d->batchHeaders.constData(), count);
+    d->cachedSocketDescriptor = d->socketEngine->socketDescriptor();
+
+    if (sent >= 0) {
+        qint64 bytes = 0;
+        for (int i = 0; i < sent; ++i)
+            bytes += datagrams.at(i).data.size();
+        if (bytes)
+            emit bytesWritten(bytes);
+    } else {
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+    }
+    return sent;
+}
 #endif // QT_NO_UDPSOCKET
 
 QT_END_NAMESPACE
@@ -36,6 +36,7 @@
 
 #include <QtNetwork/qabstractsocket.h>
 #include <QtNetwork/qhostaddress.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -49,6 +50,17 @@ class Q_NETWORK_EXPORT QUdpSocket : public QAbstractSocket
 {
     Q_OBJECT
 public:
+    struct Datagram
+    {
+        Datagram() : port(0) {}
+        Datagram(const QByteArray &payload, const QHostAddress &host, quint16 hostPort)
+            : data(payload), address(host), port(hostPort) {}
+
+        QByteArray data;
+        QHostAddress address;
+        quint16 port;
+    };
+
     explicit QUdpSocket(QObject *parent = Q_NULLPTR);
     virtual ~QUdpSocket();
 
@@ -71,11 +83,16 @@ public:
     inline qint64 writeDatagram(const QByteArray &datagram, const QHostAddress &host, quint16 port)
         { return writeDatagram(datagram.constData(), datagram.size(), host, port); }
 
+    int readDatagrams(QVector<Datagram> &datagrams, int maxCount, qint64 maxSize);
+    int writeDatagrams(const QVector<Datagram> &datagrams);
+
 private:
     Q_DISABLE_COPY(QUdpSocket)
     Q_DECLARE_PRIVATE(QUdpSocket)
 };
 
+Q_DECLARE_TYPEINFO(QUdpSocket::Datagram, Q_MOVABLE_TYPE);
+
 #endif // QT_NO_UDPSOCKET
 
 QT_END_NAMESPACE
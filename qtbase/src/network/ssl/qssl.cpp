@@ -161,7 +161,11 @@ Q_LOGGING_CATEGORY(lcSsl, "qt.network.ssl");
     option can allow connections for legacy servers, but it introduces the
     possibility that an attacker could inject plaintext into the SSL session.
     \value SslOptionDisableSessionSharing Disables SSL session sharing via
-    the session ID handshake attribute.
+    the session ID handshake attribute. This also keeps client sockets out of
+    the process-wide session cache, which otherwise lets a socket resume a
+    session negotiated by another socket connecting to the same host and
+    port with an equivalent configuration, and stops server sockets from
+    accepting session tickets issued by other server sockets.
     \value SslOptionDisableSessionPersistence Disables storing the SSL session
     in ASN.1 format as returned by QSslConfiguration::sessionTicket(). Enabling
     this feature adds memory overhead of approximately 1K per used session
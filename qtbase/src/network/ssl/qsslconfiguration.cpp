@@ -38,6 +38,8 @@
 #include "qsslsocket.h"
 #include "qsslsocket_p.h"
 #include "qmutex.h"
+#include "qcryptographichash.h"
+#include "qendian.h"
 #include "qdebug.h"
 
 QT_BEGIN_NAMESPACE
@@ -49,6 +51,7 @@ const QSsl::SslOptions QSslConfigurationPrivate::defaultSslOptions = QSsl::SslOp
 
 const char QSslConfiguration::NextProtocolSpdy3_0[] = "spdy/3";
 const char QSslConfiguration::NextProtocolHttp1_1[] = "http/1.1";
+const char QSslConfiguration::NextProtocolHttp2[] = "h2";
 
 /*!
     \class QSslConfiguration
@@ -137,6 +140,16 @@ const char QSslConfiguration::NextProtocolHttp1_1[] = "http/1.1";
     Protocol Negotiation.
 */
 
+/*!
+    \variable QSslConfiguration::NextProtocolHttp2
+    \brief The value used for negotiating HTTP/2 during the Application-Layer
+    Protocol Negotiation.
+    \since 5.6
+
+    HTTP/2 can only be negotiated through ALPN, which requires OpenSSL 1.0.2
+    or later.
+*/
+
 /*!
     Constructs an empty SSL configuration. This configuration contains
     no valid settings and the state will be empty. isNull() will
@@ -817,7 +830,7 @@ QByteArray QSslConfiguration::nextNegotiatedProtocol() const
   Whether or not the negotiation succeeded can be queried through
   nextProtocolNegotiationStatus().
 
-  \sa nextNegotiatedProtocol(), nextProtocolNegotiationStatus(), allowedNextProtocols(), QSslConfiguration::NextProtocolSpdy3_0, QSslConfiguration::NextProtocolHttp1_1
+  \sa nextNegotiatedProtocol(), nextProtocolNegotiationStatus(), allowedNextProtocols(), QSslConfiguration::NextProtocolSpdy3_0, QSslConfiguration::NextProtocolHttp1_1, QSslConfiguration::NextProtocolHttp2
  */
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
 void QSslConfiguration::setAllowedNextProtocols(const QList<QByteArray> &protocols)
@@ -835,7 +848,7 @@ void QSslConfiguration::setAllowedNextProtocols(QList<QByteArray> protocols)
   server through the Next Protocol Negotiation (NPN) TLS extension, as set
   by setAllowedNextProtocols().
 
-  \sa nextNegotiatedProtocol(), nextProtocolNegotiationStatus(), setAllowedNextProtocols(), QSslConfiguration::NextProtocolSpdy3_0, QSslConfiguration::NextProtocolHttp1_1
+  \sa nextNegotiatedProtocol(), nextProtocolNegotiationStatus(), setAllowedNextProtocols(), QSslConfiguration::NextProtocolSpdy3_0, QSslConfiguration::NextProtocolHttp1_1, QSslConfiguration::NextProtocolHttp2
  */
 QList<QByteArray> QSslConfiguration::allowedNextProtocols() const
 {
@@ -896,4 +909,52 @@ bool QSslConfigurationPrivate::peerSessionWasShared(const QSslConfiguration &con
         return configuration.d->peerSessionShared;
     }
 
+static void addField(QCryptographicHash *hash, const QByteArray &field)
+{
+    // length-prefixed, so no two different configurations feed the same bytes
+    uchar size[4];
+    qToBigEndian<quint32>(quint32(field.size()), size);
+    hash->addData(reinterpret_cast<const char *>(size), sizeof(size));
+    hash->addData(field);
+}
+
+/*! \internal
+
+  Returns a SHA-256 digest of the parts of \a configuration that decide
+  which certificates are presented and accepted during a handshake. Equal
+  digests mean that a session or connection negotiated with one
+  configuration can be reused with the other.
+*/
+QByteArray QSslConfigurationPrivate::digest(const QSslConfigurationPrivate &configuration)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    addField(&hash, QByteArray::number(int(configuration.protocol)));
+    addField(&hash, QByteArray::number(int(configuration.peerVerifyMode)));
+    addField(&hash, QByteArray::number(configuration.peerVerifyDepth));
+    // the session bits only control how sessions are kept, not what they hold
+    addField(&hash, QByteArray::number(int(configuration.sslOptions
+                                           & ~(QSsl::SslOptionDisableSessionSharing
+                                               | QSsl::SslOptionDisableSessionPersistence))));
+    addField(&hash, QByteArray::number(configuration.localCertificateChain.size()));
+    foreach (const QSslCertificate &certificate, configuration.localCertificateChain)
+        addField(&hash, certificate.toDer());
+    addField(&hash, QByteArray::number(configuration.ciphers.size()));
+    foreach (const QSslCipher &cipher, configuration.ciphers)
+        addField(&hash, cipher.name().toLatin1());
+    addField(&hash, QByteArray::number(configuration.caCertificates.size()));
+    foreach (const QSslCertificate &certificate, configuration.caCertificates)
+        addField(&hash, certificate.toDer());
+    addField(&hash, QByteArray::number(configuration.nextAllowedProtocols.size()));
+    foreach (const QByteArray &protocol, configuration.nextAllowedProtocols)
+        addField(&hash, protocol);
+    return hash.result();
+}
+
+/*! \internal
+*/
+QByteArray QSslConfigurationPrivate::digest(const QSslConfiguration &configuration)
+{
+    return digest(*configuration.d);
+}
+
 QT_END_NAMESPACE
@@ -104,6 +104,9 @@ public:
 
     Q_AUTOTEST_EXPORT static bool peerSessionWasShared(const QSslConfiguration &configuration);
 
+    static QByteArray digest(const QSslConfigurationPrivate &configuration);
+    static QByteArray digest(const QSslConfiguration &configuration);
+
     QSsl::SslOptions sslOptions;
 
     Q_AUTOTEST_EXPORT static const QSsl::SslOptions defaultSslOptions;
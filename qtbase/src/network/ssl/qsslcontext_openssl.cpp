@@ -39,6 +39,7 @@
 
 #include "private/qssl_p.h"
 #include "private/qsslcontext_openssl_p.h"
+#include "private/qsslsessioncache_openssl_p.h"
 #include "private/qsslsocket_p.h"
 #include "private/qsslsocket_openssl_p.h"
 #include "private/qsslsocket_openssl_symbols_p.h"
@@ -313,6 +314,10 @@ init_context:
     if (sslContext->sslConfiguration.peerVerifyDepth() != 0)
         q_SSL_CTX_set_verify_depth(sslContext->ctx, sslContext->sslConfiguration.peerVerifyDepth());
 
+    // Share session tickets with the other server sockets of this process
+    if (!client && !sslContext->sslConfiguration.testSslOption(QSsl::SslOptionDisableSessionSharing))
+        QSslSessionCache::setupServerContext(sslContext->ctx, *configuration.d);
+
     // set persisted session if the user set it
     if (!configuration.sessionTicket().isEmpty())
         sslContext->setSessionASN1(configuration.sessionTicket());
@@ -445,6 +450,24 @@ SSL* QSslContext::createSsl()
     }
 #endif // OPENSSL_VERSION_NUMBER >= 0x1000100fL ...
 
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+    // Offer the same protocols via ALPN; HTTP/2 over TLS is only negotiated
+    // that way, and servers supporting both extensions prefer ALPN.
+    const QList<QByteArray> alpnProtocols = sslConfiguration.d->nextAllowedProtocols;
+    if (!alpnProtocols.isEmpty()) {
+        QByteArray alpnWireFormat;
+        for (int a = 0; a < alpnProtocols.count(); ++a) {
+            const QByteArray protocol = alpnProtocols.at(a).left(255);
+            alpnWireFormat.append(char(protocol.size())).append(protocol);
+        }
+        // the protocol list is copied by OpenSSL
+        if (q_SSL_set_alpn_protos(ssl, reinterpret_cast<const unsigned char *>(alpnWireFormat.constData()),
+                                  alpnWireFormat.size()) != 0) {
+            qCWarning(lcSsl, "could not set the TLS ALPN protocol list");
+        }
+    }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+
     return ssl;
 }
 
@@ -0,0 +1,218 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "private/qsslsessioncache_openssl_p.h"
+#include "private/qsslsocket_openssl_symbols_p.h"
+
+#include <QtCore/qdatetime.h>
+
+QT_BEGIN_NAMESPACE
+
+// OpenSSL's own default for SSL_CTX_set_timeout, used when the server
+// did not send a ticket lifetime hint
+static const int defaultSessionLifeTime = 300;
+static const int defaultMaximumSize = 1024;
+
+Q_GLOBAL_STATIC(QSslSessionCache, globalSessionCache)
+
+QSslSessionCache::Entry::~Entry()
+{
+    q_SSL_SESSION_free(session);
+}
+
+QSslSessionCache::QSslSessionCache()
+    : sessions(defaultMaximumSize)
+{
+}
+
+/*
+  Returns the key under which the session for a connection to \a peerName
+  on \a port using \a configuration is cached. \a peerName should be the
+  name the peer certificate is verified against.
+*/
+QByteArray QSslSessionCache::cacheKey(const QString &peerName, quint16 port,
+                                      const QSslConfigurationPrivate &configuration)
+{
+    QByteArray key = peerName.toLower().toUtf8();
+    key += ':';
+    key += QByteArray::number(port);
+    key += '/';
+    key += QSslConfigurationPrivate::digest(configuration).toHex();
+    return key;
+}
+
+/*
+  Lets the server context \a ctx resume sessions negotiated by any other
+  server socket in this process using an equivalent \a configuration. Every
+  server socket normally has a context of its own, so the session id cache
+  of OpenSSL never sees a returning client; session tickets encrypted with
+  process-wide keys can be decrypted by all of them.
+*/
+void QSslSessionCache::setupServerContext(SSL_CTX *ctx, const QSslConfigurationPrivate &configuration)
+{
+    QSslSessionCache *cache = globalSessionCache();
+    if (!cache)
+        return;
+
+    // a SHA-256 digest is exactly SSL_MAX_SID_CTX_LENGTH bytes long
+    const QByteArray sessionIdContext = QSslConfigurationPrivate::digest(configuration);
+    q_SSL_CTX_set_session_id_context(ctx, reinterpret_cast<const unsigned char *>(sessionIdContext.constData()),
+                                     sessionIdContext.size());
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEYS
+    QMutexLocker locker(&cache->mutex);
+    if (cache->ticketKeys.isEmpty()) {
+        // name, HMAC secret and AES key, 16 bytes each
+        QByteArray keys(48, Qt::Uninitialized);
+        if (q_RAND_bytes(reinterpret_cast<unsigned char *>(keys.data()), keys.size()) != 1)
+            return;
+        cache->ticketKeys = keys;
+    }
+    q_SSL_CTX_ctrl(ctx, SSL_CTRL_SET_TLSEXT_TICKET_KEYS, cache->ticketKeys.size(), cache->ticketKeys.data());
+#endif
+}
+
+bool QSslSessionCache::resume(const QByteArray &key, SSL *ssl)
+{
+    QSslSessionCache *cache = globalSessionCache();
+    if (!cache)
+        return false;
+
+    QMutexLocker locker(&cache->mutex);
+    ++cache->stats.lookups;
+    Entry *entry = cache->sessions.object(key);
+    if (!entry)
+        return false;
+    if (entry->expiry <= QDateTime::currentMSecsSinceEpoch()) {
+        cache->sessions.remove(key);
+        return false;
+    }
+    // SSL_set_session takes its own reference, so the entry may go away
+    // as soon as the lock is released
+    if (!q_SSL_set_session(ssl, entry->session)) {
+        cache->sessions.remove(key);
+        return false;
+    }
+    ++cache->stats.hits;
+    return true;
+}
+
+void QSslSessionCache::store(const QByteArray &key, SSL *ssl)
+{
+    QSslSessionCache *cache = globalSessionCache();
+    if (!cache)
+        return;
+
+    SSL_SESSION *session = q_SSL_get1_session(ssl);
+    if (!session)
+        return;
+
+    int lifeTime = int(session->tlsext_tick_lifetime_hint);
+    if (lifeTime <= 0)
+        lifeTime = defaultSessionLifeTime;
+    const qint64 expiry = QDateTime::currentMSecsSinceEpoch() + qint64(lifeTime) * 1000;
+
+    QMutexLocker locker(&cache->mutex);
+    Entry *entry = cache->sessions.object(key);
+    if (entry && entry->session == session) {
+        // a resumed session: keep it, the server may have extended its life
+        entry->expiry = expiry;
+        q_SSL_SESSION_free(session);
+        return;
+    }
+    cache->sessions.insert(key, new Entry(session, expiry));
+}
+
+void QSslSessionCache::remove(const QByteArray &key)
+{
+    if (QSslSessionCache *cache = globalSessionCache()) {
+        QMutexLocker locker(&cache->mutex);
+        cache->sessions.remove(key);
+    }
+}
+
+void QSslSessionCache::recordHandshake(bool resumed)
+{
+    if (QSslSessionCache *cache = globalSessionCache()) {
+        QMutexLocker locker(&cache->mutex);
+        if (resumed)
+            ++cache->stats.resumedHandshakes;
+        else
+            ++cache->stats.fullHandshakes;
+    }
+}
+
+void QSslSessionCache::clear()
+{
+    if (QSslSessionCache *cache = globalSessionCache()) {
+        QMutexLocker locker(&cache->mutex);
+        cache->sessions.clear();
+    }
+}
+
+int QSslSessionCache::maximumSize()
+{
+    QSslSessionCache *cache = globalSessionCache();
+    if (!cache)
+        return 0;
+    QMutexLocker locker(&cache->mutex);
+    return cache->sessions.maxCost();
+}
+
+void QSslSessionCache::setMaximumSize(int size)
+{
+    if (QSslSessionCache *cache = globalSessionCache()) {
+        QMutexLocker locker(&cache->mutex);
+        cache->sessions.setMaxCost(qMax(0, size));
+    }
+}
+
+QSslSessionCache::Statistics QSslSessionCache::statistics()
+{
+    QSslSessionCache *cache = globalSessionCache();
+    if (!cache)
+        return Statistics();
+    QMutexLocker locker(&cache->mutex);
+    return cache->stats;
+}
+
+void QSslSessionCache::resetStatistics()
+{
+    if (QSslSessionCache *cache = globalSessionCache()) {
+        QMutexLocker locker(&cache->mutex);
+        cache->stats = Statistics();
+    }
+}
+
+QT_END_NAMESPACE
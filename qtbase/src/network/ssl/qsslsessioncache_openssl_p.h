@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSSLSESSIONCACHE_OPENSSL_P_H
+#define QSSLSESSIONCACHE_OPENSSL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/qsslconfiguration.h>
+#include <QtNetwork/private/qsslconfiguration_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qmutex.h>
+#include <openssl/ssl.h>
+
+QT_BEGIN_NAMESPACE
+
+#ifndef QT_NO_SSL
+
+/*
+  Process-wide cache of client TLS sessions, shared by all QSslSockets
+  regardless of the QSslContext they were created with. Sessions are keyed
+  by the peer (host name and port) and by a SHA-256 digest of the parts of the
+  configuration that affect what the server presents and what we accept, so
+  a session is only ever resumed by a socket that would have verified the
+  original handshake the same way.
+
+  The least recently used sessions are dropped once the cache holds
+  maximumSize() entries; expired sessions are dropped on lookup.
+
+  On the server side it hands out the session ticket keys shared by all
+  server contexts of the process.
+*/
+class Q_NETWORK_EXPORT QSslSessionCache
+{
+public:
+    struct Statistics {
+        Statistics() : lookups(0), hits(0), fullHandshakes(0), resumedHandshakes(0) {}
+        qint64 lookups;
+        qint64 hits;
+        qint64 fullHandshakes;
+        qint64 resumedHandshakes;
+    };
+
+    static QByteArray cacheKey(const QString &peerName, quint16 port,
+                               const QSslConfigurationPrivate &configuration);
+
+    static void setupServerContext(SSL_CTX *ctx, const QSslConfigurationPrivate &configuration);
+
+    // Sets the cached session for \a key on \a ssl; returns false if there is none.
+    static bool resume(const QByteArray &key, SSL *ssl);
+    // Stores the session negotiated on \a ssl after a completed handshake.
+    static void store(const QByteArray &key, SSL *ssl);
+    static void remove(const QByteArray &key);
+    static void recordHandshake(bool resumed);
+    static void clear();
+
+    static int maximumSize();
+    static void setMaximumSize(int size);
+
+    static Statistics statistics();
+    static void resetStatistics();
+
+private:
+    struct Entry {
+        Entry(SSL_SESSION *session, qint64 expiry) : session(session), expiry(expiry) {}
+        ~Entry();
+        SSL_SESSION *session;
+        qint64 expiry; // msecs since epoch
+    };
+
+    QMutex mutex;
+    QCache<QByteArray, Entry> sessions;
+    QByteArray ticketKeys;
+    Statistics stats;
+
+public:
+    QSslSessionCache();
+};
+
+#endif // QT_NO_SSL
+
+QT_END_NAMESPACE
+
+#endif // QSSLSESSIONCACHE_OPENSSL_P_H
@@ -321,6 +321,7 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qscopedvaluerollback.h>
 #include <QtNetwork/qhostaddress.h>
 #include <QtNetwork/qhostinfo.h>
 
@@ -767,6 +768,51 @@ qint64 QSslSocket::encryptedBytesToWrite() const
     return d->plainSocket->bytesToWrite();
 }
 
+/*!
+    \since 5.6
+
+    Sets whether the TLS records of this socket are encrypted and decrypted
+    on a worker thread to \a enable. The default is false.
+
+    With the offload enabled, QSslSocket hands the records of an encrypted
+    connection to a shared thread pool in batches of up to 128 KB, one batch
+    per socket at a time, and keeps buffering data on its own thread in the
+    meantime. This lets a single thread serve several busy TLS connections
+    without becoming bound by the cost of encryption. The handshake is
+    always done on the socket's thread, and so are renegotiations, alerts
+    and the record work of the blocking functions, such as
+    waitForReadyRead() and waitForBytesWritten().
+
+    Signals are still emitted from the socket's thread, but readyRead() and
+    bytesWritten() may arrive later and cover more data than without the
+    offload. bytesToWrite() does not include the data a worker thread is
+    encrypting.
+
+    The offload is currently only supported with the OpenSSL backend; other
+    backends ignore this setting.
+
+    \sa isEncryptionOffloadEnabled()
+*/
+void QSslSocket::setEncryptionOffloadEnabled(bool enable)
+{
+    Q_D(QSslSocket);
+    d->encryptionOffload = enable;
+}
+
+/*!
+    \since 5.6
+
+    Returns \c true if the TLS records of this socket are encrypted and
+    decrypted on a worker thread; otherwise returns \c false.
+
+    \sa setEncryptionOffloadEnabled()
+*/
+bool QSslSocket::isEncryptionOffloadEnabled() const
+{
+    Q_D(const QSslSocket);
+    return d->encryptionOffload;
+}
+
 /*!
     \reimp
 
@@ -790,7 +836,9 @@ void QSslSocket::close()
     qCDebug(lcSsl) << "QSslSocket::close()";
 #endif
     Q_D(QSslSocket);
-    if (encryptedBytesToWrite() || !d->writeBuffer.isEmpty())
+    // records a worker thread is still encrypting must reach the plain socket
+    const QScopedValueRollback<bool> rollback(d->offloadSuspended, true);
+    if (encryptedBytesToWrite() || !d->writeBuffer.isEmpty() || d->encryptionOffload)
         flush();
     if (d->plainSocket)
         d->plainSocket->close();
@@ -1611,7 +1659,7 @@ bool QSslSocket::waitForReadyRead(int msecs)
         }
     }
 
-    if (!d->writeBuffer.isEmpty()) {
+    if (!d->writeBuffer.isEmpty() || d->encryptionOffload) {
         // empty our cleartext write buffer first
         d->transmit();
     }
@@ -1645,7 +1693,8 @@ bool QSslSocket::waitForBytesWritten(int msecs)
         if (!waitForEncrypted(msecs))
             return false;
     }
-    if (!d->writeBuffer.isEmpty()) {
+    const QScopedValueRollback<bool> rollback(d->offloadSuspended, true);
+    if (!d->writeBuffer.isEmpty() || d->encryptionOffload) {
         // empty our cleartext write buffer first
         d->transmit();
     }
@@ -1683,6 +1732,7 @@ bool QSslSocket::waitForDisconnected(int msecs)
         if (!waitForEncrypted(msecs))
             return false;
     }
+    const QScopedValueRollback<bool> rollback(d->offloadSuspended, true);
     bool retVal = d->plainSocket->waitForDisconnected(qt_subtract_from_timeout(msecs, stopWatch.elapsed()));
     if (!retVal) {
         setSocketState(d->plainSocket->state());
@@ -2015,6 +2065,8 @@ QSslSocketPrivate::QSslSocketPrivate()
     , shutdown(false)
     , ignoreAllSslErrors(false)
     , readyReadEmittedPointer(0)
+    , encryptionOffload(false)
+    , offloadSuspended(false)
     , allowRootCertOnDemandLoading(true)
     , plainSocket(0)
     , paused(false)
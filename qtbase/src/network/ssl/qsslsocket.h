@@ -120,6 +120,9 @@ public:
     qint64 encryptedBytesAvailable() const;
     qint64 encryptedBytesToWrite() const;
 
+    void setEncryptionOffloadEnabled(bool enable);
+    bool isEncryptionOffloadEnabled() const;
+
     // SSL configuration
     QSslConfiguration sslConfiguration() const;
     void setSslConfiguration(const QSslConfiguration &config);
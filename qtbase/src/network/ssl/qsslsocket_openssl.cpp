@@ -53,6 +53,7 @@
 #include "qssl_p.h"
 #include "qsslsocket_openssl_p.h"
 #include "qsslsocket_openssl_symbols_p.h"
+#include "qsslsessioncache_openssl_p.h"
 #include "qsslsocket.h"
 #include "qsslcertificate_p.h"
 #include "qsslcipher_p.h"
@@ -69,9 +70,13 @@
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qvarlengtharray.h>
+#include <QtCore/qwaitcondition.h>
 #include <QLibrary> // for loading the security lib for the CA store
 
 #include <string.h>
@@ -207,7 +212,8 @@ QSslSocketBackendPrivate::QSslSocketBackendPrivate()
     : ssl(0),
       readBio(0),
       writeBio(0),
-      session(0)
+      session(0),
+      cryptoJob(0)
 {
     // Calls SSL_library_init().
     ensureInitialized();
@@ -398,10 +404,24 @@ bool QSslSocketBackendPrivate::initSslContext()
         }
     }
 
+    // Offer a session from the process-wide cache, unless the context
+    // already resumes one of its own
+    sessionCacheKey.clear();
+    if (mode == QSslSocket::SslClientMode
+        && !(configuration.sslOptions & QSsl::SslOptionDisableSessionSharing)) {
+        QString peer = verificationPeerName.isEmpty() ? q->peerName() : verificationPeerName;
+        if (peer.isEmpty())
+            peer = hostName;
+        sessionCacheKey = QSslSessionCache::cacheKey(peer, q->peerPort(), configuration);
+        if (!q_SSL_get_session(ssl))
+            QSslSessionCache::resume(sessionCacheKey, ssl);
+    }
+
     // Clear the session.
     errorList.clear();
 
     // Initialize memory BIOs for encryption and decryption.
+    recordTracker = QSslRecordTracker();
     readBio = q_BIO_new(q_BIO_s_mem());
     writeBio = q_BIO_new(q_BIO_s_mem());
     if (!readBio || !writeBio) {
@@ -433,8 +453,17 @@ bool QSslSocketBackendPrivate::initSslContext()
     return true;
 }
 
+// QSslCryptoJob is only defined further down
+static void deleteCryptoJob(QSslCryptoJob *job);
+
 void QSslSocketBackendPrivate::destroySslContext()
 {
+    if (cryptoJob) {
+        // the worker must be done with the SSL object before it goes away
+        waitForCryptoJob();
+        deleteCryptoJob(cryptoJob);
+        cryptoJob = 0;
+    }
     if (ssl) {
         q_SSL_free(ssl);
         ssl = 0;
@@ -835,10 +864,379 @@ void QSslSocketBackendPrivate::startServerEncryption()
     transmit();
 }
 
+// The largest amount of plain text and of encrypted data a single
+// encryption offload job takes in; a job that was given this much
+// usually leaves more work behind for the next one.
+static const int CryptoJobBatchSize = 128 * 1024;
+
+class QSslCryptoThreadPool : public QThreadPool
+{
+public:
+    QSslCryptoThreadPool()
+    {
+        setExpiryTimeout(60 * 1000);
+    }
+};
+
+Q_GLOBAL_STATIC(QSslCryptoThreadPool, sslCryptoThreadPool)
+
+/*
+    The record work of one socket with encryption offload enabled. The
+    socket thread fills encryptedIn and plainOut and starts the job; while
+    it runs, the job owns the SSL object and its BIOs, so the socket thread
+    must wait for it before touching them. The buffers live as long as the
+    job, which is reused for the whole connection.
+*/
+class QSslCryptoJob : public QRunnable
+{
+public:
+    QSslCryptoJob(QSslSocket *socket, SSL *ssl, BIO *readBio, BIO *writeBio)
+        : socket(socket), ssl(ssl), readBio(readBio), writeBio(writeBio),
+          plainWritten(0), readError(SSL_ERROR_NONE), writeError(SSL_ERROR_NONE),
+          bioFailed(false), running(false), pending(false)
+    {
+        setAutoDelete(false);
+        encryptedIn.reserve(CryptoJobBatchSize);
+        plainOut.reserve(CryptoJobBatchSize);
+        plainIn.reserve(CryptoJobBatchSize);
+        encryptedOut.reserve(CryptoJobBatchSize);
+    }
+
+    void run() Q_DECL_OVERRIDE;
+
+    bool isRunning()
+    {
+        QMutexLocker locker(&mutex);
+        return running;
+    }
+
+    void wait()
+    {
+        QMutexLocker locker(&mutex);
+        while (running)
+            finished.wait(&mutex);
+    }
+
+    QSslSocket *socket;
+    SSL *ssl;
+    BIO *readBio;
+    BIO *writeBio;
+
+    // input, filled by the socket thread
+    QByteArray encryptedIn;
+    QByteArray plainOut;
+
+    // output, filled by the worker
+    QByteArray plainIn;
+    QByteArray encryptedOut;
+    int plainWritten;
+    int readError;
+    int writeError;
+    bool bioFailed;
+    QString errorString;
+
+    QMutex mutex;
+    QWaitCondition finished;
+    bool running;
+    bool pending; // started and not collected yet; only used by the socket thread
+};
+
+static void deleteCryptoJob(QSslCryptoJob *job)
+{
+    delete job;
+}
+
+void QSslCryptoJob::run()
+{
+    plainWritten = 0;
+    readError = writeError = SSL_ERROR_NONE;
+    bioFailed = false;
+    errorString.clear();
+
+    if (!encryptedIn.isEmpty()
+        && q_BIO_write(readBio, encryptedIn.constData(), encryptedIn.size()) <= 0) {
+        bioFailed = true;
+        // OpenSSL keeps its error queue per thread
+        errorString = QSslSocketBackendPrivate::getErrorsFromOpenSsl();
+    } else {
+        // Decrypt everything that has arrived, a whole record at a time.
+        int decrypted = 0;
+        forever {
+            plainIn.resize(decrypted + SSL3_RT_MAX_PLAIN_LENGTH);
+            const int readBytes = q_SSL_read(ssl, plainIn.data() + decrypted, SSL3_RT_MAX_PLAIN_LENGTH);
+            if (readBytes <= 0) {
+                readError = q_SSL_get_error(ssl, readBytes);
+                break;
+            }
+            decrypted += readBytes;
+        }
+        plainIn.resize(decrypted);
+
+        switch (readError) {
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+            // Out of data; encrypt what was written.
+            while (plainWritten < plainOut.size()) {
+                const int writtenBytes = q_SSL_write(ssl, plainOut.constData() + plainWritten,
+                                                     plainOut.size() - plainWritten);
+                if (writtenBytes <= 0) {
+                    writeError = q_SSL_get_error(ssl, writtenBytes);
+                    if (writeError != SSL_ERROR_WANT_READ && writeError != SSL_ERROR_WANT_WRITE)
+                        errorString = QSslSocketBackendPrivate::getErrorsFromOpenSsl();
+                    break;
+                }
+                plainWritten += writtenBytes;
+            }
+            break;
+        case SSL_ERROR_ZERO_RETURN:
+            break;
+        default:
+            errorString = QSslSocketBackendPrivate::getErrorsFromOpenSsl();
+            break;
+        }
+    }
+
+    // Collect the records to send, including alerts and handshake messages
+    // that SSL_read() may have produced.
+    int encrypted = 0;
+    int pendingBytes;
+    encryptedOut.resize(0);
+    while ((pendingBytes = q_BIO_pending(writeBio)) > 0) {
+        encryptedOut.resize(encrypted + pendingBytes);
+        const int encryptedBytesRead = q_BIO_read(writeBio, encryptedOut.data() + encrypted, pendingBytes);
+        if (encryptedBytesRead <= 0)
+            break;
+        encrypted += encryptedBytesRead;
+    }
+    encryptedOut.resize(encrypted);
+
+    QMutexLocker locker(&mutex);
+    // Post while still running: the socket waits for this job before it
+    // can be destroyed.
+    QMetaObject::invokeMethod(socket, "_q_flushReadBuffer", Qt::QueuedConnection);
+    running = false;
+    finished.wakeAll();
+}
+
+/*!
+    \internal
+
+    Moves the position in the record stream over at most \a size bytes at
+    \a data and returns how many it went over. With \a applicationDataOnly,
+    stops in front of the first record that does not carry application data.
+*/
+qint64 QSslRecordTracker::advance(const char *data, qint64 size, bool applicationDataOnly)
+{
+    qint64 done = 0;
+    while (done < size) {
+        if (headerSize == 0 && applicationDataOnly && uchar(data[done]) != SSL3_RT_APPLICATION_DATA)
+            break;
+        // SSLv2 compatible hellos come with a two byte header
+        const int headerLength = (headerSize > 0 ? header[0] : uchar(data[done])) & 0x80 ? 2 : 5;
+        if (headerSize < headerLength) {
+            header[headerSize++] = uchar(data[done++]);
+            if (headerSize == headerLength) {
+                bodyLeft = headerLength == 2 ? ((header[0] & 0x7f) << 8) | header[1]
+                                             : (header[3] << 8) | header[4];
+                if (!bodyLeft)
+                    headerSize = 0;
+            }
+            continue;
+        }
+        const qint64 bodyBytes = qMin(size - done, bodyLeft);
+        done += bodyBytes;
+        bodyLeft -= bodyBytes;
+        if (!bodyLeft)
+            headerSize = 0;
+    }
+    return done;
+}
+
+/*!
+    \internal
+
+    Returns \c true if transmit() may hand the record work to a worker
+    thread instead of doing it right away.
+*/
+bool QSslSocketBackendPrivate::canOffload() const
+{
+    return encryptionOffload && !offloadSuspended && !readyReadEmittedPointer
+        && connectionEncrypted && !shutdown
+        && plainSocket->state() == QAbstractSocket::ConnectedState;
+}
+
+/*!
+    \internal
+
+    Moves up to a batch of plain text from the write buffer and of
+    encrypted data from the plain socket into the offload job and starts
+    it. Returns \c false if there was nothing to do, or if the records
+    have to be handled by transmit() itself.
+
+    The worker only gets application data records. Handshake messages,
+    alerts and change cipher spec records, as well as everything while a
+    renegotiation is pending, stay on the socket thread: verifying the
+    peer's certificates and reporting the errors that come out of it
+    rely on state that belongs to that thread.
+*/
+bool QSslSocketBackendPrivate::startCryptoJob()
+{
+    Q_Q(QSslSocket);
+    // TLS 1.3 hides its handshake messages in application data records.
+    if (q_SSL_version(ssl) > 0x303 || q_SSL_renegotiate_pending(ssl))
+        return false;
+
+    if (!cryptoJob)
+        cryptoJob = new QSslCryptoJob(q, ssl, readBio, writeBio);
+    QSslCryptoJob *job = cryptoJob;
+    job->ssl = ssl;
+    job->readBio = readBio;
+    job->writeBio = writeBio;
+
+    qint64 encryptedBytes = 0;
+    if (!readBufferMaxSize || buffer.size() < readBufferMaxSize)
+        encryptedBytes = qMin<qint64>(plainSocket->bytesAvailable(), CryptoJobBatchSize);
+    job->encryptedIn.resize(int(encryptedBytes));
+    if (encryptedBytes > 0) {
+        encryptedBytes = plainSocket->peek(job->encryptedIn.data(), encryptedBytes);
+        QSslRecordTracker tracker = recordTracker;
+        const qint64 applicationDataBytes = tracker.advance(job->encryptedIn.constData(), encryptedBytes, true);
+        if (applicationDataBytes == 0) {
+            // the next record is for transmit()
+            job->encryptedIn.resize(0);
+            return false;
+        }
+        job->encryptedIn.resize(int(plainSocket->read(job->encryptedIn.data(), applicationDataBytes)));
+        recordTracker = tracker;
+    }
+
+    job->plainOut.resize(int(qMin<qint64>(writeBuffer.size(), CryptoJobBatchSize)));
+    if (!job->plainOut.isEmpty())
+        writeBuffer.read(job->plainOut.data(), job->plainOut.size());
+
+    if (job->plainOut.isEmpty() && job->encryptedIn.isEmpty())
+        return false;
+
+#ifdef QSSLSOCKET_DEBUG
+    qCDebug(lcSsl) << "QSslSocketBackendPrivate::startCryptoJob: encrypting" << job->plainOut.size()
+                   << "bytes, decrypting" << job->encryptedIn.size() << "bytes";
+#endif
+    job->running = true;
+    job->pending = true;
+    sslCryptoThreadPool()->start(job);
+    return true;
+}
+
+/*!
+    \internal
+
+    Blocks until the offload job, if any, has stopped running.
+*/
+void QSslSocketBackendPrivate::waitForCryptoJob() const
+{
+    if (cryptoJob)
+        cryptoJob->wait();
+}
+
+/*!
+    \internal
+
+    Waits for the pending offload job and delivers its results: encrypted
+    records go to the plain socket, decrypted data to the read buffer.
+    Returns \c false if the connection cannot go on.
+*/
+bool QSslSocketBackendPrivate::collectCryptoJob()
+{
+    Q_Q(QSslSocket);
+    QSslCryptoJob *job = cryptoJob;
+    job->wait();
+    job->pending = false;
+
+    // Give back what SSL_write() did not take, e.g. during a renegotiation.
+    if (job->plainWritten < job->plainOut.size()) {
+        const int left = job->plainOut.size() - job->plainWritten;
+        ::memcpy(writeBuffer.reserveFront(left), job->plainOut.constData() + job->plainWritten, left);
+    }
+
+    if (!job->plainIn.isEmpty()) {
+#ifdef QSSLSOCKET_DEBUG
+        qCDebug(lcSsl) << "QSslSocketBackendPrivate::collectCryptoJob: decrypted" << job->plainIn.size() << "bytes";
+#endif
+        ::memcpy(buffer.reserve(job->plainIn.size()), job->plainIn.constData(), job->plainIn.size());
+    }
+
+    // The signals below may destroy the job, so take everything out first.
+    const qint64 plainWritten = job->plainWritten;
+    const qint64 plainRead = job->plainIn.size();
+    const bool bioFailed = job->bioFailed;
+    const int readError = job->readError;
+    const int writeError = job->writeError;
+    const QString errorString = job->errorString;
+
+    if (!job->encryptedOut.isEmpty() && plainSocket->isValid()) {
+#ifdef QSSLSOCKET_DEBUG
+        qCDebug(lcSsl) << "QSslSocketBackendPrivate::collectCryptoJob: wrote" << job->encryptedOut.size() << "encrypted bytes to the socket";
+#endif
+        if (plainSocket->write(job->encryptedOut) < 0) {
+            //plain socket write fails if it was in the pending close state.
+            setErrorAndEmit(plainSocket->error(), plainSocket->errorString());
+            return false;
+        }
+    }
+
+    if (plainWritten > 0) {
+        // Don't emit bytesWritten() recursively.
+        if (!emittedBytesWritten) {
+            emittedBytesWritten = true;
+            emit q->bytesWritten(plainWritten);
+            emittedBytesWritten = false;
+        }
+    }
+
+    if (plainRead > 0) {
+        if (readyReadEmittedPointer)
+            *readyReadEmittedPointer = true;
+        emit q->readyRead();
+    }
+
+    if (bioFailed) {
+        setErrorAndEmit(QAbstractSocket::SslInternalError,
+                        QSslSocket::tr("Unable to decrypt data: %1").arg(errorString));
+        return false;
+    }
+    switch (readError) {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+        break;
+    case SSL_ERROR_ZERO_RETURN:
+        // The remote host closed the connection.
+        shutdown = true; // the other side shut down, make sure we do not send shutdown ourselves
+        setErrorAndEmit(QAbstractSocket::RemoteHostClosedError,
+                        QSslSocket::tr("The TLS/SSL connection has been closed"));
+        return false;
+    default:
+        setErrorAndEmit(QAbstractSocket::SslInternalError,
+                        QSslSocket::tr("Error while reading: %1").arg(errorString));
+        return false;
+    }
+    if (writeError != SSL_ERROR_NONE && writeError != SSL_ERROR_WANT_READ
+        && writeError != SSL_ERROR_WANT_WRITE) {
+        setErrorAndEmit(QAbstractSocket::SslInternalError,
+                        QSslSocket::tr("Unable to write data: %1").arg(errorString));
+        return false;
+    }
+    return ssl != 0;
+}
+
 /*!
     \internal
 
     Transmits encrypted data between the BIOs and the socket.
+
+    With encryption offload enabled and the connection encrypted, the
+    record work is done by a worker thread instead, one job per socket at
+    a time; the job triggers another transmit() when it is done. In the
+    meantime, the socket thread keeps buffering for the next job.
 */
 void QSslSocketBackendPrivate::transmit()
 {
@@ -848,6 +1246,16 @@ void QSslSocketBackendPrivate::transmit()
     if (!ssl)
         return;
 
+    if (cryptoJob && cryptoJob->pending) {
+        // Leave a running job alone, unless the caller needs its results now.
+        if (canOffload() && cryptoJob->isRunning())
+            return;
+        if (!collectCryptoJob())
+            return;
+    }
+    if (canOffload() && startCryptoJob())
+        return;
+
     bool transmitting;
     do {
         transmitting = false;
@@ -901,7 +1309,7 @@ void QSslSocketBackendPrivate::transmit()
         }
 
         // Check if we've got any data to be written to the socket.
-        QVarLengthArray<char, 4096> data;
+        QVarLengthArray<char, SSL3_RT_MAX_PLAIN_LENGTH> data;
         int pendingBytes;
         while (plainSocket->isValid() && (pendingBytes = q_BIO_pending(writeBio)) > 0) {
             // Read encrypted data from the write BIO into a buffer.
@@ -924,10 +1332,12 @@ void QSslSocketBackendPrivate::transmit()
         // Check if we've got any data to be read from the socket.
         if (!connectionEncrypted || !readBufferMaxSize || buffer.size() < readBufferMaxSize)
             while ((pendingBytes = plainSocket->bytesAvailable()) > 0) {
-                // Read encrypted data from the socket into a buffer.
+                // Read encrypted data from the socket into a buffer. The read
+                // BIO is a memory BIO, which takes all of it or fails.
                 data.resize(pendingBytes);
-                // just peek() here because q_BIO_write could write less data than expected
-                int encryptedBytesRead = plainSocket->peek(data.data(), pendingBytes);
+                int encryptedBytesRead = plainSocket->read(data.data(), pendingBytes);
+                if (encryptedBytesRead > 0)
+                    recordTracker.advance(data.constData(), encryptedBytesRead, false);
 
 #ifdef QSSLSOCKET_DEBUG
                 qCDebug(lcSsl) << "QSslSocketBackendPrivate::transmit: read" << encryptedBytesRead << "encrypted bytes from the socket";
@@ -935,11 +1345,7 @@ void QSslSocketBackendPrivate::transmit()
                 // Write encrypted data from the buffer into the read BIO.
                 int writtenToBio = q_BIO_write(readBio, data.constData(), encryptedBytesRead);
 
-                // do the actual read() here and throw away the results.
-                if (writtenToBio > 0) {
-                    // ### TODO: make this cheaper by not making it memcpy. E.g. make it work with data=0x0 or make it work with seek
-                    plainSocket->read(data.data(), writtenToBio);
-                } else {
+                if (writtenToBio <= 0) {
                     // ### Better error handling.
                     setErrorAndEmit(QAbstractSocket::SslInternalError,
                                     QSslSocket::tr("Unable to decrypt data: %1").arg(
@@ -986,27 +1392,33 @@ void QSslSocketBackendPrivate::transmit()
         // We always read everything from the SSL decryption buffers, even if
         // we have a readBufferMaxSize. There's no point in leaving data there
         // just so that readBuffer.size() == readBufferMaxSize.
+        // Decrypt straight into the read buffer, a whole record at a time,
+        // and emit readyRead() once for all of it.
         int readBytes = 0;
-        data.resize(4096);
-        ::memset(data.data(), 0, data.size());
+        qint64 totalBytesRead = 0;
         do {
             // Don't use SSL_pending(). It's very unreliable.
-            if ((readBytes = q_SSL_read(ssl, data.data(), data.size())) > 0) {
+            char *ptr = buffer.reserve(SSL3_RT_MAX_PLAIN_LENGTH);
+            readBytes = q_SSL_read(ssl, ptr, SSL3_RT_MAX_PLAIN_LENGTH);
+            buffer.chop(SSL3_RT_MAX_PLAIN_LENGTH - qMax(readBytes, 0));
+            if (readBytes > 0) {
 #ifdef QSSLSOCKET_DEBUG
                 qCDebug(lcSsl) << "QSslSocketBackendPrivate::transmit: decrypted" << readBytes << "bytes";
 #endif
-                char *ptr = buffer.reserve(readBytes);
-                ::memcpy(ptr, data.data(), readBytes);
+                totalBytesRead += readBytes;
+                transmitting = true;
+                continue;
+            }
 
+            const int error = q_SSL_get_error(ssl, readBytes);
+            if (totalBytesRead > 0) {
                 if (readyReadEmittedPointer)
                     *readyReadEmittedPointer = true;
                 emit q->readyRead();
-                transmitting = true;
-                continue;
             }
 
             // Error.
-            switch (q_SSL_get_error(ssl, readBytes)) {
+            switch (error) {
             case SSL_ERROR_WANT_READ:
             case SSL_ERROR_WANT_WRITE:
                 // Out of data.
@@ -1498,6 +1910,11 @@ void QWindowsCaRootFetcher::start()
 
 void QSslSocketBackendPrivate::disconnectFromHost()
 {
+    if (cryptoJob && cryptoJob->pending) {
+        // deliver the records of the offload job before shutting down
+        QScopedValueRollback<bool> rollback(offloadSuspended, true);
+        transmit();
+    }
     if (ssl) {
         if (!shutdown) {
             q_SSL_shutdown(ssl);
@@ -1510,12 +1927,13 @@ void QSslSocketBackendPrivate::disconnectFromHost()
 
 void QSslSocketBackendPrivate::disconnected()
 {
-    if (plainSocket->bytesAvailable() <= 0)
+    if (plainSocket->bytesAvailable() <= 0 && !(cryptoJob && cryptoJob->pending))
         destroySslContext();
     else {
         // Move all bytes into the plain buffer
         qint64 tmpReadBufferMaxSize = readBufferMaxSize;
         readBufferMaxSize = 0; // reset temporarily so the plain socket buffer is completely drained
+        QScopedValueRollback<bool> rollback(offloadSuspended, true);
         transmit();
         readBufferMaxSize = tmpReadBufferMaxSize;
     }
@@ -1525,6 +1943,8 @@ void QSslSocketBackendPrivate::disconnected()
 
 QSslCipher QSslSocketBackendPrivate::sessionCipher() const
 {
+    // the offload job may be using the SSL object
+    waitForCryptoJob();
     if (!ssl)
         return QSslCipher();
 #if OPENSSL_VERSION_NUMBER >= 0x10000000L
@@ -1540,6 +1960,8 @@ QSslCipher QSslSocketBackendPrivate::sessionCipher() const
 
 QSsl::SslProtocol QSslSocketBackendPrivate::sessionProtocol() const
 {
+    // the offload job may be using the SSL object
+    waitForCryptoJob();
     if (!ssl)
         return QSsl::UnknownProtocol;
     int ver = q_SSL_version(ssl);
@@ -1567,8 +1989,11 @@ void QSslSocketBackendPrivate::continueHandshake()
     if (readBufferMaxSize)
         plainSocket->setReadBufferSize(readBufferMaxSize);
 
-    if (q_SSL_ctrl((ssl), SSL_CTRL_GET_SESSION_REUSED, 0, NULL))
+    const bool sessionReused = q_SSL_ctrl((ssl), SSL_CTRL_GET_SESSION_REUSED, 0, NULL);
+    if (sessionReused)
         configuration.peerSessionShared = true;
+    if (mode == QSslSocket::SslClientMode)
+        QSslSessionCache::recordHandshake(sessionReused);
 
 #ifdef QT_DECRYPT_SSL_TRAFFIC
     if (ssl->session && ssl->s3) {
@@ -1606,6 +2031,11 @@ void QSslSocketBackendPrivate::continueHandshake()
 
     // Cache this SSL session inside the QSslContext
     if (!(configuration.sslOptions & QSsl::SslOptionDisableSessionSharing)) {
+        // a session from a handshake with errors, even ignored ones, must not
+        // let other sockets skip the verification
+        if (!sessionCacheKey.isEmpty() && sslErrors.isEmpty()
+            && !ignoreAllSslErrors && ignoreErrorsList.isEmpty())
+            QSslSessionCache::store(sessionCacheKey, ssl);
         if (!sslContextPointer->cacheSession(ssl)) {
             sslContextPointer.clear(); // we could not cache the session
         } else {
@@ -1635,6 +2065,17 @@ void QSslSocketBackendPrivate::continueHandshake()
     }
 #endif // OPENSSL_VERSION_NUMBER >= 0x1000100fL ...
 
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+    // a protocol selected by the server via ALPN takes precedence over NPN
+    const unsigned char *alpnProto = 0;
+    unsigned int alpnProtoLen = 0;
+    q_SSL_get0_alpn_selected(ssl, &alpnProto, &alpnProtoLen);
+    if (alpnProtoLen) {
+        configuration.nextProtocolNegotiationStatus = QSslConfiguration::NextProtocolNegotiationNegotiated;
+        configuration.nextNegotiatedProtocol = QByteArray(reinterpret_cast<const char *>(alpnProto), alpnProtoLen);
+    }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+
     connectionEncrypted = true;
     emit q->encrypted();
     if (autoStartHandshake && pendingClose) {
@@ -97,6 +97,20 @@ typedef _STACK STACK;
 
 QT_BEGIN_NAMESPACE
 
+class QSslCryptoJob;
+
+// Follows the TLS record layer of the data read from the plain socket, so
+// that the record types can be told apart without decrypting anything.
+struct QSslRecordTracker
+{
+    QSslRecordTracker() : headerSize(0), bodyLeft(0) {}
+    qint64 advance(const char *data, qint64 size, bool applicationDataOnly);
+
+    uchar header[5];
+    int headerSize;
+    qint64 bodyLeft;
+};
+
 class QSslSocketBackendPrivate : public QSslSocketPrivate
 {
     Q_DECLARE_PUBLIC(QSslSocket)
@@ -111,11 +125,20 @@ public:
     BIO *readBio;
     BIO *writeBio;
     SSL_SESSION *session;
+    QByteArray sessionCacheKey; // key into QSslSessionCache, client mode only
     QList<QPair<int, int> > errorList;
 #if OPENSSL_VERSION_NUMBER >= 0x10001000L
     static int s_indexForSSLExtraData; // index used in SSL_get_ex_data to get the matching QSslSocketBackendPrivate
 #endif
 
+    // Encryption offload
+    QSslCryptoJob *cryptoJob;
+    QSslRecordTracker recordTracker;
+    bool canOffload() const;
+    bool startCryptoJob();
+    bool collectCryptoJob();
+    void waitForCryptoJob() const;
+
     // Platform specific functions
     void startClientEncryption() Q_DECL_OVERRIDE;
     void startServerEncryption() Q_DECL_OVERRIDE;
@@ -299,6 +299,7 @@ int q_PEM_write_bio_EC_PUBKEY(BIO *a, EC_KEY *b);
 #endif
 void q_RAND_seed(const void *a, int b);
 int q_RAND_status();
+int q_RAND_bytes(unsigned char *a, int b);
 RSA *q_RSA_new();
 void q_RSA_free(RSA *a);
 int q_sk_num(STACK *a);
@@ -331,6 +332,7 @@ int q_SSL_CTX_set_cipher_list(SSL_CTX *a, const char *b);
 int q_SSL_CTX_set_default_verify_paths(SSL_CTX *a);
 void q_SSL_CTX_set_verify(SSL_CTX *a, int b, int (*c)(int, X509_STORE_CTX *));
 void q_SSL_CTX_set_verify_depth(SSL_CTX *a, int b);
+int q_SSL_CTX_set_session_id_context(SSL_CTX *a, const unsigned char *b, unsigned int c);
 int q_SSL_CTX_use_certificate(SSL_CTX *a, X509 *b);
 int q_SSL_CTX_use_certificate_file(SSL_CTX *a, const char *b, int c);
 int q_SSL_CTX_use_PrivateKey(SSL_CTX *a, EVP_PKEY *b);
@@ -345,6 +347,7 @@ const SSL_CIPHER *q_SSL_get_current_cipher(SSL *a);
 SSL_CIPHER *q_SSL_get_current_cipher(SSL *a);
 #endif
 int q_SSL_version(const SSL *a);
+int q_SSL_renegotiate_pending(SSL *a);
 int q_SSL_get_error(SSL *a, int b);
 STACK_OF(X509) *q_SSL_get_peer_cert_chain(SSL *a);
 X509 *q_SSL_get_peer_certificate(SSL *a);
@@ -550,6 +553,10 @@ void q_SSL_CTX_set_next_proto_select_cb(SSL_CTX *s,
 void q_SSL_get0_next_proto_negotiated(const SSL *s, const unsigned char **data,
                                       unsigned *len);
 #endif // OPENSSL_VERSION_NUMBER >= 0x1000100fL ...
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+int q_SSL_set_alpn_protos(SSL *ssl, const unsigned char *protos, unsigned protos_len);
+void q_SSL_get0_alpn_selected(const SSL *ssl, const unsigned char **data, unsigned *len);
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
 
 // Helper function
 class QDateTime;
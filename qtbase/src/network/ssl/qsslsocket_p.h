@@ -112,6 +112,11 @@ public:
     QList<QSslError> ignoreErrorsList;
     bool* readyReadEmittedPointer;
 
+    // records are encrypted and decrypted on a worker thread, unless a
+    // blocking call needs transmit() to have finished when it returns
+    bool encryptionOffload;
+    bool offloadSuspended;
+
     QSslConfigurationPrivate configuration;
     QList<QSslError> sslErrors;
     QSharedPointer<QSslContext> sslContextPointer;
@@ -36,6 +36,8 @@
 #include <qcoreapplication.h>
 #include <qvariant.h>
 #include <qdatetime.h>
+#include <qendian.h>
+#include <qiodevice.h>
 #include <qregexp.h>
 #include <qsqlerror.h>
 #include <qsqlfield.h>
@@ -48,12 +50,24 @@
 #include <qlocale.h>
 #include <QtSql/private/qsqlresult_p.h>
 #include <QtSql/private/qsqldriver_p.h>
+#include <QtSql/private/qsqlcolumnbatch_p.h>
+#include <QtCore/private/qlocale_tools_p.h>
 
 #include <libpq-fe.h>
 #include <pg_config.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <limits>
+
+// PQdescribePrepared() is available since libpq 8.2, PQsetSingleRowMode() since 9.2
+#if defined(PG_VERSION_NUM) && PG_VERSION_NUM >= 80200
+#  define QPSQL_HAVE_DESCRIBE_PREPARED
+#endif
+#if defined(PG_VERSION_NUM) && PG_VERSION_NUM >= 90200
+#  define QPSQL_HAVE_SINGLE_ROW_MODE
+#endif
 // below code taken from an example at http://www.gnu.org/software/hello/manual/autoconf/Function-Portability.html
 #ifndef isnan
     # define isnan(x) \
@@ -92,6 +106,10 @@
 #define QTIMESTAMPOID 1114
 #define QTIMESTAMPTZOID 1184
 #define QOIDOID 2278
+#define QNAMEOID 19
+#define QTEXTOID 25
+#define QBPCHAROID 1042
+#define QVARCHAROID 1043
 #define QBYTEAOID 17
 #define QREGPROCOID 24
 #define QXIDOID 28
@@ -126,24 +144,46 @@ class QPSQLDriverPrivate : public QSqlDriverPrivate
 public:
     QPSQLDriverPrivate() : QSqlDriverPrivate(),
         connection(0),
+        cancel(0),
         isUtf8(false),
         pro(QPSQLDriver::Version6),
         sn(0),
         pendingNotifyCheck(false),
-        hasBackslashEscape(false)
+        hasBackslashEscape(false),
+        singleRowMode(false),
+        binaryResults(false),
+        currentStmtId(0),
+        lastStmtId(0),
+        currentInTransaction(false)
     { dbmsType = QSqlDriver::PostgreSQL; }
 
     PGconn *connection;
+    // created up front, PQcancel() may be called from any thread
+    PGcancel *cancel;
     bool isUtf8;
     QPSQLDriver::Protocol pro;
     QSocketNotifier *sn;
     QStringList seid;
     mutable bool pendingNotifyCheck;
     bool hasBackslashEscape;
+    // stream forward-only queries row by row (QPSQL_SINGLE_ROW_MODE)
+    bool singleRowMode;
+    // fetch prepared queries in binary format (QPSQL_BINARY_RESULTS)
+    bool binaryResults;
+    // the query whose results are still being received, see sendQuery()
+    mutable int currentStmtId;
+    mutable int lastStmtId;
+    // whether the current query was sent inside a transaction block
+    mutable bool currentInTransaction;
 
     void appendTables(QStringList &tl, QSqlQuery &t, QChar type);
-    PGresult * exec(const char * stmt) const;
-    PGresult * exec(const QString & stmt) const;
+    PGresult * exec(const char * stmt, bool binary = false) const;
+    PGresult * exec(const QString & stmt, bool binary = false) const;
+    int sendQuery(const QString &stmt, bool binary) const;
+    PGresult *getResult(int stmtId) const;
+    void finishQuery(int stmtId) const;
+    void cancelQuery(int stmtId) const;
+    void checkNotifications() const;
     QPSQLDriver::Protocol getPSQLVersion();
     bool setEncodingUtf8();
     void setDatestyle();
@@ -174,20 +214,85 @@ void QPSQLDriverPrivate::appendTables(QStringList &tl, QSqlQuery &t, QChar type)
     }
 }
 
-PGresult * QPSQLDriverPrivate::exec(const char * stmt) const
+PGresult * QPSQLDriverPrivate::exec(const char * stmt, bool binary) const
+{
+    // PQexec() discards the rest of a query that is still being streamed
+    currentStmtId = 0;
+    PGresult *result = binary ? PQexecParams(connection, stmt, 0, 0, 0, 0, 0, 1)
+                              : PQexec(connection, stmt);
+    checkNotifications();
+    return result;
+}
+
+PGresult * QPSQLDriverPrivate::exec(const QString & stmt, bool binary) const
+{
+    return exec(isUtf8 ? stmt.toUtf8().constData() : stmt.toLocal8Bit().constData(), binary);
+}
+
+void QPSQLDriverPrivate::checkNotifications() const
 {
     Q_Q(const QPSQLDriver);
-    PGresult *result = PQexec(connection, stmt);
     if (seid.size() && !pendingNotifyCheck) {
         pendingNotifyCheck = true;
         QMetaObject::invokeMethod(const_cast<QPSQLDriver*>(q), "_q_handleNotification", Qt::QueuedConnection, Q_ARG(int,0));
     }
+}
+
+/*
+   Sends stmt without waiting for its results and returns an id to fetch
+   them with getResult(), or 0 on failure. Only one query can be in flight
+   per connection; sending another query or calling exec() discards the
+   results of the previous one that were not fetched yet.
+ */
+int QPSQLDriverPrivate::sendQuery(const QString &stmt, bool binary) const
+{
+    finishQuery(currentStmtId);
+    const QByteArray query = isUtf8 ? stmt.toUtf8() : stmt.toLocal8Bit();
+    currentInTransaction = PQtransactionStatus(connection) != PQTRANS_IDLE;
+    const int sent = binary ? PQsendQueryParams(connection, query.constData(), 0, 0, 0, 0, 0, 1)
+                            : PQsendQuery(connection, query.constData());
+    if (!sent)
+        return 0;
+    if (++lastStmtId <= 0)
+        lastStmtId = 1;
+    currentStmtId = lastStmtId;
+    return currentStmtId;
+}
+
+PGresult *QPSQLDriverPrivate::getResult(int stmtId) const
+{
+    if (stmtId == 0 || stmtId != currentStmtId)
+        return 0;
+    PGresult *result = PQgetResult(connection);
+    if (!result) {
+        currentStmtId = 0;
+        checkNotifications();
+    }
     return result;
 }
 
-PGresult * QPSQLDriverPrivate::exec(const QString & stmt) const
+void QPSQLDriverPrivate::finishQuery(int stmtId) const
 {
-    return exec(isUtf8 ? stmt.toUtf8().constData() : stmt.toLocal8Bit().constData());
+    if (stmtId == 0 || stmtId != currentStmtId)
+        return;
+    while (PGresult *result = PQgetResult(connection))
+        PQclear(result);
+    currentStmtId = 0;
+    checkNotifications();
+}
+
+/*
+   Asks the server to stop sending the rest of a streamed result, so that
+   finishQuery() does not have to receive all of it. A cancelled query
+   aborts the transaction it runs in, so queries sent inside a transaction
+   block are always received to the end.
+ */
+void QPSQLDriverPrivate::cancelQuery(int stmtId) const
+{
+    if (stmtId == 0 || stmtId != currentStmtId || currentInTransaction || !cancel)
+        return;
+    char error[256];
+    PQcancel(cancel, error, sizeof(error));
 }
 
 class QPSQLResultPrivate : public QSqlResultPrivate
@@ -198,7 +303,10 @@ public:
       : QSqlResultPrivate(),
         result(0),
         currentSize(-1),
-        preparedQueriesEnabled(false)
+        preparedQueriesEnabled(false),
+        stmtId(0),
+        rowOffset(0),
+        binaryResults(false)
     { }
 
     QString fieldSerial(int i) const Q_DECL_OVERRIDE { return QLatin1Char('$') + QString::number(i + 1); }
@@ -213,7 +321,15 @@ public:
     int currentSize;
     bool preparedQueriesEnabled;
     QString preparedStmtId;
-
+    // set while the rows of a single-row mode query are being streamed
+    int stmtId;
+    // the row number of the first row in result
+    int rowOffset;
+    // whether the prepared statement can be executed with binary results
+    bool binaryResults;
+
+    bool execute(const QString &stmt, bool binary);
+    bool fetchStreamed(int i);
     bool processResults();
 };
 
@@ -227,6 +343,9 @@ static QSqlError qMakeError(const QString& err, QSqlError::ErrorType type,
       errorCode = QString::fromLatin1(PQresultErrorField(result, PG_DIAG_SQLSTATE));
       msg += QString::fromLatin1("(%1)").arg(errorCode);
     }
+    // lets callers tell a lost connection from a failed statement
+    if (PQstatus(p->connection) == CONNECTION_BAD)
+        type = QSqlError::ConnectionError;
     return QSqlError(QLatin1String("QPSQL: ") + err, msg, type, errorCode);
 }
 
@@ -237,6 +356,19 @@ bool QPSQLResultPrivate::processResults()
         return false;
 
     int status = PQresultStatus(result);
+#ifdef QPSQL_HAVE_SINGLE_ROW_MODE
+    if (status == PGRES_SINGLE_TUPLE) {
+        // the size is unknown until the last row has been received
+        q->setSelect(true);
+        q->setActive(true);
+        currentSize = -1;
+        return true;
+    }
+#endif
+    // anything else completes a streamed query
+    privDriver()->finishQuery(stmtId);
+    stmtId = 0;
+
     if (status == PGRES_TUPLES_OK) {
         q->setSelect(true);
         q->setActive(true);
@@ -335,9 +467,16 @@ QVariant QPSQLResult::handle() const
 void QPSQLResult::cleanup()
 {
     Q_D(QPSQLResult);
+    if (d->stmtId && driver()) {
+        // the rest of an abandoned stream is not wanted
+        d->privDriver()->cancelQuery(d->stmtId);
+        d->privDriver()->finishQuery(d->stmtId);
+    }
+    d->stmtId = 0;
     if (d->result)
         PQclear(d->result);
     d->result = 0;
+    d->rowOffset = 0;
     setAt(QSql::BeforeFirstRow);
     d->currentSize = -1;
     setActive(false);
@@ -345,19 +484,62 @@ void QPSQLResult::cleanup()
 
 bool QPSQLResult::fetch(int i)
 {
-    Q_D(const QPSQLResult);
+    Q_D(QPSQLResult);
     if (!isActive())
         return false;
     if (i < 0)
         return false;
-    if (i >= d->currentSize)
-        return false;
     if (at() == i)
         return true;
+    if (d->stmtId)
+        return d->fetchStreamed(i);
+    // after streaming, result only holds the last row
+    if (i >= d->currentSize || i < d->rowOffset)
+        return false;
     setAt(i);
     return true;
 }
 
+bool QPSQLResultPrivate::fetchStreamed(int i)
+{
+    Q_Q(QPSQLResult);
+    // the rows before the one in result are gone
+    if (i < rowOffset)
+        return false;
+    while (rowOffset + PQntuples(result) <= i) {
+        PGresult *next = privDriver()->getResult(stmtId);
+        if (!next) {
+            stmtId = 0;
+            q->setLastError(QSqlError(QCoreApplication::translate("QPSQLResult", "Unable to fetch row"),
+                                      QCoreApplication::translate("QPSQLResult",
+                                      "The rest of the result was discarded by another query on the connection"),
+                                      QSqlError::StatementError));
+            return false;
+        }
+        const int status = PQresultStatus(next);
+#ifdef QPSQL_HAVE_SINGLE_ROW_MODE
+        if (status == PGRES_SINGLE_TUPLE) {
+            rowOffset += PQntuples(result);
+            PQclear(result);
+            result = next;
+            continue;
+        }
+#endif
+        // the end of the result set, or an error; keep the last row
+        privDriver()->finishQuery(stmtId);
+        stmtId = 0;
+        currentSize = rowOffset + PQntuples(result);
+        if (status != PGRES_TUPLES_OK) {
+            q->setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
+                            "Unable to fetch row"), QSqlError::StatementError, privDriver(), next));
+        }
+        PQclear(next);
+        return false;
+    }
+    q->setAt(i);
+    return true;
+}
+
 bool QPSQLResult::fetchFirst()
 {
     return fetch(0);
@@ -366,7 +548,220 @@ bool QPSQLResult::fetchFirst()
 bool QPSQLResult::fetchLast()
 {
     Q_D(const QPSQLResult);
-    return fetch(PQntuples(d->result) - 1);
+    if (d->stmtId) {
+        while (fetch(at() + 1))
+            ;
+        return at() >= 0;
+    }
+    return fetch(d->currentSize - 1);
+}
+
+static QVariant qPSQLNumeric(const QString &val, QSql::NumericalPrecisionPolicy policy)
+{
+    if (policy == QSql::HighPrecision)
+        return val;
+    QVariant retval;
+    bool convert;
+    double dbl = val.toDouble(&convert);
+    if (policy == QSql::LowPrecisionInt64)
+        retval = (qlonglong)dbl;
+    else if (policy == QSql::LowPrecisionInt32)
+        retval = (int)dbl;
+    else if (policy == QSql::LowPrecisionDouble)
+        retval = dbl;
+    if (!convert)
+        return QVariant();
+    return retval;
+}
+
+/*
+   Binary results are only requested for queries whose columns all have
+   one of these types; the wire format of the others is not decoded.
+ */
+static bool qCanDecodePSQLBinary(int ptype, bool integerDatetimes)
+{
+    switch (ptype) {
+    case QBOOLOID:
+    case QINT2OID:
+    case QINT4OID:
+    case QINT8OID:
+    case QFLOAT4OID:
+    case QFLOAT8OID:
+    case QNUMERICOID:
+    case QDATEOID:
+    case QBYTEAOID:
+    case QNAMEOID:
+    case QTEXTOID:
+    case QBPCHAROID:
+    case QVARCHAROID:
+        return true;
+    case QTIMEOID:
+    case QTIMESTAMPOID:
+    case QTIMESTAMPTZOID:
+        // servers built without integer datetimes send floating point seconds
+        return integerDatetimes;
+    }
+    return false;
+}
+
+// the size of the fixed-width binary formats, or -1 for the others
+static int qPSQLBinarySize(int ptype)
+{
+    switch (ptype) {
+    case QBOOLOID:
+        return 1;
+    case QINT2OID:
+        return 2;
+    case QINT4OID:
+    case QFLOAT4OID:
+    case QDATEOID:
+        return 4;
+    case QINT8OID:
+    case QFLOAT8OID:
+    case QTIMEOID:
+    case QTIMESTAMPOID:
+    case QTIMESTAMPTZOID:
+        return 8;
+    }
+    return -1;
+}
+
+static inline bool qIsValidPSQLBinary(int len, int ptype)
+{
+    const int size = qPSQLBinarySize(ptype);
+    return size < 0 || len == size;
+}
+
+static inline qint64 qPSQLBinaryInt(const char *val, int ptype)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(val);
+    switch (ptype) {
+    case QBOOLOID:
+        return val[0] != 0;
+    case QINT2OID:
+        return qFromBigEndian<qint16>(p);
+    case QINT8OID:
+        return qFromBigEndian<qint64>(p);
+    }
+    return qFromBigEndian<qint32>(p);
+}
+
+static inline double qPSQLBinaryDouble(const char *val, int ptype)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(val);
+    if (ptype == QFLOAT4OID) {
+        const quint32 bits = qFromBigEndian<quint32>(p);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+    const quint64 bits = qFromBigEndian<quint64>(p);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// converts the binary NUMERIC format (base 10000 digits) to its text form
+static QString qPSQLBinaryNumeric(const char *val, int len)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(val);
+    if (len < 8)
+        return QString();
+    const int ndigits = qFromBigEndian<qint16>(p);
+    const int weight = qFromBigEndian<qint16>(p + 2);
+    const quint16 sign = qFromBigEndian<quint16>(p + 4);
+    const int dscale = qFromBigEndian<quint16>(p + 6);
+    if (sign == 0xC000)
+        return QStringLiteral("NaN");
+    if (sign == 0xD000)
+        return QStringLiteral("Infinity");
+    if (sign == 0xF000)
+        return QStringLiteral("-Infinity");
+    if (ndigits < 0 || len < 8 + 2 * ndigits)
+        return QString();
+
+    QString str;
+    str.reserve(4 * (qMax(weight, 0) + 1) + dscale + 2);
+    if (sign == 0x4000)
+        str += QLatin1Char('-');
+    if (weight < 0) {
+        str += QLatin1Char('0');
+    } else {
+        for (int i = 0; i <= weight; ++i) {
+            const int digit = i < ndigits ? qFromBigEndian<qint16>(p + 8 + 2 * i) : 0;
+            if (i == 0)
+                str += QString::number(digit);
+            else
+                str += QString::number(digit).rightJustified(4, QLatin1Char('0'));
+        }
+    }
+    if (dscale > 0) {
+        QString fraction;
+        for (int i = weight + 1; fraction.size() < dscale; ++i) {
+            const int digit = (i >= 0 && i < ndigits) ? qFromBigEndian<qint16>(p + 8 + 2 * i) : 0;
+            fraction += QString::number(digit).rightJustified(4, QLatin1Char('0'));
+        }
+        fraction.truncate(dscale);
+        str += QLatin1Char('.') + fraction;
+    }
+    return str;
+}
+
+static QVariant qDecodePSQLBinary(const char *val, int len, int ptype,
+                                  QSql::NumericalPrecisionPolicy policy, bool isUtf8)
+{
+    // dates and times count from 2000-01-01
+    static const qint64 usecsPerDay = Q_INT64_C(86400000000);
+    const QDate epoch(2000, 1, 1);
+    const uchar *p = reinterpret_cast<const uchar *>(val);
+    if (!qIsValidPSQLBinary(len, ptype)) {
+        qWarning("QPSQLResult::data: unexpected size %d for binary type %d", len, ptype);
+        return QVariant(qDecodePSQLType(ptype));
+    }
+
+    switch (ptype) {
+    case QBOOLOID:
+        return QVariant(bool(val[0]));
+    case QINT2OID:
+    case QINT4OID:
+        return QVariant(int(qPSQLBinaryInt(val, ptype)));
+    case QINT8OID:
+        return QVariant(qlonglong(qPSQLBinaryInt(val, ptype)));
+    case QFLOAT4OID:
+    case QFLOAT8OID:
+        return QVariant(qPSQLBinaryDouble(val, ptype));
+    case QNUMERICOID:
+        return qPSQLNumeric(qPSQLBinaryNumeric(val, len), policy);
+    case QDATEOID: {
+        const qint32 days = qFromBigEndian<qint32>(p);
+        // +-infinity
+        if (days == std::numeric_limits<qint32>::max() || days == std::numeric_limits<qint32>::min())
+            return QVariant(QDate());
+        return QVariant(epoch.addDays(days));
+    }
+    case QTIMEOID:
+        return QVariant(QTime(0, 0).addMSecs(int(qFromBigEndian<qint64>(p) / 1000)));
+    case QTIMESTAMPOID:
+    case QTIMESTAMPTZOID: {
+        const qint64 usecs = qFromBigEndian<qint64>(p);
+        if (usecs == std::numeric_limits<qint64>::max() || usecs == std::numeric_limits<qint64>::min())
+            return QVariant(QDateTime());
+        qint64 days = usecs / usecsPerDay;
+        qint64 rest = usecs % usecsPerDay;
+        if (rest < 0) {
+            rest += usecsPerDay;
+            --days;
+        }
+        if (ptype == QTIMESTAMPTZOID) {
+            const QDateTime utc(epoch.addDays(days), QTime(0, 0).addMSecs(int(rest / 1000)), Qt::UTC);
+            return QVariant(utc.toLocalTime());
+        }
+        return QVariant(QDateTime(epoch.addDays(days), QTime(0, 0).addMSecs(int(rest / 1000))));
+    }
+    case QBYTEAOID:
+        return QVariant(QByteArray(val, len));
+    }
+    return isUtf8 ? QString::fromUtf8(val, len) : QString::fromLatin1(val, len);
 }
 
 QVariant QPSQLResult::data(int i)
@@ -376,11 +771,16 @@ QVariant QPSQLResult::data(int i)
         qWarning("QPSQLResult::data: column %d out of range", i);
         return QVariant();
     }
+    const int row = at() - d->rowOffset;
     int ptype = PQftype(d->result, i);
     QVariant::Type type = qDecodePSQLType(ptype);
-    const char *val = PQgetvalue(d->result, at(), i);
-    if (PQgetisnull(d->result, at(), i))
+    const char *val = PQgetvalue(d->result, row, i);
+    if (PQgetisnull(d->result, row, i))
         return QVariant(type);
+    if (PQfformat(d->result, i) == 1) {
+        return qDecodePSQLBinary(val, PQgetlength(d->result, row, i), ptype,
+                                 numericalPrecisionPolicy(), d->privDriver()->isUtf8);
+    }
     switch (type) {
     case QVariant::Bool:
         return QVariant((bool)(val[0] == 't'));
@@ -394,23 +794,8 @@ QVariant QPSQLResult::data(int i)
     case QVariant::Int:
         return atoi(val);
     case QVariant::Double:
-        if (ptype == QNUMERICOID) {
-            if (numericalPrecisionPolicy() != QSql::HighPrecision) {
-                QVariant retval;
-                bool convert;
-                double dbl=QString::fromLatin1(val).toDouble(&convert);
-                if (numericalPrecisionPolicy() == QSql::LowPrecisionInt64)
-                    retval = (qlonglong)dbl;
-                else if (numericalPrecisionPolicy() == QSql::LowPrecisionInt32)
-                    retval = (int)dbl;
-                else if (numericalPrecisionPolicy() == QSql::LowPrecisionDouble)
-                    retval = dbl;
-                if (!convert)
-                    return QVariant();
-                return retval;
-            }
-            return QString::fromLatin1(val);
-        }
+        if (ptype == QNUMERICOID)
+            return qPSQLNumeric(QString::fromLatin1(val), numericalPrecisionPolicy());
         return QString::fromLatin1(val).toDouble();
     case QVariant::Date:
         if (val[0] == '\0') {
@@ -461,11 +846,121 @@ QVariant QPSQLResult::data(int i)
     return QVariant();
 }
 
+static inline qint64 qParsePSQLInt(const char *val)
+{
+    const bool negative = *val == '-';
+    if (negative)
+        ++val;
+    quint64 n = 0;
+    for (; *val >= '0' && *val <= '9'; ++val)
+        n = n * 10 + (*val - '0');
+    return negative ? -qint64(n) : qint64(n);
+}
+
+static inline double qParsePSQLDouble(const char *val)
+{
+    // the server spells out the special values, which qstrtod() does not know
+    if (qstrcmp(val, "NaN") == 0)
+        return qQNaN();
+    if (qstrcmp(val, "Infinity") == 0)
+        return qInf();
+    if (qstrcmp(val, "-Infinity") == 0)
+        return -qInf();
+    return qstrtod(val, 0, 0);
+}
+
+int QPSQLResult::fetchBatch(QSqlColumnBatch *batch, int maxRows)
+{
+    Q_D(QPSQLResult);
+    QSqlColumnBatchPrivate *b = QSqlColumnBatchPrivate::get(batch);
+    b->reset(record(), maxRows, numericalPrecisionPolicy());
+    const int columns = b->columns.size();
+    const bool utf8 = d->privDriver()->isUtf8;
+
+    // the storage follows data(): NUMERIC is only converted when the
+    // precision policy asks for it, the float types never are
+    QVector<int> ptypes(columns);
+    QVector<bool> binary(columns);
+    for (int i = 0; i < columns; ++i) {
+        const int ptype = PQftype(d->result, i);
+        ptypes[i] = ptype;
+        binary[i] = PQfformat(d->result, i) == 1;
+        QSqlColumnBatchPrivate::Column &c = b->columns[i];
+        if (ptype == QFLOAT4OID || ptype == QFLOAT8OID)
+            c.type = QSqlColumnBatch::DoubleColumn;
+        else if (ptype == QNUMERICOID && numericalPrecisionPolicy() == QSql::HighPrecision)
+            c.type = QSqlColumnBatch::StringColumn;
+    }
+
+    if (at() == QSql::AfterLastRow) {
+        b->finish();
+        return 0;
+    }
+    int rows = 0;
+    // fetch() receives the next row when the query is streamed
+    while (rows < maxRows && fetch(at() + 1)) {
+        const int row = at() - d->rowOffset;
+        for (int i = 0; i < columns; ++i) {
+            if (PQgetisnull(d->result, row, i)) {
+                b->appendNull(i);
+                continue;
+            }
+            const char *val = PQgetvalue(d->result, row, i);
+            const int len = PQgetlength(d->result, row, i);
+            if (binary.at(i) && !qIsValidPSQLBinary(len, ptypes.at(i))) {
+                qWarning("QPSQLResult::fetchBatch: unexpected size %d for binary type %d", len, ptypes.at(i));
+                b->appendNull(i);
+                continue;
+            }
+            switch (b->columns.at(i).type) {
+            case QSqlColumnBatch::Int64Column:
+                if (ptypes.at(i) == QNUMERICOID)
+                    b->appendInt64(i, qint64(binary.at(i) ? qPSQLBinaryNumeric(val, len).toDouble()
+                                                          : qParsePSQLDouble(val)));
+                else if (binary.at(i))
+                    b->appendInt64(i, qPSQLBinaryInt(val, ptypes.at(i)));
+                else if (ptypes.at(i) == QBOOLOID)
+                    b->appendInt64(i, val[0] == 't');
+                else
+                    b->appendInt64(i, qParsePSQLInt(val));
+                break;
+            case QSqlColumnBatch::DoubleColumn:
+                if (ptypes.at(i) == QNUMERICOID && binary.at(i))
+                    b->appendDouble(i, qPSQLBinaryNumeric(val, len).toDouble());
+                else if (binary.at(i))
+                    b->appendDouble(i, qPSQLBinaryDouble(val, ptypes.at(i)));
+                else
+                    b->appendDouble(i, qParsePSQLDouble(val));
+                break;
+            case QSqlColumnBatch::StringColumn:
+                if (ptypes.at(i) == QNUMERICOID)
+                    b->appendString(i, binary.at(i) ? qPSQLBinaryNumeric(val, len)
+                                                    : QString::fromLatin1(val, len));
+                else if (utf8)
+                    b->appendString(i, QString::fromUtf8(val, len));
+                else
+                    b->appendString(i, QString::fromLatin1(val, len));
+                break;
+            case QSqlColumnBatch::VariantColumn:
+                b->appendValue(i, data(i));
+                break;
+            }
+        }
+        ++rows;
+    }
+    b->finish();
+
+    if (rows < maxRows)
+        setAt(QSql::AfterLastRow);
+    return rows;
+}
+
 bool QPSQLResult::isNull(int field)
 {
     Q_D(const QPSQLResult);
-    PQgetvalue(d->result, at(), field);
-    return PQgetisnull(d->result, at(), field);
+    const int row = at() - d->rowOffset;
+    PQgetvalue(d->result, row, field);
+    return PQgetisnull(d->result, row, field);
 }
 
 bool QPSQLResult::reset (const QString& query)
@@ -476,8 +971,28 @@ bool QPSQLResult::reset (const QString& query)
         return false;
     if (!driver()->isOpen() || driver()->isOpenError())
         return false;
-    d->result = d->privDriver()->exec(query);
-    return d->processResults();
+    return d->execute(query, false);
+}
+
+bool QPSQLResultPrivate::execute(const QString &stmt, bool binary)
+{
+#ifdef QPSQL_HAVE_SINGLE_ROW_MODE
+    Q_Q(QPSQLResult);
+    if (q->isForwardOnly() && privDriver()->singleRowMode) {
+        // receive the rows one at a time instead of the whole result at once
+        stmtId = privDriver()->sendQuery(stmt, binary);
+        if (!stmtId) {
+            q->setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
+                            "Unable to create query"), QSqlError::StatementError, privDriver()));
+            return false;
+        }
+        PQsetSingleRowMode(privDriver()->connection);
+        result = privDriver()->getResult(stmtId);
+        return processResults();
+    }
+#endif
+    result = privDriver()->exec(stmt, binary);
+    return processResults();
 }
 
 int QPSQLResult::size()
@@ -563,6 +1078,11 @@ void QPSQLResult::virtual_hook(int id, void *data)
 {
     Q_ASSERT(data);
 
+    if (id == FetchBatchOperation) {
+        QSqlFetchBatchData *args = static_cast<QSqlFetchBatchData *>(data);
+        args->rows = fetchBatch(args->batch, args->maxRows);
+        return;
+    }
     QSqlResult::virtual_hook(id, data);
 }
 
@@ -624,6 +1144,23 @@ bool QPSQLResult::prepare(const QString &query)
 
     PQclear(result);
     d->preparedStmtId = stmtId;
+
+    d->binaryResults = false;
+#ifdef QPSQL_HAVE_DESCRIBE_PREPARED
+    if (d->privDriver()->binaryResults) {
+        // use binary results only if every column can be decoded
+        const QPSQLDriverPrivate *drv = d->privDriver();
+        const bool integerDatetimes = qstrcmp(PQparameterStatus(drv->connection, "integer_datetimes"), "on") == 0;
+        PGresult *description = PQdescribePrepared(drv->connection, stmtId.toLatin1().constData());
+        if (PQresultStatus(description) == PGRES_COMMAND_OK) {
+            const int count = PQnfields(description);
+            d->binaryResults = count > 0;
+            for (int i = 0; i < count && d->binaryResults; ++i)
+                d->binaryResults = qCanDecodePSQLBinary(PQftype(description, i), integerDatetimes);
+        }
+        PQclear(description);
+    }
+#endif
     return true;
 }
 
@@ -642,9 +1179,7 @@ bool QPSQLResult::exec()
     else
         stmt = QString::fromLatin1("EXECUTE %1 (%2)").arg(d->preparedStmtId).arg(params);
 
-    d->result = d->privDriver()->exec(stmt);
-
-    return d->processResults();
+    return d->execute(stmt, d->binaryResults);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -793,6 +1328,7 @@ QPSQLDriver::QPSQLDriver(PGconn *conn, QObject *parent)
     Q_D(QPSQLDriver);
     d->connection = conn;
     if (conn) {
+        d->cancel = PQgetCancel(conn);
         d->pro = d->getPSQLVersion();
         d->detectBackslashEscape();
         setOpen(true);
@@ -803,6 +1339,8 @@ QPSQLDriver::QPSQLDriver(PGconn *conn, QObject *parent)
 QPSQLDriver::~QPSQLDriver()
 {
     Q_D(QPSQLDriver);
+    if (d->cancel)
+        PQfreeCancel(d->cancel);
     if (d->connection)
         PQfinish(d->connection);
 }
@@ -877,13 +1415,24 @@ bool QPSQLDriver::open(const QString & db,
     if (port != -1)
         connectString.append(QLatin1String(" port=")).append(qQuote(QString::number(port)));
 
-    // add any connect options - the server will handle error detection
-    if (!connOpts.isEmpty()) {
-        QString opt = connOpts;
-        opt.replace(QLatin1Char(';'), QLatin1Char(' '), Qt::CaseInsensitive);
-        connectString.append(QLatin1Char(' ')).append(opt);
+    // take out the options of the driver, libpq rejects unknown ones
+    bool singleRowMode = false;
+    bool binaryResults = false;
+    QStringList opts;
+    foreach (const QString &option, connOpts.split(QLatin1Char(';'), QString::SkipEmptyParts)) {
+        const QString trimmed = option.trimmed();
+        if (trimmed == QLatin1String("QPSQL_SINGLE_ROW_MODE"))
+            singleRowMode = true;
+        else if (trimmed == QLatin1String("QPSQL_BINARY_RESULTS"))
+            binaryResults = true;
+        else
+            opts.append(option);
     }
 
+    // add any connect options - the server will handle error detection
+    if (!opts.isEmpty())
+        connectString.append(QLatin1Char(' ')).append(opts.join(QLatin1Char(' ')));
+
     d->connection = PQconnectdb(connectString.toLocal8Bit().constData());
     if (PQstatus(d->connection) == CONNECTION_BAD) {
         setLastError(qMakeError(tr("Unable to connect"), QSqlError::ConnectionError, d));
@@ -893,10 +1442,13 @@ bool QPSQLDriver::open(const QString & db,
         return false;
     }
 
+    d->cancel = PQgetCancel(d->connection);
     d->pro = d->getPSQLVersion();
     d->detectBackslashEscape();
     d->isUtf8 = d->setEncodingUtf8();
     d->setDatestyle();
+    d->singleRowMode = singleRowMode;
+    d->binaryResults = binaryResults;
 
     setOpen(true);
     setOpenError(false);
@@ -915,9 +1467,13 @@ void QPSQLDriver::close()
             d->sn = 0;
         }
 
+        if (d->cancel)
+            PQfreeCancel(d->cancel);
+        d->cancel = 0;
         if (d->connection)
             PQfinish(d->connection);
         d->connection = 0;
+        d->currentStmtId = 0;
         setOpen(false);
         setOpenError(false);
     }
@@ -928,6 +1484,135 @@ QSqlResult *QPSQLDriver::createResult() const
     return new QPSQLResult(this);
 }
 
+/*
+   Asks the server to cancel the query that is running on the connection,
+   which then fails with an error. Unlike the rest of the driver, this may
+   be called from any thread while the connection is open.
+
+   Like copyFrom(), this is not part of the QSqlDriver API and has to be
+   called through the meta object, with Qt::DirectConnection when called
+   from another thread.
+ */
+void QPSQLDriver::interrupt()
+{
+    Q_D(QPSQLDriver);
+    if (d->cancel) {
+        char error[256];
+        PQcancel(d->cancel, error, sizeof(error));
+    }
+}
+
+/*
+   Runs statement, which must be a COPY ... FROM STDIN, and sends the
+   content of device to the server until device has no more data. The
+   data must be in the format the statement asks for, in the client
+   encoding of the connection.
+
+   Like copyTo(), this is not part of the QSqlDriver API and has to be
+   called through the meta object:
+
+   QMetaObject::invokeMethod(db.driver(), "copyFrom", Q_RETURN_ARG(bool, ok),
+                             Q_ARG(QString, statement), Q_ARG(QIODevice*, device));
+ */
+bool QPSQLDriver::copyFrom(const QString &statement, QIODevice *device)
+{
+    Q_D(QPSQLDriver);
+    if (!isOpen() || isOpenError())
+        return false;
+    if (!device || !device->isReadable()) {
+        setLastError(QSqlError(tr("Unable to copy data"), tr("The device is not readable"),
+                               QSqlError::StatementError));
+        return false;
+    }
+
+    PGresult *result = d->exec(statement);
+    if (PQresultStatus(result) != PGRES_COPY_IN) {
+        setLastError(qMakeError(tr("Unable to copy data"), QSqlError::StatementError, d, result));
+        PQclear(result);
+        return false;
+    }
+    PQclear(result);
+
+    QByteArray buffer(64 * 1024, Qt::Uninitialized);
+    QByteArray readError;
+    forever {
+        const qint64 read = device->read(buffer.data(), buffer.size());
+        if (read < 0) {
+            readError = device->errorString().toUtf8();
+            break;
+        }
+        if (read == 0) {
+            if (device->isSequential() && device->waitForReadyRead(-1))
+                continue;
+            break;
+        }
+        // only fails when the connection is lost, which PQgetResult() reports
+        if (PQputCopyData(d->connection, buffer.constData(), int(read)) != 1)
+            break;
+    }
+    // a message makes the server fail the COPY
+    PQputCopyEnd(d->connection, readError.isNull() ? 0 : readError.constData());
+
+    bool ok = true;
+    while ((result = PQgetResult(d->connection))) {
+        if (ok && PQresultStatus(result) != PGRES_COMMAND_OK) {
+            setLastError(qMakeError(tr("Unable to copy data"), QSqlError::StatementError, d, result));
+            ok = false;
+        }
+        PQclear(result);
+    }
+    return ok;
+}
+
+/*
+   Runs statement, which must be a COPY ... TO STDOUT, and writes the data
+   the server sends to device.
+ */
+bool QPSQLDriver::copyTo(const QString &statement, QIODevice *device)
+{
+    Q_D(QPSQLDriver);
+    if (!isOpen() || isOpenError())
+        return false;
+    if (!device || !device->isWritable()) {
+        setLastError(QSqlError(tr("Unable to copy data"), tr("The device is not writable"),
+                               QSqlError::StatementError));
+        return false;
+    }
+
+    PGresult *result = d->exec(statement);
+    if (PQresultStatus(result) != PGRES_COPY_OUT) {
+        setLastError(qMakeError(tr("Unable to copy data"), QSqlError::StatementError, d, result));
+        PQclear(result);
+        return false;
+    }
+    PQclear(result);
+
+    // the rows have to be received even if writing fails
+    bool writeFailed = false;
+    char *buffer = 0;
+    int size;
+    while ((size = PQgetCopyData(d->connection, &buffer, 0)) > 0) {
+        if (!writeFailed && device->write(buffer, size) != size)
+            writeFailed = true;
+        qPQfreemem(buffer);
+    }
+
+    bool ok = true;
+    while ((result = PQgetResult(d->connection))) {
+        if (ok && PQresultStatus(result) != PGRES_COMMAND_OK) {
+            setLastError(qMakeError(tr("Unable to copy data"), QSqlError::StatementError, d, result));
+            ok = false;
+        }
+        PQclear(result);
+    }
+    if (ok && writeFailed) {
+        setLastError(QSqlError(tr("Unable to copy data"), device->errorString(),
+                               QSqlError::StatementError));
+        ok = false;
+    }
+    return ok;
+}
+
 bool QPSQLDriver::beginTransaction()
 {
     Q_D(const QPSQLDriver);
@@ -47,6 +47,7 @@
 
 #include <QtSql/qsqlresult.h>
 #include <QtSql/qsqldriver.h>
+#include <QtCore/qiodevice.h>
 
 #ifdef QT_PLUGIN
 #define Q_EXPORT_SQLDRIVER_PSQL
@@ -62,6 +63,7 @@ QT_BEGIN_NAMESPACE
 class QPSQLResultPrivate;
 class QPSQLDriver;
 class QSqlRecordInfo;
+class QSqlColumnBatch;
 
 class QPSQLResult : public QSqlResult
 {
@@ -88,6 +90,9 @@ protected:
     QVariant lastInsertId() const Q_DECL_OVERRIDE;
     bool prepare(const QString& query) Q_DECL_OVERRIDE;
     bool exec() Q_DECL_OVERRIDE;
+
+private:
+    int fetchBatch(QSqlColumnBatch *batch, int maxRows);
 };
 
 class QPSQLDriverPrivate;
@@ -141,6 +146,10 @@ public:
     bool unsubscribeFromNotification(const QString &name) Q_DECL_OVERRIDE;
     QStringList subscribedToNotifications() const Q_DECL_OVERRIDE;
 
+    Q_INVOKABLE void interrupt();
+    Q_INVOKABLE bool copyFrom(const QString &statement, QIODevice *device);
+    Q_INVOKABLE bool copyTo(const QString &statement, QIODevice *device);
+
 protected:
     bool beginTransaction() Q_DECL_OVERRIDE;
     bool commitTransaction() Q_DECL_OVERRIDE;
@@ -33,6 +33,7 @@
 
 #include "qsql_sqlite_p.h"
 
+#include <qcache.h>
 #include <qcoreapplication.h>
 #include <qdatetime.h>
 #include <qvariant.h>
@@ -41,6 +42,7 @@
 #include <qsqlindex.h>
 #include <qsqlquery.h>
 #include <QtSql/private/qsqlcachedresult_p.h>
+#include <QtSql/private/qsqlcolumnbatch_p.h>
 #include <QtSql/private/qsqldriver_p.h>
 #include <qstringlist.h>
 #include <qvector.h>
@@ -123,17 +125,42 @@ protected:
     QSqlRecord record() const Q_DECL_OVERRIDE;
     void detachFromResultSet() Q_DECL_OVERRIDE;
     void virtual_hook(int id, void *data) Q_DECL_OVERRIDE;
+    bool execBatch(bool arrayBind = false) Q_DECL_OVERRIDE;
 
 private:
+    int fetchBatch(QSqlColumnBatch *batch, int maxRows);
+
     QSQLiteResultPrivate* d;
 };
 
+// a prepared statement that is not used by any result
+struct QSQLiteCachedStatement
+{
+    explicit QSQLiteCachedStatement(sqlite3_stmt *stmt) : stmt(stmt) {}
+    ~QSQLiteCachedStatement() { sqlite3_finalize(stmt); }
+
+    sqlite3_stmt *stmt;
+};
+
 class QSQLiteDriverPrivate : public QSqlDriverPrivate
 {
 public:
-    inline QSQLiteDriverPrivate() : QSqlDriverPrivate(), access(0) { dbmsType = QSqlDriver::SQLite; }
+    inline QSQLiteDriverPrivate() : QSqlDriverPrivate(), access(0), batchTransactions(false)
+    {
+        dbmsType = QSqlDriver::SQLite;
+        statements.setMaxCost(defaultStatementCacheSize);
+    }
+
+    enum { defaultStatementCacheSize = 32 };
+
     sqlite3 *access;
     QList <QSQLiteResult *> results;
+    // statements keyed by their SQL text, so that preparing the same
+    // query again skips sqlite3_prepare16_v2(); the least recently
+    // used one is finalized when the cache is full
+    QCache<QString, QSQLiteCachedStatement> statements;
+    // wrap execBatch() in a transaction when none is open
+    bool batchTransactions;
 };
 
 
@@ -143,6 +170,12 @@ public:
     QSQLiteResultPrivate(QSQLiteResult *res);
     void cleanup();
     bool fetchNext(QSqlCachedResult::ValueCache &values, int idx, bool initialFetch);
+    // the value of column i of the current row
+    QVariant value(int i) const;
+    // handles a sqlite3_step() result other than SQLITE_ROW
+    bool stepFailed(int res);
+    int bindValue(int index, const QVariant &value);
+    QSQLiteDriverPrivate *driverPrivate() const;
     // initializes the recordInfo and the cache
     void initColumns(bool emptyResultset);
     void finalize();
@@ -151,6 +184,9 @@ public:
     sqlite3 *access;
 
     sqlite3_stmt *stmt;
+    QString query; // the SQL text stmt was prepared from
+    bool cacheable; // return stmt to the statement cache in finalize()?
+    int batchRowsAffected; // the rows changed by execBatch(), or -1
 
     bool skippedStatus; // the status of the fetchNext() that's skipped
     bool skipRow; // skip the next fetchNext()?
@@ -159,10 +195,16 @@ public:
 };
 
 QSQLiteResultPrivate::QSQLiteResultPrivate(QSQLiteResult* res) : q(res), access(0),
-    stmt(0), skippedStatus(false), skipRow(false)
+    stmt(0), cacheable(false), batchRowsAffected(-1), skippedStatus(false), skipRow(false)
 {
 }
 
+QSQLiteDriverPrivate *QSQLiteResultPrivate::driverPrivate() const
+{
+    const QSQLiteDriver *driver = static_cast<const QSQLiteDriver *>(q->driver());
+    return driver ? const_cast<QSQLiteDriverPrivate *>(driver->d_func()) : 0;
+}
+
 void QSQLiteResultPrivate::cleanup()
 {
     finalize();
@@ -179,8 +221,17 @@ void QSQLiteResultPrivate::finalize()
     if (!stmt)
         return;
 
-    sqlite3_finalize(stmt);
+    QSQLiteDriverPrivate *drv = cacheable ? driverPrivate() : 0;
+    if (drv && drv->access) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        // deletes the statement right away if the cache is disabled
+        drv->statements.insert(query, new QSQLiteCachedStatement(stmt));
+    } else {
+        sqlite3_finalize(stmt);
+    }
     stmt = 0;
+    cacheable = false;
 }
 
 void QSQLiteResultPrivate::initColumns(bool emptyResultset)
@@ -261,51 +312,51 @@ bool QSQLiteResultPrivate::fetchNext(QSqlCachedResult::ValueCache &values, int i
         return false;
     }
     res = sqlite3_step(stmt);
+    if (res != SQLITE_ROW)
+        return stepFailed(res);
+
+    // check to see if should fill out columns
+    if (rInf.isEmpty())
+        // must be first call.
+        initColumns(false);
+    if (idx < 0 && !initialFetch)
+        return true;
+    for (i = 0; i < rInf.count(); ++i)
+        values[i + idx] = value(i);
+    return true;
+}
 
-    switch(res) {
-    case SQLITE_ROW:
-        // check to see if should fill out columns
-        if (rInf.isEmpty())
-            // must be first call.
-            initColumns(false);
-        if (idx < 0 && !initialFetch)
-            return true;
-        for (i = 0; i < rInf.count(); ++i) {
-            switch (sqlite3_column_type(stmt, i)) {
-            case SQLITE_BLOB:
-                values[i + idx] = QByteArray(static_cast<const char *>(
-                            sqlite3_column_blob(stmt, i)),
-                            sqlite3_column_bytes(stmt, i));
-                break;
-            case SQLITE_INTEGER:
-                values[i + idx] = sqlite3_column_int64(stmt, i);
-                break;
-            case SQLITE_FLOAT:
-                switch(q->numericalPrecisionPolicy()) {
-                    case QSql::LowPrecisionInt32:
-                        values[i + idx] = sqlite3_column_int(stmt, i);
-                        break;
-                    case QSql::LowPrecisionInt64:
-                        values[i + idx] = sqlite3_column_int64(stmt, i);
-                        break;
-                    case QSql::LowPrecisionDouble:
-                    case QSql::HighPrecision:
-                    default:
-                        values[i + idx] = sqlite3_column_double(stmt, i);
-                        break;
-                };
-                break;
-            case SQLITE_NULL:
-                values[i + idx] = QVariant(QVariant::String);
-                break;
-            default:
-                values[i + idx] = QString(reinterpret_cast<const QChar *>(
-                            sqlite3_column_text16(stmt, i)),
-                            sqlite3_column_bytes16(stmt, i) / sizeof(QChar));
-                break;
-            }
+QVariant QSQLiteResultPrivate::value(int i) const
+{
+    switch (sqlite3_column_type(stmt, i)) {
+    case SQLITE_BLOB:
+        return QByteArray(static_cast<const char *>(sqlite3_column_blob(stmt, i)),
+                          sqlite3_column_bytes(stmt, i));
+    case SQLITE_INTEGER:
+        return sqlite3_column_int64(stmt, i);
+    case SQLITE_FLOAT:
+        switch(q->numericalPrecisionPolicy()) {
+        case QSql::LowPrecisionInt32:
+            return sqlite3_column_int(stmt, i);
+        case QSql::LowPrecisionInt64:
+            return sqlite3_column_int64(stmt, i);
+        case QSql::LowPrecisionDouble:
+        case QSql::HighPrecision:
+        default:
+            return sqlite3_column_double(stmt, i);
         }
-        return true;
+    case SQLITE_NULL:
+        return QVariant(QVariant::String);
+    default:
+        break;
+    }
+    return QString(reinterpret_cast<const QChar *>(sqlite3_column_text16(stmt, i)),
+                   sqlite3_column_bytes16(stmt, i) / sizeof(QChar));
+}
+
+bool QSQLiteResultPrivate::stepFailed(int res)
+{
+    switch(res) {
     case SQLITE_DONE:
         if (rInf.isEmpty())
             // must be first call.
@@ -335,6 +386,61 @@ bool QSQLiteResultPrivate::fetchNext(QSqlCachedResult::ValueCache &values, int i
     return false;
 }
 
+int QSQLiteResultPrivate::bindValue(int index, const QVariant &value)
+{
+    int res = SQLITE_OK;
+
+    if (value.isNull()) {
+        res = sqlite3_bind_null(stmt, index);
+    } else {
+        switch (value.type()) {
+        case QVariant::ByteArray: {
+            const QByteArray *ba = static_cast<const QByteArray*>(value.constData());
+            res = sqlite3_bind_blob(stmt, index, ba->constData(),
+                                    ba->size(), SQLITE_STATIC);
+            break; }
+        case QVariant::Int:
+        case QVariant::Bool:
+            res = sqlite3_bind_int(stmt, index, value.toInt());
+            break;
+        case QVariant::Double:
+            res = sqlite3_bind_double(stmt, index, value.toDouble());
+            break;
+        case QVariant::UInt:
+        case QVariant::LongLong:
+            res = sqlite3_bind_int64(stmt, index, value.toLongLong());
+            break;
+        case QVariant::DateTime: {
+            const QDateTime dateTime = value.toDateTime();
+            const QString str = dateTime.toString(QStringLiteral("yyyy-MM-ddThh:mm:ss.zzz"));
+            res = sqlite3_bind_text16(stmt, index, str.utf16(),
+                                      str.size() * sizeof(ushort), SQLITE_TRANSIENT);
+            break;
+        }
+        case QVariant::Time: {
+            const QTime time = value.toTime();
+            const QString str = time.toString(QStringLiteral("hh:mm:ss.zzz"));
+            res = sqlite3_bind_text16(stmt, index, str.utf16(),
+                                      str.size() * sizeof(ushort), SQLITE_TRANSIENT);
+            break;
+        }
+        case QVariant::String: {
+            // lifetime of string == lifetime of its qvariant
+            const QString *str = static_cast<const QString*>(value.constData());
+            res = sqlite3_bind_text16(stmt, index, str->utf16(),
+                                      (str->size()) * sizeof(QChar), SQLITE_STATIC);
+            break; }
+        default: {
+            QString str = value.toString();
+            // SQLITE_TRANSIENT makes sure that sqlite buffers the data
+            res = sqlite3_bind_text16(stmt, index, str.utf16(),
+                                      (str.size()) * sizeof(QChar), SQLITE_TRANSIENT);
+            break; }
+        }
+    }
+    return res;
+}
+
 QSQLiteResult::QSQLiteResult(const QSQLiteDriver* db)
     : QSqlCachedResult(db)
 {
@@ -354,6 +460,13 @@ QSQLiteResult::~QSQLiteResult()
 
 void QSQLiteResult::virtual_hook(int id, void *data)
 {
+    // a scrollable result has to go through the row cache
+    if (id == FetchBatchOperation && isForwardOnly() && d->stmt && !d->rInf.isEmpty()
+        && at() != QSql::AfterLastRow) {
+        QSqlFetchBatchData *args = static_cast<QSqlFetchBatchData *>(data);
+        args->rows = fetchBatch(args->batch, args->maxRows);
+        return;
+    }
     QSqlCachedResult::virtual_hook(id, data);
 }
 
@@ -370,12 +483,26 @@ bool QSQLiteResult::prepare(const QString &query)
         return false;
 
     d->cleanup();
+    d->batchRowsAffected = -1;
 
     setSelect(false);
 
     const void *pzTail = NULL;
 
 #if (SQLITE_VERSION_NUMBER >= 3003011)
+    // statements from sqlite3_prepare16_v2() recompile themselves when the
+    // schema changes, which makes them safe to keep around
+    if (QSQLiteDriverPrivate *drv = d->driverPrivate()) {
+        if (QSQLiteCachedStatement *cached = drv->statements.take(query)) {
+            d->stmt = cached->stmt;
+            cached->stmt = 0;
+            delete cached;
+            d->query = query;
+            d->cacheable = true;
+            return true;
+        }
+    }
+
     int res = sqlite3_prepare16_v2(d->access, query.constData(), (query.size() + 1) * sizeof(QChar),
                                    &d->stmt, &pzTail);
 #else
@@ -394,6 +521,10 @@ bool QSQLiteResult::prepare(const QString &query)
         d->finalize();
         return false;
     }
+#if (SQLITE_VERSION_NUMBER >= 3003011)
+    d->query = query;
+    d->cacheable = true;
+#endif
     return true;
 }
 
@@ -403,6 +534,7 @@ bool QSQLiteResult::exec()
 
     d->skippedStatus = false;
     d->skipRow = false;
+    d->batchRowsAffected = -1;
     d->rInf.clear();
     clearValues();
     setLastError(QSqlError());
@@ -417,57 +549,7 @@ bool QSQLiteResult::exec()
     int paramCount = sqlite3_bind_parameter_count(d->stmt);
     if (paramCount == values.count()) {
         for (int i = 0; i < paramCount; ++i) {
-            res = SQLITE_OK;
-            const QVariant value = values.at(i);
-
-            if (value.isNull()) {
-                res = sqlite3_bind_null(d->stmt, i + 1);
-            } else {
-                switch (value.type()) {
-                case QVariant::ByteArray: {
-                    const QByteArray *ba = static_cast<const QByteArray*>(value.constData());
-                    res = sqlite3_bind_blob(d->stmt, i + 1, ba->constData(),
-                                            ba->size(), SQLITE_STATIC);
-                    break; }
-                case QVariant::Int:
-                case QVariant::Bool:
-                    res = sqlite3_bind_int(d->stmt, i + 1, value.toInt());
-                    break;
-                case QVariant::Double:
-                    res = sqlite3_bind_double(d->stmt, i + 1, value.toDouble());
-                    break;
-                case QVariant::UInt:
-                case QVariant::LongLong:
-                    res = sqlite3_bind_int64(d->stmt, i + 1, value.toLongLong());
-                    break;
-                case QVariant::DateTime: {
-                    const QDateTime dateTime = value.toDateTime();
-                    const QString str = dateTime.toString(QStringLiteral("yyyy-MM-ddThh:mm:ss.zzz"));
-                    res = sqlite3_bind_text16(d->stmt, i + 1, str.utf16(),
-                                              str.size() * sizeof(ushort), SQLITE_TRANSIENT);
-                    break;
-                }
-                case QVariant::Time: {
-                    const QTime time = value.toTime();
-                    const QString str = time.toString(QStringLiteral("hh:mm:ss.zzz"));
-                    res = sqlite3_bind_text16(d->stmt, i + 1, str.utf16(),
-                                              str.size() * sizeof(ushort), SQLITE_TRANSIENT);
-                    break;
-                }
-                case QVariant::String: {
-                    // lifetime of string == lifetime of its qvariant
-                    const QString *str = static_cast<const QString*>(value.constData());
-                    res = sqlite3_bind_text16(d->stmt, i + 1, str->utf16(),
-                                              (str->size()) * sizeof(QChar), SQLITE_STATIC);
-                    break; }
-                default: {
-                    QString str = value.toString();
-                    // SQLITE_TRANSIENT makes sure that sqlite buffers the data
-                    res = sqlite3_bind_text16(d->stmt, i + 1, str.utf16(),
-                                              (str.size()) * sizeof(QChar), SQLITE_TRANSIENT);
-                    break; }
-                }
-            }
+            res = d->bindValue(i + 1, values.at(i));
             if (res != SQLITE_OK) {
                 setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
                              "Unable to bind parameters"), QSqlError::StatementError, res));
@@ -491,11 +573,171 @@ bool QSQLiteResult::exec()
     return true;
 }
 
+bool QSQLiteResult::execBatch(bool arrayBind)
+{
+    Q_UNUSED(arrayBind);
+
+    const QVector<QVariant> values = boundValues();
+    if (values.isEmpty())
+        return false;
+
+    d->skippedStatus = false;
+    d->skipRow = false;
+    d->batchRowsAffected = -1;
+    d->rInf.clear();
+    clearValues();
+    setLastError(QSqlError());
+
+    if (!d->stmt)
+        return false;
+    int res = sqlite3_reset(d->stmt);
+    if (res != SQLITE_OK) {
+        setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
+                     "Unable to reset statement"), QSqlError::StatementError, res));
+        d->finalize();
+        return false;
+    }
+
+    // unpack the lists once instead of once per row
+    const int paramCount = values.count();
+    QVector<QVariantList> columns(paramCount);
+    for (int j = 0; j < paramCount; ++j)
+        columns[j] = values.at(j).toList();
+    const int rows = columns.at(0).count();
+    bool mismatch = sqlite3_bind_parameter_count(d->stmt) != paramCount;
+    for (int j = 1; j < paramCount && !mismatch; ++j)
+        mismatch = columns.at(j).count() != rows;
+    if (mismatch) {
+        setLastError(QSqlError(QCoreApplication::translate("QSQLiteResult",
+                        "Parameter count mismatch"), QString(), QSqlError::StatementError));
+        return false;
+    }
+
+    // one transaction for the whole batch instead of one per row
+    const QSQLiteDriverPrivate *drv = d->driverPrivate();
+    const bool transaction = drv && drv->batchTransactions && sqlite3_get_autocommit(d->access);
+    if (transaction) {
+        res = sqlite3_exec(d->access, "BEGIN", 0, 0, 0);
+        if (res != SQLITE_OK) {
+            setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
+                         "Unable to begin transaction"), QSqlError::TransactionError, res));
+            return false;
+        }
+    }
+
+    int changes = 0;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < paramCount && res == SQLITE_OK; ++j)
+            res = d->bindValue(j + 1, columns.at(j).at(i));
+        if (res != SQLITE_OK) {
+            setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
+                         "Unable to bind parameters"), QSqlError::StatementError, res));
+            break;
+        }
+
+        res = sqlite3_step(d->stmt);
+        if (res == SQLITE_DONE || res == SQLITE_ROW)
+            changes += sqlite3_changes(d->access);
+        // after a failed step sqlite3_reset() returns the specific error code
+        res = sqlite3_reset(d->stmt);
+        if (res != SQLITE_OK) {
+            setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
+                         "Unable to execute statement"), QSqlError::StatementError, res));
+            break;
+        }
+    }
+    // the lists go away with this function
+    sqlite3_clear_bindings(d->stmt);
+
+    if (transaction) {
+        if (lastError().isValid()) {
+            sqlite3_exec(d->access, "ROLLBACK", 0, 0, 0);
+        } else {
+            res = sqlite3_exec(d->access, "COMMIT", 0, 0, 0);
+            if (res != SQLITE_OK) {
+                setLastError(qMakeError(d->access, QCoreApplication::translate("QSQLiteResult",
+                             "Unable to commit transaction"), QSqlError::TransactionError, res));
+                sqlite3_exec(d->access, "ROLLBACK", 0, 0, 0);
+            }
+        }
+    }
+
+    if (lastError().isValid()) {
+        setSelect(false);
+        setActive(false);
+        return false;
+    }
+    d->batchRowsAffected = changes;
+    setSelect(false);
+    setActive(true);
+    return true;
+}
+
 bool QSQLiteResult::gotoNext(QSqlCachedResult::ValueCache& row, int idx)
 {
     return d->fetchNext(row, idx, false);
 }
 
+int QSQLiteResult::fetchBatch(QSqlColumnBatch *batch, int maxRows)
+{
+    QSqlColumnBatchPrivate *b = QSqlColumnBatchPrivate::get(batch);
+    b->reset(d->rInf, maxRows, numericalPrecisionPolicy());
+    const int columns = b->columns.size();
+    int rows = 0;
+
+    if (d->skipRow) {
+        // the first row was already stepped to by exec()
+        d->skipRow = false;
+        if (!d->skippedStatus) {
+            setAt(QSql::AfterLastRow);
+            b->finish();
+            return 0;
+        }
+        for (int i = 0; i < columns; ++i)
+            b->appendValue(i, d->firstRow.at(i));
+        ++rows;
+    }
+
+    while (rows < maxRows) {
+        const int res = sqlite3_step(d->stmt);
+        if (res != SQLITE_ROW) {
+            d->stepFailed(res);
+            break;
+        }
+        for (int i = 0; i < columns; ++i) {
+            // The column types follow the declared types, which SQLite
+            // does not enforce; a value of another storage class goes
+            // through value(), like it would with fetchNext().
+            const int storage = sqlite3_column_type(d->stmt, i);
+            const QSqlColumnBatch::ColumnType type = b->columns.at(i).type;
+            if (storage == SQLITE_NULL) {
+                b->appendNull(i);
+            } else if (type == QSqlColumnBatch::Int64Column && storage == SQLITE_INTEGER) {
+                b->appendInt64(i, sqlite3_column_int64(d->stmt, i));
+            } else if (type == QSqlColumnBatch::DoubleColumn && storage == SQLITE_FLOAT) {
+                b->appendDouble(i, sqlite3_column_double(d->stmt, i));
+            } else if (type == QSqlColumnBatch::StringColumn && storage == SQLITE_TEXT) {
+                b->appendString(i, QString(reinterpret_cast<const QChar *>(
+                                    sqlite3_column_text16(d->stmt, i)),
+                                    sqlite3_column_bytes16(d->stmt, i) / sizeof(QChar)));
+            } else {
+                b->appendValue(i, d->value(i));
+            }
+        }
+        ++rows;
+    }
+    b->finish();
+
+    if (rows > 0 && at() != QSql::AfterLastRow) {
+        // keep value() working on the last row fetched
+        QSqlCachedResult::ValueCache &values = cache();
+        for (int i = 0; i < columns; ++i)
+            values[i] = b->value(rows - 1, i);
+        setAt(at() + rows);
+    }
+    return rows;
+}
+
 int QSQLiteResult::size()
 {
     return -1;
@@ -503,6 +745,8 @@ int QSQLiteResult::size()
 
 int QSQLiteResult::numRowsAffected()
 {
+    if (d->batchRowsAffected >= 0)
+        return d->batchRowsAffected;
     return sqlite3_changes(d->access);
 }
 
@@ -567,10 +811,10 @@ bool QSQLiteDriver::hasFeature(DriverFeature f) const
     case SimpleLocking:
     case FinishQuery:
     case LowPrecisionNumbers:
+    case BatchOperations:
         return true;
     case QuerySize:
     case NamedPlaceholders:
-    case BatchOperations:
     case EventNotifications:
     case MultipleResultSets:
     case CancelQuery:
@@ -594,6 +838,8 @@ bool QSQLiteDriver::open(const QString & db, const QString &, const QString &, c
     bool sharedCache = false;
     bool openReadOnlyOption = false;
     bool openUriOption = false;
+    int statementCacheSize = QSQLiteDriverPrivate::defaultStatementCacheSize;
+    bool batchTransactions = false;
 
     const QStringList opts = QString(conOpts).remove(QLatin1Char(' ')).split(QLatin1Char(';'));
     foreach (const QString &option, opts) {
@@ -608,6 +854,13 @@ bool QSQLiteDriver::open(const QString & db, const QString &, const QString &, c
             openUriOption = true;
         } else if (option == QLatin1String("QSQLITE_ENABLE_SHARED_CACHE")) {
             sharedCache = true;
+        } else if (option.startsWith(QLatin1String("QSQLITE_STATEMENT_CACHE_SIZE="))) {
+            bool ok;
+            const int size = option.midRef(29).toInt(&ok);
+            if (ok && size >= 0)
+                statementCacheSize = size;
+        } else if (option == QLatin1String("QSQLITE_BATCH_TRANSACTIONS")) {
+            batchTransactions = true;
         }
     }
 
@@ -619,6 +872,8 @@ bool QSQLiteDriver::open(const QString & db, const QString &, const QString &, c
 
     if (sqlite3_open_v2(db.toUtf8().constData(), &d->access, openMode, NULL) == SQLITE_OK) {
         sqlite3_busy_timeout(d->access, timeOut);
+        d->statements.setMaxCost(statementCacheSize);
+        d->batchTransactions = batchTransactions;
         setOpen(true);
         setOpenError(false);
         return true;
@@ -642,6 +897,8 @@ void QSQLiteDriver::close()
         foreach (QSQLiteResult *result, d->results) {
             result->d->finalize();
         }
+        // sqlite3_close() fails while statements are left
+        d->statements.clear();
 
         if (sqlite3_close(d->access) != SQLITE_OK)
             setLastError(qMakeError(d->access, tr("Error closing database"),
@@ -652,6 +909,19 @@ void QSQLiteDriver::close()
     }
 }
 
+/*
+   Makes the statements that are running on the connection fail with
+   SQLITE_INTERRUPT. Unlike the rest of the driver, this may be called
+   from any thread while the connection is open, through the meta object
+   and with Qt::DirectConnection, since it is not part of the QSqlDriver API.
+ */
+void QSQLiteDriver::interrupt()
+{
+    Q_D(QSQLiteDriver);
+    if (d->access)
+        sqlite3_interrupt(d->access);
+}
+
 QSqlResult *QSQLiteDriver::createResult() const
 {
     return new QSQLiteResult(this);
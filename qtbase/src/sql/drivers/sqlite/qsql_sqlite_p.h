@@ -66,6 +66,7 @@ class Q_EXPORT_SQLDRIVER_SQLITE QSQLiteDriver : public QSqlDriver
     Q_DECLARE_PRIVATE(QSQLiteDriver)
     Q_OBJECT
     friend class QSQLiteResult;
+    friend class QSQLiteResultPrivate;
 public:
     explicit QSQLiteDriver(QObject *parent = 0);
     explicit QSQLiteDriver(sqlite3 *connection, QObject *parent = 0);
@@ -88,6 +89,8 @@ public:
     QSqlIndex primaryIndex(const QString &table) const Q_DECL_OVERRIDE;
     QVariant handle() const Q_DECL_OVERRIDE;
     QString escapeIdentifier(const QString &identifier, IdentifierType) const Q_DECL_OVERRIDE;
+
+    Q_INVOKABLE void interrupt();
 };
 
 QT_END_NAMESPACE
@@ -11,7 +11,12 @@ HEADERS +=      kernel/qsql.h \
                 kernel/qsqlresult.h \
                 kernel/qsqlresult_p.h \
                 kernel/qsqlcachedresult_p.h \
-                kernel/qsqlindex.h
+                kernel/qsqlindex.h \
+                kernel/qsqlcolumnbatch.h \
+                kernel/qsqlcolumnbatch_p.h \
+                kernel/qsqlqueryresultset.h \
+                kernel/qsqlqueryresultset_p.h \
+                kernel/qsqlconnectionpool.h
 
 SOURCES +=      kernel/qsqlquery.cpp \
                 kernel/qsqldatabase.cpp \
@@ -22,5 +27,8 @@ SOURCES +=      kernel/qsqlquery.cpp \
                 kernel/qsqlerror.cpp \
                 kernel/qsqlresult.cpp \
                 kernel/qsqlindex.cpp \
-                kernel/qsqlcachedresult.cpp
+                kernel/qsqlcachedresult.cpp \
+                kernel/qsqlcolumnbatch.cpp \
+                kernel/qsqlqueryresultset.cpp \
+                kernel/qsqlconnectionpool.cpp
 
@@ -0,0 +1,370 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSql module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsqlcolumnbatch.h"
+#include "qsqlcolumnbatch_p.h"
+
+#include "qsqlfield.h"
+
+QT_BEGIN_NAMESPACE
+
+QSqlColumnBatch::ColumnType QSqlColumnBatchPrivate::columnType(QVariant::Type type,
+                                                               QSql::NumericalPrecisionPolicy policy)
+{
+    switch (type) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Bool:
+        return QSqlColumnBatch::Int64Column;
+    case QVariant::Double:
+        if (policy == QSql::LowPrecisionInt32 || policy == QSql::LowPrecisionInt64)
+            return QSqlColumnBatch::Int64Column;
+        return QSqlColumnBatch::DoubleColumn;
+    case QVariant::String:
+        return QSqlColumnBatch::StringColumn;
+    default:
+        break;
+    }
+    return QSqlColumnBatch::VariantColumn;
+}
+
+void QSqlColumnBatchPrivate::reset(const QSqlRecord &record, int maxRows,
+                                   QSql::NumericalPrecisionPolicy policy)
+{
+    const int count = record.count();
+    columns.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const QSqlField field = record.field(i);
+        Column &c = columns[i];
+        c.name = field.name();
+        c.type = columnType(field.type(), policy);
+        // resize(0) keeps the capacity, so a batch that is fetched into
+        // repeatedly does not allocate once it has reached its size
+        c.int64s.resize(0);
+        c.doubles.resize(0);
+        c.strings.clear();
+        c.variants.resize(0);
+        switch (c.type) {
+        case QSqlColumnBatch::Int64Column:
+            c.int64s.reserve(maxRows);
+            break;
+        case QSqlColumnBatch::DoubleColumn:
+            c.doubles.reserve(maxRows);
+            break;
+        case QSqlColumnBatch::StringColumn:
+            c.strings.reserve(maxRows);
+            break;
+        case QSqlColumnBatch::VariantColumn:
+            c.variants.reserve(maxRows);
+            break;
+        }
+        c.nulls.fill(false, maxRows);
+    }
+    rows = 0;
+}
+
+void QSqlColumnBatchPrivate::finish()
+{
+    rows = columns.isEmpty() ? 0 : columns.at(0).size();
+    for (int i = 0; i < columns.size(); ++i)
+        columns[i].nulls.truncate(rows);
+}
+
+void QSqlColumnBatchPrivate::appendValue(int column, const QVariant &value)
+{
+    if (value.isNull()) {
+        appendNull(column);
+        return;
+    }
+    Column &c = columns[column];
+    switch (c.type) {
+    case QSqlColumnBatch::Int64Column:
+        c.int64s.append(value.toLongLong());
+        break;
+    case QSqlColumnBatch::DoubleColumn:
+        c.doubles.append(value.toDouble());
+        break;
+    case QSqlColumnBatch::StringColumn:
+        c.strings.append(value.toString());
+        break;
+    case QSqlColumnBatch::VariantColumn:
+        c.variants.append(value);
+        break;
+    }
+}
+
+QVariant QSqlColumnBatchPrivate::value(int row, int column) const
+{
+    const Column &c = columns.at(column);
+    if (c.nulls.testBit(row))
+        return QVariant();
+    switch (c.type) {
+    case QSqlColumnBatch::Int64Column:
+        return c.int64s.at(row);
+    case QSqlColumnBatch::DoubleColumn:
+        return c.doubles.at(row);
+    case QSqlColumnBatch::StringColumn:
+        return c.strings.at(row);
+    case QSqlColumnBatch::VariantColumn:
+        break;
+    }
+    return c.variants.at(row);
+}
+
+/*!
+    \class QSqlColumnBatch
+    \brief The QSqlColumnBatch class holds a block of rows of a query result, stored by column.
+    \since 5.6
+
+    \ingroup database
+    \ingroup shared
+    \inmodule QtSql
+
+    A QSqlColumnBatch is filled by QSqlQuery::fetchBatch(). Instead of
+    one QVariant per value, each column keeps its values in a single
+    vector of the column's native type, which avoids the per-value
+    allocation and dispatch of QSqlQuery::value() when a large result
+    set is read.
+
+    The storage of a column is chosen from the type of the field in the
+    query's record, see columnType(). Values of an Int64Column are read
+    with int64Column(), of a DoubleColumn with doubleColumn(), of a
+    StringColumn with stringColumn() and of a VariantColumn with
+    variantColumn(). Null values are stored as default-constructed
+    values and are marked in nulls(); use isNull() to tell them apart.
+    value() returns a single value as a QVariant regardless of the
+    column type.
+
+    \code
+    QSqlQuery query("SELECT id, price FROM items");
+    QSqlColumnBatch batch;
+    double total = 0;
+    while (query.fetchBatch(&batch, 1024) > 0) {
+        const QVector<double> prices = batch.doubleColumn(1);
+        for (int i = 0; i < prices.size(); ++i)
+            total += prices.at(i);
+    }
+    \endcode
+
+    Passing the same batch to successive calls of
+    QSqlQuery::fetchBatch() reuses its memory.
+
+    \sa QSqlQuery::fetchBatch()
+*/
+
+/*!
+    \enum QSqlColumnBatch::ColumnType
+
+    This enum type describes how the values of a column are stored.
+
+    \value Int64Column The values are stored as qint64. Used for integer
+    and boolean fields, and for floating point fields if the query's
+    numerical precision policy is QSql::LowPrecisionInt32 or
+    QSql::LowPrecisionInt64.
+    \value DoubleColumn The values are stored as double.
+    \value StringColumn The values are stored as QString.
+    \value VariantColumn The values are stored as QVariant. Used for all
+    other field types.
+*/
+
+/*!
+    Constructs an empty batch.
+*/
+QSqlColumnBatch::QSqlColumnBatch()
+    : d(new QSqlColumnBatchPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QSqlColumnBatch::QSqlColumnBatch(const QSqlColumnBatch &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this batch and returns a reference to it.
+*/
+QSqlColumnBatch &QSqlColumnBatch::operator=(const QSqlColumnBatch &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Destroys the batch.
+*/
+QSqlColumnBatch::~QSqlColumnBatch()
+{
+}
+
+/*!
+    \fn void QSqlColumnBatch::swap(QSqlColumnBatch &other)
+
+    Swaps this batch with \a other. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    Returns the number of rows in the batch.
+*/
+int QSqlColumnBatch::rowCount() const
+{
+    return d->rows;
+}
+
+/*!
+    Returns the number of columns in the batch.
+*/
+int QSqlColumnBatch::columnCount() const
+{
+    return d->columns.size();
+}
+
+/*!
+    \fn bool QSqlColumnBatch::isEmpty() const
+
+    Returns \c true if the batch holds no rows; otherwise returns \c false.
+*/
+
+/*!
+    Removes all rows and columns from the batch.
+*/
+void QSqlColumnBatch::clear()
+{
+    d->columns.clear();
+    d->rows = 0;
+}
+
+/*!
+    Returns the name of \a column.
+*/
+QString QSqlColumnBatch::columnName(int column) const
+{
+    return d->columns.value(column).name;
+}
+
+/*!
+    Returns the index of the column called \a name, or -1 if there is
+    no such column. The comparison is case insensitive.
+*/
+int QSqlColumnBatch::indexOf(const QString &name) const
+{
+    for (int i = 0; i < d->columns.size(); ++i) {
+        if (d->columns.at(i).name.compare(name, Qt::CaseInsensitive) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+    Returns how the values of \a column are stored.
+*/
+QSqlColumnBatch::ColumnType QSqlColumnBatch::columnType(int column) const
+{
+    return d->columns.value(column).type;
+}
+
+/*!
+    Returns \c true if the value at \a row in \a column is null;
+    otherwise returns \c false.
+*/
+bool QSqlColumnBatch::isNull(int row, int column) const
+{
+    if (column < 0 || column >= d->columns.size() || row < 0 || row >= d->rows)
+        return true;
+    return d->columns.at(column).nulls.testBit(row);
+}
+
+/*!
+    Returns the null flags of \a column; bit \c i is set if the value in
+    row \c i is null.
+*/
+QBitArray QSqlColumnBatch::nulls(int column) const
+{
+    return d->columns.value(column).nulls;
+}
+
+/*!
+    Returns the values of \a column, which must be an Int64Column.
+    Returns an empty vector for other columns.
+*/
+QVector<qint64> QSqlColumnBatch::int64Column(int column) const
+{
+    return d->columns.value(column).int64s;
+}
+
+/*!
+    Returns the values of \a column, which must be a DoubleColumn.
+    Returns an empty vector for other columns.
+*/
+QVector<double> QSqlColumnBatch::doubleColumn(int column) const
+{
+    return d->columns.value(column).doubles;
+}
+
+/*!
+    Returns the values of \a column, which must be a StringColumn.
+    Returns an empty list for other columns.
+*/
+QStringList QSqlColumnBatch::stringColumn(int column) const
+{
+    return d->columns.value(column).strings;
+}
+
+/*!
+    Returns the values of \a column, which must be a VariantColumn.
+    Returns an empty vector for other columns.
+*/
+QVector<QVariant> QSqlColumnBatch::variantColumn(int column) const
+{
+    return d->columns.value(column).variants;
+}
+
+/*!
+    Returns the value at \a row in \a column as a QVariant. Returns an
+    invalid QVariant if the value is null or the position is out of
+    range.
+*/
+QVariant QSqlColumnBatch::value(int row, int column) const
+{
+    if (column < 0 || column >= d->columns.size() || row < 0 || row >= d->rows)
+        return QVariant();
+    return d->value(row, column);
+}
+
+QT_END_NAMESPACE
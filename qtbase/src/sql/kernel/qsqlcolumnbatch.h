@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSql module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSQLCOLUMNBATCH_H
+#define QSQLCOLUMNBATCH_H
+
+#include <QtSql/qsql.h>
+#include <QtCore/qbitarray.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+
+class QSqlColumnBatchPrivate;
+
+class Q_SQL_EXPORT QSqlColumnBatch
+{
+public:
+    enum ColumnType {
+        Int64Column,
+        DoubleColumn,
+        StringColumn,
+        VariantColumn
+    };
+
+    QSqlColumnBatch();
+    QSqlColumnBatch(const QSqlColumnBatch &other);
+    QSqlColumnBatch &operator=(const QSqlColumnBatch &other);
+    ~QSqlColumnBatch();
+
+    void swap(QSqlColumnBatch &other) Q_DECL_NOTHROW { qSwap(d, other.d); }
+
+    int rowCount() const;
+    int columnCount() const;
+    bool isEmpty() const { return rowCount() == 0; }
+    void clear();
+
+    QString columnName(int column) const;
+    int indexOf(const QString &name) const;
+    ColumnType columnType(int column) const;
+
+    bool isNull(int row, int column) const;
+    QBitArray nulls(int column) const;
+
+    QVector<qint64> int64Column(int column) const;
+    QVector<double> doubleColumn(int column) const;
+    QStringList stringColumn(int column) const;
+    QVector<QVariant> variantColumn(int column) const;
+
+    QVariant value(int row, int column) const;
+
+private:
+    friend class QSqlColumnBatchPrivate;
+    QSharedDataPointer<QSqlColumnBatchPrivate> d;
+};
+
+Q_DECLARE_SHARED(QSqlColumnBatch)
+
+QT_END_NAMESPACE
+
+#endif // QSQLCOLUMNBATCH_H
@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSql module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSQLCOLUMNBATCH_P_H
+#define QSQLCOLUMNBATCH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QtSql drivers.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "QtSql/qsqlcolumnbatch.h"
+#include "QtSql/qsqlrecord.h"
+
+QT_BEGIN_NAMESPACE
+
+class Q_SQL_EXPORT QSqlColumnBatchPrivate : public QSharedData
+{
+public:
+    struct Column
+    {
+        Column() : type(QSqlColumnBatch::VariantColumn) {}
+
+        inline int size() const
+        {
+            switch (type) {
+            case QSqlColumnBatch::Int64Column:
+                return int64s.size();
+            case QSqlColumnBatch::DoubleColumn:
+                return doubles.size();
+            case QSqlColumnBatch::StringColumn:
+                return strings.size();
+            case QSqlColumnBatch::VariantColumn:
+                break;
+            }
+            return variants.size();
+        }
+
+        QString name;
+        QSqlColumnBatch::ColumnType type;
+        // only the storage that matches type is used
+        QVector<qint64> int64s;
+        QVector<double> doubles;
+        QStringList strings;
+        QVector<QVariant> variants;
+        QBitArray nulls;
+    };
+
+    QSqlColumnBatchPrivate() : rows(0) {}
+
+    static QSqlColumnBatchPrivate *get(QSqlColumnBatch *batch) { return batch->d.data(); }
+    static QSqlColumnBatch::ColumnType columnType(QVariant::Type type,
+                                                  QSql::NumericalPrecisionPolicy policy);
+
+    // Sets up one column per field of record and makes room for maxRows
+    // rows. The storage of the previous batch is reused where possible.
+    void reset(const QSqlRecord &record, int maxRows, QSql::NumericalPrecisionPolicy policy);
+    // Trims the columns to the rows that were appended.
+    void finish();
+
+    inline void appendNull(int column)
+    {
+        Column &c = columns[column];
+        c.nulls.setBit(c.size());
+        switch (c.type) {
+        case QSqlColumnBatch::Int64Column:
+            c.int64s.append(0);
+            break;
+        case QSqlColumnBatch::DoubleColumn:
+            c.doubles.append(0);
+            break;
+        case QSqlColumnBatch::StringColumn:
+            c.strings.append(QString());
+            break;
+        case QSqlColumnBatch::VariantColumn:
+            c.variants.append(QVariant());
+            break;
+        }
+    }
+    inline void appendInt64(int column, qint64 value) { columns[column].int64s.append(value); }
+    inline void appendDouble(int column, double value) { columns[column].doubles.append(value); }
+    inline void appendString(int column, const QString &value) { columns[column].strings.append(value); }
+    // converts value to the type of the column
+    void appendValue(int column, const QVariant &value);
+
+    QVariant value(int row, int column) const;
+
+    QVector<Column> columns;
+    int rows;
+};
+
+// The data of QSqlResult::virtual_hook() with FetchBatchOperation.
+struct QSqlFetchBatchData
+{
+    QSqlColumnBatch *batch;
+    int maxRows;
+    int rows; // the number of rows fetched, set by the result
+};
+
+QT_END_NAMESPACE
+
+#endif // QSQLCOLUMNBATCH_P_H
@@ -0,0 +1,639 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSql module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsqlconnectionpool.h"
+
+#ifndef QT_NO_QFUTURE
+
+#include "qsqldatabase.h"
+#include "qsqldriver.h"
+#include "qsqlerror.h"
+#include "qsqlquery.h"
+#include "qsqlqueryresultset_p.h"
+
+#include <qcoreapplication.h>
+#include <qelapsedtimer.h>
+#include <qfutureinterface.h>
+#include <qmutex.h>
+#include <qqueue.h>
+#include <qsharedpointer.h>
+#include <qthread.h>
+#include <qwaitcondition.h>
+#include <private/qobject_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSqlConnectionPoolPrivate;
+
+class QSqlPoolWorker : public QThread
+{
+public:
+    QSqlPoolWorker(QSqlConnectionPoolPrivate *pool, const QString &connectionName)
+        : pool(pool), connectionName(connectionName), driver(0), interrupts(0) {}
+
+    void run() Q_DECL_OVERRIDE;
+
+    QSqlConnectionPoolPrivate *pool;
+    QString connectionName;
+    // the driver of the open connection, guarded by the mutex of the pool
+    QSqlDriver *driver;
+    // the interrupt() calls in progress on driver, which keep it alive
+    int interrupts;
+};
+
+class QSqlPoolWatchdog : public QThread
+{
+public:
+    explicit QSqlPoolWatchdog(QSqlConnectionPoolPrivate *pool) : pool(pool) {}
+
+    void run() Q_DECL_OVERRIDE;
+
+    QSqlConnectionPoolPrivate *pool;
+};
+
+class QSqlPoolRequest
+{
+public:
+    QSqlPoolRequest(const QString &query, const QVariantList &values, int timeout)
+        : query(query), values(values), timeout(timeout), worker(0), done(false)
+    { timer.start(); }
+
+    QString query;
+    QVariantList values;
+    // in milliseconds since the request was queued, 0 for none
+    int timeout;
+    QElapsedTimer timer;
+    QFutureInterface<QSqlQueryResultSet> future;
+    // the worker running the request, if it has been started
+    QSqlPoolWorker *worker;
+    // set once the future has been finished
+    bool done;
+};
+
+typedef QSharedPointer<QSqlPoolRequest> QSqlPoolRequestPointer;
+
+static QAtomicInt qPoolId = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+class QSqlConnectionPoolPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QSqlConnectionPool)
+
+public:
+    QSqlConnectionPoolPrivate()
+        : port(-1), precisionPolicy(QSql::LowPrecisionDouble),
+          maxConnections(qMax(1, QThread::idealThreadCount())), defaultTimeout(0),
+          id(qPoolId.fetchAndAddRelaxed(1)), nextWorkerId(0), idleWorkers(0),
+          watchdog(0), quit(false)
+    {}
+
+    void enqueue(const QSqlPoolRequestPointer &request);
+    void work(QSqlPoolWorker *worker);
+    void watch();
+    QSqlQueryResultSet execute(QSqlDatabase &db, const QSqlPoolRequest &request) const;
+    // the following are called with the mutex locked
+    void finish(QSqlPoolRequest *request, const QSqlQueryResultSet &result);
+    void reserveInterrupt(QSqlPoolRequest *request, QList<QSqlPoolWorker *> *interrupted);
+    void releaseDriver(QSqlPoolWorker *worker);
+    void checkDone();
+    // called with the mutex unlocked
+    void interrupt(const QList<QSqlPoolWorker *> &interrupted);
+
+    // the parameters of the database the pool was created for
+    QString driverName;
+    QString databaseName;
+    QString userName;
+    QString password;
+    QString hostName;
+    QString connectOptions;
+    int port;
+    QSql::NumericalPrecisionPolicy precisionPolicy;
+
+    int maxConnections;
+    int defaultTimeout;
+    int id;
+    int nextWorkerId;
+
+    mutable QMutex mutex;
+    QWaitCondition requestQueued;
+    QWaitCondition deadlineChanged;
+    QWaitCondition allDone;
+    QWaitCondition interruptsDone;
+    QQueue<QSqlPoolRequestPointer> queue;
+    QList<QSqlPoolRequestPointer> running;
+    QList<QSqlPoolWorker *> workers;
+    QList<QSqlPoolWorker *> retiredWorkers;
+    int idleWorkers;
+    QSqlPoolWatchdog *watchdog;
+    bool quit;
+};
+
+void QSqlPoolWorker::run()
+{
+    pool->work(this);
+}
+
+void QSqlPoolWatchdog::run()
+{
+    pool->watch();
+}
+
+void QSqlConnectionPoolPrivate::enqueue(const QSqlPoolRequestPointer &request)
+{
+    QMutexLocker locker(&mutex);
+    request->future.reportStarted();
+    queue.enqueue(request);
+
+    if (request->timeout > 0) {
+        if (!watchdog) {
+            watchdog = new QSqlPoolWatchdog(this);
+            watchdog->start();
+        }
+        deadlineChanged.wakeOne();
+    }
+
+    // connections are opened on demand, one per worker thread
+    if (queue.size() > idleWorkers && workers.size() < maxConnections) {
+        const QString name = QString::fromLatin1("qt_sql_connection_pool_%1_%2")
+                             .arg(id).arg(nextWorkerId++);
+        QSqlPoolWorker *worker = new QSqlPoolWorker(this, name);
+        workers.append(worker);
+        worker->start();
+    } else {
+        requestQueued.wakeOne();
+    }
+}
+
+void QSqlConnectionPoolPrivate::work(QSqlPoolWorker *worker)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(driverName, worker->connectionName);
+        db.setDatabaseName(databaseName);
+        db.setUserName(userName);
+        db.setPassword(password);
+        db.setHostName(hostName);
+        db.setPort(port);
+        db.setConnectOptions(connectOptions);
+        db.setNumericalPrecisionPolicy(precisionPolicy);
+
+        QMutexLocker locker(&mutex);
+        forever {
+            // an interrupt that comes late must not hit the next query
+            while (worker->interrupts > 0)
+                interruptsDone.wait(&mutex);
+            while (queue.isEmpty() && !quit && workers.size() <= maxConnections) {
+                ++idleWorkers;
+                requestQueued.wait(&mutex);
+                --idleWorkers;
+            }
+            if (quit)
+                break;
+            if (queue.isEmpty()) {
+                // the pool was made smaller
+                workers.removeOne(worker);
+                retiredWorkers.append(worker);
+                break;
+            }
+
+            const QSqlPoolRequestPointer request = queue.dequeue();
+            if (request->done || request->future.isCanceled()) {
+                finish(request.data(), QSqlQueryResultSet());
+                checkDone();
+                continue;
+            }
+            request->worker = worker;
+            running.append(request);
+            locker.unlock();
+
+            // open the connection for the first request, and again after
+            // it failed to open or was lost
+            QSqlQueryResultSet result;
+            if (!db.isOpen() && db.open()) {
+                locker.relock();
+                worker->driver = db.driver();
+                locker.unlock();
+            }
+            if (db.isOpen())
+                result = execute(db, *request);
+            else
+                result = QSqlQueryResultSetPrivate::fromError(db.lastError());
+
+            // a lost connection still counts as open, close it
+            if (db.isOpen() && result.lastError().type() == QSqlError::ConnectionError) {
+                locker.relock();
+                releaseDriver(worker);
+                locker.unlock();
+                db.close();
+            }
+
+            locker.relock();
+            running.removeOne(request);
+            request->worker = 0;
+            finish(request.data(), result);
+            checkDone();
+        }
+        releaseDriver(worker);
+    }
+    QSqlDatabase::removeDatabase(worker->connectionName);
+}
+
+QSqlQueryResultSet QSqlConnectionPoolPrivate::execute(QSqlDatabase &db,
+                                                      const QSqlPoolRequest &request) const
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (request.values.isEmpty()) {
+        query.exec(request.query);
+    } else if (query.prepare(request.query)) {
+        for (int i = 0; i < request.values.size(); ++i)
+            query.addBindValue(request.values.at(i));
+        query.exec();
+    }
+    return QSqlQueryResultSetPrivate::fromQuery(query);
+}
+
+void QSqlConnectionPoolPrivate::finish(QSqlPoolRequest *request, const QSqlQueryResultSet &result)
+{
+    if (request->done)
+        return;
+    request->done = true;
+    if (!request->future.isCanceled())
+        request->future.reportResult(result);
+    request->future.reportFinished();
+}
+
+/*
+   Adds the worker running request to interrupted if its driver can abort
+   the query. The SQLite and PostgreSQL drivers can do so from another
+   thread; for other drivers the query runs to its end and its result is
+   dropped. The worker keeps its driver until interrupt() is done with it.
+ */
+void QSqlConnectionPoolPrivate::reserveInterrupt(QSqlPoolRequest *request,
+                                                 QList<QSqlPoolWorker *> *interrupted)
+{
+    QSqlPoolWorker *worker = request->worker;
+    if (!worker || !worker->driver
+        || worker->driver->metaObject()->indexOfMethod("interrupt()") == -1)
+        return;
+    ++worker->interrupts;
+    interrupted->append(worker);
+}
+
+void QSqlConnectionPoolPrivate::releaseDriver(QSqlPoolWorker *worker)
+{
+    while (worker->interrupts > 0)
+        interruptsDone.wait(&mutex);
+    worker->driver = 0;
+}
+
+/*
+   Aborts the queries of the workers reserved with reserveInterrupt().
+   PQcancel() waits for the server, so this runs without the mutex.
+ */
+void QSqlConnectionPoolPrivate::interrupt(const QList<QSqlPoolWorker *> &interrupted)
+{
+    if (interrupted.isEmpty())
+        return;
+    for (int i = 0; i < interrupted.size(); ++i)
+        QMetaObject::invokeMethod(interrupted.at(i)->driver, "interrupt", Qt::DirectConnection);
+
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < interrupted.size(); ++i)
+        --interrupted.at(i)->interrupts;
+    interruptsDone.wakeAll();
+}
+
+void QSqlConnectionPoolPrivate::checkDone()
+{
+    if (queue.isEmpty() && running.isEmpty())
+        allDone.wakeAll();
+}
+
+void QSqlConnectionPoolPrivate::watch()
+{
+    QMutexLocker locker(&mutex);
+    while (!quit) {
+        const QSqlQueryResultSet timedOut = QSqlQueryResultSetPrivate::fromError(
+                    QSqlError(QCoreApplication::translate("QSqlConnectionPool", "Query timed out"),
+                              QString(), QSqlError::StatementError));
+        QList<QSqlPoolWorker *> interrupted;
+        qint64 next = -1;
+
+        QMutableListIterator<QSqlPoolRequestPointer> it(queue);
+        while (it.hasNext()) {
+            QSqlPoolRequest *request = it.next().data();
+            if (request->timeout <= 0 || request->done)
+                continue;
+            const qint64 remaining = request->timeout - request->timer.elapsed();
+            if (remaining <= 0) {
+                finish(request, timedOut);
+                it.remove();
+            } else if (next < 0 || remaining < next) {
+                next = remaining;
+            }
+        }
+        for (int i = 0; i < running.size(); ++i) {
+            QSqlPoolRequest *request = running.at(i).data();
+            if (request->timeout <= 0 || request->done)
+                continue;
+            const qint64 remaining = request->timeout - request->timer.elapsed();
+            if (remaining <= 0) {
+                // the worker drops the result once the query returns
+                finish(request, timedOut);
+                reserveInterrupt(request, &interrupted);
+            } else if (next < 0 || remaining < next) {
+                next = remaining;
+            }
+        }
+        checkDone();
+
+        if (!interrupted.isEmpty()) {
+            // the deadlines are checked again afterwards
+            locker.unlock();
+            interrupt(interrupted);
+            locker.relock();
+            continue;
+        }
+        if (next < 0)
+            deadlineChanged.wait(&mutex);
+        else
+            deadlineChanged.wait(&mutex, next);
+    }
+}
+
+/*!
+    \class QSqlConnectionPool
+    \brief The QSqlConnectionPool class runs queries asynchronously on a pool of connections.
+    \since 5.6
+
+    \ingroup database
+    \inmodule QtSql
+
+    A QSqlDatabase connection can only be used in the thread that
+    created it, and QSqlQuery::exec() blocks until the database has
+    answered. QSqlConnectionPool executes queries in worker threads
+    instead, each of which owns its own connection to the database the
+    pool was created for, so that the thread calling exec() is not
+    blocked.
+
+    exec() queues the query and returns a QFuture that receives the
+    QSqlQueryResultSet of the query once it has run. Use a
+    QFutureWatcher to be notified in an event loop:
+
+    \code
+    QSqlConnectionPool *pool = new QSqlConnectionPool(QSqlDatabase::database(), this);
+    QFutureWatcher<QSqlQueryResultSet> *watcher = new QFutureWatcher<QSqlQueryResultSet>(this);
+    connect(watcher, &QFutureWatcherBase::finished, [watcher]() {
+        const QSqlQueryResultSet result = watcher->result();
+        for (int row = 0; row < result.rowCount(); ++row)
+            qDebug() << result.value(row, 0);
+    });
+    watcher->setFuture(pool->exec("SELECT name FROM items WHERE price > ?", QVariantList() << 10));
+    \endcode
+
+    Connections are opened on demand, up to maxConnections(). When a
+    query fails with a QSqlError::ConnectionError, its connection is
+    closed and opened again for the next query. Queries
+    are started in the order in which exec() was called, on the first
+    connection that becomes free, so a query is never overtaken by one
+    that was queued after it. Each query runs in a forward-only
+    QSqlQuery of its own; statements that depend on each other, like
+    the statements of a transaction, may run on different connections
+    and should therefore be sent as a single query or be run with a
+    QSqlDatabase of their own.
+
+    A query can be given a timeout, which covers both the time it
+    spends in the queue and its execution. When the timeout expires,
+    the future receives a result set with an error. The SQLite and
+    PostgreSQL drivers abort a query that is still running; with other
+    drivers, it runs to its end and the result is dropped. Canceling the
+    future with QFuture::cancel() removes a query that has not been
+    started from the queue.
+
+    \sa QSqlQueryResultSet, QSqlDatabase
+*/
+
+/*!
+    Constructs a connection pool for the database described by \a
+    database, with the given \a parent.
+
+    The pool copies the driver name, connection parameters, connect
+    options and numerical precision policy of \a database and opens
+    connections of its own with them; \a database itself is not used.
+*/
+QSqlConnectionPool::QSqlConnectionPool(const QSqlDatabase &database, QObject *parent)
+    : QObject(*new QSqlConnectionPoolPrivate, parent)
+{
+    Q_D(QSqlConnectionPool);
+    d->driverName = database.driverName();
+    d->databaseName = database.databaseName();
+    d->userName = database.userName();
+    d->password = database.password();
+    d->hostName = database.hostName();
+    d->port = database.port();
+    d->connectOptions = database.connectOptions();
+    d->precisionPolicy = database.numericalPrecisionPolicy();
+}
+
+/*!
+    Destroys the pool. Queries that have not finished receive an error,
+    running queries are aborted where the driver allows it, and the
+    connections are closed.
+*/
+QSqlConnectionPool::~QSqlConnectionPool()
+{
+    Q_D(QSqlConnectionPool);
+    QList<QThread *> threads;
+    QList<QSqlPoolWorker *> interrupted;
+    {
+        QMutexLocker locker(&d->mutex);
+        d->quit = true;
+        const QSqlQueryResultSet destroyed = QSqlQueryResultSetPrivate::fromError(
+                    QSqlError(tr("The connection pool was destroyed"), QString(),
+                              QSqlError::ConnectionError));
+        while (!d->queue.isEmpty())
+            d->finish(d->queue.dequeue().data(), destroyed);
+        for (int i = 0; i < d->running.size(); ++i) {
+            d->finish(d->running.at(i).data(), destroyed);
+            d->reserveInterrupt(d->running.at(i).data(), &interrupted);
+        }
+        d->requestQueued.wakeAll();
+        d->deadlineChanged.wakeAll();
+
+        for (int i = 0; i < d->workers.size(); ++i)
+            threads.append(d->workers.at(i));
+        for (int i = 0; i < d->retiredWorkers.size(); ++i)
+            threads.append(d->retiredWorkers.at(i));
+        if (d->watchdog)
+            threads.append(d->watchdog);
+    }
+    d->interrupt(interrupted);
+    foreach (QThread *thread, threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/*!
+    Returns the maximum number of connections the pool opens. The
+    default is QThread::idealThreadCount().
+
+    \sa setMaxConnections(), connectionCount()
+*/
+int QSqlConnectionPool::maxConnections() const
+{
+    Q_D(const QSqlConnectionPool);
+    QMutexLocker locker(&d->mutex);
+    return d->maxConnections;
+}
+
+/*!
+    Sets the maximum number of connections the pool opens to \a count,
+    which must be at least 1. If the pool has more connections open,
+    the surplus ones are closed as they become idle.
+
+    For SQLite databases, where writers lock the whole database, a
+    single connection is often the best choice for pools that write.
+
+    \sa maxConnections()
+*/
+void QSqlConnectionPool::setMaxConnections(int count)
+{
+    Q_D(QSqlConnectionPool);
+    QMutexLocker locker(&d->mutex);
+    d->maxConnections = qMax(1, count);
+    d->requestQueued.wakeAll();
+}
+
+/*!
+    Returns the number of connections the pool currently has open.
+
+    \sa maxConnections()
+*/
+int QSqlConnectionPool::connectionCount() const
+{
+    Q_D(const QSqlConnectionPool);
+    QMutexLocker locker(&d->mutex);
+    return d->workers.size();
+}
+
+/*!
+    Returns the timeout in milliseconds of queries that are executed
+    without one. The default is 0, which means that queries do not time
+    out.
+
+    \sa setDefaultTimeout(), exec()
+*/
+int QSqlConnectionPool::defaultTimeout() const
+{
+    Q_D(const QSqlConnectionPool);
+    QMutexLocker locker(&d->mutex);
+    return d->defaultTimeout;
+}
+
+/*!
+    Sets the timeout of queries that are executed without one to \a
+    msecs milliseconds. 0 disables the timeout. The new timeout applies
+    to queries that are executed afterwards.
+
+    \sa defaultTimeout()
+*/
+void QSqlConnectionPool::setDefaultTimeout(int msecs)
+{
+    Q_D(QSqlConnectionPool);
+    QMutexLocker locker(&d->mutex);
+    d->defaultTimeout = qMax(0, msecs);
+}
+
+/*!
+    Queues \a query for execution on one of the connections of the pool
+    and returns a future that receives its result.
+
+    If \a timeout is 0 or positive, the query fails with an error if it
+    has not finished \a timeout milliseconds after this call; 0 means no
+    timeout. If \a timeout is negative, defaultTimeout() is used.
+
+    \sa waitForDone()
+*/
+QFuture<QSqlQueryResultSet> QSqlConnectionPool::exec(const QString &query, int timeout)
+{
+    return exec(query, QVariantList(), timeout);
+}
+
+/*!
+    \overload
+
+    Prepares \a query and binds \a values to its placeholders in order
+    before executing it.
+
+    \sa QSqlQuery::addBindValue()
+*/
+QFuture<QSqlQueryResultSet> QSqlConnectionPool::exec(const QString &query,
+                                                     const QVariantList &values, int timeout)
+{
+    Q_D(QSqlConnectionPool);
+    if (timeout < 0)
+        timeout = defaultTimeout();
+    const QSqlPoolRequestPointer request(new QSqlPoolRequest(query, values, timeout));
+    QFuture<QSqlQueryResultSet> future = request->future.future();
+    d->enqueue(request);
+    return future;
+}
+
+/*!
+    Waits until all queued queries have finished, but no longer than \a
+    msecs milliseconds. If \a msecs is -1, this function does not time
+    out. Returns \c true if all queries have finished; otherwise returns
+    \c false.
+*/
+bool QSqlConnectionPool::waitForDone(int msecs)
+{
+    Q_D(QSqlConnectionPool);
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&d->mutex);
+    while (!d->queue.isEmpty() || !d->running.isEmpty()) {
+        if (msecs < 0) {
+            d->allDone.wait(&d->mutex);
+        } else {
+            const qint64 remaining = msecs - timer.elapsed();
+            if (remaining <= 0 || !d->allDone.wait(&d->mutex, remaining))
+                return d->queue.isEmpty() && d->running.isEmpty();
+        }
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_QFUTURE
@@ -436,7 +436,12 @@ void QSqlDatabasePrivate::disable()
     If you have created your own custom driver, you must register it
     with registerSqlDriver().
 
-    \sa QSqlDriver, QSqlQuery, {Qt SQL}, {Threads and the SQL Module}
+    A connection can only be used in the thread that created it. To run
+    queries without blocking the calling thread, use a
+    QSqlConnectionPool, which executes them on connections of its own in
+    worker threads.
+
+    \sa QSqlDriver, QSqlQuery, QSqlConnectionPool, {Qt SQL}, {Threads and the SQL Module}
 */
 
 /*! \fn QSqlDatabase QSqlDatabase::addDatabase(const QString &type, const QString &connectionName)
@@ -1240,6 +1245,8 @@ QSqlRecord QSqlDatabase::record(const QString& tablename) const
     \li tty
     \li requiressl
     \li service
+    \li QPSQL_SINGLE_ROW_MODE
+    \li QPSQL_BINARY_RESULTS
     \endlist
 
     \header \li DB2 \li OCI \li TDS
@@ -1269,6 +1276,8 @@ QSqlRecord QSqlDatabase::record(const QString& tablename) const
     \li QSQLITE_OPEN_READONLY
     \li QSQLITE_OPEN_URI
     \li QSQLITE_ENABLE_SHARED_CACHE
+    \li QSQLITE_STATEMENT_CACHE_SIZE
+    \li QSQLITE_BATCH_TRANSACTIONS
     \endlist
 
     \li
@@ -40,6 +40,7 @@
 #include "qatomic.h"
 #include "qsqlrecord.h"
 #include "qsqlresult.h"
+#include "qsqlcolumnbatch_p.h"
 #include "qsqldriver.h"
 #include "qsqldatabase.h"
 #include "private/qsqlnulldriver_p.h"
@@ -1289,4 +1290,44 @@ bool QSqlQuery::nextResult()
     return false;
 }
 
+/*!
+  \since 5.6
+
+  Fetches up to \a maxRows records following the current record into
+  \a batch and returns the number of records fetched. The previous
+  content of \a batch is replaced, but its memory is reused, so the
+  same batch can be passed to every call while a result set is read.
+
+  The values are stored by column in the column's native type, see
+  QSqlColumnBatch. For large result sets this is considerably faster
+  than calling next() and value() for each record, in particular for
+  drivers that fill the columns directly from the database's row
+  buffers.
+
+  Like next(), the query must be \l{isActive()}{active} and isSelect()
+  must return true. After the call the query is positioned on the last
+  record fetched, so value() still returns the values of that record.
+  If fewer than \a maxRows records were left, the query is positioned
+  after the last record. If the query is not active, is not a select or
+  \a maxRows is not positive, \a batch is cleared and 0 is returned.
+
+  \sa next(), setForwardOnly()
+*/
+int QSqlQuery::fetchBatch(QSqlColumnBatch *batch, int maxRows)
+{
+    if (!batch)
+        return 0;
+    if (!isSelect() || !isActive() || maxRows <= 0) {
+        batch->clear();
+        return 0;
+    }
+    QSqlFetchBatchData args = { batch, maxRows, -1 };
+    d->sqlResult->virtual_hook(QSqlResult::FetchBatchOperation, &args);
+    if (args.rows < 0) {
+        // the driver's virtual_hook() did not pass the operation on
+        d->sqlResult->QSqlResult::virtual_hook(QSqlResult::FetchBatchOperation, &args);
+    }
+    return args.rows;
+}
+
 QT_END_NAMESPACE
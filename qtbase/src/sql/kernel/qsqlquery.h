@@ -46,6 +46,7 @@ class QSqlDriver;
 class QSqlError;
 class QSqlResult;
 class QSqlRecord;
+class QSqlColumnBatch;
 template <class Key, class T> class QMap;
 class QSqlQueryPrivate;
 
@@ -106,6 +107,7 @@ public:
     QVariant lastInsertId() const;
     void finish();
     bool nextResult();
+    int fetchBatch(QSqlColumnBatch *batch, int maxRows);
 
 private:
     QSqlQueryPrivate* d;
@@ -0,0 +1,265 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtSql module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsqlqueryresultset.h"
+#include "qsqlqueryresultset_p.h"
+
+#include "qsqldriver.h"
+#include "qsqlquery.h"
+
+QT_BEGIN_NAMESPACE
+
+QSqlQueryResultSet QSqlQueryResultSetPrivate::fromQuery(QSqlQuery &query)
+{
+    QSqlQueryResultSet resultSet;
+    QSqlQueryResultSetPrivate *d = resultSet.d.data();
+    d->error = query.lastError();
+    if (!query.isActive())
+        return resultSet;
+
+    d->select = query.isSelect();
+    d->rowsAffected = query.numRowsAffected();
+    if (!d->select) {
+        if (query.driver() && query.driver()->hasFeature(QSqlDriver::LastInsertId))
+            d->lastInsertId = query.lastInsertId();
+        return resultSet;
+    }
+
+    d->record = query.record();
+    const int columns = d->record.count();
+    if (query.size() > 0)
+        d->values.reserve(query.size() * columns);
+    while (query.next()) {
+        for (int i = 0; i < columns; ++i)
+            d->values.append(query.value(i));
+        ++d->rows;
+    }
+    // a streaming driver may only notice an error while fetching
+    if (query.lastError().isValid())
+        d->error = query.lastError();
+    return resultSet;
+}
+
+QSqlQueryResultSet QSqlQueryResultSetPrivate::fromError(const QSqlError &error)
+{
+    QSqlQueryResultSet resultSet;
+    resultSet.d->error = error;
+    return resultSet;
+}
+
+/*!
+    \class QSqlQueryResultSet
+    \brief The QSqlQueryResultSet class holds the complete result of a query.
+    \since 5.6
+
+    \ingroup database
+    \ingroup shared
+    \inmodule QtSql
+
+    A QSqlQueryResultSet is returned by the QFuture of
+    QSqlConnectionPool::exec(). Unlike QSqlQuery, it does not refer to
+    a connection: all rows of the result are read when the query is
+    executed, so the result set can be passed between threads and read
+    after the connection has been used for other queries.
+
+    If the query failed, lastError() returns the error and the result
+    set has no rows. For a SELECT statement, record() describes the
+    columns and value() returns the value at a row and column. For other
+    statements, numRowsAffected() and lastInsertId() are available.
+
+    \sa QSqlConnectionPool, QSqlQuery
+*/
+
+/*!
+    Constructs an empty result set.
+*/
+QSqlQueryResultSet::QSqlQueryResultSet()
+    : d(new QSqlQueryResultSetPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QSqlQueryResultSet::QSqlQueryResultSet(const QSqlQueryResultSet &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this result set and returns a reference to it.
+*/
+QSqlQueryResultSet &QSqlQueryResultSet::operator=(const QSqlQueryResultSet &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Destroys the result set.
+*/
+QSqlQueryResultSet::~QSqlQueryResultSet()
+{
+}
+
+/*!
+    \fn void QSqlQueryResultSet::swap(QSqlQueryResultSet &other)
+
+    Swaps this result set with \a other. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    Returns the error of the query, or an invalid error if the query
+    succeeded.
+
+    \sa QSqlQuery::lastError()
+*/
+QSqlError QSqlQueryResultSet::lastError() const
+{
+    return d->error;
+}
+
+/*!
+    Returns \c true if the query was a SELECT statement; otherwise
+    returns \c false.
+
+    \sa QSqlQuery::isSelect()
+*/
+bool QSqlQueryResultSet::isSelect() const
+{
+    return d->select;
+}
+
+/*!
+    Returns the number of rows affected by the query, or -1 if it
+    cannot be determined or the query failed.
+
+    \sa QSqlQuery::numRowsAffected()
+*/
+int QSqlQueryResultSet::numRowsAffected() const
+{
+    return d->rowsAffected;
+}
+
+/*!
+    Returns the object ID of the most recent inserted row if the query
+    inserted a row and the driver supports QSqlDriver::LastInsertId;
+    otherwise returns an invalid QVariant.
+
+    \sa QSqlQuery::lastInsertId()
+*/
+QVariant QSqlQueryResultSet::lastInsertId() const
+{
+    return d->lastInsertId;
+}
+
+/*!
+    Returns a record describing the columns of the result. The values
+    of the record are null.
+
+    \sa QSqlQuery::record()
+*/
+QSqlRecord QSqlQueryResultSet::record() const
+{
+    return d->record;
+}
+
+/*!
+    \overload
+
+    Returns a record holding the values of \a row, or an empty record if
+    \a row is out of range.
+*/
+QSqlRecord QSqlQueryResultSet::record(int row) const
+{
+    if (row < 0 || row >= d->rows)
+        return QSqlRecord();
+    QSqlRecord rec = d->record;
+    const int columns = rec.count();
+    for (int i = 0; i < columns; ++i)
+        rec.setValue(i, d->values.at(row * columns + i));
+    return rec;
+}
+
+/*!
+    Returns the number of rows in the result set.
+*/
+int QSqlQueryResultSet::rowCount() const
+{
+    return d->rows;
+}
+
+/*!
+    Returns the number of columns in the result set.
+*/
+int QSqlQueryResultSet::columnCount() const
+{
+    return d->record.count();
+}
+
+/*!
+    Returns \c true if the value at \a row and \a column is null or out
+    of range; otherwise returns \c false.
+*/
+bool QSqlQueryResultSet::isNull(int row, int column) const
+{
+    return value(row, column).isNull();
+}
+
+/*!
+    Returns the value at \a row and \a column, or an invalid QVariant if
+    either is out of range.
+
+    \sa QSqlQuery::value()
+*/
+QVariant QSqlQueryResultSet::value(int row, int column) const
+{
+    const int columns = d->record.count();
+    if (row < 0 || row >= d->rows || column < 0 || column >= columns)
+        return QVariant();
+    return d->values.at(row * columns + column);
+}
+
+/*!
+    \overload
+
+    Returns the value of the column called \a name at \a row.
+*/
+QVariant QSqlQueryResultSet::value(int row, const QString &name) const
+{
+    return value(row, d->record.indexOf(name));
+}
+
+QT_END_NAMESPACE
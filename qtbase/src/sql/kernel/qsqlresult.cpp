@@ -43,6 +43,7 @@
 #include "qsqldriver.h"
 #include "qpointer.h"
 #include "qsqlresult_p.h"
+#include "qsqlcolumnbatch_p.h"
 #include "private/qsqldriver_p.h"
 #include <QDebug>
 
@@ -910,9 +911,35 @@ QVariant QSqlResult::lastInsertId() const
 }
 
 /*! \internal
+
+    With FetchBatchOperation, \a data points to a QSqlFetchBatchData. The
+    default implementation walks the rows with fetchNext() and copies the
+    values with data(); drivers can handle the operation themselves to
+    fill the columns straight from the database's row buffers.
 */
-void QSqlResult::virtual_hook(int, void *)
+void QSqlResult::virtual_hook(int id, void *data)
 {
+    if (id == FetchBatchOperation) {
+        QSqlFetchBatchData *args = static_cast<QSqlFetchBatchData *>(data);
+        QSqlColumnBatchPrivate *b = QSqlColumnBatchPrivate::get(args->batch);
+        b->reset(record(), args->maxRows, numericalPrecisionPolicy());
+        const int columns = b->columns.size();
+        int rows = 0;
+        while (rows < args->maxRows) {
+            if (at() == QSql::AfterLastRow)
+                break;
+            const bool ok = at() == QSql::BeforeFirstRow ? fetchFirst() : fetchNext();
+            if (!ok) {
+                setAt(QSql::AfterLastRow);
+                break;
+            }
+            for (int i = 0; i < columns; ++i)
+                b->appendValue(i, isNull(i) ? QVariant() : this->data(i));
+            ++rows;
+        }
+        b->finish();
+        args->rows = rows;
+    }
 }
 
 /*! \internal
@@ -121,7 +121,7 @@ protected:
     virtual QSqlRecord record() const;
     virtual QVariant lastInsertId() const;
 
-    enum VirtualHookOperation { };
+    enum VirtualHookOperation { FetchBatchOperation };
     virtual void virtual_hook(int id, void *data);
     virtual bool execBatch(bool arrayBind = false);
     virtual void detachFromResultSet();
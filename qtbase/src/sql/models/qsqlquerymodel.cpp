@@ -35,12 +35,16 @@
 #include "qsqlquerymodel_p.h"
 
 #include <qdebug.h>
+#include <qsqlconnectionpool.h>
 #include <qsqldriver.h>
 #include <qsqlfield.h>
+#include <private/qsqlqueryresultset_p.h>
 
 QT_BEGIN_NAMESPACE
 
 #define QSQL_PREFETCH 255
+// the number of windows kept in windowed mode
+#define QSQL_CACHED_WINDOWS 3
 
 void QSqlQueryModelPrivate::prefetch(int limit)
 {
@@ -79,6 +83,8 @@ void QSqlQueryModelPrivate::prefetch(int limit)
 
 QSqlQueryModelPrivate::~QSqlQueryModelPrivate()
 {
+    clearWindows();
+    delete pool;
 }
 
 void QSqlQueryModelPrivate::initColOffsets(int size)
@@ -94,6 +100,174 @@ int QSqlQueryModelPrivate::columnInQuery(int modelColumn) const
     return modelColumn - colOffsets[modelColumn];
 }
 
+// every connection to an SQLite in-memory database has a database of its own
+static bool qIsPrivateDatabase(const QSqlDatabase &db)
+{
+    if (!db.driver() || db.driver()->dbmsType() != QSqlDriver::SQLite)
+        return false;
+    const QString name = db.databaseName();
+    return name.isEmpty() || name == QLatin1String(":memory:")
+           || name.contains(QLatin1String("mode=memory"));
+}
+
+/*
+   Returns the statement selecting window index and appends the values to
+   bind to values. Next to a cached window, the statement seeks by the key
+   of its first or last row, which an index on the key column answers
+   without reading the rows in between; other windows are selected by
+   OFFSET.
+*/
+QString QSqlQueryModelPrivate::windowStatement(int index, QVariantList *values) const
+{
+    typedef QSqlQueryModelSql Sql;
+    const QString alias = QLatin1String("qt_window");
+    const QString key = windowDb.driver()->escapeIdentifier(keyColumn, QSqlDriver::FieldName);
+    const QString all = Sql::select(QLatin1String("*"));
+    const QString rows = Sql::concat(all, Sql::from(Sql::as(Sql::paren(windowQuery), alias)));
+
+    for (int i = 0; i < windows.size(); ++i) {
+        const Window &w = windows.at(i);
+        const int keyIndex = w.rows.record().indexOf(keyColumn);
+        if (w.rows.rowCount() == 0 || keyIndex == -1)
+            continue;
+        if (w.index == index - 1) {
+            values->append(w.rows.value(w.rows.rowCount() - 1, keyIndex));
+            return Sql::concat(Sql::concat(Sql::concat(rows, Sql::where(key + QLatin1String(" > ?"))),
+                                           Sql::orderBy(Sql::asc(key))),
+                               Sql::limit(windowSize));
+        }
+        if (w.index == index + 1) {
+            values->append(w.rows.value(0, keyIndex));
+            const QString before =
+                    Sql::concat(Sql::concat(Sql::concat(rows, Sql::where(key + QLatin1String(" < ?"))),
+                                            Sql::orderBy(Sql::desc(key))),
+                                Sql::limit(windowSize));
+            return Sql::concat(Sql::concat(all, Sql::from(Sql::as(Sql::paren(before), alias))),
+                               Sql::orderBy(Sql::asc(key)));
+        }
+    }
+
+    return Sql::concat(Sql::concat(Sql::concat(rows, Sql::orderBy(Sql::asc(key))),
+                                   Sql::limit(windowSize)),
+                       Sql::offset(index * windowSize));
+}
+
+QSqlQueryResultSet QSqlQueryModelPrivate::loadWindow(int index)
+{
+    QVariantList values;
+    const QString statement = windowStatement(index, &values);
+    if (query.prepare(statement)) {
+        for (int i = 0; i < values.size(); ++i)
+            query.addBindValue(values.at(i));
+        query.exec();
+    }
+    return QSqlQueryResultSetPrivate::fromQuery(query);
+}
+
+/*
+   Returns the rows of window index, or 0 if they cannot be selected.
+   The window is taken from the cache, from the prefetched windows or,
+   failing both, selected on the model's connection.
+*/
+const QSqlQueryResultSet *QSqlQueryModelPrivate::window(int index)
+{
+    for (int i = 0; i < windows.size(); ++i) {
+        if (windows.at(i).index == index) {
+            windows.move(i, 0);
+            return &windows.first().rows;
+        }
+    }
+
+    Window w;
+    w.index = index;
+    bool loaded = false;
+#ifndef QT_NO_QFUTURE
+    if (pendingWindows.contains(index)) {
+        // usually finished already, otherwise waiting is still shorter
+        // than selecting the window again
+        QFuture<QSqlQueryResultSet> pending = pendingWindows.take(index);
+        pending.waitForFinished();
+        if (pending.resultCount() > 0) {
+            w.rows = pending.result();
+            loaded = !w.rows.lastError().isValid();
+        }
+    }
+#endif
+    if (!loaded)
+        w.rows = loadWindow(index);
+    if (w.rows.lastError().isValid()) {
+        error = w.rows.lastError();
+        return 0;
+    }
+
+    windows.prepend(w);
+    while (windows.size() > QSQL_CACHED_WINDOWS)
+        windows.removeLast();
+    prefetchWindows(index);
+    return &windows.first().rows;
+}
+
+// Selects the windows before and after window index on the connection
+// pool, so that they are ready when the view scrolls there.
+void QSqlQueryModelPrivate::prefetchWindows(int index)
+{
+#ifndef QT_NO_QFUTURE
+    if (!pool)
+        return;
+
+    QHash<int, QFuture<QSqlQueryResultSet> >::iterator it = pendingWindows.begin();
+    while (it != pendingWindows.end()) {
+        if (qAbs(it.key() - index) != 1) {
+            it->cancel();
+            it = pendingWindows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // the next window first, views mostly scroll down
+    const int neighbours[] = { index + 1, index - 1 };
+    for (int i = 0; i < 2; ++i) {
+        const int n = neighbours[i];
+        if (n < 0 || qint64(n) * windowSize >= rowTotal || pendingWindows.contains(n))
+            continue;
+        bool cached = false;
+        for (int j = 0; j < windows.size() && !cached; ++j)
+            cached = windows.at(j).index == n;
+        if (cached)
+            continue;
+        QVariantList values;
+        const QString statement = windowStatement(n, &values);
+        pendingWindows.insert(n, pool->exec(statement, values));
+    }
+#else
+    Q_UNUSED(index);
+#endif
+}
+
+void QSqlQueryModelPrivate::clearWindows()
+{
+    windows.clear();
+#ifndef QT_NO_QFUTURE
+    QHash<int, QFuture<QSqlQueryResultSet> >::iterator it = pendingWindows.begin();
+    for (; it != pendingWindows.end(); ++it)
+        it->cancel();
+    pendingWindows.clear();
+#endif
+}
+
+void QSqlQueryModelPrivate::resetWindows()
+{
+    clearWindows();
+    delete pool;
+    pool = 0;
+    windowed = false;
+    windowQuery.clear();
+    keyColumn.clear();
+    windowDb = QSqlDatabase();
+    rowTotal = 0;
+}
+
 /*!
     \class QSqlQueryModel
     \brief The QSqlQueryModel class provides a read-only data model for SQL
@@ -138,6 +312,29 @@ int QSqlQueryModelPrivate::columnInQuery(int modelColumn) const
     a query, the model will fetch rows incrementally.
     See fetchMore() for more information.
 
+    \section1 Windowed Mode
+
+    A model set up with setQuery() keeps every row it has fetched, and a
+    view scrolling through a large result makes it fetch the rows in
+    between on the way. For large tables, setWindowedQuery() selects the
+    rows in windows of windowSize() rows instead, ordered by a unique key
+    column:
+
+    \code
+    QSqlQueryModel *model = new QSqlQueryModel;
+    model->setWindowedQuery("SELECT id, time, user, action FROM audit", "id");
+    view->setModel(model);
+    \endcode
+
+    Only the windows around the rows that were last read are kept. The
+    window before or after a kept window is selected by the key of its
+    first or last row, which an index on the key column answers without
+    reading the rows in between, so scrolling costs the same near the
+    end of the table as near its start; windows far from those kept are
+    selected with OFFSET. While the view shows a window, the windows
+    around it are selected in the background on a QSqlConnectionPool
+    connection of their own, see setPrefetchEnabled().
+
     \sa QSqlTableModel, QSqlRelationalTableModel, QSqlQuery,
         {Model/View Programming}, {Query Model Example}
 */
@@ -345,6 +542,14 @@ QVariant QSqlQueryModel::data(const QModelIndex &item, int role) const
     if (!d->rec.isGenerated(item.column()))
         return v;
     QModelIndex dItem = indexInQuery(item);
+    if (d->windowed) {
+        const int row = dItem.row();
+        if (row < 0 || row >= d->rowTotal)
+            return v;
+        const QSqlQueryResultSet *rows =
+                const_cast<QSqlQueryModelPrivate *>(d)->window(row / d->windowSize);
+        return rows ? rows->value(row % d->windowSize, dItem.column()) : v;
+    }
     if (dItem.row() > d->bottom.row())
         const_cast<QSqlQueryModelPrivate *>(d)->prefetch(dItem.row());
 
@@ -404,6 +609,7 @@ void QSqlQueryModel::setQuery(const QSqlQuery &query)
 {
     Q_D(QSqlQueryModel);
     beginResetModel();
+    d->resetWindows();
 
     QSqlRecord newRec = query.record();
     bool columnsChanged = (newRec != d->rec);
@@ -465,6 +671,169 @@ void QSqlQueryModel::setQuery(const QString &query, const QSqlDatabase &db)
     setQuery(QSqlQuery(query, db));
 }
 
+/*!
+    \since 5.6
+
+    Resets the model and shows the rows of the SELECT statement \a query
+    on the database connection \a db in windowed mode, ordered by \a
+    keyColumn. If no database (or an invalid database) is specified, the
+    default connection is used.
+
+    The values of \a keyColumn, which must be a column of \a query, must
+    be unique and not null, and the column should be indexed. \a query
+    itself must not have an ORDER BY clause. The number of rows is
+    counted when the query is set; rows that are inserted or removed
+    later are not reflected until the query is set again. The database
+    must support LIMIT and OFFSET, as SQLite, PostgreSQL and MySQL do.
+
+    lastError() can be used to retrieve verbose information if there
+    was an error setting the query.
+
+    \note Calling setWindowedQuery() will remove any inserted columns.
+
+    \sa isWindowed(), setWindowSize(), setPrefetchEnabled(), setQuery()
+*/
+void QSqlQueryModel::setWindowedQuery(const QString &query, const QString &keyColumn,
+                                      const QSqlDatabase &db)
+{
+    Q_D(QSqlQueryModel);
+    beginResetModel();
+    d->resetWindows();
+
+    d->bottom = QModelIndex();
+    d->error = QSqlError();
+    d->atEnd = true;
+    d->windowed = true;
+    d->windowQuery = query;
+    d->keyColumn = keyColumn;
+    d->windowDb = db.isValid() ? db : QSqlDatabase::database();
+    d->query = QSqlQuery(d->windowDb);
+    d->query.setForwardOnly(true);
+
+#ifndef QT_NO_QFUTURE
+    if (d->prefetchEnabled && d->windowDb.isOpen() && !qIsPrivateDatabase(d->windowDb)) {
+        d->pool = new QSqlConnectionPool(d->windowDb);
+        d->pool->setMaxConnections(1);
+    }
+#endif
+
+    typedef QSqlQueryModelSql Sql;
+    const QSqlQueryResultSet *first = 0;
+    const QString count = Sql::concat(Sql::select(QLatin1String("COUNT(*)")),
+                                      Sql::from(Sql::as(Sql::paren(query), QLatin1String("qt_window"))));
+    if (d->query.exec(count) && d->query.next()) {
+        d->rowTotal = d->query.value(0).toInt();
+        first = d->window(0);
+    } else {
+        d->error = d->query.lastError();
+    }
+
+    QSqlRecord newRec;
+    if (first) {
+        newRec = first->record();
+        if (newRec.indexOf(keyColumn) == -1) {
+            d->error = QSqlError(QLatin1String("The key column is not a column of the query"),
+                                 QString(), QSqlError::StatementError);
+            newRec = QSqlRecord();
+            first = 0;
+        }
+    }
+
+    if (d->colOffsets.size() != newRec.count() || newRec != d->rec)
+        d->initColOffsets(newRec.count());
+    d->rec = newRec;
+
+    if (!first) {
+        d->resetWindows();
+        endResetModel();
+        return;
+    }
+
+    d->bottom = createIndex(d->rowTotal - 1, d->rec.count() - 1);
+    endResetModel();
+    queryChange();
+}
+
+/*!
+    \since 5.6
+
+    Returns \c true if the model was set up with setWindowedQuery();
+    otherwise returns \c false.
+*/
+bool QSqlQueryModel::isWindowed() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->windowed;
+}
+
+/*!
+    \since 5.6
+
+    Returns the number of rows selected at a time in windowed mode. The
+    default is 1024.
+
+    \sa setWindowSize(), setWindowedQuery()
+*/
+int QSqlQueryModel::windowSize() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->windowSize;
+}
+
+/*!
+    \since 5.6
+
+    Sets the number of rows selected at a time in windowed mode to \a
+    rows. The model keeps three windows, so a window should hold a few
+    screens of rows. Changing the size drops the windows that have been
+    selected.
+
+    \sa windowSize()
+*/
+void QSqlQueryModel::setWindowSize(int rows)
+{
+    Q_D(QSqlQueryModel);
+    rows = qMax(1, rows);
+    if (rows == d->windowSize)
+        return;
+    d->windowSize = rows;
+    d->clearWindows();
+}
+
+/*!
+    \since 5.6
+
+    Returns \c true if windowed mode selects the windows around the
+    current one in the background; otherwise returns \c false. The
+    default is \c true.
+
+    \sa setPrefetchEnabled()
+*/
+bool QSqlQueryModel::isPrefetchEnabled() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->prefetchEnabled;
+}
+
+/*!
+    \since 5.6
+
+    Sets whether windowed mode selects the windows around the current
+    one in the background to \a enable. The setting applies to the next
+    call of setWindowedQuery().
+
+    Prefetching opens a second connection to the database with the
+    parameters of the model's connection. It is not used for SQLite
+    in-memory databases, which cannot be shared between connections.
+
+    \sa isPrefetchEnabled(), QSqlConnectionPool
+*/
+void QSqlQueryModel::setPrefetchEnabled(bool enable)
+{
+    Q_D(QSqlQueryModel);
+    d->prefetchEnabled = enable;
+}
+
 /*!
     Clears the model and releases any acquired resource.
 */
@@ -472,6 +841,7 @@ void QSqlQueryModel::clear()
 {
     Q_D(QSqlQueryModel);
     beginResetModel();
+    d->resetWindows();
     d->error = QSqlError();
     d->atEnd = true;
     d->query.clear();
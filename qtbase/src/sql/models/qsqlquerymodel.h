@@ -72,6 +72,14 @@ public:
     void setQuery(const QString &query, const QSqlDatabase &db = QSqlDatabase());
     QSqlQuery query() const;
 
+    void setWindowedQuery(const QString &query, const QString &keyColumn,
+                          const QSqlDatabase &db = QSqlDatabase());
+    bool isWindowed() const;
+    int windowSize() const;
+    void setWindowSize(int rows);
+    bool isPrefetchEnabled() const;
+    void setPrefetchEnabled(bool enable);
+
     virtual void clear();
 
     QSqlError lastError() const;
@@ -48,24 +48,43 @@
 #include "private/qabstractitemmodel_p.h"
 #include "QtSql/qsqlerror.h"
 #include "QtSql/qsqlquery.h"
+#include "QtSql/qsqlqueryresultset.h"
 #include "QtSql/qsqlrecord.h"
+#include "QtCore/qfuture.h"
 #include "QtCore/qhash.h"
+#include "QtCore/qlist.h"
 #include "QtCore/qvarlengtharray.h"
 #include "QtCore/qvector.h"
 
 QT_BEGIN_NAMESPACE
 
+class QSqlConnectionPool;
+
 class QSqlQueryModelPrivate: public QAbstractItemModelPrivate
 {
     Q_DECLARE_PUBLIC(QSqlQueryModel)
 public:
-    QSqlQueryModelPrivate() : atEnd(false), nestedResetLevel(0) {}
+    QSqlQueryModelPrivate() : atEnd(false), nestedResetLevel(0), windowed(false),
+        windowSize(1024), rowTotal(0), prefetchEnabled(true), pool(0) {}
     ~QSqlQueryModelPrivate();
 
     void prefetch(int);
     void initColOffsets(int size);
     int columnInQuery(int modelColumn) const;
 
+    // windowed mode, see QSqlQueryModel::setWindowedQuery()
+    struct Window {
+        int index; // holds the rows from index * windowSize on
+        QSqlQueryResultSet rows;
+    };
+
+    QString windowStatement(int index, QVariantList *values) const;
+    QSqlQueryResultSet loadWindow(int index);
+    const QSqlQueryResultSet *window(int index);
+    void prefetchWindows(int index);
+    void clearWindows();
+    void resetWindows();
+
     mutable QSqlQuery query;
     mutable QSqlError error;
     QModelIndex bottom;
@@ -74,7 +93,22 @@ public:
     QVector<QHash<int, QVariant> > headers;
     QVarLengthArray<int, 56> colOffsets; // used to calculate indexInQuery of columns
     int nestedResetLevel;
+
+    bool windowed;
+    QString windowQuery;
+    QString keyColumn;
+    QSqlDatabase windowDb;
+    int windowSize;
+    int rowTotal;
+    bool prefetchEnabled;
+    // the most recently used first
+    QList<Window> windows;
+#ifndef QT_NO_QFUTURE
+    QHash<int, QFuture<QSqlQueryResultSet> > pendingWindows;
+#endif
+    QSqlConnectionPool *pool;
 };
+Q_DECLARE_TYPEINFO(QSqlQueryModelPrivate::Window, Q_MOVABLE_TYPE);
 
 // helpers for building SQL expressions
 class QSqlQueryModelSql
@@ -90,6 +124,8 @@ public:
     inline const static QLatin1String et() { return QLatin1String("AND"); }
     inline const static QLatin1String from() { return QLatin1String("FROM"); }
     inline const static QLatin1String leftJoin() { return QLatin1String("LEFT JOIN"); }
+    inline const static QLatin1String limit() { return QLatin1String("LIMIT"); }
+    inline const static QLatin1String offset() { return QLatin1String("OFFSET"); }
     inline const static QLatin1String on() { return QLatin1String("ON"); }
     inline const static QLatin1String orderBy() { return QLatin1String("ORDER BY"); }
     inline const static QLatin1String parenClose() { return QLatin1String(")"); }
@@ -108,6 +144,8 @@ public:
     inline const static QString et(const QString &a, const QString &b) { return a.isEmpty() ? b : b.isEmpty() ? a : concat(concat(a, et()), b); }
     inline const static QString from(const QString &s) { return concat(from(), s); }
     inline const static QString leftJoin(const QString &s) { return concat(leftJoin(), s); }
+    inline const static QString limit(int n) { return concat(limit(), QString::number(n)); }
+    inline const static QString offset(int n) { return concat(offset(), QString::number(n)); }
     inline const static QString on(const QString &s) { return concat(on(), s); }
     inline const static QString orderBy(const QString &s) { return s.isEmpty() ? s : concat(orderBy(), s); }
     inline const static QString paren(const QString &s) { return s.isEmpty() ? s : parenOpen() + s + parenClose(); }
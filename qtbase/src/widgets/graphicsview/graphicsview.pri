@@ -14,6 +14,8 @@ HEADERS += graphicsview/qgraphicsgridlayout.h \
     graphicsview/qgraphicsscene_bsp_p.h \
     graphicsview/qgraphicsscene_p.h \
     graphicsview/qgraphicsscenebsptreeindex_p.h \
+    graphicsview/qgraphicsscene_rtree_p.h \
+    graphicsview/qgraphicsscenertreeindex_p.h \
     graphicsview/qgraphicssceneevent.h \
     graphicsview/qgraphicssceneindex_p.h \
     graphicsview/qgraphicsscenelinearindex_p.h \
@@ -21,6 +23,7 @@ HEADERS += graphicsview/qgraphicsgridlayout.h \
     graphicsview/qgraphicstransform_p.h \
     graphicsview/qgraphicsview.h \
     graphicsview/qgraphicsview_p.h \
+    graphicsview/qgraphicsviewtilecache_p.h \
     graphicsview/qgraphicswidget.h \
     graphicsview/qgraphicswidget_p.h \
     graphicsview/qgraphicslayoutstyleinfo_p.h \
@@ -41,11 +44,14 @@ SOURCES += graphicsview/qgraphicsgridlayout.cpp \
     graphicsview/qgraphicsscene.cpp \
     graphicsview/qgraphicsscene_bsp.cpp \
     graphicsview/qgraphicsscenebsptreeindex.cpp \
+    graphicsview/qgraphicsscene_rtree.cpp \
+    graphicsview/qgraphicsscenertreeindex.cpp \
     graphicsview/qgraphicssceneevent.cpp \
     graphicsview/qgraphicssceneindex.cpp \
     graphicsview/qgraphicsscenelinearindex.cpp \
     graphicsview/qgraphicstransform.cpp \
     graphicsview/qgraphicsview.cpp \
+    graphicsview/qgraphicsviewtilecache.cpp \
     graphicsview/qgraphicswidget.cpp \
     graphicsview/qgraphicswidget_p.cpp \
     graphicsview/qgraphicslayoutstyleinfo.cpp \
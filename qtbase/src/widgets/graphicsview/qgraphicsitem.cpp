@@ -430,6 +430,17 @@
     ItemClipsChildrenToShape.
 
     This flag was introduced in Qt 5.4.
+
+    \value ItemPaintsStandardShape The item is a QGraphicsRectItem,
+    QGraphicsEllipseItem, QGraphicsPolygonItem, QGraphicsPathItem or
+    QGraphicsLineItem, or a subclass of one of them that does not reimplement
+    paint(). QGraphicsView can then draw the item's shape with the item's pen
+    and brush itself, as enabled by the SimplifyTinyItems, BatchSimpleItems and
+    ElidePainterState optimization flags of QGraphicsView. Do not set this
+    flag on items whose paint() draws anything else. The flag is disabled by
+    default.
+
+    This flag was introduced in Qt 5.6.
 */
 
 /*!
@@ -11522,6 +11533,9 @@ QDebug operator<<(QDebug debug, QGraphicsItem::GraphicsItemFlag flag)
     case QGraphicsItem::ItemContainsChildrenInShape:
         str = "ItemContainsChildrenInShape";
         break;
+    case QGraphicsItem::ItemPaintsStandardShape:
+        str = "ItemPaintsStandardShape";
+        break;
     }
     debug << str;
     return debug;
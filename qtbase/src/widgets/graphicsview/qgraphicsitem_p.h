@@ -551,7 +551,7 @@ public:
     quint32 fullUpdatePending : 1;
 
     // Packed 32 bits
-    quint32 flags : 20;
+    quint32 flags : 21;
     quint32 paintedViewBoundingRectsNeedRepaint : 1;
     quint32 dirtySceneTransform : 1;
     quint32 geometryChanged : 1;
@@ -563,9 +563,9 @@ public:
     quint32 acceptedTouchBeginEvent : 1;
     quint32 filtersDescendantEvents : 1;
     quint32 sceneTransformTranslateOnly : 1;
-    quint32 notifyBoundingRectChanged : 1;
 
     // New 32 bits
+    quint32 notifyBoundingRectChanged : 1;
     quint32 notifyInvalidated : 1;
     quint32 mouseSetsFocus : 1;
     quint32 explicitActivate : 1;
@@ -579,7 +579,7 @@ public:
     quint32 isDeclarativeItem : 1;
     quint32 sendParentChangeNotification : 1;
     quint32 dirtyChildrenBoundingRect : 1;
-    quint32 padding : 19;
+    quint32 padding : 18;
 
     // Optional stacking order
     int globalStackingOrder;
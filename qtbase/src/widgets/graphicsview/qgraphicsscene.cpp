@@ -187,6 +187,13 @@
     removing items is logarithmic. This approach is best for static scenes
     (i.e., scenes where most items do not move).
 
+    \value RTreeIndex A dynamic R*-tree is applied. Item location is of
+    logarithmic complexity, and the tree adapts to the distribution of the
+    items instead of to the scene rect. Adding, moving and removing items is
+    logarithmic as well, and small moves are applied in place, which makes
+    this approach suitable for large scenes where many items move. This value
+    was introduced in Qt 5.6.
+
     \value NoIndex No index is applied. Item location is of linear complexity,
     as all items on the scene are searched. Adding, moving and removing items,
     however, is done in constant time. This approach is ideal for dynamic
@@ -211,6 +218,7 @@
 #include "qgraphicssceneindex_p.h"
 #include "qgraphicsscenebsptreeindex_p.h"
 #include "qgraphicsscenelinearindex_p.h"
+#include "qgraphicsscenertreeindex_p.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qlist.h>
@@ -291,6 +299,9 @@ QGraphicsScenePrivate::QGraphicsScenePrivate()
       painterStateProtection(true),
       sortCacheEnabled(false),
       allItemsIgnoreTouchEvents(true),
+      simplifyTinyItems(false),
+      batchSimpleItems(false),
+      elidePainterState(false),
       minimumRenderSize(0.0),
       selectionChanging(0),
       rectAdjust(2),
@@ -1834,7 +1845,9 @@ void QGraphicsScene::render(QPainter *painter, const QRectF &target, const QRect
 
     For the common case, the default index method BspTreeIndex works fine.  If
     your scene uses many animations and you are experiencing slowness, you can
-    disable indexing by calling \c setItemIndexMethod(NoIndex).
+    disable indexing by calling \c setItemIndexMethod(NoIndex). For large
+    scenes where many items move, RTreeIndex usually gives both fast lookups
+    and cheap updates.
 
     \sa bspTreeDepth
 */
@@ -1855,6 +1868,8 @@ void QGraphicsScene::setItemIndexMethod(ItemIndexMethod method)
     delete d->index;
     if (method == BspTreeIndex)
         d->index = new QGraphicsSceneBspTreeIndex(this);
+    else if (method == RTreeIndex)
+        d->index = new QGraphicsSceneRTreeIndex(this);
     else
         d->index = new QGraphicsSceneLinearIndex(this);
     for (int i = oldItems.size() - 1; i >= 0; --i)
@@ -4672,6 +4687,231 @@ void QGraphicsScenePrivate::drawItemHelper(QGraphicsItem *item, QPainter *painte
     }
 }
 
+/*
+    Returns \c true if \a item is one of the standard shape items, whose
+    paint() only sets the pen and brush and draws the item's geometry (and
+    the selection highlight). The type alone does not tell whether a
+    subclass reimplements paint(), so the item has to opt in with
+    QGraphicsItem::ItemPaintsStandardShape.
+*/
+static inline bool qt_isSimpleShapeItem(const QGraphicsItem *item)
+{
+    if (!(item->flags() & QGraphicsItem::ItemPaintsStandardShape))
+        return false;
+    switch (item->type()) {
+    case QGraphicsRectItem::Type:
+    case QGraphicsEllipseItem::Type:
+    case QGraphicsPolygonItem::Type:
+    case QGraphicsPathItem::Type:
+    case QGraphicsLineItem::Type:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Items smaller than this, in device pixels, are simplified when the
+// QGraphicsView::SimplifyTinyItems optimization flag is set.
+static const qreal qt_tinyItemSize = 2.0;
+
+static inline QColor qt_brushColor(const QBrush &brush)
+{
+    if (const QGradient *gradient = brush.gradient()) {
+        const QGradientStops stops = gradient->stops();
+        return stops.isEmpty() ? QColor() : stops.at(stops.size() / 2).second;
+    }
+    return brush.color();
+}
+
+/*
+    Determines the \a color a tiny standard shape \a item is drawn with
+    as a box. Returns \c false for other items, which are painted
+    normally.
+*/
+static bool qt_tinyItemColor(const QGraphicsItem *item, QColor *color)
+{
+    if (!qt_isSimpleShapeItem(item))
+        return false;
+
+    if (item->type() == QGraphicsLineItem::Type) {
+        const QPen pen = static_cast<const QGraphicsLineItem *>(item)->pen();
+        *color = pen.style() != Qt::NoPen ? qt_brushColor(pen.brush()) : QColor(Qt::transparent);
+        return true;
+    }
+
+    const QAbstractGraphicsShapeItem *shapeItem = static_cast<const QAbstractGraphicsShapeItem *>(item);
+    const QBrush brush = shapeItem->brush();
+    if (brush.style() != Qt::NoBrush) {
+        *color = qt_brushColor(brush);
+    } else {
+        const QPen pen = shapeItem->pen();
+        *color = pen.style() != Qt::NoPen ? qt_brushColor(pen.brush()) : QColor(Qt::transparent);
+    }
+    return true;
+}
+
+static inline bool qt_isOpaque(const QPen &pen)
+{
+    return pen.style() == Qt::NoPen || pen.brush().isOpaque();
+}
+
+static inline bool qt_isOpaque(const QBrush &brush)
+{
+    return brush.style() == Qt::NoBrush || brush.isOpaque();
+}
+
+// The number of items in a batch, which bounds the cost of the overlap checks.
+static const int qt_maxItemBatchSize = 256;
+
+static bool qt_overlapsItemBatch(const QRect &rect, const QVector<QRect> &rects, const QRect &bounds)
+{
+    if (!bounds.intersects(rect))
+        return false;
+    for (int i = 0; i < rects.size(); ++i) {
+        if (rects.at(i).intersects(rect))
+            return true;
+    }
+    return false;
+}
+
+/*
+    Adds the childless top-level \a item to \a batch if it can be drawn as
+    part of a single path together with the items before it, which is the
+    case for opaque rect, ellipse and line items with a translate-only
+    scene transform that do not share a pixel with any item of the batch,
+    so that the result is the same as painting them one by one. Items that
+    do not need to be drawn at all are also handled here. Returns \c false
+    if the item has to be drawn by drawSubtreeRecursive(); the caller must
+    flush the batch first.
+*/
+bool QGraphicsScenePrivate::batchItem(QGraphicsItem *item, ItemBatch *batch, QPainter *painter,
+                                      const QTransform *const viewTransform, QRegion *exposedRegion,
+                                      QWidget *widget)
+{
+    QGraphicsItemPrivate *itemd = item->d_ptr.data();
+    if (!itemd->visible)
+        return true;
+
+    const int type = item->type();
+    if (!qt_isSimpleShapeItem(item) || type == QGraphicsPolygonItem::Type
+        || type == QGraphicsPathItem::Type) {
+        return false;
+    }
+    if (!itemd->children.isEmpty() || itemd->cacheMode || itemd->selected
+#ifndef QT_NO_GRAPHICSEFFECT
+        || itemd->graphicsEffect
+#endif
+        || (itemd->flags & (QGraphicsItem::ItemClipsToShape | QGraphicsItem::ItemHasNoContents
+                            | QGraphicsItem::ItemIgnoresTransformations))) {
+        return false;
+    }
+
+    const qreal opacity = itemd->combineOpacityFromParent(qreal(1.0));
+    if (QGraphicsItemPrivate::isOpacityNull(opacity))
+        return true;
+    if (opacity < qreal(1.0))
+        return false;
+
+    if (itemd->dirtySceneTransform)
+        itemd->updateSceneTransformFromParent();
+    if (!itemd->sceneTransformTranslateOnly)
+        return false;
+
+    QPainterPath shape;
+    QPen pen;
+    QBrush brush;
+    if (type == QGraphicsLineItem::Type) {
+        const QGraphicsLineItem *lineItem = static_cast<const QGraphicsLineItem *>(item);
+        const QLineF line = lineItem->line();
+        pen = lineItem->pen();
+        shape.moveTo(line.p1());
+        shape.lineTo(line.p2());
+    } else {
+        const QAbstractGraphicsShapeItem *shapeItem = static_cast<const QAbstractGraphicsShapeItem *>(item);
+        pen = shapeItem->pen();
+        brush = shapeItem->brush();
+        if (type == QGraphicsRectItem::Type) {
+            shape.addRect(static_cast<const QGraphicsRectItem *>(item)->rect().normalized());
+        } else {
+            const QGraphicsEllipseItem *ellipseItem = static_cast<const QGraphicsEllipseItem *>(item);
+            const int spanAngle = ellipseItem->spanAngle();
+            if (spanAngle == 0 || qAbs(spanAngle) % (360 * 16) != 0)
+                return false; // pies are drawn individually
+            shape.addEllipse(ellipseItem->rect().normalized());
+        }
+    }
+    if (!qt_isOpaque(pen) || !qt_isOpaque(brush))
+        return false;
+
+    const QRectF brect = adjustedItemEffectiveBoundingRect(item);
+    const QRectF preciseViewBoundingRect = viewTransform
+        ? (itemd->sceneTransform * *viewTransform).mapRect(brect)
+        : brect.translated(itemd->sceneTransform.dx(), itemd->sceneTransform.dy());
+    if (minimumRenderSize > 0.0
+        && (preciseViewBoundingRect.width() < minimumRenderSize
+            || preciseViewBoundingRect.height() < minimumRenderSize)) {
+        return true;
+    }
+    if (simplifyTinyItems
+        && preciseViewBoundingRect.width() < qt_tinyItemSize
+        && preciseViewBoundingRect.height() < qt_tinyItemSize) {
+        return false; // drawn as a box, which is cheaper still
+    }
+
+    QRect viewBoundingRect = preciseViewBoundingRect.toAlignedRect();
+    viewBoundingRect.adjust(-int(rectAdjust), -int(rectAdjust), rectAdjust, rectAdjust);
+    if (widget)
+        itemd->paintedViewBoundingRects.insert(widget, viewBoundingRect);
+    if (exposedRegion ? !exposedRegion->intersects(viewBoundingRect)
+                      : viewBoundingRect.normalized().isEmpty()) {
+        return true;
+    }
+
+    // A path strokes all outlines after filling all shapes, so items that
+    // overlap one in the batch start a new one.
+    if (batch->count && (type != batch->type || pen != batch->pen || brush != batch->brush
+                         || batch->count >= qt_maxItemBatchSize
+                         || qt_overlapsItemBatch(viewBoundingRect, batch->rects, batch->bounds))) {
+        flushItemBatch(batch, painter, viewTransform);
+    }
+    if (!batch->count) {
+        batch->type = type;
+        batch->pen = pen;
+        batch->brush = brush;
+    }
+    batch->path.addPath(shape.translated(itemd->sceneTransform.dx(), itemd->sceneTransform.dy()));
+    batch->rects.append(viewBoundingRect);
+    batch->bounds |= viewBoundingRect;
+    ++batch->count;
+    return true;
+}
+
+void QGraphicsScenePrivate::flushItemBatch(ItemBatch *batch, QPainter *painter,
+                                           const QTransform *const viewTransform)
+{
+    if (!batch->count)
+        return;
+
+    const QPen oldPen = painter->pen();
+    const QBrush oldBrush = painter->brush();
+    const QTransform oldTransform = painter->worldTransform();
+    const qreal oldOpacity = painter->opacity();
+    painter->setWorldTransform(viewTransform ? *viewTransform : QTransform());
+    painter->setOpacity(1.0);
+    painter->setPen(batch->pen);
+    painter->setBrush(batch->brush);
+    painter->drawPath(batch->path);
+    painter->setPen(oldPen);
+    painter->setBrush(oldBrush);
+    painter->setWorldTransform(oldTransform);
+    painter->setOpacity(oldOpacity);
+
+    batch->path = QPainterPath();
+    batch->rects.clear();
+    batch->bounds = QRect();
+    batch->count = 0;
+}
+
 void QGraphicsScenePrivate::drawItems(QPainter *painter, const QTransform *const viewTransform,
                                       QRegion *exposedRegion, QWidget *widget)
 {
@@ -4687,8 +4927,21 @@ void QGraphicsScenePrivate::drawItems(QPainter *painter, const QTransform *const
             exposedSceneRect = viewTransform->inverted().mapRect(exposedSceneRect);
     }
     const QList<QGraphicsItem *> tli = index->estimateTopLevelItems(exposedSceneRect, Qt::AscendingOrder);
-    for (int i = 0; i < tli.size(); ++i)
-        drawSubtreeRecursive(tli.at(i), painter, viewTransform, exposedRegion, widget);
+    if (!batchSimpleItems) {
+        for (int i = 0; i < tli.size(); ++i)
+            drawSubtreeRecursive(tli.at(i), painter, viewTransform, exposedRegion, widget);
+        return;
+    }
+
+    ItemBatch batch;
+    for (int i = 0; i < tli.size(); ++i) {
+        QGraphicsItem *item = tli.at(i);
+        if (batchItem(item, &batch, painter, viewTransform, exposedRegion, widget))
+            continue;
+        flushItemBatch(&batch, painter, viewTransform);
+        drawSubtreeRecursive(item, painter, viewTransform, exposedRegion, widget);
+    }
+    flushItemBatch(&batch, painter, viewTransform);
 }
 
 void QGraphicsScenePrivate::drawSubtreeRecursive(QGraphicsItem *item, QPainter *painter,
@@ -4768,6 +5021,31 @@ void QGraphicsScenePrivate::drawSubtreeRecursive(QGraphicsItem *item, QPainter *
             itemIsOutsideVisibleRect = !drawItem;
         }
 
+        // Level of detail: draw tiny shape items as a box in their color.
+        if (drawItem && simplifyTinyItems && !itemHasChildren && !effectTransform
+#ifndef QT_NO_GRAPHICSEFFECT
+            && !item->d_ptr->graphicsEffect
+#endif
+            && preciseViewBoundingRect.width() < qt_tinyItemSize
+            && preciseViewBoundingRect.height() < qt_tinyItemSize) {
+            QColor color;
+            if (qt_tinyItemColor(item, &color)) {
+                if (color.alpha()) {
+                    const QTransform oldTransform = painter->worldTransform();
+                    const qreal oldOpacity = painter->opacity();
+                    painter->setWorldTransform(QTransform());
+                    painter->setOpacity(opacity);
+                    painter->fillRect(QRectF(preciseViewBoundingRect.topLeft(),
+                                             QSizeF(qMax(preciseViewBoundingRect.width(), qreal(1.0)),
+                                                    qMax(preciseViewBoundingRect.height(), qreal(1.0)))),
+                                      color);
+                    painter->setWorldTransform(oldTransform);
+                    painter->setOpacity(oldOpacity);
+                }
+                return;
+            }
+        }
+
         if (itemIsTooSmallToRender || itemIsOutsideVisibleRect) {
             // We cannot simply use !drawItem here. If we did it is possible
             // to enter the outter if statement with drawItem == false and minimumRenderSize > 0
@@ -4929,8 +5207,20 @@ void QGraphicsScenePrivate::draw(QGraphicsItem *item, QPainter *painter, const Q
             setChildClip = false;
         }
 
-        if (painterStateProtection && !restorePainterClip)
+        // The standard shape items only change the pen and brush, so there
+        // is no need to save and restore the whole painter state for them.
+        const bool elideState = painterStateProtection && elidePainterState && !restorePainterClip
+                                && !item->d_ptr->cacheMode && qt_isSimpleShapeItem(item);
+        QPen oldPen;
+        QBrush oldBrush;
+        qreal oldOpacity = 1.0;
+        if (elideState) {
+            oldPen = painter->pen();
+            oldBrush = painter->brush();
+            oldOpacity = painter->opacity();
+        } else if (painterStateProtection && !restorePainterClip) {
             painter->save();
+        }
 
         painter->setOpacity(opacity);
         if (!item->d_ptr->cacheMode && !item->d_ptr->isWidget)
@@ -4938,8 +5228,13 @@ void QGraphicsScenePrivate::draw(QGraphicsItem *item, QPainter *painter, const Q
         else
             drawItemHelper(item, painter, &styleOptionTmp, widget, painterStateProtection);
 
-        if (painterStateProtection || restorePainterClip)
+        if (elideState) {
+            painter->setPen(oldPen);
+            painter->setBrush(oldBrush);
+            painter->setOpacity(oldOpacity);
+        } else if (painterStateProtection || restorePainterClip) {
             painter->restore();
+        }
 
         static int drawRect = qEnvironmentVariableIntValue("QT_DRAW_SCENE_ITEM_RECTS");
         if (drawRect) {
@@ -104,6 +104,7 @@ class Q_WIDGETS_EXPORT QGraphicsScene : public QObject
 public:
     enum ItemIndexMethod {
         BspTreeIndex,
+        RTreeIndex,
         NoIndex = -1
     };
 
@@ -313,6 +314,8 @@ private:
     friend class QGraphicsSceneIndexPrivate;
     friend class QGraphicsSceneBspTreeIndex;
     friend class QGraphicsSceneBspTreeIndexPrivate;
+    friend class QGraphicsSceneRTreeIndex;
+    friend class QGraphicsSceneRTreeIndexPrivate;
     friend class QGraphicsItemEffectSourcePrivate;
 #ifndef QT_NO_GESTURES
     friend class QGesture;
@@ -59,8 +59,11 @@
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qset.h>
+#include <QtGui/qbrush.h>
 #include <QtGui/qfont.h>
+#include <QtGui/qpainterpath.h>
 #include <QtGui/qpalette.h>
+#include <QtGui/qpen.h>
 #include <QtWidgets/qstyle.h>
 #include <QtWidgets/qstyleoption.h>
 
@@ -107,7 +110,10 @@ public:
     quint32 painterStateProtection : 1;
     quint32 sortCacheEnabled : 1; // for compatibility
     quint32 allItemsIgnoreTouchEvents : 1;
-    quint32 padding : 15;
+    quint32 simplifyTinyItems : 1;
+    quint32 batchSimpleItems : 1;
+    quint32 elidePainterState : 1;
+    quint32 padding : 12;
 
     qreal minimumRenderSize;
 
@@ -216,6 +222,22 @@ public:
     void drawItems(QPainter *painter, const QTransform *const viewTransform,
                    QRegion *exposedRegion, QWidget *widget);
 
+    struct ItemBatch
+    {
+        ItemBatch() : type(0), count(0) {}
+        int type;
+        int count;
+        QPen pen;
+        QBrush brush;
+        QPainterPath path;
+        // the device rects of the items, which must not share any pixel
+        QVector<QRect> rects;
+        QRect bounds;
+    };
+    bool batchItem(QGraphicsItem *item, ItemBatch *batch, QPainter *painter,
+                   const QTransform *const viewTransform, QRegion *exposedRegion, QWidget *widget);
+    void flushItemBatch(ItemBatch *batch, QPainter *painter, const QTransform *const viewTransform);
+
     void drawSubtreeRecursive(QGraphicsItem *item, QPainter *painter, const QTransform *const,
                               QRegion *exposedRegion, QWidget *widget, qreal parentOpacity = qreal(1.0),
                               const QTransform *const effectTransform = 0);
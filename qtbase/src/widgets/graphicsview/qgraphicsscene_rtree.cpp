@@ -0,0 +1,639 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgraphicsscene_rtree_p.h"
+
+#ifndef QT_NO_GRAPHICSVIEW
+
+#include <QtCore/qmath.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qvarlengtharray.h>
+#include <private/qgraphicsitem_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// Unlike QRectF::united() and QRectF::intersects(), these treat rects as
+// closed point sets, so that items with an empty bounding rect are still
+// indexed (and found) at their position.
+static inline QRectF qt_boundingRect(const QRectF &a, const QRectF &b)
+{
+    return QRectF(QPointF(qMin(a.left(), b.left()), qMin(a.top(), b.top())),
+                  QPointF(qMax(a.right(), b.right()), qMax(a.bottom(), b.bottom())));
+}
+
+static inline bool qt_rectsOverlap(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+static inline bool qt_rectContains(const QRectF &outer, const QRectF &inner)
+{
+    return outer.left() <= inner.left() && inner.right() <= outer.right()
+        && outer.top() <= inner.top() && inner.bottom() <= outer.bottom();
+}
+
+static inline bool qt_sameRect(const QRectF &a, const QRectF &b)
+{
+    return a.x() == b.x() && a.y() == b.y() && a.width() == b.width() && a.height() == b.height();
+}
+
+static inline qreal qt_area(const QRectF &r)
+{
+    return r.width() * r.height();
+}
+
+static inline qreal qt_margin(const QRectF &r)
+{
+    return r.width() + r.height();
+}
+
+static inline qreal qt_overlap(const QRectF &a, const QRectF &b)
+{
+    const qreal w = qMin(a.right(), b.right()) - qMax(a.left(), b.left());
+    const qreal h = qMin(a.bottom(), b.bottom()) - qMax(a.top(), b.top());
+    return (w > 0 && h > 0) ? w * h : 0;
+}
+
+namespace {
+struct EntryLessThan
+{
+    EntryLessThan(Qt::Orientation orientation, bool upper) : orientation(orientation), upper(upper) {}
+
+    inline qreal key(const QGraphicsSceneRTree::Entry &entry) const
+    {
+        if (orientation == Qt::Horizontal)
+            return upper ? entry.rect.right() : entry.rect.left();
+        return upper ? entry.rect.bottom() : entry.rect.top();
+    }
+    inline bool operator()(const QGraphicsSceneRTree::Entry &e1, const QGraphicsSceneRTree::Entry &e2) const
+    { return key(e1) < key(e2); }
+
+    Qt::Orientation orientation;
+    bool upper;
+};
+
+struct EntryCenterLessThan
+{
+    explicit EntryCenterLessThan(Qt::Orientation orientation) : orientation(orientation) {}
+
+    inline bool operator()(const QGraphicsSceneRTree::Entry &e1, const QGraphicsSceneRTree::Entry &e2) const
+    {
+        if (orientation == Qt::Horizontal)
+            return e1.rect.left() + e1.rect.right() < e2.rect.left() + e2.rect.right();
+        return e1.rect.top() + e1.rect.bottom() < e2.rect.top() + e2.rect.bottom();
+    }
+
+    Qt::Orientation orientation;
+};
+}
+
+QGraphicsSceneRTree::QGraphicsSceneRTree()
+    : root(createNode(0)), size(0), reinsertedLevels(0)
+{
+}
+
+QGraphicsSceneRTree::~QGraphicsSceneRTree()
+{
+    deleteNode(root);
+}
+
+void QGraphicsSceneRTree::clear()
+{
+    deleteNode(root);
+    root = createNode(0);
+    leaves.clear();
+    size = 0;
+}
+
+/*
+    Inserts \a item with the scene bounding rect \a rect. The item's index
+    slot must be set and must not already be in use in this tree.
+*/
+void QGraphicsSceneRTree::insertItem(QGraphicsItem *item, const QRectF &rect)
+{
+    const int slot = item->d_ptr->index;
+    Q_ASSERT(slot >= 0);
+    if (slot >= leaves.size())
+        leaves.resize(qMax(slot + 1, leaves.size() * 2));
+    Q_ASSERT(!leaves.at(slot));
+
+    Entry entry;
+    entry.rect = rect.normalized();
+    entry.item = item;
+    reinsertedLevels = 0;
+    insertEntry(entry, 0);
+    ++size;
+}
+
+void QGraphicsSceneRTree::removeItem(QGraphicsItem *item)
+{
+    const int slot = item->d_ptr->index;
+    Node *leaf = slot >= 0 && slot < leaves.size() ? leaves.at(slot) : 0;
+    if (!leaf)
+        return;
+
+    leaves[slot] = 0;
+    for (int i = 0; i < leaf->count; ++i) {
+        if (leaf->entries[i].item == item) {
+            leaf->entries[i] = leaf->entries[--leaf->count];
+            break;
+        }
+    }
+    --size;
+    condenseTree(leaf);
+}
+
+/*
+    Moves \a item to \a rect. If the item stays inside its leaf's bounds
+    (the common case for small moves), the entry is updated in place and
+    only the bounds along the path to the root are tightened; otherwise the
+    item is reinserted.
+*/
+void QGraphicsSceneRTree::updateItem(QGraphicsItem *item, const QRectF &rect)
+{
+    const int slot = item->d_ptr->index;
+    Node *leaf = slot >= 0 && slot < leaves.size() ? leaves.at(slot) : 0;
+    if (!leaf) {
+        insertItem(item, rect);
+        return;
+    }
+
+    const QRectF newRect = rect.normalized();
+    if (leaf == root || qt_rectContains(leaf->parent->entries[entryIndex(leaf)].rect, newRect)) {
+        for (int i = 0; i < leaf->count; ++i) {
+            if (leaf->entries[i].item == item) {
+                leaf->entries[i].rect = newRect;
+                break;
+            }
+        }
+        updateNodeRect(leaf);
+        return;
+    }
+
+    removeItem(item);
+    insertItem(item, newRect);
+}
+
+/*
+    Builds the tree from \a items in one go using Sort-Tile-Recursive
+    packing, which gives much better node utilization and less overlap than
+    inserting the items one by one. The tree must be empty.
+*/
+void QGraphicsSceneRTree::bulkLoad(const QVector<Entry> &items)
+{
+    Q_ASSERT(isEmpty());
+    if (items.isEmpty())
+        return;
+
+    int maxSlot = -1;
+    for (int i = 0; i < items.size(); ++i)
+        maxSlot = qMax(maxSlot, items.at(i).item->d_ptr->index);
+    if (maxSlot >= leaves.size())
+        leaves.resize(maxSlot + 1);
+
+    QVector<Entry> entries = items;
+    for (int i = 0; i < entries.size(); ++i)
+        entries[i].rect = entries.at(i).rect.normalized();
+
+    int level = 0;
+    while (entries.size() > MaxEntries) {
+        entries = packLevel(entries, level);
+        ++level;
+    }
+
+    deleteNode(root);
+    root = createNode(level);
+    for (int i = 0; i < entries.size(); ++i)
+        appendEntry(root, entries.at(i));
+    size += items.size();
+}
+
+QVector<QGraphicsSceneRTree::Entry> QGraphicsSceneRTree::packLevel(QVector<Entry> &entries, int level)
+{
+    const int count = entries.size();
+    const int nodeCount = (count + MaxEntries - 1) / MaxEntries;
+    const int sliceCount = qCeil(qSqrt(qreal(nodeCount)));
+    const int sliceSize = ((nodeCount + sliceCount - 1) / sliceCount) * MaxEntries;
+
+    QVector<Entry> parentEntries;
+    parentEntries.reserve(nodeCount);
+
+    std::sort(entries.begin(), entries.end(), EntryCenterLessThan(Qt::Horizontal));
+    for (int start = 0; start < count; start += sliceSize) {
+        const int end = qMin(count, start + sliceSize);
+        std::sort(entries.begin() + start, entries.begin() + end, EntryCenterLessThan(Qt::Vertical));
+
+        // Spread the slice evenly over its nodes rather than leaving an
+        // almost empty node at the end.
+        const int sliceEntries = end - start;
+        const int sliceNodes = (sliceEntries + MaxEntries - 1) / MaxEntries;
+        for (int i = 0; i < sliceNodes; ++i) {
+            Node *node = createNode(level);
+            const int from = start + i * sliceEntries / sliceNodes;
+            const int to = start + (i + 1) * sliceEntries / sliceNodes;
+            for (int j = from; j < to; ++j)
+                appendEntry(node, entries.at(j));
+
+            Entry entry;
+            entry.rect = nodeRect(node);
+            entry.child = node;
+            parentEntries << entry;
+        }
+    }
+    return parentEntries;
+}
+
+QList<QGraphicsItem *> QGraphicsSceneRTree::items(const QRectF &rect, bool onlyTopLevelItems) const
+{
+    QList<QGraphicsItem *> found;
+    if (!root->count)
+        return found;
+
+    const QRectF area = rect.normalized();
+    QVarLengthArray<const Node *, 64> stack;
+    stack.append(root);
+    while (!stack.isEmpty()) {
+        const Node *node = stack.last();
+        stack.removeLast();
+        for (int i = 0; i < node->count; ++i) {
+            const Entry &entry = node->entries[i];
+            if (!qt_rectsOverlap(entry.rect, area))
+                continue;
+            if (node->level) {
+                stack.append(entry.child);
+                continue;
+            }
+            QGraphicsItem *item = entry.item;
+            if (onlyTopLevelItems && item->d_ptr->parent)
+                item = item->topLevelItem();
+            if (!item->d_func()->itemDiscovered && item->d_ptr->visible) {
+                item->d_func()->itemDiscovered = 1;
+                found << item;
+            }
+        }
+    }
+
+    // Reset discovery bits.
+    for (int i = 0; i < found.size(); ++i)
+        found.at(i)->d_ptr->itemDiscovered = 0;
+    return found;
+}
+
+QGraphicsSceneRTree::Node *QGraphicsSceneRTree::createNode(int level)
+{
+    Node *node = new Node;
+    node->parent = 0;
+    node->level = level;
+    node->count = 0;
+    return node;
+}
+
+void QGraphicsSceneRTree::deleteNode(Node *node)
+{
+    if (node->level) {
+        for (int i = 0; i < node->count; ++i)
+            deleteNode(node->entries[i].child);
+    }
+    delete node;
+}
+
+void QGraphicsSceneRTree::appendEntry(Node *node, const Entry &entry)
+{
+    Q_ASSERT(node->count <= MaxEntries);
+    node->entries[node->count++] = entry;
+    if (node->level)
+        entry.child->parent = node;
+    else
+        leaves[entry.item->d_ptr->index] = node;
+}
+
+int QGraphicsSceneRTree::entryIndex(const Node *node) const
+{
+    const Node *parent = node->parent;
+    Q_ASSERT(parent);
+    for (int i = 0; i < parent->count; ++i) {
+        if (parent->entries[i].child == node)
+            return i;
+    }
+    Q_UNREACHABLE();
+    return -1;
+}
+
+QRectF QGraphicsSceneRTree::nodeRect(const Node *node) const
+{
+    if (!node->count)
+        return QRectF();
+    QRectF rect = node->entries[0].rect;
+    for (int i = 1; i < node->count; ++i)
+        rect = qt_boundingRect(rect, node->entries[i].rect);
+    return rect;
+}
+
+/*
+    Recomputes the bounds of \a node in its parent, and of each ancestor in
+    turn, stopping as soon as a bound does not change.
+*/
+void QGraphicsSceneRTree::updateNodeRect(Node *node)
+{
+    while (Node *parent = node->parent) {
+        QRectF &rect = parent->entries[entryIndex(node)].rect;
+        const QRectF newRect = nodeRect(node);
+        if (qt_sameRect(rect, newRect))
+            return;
+        rect = newRect;
+        node = parent;
+    }
+}
+
+QGraphicsSceneRTree::Node *QGraphicsSceneRTree::chooseSubtree(const QRectF &rect, int level) const
+{
+    Node *node = root;
+    while (node->level > level) {
+        Q_ASSERT(node->count);
+        int best = 0;
+        if (node->level == 1) {
+            // The children are leaves: minimize the overlap enlargement,
+            // then the area enlargement, then the area.
+            qreal bestOverlap = 0, bestEnlargement = 0, bestArea = 0;
+            for (int i = 0; i < node->count; ++i) {
+                const QRectF &entryRect = node->entries[i].rect;
+                const QRectF grown = qt_boundingRect(entryRect, rect);
+                qreal overlap = 0;
+                for (int j = 0; j < node->count; ++j) {
+                    if (j != i) {
+                        overlap += qt_overlap(grown, node->entries[j].rect)
+                                   - qt_overlap(entryRect, node->entries[j].rect);
+                    }
+                }
+                const qreal area = qt_area(entryRect);
+                const qreal enlargement = qt_area(grown) - area;
+                if (i == 0 || overlap < bestOverlap
+                    || (overlap == bestOverlap && (enlargement < bestEnlargement
+                                                   || (enlargement == bestEnlargement && area < bestArea)))) {
+                    best = i;
+                    bestOverlap = overlap;
+                    bestEnlargement = enlargement;
+                    bestArea = area;
+                }
+            }
+        } else {
+            // Minimize the area enlargement, then the area.
+            qreal bestEnlargement = 0, bestArea = 0;
+            for (int i = 0; i < node->count; ++i) {
+                const QRectF &entryRect = node->entries[i].rect;
+                const qreal area = qt_area(entryRect);
+                const qreal enlargement = qt_area(qt_boundingRect(entryRect, rect)) - area;
+                if (i == 0 || enlargement < bestEnlargement
+                    || (enlargement == bestEnlargement && area < bestArea)) {
+                    best = i;
+                    bestEnlargement = enlargement;
+                    bestArea = area;
+                }
+            }
+        }
+        node = node->entries[best].child;
+    }
+    return node;
+}
+
+void QGraphicsSceneRTree::insertEntry(const Entry &entry, int level)
+{
+    Node *node = chooseSubtree(entry.rect, level);
+    appendEntry(node, entry);
+    if (node->count > MaxEntries)
+        treatOverflow(node);
+    else
+        updateNodeRect(node);
+}
+
+void QGraphicsSceneRTree::treatOverflow(Node *node)
+{
+    // Forced reinsertion is tried once per level and insertion; it lets
+    // the tree reorganize itself instead of splitting right away.
+    const uint levelBit = 1u << qMin(node->level, 31);
+    if (node != root && !(reinsertedLevels & levelBit)) {
+        reinsertedLevels |= levelBit;
+        reinsert(node);
+    } else {
+        split(node);
+    }
+}
+
+void QGraphicsSceneRTree::reinsert(Node *node)
+{
+    const QPointF center = nodeRect(node).center();
+    const int count = node->count;
+
+    QPair<qreal, int> distances[MaxEntries + 1];
+    for (int i = 0; i < count; ++i) {
+        const QPointF d = node->entries[i].rect.center() - center;
+        distances[i] = qMakePair(-(d.x() * d.x() + d.y() * d.y()), i);
+    }
+    std::sort(distances, distances + count);
+
+    // Take out the entries farthest from the center...
+    Entry removed[ReinsertEntries];
+    Entry kept[MaxEntries + 1];
+    for (int i = 0; i < ReinsertEntries; ++i)
+        removed[i] = node->entries[distances[i].second];
+    for (int i = ReinsertEntries; i < count; ++i)
+        kept[i - ReinsertEntries] = node->entries[distances[i].second];
+    node->count = 0;
+    for (int i = 0; i < count - ReinsertEntries; ++i)
+        appendEntry(node, kept[i]);
+    updateNodeRect(node);
+
+    // ...and insert them again, closest first.
+    const int level = node->level;
+    for (int i = ReinsertEntries - 1; i >= 0; --i)
+        insertEntry(removed[i], level);
+}
+
+void QGraphicsSceneRTree::split(Node *node)
+{
+    const int count = node->count;
+    Entry entries[MaxEntries + 1];
+    std::copy(node->entries, node->entries + count, entries);
+
+    QRectF lower[MaxEntries + 1];
+    QRectF upper[MaxEntries + 1];
+    const int distributions = count - 2 * MinEntries + 1;
+
+    // Choose the split axis: the one with the smallest sum of margins over
+    // all distributions.
+    Qt::Orientation axis = Qt::Horizontal;
+    qreal bestMarginSum = 0;
+    for (int a = 0; a < 2; ++a) {
+        const Qt::Orientation orientation = a ? Qt::Vertical : Qt::Horizontal;
+        qreal marginSum = 0;
+        for (int u = 0; u < 2; ++u) {
+            std::sort(entries, entries + count, EntryLessThan(orientation, u));
+            lower[0] = entries[0].rect;
+            for (int i = 1; i < count; ++i)
+                lower[i] = qt_boundingRect(lower[i - 1], entries[i].rect);
+            upper[count - 1] = entries[count - 1].rect;
+            for (int i = count - 2; i >= 0; --i)
+                upper[i] = qt_boundingRect(upper[i + 1], entries[i].rect);
+            for (int k = 0; k < distributions; ++k) {
+                const int first = MinEntries + k;
+                marginSum += qt_margin(lower[first - 1]) + qt_margin(upper[first]);
+            }
+        }
+        if (a == 0 || marginSum < bestMarginSum) {
+            axis = orientation;
+            bestMarginSum = marginSum;
+        }
+    }
+
+    // Along that axis, choose the distribution with the least overlap, then
+    // the least area.
+    bool bestUpper = false;
+    int bestFirst = MinEntries;
+    qreal bestOverlap = 0, bestArea = 0;
+    for (int u = 0; u < 2; ++u) {
+        std::sort(entries, entries + count, EntryLessThan(axis, u));
+        lower[0] = entries[0].rect;
+        for (int i = 1; i < count; ++i)
+            lower[i] = qt_boundingRect(lower[i - 1], entries[i].rect);
+        upper[count - 1] = entries[count - 1].rect;
+        for (int i = count - 2; i >= 0; --i)
+            upper[i] = qt_boundingRect(upper[i + 1], entries[i].rect);
+        for (int k = 0; k < distributions; ++k) {
+            const int first = MinEntries + k;
+            const qreal overlap = qt_overlap(lower[first - 1], upper[first]);
+            const qreal area = qt_area(lower[first - 1]) + qt_area(upper[first]);
+            if ((u == 0 && k == 0) || overlap < bestOverlap
+                || (overlap == bestOverlap && area < bestArea)) {
+                bestUpper = u;
+                bestFirst = first;
+                bestOverlap = overlap;
+                bestArea = area;
+            }
+        }
+    }
+    std::sort(entries, entries + count, EntryLessThan(axis, bestUpper));
+
+    Node *sibling = createNode(node->level);
+    node->count = 0;
+    for (int i = 0; i < bestFirst; ++i)
+        appendEntry(node, entries[i]);
+    for (int i = bestFirst; i < count; ++i)
+        appendEntry(sibling, entries[i]);
+
+    Entry siblingEntry;
+    siblingEntry.rect = nodeRect(sibling);
+    siblingEntry.child = sibling;
+
+    if (node == root) {
+        root = createNode(node->level + 1);
+        Entry nodeEntry;
+        nodeEntry.rect = nodeRect(node);
+        nodeEntry.child = node;
+        appendEntry(root, nodeEntry);
+        appendEntry(root, siblingEntry);
+        return;
+    }
+
+    Node *parent = node->parent;
+    parent->entries[entryIndex(node)].rect = nodeRect(node);
+    appendEntry(parent, siblingEntry);
+    if (parent->count > MaxEntries)
+        treatOverflow(parent);
+    else
+        updateNodeRect(parent);
+}
+
+static void qt_takeItems(QGraphicsSceneRTree::Node *node, QVector<QGraphicsSceneRTree::Entry> *items)
+{
+    for (int i = 0; i < node->count; ++i) {
+        if (node->level)
+            qt_takeItems(node->entries[i].child, items);
+        else
+            *items << node->entries[i];
+    }
+    delete node;
+}
+
+/*
+    Called after an entry was removed from \a leaf. Nodes that became
+    underfull on the way to the root are taken out of the tree, and their
+    items are inserted again.
+*/
+void QGraphicsSceneRTree::condenseTree(Node *leaf)
+{
+    QVarLengthArray<Node *, 8> eliminated;
+    Node *node = leaf;
+    while (node != root) {
+        Node *parent = node->parent;
+        const int i = entryIndex(node);
+        if (node->count < MinEntries) {
+            parent->entries[i] = parent->entries[--parent->count];
+            eliminated.append(node);
+        } else {
+            const QRectF rect = nodeRect(node);
+            if (qt_sameRect(rect, parent->entries[i].rect))
+                break;
+            parent->entries[i].rect = rect;
+        }
+        node = parent;
+    }
+
+    QVector<Entry> orphans;
+    for (int i = 0; i < eliminated.size(); ++i)
+        qt_takeItems(eliminated.at(i), &orphans);
+
+    // Shorten the tree while the root has a single child.
+    while (root->level && root->count <= 1) {
+        Node *oldRoot = root;
+        if (root->count) {
+            root = root->entries[0].child;
+            root->parent = 0;
+        } else {
+            root = createNode(0);
+        }
+        delete oldRoot;
+    }
+
+    for (int i = 0; i < orphans.size(); ++i) {
+        leaves[orphans.at(i).item->d_ptr->index] = 0;
+        reinsertedLevels = 0;
+        insertEntry(orphans.at(i), 0);
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_GRAPHICSVIEW
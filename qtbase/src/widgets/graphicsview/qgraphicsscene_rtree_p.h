@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGRAPHICSSCENERTREE_P_H
+#define QGRAPHICSSCENERTREE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qlist.h>
+
+#if !defined(QT_NO_GRAPHICSVIEW)
+
+#include <QtCore/qrect.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class QGraphicsItem;
+
+/*
+  A dynamic R*-tree (Beckmann, Kriegel, Schneider, Seeger) over the scene
+  bounding rects of items. Items are identified by their index slot
+  (QGraphicsItemPrivate::index), which maps to the leaf holding the item so
+  that removing or updating an item never has to search the tree, and never
+  has to know the item's previous bounding rect.
+*/
+class QGraphicsSceneRTree
+{
+public:
+    enum {
+        MaxEntries = 16,
+        MinEntries = 6,         // 40% of MaxEntries
+        ReinsertEntries = 5     // 30% of MaxEntries
+    };
+
+    struct Node;
+    struct Entry
+    {
+        QRectF rect;
+        union {
+            Node *child;
+            QGraphicsItem *item;
+        };
+    };
+
+    struct Node
+    {
+        Node *parent;
+        int level;              // 0 for leaves
+        int count;
+        Entry entries[MaxEntries + 1];
+    };
+
+    QGraphicsSceneRTree();
+    ~QGraphicsSceneRTree();
+
+    void clear();
+    bool isEmpty() const { return root->count == 0; }
+    int itemCount() const { return size; }
+    int height() const { return root->level + 1; }
+
+    void insertItem(QGraphicsItem *item, const QRectF &rect);
+    void removeItem(QGraphicsItem *item);
+    void updateItem(QGraphicsItem *item, const QRectF &rect);
+    void bulkLoad(const QVector<Entry> &items);
+
+    QList<QGraphicsItem *> items(const QRectF &rect, bool onlyTopLevelItems = false) const;
+
+private:
+    Node *createNode(int level);
+    void deleteNode(Node *node);
+    void appendEntry(Node *node, const Entry &entry);
+    int entryIndex(const Node *node) const;
+    QRectF nodeRect(const Node *node) const;
+    void updateNodeRect(Node *node);
+
+    Node *chooseSubtree(const QRectF &rect, int level) const;
+    void insertEntry(const Entry &entry, int level);
+    void treatOverflow(Node *node);
+    void reinsert(Node *node);
+    void split(Node *node);
+    void condenseTree(Node *leaf);
+    QVector<Entry> packLevel(QVector<Entry> &entries, int level);
+
+    Node *root;
+    QVector<Node *> leaves;     // by item index slot
+    int size;
+    uint reinsertedLevels;
+};
+Q_DECLARE_TYPEINFO(QGraphicsSceneRTree::Entry, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_GRAPHICSVIEW
+
+#endif // QGRAPHICSSCENERTREE_P_H
@@ -0,0 +1,483 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*!
+    \class QGraphicsSceneRTreeIndex
+    \brief The QGraphicsSceneRTreeIndex class provides an implementation of
+    an R*-tree indexing algorithm for discovering items in QGraphicsScene.
+    \since 5.6
+    \ingroup graphicsview-api
+
+    \internal
+
+    QGraphicsSceneRTreeIndex keeps the scene bounding rects of the items in a
+    dynamic R*-tree. Unlike the BSP tree, the R*-tree adapts to the actual
+    distribution of items rather than to the scene rect, needs no tuning and
+    never has to be regenerated: items are inserted, moved and removed
+    incrementally, in logarithmic time. When many items are indexed at once,
+    for example when the scene is first populated, the tree is bulk loaded.
+
+    Moving an item only marks it as changed; the tree is updated the next time
+    it is queried, or when control returns to the event loop. Small moves that
+    keep the item inside its leaf are applied in place.
+
+    \sa QGraphicsScene, QGraphicsView, QGraphicsSceneIndex, QGraphicsSceneBspTreeIndex
+*/
+
+#include <QtCore/qglobal.h>
+
+#ifndef QT_NO_GRAPHICSVIEW
+
+#include <private/qgraphicsscene_p.h>
+#include <private/qgraphicsscenertreeindex_p.h>
+#include <private/qgraphicssceneindex_p.h>
+
+#include <QtCore/qdebug.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    Constructs a private scene R*-tree index.
+*/
+QGraphicsSceneRTreeIndexPrivate::QGraphicsSceneRTreeIndexPrivate(QGraphicsScene *scene)
+    : QGraphicsSceneIndexPrivate(scene),
+    indexTimerId(0),
+    restartIndexTimer(false)
+{
+}
+
+/*!
+    \internal
+
+    Brings the tree up to date: refreshes the rects of the items whose
+    geometry changed and inserts the items that were added since the last
+    update, bulk loading them if the tree is empty.
+*/
+void QGraphicsSceneRTreeIndexPrivate::updateIndex()
+{
+    Q_Q(QGraphicsSceneRTreeIndex);
+    if (!indexTimerId)
+        return;
+
+    q->killTimer(indexTimerId);
+    indexTimerId = 0;
+
+    for (int i = 0; i < changedItemIndexes.size(); ++i) {
+        const int index = changedItemIndexes.at(i);
+        uchar &state = itemStates[index];
+        if (!(state & GeometryChanged))
+            continue;
+        state &= ~GeometryChanged;
+        if ((state & StateMask) == InTree) {
+            QGraphicsItem *item = indexedItems.at(index);
+            tree.updateItem(item, item->d_ptr->sceneEffectiveBoundingRect());
+        }
+    }
+    changedItemIndexes.clear();
+
+    QVector<QGraphicsSceneRTree::Entry> newEntries;
+    for (int i = 0; i < unindexedItems.size(); ++i) {
+        QGraphicsItem *item = unindexedItems.at(i);
+        Q_ASSERT(!item->d_ptr->itemDiscovered);
+        int index;
+        if (!freeItemIndexes.isEmpty()) {
+            index = freeItemIndexes.takeLast();
+            indexedItems[index] = item;
+        } else {
+            index = indexedItems.size();
+            indexedItems << item;
+            itemStates << uchar(NotIndexed);
+        }
+        item->d_ptr->index = index;
+
+        if (item->d_ptr->itemIsUntransformable()) {
+            itemStates[index] = Untransformable;
+            untransformableItems << item;
+        } else if (item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                   || item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren) {
+            itemStates[index] = ClippedByAncestor;
+        } else {
+            itemStates[index] = InTree;
+            QGraphicsSceneRTree::Entry entry;
+            entry.rect = item->d_ptr->sceneEffectiveBoundingRect();
+            entry.item = item;
+            newEntries << entry;
+        }
+    }
+    unindexedItems.clear();
+
+    if (tree.isEmpty() && newEntries.size() > QGraphicsSceneRTree::MaxEntries) {
+        tree.bulkLoad(newEntries);
+    } else {
+        for (int i = 0; i < newEntries.size(); ++i)
+            tree.insertItem(newEntries.at(i).item, newEntries.at(i).rect);
+    }
+}
+
+/*!
+    \internal
+
+    Starts or restarts the timer used for updating the index.
+*/
+void QGraphicsSceneRTreeIndexPrivate::startIndexTimer()
+{
+    Q_Q(QGraphicsSceneRTreeIndex);
+    if (indexTimerId)
+        restartIndexTimer = true;
+    else
+        indexTimerId = q->startTimer(0);
+}
+
+void QGraphicsSceneRTreeIndexPrivate::addItem(QGraphicsItem *item, bool recursive)
+{
+    if (!item)
+        return;
+
+    // Indexing requires sceneBoundingRect(), but because \a item might
+    // not be completely constructed at this point, we need to store it in
+    // a temporary list and schedule an indexing for later.
+    if (item->d_ptr->index == -1) {
+        Q_ASSERT(!unindexedItems.contains(item));
+        unindexedItems << item;
+        startIndexTimer();
+    } else {
+        Q_ASSERT(indexedItems.contains(item));
+        qWarning("QGraphicsSceneRTreeIndex::addItem: item has already been added to this index");
+    }
+
+    if (recursive) {
+        for (int i = 0; i < item->d_ptr->children.size(); ++i)
+            addItem(item->d_ptr->children.at(i), recursive);
+    }
+}
+
+void QGraphicsSceneRTreeIndexPrivate::removeItem(QGraphicsItem *item, bool recursive,
+                                                 bool moveToUnindexedItems)
+{
+    if (!item)
+        return;
+
+    const int index = item->d_ptr->index;
+    if (index != -1) {
+        Q_ASSERT(index < indexedItems.size());
+        Q_ASSERT(indexedItems.at(index) == item);
+        Q_ASSERT(!item->d_ptr->itemDiscovered);
+        // The tree finds the item through its index slot, so this is safe
+        // (and free of virtual calls) even from the item's destructor.
+        switch (itemStates.at(index) & StateMask) {
+        case InTree:
+            tree.removeItem(item);
+            break;
+        case Untransformable:
+            untransformableItems.removeOne(item);
+            break;
+        default:
+            break;
+        }
+        indexedItems[index] = 0;
+        itemStates[index] = NotIndexed;
+        freeItemIndexes << index;
+        item->d_ptr->index = -1;
+    } else {
+        unindexedItems.removeOne(item);
+    }
+
+    if (moveToUnindexedItems)
+        addItem(item);
+
+    if (recursive) {
+        for (int i = 0; i < item->d_ptr->children.size(); ++i)
+            removeItem(item->d_ptr->children.at(i), recursive, moveToUnindexedItems);
+    }
+}
+
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndexPrivate::estimateItems(const QRectF &rect, Qt::SortOrder order,
+                                                                      bool onlyTopLevelItems)
+{
+    Q_Q(QGraphicsSceneRTreeIndex);
+    if (onlyTopLevelItems && rect.isNull())
+        return q->QGraphicsSceneIndex::estimateTopLevelItems(rect, order);
+
+    updateIndex();
+    Q_ASSERT(unindexedItems.isEmpty());
+
+    QList<QGraphicsItem *> rectItems = tree.items(rect, onlyTopLevelItems);
+    if (onlyTopLevelItems) {
+        for (int i = 0; i < untransformableItems.size(); ++i) {
+            QGraphicsItem *item = untransformableItems.at(i);
+            if (!item->d_ptr->parent) {
+                rectItems << item;
+            } else {
+                item = item->topLevelItem();
+                if (!rectItems.contains(item))
+                    rectItems << item;
+            }
+        }
+    } else {
+        rectItems += untransformableItems;
+    }
+
+    sortItems(&rectItems, order, onlyTopLevelItems);
+    return rectItems;
+}
+
+/*!
+    Sort a list of \a itemList in a specific \a order.
+
+    \internal
+*/
+void QGraphicsSceneRTreeIndexPrivate::sortItems(QList<QGraphicsItem *> *itemList, Qt::SortOrder order,
+                                                bool onlyTopLevelItems)
+{
+    if (order == Qt::SortOrder(-1))
+        return;
+
+    if (onlyTopLevelItems) {
+        if (order == Qt::DescendingOrder)
+            std::sort(itemList->begin(), itemList->end(), qt_closestLeaf);
+        else if (order == Qt::AscendingOrder)
+            std::sort(itemList->begin(), itemList->end(), qt_notclosestLeaf);
+        return;
+    }
+
+    if (order == Qt::DescendingOrder)
+        std::sort(itemList->begin(), itemList->end(), qt_closestItemFirst);
+    else if (order == Qt::AscendingOrder)
+        std::sort(itemList->begin(), itemList->end(), qt_closestItemLast);
+}
+
+/*!
+    Constructs an R*-tree scene index for the given \a scene.
+*/
+QGraphicsSceneRTreeIndex::QGraphicsSceneRTreeIndex(QGraphicsScene *scene)
+    : QGraphicsSceneIndex(*new QGraphicsSceneRTreeIndexPrivate(scene), scene)
+{
+}
+
+QGraphicsSceneRTreeIndex::~QGraphicsSceneRTreeIndex()
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    for (int i = 0; i < d->indexedItems.size(); ++i) {
+        // Ensure item bits are reset properly.
+        if (QGraphicsItem *item = d->indexedItems.at(i)) {
+            Q_ASSERT(!item->d_ptr->itemDiscovered);
+            item->d_ptr->index = -1;
+        }
+    }
+}
+
+/*!
+    \internal
+    Clear the whole R*-tree index.
+*/
+void QGraphicsSceneRTreeIndex::clear()
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->tree.clear();
+    for (int i = 0; i < d->indexedItems.size(); ++i) {
+        // Ensure item bits are reset properly.
+        if (QGraphicsItem *item = d->indexedItems.at(i)) {
+            Q_ASSERT(!item->d_ptr->itemDiscovered);
+            item->d_ptr->index = -1;
+        }
+    }
+    d->indexedItems.clear();
+    d->itemStates.clear();
+    d->freeItemIndexes.clear();
+    d->changedItemIndexes.clear();
+    d->unindexedItems.clear();
+    d->untransformableItems.clear();
+}
+
+/*!
+    Add the \a item into the R*-tree index.
+*/
+void QGraphicsSceneRTreeIndex::addItem(QGraphicsItem *item)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->addItem(item);
+}
+
+/*!
+    Remove the \a item from the R*-tree index.
+*/
+void QGraphicsSceneRTreeIndex::removeItem(QGraphicsItem *item)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->removeItem(item);
+}
+
+/*!
+    \internal
+    Marks the \a item and its children as changed; their entries in the tree
+    are updated once the new bounding rects are known.
+*/
+void QGraphicsSceneRTreeIndex::prepareBoundingRectChange(const QGraphicsItem *item)
+{
+    if (!item || item->d_ptr->index == -1)
+        return;
+
+    Q_D(QGraphicsSceneRTreeIndex);
+    uchar &state = d->itemStates[item->d_ptr->index];
+    if ((state & QGraphicsSceneRTreeIndexPrivate::StateMask) != QGraphicsSceneRTreeIndexPrivate::InTree)
+        return; // Item is not in the tree; nothing to do.
+
+    if (!(state & QGraphicsSceneRTreeIndexPrivate::GeometryChanged)) {
+        state |= QGraphicsSceneRTreeIndexPrivate::GeometryChanged;
+        d->changedItemIndexes << item->d_ptr->index;
+        d->startIndexTimer();
+    }
+    for (int i = 0; i < item->d_ptr->children.size(); ++i)
+        prepareBoundingRectChange(item->d_ptr->children.at(i));
+}
+
+/*!
+    Returns an estimation visible items that are either inside or
+    intersect with the specified \a rect and return a list sorted using \a order.
+*/
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::estimateItems(const QRectF &rect, Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    return const_cast<QGraphicsSceneRTreeIndexPrivate*>(d)->estimateItems(rect, order);
+}
+
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::estimateTopLevelItems(const QRectF &rect, Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    return const_cast<QGraphicsSceneRTreeIndexPrivate*>(d)->estimateItems(rect, order, /*onlyTopLevels=*/true);
+}
+
+/*!
+    \fn QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::items(Qt::SortOrder order = Qt::DescendingOrder) const;
+
+    Return all items in the R*-tree index and sort them using \a order.
+*/
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::items(Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    QList<QGraphicsItem *> itemList;
+    itemList.reserve(d->indexedItems.size() - d->freeItemIndexes.size() + d->unindexedItems.size());
+    for (int i = 0; i < d->indexedItems.size(); ++i) {
+        if (QGraphicsItem *item = d->indexedItems.at(i))
+            itemList << item;
+    }
+    itemList += d->unindexedItems;
+    d->sortItems(&itemList, order);
+    return itemList;
+}
+
+/*!
+    \internal
+
+    This method react to the \a change of the \a item and use the \a value to
+    update the R*-tree if necessary.
+*/
+void QGraphicsSceneRTreeIndex::itemChange(const QGraphicsItem *item, QGraphicsItem::GraphicsItemChange change, const void *const value)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    switch (change) {
+    case QGraphicsItem::ItemFlagsChange: {
+        // Handle ItemIgnoresTransformations
+        QGraphicsItem::GraphicsItemFlags newFlags = *static_cast<const QGraphicsItem::GraphicsItemFlags *>(value);
+        bool ignoredTransform = item->d_ptr->flags & QGraphicsItem::ItemIgnoresTransformations;
+        bool willIgnoreTransform = newFlags & QGraphicsItem::ItemIgnoresTransformations;
+        bool clipsChildren = item->d_ptr->flags & QGraphicsItem::ItemClipsChildrenToShape
+                             || item->d_ptr->flags & QGraphicsItem::ItemContainsChildrenInShape;
+        bool willClipChildren = newFlags & QGraphicsItem::ItemClipsChildrenToShape
+                                || newFlags & QGraphicsItem::ItemContainsChildrenInShape;
+        if ((ignoredTransform != willIgnoreTransform) || (clipsChildren != willClipChildren)) {
+            QGraphicsItem *thatItem = const_cast<QGraphicsItem *>(item);
+            // Remove item and its descendants from the index and append
+            // them to the list of unindexed items. Then, when the index
+            // is updated, they will be put into the tree or the list
+            // of untransformable items.
+            d->removeItem(thatItem, /*recursive=*/true, /*moveToUnidexedItems=*/true);
+        }
+        break;
+    }
+    case QGraphicsItem::ItemParentChange: {
+        // Handle ItemIgnoresTransformations
+        const QGraphicsItem *newParent = static_cast<const QGraphicsItem *>(value);
+        bool ignoredTransform = item->d_ptr->itemIsUntransformable();
+        bool willIgnoreTransform = (item->d_ptr->flags & QGraphicsItem::ItemIgnoresTransformations)
+                                   || (newParent && newParent->d_ptr->itemIsUntransformable());
+        bool ancestorClippedChildren = item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                                       || item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren;
+        bool ancestorWillClipChildren = newParent
+                            && ((newParent->d_ptr->flags & QGraphicsItem::ItemClipsChildrenToShape
+                                 || newParent->d_ptr->flags & QGraphicsItem::ItemContainsChildrenInShape)
+                                || (newParent->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                                    || newParent->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren));
+        if ((ignoredTransform != willIgnoreTransform) || (ancestorClippedChildren != ancestorWillClipChildren)) {
+            QGraphicsItem *thatItem = const_cast<QGraphicsItem *>(item);
+            // Remove item and its descendants from the index and append
+            // them to the list of unindexed items. Then, when the index
+            // is updated, they will be put into the tree or the list
+            // of untransformable items.
+            d->removeItem(thatItem, /*recursive=*/true, /*moveToUnidexedItems=*/true);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*!
+    \reimp
+
+    Used to catch the timer event.
+
+    \internal
+*/
+bool QGraphicsSceneRTreeIndex::event(QEvent *event)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    if (event->type() == QEvent::Timer) {
+        if (d->indexTimerId && static_cast<QTimerEvent *>(event)->timerId() == d->indexTimerId) {
+            if (d->restartIndexTimer) {
+                d->restartIndexTimer = false;
+            } else {
+                // this call will kill the timer
+                d->updateIndex();
+            }
+        }
+    }
+    return QObject::event(event);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qgraphicsscenertreeindex_p.cpp"
+
+#endif  // QT_NO_GRAPHICSVIEW
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGRAPHICSSCENERTREEINDEX_H
+#define QGRAPHICSSCENERTREEINDEX_H
+
+#include <QtCore/qglobal.h>
+
+#if !defined(QT_NO_GRAPHICSVIEW)
+
+#include "qgraphicssceneindex_p.h"
+#include "qgraphicsitem_p.h"
+#include "qgraphicsscene_rtree_p.h"
+
+#include <QtCore/qrect.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class QGraphicsScene;
+class QGraphicsSceneRTreeIndexPrivate;
+
+class Q_AUTOTEST_EXPORT QGraphicsSceneRTreeIndex : public QGraphicsSceneIndex
+{
+    Q_OBJECT
+public:
+    QGraphicsSceneRTreeIndex(QGraphicsScene *scene = 0);
+    ~QGraphicsSceneRTreeIndex();
+
+    QList<QGraphicsItem *> estimateItems(const QRectF &rect, Qt::SortOrder order) const Q_DECL_OVERRIDE;
+    QList<QGraphicsItem *> estimateTopLevelItems(const QRectF &rect, Qt::SortOrder order) const Q_DECL_OVERRIDE;
+    QList<QGraphicsItem *> items(Qt::SortOrder order = Qt::DescendingOrder) const Q_DECL_OVERRIDE;
+
+protected:
+    bool event(QEvent *event) Q_DECL_OVERRIDE;
+    void clear() Q_DECL_OVERRIDE;
+
+    void addItem(QGraphicsItem *item) Q_DECL_OVERRIDE;
+    void removeItem(QGraphicsItem *item) Q_DECL_OVERRIDE;
+    void prepareBoundingRectChange(const QGraphicsItem *item) Q_DECL_OVERRIDE;
+
+    void itemChange(const QGraphicsItem *item, QGraphicsItem::GraphicsItemChange change, const void *const value) Q_DECL_OVERRIDE;
+
+private:
+    Q_DECLARE_PRIVATE(QGraphicsSceneRTreeIndex)
+    Q_DISABLE_COPY(QGraphicsSceneRTreeIndex)
+
+    friend class QGraphicsScene;
+    friend class QGraphicsScenePrivate;
+};
+
+class QGraphicsSceneRTreeIndexPrivate : public QGraphicsSceneIndexPrivate
+{
+    Q_DECLARE_PUBLIC(QGraphicsSceneRTreeIndex)
+public:
+    QGraphicsSceneRTreeIndexPrivate(QGraphicsScene *scene);
+
+    enum ItemState {
+        NotIndexed,
+        InTree,
+        Untransformable,
+        ClippedByAncestor,
+        StateMask = 0x3,
+        GeometryChanged = 0x4
+    };
+
+    QGraphicsSceneRTree tree;
+    int indexTimerId;
+    bool restartIndexTimer;
+
+    QVector<QGraphicsItem *> indexedItems;
+    QVector<uchar> itemStates;
+    QVector<int> freeItemIndexes;
+    QVector<int> changedItemIndexes;
+    QList<QGraphicsItem *> unindexedItems;
+    QList<QGraphicsItem *> untransformableItems;
+
+    void updateIndex();
+    void startIndexTimer();
+
+    void addItem(QGraphicsItem *item, bool recursive = false);
+    void removeItem(QGraphicsItem *item, bool recursive = false, bool moveToUnindexedItems = false);
+    QList<QGraphicsItem *> estimateItems(const QRectF &, Qt::SortOrder, bool onlyTopLevelItems = false);
+
+    static void sortItems(QList<QGraphicsItem *> *itemList, Qt::SortOrder order, bool onlyTopLevelItems = false);
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_GRAPHICSVIEW
+
+#endif // QGRAPHICSSCENERTREEINDEX_H
@@ -211,6 +211,29 @@ static const int QGRAPHICSVIEW_PREALLOC_STYLE_OPTIONS = 503; // largest prime <
     \value IndirectPainting Since Qt 4.6, restore the old painting algorithm
     that calls QGraphicsView::drawItems() and QGraphicsScene::drawItems().
     To be used only for compatibility with old code.
+
+    \value SimplifyTinyItems Since Qt 5.6, standard shape items (rect,
+    ellipse, polygon, path and line items with the
+    QGraphicsItem::ItemPaintsStandardShape flag) without children that cover less
+    than two pixels in both directions are drawn as a single box in their
+    brush color (or pen color, if they have no brush) instead of being
+    painted. Other items are painted as usual; use
+    QGraphicsScene::minimumRenderSize to skip them altogether.
+
+    \value BatchSimpleItems Since Qt 5.6, consecutive top-level rect, full
+    ellipse and line items with the QGraphicsItem::ItemPaintsStandardShape
+    flag that share the same opaque pen and brush, have no
+    children, are only translated and do not overlap each other are drawn
+    together as one path. The result is the same as painting the items one
+    by one. Items that are selected, cached, clipped or have an effect are
+    always painted individually.
+
+    \value ElidePainterState Since Qt 5.6, QGraphicsView no longer saves and
+    restores the full painter state around standard shape items with the
+    QGraphicsItem::ItemPaintsStandardShape flag, whose paint()
+    implementations only change the pen and brush; only those are
+    restored. This gives most of the benefit of DontSavePainterState while
+    keeping custom items protected.
 */
 
 /*!
@@ -226,6 +249,17 @@ static const int QGRAPHICSVIEW_PREALLOC_STYLE_OPTIONS = 503; // largest prime <
     this flag is enabled, QGraphicsView will allocate one pixmap with the full
     size of the viewport.
 
+    \value CacheBackgroundTiles The background is cached in tiles of 256 by
+    256 pixels, one set of tiles for each power-of-two zoom level. Tiles that
+    are missing, or that have been invalidated, are rendered a few at a time
+    between events and drawn as soon as they are ready; until then,
+    QGraphicsView shows the invalidated tile or an enlarged part of a tile
+    from a lower zoom level. Panning and zooming therefore does not wait for
+    drawBackground() to render the whole viewport. Call resetCachedContent()
+    or invalidateScene() after changing state that drawBackground() depends
+    on. Tiles are only used while the view is scaled and translated, but not
+    rotated, sheared or mirrored. This value was introduced in Qt 5.6.
+
     \sa cacheMode
 */
 
@@ -264,6 +298,7 @@ static const int QGRAPHICSVIEW_PREALLOC_STYLE_OPTIONS = 503; // largest prime <
 
 #include "qgraphicsview.h"
 #include "qgraphicsview_p.h"
+#include "qgraphicsviewtilecache_p.h"
 
 #ifndef QT_NO_GRAPHICSVIEW
 
@@ -353,6 +388,7 @@ QGraphicsViewPrivate::QGraphicsViewPrivate()
       rubberBandSelectionOperation(Qt::ReplaceSelection),
 #endif
       handScrollMotions(0), cacheMode(0),
+      tileCache(0),
 #ifndef QT_NO_CURSOR
       hasStoredOriginalCursor(false),
 #endif
@@ -364,6 +400,19 @@ QGraphicsViewPrivate::QGraphicsViewPrivate()
 
 QGraphicsViewPrivate::~QGraphicsViewPrivate()
 {
+    delete tileCache;
+}
+
+/*!
+    \internal
+
+    Draws the background of the scene area \a rect on behalf of the tile
+    cache.
+*/
+void QGraphicsViewPrivate::drawBackgroundTile(QPainter *painter, const QRectF &rect)
+{
+    Q_Q(QGraphicsView);
+    q->drawBackground(painter, rect);
 }
 
 /*!
@@ -1231,6 +1280,9 @@ QGraphicsView::QGraphicsView(QGraphicsViewPrivate &dd, QWidget *parent)
 QGraphicsView::~QGraphicsView()
 {
     Q_D(QGraphicsView);
+    // Stop rendering background tiles while the view is still complete.
+    delete d->tileCache;
+    d->tileCache = 0;
     if (d->scene)
         d->scene->d_func()->views.removeAll(this);
     delete d->lastDragDropEvent;
@@ -1570,7 +1622,8 @@ QRect QGraphicsView::rubberBandRect() const
     \snippet code/src_gui_graphicsview_qgraphicsview.cpp 2
 
     The cache is invalidated every time the view is transformed. However, when
-    scrolling, only partial invalidation is required.
+    scrolling, only partial invalidation is required. With
+    CacheBackgroundTiles, the cache survives both scrolling and zooming.
 
     By default, nothing is cached.
 
@@ -1606,6 +1659,16 @@ void QGraphicsView::setCacheMode(CacheMode mode)
 void QGraphicsView::resetCachedContent()
 {
     Q_D(QGraphicsView);
+    if (d->cacheMode & CacheBackgroundTiles) {
+        if (!d->tileCache)
+            d->tileCache = new QGraphicsViewTileCache(this, d);
+        d->tileCache->invalidate();
+        d->updateAll();
+    } else if (d->tileCache) {
+        delete d->tileCache;
+        d->tileCache = 0;
+    }
+
     if (d->cacheMode == CacheNone)
         return;
 
@@ -1641,6 +1704,15 @@ void QGraphicsView::resetCachedContent()
 void QGraphicsView::invalidateScene(const QRectF &rect, QGraphicsScene::SceneLayers layers)
 {
     Q_D(QGraphicsView);
+    if ((layers & QGraphicsScene::BackgroundLayer) && d->tileCache) {
+        // A null rect stands for the whole scene, as in QGraphicsScene::invalidate().
+        if (rect.isNull())
+            d->tileCache->invalidate();
+        else
+            d->tileCache->invalidate(rect);
+        if (d->scene)
+            d->scene->update(rect);
+    }
     if ((layers & QGraphicsScene::BackgroundLayer) && !d->mustResizeBackgroundPixmap) {
         QRect viewRect = mapFromScene(rect).boundingRect();
         if (viewport()->rect().intersects(viewRect)) {
@@ -1705,6 +1777,10 @@ void QGraphicsView::setScene(QGraphicsScene *scene)
     // Always update the viewport when the scene changes.
     d->updateAll();
 
+    // Background tiles show the old scene.
+    if (d->tileCache)
+        d->tileCache->invalidate();
+
     // Remove the previously assigned scene.
     if (d->scene) {
         disconnect(d->scene, SIGNAL(changed(QList<QRectF>)),
@@ -2622,6 +2698,8 @@ QBrush QGraphicsView::backgroundBrush() const
 void QGraphicsView::setBackgroundBrush(const QBrush &brush)
 {
     Q_D(QGraphicsView);
+    if (d->tileCache)
+        d->tileCache->invalidate();
     d->backgroundBrush = brush;
     d->updateAll();
 
@@ -3469,6 +3547,9 @@ void QGraphicsView::paintEvent(QPaintEvent *event)
 
     // Set up painter state protection.
     d->scene->d_func()->painterStateProtection = !(d->optimizationFlags & DontSavePainterState);
+    d->scene->d_func()->elidePainterState = bool(d->optimizationFlags & ElidePainterState);
+    d->scene->d_func()->simplifyTinyItems = bool(d->optimizationFlags & SimplifyTinyItems);
+    d->scene->d_func()->batchSimpleItems = bool(d->optimizationFlags & BatchSimpleItems);
 
     // Determine the exposed region
     d->exposedRegion = event->region();
@@ -3491,7 +3572,12 @@ void QGraphicsView::paintEvent(QPaintEvent *event)
     const QTransform viewTransform = painter.worldTransform();
 
     // Draw background
-    if ((d->cacheMode & CacheBackground)
+    const bool backgroundFromTiles = d->tileCache
+        && d->tileCache->drawBackground(&painter, viewTransform, d->exposedRegion.boundingRect(),
+                                        viewport()->palette().brush(viewport()->backgroundRole()));
+    if (backgroundFromTiles) {
+        // The tile cache has drawn the background
+    } else if ((d->cacheMode & CacheBackground)
 #ifdef Q_DEAD_CODE_FROM_QT4_X11
         && X11->use_xrender
 #endif
@@ -3623,6 +3709,9 @@ void QGraphicsView::paintEvent(QPaintEvent *event)
 
     // Restore painter state protection.
     d->scene->d_func()->painterStateProtection = true;
+    d->scene->d_func()->elidePainterState = false;
+    d->scene->d_func()->simplifyTinyItems = false;
+    d->scene->d_func()->batchSimpleItems = false;
 }
 
 /*!
@@ -80,7 +80,8 @@ public:
 
     enum CacheModeFlag {
         CacheNone = 0x0,
-        CacheBackground = 0x1
+        CacheBackground = 0x1,
+        CacheBackgroundTiles = 0x2
     };
     Q_DECLARE_FLAGS(CacheMode, CacheModeFlag)
 
@@ -104,7 +105,10 @@ public:
         DontClipPainter = 0x1, // obsolete
         DontSavePainterState = 0x2,
         DontAdjustForAntialiasing = 0x4,
-        IndirectPainting = 0x8
+        IndirectPainting = 0x8,
+        SimplifyTinyItems = 0x10,
+        BatchSimpleItems = 0x20,
+        ElidePainterState = 0x40
     };
     Q_DECLARE_FLAGS(OptimizationFlags, OptimizationFlag)
 
@@ -58,6 +58,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QGraphicsViewTileCache;
+
 class Q_WIDGETS_EXPORT QGraphicsViewPrivate : public QAbstractScrollAreaPrivate
 {
     Q_DECLARE_PUBLIC(QGraphicsView)
@@ -149,6 +151,8 @@ public:
     QBrush foregroundBrush;
     QPixmap backgroundPixmap;
     QRegion backgroundPixmapExposed;
+    QGraphicsViewTileCache *tileCache;
+    void drawBackgroundTile(QPainter *painter, const QRectF &rect);
 
 #ifndef QT_NO_CURSOR
     QCursor originalCursor;
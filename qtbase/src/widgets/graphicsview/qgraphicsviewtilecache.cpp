@@ -0,0 +1,292 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qgraphicsviewtilecache_p.h"
+
+#ifndef QT_NO_GRAPHICSVIEW
+
+#include "qgraphicsview.h"
+#include "qgraphicsview_p.h"
+
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmath.h>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+/*
+  Rounds x / 2^shift towards negative infinity, also for negative x.
+*/
+static inline int qt_floorShift(int x, int shift)
+{
+    return x >= 0 ? x >> shift : ~(~x >> shift);
+}
+
+QGraphicsViewTileCache::QGraphicsViewTileCache(QGraphicsView *view, QGraphicsViewPrivate *viewPrivate)
+    : view(view), viewPrivate(viewPrivate), generation(0), currentLevel(MinLevel - 1)
+{
+    // 64 MB, or 256 tiles
+    tiles.setMaxCost(64 * 1024);
+}
+
+QGraphicsViewTileCache::~QGraphicsViewTileCache()
+{
+    cancel();
+}
+
+/*
+  Returns the zoom level of tiles that are drawn at \a scale, that is, the
+  smallest level such that 2^level >= scale.
+*/
+int QGraphicsViewTileCache::levelForScale(qreal scale)
+{
+    int exponent;
+    const qreal mantissa = std::frexp(scale, &exponent);
+    const int level = mantissa == qreal(0.5) ? exponent - 1 : exponent;
+    return qBound(int(MinLevel), level, int(MaxLevel));
+}
+
+/*
+  Returns the area of the scene that is covered by the tile \a key.
+*/
+QRectF QGraphicsViewTileCache::tileSceneRect(const Key &key)
+{
+    const qreal size = std::ldexp(qreal(TileSize), -key.level);
+    return QRectF(key.x * size, key.y * size, size, size);
+}
+
+/*
+  Draws the tiles that intersect \a exposedRect (in device coordinates),
+  and schedules rendering of the tiles that are missing or stale. Parts
+  that have no tile at all are filled with \a baseBrush.
+
+  Returns false, and draws nothing, if \a viewTransform scales, rotates or
+  mirrors the scene in a way that cannot be served from square tiles.
+*/
+bool QGraphicsViewTileCache::drawBackground(QPainter *painter, const QTransform &viewTransform,
+                                            const QRect &exposedRect, const QBrush &baseBrush)
+{
+    if (viewTransform.type() > QTransform::TxScale
+        || viewTransform.m11() <= 0 || viewTransform.m22() <= 0) {
+        return false;
+    }
+
+    const int level = levelForScale(qMax(viewTransform.m11(), viewTransform.m22()));
+    if (level != currentLevel) {
+        // The view was zoomed; tiles queued for the previous level are no
+        // longer of interest.
+        cancel();
+        currentLevel = level;
+    }
+    this->baseBrush = baseBrush;
+
+    const qreal tileSize = std::ldexp(qreal(TileSize), -level);
+    const QRectF exposedSceneRect = viewTransform.inverted().mapRect(QRectF(exposedRect));
+    const int left = qFloor(exposedSceneRect.left() / tileSize);
+    const int top = qFloor(exposedSceneRect.top() / tileSize);
+    const int right = qFloor(exposedSceneRect.right() / tileSize);
+    const int bottom = qFloor(exposedSceneRect.bottom() / tileSize);
+
+    const QTransform oldWorldTransform = painter->worldTransform();
+    painter->setWorldTransform(QTransform());
+
+    QVector<Key> missing;
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            const Key key = { level, x, y };
+
+            // Round the edges rather than the rect, so that neighbouring
+            // tiles always meet without gaps.
+            const QRectF deviceRect = viewTransform.mapRect(tileSceneRect(key));
+            const QRect target(QPoint(qRound(deviceRect.left()), qRound(deviceRect.top())),
+                               QPoint(qRound(deviceRect.right()) - 1, qRound(deviceRect.bottom()) - 1));
+
+            if (Tile *tile = tiles.object(key)) {
+                painter->drawPixmap(target, tile->pixmap);
+                if (tile->generation == generation)
+                    continue;
+            } else if (!drawFallback(painter, key, target)) {
+                painter->fillRect(target, baseBrush);
+            }
+            if (!pending.contains(key))
+                missing << key;
+        }
+    }
+
+    painter->setWorldTransform(oldWorldTransform);
+
+    if (!missing.isEmpty()) {
+        // Render the tiles in the middle of the exposed area first, ahead
+        // of the ones queued for earlier paint events.
+        const qreal centerX = exposedSceneRect.center().x() / tileSize - qreal(0.5);
+        const qreal centerY = exposedSceneRect.center().y() / tileSize - qreal(0.5);
+        QVector<QPair<qreal, int> > order;
+        order.reserve(missing.size());
+        for (int i = 0; i < missing.size(); ++i) {
+            const qreal dx = missing.at(i).x - centerX;
+            const qreal dy = missing.at(i).y - centerY;
+            order << qMakePair(dx * dx + dy * dy, i);
+        }
+        std::sort(order.begin(), order.end());
+        QVector<Key> requested;
+        requested.reserve(order.size() + queue.size());
+        for (int i = 0; i < order.size(); ++i)
+            requested << missing.at(order.at(i).second);
+        requested += queue;
+        queue.swap(requested);
+        for (int i = 0; i < missing.size(); ++i)
+            requestTile(missing.at(i));
+    }
+    return true;
+}
+
+/*
+  Draws the part of a coarser tile that covers \a key into \a target.
+  Returns false if none of the coarser levels has a tile for it.
+*/
+bool QGraphicsViewTileCache::drawFallback(QPainter *painter, const Key &key, const QRect &target)
+{
+    for (int shift = 1; shift <= MaxFallbackLevels && key.level - shift >= MinLevel; ++shift) {
+        const Key parentKey = { key.level - shift, qt_floorShift(key.x, shift), qt_floorShift(key.y, shift) };
+        Tile *tile = tiles.object(parentKey);
+        if (!tile)
+            continue;
+        const int size = TileSize >> shift;
+        const QRect source((key.x - (parentKey.x << shift)) * size,
+                           (key.y - (parentKey.y << shift)) * size, size, size);
+        painter->drawPixmap(target, tile->pixmap, source);
+        return true;
+    }
+    return false;
+}
+
+void QGraphicsViewTileCache::requestTile(const Key &key)
+{
+    pending.insert(key);
+    if (!renderTimer.isActive())
+        renderTimer.start(0, this);
+}
+
+/*
+  Renders the queued tiles until the time budget for one timer event is
+  used up, so that input and paint events are handled in between.
+*/
+void QGraphicsViewTileCache::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != renderTimer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    QElapsedTimer budget;
+    budget.start();
+    int rendered = 0;
+    while (rendered < queue.size() && budget.elapsed() < RenderBudget)
+        renderTile(queue.at(rendered++));
+    queue.remove(0, rendered);
+    if (queue.isEmpty())
+        renderTimer.stop();
+}
+
+void QGraphicsViewTileCache::renderTile(const Key &key)
+{
+    pending.remove(key);
+
+    const QRectF sceneRect = tileSceneRect(key);
+    const qreal scale = std::ldexp(qreal(1), key.level);
+
+    Tile *tile = new Tile;
+    tile->pixmap = QPixmap(TileSize, TileSize);
+    if (!baseBrush.isOpaque())
+        tile->pixmap.fill(Qt::transparent);
+    tile->generation = generation;
+
+    QPainter painter(&tile->pixmap);
+    painter.fillRect(tile->pixmap.rect(), baseBrush);
+    painter.setRenderHints(view->renderHints());
+    painter.scale(scale, scale);
+    painter.translate(-sceneRect.topLeft());
+    painter.setClipRect(sceneRect);
+    viewPrivate->drawBackgroundTile(&painter, sceneRect);
+    painter.end();
+
+    tiles.insert(key, tile, TileSize * TileSize * 4 / 1024);
+    if (key.level == currentLevel)
+        view->viewport()->update(view->viewportTransform().mapRect(sceneRect).toAlignedRect());
+}
+
+/*
+  Marks all tiles as stale. Stale tiles are still drawn until they have been
+  rendered again.
+*/
+void QGraphicsViewTileCache::invalidate()
+{
+    ++generation;
+}
+
+/*
+  Marks the tiles that intersect \a sceneRect as stale.
+*/
+void QGraphicsViewTileCache::invalidate(const QRectF &sceneRect)
+{
+    const int previousGeneration = generation++;
+    const QList<Key> keys = tiles.keys();
+    for (int i = 0; i < keys.size(); ++i) {
+        const Key &key = keys.at(i);
+        if (tileSceneRect(key).intersects(sceneRect))
+            continue;
+        Tile *tile = tiles.object(key);
+        if (tile->generation == previousGeneration)
+            tile->generation = generation;
+    }
+}
+
+/*
+  Drops all queued tiles.
+*/
+void QGraphicsViewTileCache::cancel()
+{
+    renderTimer.stop();
+    queue.clear();
+    pending.clear();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qgraphicsviewtilecache_p.cpp"
+
+#endif // QT_NO_GRAPHICSVIEW
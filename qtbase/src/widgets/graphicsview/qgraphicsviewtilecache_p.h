@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWidgets module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QGRAPHICSVIEWTILECACHE_P_H
+#define QGRAPHICSVIEWTILECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+#if !defined(QT_NO_GRAPHICSVIEW)
+
+#include <QtCore/qobject.h>
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qset.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qvector.h>
+#include <QtGui/qbrush.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpixmap.h>
+#include <QtGui/qtransform.h>
+
+QT_BEGIN_NAMESPACE
+
+class QGraphicsView;
+class QGraphicsViewPrivate;
+
+/*
+  Caches the background of a QGraphicsView as square tiles of TileSize
+  device pixels, one set of tiles per power-of-two zoom level. Missing tiles
+  are queued and rendered from a timer by calling the view's
+  drawBackground(), a few at a time so that event processing goes on, and
+  are replaced by a stale tile or by a part of a coarser tile until then.
+*/
+class QGraphicsViewTileCache : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        TileSize = 256,
+        MinLevel = -16,
+        MaxLevel = 16,
+        MaxFallbackLevels = 4,
+        RenderBudget = 8 // milliseconds per timer event
+    };
+
+    struct Key {
+        int level;
+        int x;
+        int y;
+    };
+
+    QGraphicsViewTileCache(QGraphicsView *view, QGraphicsViewPrivate *viewPrivate);
+    ~QGraphicsViewTileCache();
+
+    bool drawBackground(QPainter *painter, const QTransform &viewTransform, const QRect &exposedRect,
+                        const QBrush &baseBrush);
+
+    void invalidate();
+    void invalidate(const QRectF &sceneRect);
+    void cancel();
+
+    inline int maxCost() const { return tiles.maxCost(); }
+    inline void setMaxCost(int kilobytes) { tiles.setMaxCost(kilobytes); }
+
+    static int levelForScale(qreal scale);
+    static QRectF tileSceneRect(const Key &key);
+
+private:
+protected:
+    void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE;
+
+private:
+    struct Tile {
+        QPixmap pixmap;
+        int generation;
+    };
+
+    void requestTile(const Key &key);
+    void renderTile(const Key &key);
+    bool drawFallback(QPainter *painter, const Key &key, const QRect &target);
+
+    QGraphicsView *view;
+    QGraphicsViewPrivate *viewPrivate;
+    QCache<Key, Tile> tiles;
+    QVector<Key> queue;
+    QSet<Key> pending;
+    QBasicTimer renderTimer;
+    QBrush baseBrush;
+    int generation;
+    int currentLevel;
+};
+Q_DECLARE_TYPEINFO(QGraphicsViewTileCache::Key, Q_PRIMITIVE_TYPE);
+
+inline bool operator==(const QGraphicsViewTileCache::Key &k1, const QGraphicsViewTileCache::Key &k2)
+{ return k1.level == k2.level && k1.x == k2.x && k1.y == k2.y; }
+
+inline uint qHash(const QGraphicsViewTileCache::Key &key, uint seed = 0) Q_DECL_NOTHROW
+{ return qHash((quint64(uint(key.x)) << 32) | uint(key.y), seed) ^ uint(key.level); }
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_GRAPHICSVIEW
+
+#endif // QGRAPHICSVIEWTILECACHE_P_H
@@ -96,6 +96,7 @@ QAbstractItemViewPrivate::QAbstractItemViewPrivate()
         shouldClearStatusTip(false),
         alternatingColors(false),
         textElideMode(Qt::ElideRight),
+        renderCache(0),
         verticalScrollMode(QAbstractItemView::ScrollPerItem),
         horizontalScrollMode(QAbstractItemView::ScrollPerItem),
         currentIndexSet(false),
@@ -1102,6 +1103,7 @@ void QAbstractItemView::reset()
     d->editorIndexHash.clear();
     d->indexEditorHash.clear();
     d->persistent.clear();
+    d->clearRenderCache();
     d->currentIndexSet = false;
     setState(NoState);
     setRootIndex(QModelIndex());
@@ -1129,6 +1131,7 @@ void QAbstractItemView::setRootIndex(const QModelIndex &index)
         return;
     }
     d->root = index;
+    d->clearRenderCache();
     d->doDelayedItemsLayout();
     d->updateGeometry();
 }
@@ -1205,6 +1208,7 @@ void QAbstractItemView::doItemsLayout()
 {
     Q_D(QAbstractItemView);
     d->interruptDelayedItemsLayout();
+    d->clearRenderCache();
     updateGeometries();
     d->viewport->update();
 }
@@ -1571,6 +1575,38 @@ Qt::TextElideMode QAbstractItemView::textElideMode() const
     return d_func()->textElideMode;
 }
 
+/*!
+    \property QAbstractItemView::renderCacheLimit
+    \since 5.6
+
+    \brief the size in kilobytes of the cache of rendered items
+
+    When the limit is larger than 0, QListView and QTableView keep the items
+    painted by the delegate as pixmaps and reuse them as long as the model
+    does not report a change of the item and the item is painted with the
+    same style options, for instance while scrolling. This saves calling the
+    delegate and the model for items that are painted over and over.
+
+    The cached pixmaps are composed over the background of the view, so
+    text is rendered with grayscale antialiasing. Delegates whose rendering
+    depends on state other than the model data and the style option should
+    not be used with the cache; call doItemsLayout() to discard the
+    cached items after changing such state.
+
+    The default value is 0, which disables the cache.
+*/
+void QAbstractItemView::setRenderCacheLimit(int limit)
+{
+    Q_D(QAbstractItemView);
+    d->renderCache.setMaxCost(qMax(limit, 0));
+    d->clearRenderCache();
+}
+
+int QAbstractItemView::renderCacheLimit() const
+{
+    return d_func()->renderCache.maxCost();
+}
+
 /*!
   \reimp
 */
@@ -3243,6 +3279,7 @@ void QAbstractItemView::dataChanged(const QModelIndex &topLeft, const QModelInde
     Q_UNUSED(roles);
     // Single item changed
     Q_D(QAbstractItemView);
+    d->clearRenderCache(topLeft, bottomRight);
     if (topLeft == bottomRight && topLeft.isValid()) {
         const QEditorInfo &editorInfo = d->editorForIndex(topLeft);
         //we don't update the edit data if it is static
@@ -3362,6 +3399,8 @@ void QAbstractItemViewPrivate::_q_rowsRemoved(const QModelIndex &index, int star
     Q_UNUSED(start)
     Q_UNUSED(end)
 
+    clearRenderCache();
+
     Q_Q(QAbstractItemView);
     if (q->isVisible())
         q->updateEditorGeometries();
@@ -3443,6 +3482,8 @@ void QAbstractItemViewPrivate::_q_columnsRemoved(const QModelIndex &index, int s
     Q_UNUSED(start)
     Q_UNUSED(end)
 
+    clearRenderCache();
+
     Q_Q(QAbstractItemView);
     if (q->isVisible())
         q->updateEditorGeometries();
@@ -3470,6 +3511,8 @@ void QAbstractItemViewPrivate::_q_rowsInserted(const QModelIndex &index, int sta
     Q_UNUSED(start)
     Q_UNUSED(end)
 
+    clearRenderCache();
+
 #ifndef QT_NO_ACCESSIBILITY
     Q_Q(QAbstractItemView);
     if (QAccessible::isActive()) {
@@ -3493,6 +3536,8 @@ void QAbstractItemViewPrivate::_q_columnsInserted(const QModelIndex &index, int
     Q_UNUSED(start)
     Q_UNUSED(end)
 
+    clearRenderCache();
+
     Q_Q(QAbstractItemView);
     if (q->isVisible())
         q->updateEditorGeometries();
@@ -3512,6 +3557,7 @@ void QAbstractItemViewPrivate::_q_columnsInserted(const QModelIndex &index, int
 */
 void QAbstractItemViewPrivate::_q_modelDestroyed()
 {
+    clearRenderCache();
     model = QAbstractItemModelPrivate::staticEmptyModel();
     doDelayedReset();
 }
@@ -3523,6 +3569,7 @@ void QAbstractItemViewPrivate::_q_modelDestroyed()
 */
 void QAbstractItemViewPrivate::_q_layoutChanged()
 {
+    clearRenderCache();
     doDelayedItemsLayout();
 #ifndef QT_NO_ACCESSIBILITY
     Q_Q(QAbstractItemView);
@@ -4142,6 +4189,109 @@ void QAbstractItemViewPrivate::updateGeometry()
         q->updateGeometry();
 }
 
+QItemRenderCacheEntry::QItemRenderCacheEntry(const QStyleOptionViewItem &option,
+                                             const QAbstractItemDelegate *delegate, qreal devicePixelRatio)
+    : delegate(delegate),
+      size(option.rect.size()),
+      state(option.state),
+      features(option.features),
+      colorGroup(option.palette.currentColorGroup()),
+      paletteKey(option.palette.cacheKey()),
+      font(option.font),
+      decorationSize(option.decorationSize),
+      displayAlignment(option.displayAlignment),
+      textElideMode(option.textElideMode),
+      direction(option.direction),
+      devicePixelRatio(devicePixelRatio)
+{
+}
+
+bool QItemRenderCacheEntry::matches(const QStyleOptionViewItem &option, const QAbstractItemDelegate *delegate,
+                                    qreal devicePixelRatio) const
+{
+    return this->delegate == delegate
+        && size == option.rect.size()
+        && state == option.state
+        && features == option.features
+        && colorGroup == option.palette.currentColorGroup()
+        && paletteKey == option.palette.cacheKey()
+        && decorationSize == option.decorationSize
+        && displayAlignment == option.displayAlignment
+        && textElideMode == option.textElideMode
+        && direction == option.direction
+        && this->devicePixelRatio == devicePixelRatio
+        && font == option.font;
+}
+
+/*!
+  \internal
+
+  Paints the item at \a index with \a delegate, going through the render cache
+  when it is enabled.
+*/
+void QAbstractItemViewPrivate::paintItem(QAbstractItemDelegate *delegate, QPainter *painter,
+                                         const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    // only plain painting on the viewport can be cached
+    if (renderCache.maxCost() <= 0 || option.rect.isEmpty()
+        || painter->device() != viewport || !painter->transform().isIdentity()) {
+        delegate->paint(painter, option, index);
+        return;
+    }
+
+    const qreal dpr = viewport->devicePixelRatioF();
+    if (const QItemRenderCacheEntry *entry = renderCache.object(index)) {
+        if (entry->matches(option, delegate, dpr)) {
+            painter->drawPixmap(option.rect.topLeft(), entry->pixmap);
+            return;
+        }
+    }
+
+    QItemRenderCacheEntry *entry = new QItemRenderCacheEntry(option, delegate, dpr);
+    entry->pixmap = QPixmap(option.rect.size() * dpr);
+    entry->pixmap.setDevicePixelRatio(dpr);
+    entry->pixmap.fill(Qt::transparent);
+    {
+        QPainter p(&entry->pixmap);
+        p.setRenderHints(painter->renderHints());
+        p.setFont(painter->font());
+        QStyleOptionViewItem opt = option;
+        opt.rect.moveTo(0, 0);
+        delegate->paint(&p, opt, index);
+    }
+    painter->drawPixmap(option.rect.topLeft(), entry->pixmap);
+
+    const int cost = qMax(1, entry->pixmap.width() * entry->pixmap.height() * entry->pixmap.depth() / (8 * 1024));
+    renderCache.insert(index, entry, cost);
+}
+
+void QAbstractItemViewPrivate::clearRenderCache()
+{
+    renderCache.clear();
+}
+
+void QAbstractItemViewPrivate::clearRenderCache(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (renderCache.isEmpty())
+        return;
+    if (topLeft == bottomRight) {
+        renderCache.remove(topLeft);
+        return;
+    }
+    const QModelIndex parent = topLeft.parent();
+    if (bottomRight.parent() != parent) {
+        clearRenderCache();
+        return;
+    }
+    foreach (const QModelIndex &index, renderCache.keys()) {
+        if (index.row() >= topLeft.row() && index.row() <= bottomRight.row()
+            && index.column() >= topLeft.column() && index.column() <= bottomRight.column()
+            && index.parent() == parent) {
+            renderCache.remove(index);
+        }
+    }
+}
+
 QWidget *QAbstractItemViewPrivate::editor(const QModelIndex &index,
                                           const QStyleOptionViewItem &options)
 {
@@ -72,6 +72,7 @@ class Q_WIDGETS_EXPORT QAbstractItemView : public QAbstractScrollArea
     Q_PROPERTY(SelectionBehavior selectionBehavior READ selectionBehavior WRITE setSelectionBehavior)
     Q_PROPERTY(QSize iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged)
     Q_PROPERTY(Qt::TextElideMode textElideMode READ textElideMode WRITE setTextElideMode)
+    Q_PROPERTY(int renderCacheLimit READ renderCacheLimit WRITE setRenderCacheLimit)
     Q_PROPERTY(ScrollMode verticalScrollMode READ verticalScrollMode WRITE setVerticalScrollMode)
     Q_PROPERTY(ScrollMode horizontalScrollMode READ horizontalScrollMode WRITE setHorizontalScrollMode)
 
@@ -192,6 +193,9 @@ public:
     void setTextElideMode(Qt::TextElideMode mode);
     Qt::TextElideMode textElideMode() const;
 
+    void setRenderCacheLimit(int limit);
+    int renderCacheLimit() const;
+
     virtual void keyboardSearch(const QString &search);
 
     virtual QRect visualRect(const QModelIndex &index) const = 0;
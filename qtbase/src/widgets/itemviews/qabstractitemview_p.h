@@ -56,11 +56,37 @@
 #include "QtCore/qdebug.h"
 #include "QtCore/qbasictimer.h"
 #include "QtCore/qelapsedtimer.h"
+#include "QtCore/qcache.h"
+#include "QtGui/qpixmap.h"
+#include "QtWidgets/qstyleoption.h"
 
 #ifndef QT_NO_ITEMVIEWS
 
 QT_BEGIN_NAMESPACE
 
+// A rendered item, valid as long as the item is painted with the same options.
+struct QItemRenderCacheEntry
+{
+    QItemRenderCacheEntry(const QStyleOptionViewItem &option, const QAbstractItemDelegate *delegate,
+                          qreal devicePixelRatio);
+    bool matches(const QStyleOptionViewItem &option, const QAbstractItemDelegate *delegate,
+                 qreal devicePixelRatio) const;
+
+    QPixmap pixmap;
+    const QAbstractItemDelegate *delegate;
+    QSize size;
+    QStyle::State state;
+    QStyleOptionViewItem::ViewItemFeatures features;
+    QPalette::ColorGroup colorGroup;
+    qint64 paletteKey;
+    QFont font;
+    QSize decorationSize;
+    Qt::Alignment displayAlignment;
+    Qt::TextElideMode textElideMode;
+    Qt::LayoutDirection direction;
+    qreal devicePixelRatio;
+};
+
 struct QEditorInfo {
     QEditorInfo(QWidget *e, bool s): widget(QPointer<QWidget>(e)), isStatic(s) {}
     QEditorInfo(): isStatic(false) {}
@@ -274,6 +300,11 @@ public:
         return state == QAbstractItemView::AnimatingState;
     }
 
+    void paintItem(QAbstractItemDelegate *delegate, QPainter *painter,
+                   const QStyleOptionViewItem &option, const QModelIndex &index);
+    void clearRenderCache();
+    void clearRenderCache(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
     inline QAbstractItemDelegate *delegateForIndex(const QModelIndex &index) const {
         QMap<int, QPointer<QAbstractItemDelegate> >::ConstIterator it;
 
@@ -424,6 +455,9 @@ public:
     QSize iconSize;
     Qt::TextElideMode textElideMode;
 
+    // rendered items by index, cost in kilobytes; disabled while the limit is 0
+    QCache<QModelIndex, QItemRenderCacheEntry> renderCache;
+
     QRegion updateRegion; // used for the internal update system
     QPoint scrollDelayOffset;
 
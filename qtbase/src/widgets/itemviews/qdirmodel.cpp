@@ -1251,11 +1251,14 @@ void QDirModelPrivate::restorePersistentIndexes()
         QModelIndex idx = q->index(path, column);
         if (idx != data->index || data->model == 0) {
             //data->model may be equal to 0 if the model is getting destroyed
+            removeFromPersistentLevel(data);
             persistent.indexes.remove(data->index);
             data->index = idx;
             data->model = q;
-            if (idx.isValid())
+            if (idx.isValid()) {
                 persistent.indexes.insert(idx, data);
+                addToPersistentLevel(data);
+            }
         }
     }
     savedPersistent.clear();
@@ -3171,18 +3171,14 @@ bool QHeaderViewPrivate::isSectionSelected(int section) const
 
 bool QHeaderViewPrivate::isFirstVisibleSection(int section) const
 {
-    if (sectionStartposRecalc)
-        recalcSectionStartPos();
     const SectionItem &item = sectionItems.at(section);
-    return item.size > 0 && item.calculated_startpos == 0;
+    return item.size > 0 && headerSectionPosition(section) == 0;
 }
 
 bool QHeaderViewPrivate::isLastVisibleSection(int section) const
 {
-    if (sectionStartposRecalc)
-        recalcSectionStartPos();
     const SectionItem &item = sectionItems.at(section);
-    return item.size > 0 && item.calculatedEndPos() == length;
+    return item.size > 0 && headerSectionPosition(section) + int(item.size) == length;
 }
 
 /*!
@@ -3346,14 +3342,23 @@ void QHeaderViewPrivate::resizeSections(QHeaderView::ResizeMode globalMode, bool
 void QHeaderViewPrivate::createSectionItems(int start, int end, int size, QHeaderView::ResizeMode mode)
 {
     int sizePerSection = size / (end - start + 1);
-    if (end >= sectionItems.count()) {
+    const int oldCount = sectionItems.count();
+    if (end >= oldCount) {
+        // appending sections of the same size as all the others keeps the positions valid
+        if (!sectionStartposRecalc && sectionStartposTree.isEmpty() && start == oldCount
+            && (oldCount == 0 || sizePerSection == uniformSectionSize)) {
+            uniformSectionSize = sizePerSection;
+        } else {
+            sectionStartposRecalc = true;
+        }
         sectionItems.resize(end + 1);
-        sectionStartposRecalc = true;
     }
     SectionItem *sectiondata = sectionItems.data();
     for (int i = start; i <= end; ++i) {
-        length += (sizePerSection - sectiondata[i].size);
-        sectionStartposRecalc |= (sectiondata[i].size != sizePerSection);
+        const int delta = sizePerSection - int(sectiondata[i].size);
+        length += delta;
+        if (delta && i < oldCount)
+            updateSectionStartPos(i, delta);
         sectiondata[i].size = sizePerSection;
         sectiondata[i].resizeMode = mode;
     }
@@ -3361,8 +3366,11 @@ void QHeaderViewPrivate::createSectionItems(int start, int end, int size, QHeade
 
 void QHeaderViewPrivate::removeSectionsFromSectionItems(int start, int end)
 {
-    // remove sections
-    sectionStartposRecalc |= (end != sectionItems.count() - 1);
+    // remove sections; the positions before a removed tail stay the same
+    if (end != sectionItems.count() - 1)
+        sectionStartposRecalc = true;
+    else if (!sectionStartposTree.isEmpty())
+        sectionStartposTree.resize(start + 1);
     int removedlength = 0;
     for (int u = start; u <= end; ++u)
         removedlength += sectionItems.at(u).size;
@@ -3547,14 +3555,44 @@ void QHeaderViewPrivate::updateDefaultSectionSizeFromStyle()
 
 void QHeaderViewPrivate::recalcSectionStartPos() const // linear (but fast)
 {
-    int pixelpos = 0;
-    for (QVector<SectionItem>::const_iterator i = sectionItems.constBegin(); i != sectionItems.constEnd(); ++i) {
-        i->calculated_startpos = pixelpos; // write into const mutable
-        pixelpos += i->size;
+    const int count = sectionItems.count();
+    uniformSectionSize = count ? int(sectionItems.at(0).size) : 0;
+    int uniform = 1;
+    while (uniform < count && int(sectionItems.at(uniform).size) == uniformSectionSize)
+        ++uniform;
+    if (uniform == count) {
+        sectionStartposTree.clear();
+    } else {
+        // build the tree bottom-up, each node adding itself to its parent
+        sectionStartposTree.resize(count + 1);
+        int *tree = sectionStartposTree.data();
+        tree[0] = 0;
+        for (int n = 1; n <= count; ++n)
+            tree[n] = sectionItems.at(n - 1).size;
+        for (int n = 1; n <= count; ++n) {
+            const int parent = n + (n & -n);
+            if (parent <= count)
+                tree[parent] += tree[n];
+        }
     }
     sectionStartposRecalc = false;
 }
 
+void QHeaderViewPrivate::updateSectionStartPos(int visual, int delta)
+{
+    if (sectionStartposRecalc)
+        return;
+    if (sectionStartposTree.isEmpty()) {
+        // the sections no longer have the same size, build the tree on the next lookup
+        sectionStartposRecalc = true;
+        return;
+    }
+    int *tree = sectionStartposTree.data();
+    const int count = sectionStartposTree.count();
+    for (int n = visual + 1; n < count; n += n & -n)
+        tree[n] += delta;
+}
+
 void QHeaderViewPrivate::resizeSectionItem(int visualIndex, int oldSize, int newSize)
 {
     Q_Q(QHeaderView);
@@ -3575,7 +3613,13 @@ int QHeaderViewPrivate::headerSectionPosition(int visual) const
     if (visual < sectionCount() && visual >= 0) {
         if (sectionStartposRecalc)
             recalcSectionStartPos();
-        return sectionItems.at(visual).calculated_startpos;
+        if (sectionStartposTree.isEmpty())
+            return visual * uniformSectionSize;
+        const int *tree = sectionStartposTree.constData();
+        int position = 0;
+        for (int n = visual; n > 0; n &= n - 1)
+            position += tree[n];
+        return position;
     }
     return -1;
 }
@@ -3584,20 +3628,29 @@ int QHeaderViewPrivate::headerVisualIndexAt(int position) const
 {
     if (sectionStartposRecalc)
         recalcSectionStartPos();
-    int startidx = 0;
-    int endidx = sectionItems.count() - 1;
-    while (startidx <= endidx) {
-        int middle = (endidx + startidx) / 2;
-        if (sectionItems.at(middle).calculated_startpos > position) {
-            endidx = middle - 1;
-        } else {
-            if (sectionItems.at(middle).calculatedEndPos() <= position)
-                startidx = middle + 1;
-            else // we found it.
-                return middle;
+    const int count = sectionItems.count();
+    if (position < 0)
+        return -1;
+    if (sectionStartposTree.isEmpty()) {
+        if (uniformSectionSize <= 0)
+            return -1;
+        const int visual = position / uniformSectionSize;
+        return visual < count ? visual : -1;
+    }
+    // find the number of sections that end at or before position
+    const int *tree = sectionStartposTree.constData();
+    int step = 1;
+    while (step * 2 <= count)
+        step *= 2;
+    int visual = 0;
+    for (; step > 0; step /= 2) {
+        const int n = visual + step;
+        if (n <= count && tree[n] <= position) {
+            visual = n;
+            position -= tree[n];
         }
     }
-    return -1;
+    return visual < count ? visual : -1;
 }
 
 void QHeaderViewPrivate::setHeaderSectionResizeMode(int visual, QHeaderView::ResizeMode mode)
@@ -94,6 +94,7 @@ public:
           sectionIndicator(0),
           globalResizeMode(QHeaderView::Interactive),
           sectionStartposRecalc(true),
+          uniformSectionSize(0),
           resizeContentsPrecision(1000)
     {}
 
@@ -288,6 +289,11 @@ public:
     QHeaderView::ResizeMode globalResizeMode;
     QList<QPersistentModelIndex> persistentHiddenSections;
     mutable bool sectionStartposRecalc;
+    // The start positions of the sections: while all sections have the same size they
+    // are computed from uniformSectionSize, otherwise from a Fenwick tree of the section
+    // sizes (sectionStartposTree[0] is unused), so that lookups and resizes are O(log n).
+    mutable int uniformSectionSize;
+    mutable QVector<int> sectionStartposTree;
     int resizeContentsPrecision;
     // header sections
 
@@ -298,16 +304,14 @@ public:
         uint currentlyUnusedPadding : 6;
 
         union { // This union is made in order to save space and ensure good vector performance (on remove)
-            mutable int calculated_startpos; // <- this is the primary used member.
-            mutable int tmpLogIdx;         // When one of these 'tmp'-members has been used we call
-            int tmpDataStreamSectionCount; // recalcSectionStartPos() or set sectionStartposRecalc to true
-        };                                 // to ensure that calculated_startpos will be calculated afterwards.
+            mutable int tmpLogIdx;
+            int tmpDataStreamSectionCount;
+        };
 
         inline SectionItem() : size(0), isHidden(0), resizeMode(QHeaderView::Interactive) {}
         inline SectionItem(int length, QHeaderView::ResizeMode mode)
-            : size(length), isHidden(0), resizeMode(mode), calculated_startpos(-1) {}
+            : size(length), isHidden(0), resizeMode(mode), tmpLogIdx(-1) {}
         inline int sectionSize() const { return size; }
-        inline int calculatedEndPos() const { return calculated_startpos + size; }
 #ifndef QT_NO_DATASTREAM
         inline void write(QDataStream &out) const
         { out << static_cast<int>(size); out << 1; out << (int)resizeMode; }
@@ -324,6 +328,7 @@ public:
     void setDefaultSectionSize(int size);
     void updateDefaultSectionSizeFromStyle();
     void recalcSectionStartPos() const; // not really const
+    void updateSectionStartPos(int visual, int delta);
 
     inline int headerLength() const { // for debugging
         int len = 0;
@@ -1040,7 +1040,7 @@ void QListView::paintEvent(QPaintEvent *e)
             previousRow = row;
         }
 
-        d->delegateForIndex(*it)->paint(&painter, option, *it);
+        d->paintItem(d->delegateForIndex(*it), &painter, option, *it);
     }
 
 #ifndef QT_NO_DRAGANDDROP
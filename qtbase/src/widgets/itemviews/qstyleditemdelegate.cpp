@@ -57,6 +57,7 @@
 #include <qmetaobject.h>
 #include <qtextlayout.h>
 #include <private/qabstractitemdelegate_p.h>
+#include <private/qabstractitemmodel_p.h>
 #include <private/qtextengine_p.h>
 #include <private/qlayoutengine_p.h>
 #include <qdebug.h>
@@ -268,28 +269,38 @@ QString QStyledItemDelegate::displayText(const QVariant &value, const QLocale& l
 void QStyledItemDelegate::initStyleOption(QStyleOptionViewItem *option,
                                          const QModelIndex &index) const
 {
-    QVariant value = index.data(Qt::FontRole);
+    // fetch all the roles with a single call into the model
+    enum { Font, TextAlignment, Foreground, CheckState, Decoration, Display, Background, RoleCount };
+    static const int roles[RoleCount] = {
+        Qt::FontRole, Qt::TextAlignmentRole, Qt::ForegroundRole, Qt::CheckStateRole,
+        Qt::DecorationRole, Qt::DisplayRole, Qt::BackgroundRole
+    };
+    QVariant values[RoleCount];
+    if (const QAbstractItemModel *model = index.model())
+        QAbstractItemModelPrivate::get(model)->multiData(index, roles, values, RoleCount);
+
+    QVariant value = values[Font];
     if (value.isValid() && !value.isNull()) {
         option->font = qvariant_cast<QFont>(value).resolve(option->font);
         option->fontMetrics = QFontMetrics(option->font);
     }
 
-    value = index.data(Qt::TextAlignmentRole);
+    value = values[TextAlignment];
     if (value.isValid() && !value.isNull())
         option->displayAlignment = Qt::Alignment(value.toInt());
 
-    value = index.data(Qt::ForegroundRole);
+    value = values[Foreground];
     if (value.canConvert<QBrush>())
         option->palette.setBrush(QPalette::Text, qvariant_cast<QBrush>(value));
 
     option->index = index;
-    value = index.data(Qt::CheckStateRole);
+    value = values[CheckState];
     if (value.isValid() && !value.isNull()) {
         option->features |= QStyleOptionViewItem::HasCheckIndicator;
         option->checkState = static_cast<Qt::CheckState>(value.toInt());
     }
 
-    value = index.data(Qt::DecorationRole);
+    value = values[Decoration];
     if (value.isValid() && !value.isNull()) {
         option->features |= QStyleOptionViewItem::HasDecoration;
         switch (value.type()) {
@@ -332,13 +343,13 @@ void QStyledItemDelegate::initStyleOption(QStyleOptionViewItem *option,
         }
     }
 
-    value = index.data(Qt::DisplayRole);
+    value = values[Display];
     if (value.isValid() && !value.isNull()) {
         option->features |= QStyleOptionViewItem::HasDisplay;
         option->text = displayText(value, option->locale);
     }
 
-    option->backgroundBrush = qvariant_cast<QBrush>(index.data(Qt::BackgroundRole));
+    option->backgroundBrush = qvariant_cast<QBrush>(values[Background]);
 
     // disable style animations for checkboxes etc. within itemviews (QTBUG-30146)
     option->styleObject = 0;
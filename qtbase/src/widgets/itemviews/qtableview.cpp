@@ -912,7 +912,7 @@ void QTableViewPrivate::drawCell(QPainter *painter, const QStyleOptionViewItem &
 
     q->style()->drawPrimitive(QStyle::PE_PanelItemViewRow, &opt, painter, q);
 
-    q->itemDelegate(index)->paint(painter, opt, index);
+    paintItem(q->itemDelegate(index), painter, opt, index);
 }
 
 /*!
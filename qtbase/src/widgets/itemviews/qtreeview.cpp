@@ -447,9 +447,50 @@ bool QTreeView::uniformRowHeights() const
 void QTreeView::setUniformRowHeights(bool uniform)
 {
     Q_D(QTreeView);
+    if (d->lazyLayout && d->uniformRowHeights != uniform)
+        d->doDelayedItemsLayout(); // switch between the lazy and the flat layout
     d->uniformRowHeights = uniform;
 }
 
+/*!
+  \property QTreeView::lazyLayout
+  \brief whether the view lays out its items lazily
+  \since 5.6
+
+  By default, the tree view keeps an entry for every visible row, which means
+  that expanding, collapsing or inserting rows and calling expandAll() takes
+  time proportional to the number of visible rows in the whole tree.
+
+  If this property is \c true and uniformRowHeights is also \c true, the view
+  only keeps track of the number of visible rows below each expanded item.
+  Expanding, collapsing, inserting and removing rows then only touch the
+  affected level of the tree, and the information about a row is only
+  created from the model when the row is painted or otherwise accessed.
+  This is useful for models with millions of visible rows.
+
+  The property has no effect if uniformRowHeights is \c false.
+
+  By default, this property is \c false.
+
+  \sa uniformRowHeights, expandAll()
+*/
+bool QTreeView::lazyLayout() const
+{
+    Q_D(const QTreeView);
+    return d->lazyLayout;
+}
+
+void QTreeView::setLazyLayout(bool enable)
+{
+    Q_D(QTreeView);
+    if (d->lazyLayout == enable)
+        return;
+    d->lazyLayout = enable;
+    if (enable && !d->lazyItems)
+        d->lazyItems = new QTreeViewLazyLayout(d);
+    d->doDelayedItemsLayout();
+}
+
 /*!
   \property QTreeView::itemsExpandable
   \brief whether the items are expandable by the user.
@@ -672,7 +713,7 @@ void QTreeView::setFirstColumnSpanned(int row, const QModelIndex &parent, bool s
     d->executePostedLayout();
     int i = d->viewIndex(index);
     if (i >= 0)
-        d->viewItems[i].spanning = span;
+        d->viewItems.setSpanning(i, span);
 
     d->viewport->update();
 }
@@ -705,7 +746,7 @@ void QTreeView::dataChanged(const QModelIndex &topLeft, const QModelIndex &botto
             d->invalidateHeightCache(topViewIndex);
             sizeChanged |= (oldHeight != d->itemHeight(topViewIndex));
             if (topLeft.column() == 0)
-                d->viewItems[topViewIndex].hasChildren = d->hasVisibleChildren(topLeft);
+                d->viewItems.setHasChildren(topViewIndex, d->hasVisibleChildren(topLeft));
         } else {
             int bottomViewIndex = d->viewIndex(bottomRight);
             for (int i = topViewIndex; i <= bottomViewIndex; ++i) {
@@ -713,7 +754,7 @@ void QTreeView::dataChanged(const QModelIndex &topLeft, const QModelIndex &botto
                 d->invalidateHeightCache(i);
                 sizeChanged |= (oldHeight != d->itemHeight(i));
                 if (topLeft.column() == 0)
-                    d->viewItems[i].hasChildren = d->hasVisibleChildren(d->viewItems.at(i).index);
+                    d->viewItems.setHasChildren(i, d->hasVisibleChildren(d->viewItems.at(i).index));
             }
         }
     }
@@ -1451,7 +1492,7 @@ void QTreeViewPrivate::adjustViewOptionsForIndex(QStyleOptionViewItem *option, c
 void QTreeView::drawTree(QPainter *painter, const QRegion &region) const
 {
     Q_D(const QTreeView);
-    const QVector<QTreeViewItem> viewItems = d->viewItems;
+    const QTreeViewItems viewItems = d->viewItems;
 
     QStyleOptionViewItem option = d->viewOptionsV1();
     const QStyle::State state = option.state;
@@ -1810,7 +1851,7 @@ void QTreeView::drawBranches(QPainter *painter, const QRect &rect,
     const int indent = d->indent;
     const int outer = d->rootDecoration ? 0 : 1;
     const int item = d->current;
-    const QTreeViewItem &viewItem = d->viewItems.at(item);
+    const QTreeViewItem viewItem = d->viewItems.at(item);
     int level = viewItem.level;
     QRect primitive(reverse ? rect.left() : rect.right() + 1, rect.top(), indent, rect.height());
 
@@ -2502,7 +2543,7 @@ void QTreeView::scrollContentsBy(int dx, int dy)
         int previousScrollbarValue = currentScrollbarValue + dy; // -(-dy)
         int currentViewIndex = currentScrollbarValue; // the first visible item
         int previousViewIndex = previousScrollbarValue;
-        const QVector<QTreeViewItem> viewItems = d->viewItems;
+        const QTreeViewItems viewItems = d->viewItems;
         dy = 0;
         if (previousViewIndex < currentViewIndex) { // scrolling down
             for (int i = previousViewIndex; i < currentViewIndex; ++i) {
@@ -2564,13 +2605,24 @@ void QTreeView::rowsInserted(const QModelIndex &parent, int start, int end)
         return;
     }
 
+    if (d->viewItems.lazy) {
+        if (d->viewItems.lazy->insertRows(parent, start, end)) {
+            updateGeometries();
+            viewport()->update();
+        } else {
+            d->doDelayedItemsLayout();
+        }
+        QAbstractItemView::rowsInserted(parent, start, end);
+        return;
+    }
+
     const int parentItem = d->viewIndex(parent);
     if (((parentItem != -1) && d->viewItems.at(parentItem).expanded)
         || (parent == d->root)) {
         d->doDelayedItemsLayout();
     } else if (parentItem != -1 && parentRowCount == delta) {
         // the parent just went from 0 children to more. update to re-paint the decoration
-        d->viewItems[parentItem].hasChildren = true;
+        d->viewItems.setHasChildren(parentItem, true);
         viewport()->update();
     }
     QAbstractItemView::rowsInserted(parent, start, end);
@@ -2584,7 +2636,8 @@ void QTreeView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int e
 {
     Q_D(QTreeView);
     QAbstractItemView::rowsAboutToBeRemoved(parent, start, end);
-    d->viewItems.clear();
+    if (!d->viewItems.lazy || !d->viewItems.lazy->removeRows(parent, start, end))
+        d->viewItems.clear();
 }
 
 /*!
@@ -2596,8 +2649,15 @@ void QTreeView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int e
 void QTreeView::rowsRemoved(const QModelIndex &parent, int start, int end)
 {
     Q_D(QTreeView);
-    d->viewItems.clear();
-    d->doDelayedItemsLayout();
+    if (d->viewItems.lazy && !d->viewItems.isEmpty()) {
+        // the lazy layout was already updated in rowsAboutToBeRemoved()
+        d->viewItems.lazy->invalidate();
+        updateGeometries();
+        viewport()->update();
+    } else {
+        d->viewItems.clear();
+        d->doDelayedItemsLayout();
+    }
     d->hasRemovedItems = true;
     d->_q_rowsRemoved(parent, start, end);
 }
@@ -2775,11 +2835,15 @@ void QTreeView::expandToDepth(int depth)
     d->expandedIndexes.clear();
     d->interruptDelayedItemsLayout();
     d->layout(-1);
-    for (int i = 0; i < d->viewItems.count(); ++i) {
-        if (d->viewItems.at(i).level <= (uint)depth) {
-            d->viewItems[i].expanded = true;
-            d->layout(i);
-            d->storeExpanded(d->viewItems.at(i).index);
+    if (d->viewItems.lazy) {
+        d->viewItems.lazy->layout(-1, false, depth);
+    } else {
+        for (int i = 0; i < d->viewItems.count(); ++i) {
+            if (d->viewItems.at(i).level <= (uint)depth) {
+                d->viewItems[i].expanded = true;
+                d->layout(i);
+                d->storeExpanded(d->viewItems.at(i).index);
+            }
         }
     }
 
@@ -2873,7 +2937,7 @@ int QTreeView::sizeHintForColumn(int column) const
     ensurePolished();
     int w = 0;
     QStyleOptionViewItem option = d->viewOptionsV1();
-    const QVector<QTreeViewItem> viewItems = d->viewItems;
+    const QTreeViewItems viewItems = d->viewItems;
 
     const int maximumProcessRows = d->header->resizeContentsPrecision(); // To avoid this to take forever.
 
@@ -3088,7 +3152,7 @@ void QTreeViewPrivate::expand(int item, bool emitSignal)
         stateBeforeAnimation = state;
     q->setState(QAbstractItemView::ExpandingState);
     storeExpanded(index);
-    viewItems[item].expanded = true;
+    viewItems.setExpanded(item, true);
     layout(item);
     q->setState(stateBeforeAnimation);
 
@@ -3147,7 +3211,7 @@ void QTreeViewPrivate::collapse(int item, bool emitSignal)
     delayedAutoScroll.stop();
 
     int total = viewItems.at(item).total;
-    const QModelIndex &modelIndex = viewItems.at(item).index;
+    const QModelIndex modelIndex = viewItems.at(item).index;
     if (!isPersistent(modelIndex))
         return; // if the index is not persistent, no chances it is expanded
     QSet<QPersistentModelIndex>::iterator it = expandedIndexes.find(modelIndex);
@@ -3164,13 +3228,17 @@ void QTreeViewPrivate::collapse(int item, bool emitSignal)
         stateBeforeAnimation = state;
     q->setState(QAbstractItemView::CollapsingState);
     expandedIndexes.erase(it);
-    viewItems[item].expanded = false;
-    int index = item;
-    while (index > -1) {
-        viewItems[index].total -= total;
-        index = viewItems[index].parentItem;
+    if (viewItems.lazy) {
+        viewItems.lazy->collapse(item);
+    } else {
+        viewItems[item].expanded = false;
+        int index = item;
+        while (index > -1) {
+            viewItems[index].total -= total;
+            index = viewItems[index].parentItem;
+        }
+        removeViewItems(item + 1, total); // collapse
     }
-    removeViewItems(item + 1, total); // collapse
     q->setState(stateBeforeAnimation);
 
     if (emitSignal) {
@@ -3318,6 +3386,20 @@ void QTreeViewPrivate::_q_columnsRemoved(const QModelIndex &parent, int start, i
 void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninitialized)
 {
     Q_Q(QTreeView);
+    if (i == -1) {
+        QTreeViewLazyLayout *lazy = useLazyLayout() ? lazyItems : 0;
+        if (viewItems.lazy != lazy) {
+            viewItems.clear();
+            viewItems.lazy = lazy;
+        }
+    }
+    if (viewItems.lazy) {
+        if (i == -1)
+            defaultItemHeight = q->indexRowSizeHint(model->index(0, 0, root));
+        viewItems.lazy->layout(i, recursiveExpanding);
+        return;
+    }
+
     QModelIndex current;
     QModelIndex parent = (i < 0) ? (QModelIndex)root : modelIndex(i);
 
@@ -3446,7 +3528,7 @@ int QTreeViewPrivate::itemHeight(int item) const
     int height = viewItems.at(item).height;
     if (height <= 0) {
         height = q_func()->indexRowSizeHint(index);
-        viewItems[item].height = height;
+        viewItems.setHeight(item, height);
     }
     return qMax(height, 0);
 }
@@ -3560,6 +3642,8 @@ int QTreeViewPrivate::viewIndex(const QModelIndex &_index) const
 {
     if (!_index.isValid() || viewItems.isEmpty())
         return -1;
+    if (viewItems.lazy)
+        return viewItems.lazy->viewIndex(_index);
 
     const int totalCount = viewItems.count();
     const QModelIndex index = _index.sibling(_index.row(), 0);
@@ -3942,6 +4026,420 @@ void QTreeViewPrivate::updateIndentationFromStyle()
     indent = q->style()->pixelMetric(QStyle::PM_TreeViewIndentation, 0, q);
 }
 
+int QTreeViewLazyLayout::Node::prefix(int row) const
+{
+    int sum = 0;
+    for (int i = row; i > 0; i -= i & -i)
+        sum += counts.at(i - 1);
+    return sum;
+}
+
+void QTreeViewLazyLayout::Node::add(int row, int delta)
+{
+    const int n = counts.size();
+    int *data = counts.data();
+    for (int i = row + 1; i <= n; i += i & -i)
+        data[i - 1] += delta;
+}
+
+/*
+  Returns the row containing the view \a item, counted from the first row of
+  this node, and sets \a offset to the position of the item inside that row:
+  0 for the row itself, otherwise 1 + the position in the row's descendants.
+*/
+int QTreeViewLazyLayout::Node::find(int item, int *offset) const
+{
+    const int n = counts.size();
+    int step = 1;
+    while (step * 2 <= n)
+        step *= 2;
+    int pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n && counts.at(pos + step - 1) <= item) {
+            pos += step;
+            item -= counts.at(pos - 1);
+        }
+    }
+    *offset = item;
+    return pos;
+}
+
+// turns the per row counts into a Fenwick tree in O(n)
+void QTreeViewLazyLayout::Node::build()
+{
+    const int n = counts.size();
+    int *data = counts.data();
+    for (int i = 1; i <= n; ++i) {
+        const int j = i + (i & -i);
+        if (j <= n)
+            data[j - 1] += data[i - 1];
+    }
+}
+
+// turns the Fenwick tree back into per row counts in O(n)
+void QTreeViewLazyLayout::Node::unbuild()
+{
+    const int n = counts.size();
+    int *data = counts.data();
+    for (int i = n; i > 0; --i) {
+        const int j = i + (i & -i);
+        if (j <= n)
+            data[j - 1] -= data[i - 1];
+    }
+}
+
+QTreeViewLazyLayout::QTreeViewLazyLayout(QTreeViewPrivate *priv)
+    : d(priv), root(0), building(false), nextSlot(0)
+{
+}
+
+QTreeViewLazyLayout::~QTreeViewLazyLayout()
+{
+    delete root;
+}
+
+void QTreeViewLazyLayout::clear()
+{
+    delete root;
+    root = 0;
+    invalidate();
+}
+
+void QTreeViewLazyLayout::invalidate() const
+{
+    cacheSlots.clear();
+    cachedItems.fill(-1);
+}
+
+/*
+  Returns the view item \a i, creating it from the model if it is not cached.
+*/
+QTreeViewItem &QTreeViewLazyLayout::item(int i) const
+{
+    Q_ASSERT(i >= 0 && i < count());
+    const int cached = cacheSlots.value(i, -1);
+    if (cached != -1)
+        return cache[cached];
+
+    if (cache.isEmpty()) {
+        cache.resize(CacheSize);
+        cachedItems.fill(-1, CacheSize);
+    }
+    const int slot = nextSlot;
+    nextSlot = (nextSlot + 1) % CacheSize;
+    if (cachedItems.at(slot) != -1)
+        cacheSlots.remove(cachedItems.at(slot));
+    cachedItems[slot] = i;
+    cacheSlots.insert(i, slot);
+
+    int row;
+    const Node *node = locate(i, &row);
+    const QModelIndex parent = node->index;
+    const Node *child = node->children.value(row);
+    QTreeViewItem &viewItem = cache[slot];
+    viewItem.index = d->model->index(row, 0, parent);
+    viewItem.parentItem = i - 1 - node->prefix(row);
+    viewItem.level = node->level + 1;
+    viewItem.expanded = child || d->isIndexExpanded(viewItem.index);
+    viewItem.total = child ? child->total : 0;
+    viewItem.hasChildren = viewItem.expanded ? viewItem.total > 0 : d->hasVisibleChildren(viewItem.index);
+    viewItem.hasMoreSiblings = node->total - node->prefix(row + 1) > 0;
+    viewItem.spanning = static_cast<QTreeView *>(d->q_ptr)->isFirstColumnSpanned(row, parent);
+    viewItem.height = 0;
+    return viewItem;
+}
+
+/*
+  The lazy items are created from the expanded and spanning indexes of the
+  view and from the model, so the setters store the change there; the cached
+  copy is only updated so that it stays consistent until it is evicted.
+*/
+void QTreeViewLazyLayout::setExpanded(int i, bool expanded)
+{
+    QTreeViewItem &viewItem = item(i);
+    if (expanded)
+        d->storeExpanded(viewItem.index);
+    else
+        d->expandedIndexes.remove(viewItem.index);
+    viewItem.expanded = expanded;
+}
+
+void QTreeViewLazyLayout::setSpanning(int i, bool spanning)
+{
+    QTreeViewItem &viewItem = item(i);
+    const QPersistentModelIndex persistent(viewItem.index);
+    const int span = d->spanningIndexes.indexOf(persistent);
+    if (spanning && span == -1)
+        d->spanningIndexes.append(persistent);
+    else if (!spanning && span != -1)
+        d->spanningIndexes.remove(span);
+    viewItem.spanning = spanning;
+}
+
+// hasChildren is taken from the model whenever the item is created again
+void QTreeViewLazyLayout::setHasChildren(int i, bool hasChildren)
+{
+    item(i).hasChildren = hasChildren;
+}
+
+/*
+  Creates the node for the expanded \a index, which is the \a row of \a parent.
+
+  If \a recursiveExpanding is set all the children are expanded as well. If \a depth
+  is not negative, all the children up to that level are expanded.
+*/
+QTreeViewLazyLayout::Node *QTreeViewLazyLayout::createNode(Node *parent, int row, const QModelIndex &index,
+                                                           bool recursiveExpanding, int depth)
+{
+    QTreeView *q = static_cast<QTreeView *>(d->q_ptr);
+    QAbstractItemModel *model = d->model;
+    Node *node = new Node(parent, row);
+    node->index = index;
+
+    int count = 0;
+    if (model->hasChildren(index)) {
+        if (model->canFetchMore(index))
+            model->fetchMore(index);
+        count = model->rowCount(index);
+    }
+    node->counts.fill(1, count);
+    node->total = count;
+
+    const int level = node->level + 1;
+    const bool expandToDepth = depth >= 0 && level <= depth;
+    // with no expanded or hidden rows every row is exactly one view item
+    if (recursiveExpanding || expandToDepth || !d->expandedIndexes.isEmpty() || !d->hiddenIndexes.isEmpty()) {
+        int *counts = node->counts.data();
+        for (int j = 0; j < count; ++j) {
+            const QModelIndex current = model->index(j, 0, index);
+            if (d->isRowHidden(current)) {
+                counts[j] = 0;
+                --node->total;
+                continue;
+            }
+            bool expand = false;
+            if (recursiveExpanding) {
+                expand = !(current.flags() & Qt::ItemNeverHasChildren);
+                if (expand && d->storeExpanded(current) && !q->signalsBlocked())
+                    emit q->expanded(current);
+            } else if (expandToDepth) {
+                d->storeExpanded(current);
+                expand = true;
+            } else {
+                expand = d->isIndexExpanded(current);
+            }
+            if (expand && model->hasChildren(current)) {
+                Node *child = createNode(node, j, current, recursiveExpanding, depth);
+                node->children.insert(j, child);
+                counts[j] += child->total;
+                node->total += child->total;
+            }
+        }
+    }
+    node->build();
+    return node;
+}
+
+/*
+  Lays out the children of the view \a item, or all the items if \a item is -1.
+*/
+void QTreeViewLazyLayout::layout(int item, bool recursiveExpanding, int depth)
+{
+    building = true;
+    if (item < 0) {
+        delete root;
+        root = createNode(0, -1, d->root, recursiveExpanding, depth);
+    } else {
+        int row;
+        Node *node = locate(item, &row);
+        if (!node->children.contains(row)) {
+            const QModelIndex index = d->model->index(row, 0, node->index);
+            Node *child = createNode(node, row, index, recursiveExpanding, depth);
+            if (child->rowCount() > 0) {
+                node->children.insert(row, child);
+                node->add(row, child->total);
+                propagate(node, child->total);
+            } else {
+                delete child;
+            }
+        }
+    }
+    building = false;
+    invalidate();
+}
+
+void QTreeViewLazyLayout::collapse(int item)
+{
+    int row;
+    Node *node = locate(item, &row);
+    if (Node *child = node->children.take(row)) {
+        node->add(row, -child->total);
+        propagate(node, -child->total);
+        delete child;
+        invalidate();
+    }
+}
+
+int QTreeViewLazyLayout::viewIndex(const QModelIndex &index) const
+{
+    if (!root || !index.isValid())
+        return -1;
+
+    QVarLengthArray<int, 16> rows;
+    QModelIndex current = index;
+    while (current.isValid() && current != root->index) {
+        rows.append(current.row());
+        current = current.parent();
+    }
+    if (rows.isEmpty() || current != root->index)
+        return -1;
+
+    const Node *node = root;
+    int item = -1;
+    for (int i = rows.count() - 1; i >= 0; --i) {
+        const int row = rows.at(i);
+        if (row >= node->rowCount() || node->weight(row) == 0)
+            return -1;
+        item += 1 + node->prefix(row);
+        if (i == 0)
+            break;
+        node = node->children.value(row);
+        if (!node)
+            return -1;
+    }
+    return item;
+}
+
+/*
+  Updates the layout after the rows \a start to \a end have been inserted in \a parent.
+  Returns \c false if the layout could not be updated and has to be redone.
+*/
+bool QTreeViewLazyLayout::insertRows(const QModelIndex &parent, int start, int end)
+{
+    if (!root || building)
+        return false;
+
+    if (Node *node = findNode(parent)) {
+        const int count = end - start + 1;
+        if (start > node->rowCount())
+            return false;
+        node->unbuild();
+        node->counts.insert(start, count, 1);
+        node->build();
+        QHash<int, Node *> children;
+        for (QHash<int, Node *>::const_iterator it = node->children.constBegin(); it != node->children.constEnd(); ++it) {
+            Node *child = it.value();
+            if (child->row >= start)
+                child->row += count;
+            children.insert(child->row, child);
+        }
+        node->children.swap(children);
+        propagate(node, count);
+    } else {
+        // the parent may have been expanded while it had no children
+        Node *parentNode;
+        int row;
+        if (findRow(parent, &parentNode, &row) && d->isIndexExpanded(parent)) {
+            building = true;
+            Node *child = createNode(parentNode, row, parent, false, -1);
+            building = false;
+            parentNode->children.insert(row, child);
+            parentNode->add(row, child->total);
+            propagate(parentNode, child->total);
+        }
+    }
+    invalidate();
+    return true;
+}
+
+/*
+  Updates the layout before the rows \a start to \a end are removed from \a parent.
+  Returns \c false if the layout could not be updated and has to be redone.
+*/
+bool QTreeViewLazyLayout::removeRows(const QModelIndex &parent, int start, int end)
+{
+    if (!root || building)
+        return false;
+
+    if (Node *node = findNode(parent)) {
+        const int count = end - start + 1;
+        if (end >= node->rowCount())
+            return false;
+        const int removed = node->prefix(end + 1) - node->prefix(start);
+        node->unbuild();
+        node->counts.remove(start, count);
+        node->build();
+        QHash<int, Node *> children;
+        for (QHash<int, Node *>::const_iterator it = node->children.constBegin(); it != node->children.constEnd(); ++it) {
+            Node *child = it.value();
+            if (child->row > end) {
+                child->row -= count;
+            } else if (child->row >= start) {
+                delete child;
+                continue;
+            }
+            children.insert(child->row, child);
+        }
+        node->children.swap(children);
+        propagate(node, -removed);
+    }
+    invalidate();
+    return true;
+}
+
+// returns the node and the row containing the view \a item
+QTreeViewLazyLayout::Node *QTreeViewLazyLayout::locate(int item, int *row) const
+{
+    Node *node = root;
+    forever {
+        int offset;
+        const int r = node->find(item, &offset);
+        if (offset == 0) {
+            *row = r;
+            return node;
+        }
+        node = node->children.value(r);
+        Q_ASSERT(node);
+        item = offset - 1;
+    }
+}
+
+// finds the node and the row of the visible \a index
+bool QTreeViewLazyLayout::findRow(const QModelIndex &index, Node **node, int *row) const
+{
+    const QModelIndex parent = index.parent();
+    Node *parentNode = (parent == root->index ? root : findNode(parent));
+    if (!parentNode || index.row() >= parentNode->rowCount() || parentNode->weight(index.row()) == 0)
+        return false;
+    *node = parentNode;
+    *row = index.row();
+    return true;
+}
+
+// finds the node of the expanded and visible \a index
+QTreeViewLazyLayout::Node *QTreeViewLazyLayout::findNode(const QModelIndex &index) const
+{
+    if (index == root->index)
+        return root;
+    if (!index.isValid())
+        return 0;
+    Node *parentNode;
+    int row;
+    if (!findRow(index, &parentNode, &row))
+        return 0;
+    return parentNode->children.value(row);
+}
+
+// adds \a delta view items to \a node and all its ancestors
+void QTreeViewLazyLayout::propagate(Node *node, int delta)
+{
+    node->total += delta;
+    for (; node->parent; node = node->parent) {
+        node->parent->add(node->row, delta);
+        node->parent->total += delta;
+    }
+}
+
 /*!
   \reimp
  */
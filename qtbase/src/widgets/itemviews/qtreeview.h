@@ -60,6 +60,7 @@ class Q_WIDGETS_EXPORT QTreeView : public QAbstractItemView
     Q_PROPERTY(bool wordWrap READ wordWrap WRITE setWordWrap)
     Q_PROPERTY(bool headerHidden READ isHeaderHidden WRITE setHeaderHidden)
     Q_PROPERTY(bool expandsOnDoubleClick READ expandsOnDoubleClick WRITE setExpandsOnDoubleClick)
+    Q_PROPERTY(bool lazyLayout READ lazyLayout WRITE setLazyLayout)
 
 public:
     explicit QTreeView(QWidget *parent = Q_NULLPTR);
@@ -85,6 +86,9 @@ public:
     bool uniformRowHeights() const;
     void setUniformRowHeights(bool uniform);
 
+    bool lazyLayout() const;
+    void setLazyLayout(bool enable);
+
     bool itemsExpandable() const;
     void setItemsExpandable(bool enable);
 
@@ -48,6 +48,7 @@
 #include "private/qabstractitemview_p.h"
 #include <QtCore/qvariantanimation.h>
 #include <QtCore/qabstractitemmodel.h>
+#include <QtCore/qhash.h>
 
 #ifndef QT_NO_TREEVIEW
 
@@ -70,6 +71,126 @@ struct QTreeViewItem
 
 Q_DECLARE_TYPEINFO(QTreeViewItem, Q_MOVABLE_TYPE);
 
+class QTreeViewPrivate;
+
+/*
+  Lazy replacement for the flat list of view items.
+
+  Instead of one QTreeViewItem per visible row, the lazy layout keeps one
+  node per expanded model index. Each node stores a Fenwick tree over the
+  number of view items contributed by each of its rows (the row itself plus
+  the visible descendants of the row if it is expanded, or 0 if the row is
+  hidden). Mapping a view item to a model index, a model index to a view
+  item, and expanding or collapsing an item are O(depth * log(rows)).
+
+  QTreeViewItems are only created on demand for the rows that are actually
+  accessed, and are kept in a small ring cache: a reference returned by
+  item() stays valid until cacheSize other items have been materialized
+  or the layout changes.
+*/
+class Q_AUTOTEST_EXPORT QTreeViewLazyLayout
+{
+public:
+    struct Node
+    {
+        Node(Node *parentNode, int parentRow)
+            : parent(parentNode), row(parentRow), level(parentNode ? parentNode->level + 1 : -1),
+              total(0) {}
+        ~Node() { qDeleteAll(children); }
+
+        inline int rowCount() const { return counts.size(); }
+        int prefix(int row) const; // number of view items in the rows before row
+        inline int weight(int row) const { return prefix(row + 1) - prefix(row); }
+        void add(int row, int delta);
+        int find(int item, int *offset) const;
+        void build();
+        void unbuild();
+
+        QPersistentModelIndex index; // the root index for the root node
+        Node *parent;
+        int row; // row in the parent node
+        int level; // level of the node index, the rows have level + 1
+        int total; // number of view items below this node
+        QVector<int> counts;
+        QHash<int, Node *> children; // expanded rows
+    };
+
+    enum { CacheSize = 512 };
+
+    explicit QTreeViewLazyLayout(QTreeViewPrivate *priv);
+    ~QTreeViewLazyLayout();
+
+    inline int count() const { return root ? root->total : 0; }
+    QTreeViewItem &item(int i) const;
+    void setExpanded(int i, bool expanded);
+    void setSpanning(int i, bool spanning);
+    void setHasChildren(int i, bool hasChildren);
+
+    void clear();
+    void invalidate() const;
+    void layout(int item, bool recursiveExpanding = false, int depth = -1);
+    void collapse(int item);
+    int viewIndex(const QModelIndex &index) const;
+    bool insertRows(const QModelIndex &parent, int start, int end);
+    bool removeRows(const QModelIndex &parent, int start, int end);
+
+private:
+    Node *createNode(Node *parent, int row, const QModelIndex &index, bool recursiveExpanding, int depth);
+    Node *locate(int item, int *row) const;
+    bool findRow(const QModelIndex &index, Node **node, int *row) const;
+    Node *findNode(const QModelIndex &index) const;
+    void propagate(Node *node, int delta);
+
+    QTreeViewPrivate *d;
+    Node *root;
+    bool building;
+    mutable QVector<QTreeViewItem> cache;
+    mutable QVector<int> cachedItems;
+    mutable QHash<int, int> cacheSlots;
+    mutable int nextSlot;
+};
+
+/*
+  The view items of the tree, either as a flat vector of all visible rows or,
+  when the lazy layout is used, backed by a QTreeViewLazyLayout. The
+  structural operations (resize(), insert(), remove(), data()) and
+  operator[] are only available for the flat vector. The lazy layout only
+  hands out cached copies of its items, so single items are changed with the
+  setters, which also update the state the lazy items are created from.
+*/
+class QTreeViewItems
+{
+public:
+    QTreeViewItems() : lazy(0) {}
+
+    inline int count() const { return lazy ? lazy->count() : items.count(); }
+    inline int size() const { return count(); }
+    inline bool isEmpty() const { return count() == 0; }
+    inline const QTreeViewItem &at(int i) const { return lazy ? lazy->item(i) : items.at(i); }
+    inline QTreeViewItem &operator[](int i) { Q_ASSERT(!lazy); return items[i]; }
+    inline const QTreeViewItem &first() const { return at(0); }
+    inline const QTreeViewItem &last() const { return at(count() - 1); }
+    inline void clear() { items.clear(); if (lazy) lazy->clear(); }
+
+    inline void setExpanded(int i, bool expanded)
+    { if (lazy) lazy->setExpanded(i, expanded); else items[i].expanded = expanded; }
+    inline void setSpanning(int i, bool spanning)
+    { if (lazy) lazy->setSpanning(i, spanning); else items[i].spanning = spanning; }
+    inline void setHasChildren(int i, bool hasChildren)
+    { if (lazy) lazy->setHasChildren(i, hasChildren); else items[i].hasChildren = hasChildren; }
+    // the lazy layout requires uniform row heights, which are not stored per item
+    inline void setHeight(int i, int height)
+    { if (!lazy) items[i].height = height; }
+
+    inline void resize(int size) { Q_ASSERT(!lazy); items.resize(size); }
+    inline void insert(int i, int n, const QTreeViewItem &t) { Q_ASSERT(!lazy); items.insert(i, n, t); }
+    inline void remove(int i, int n) { Q_ASSERT(!lazy); items.remove(i, n); }
+    inline QTreeViewItem *data() { Q_ASSERT(!lazy); return items.data(); }
+
+    QVector<QTreeViewItem> items;
+    QTreeViewLazyLayout *lazy;
+};
+
 class Q_WIDGETS_EXPORT QTreeViewPrivate : public QAbstractItemViewPrivate
 {
     Q_DECLARE_PUBLIC(QTreeView)
@@ -84,9 +205,9 @@ public:
           allColumnsShowFocus(false), customIndent(false), current(0), spanning(false),
           animationsEnabled(false), columnResizeTimerID(0),
           autoExpandDelay(-1), hoverBranch(-1), geometryRecursionBlock(false), hasRemovedItems(false),
-          treePosition(0) {}
+          treePosition(0), lazyLayout(false), lazyItems(0) {}
 
-    ~QTreeViewPrivate() {}
+    ~QTreeViewPrivate() { delete lazyItems; }
     void initialize();
     int logicalIndexForTree() const;
     inline bool isTreePosition(int logicalIndex) const
@@ -174,7 +295,7 @@ public:
     QHeaderView *header;
     int indent;
 
-    mutable QVector<QTreeViewItem> viewItems;
+    mutable QTreeViewItems viewItems;
     mutable int lastViewedItem;
     int defaultItemHeight; // this is just a number; contentsHeight() / numItems
     bool uniformRowHeights; // used when all rows have the same height
@@ -260,6 +381,12 @@ public:
 
     // tree position
     int treePosition;
+
+    // used for the lazy layout of huge trees
+    bool lazyLayout;
+    QTreeViewLazyLayout *lazyItems;
+
+    inline bool useLazyLayout() const { return lazyLayout && uniformRowHeights; }
 };
 
 QT_END_NAMESPACE
@@ -1632,6 +1632,7 @@ QWidget::~QWidget()
 
     if (QWidgetBackingStore *bs = d->maybeBackingStore()) {
         bs->removeDirtyWidget(this);
+        bs->removeStatistics(this);
         if (testAttribute(Qt::WA_StaticContents))
             bs->removeStaticWidget(this);
     }
@@ -5613,8 +5614,16 @@ void QWidgetPrivate::drawWidget(QPaintDevice *pdev, const QRegion &rgn, const QP
 #endif // QT_NO_OPENGL
 
             if (!skipPaintEvent) {
+                QElapsedTimer paintTimer;
+                const bool recordPaint = backingStore && backingStore->collectingStatistics;
+                if (recordPaint)
+                    paintTimer.start();
+
                 //actually send the paint event
                 sendPaintEvent(toBePainted);
+
+                if (recordPaint)
+                    backingStore->recordPaint(q, toBePainted, paintTimer.nsecsElapsed(), flags & DrawConcurrently);
             }
 
             // Native widgets need to be marked dirty on screen so painting will be done in correct context
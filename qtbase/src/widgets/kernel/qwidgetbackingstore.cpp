@@ -38,10 +38,14 @@
 
 #include <QtCore/qglobal.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtGui/qevent.h>
 #include <QtWidgets/qapplication.h>
 #include <QtGui/qpaintengine.h>
+#include <QtGui/qpainter.h>
 #include <QtWidgets/qgraphicsproxywidget.h>
 
 #include <private/qwidget_p.h>
@@ -61,6 +65,12 @@ QT_BEGIN_NAMESPACE
 
 extern QRegion qt_dirtyRegion(QWidget *);
 
+Q_LOGGING_CATEGORY(lcWidgetPainting, "qt.widgets.painting")
+
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_PICTURE)
+Q_GLOBAL_STATIC(QThreadPool, qt_widgetPaintThreadPool)
+#endif
+
 #ifndef QT_NO_OPENGL
 Q_GLOBAL_STATIC(QPlatformTextureList, qt_dummy_platformTextureList)
 #endif
@@ -794,7 +804,9 @@ QWidgetBackingStore::QWidgetBackingStore(QWidget *topLevel)
       fullUpdatePending(0),
       updateRequestSent(0),
       textureListWatcher(0),
-      perfFrames(0)
+      perfFrames(0),
+      statisticsEnabled(0),
+      collectingStatistics(0)
 {
     store = tlw->backingStore();
     Q_ASSERT(store);
@@ -813,6 +825,33 @@ QWidgetBackingStore::~QWidgetBackingStore()
     delete dirtyOnScreenWidgets;
 }
 
+static qint64 qt_regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+    const QVector<QRect> rects = region.rects();
+    for (int i = 0; i < rects.size(); ++i)
+        area += qint64(rects.at(i).width()) * rects.at(i).height();
+    return area;
+}
+
+/*!
+    Records that the paint event of \a widget painted \a region in
+    \a paintTime nanoseconds. Statistics are collected while
+    isStatisticsEnabled() is \c true, or while debug output is enabled for
+    the \c qt.widgets.painting logging category.
+*/
+void QWidgetBackingStore::recordPaint(QWidget *widget, const QRegion &region, qint64 paintTime,
+                                      bool concurrent)
+{
+    QWidgetPaintStatistics &widgetStats = stats.widgets[widget];
+    ++widgetStats.paintEvents;
+    widgetStats.paintTime += paintTime;
+    widgetStats.paintedArea += qt_regionArea(region);
+    ++stats.paintEvents;
+    if (concurrent)
+        ++stats.concurrentPaintEvents;
+}
+
 //parent's coordinates; move whole rect; update parent and widget
 //assume the screen blt has already been done, so we don't need to refresh that part
 void QWidgetPrivate::moveRect(const QRect &rect, int dx, int dy)
@@ -1179,6 +1218,122 @@ void QWidgetBackingStore::sync()
         doSync();
 }
 
+/*
+    Returns \c true if the painting of \a widget and its children may be
+    rasterized on a thread other than the GUI thread, into a backing store
+    image. Style sheets, styled backgrounds and palettes with texture brushes
+    may draw pixmaps, which must stay on the GUI thread.
+*/
+static bool qt_canPaintConcurrently(QWidget *widget)
+{
+    if (!widget->testAttribute(Qt::WA_ConcurrentPaintEvent) || widget->internalWinId()
+        || widget->testAttribute(Qt::WA_StyleSheet) || widget->testAttribute(Qt::WA_StyledBackground)) {
+        return false;
+    }
+    QWidgetPrivate *wd = qt_widget_private(widget);
+    if (wd->textureChildSeen)
+        return false;
+#ifndef QT_NO_GRAPHICSEFFECT
+    if (wd->graphicsEffect)
+        return false;
+#endif
+    const QPalette &palette = widget->palette();
+    for (int role = 0; role < QPalette::NColorRoles; ++role) {
+        if (palette.brush(QPalette::ColorRole(role)).style() == Qt::TexturePattern)
+            return false;
+    }
+    for (int i = 0; i < wd->children.size(); ++i) {
+        QWidget *child = qobject_cast<QWidget *>(wd->children.at(i));
+        if (child && !child->isWindow() && !child->isHidden() && !qt_canPaintConcurrently(child))
+            return false;
+    }
+    return true;
+}
+
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_PICTURE)
+/*
+    Replays a share of the recorded paint jobs into its own QImage that
+    shares the pixels of the backing store image, so that each thread gets
+    its own paint engine. The jobs paint disjoint regions.
+*/
+class QWidgetPaintTask : public QRunnable
+{
+public:
+    QWidgetPaintTask(const QImage *target, QSemaphore *done)
+        : bits(const_cast<uchar *>(target->constBits())),
+          size(target->size()), bytesPerLine(target->bytesPerLine()), format(target->format()),
+          devicePixelRatio(target->devicePixelRatio()), done(done)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QImage image(bits, size.width(), size.height(), bytesPerLine, format);
+        image.setDevicePixelRatio(devicePixelRatio);
+        QPainter painter(&image);
+        for (int i = 0; i < jobs.size(); ++i) {
+            const QWidgetBackingStore::PaintJob &job = *jobs.at(i);
+            painter.setClipRegion(job.region.translated(job.offset));
+            painter.drawPicture(0, 0, job.picture);
+        }
+        painter.end();
+        if (done)
+            done->release();
+    }
+
+    QVector<const QWidgetBackingStore::PaintJob *> jobs;
+
+private:
+    uchar *bits;
+    QSize size;
+    int bytesPerLine;
+    QImage::Format format;
+    qreal devicePixelRatio;
+    QSemaphore *done;
+};
+#endif // !QT_NO_THREAD && !QT_NO_PICTURE
+
+/*
+    Paints \a jobs and returns when all of them have been painted. The paint
+    events are sent on the GUI thread as usual, but are recorded into a
+    QPicture for each job; the pictures are then rasterized into the backing
+    store on the GUI thread and the paint threads at the same time.
+*/
+void QWidgetBackingStore::paintConcurrently(QVector<PaintJob> &jobs)
+{
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_PICTURE)
+    for (int i = 0; i < jobs.size(); ++i) {
+        PaintJob &job = jobs[i];
+        qt_widget_private(job.widget)->drawWidget(&job.picture, job.region, job.offset, job.flags, 0, this);
+    }
+
+    QImage *target = static_cast<QImage *>(store->paintDevice());
+    target->bits(); // detach on the GUI thread
+
+    QThreadPool *pool = qt_widgetPaintThreadPool();
+    const int taskCount = qMin(jobs.size(), qMax(1, pool->maxThreadCount() + 1));
+    QSemaphore done;
+    QVector<QWidgetPaintTask *> tasks;
+    tasks.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        tasks << new QWidgetPaintTask(target, i ? &done : 0);
+    for (int i = 0; i < jobs.size(); ++i)
+        tasks.at(i % taskCount)->jobs << &jobs.at(i);
+
+    for (int i = 1; i < taskCount; ++i)
+        pool->start(tasks.at(i));
+    tasks.at(0)->run();
+    delete tasks.at(0);
+    done.acquire(taskCount - 1);
+#else
+    for (int i = 0; i < jobs.size(); ++i) {
+        const PaintJob &job = jobs.at(i);
+        qt_widget_private(job.widget)->drawWidget(store->paintDevice(), job.region, job.offset,
+                                         job.flags & ~QWidgetPrivate::DrawConcurrently, 0, this);
+    }
+#endif
+}
+
 void QWidgetBackingStore::doSync()
 {
     const bool updatesDisabled = !tlw->updatesEnabled();
@@ -1373,6 +1528,22 @@ void QWidgetBackingStore::doSync()
     dirty = QRegion();
     updateRequestSent = false;
 
+    QElapsedTimer syncTimer;
+    collectingStatistics = statisticsEnabled || lcWidgetPainting().isDebugEnabled();
+    if (collectingStatistics)
+        syncTimer.start();
+
+    // Opaque widgets that opted in with Qt::WA_ConcurrentPaintEvent are
+    // painted on several threads at once when painting into an image.
+    bool canPaintConcurrently = opaqueNonOverlappedWidgets.size() > 1
+        && store->paintDevice()->devType() == QInternal::Image;
+#ifndef QT_NO_PAINT_DEBUG
+    static const bool flushPaintDebugging = qEnvironmentVariableIsSet("QT_FLUSH_PAINT")
+        || qEnvironmentVariableIsSet("QT_FLUSH_PAINT_EVENT");
+    canPaintConcurrently = canPaintConcurrently && !flushPaintDebugging;
+#endif
+    QVector<PaintJob> concurrentJobs;
+
     // Paint opaque non overlapped widgets.
     for (int i = 0; i < opaqueNonOverlappedWidgets.size(); ++i) {
         QWidget *w = opaqueNonOverlappedWidgets[i];
@@ -1391,8 +1562,19 @@ void QWidgetBackingStore::doSync()
         QPoint offset(tlwOffset);
         if (w != tlw)
             offset += w->mapTo(tlw, QPoint());
+        if (canPaintConcurrently && w != tlw && qt_canPaintConcurrently(w)) {
+            PaintJob job;
+            job.widget = w;
+            job.region = toBePainted;
+            job.offset = offset;
+            job.flags = flags | QWidgetPrivate::DrawConcurrently;
+            concurrentJobs.append(job);
+            continue;
+        }
         wd->drawWidget(store->paintDevice(), toBePainted, offset, flags, 0, this);
     }
+    if (!concurrentJobs.isEmpty())
+        paintConcurrently(concurrentJobs);
 
     // Paint the rest with composition.
     if (repaintAllWidgets || !dirtyCopy.isEmpty()) {
@@ -1401,6 +1583,19 @@ void QWidgetBackingStore::doSync()
     }
 
     endPaint(toClean, store, &beginPaintInfo);
+
+    if (collectingStatistics) {
+        const qint64 syncTime = syncTimer.nsecsElapsed();
+        const qint64 dirtyArea = qt_regionArea(toClean);
+        ++stats.syncs;
+        stats.syncTime += syncTime;
+        stats.dirtyArea += dirtyArea;
+        qCDebug(lcWidgetPainting) << "painted" << tlw << "dirty area" << dirtyArea
+                                  << "widgets" << opaqueNonOverlappedWidgets.size()
+                                  << "concurrently" << concurrentJobs.size()
+                                  << "in" << syncTime / 1000 << "us";
+        collectingStatistics = false;
+    }
 }
 
 /*!
@@ -46,9 +46,12 @@
 //
 
 #include <QDebug>
+#include <QtCore/qhash.h>
+#include <QtCore/qloggingcategory.h>
 #include <QtWidgets/qwidget.h>
 #include <private/qwidget_p.h>
 #include <QtGui/qbackingstore.h>
+#include <QtGui/qpicture.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -56,6 +59,28 @@ class QPlatformTextureList;
 class QPlatformTextureListWatcher;
 class QWidgetBackingStore;
 
+Q_DECLARE_LOGGING_CATEGORY(lcWidgetPainting)
+
+struct QWidgetPaintStatistics
+{
+    inline QWidgetPaintStatistics() : paintEvents(0), paintTime(0), paintedArea(0) {}
+    int paintEvents;
+    qint64 paintTime; // nanoseconds spent in paint events
+    qint64 paintedArea; // pixels
+};
+
+struct QWidgetBackingStoreStatistics
+{
+    inline QWidgetBackingStoreStatistics()
+        : syncs(0), syncTime(0), dirtyArea(0), paintEvents(0), concurrentPaintEvents(0) {}
+    int syncs;
+    qint64 syncTime; // nanoseconds
+    qint64 dirtyArea; // pixels repainted in the backing store
+    int paintEvents;
+    int concurrentPaintEvents; // paint events rasterized on worker threads
+    QHash<const QWidget *, QWidgetPaintStatistics> widgets;
+};
+
 struct BeginPaintInfo {
     inline BeginPaintInfo() : wasFlushed(0), nothingToPaint(0), backingStoreRecreated(0) {}
     uint wasFlushed : 1;
@@ -119,6 +144,12 @@ public:
     void markDirty(const QRect &rect, QWidget *widget, UpdateTime updateTime = UpdateLater,
                    BufferState bufferState = BufferValid);
 
+    inline bool isStatisticsEnabled() const { return statisticsEnabled; }
+    inline void setStatisticsEnabled(bool enabled) { statisticsEnabled = enabled; }
+    inline QWidgetBackingStoreStatistics statistics() const { return stats; }
+    inline void resetStatistics() { stats = QWidgetBackingStoreStatistics(); }
+    inline void removeStatistics(const QWidget *widget) { stats.widgets.remove(widget); }
+
 private:
     QWidget *tlw;
     QRegion dirtyOnScreen; // needsFlush
@@ -138,6 +169,10 @@ private:
     QElapsedTimer perfTime;
     int perfFrames;
 
+    uint statisticsEnabled : 1;
+    uint collectingStatistics : 1;
+    QWidgetBackingStoreStatistics stats;
+
     void sendUpdateRequest(QWidget *widget, UpdateTime updateTime);
 
     static bool flushPaint(QWidget *widget, const QRegion &rgn);
@@ -147,7 +182,19 @@ private:
                          QPlatformTextureList *widgetTextures,
                          QWidgetBackingStore *widgetBackingStore);
 
+    struct PaintJob {
+        QWidget *widget;
+        QRegion region;
+        QPoint offset;
+        int flags;
+#ifndef QT_NO_PICTURE
+        QPicture picture;
+#endif
+    };
+
     void doSync();
+    void paintConcurrently(QVector<PaintJob> &jobs);
+    void recordPaint(QWidget *widget, const QRegion &region, qint64 paintTime, bool concurrent);
     bool bltRect(const QRect &rect, int dx, int dy, QWidget *widget);
     void releaseBuffer();
 
@@ -299,6 +346,7 @@ private:
     }
 
     friend QRegion qt_dirtyRegion(QWidget *);
+    friend class QWidgetPaintTask;
     friend class QWidgetPrivate;
     friend class QWidget;
     friend class QBackingStore;
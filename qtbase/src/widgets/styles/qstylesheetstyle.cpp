@@ -1517,6 +1517,44 @@ private:
     mutable QHash<const QObject *, QHash<QString, QString> > m_attributeCache;
 };
 
+/*
+  Returns a key that is equal for all objects that the selectors of
+  \a styleSheets cannot tell apart: objects of the same class, with the
+  same object name and the same values for the attributes that are tested,
+  and, if any selector looks at ancestors, with ancestors that are equal in
+  the same way. Such objects get the same style rules.
+*/
+static QString styleRulesKey(const QStyleSheetStyleSelector &selector, const QObject *obj)
+{
+    QStringList attributeNames;
+    bool hasRelations = false;
+    for (int i = 0; i < selector.styleSheets.count(); ++i) {
+        const StyleSheet &styleSheet = selector.styleSheets.at(i);
+        for (int j = 0; j < styleSheet.attributeNames.count(); ++j) {
+            if (!attributeNames.contains(styleSheet.attributeNames.at(j)))
+                attributeNames += styleSheet.attributeNames.at(j);
+        }
+        hasRelations = hasRelations || styleSheet.hasRelations;
+    }
+
+    QString key = QString::number(selector.styleSheets.count());
+    for (const QObject *o = obj; o; o = hasRelations ? parentObject(o) : 0) {
+        StyleSelector::NodePtr n;
+        n.ptr = const_cast<QObject *>(o);
+        key += QLatin1Char('\x1');
+        key += QString::number(quintptr(o->metaObject()), 16);
+        key += QLatin1Char('\x2');
+        key += o->objectName();
+        for (int i = 0; i < attributeNames.count(); ++i) {
+            const QString value = selector.attribute(n, attributeNames.at(i));
+            // a null value never matches, an empty one may
+            key += value.isNull() ? QLatin1Char('\x3') : QLatin1Char('\x2');
+            key += value;
+        }
+    }
+    return key;
+}
+
 QVector<QCss::StyleRule> QStyleSheetStyle::styleRules(const QObject *obj) const
 {
     QHash<const QObject *, QVector<StyleRule> >::const_iterator cacheIt = styleSheetCaches->styleRulesCache.constFind(obj);
@@ -1587,10 +1625,25 @@ QVector<QCss::StyleRule> QStyleSheetStyle::styleRules(const QObject *obj) const
 
     styleSelector.styleSheets += objectSs;
 
+    // Objects that are only styled by the default and the application style
+    // sheets share their rules with all objects that look the same to them.
+    QString sharedKey;
+    if (objectSs.isEmpty()) {
+        sharedKey = styleRulesKey(styleSelector, obj);
+        QHash<QString, QVector<StyleRule> > &sharedRules = styleSheetCaches->sharedStyleRulesCache[baseStyle()];
+        QHash<QString, QVector<StyleRule> >::const_iterator sharedIt = sharedRules.constFind(sharedKey);
+        if (sharedIt != sharedRules.constEnd()) {
+            styleSheetCaches->styleRulesCache.insert(obj, sharedIt.value());
+            return sharedIt.value();
+        }
+    }
+
     StyleSelector::NodePtr n;
     n.ptr = const_cast<QObject *>(obj);
     QVector<QCss::StyleRule> rules = styleSelector.styleRulesForNode(n);
     styleSheetCaches->styleRulesCache.insert(obj, rules);
+    if (objectSs.isEmpty())
+        styleSheetCaches->sharedStyleRulesCache[baseStyle()].insert(sharedKey, rules);
     return rules;
 }
 
@@ -2667,6 +2720,7 @@ void QStyleSheetStyleCaches::objectDestroyed(QObject *o)
 void QStyleSheetStyleCaches::styleDestroyed(QObject *o)
 {
     styleSheetCache.remove(o);
+    sharedStyleRulesCache.remove(o);
 }
 
 /*!
@@ -2799,6 +2853,7 @@ void QStyleSheetStyle::repolish(QApplication *app)
     const QList<const QObject*> allObjects = styleSheetCaches->styleRulesCache.keys();
     styleSheetCaches->styleSheetCache.remove(qApp);
     styleSheetCaches->styleRulesCache.clear();
+    styleSheetCaches->sharedStyleRulesCache.clear();
     styleSheetCaches->hasStyleRuleCache.clear();
     styleSheetCaches->renderRulesCache.clear();
     updateObjects(allObjects);
@@ -2838,6 +2893,7 @@ void QStyleSheetStyle::unpolish(QApplication *app)
     baseStyle()->unpolish(app);
     RECURSION_GUARD(return)
     styleSheetCaches->styleRulesCache.clear();
+    styleSheetCaches->sharedStyleRulesCache.clear();
     styleSheetCaches->hasStyleRuleCache.clear();
     styleSheetCaches->renderRulesCache.clear();
     styleSheetCaches->styleSheetCache.remove(qApp);
@@ -175,6 +175,7 @@ public Q_SLOTS:
     void styleDestroyed(QObject *);
 public:
     QHash<const QObject *, QVector<QCss::StyleRule> > styleRulesCache;
+    QHash<const QObject *, QHash<QString, QVector<QCss::StyleRule> > > sharedStyleRulesCache; // per base style
     QHash<const QObject *, QHash<int, bool> > hasStyleRuleCache;
     typedef QHash<int, QHash<quint64, QRenderRule> > QRenderRules;
     QHash<const QObject *, QRenderRules> renderRulesCache;
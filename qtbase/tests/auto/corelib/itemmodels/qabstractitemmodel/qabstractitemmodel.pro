@@ -0,0 +1,5 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qabstractitemmodel
+QT = core testlib
+SOURCES = tst_qabstractitemmodel.cpp
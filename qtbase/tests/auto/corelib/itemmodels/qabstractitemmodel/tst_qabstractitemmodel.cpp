@@ -0,0 +1,632 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <qabstractitemmodel.h>
+
+/*
+   A tree in which every cell has a label that stays with it however the
+   tree changes, so that each persistent index can be checked against the
+   cell it was created for. Children hang off column 0.
+*/
+class TreeModel : public QAbstractItemModel
+{
+public:
+    struct Node
+    {
+        Node(Node *parent, int id) : parent(parent), id(id), columns(0) {}
+        ~Node() { qDeleteAll(children); }
+
+        Node *parent;
+        int id;
+        QVector<int> cells; // one id per column of the parent
+        QList<Node *> children;
+        int columns; // the column count of the children
+    };
+
+    TreeModel() : root(0, 0), nextId(1) { root.columns = 3; }
+
+    // gives the node at path rows children, each with three columns
+    void addChildren(const QVector<int> &path, int rows)
+    {
+        Node *node = &root;
+        for (int i = 0; i < path.size(); ++i)
+            node = node->children.at(path.at(i));
+        node->columns = 3;
+        beginInsertRows(indexAt(path), 0, rows - 1);
+        for (int i = 0; i < rows; ++i)
+            node->children.append(newNode(node));
+        endInsertRows();
+    }
+
+    QModelIndex indexAt(const QVector<int> &path) const
+    {
+        QModelIndex index;
+        for (int i = 0; i < path.size(); ++i)
+            index = this->index(path.at(i), 0, index);
+        return index;
+    }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        if (!hasIndex(row, column, parent))
+            return QModelIndex();
+        return createIndex(row, column, node(parent));
+    }
+
+    QModelIndex parent(const QModelIndex &child) const Q_DECL_OVERRIDE
+    {
+        Node *parentNode = static_cast<Node *>(child.internalPointer());
+        if (!child.isValid() || parentNode == &root)
+            return QModelIndex();
+        return createIndex(parentNode->parent->children.indexOf(parentNode), 0, parentNode->parent);
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        if (parent.column() > 0)
+            return 0;
+        return node(parent)->children.size();
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        if (parent.column() > 0)
+            return 0;
+        return node(parent)->columns;
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE
+    {
+        if (!index.isValid() || role != Qt::DisplayRole)
+            return QVariant();
+        const Node *child = static_cast<Node *>(index.internalPointer())->children.at(index.row());
+        return QString::fromLatin1("%1/%2").arg(child->id).arg(child->cells.at(index.column()));
+    }
+
+    bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) Q_DECL_OVERRIDE
+    {
+        Node *parentNode = node(parent);
+        beginInsertRows(parent, row, row + count - 1);
+        for (int i = 0; i < count; ++i)
+            parentNode->children.insert(row + i, newNode(parentNode));
+        endInsertRows();
+        return true;
+    }
+
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) Q_DECL_OVERRIDE
+    {
+        Node *parentNode = node(parent);
+        beginRemoveRows(parent, row, row + count - 1);
+        for (int i = 0; i < count; ++i)
+            delete parentNode->children.takeAt(row);
+        endRemoveRows();
+        return true;
+    }
+
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) Q_DECL_OVERRIDE
+    {
+        if (!beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1,
+                           destinationParent, destinationChild))
+            return false;
+        Node *source = node(sourceParent);
+        Node *destination = node(destinationParent);
+        QList<Node *> moved;
+        for (int i = 0; i < count; ++i)
+            moved.append(source->children.takeAt(sourceRow));
+        if (source == destination && destinationChild > sourceRow)
+            destinationChild -= count;
+        for (int i = 0; i < count; ++i) {
+            moved.at(i)->parent = destination;
+            destination->children.insert(destinationChild + i, moved.at(i));
+        }
+        endMoveRows();
+        return true;
+    }
+
+    bool insertColumns(int column, int count, const QModelIndex &parent = QModelIndex()) Q_DECL_OVERRIDE
+    {
+        Node *parentNode = node(parent);
+        beginInsertColumns(parent, column, column + count - 1);
+        parentNode->columns += count;
+        foreach (Node *child, parentNode->children) {
+            for (int i = 0; i < count; ++i)
+                child->cells.insert(column + i, nextId++);
+        }
+        endInsertColumns();
+        return true;
+    }
+
+    bool removeColumns(int column, int count, const QModelIndex &parent = QModelIndex()) Q_DECL_OVERRIDE
+    {
+        Node *parentNode = node(parent);
+        beginRemoveColumns(parent, column, column + count - 1);
+        parentNode->columns -= count;
+        foreach (Node *child, parentNode->children)
+            child->cells.remove(column, count);
+        endRemoveColumns();
+        return true;
+    }
+
+    bool moveColumns(const QModelIndex &sourceParent, int sourceColumn, int count,
+                     const QModelIndex &destinationParent, int destinationChild) Q_DECL_OVERRIDE
+    {
+        if (sourceParent != destinationParent
+            || !beginMoveColumns(sourceParent, sourceColumn, sourceColumn + count - 1,
+                                 destinationParent, destinationChild))
+            return false;
+        const int target = destinationChild > sourceColumn ? destinationChild - count : destinationChild;
+        foreach (Node *child, node(sourceParent)->children) {
+            const QVector<int> moved = child->cells.mid(sourceColumn, count);
+            child->cells.remove(sourceColumn, count);
+            for (int i = 0; i < count; ++i)
+                child->cells.insert(target + i, moved.at(i));
+        }
+        endMoveColumns();
+        return true;
+    }
+
+    // reverses the order of the children of parent
+    void reverseRows(const QModelIndex &parent)
+    {
+        const QPersistentModelIndex persistentParent(parent);
+        emit layoutAboutToBeChanged(QList<QPersistentModelIndex>() << persistentParent,
+                                    QAbstractItemModel::VerticalSortHint);
+        Node *parentNode = node(parent);
+        const int rows = parentNode->children.size();
+        QModelIndexList from;
+        QModelIndexList to;
+        foreach (const QModelIndex &index, persistentIndexList()) {
+            if (index.parent() == persistentParent) {
+                from.append(index);
+                to.append(createIndex(rows - 1 - index.row(), index.column(), parentNode));
+            }
+        }
+        for (int i = 0; i < rows / 2; ++i)
+            parentNode->children.swap(i, rows - 1 - i);
+        changePersistentIndexList(from, to);
+        emit layoutChanged(QList<QPersistentModelIndex>() << persistentParent,
+                           QAbstractItemModel::VerticalSortHint);
+    }
+
+    // the labels of all cells, found through the model API
+    QSet<QString> labels(const QModelIndex &parent = QModelIndex()) const
+    {
+        QSet<QString> result;
+        for (int row = 0; row < rowCount(parent); ++row) {
+            for (int column = 0; column < columnCount(parent); ++column)
+                result.insert(index(row, column, parent).data().toString());
+            const QModelIndex child = index(row, 0, parent);
+            if (child.isValid())
+                result += labels(child);
+        }
+        return result;
+    }
+
+private:
+    Node *node(const QModelIndex &index) const
+    {
+        if (!index.isValid())
+            return const_cast<Node *>(&root);
+        return static_cast<Node *>(index.internalPointer())->children.at(index.row());
+    }
+
+    Node *newNode(Node *parent)
+    {
+        Node *child = new Node(parent, nextId++);
+        for (int i = 0; i < parent->columns; ++i)
+            child->cells.append(nextId++);
+        return child;
+    }
+
+    Node root;
+    int nextId;
+};
+
+typedef QVector<int> Path;
+
+class tst_QAbstractItemModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void insertRows_data();
+    void insertRows();
+    void removeRows_data();
+    void removeRows();
+    void removedParent();
+    void insertColumns_data();
+    void insertColumns();
+    void removeColumns_data();
+    void removeColumns();
+    void moveRows_data();
+    void moveRows();
+    void moveColumns_data();
+    void moveColumns();
+    void layoutChanged_data();
+    void layoutChanged();
+
+private:
+    void persistAll(const QModelIndex &parent = QModelIndex());
+    void checkPersistent();
+
+    TreeModel *model;
+    QList<QPersistentModelIndex> persistent;
+    QStringList labels;
+};
+
+/*
+   Six rows at the top level, five children under rows 1 and 4, and four
+   grandchildren under row 2 of row 1; every level has three columns.
+*/
+void tst_QAbstractItemModel::init()
+{
+    model = new TreeModel;
+    model->addChildren(Path(), 6);
+    model->addChildren(Path() << 1, 5);
+    model->addChildren(Path() << 4, 5);
+    model->addChildren(Path() << 1 << 2, 4);
+    persistAll();
+}
+
+void tst_QAbstractItemModel::cleanup()
+{
+    persistent.clear();
+    labels.clear();
+    delete model;
+    model = 0;
+}
+
+void tst_QAbstractItemModel::persistAll(const QModelIndex &parent)
+{
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        for (int column = 0; column < model->columnCount(parent); ++column) {
+            const QModelIndex index = model->index(row, column, parent);
+            persistent.append(index);
+            labels.append(index.data().toString());
+        }
+        const QModelIndex child = model->index(row, 0, parent);
+        if (child.isValid())
+            persistAll(child);
+    }
+}
+
+// every persistent index still points to its cell, or is invalid if the cell is gone
+void tst_QAbstractItemModel::checkPersistent()
+{
+    const QSet<QString> present = model->labels();
+    for (int i = 0; i < persistent.size(); ++i) {
+        const QPersistentModelIndex &index = persistent.at(i);
+        const QString &label = labels.at(i);
+        if (!present.contains(label)) {
+            QVERIFY2(!index.isValid(), qPrintable(label));
+            continue;
+        }
+        QVERIFY2(index.isValid(), qPrintable(label));
+        QCOMPARE(index.data().toString(), label);
+        QVERIFY2(QModelIndex(index) == model->index(index.row(), index.column(), index.parent()),
+                 qPrintable(label));
+    }
+}
+
+void tst_QAbstractItemModel::insertRows_data()
+{
+    QTest::addColumn<Path>("parent");
+    QTest::addColumn<int>("row");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("top front") << Path() << 0 << 2;
+    QTest::newRow("top middle") << Path() << 3 << 1;
+    QTest::newRow("top end") << Path() << 6 << 2;
+    QTest::newRow("child front") << (Path() << 1) << 0 << 3;
+    QTest::newRow("child before parent row") << (Path() << 1) << 2 << 1;
+    QTest::newRow("grandchild middle") << (Path() << 1 << 2) << 2 << 2;
+    QTest::newRow("grandchild end") << (Path() << 1 << 2) << 4 << 1;
+}
+
+void tst_QAbstractItemModel::insertRows()
+{
+    QFETCH(Path, parent);
+    QFETCH(int, row);
+    QFETCH(int, count);
+
+    const QPersistentModelIndex grandparent = model->indexAt(Path() << 1 << 2);
+    QVERIFY(model->insertRows(row, count, model->indexAt(parent)));
+    checkPersistent();
+
+    // the nested level follows its parent row
+    QVERIFY(model->insertRows(0, 1, grandparent));
+    checkPersistent();
+    QVERIFY(model->removeRows(1, 2, grandparent));
+    checkPersistent();
+}
+
+void tst_QAbstractItemModel::removeRows_data()
+{
+    QTest::addColumn<Path>("parent");
+    QTest::addColumn<int>("row");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("top front") << Path() << 0 << 1;
+    QTest::newRow("top with children") << Path() << 1 << 1;
+    QTest::newRow("top range") << Path() << 2 << 3;
+    QTest::newRow("top end") << Path() << 5 << 1;
+    QTest::newRow("child with children") << (Path() << 1) << 1 << 2;
+    QTest::newRow("child after parent row") << (Path() << 1) << 3 << 2;
+    QTest::newRow("grandchild first") << (Path() << 1 << 2) << 0 << 1;
+    QTest::newRow("grandchild last") << (Path() << 1 << 2) << 3 << 1;
+    QTest::newRow("grandchild all") << (Path() << 1 << 2) << 0 << 4;
+}
+
+void tst_QAbstractItemModel::removeRows()
+{
+    QFETCH(Path, parent);
+    QFETCH(int, row);
+    QFETCH(int, count);
+
+    const QPersistentModelIndex other = model->indexAt(Path() << 4);
+    QVERIFY(model->removeRows(row, count, model->indexAt(parent)));
+    checkPersistent();
+
+    if (other.isValid()) {
+        QVERIFY(model->removeRows(0, 1, other));
+        checkPersistent();
+        QVERIFY(model->insertRows(1, 2, other));
+        checkPersistent();
+    }
+}
+
+void tst_QAbstractItemModel::removedParent()
+{
+    QList<QPersistentModelIndex> descendants;
+    const QModelIndex removed = model->indexAt(Path() << 1);
+    for (int i = 0; i < persistent.size(); ++i) {
+        for (QModelIndex index = persistent.at(i).parent(); index.isValid(); index = index.parent()) {
+            if (index == removed)
+                descendants.append(persistent.at(i));
+        }
+    }
+    QCOMPARE(descendants.size(), 5 * 3 + 4 * 3);
+
+    QVERIFY(model->removeRows(1, 1));
+    foreach (const QPersistentModelIndex &index, descendants) {
+        QVERIFY(!index.isValid());
+        QVERIFY(!index.model());
+    }
+    checkPersistent();
+
+    // new rows in the same place are not picked up by the old indexes
+    QVERIFY(model->insertRows(1, 1));
+    model->addChildren(Path() << 1, 5);
+    foreach (const QPersistentModelIndex &index, descendants)
+        QVERIFY(!index.isValid());
+    checkPersistent();
+}
+
+void tst_QAbstractItemModel::insertColumns_data()
+{
+    QTest::addColumn<Path>("parent");
+    QTest::addColumn<int>("column");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("top middle") << Path() << 1 << 1;
+    QTest::newRow("top end") << Path() << 3 << 2;
+    QTest::newRow("child middle") << (Path() << 1) << 2 << 1;
+    QTest::newRow("grandchild front") << (Path() << 1 << 2) << 0 << 2;
+}
+
+void tst_QAbstractItemModel::insertColumns()
+{
+    QFETCH(Path, parent);
+    QFETCH(int, column);
+    QFETCH(int, count);
+
+    const QPersistentModelIndex grandparent = model->indexAt(Path() << 1 << 2);
+    QVERIFY(model->insertColumns(column, count, model->indexAt(parent)));
+    checkPersistent();
+
+    QVERIFY(model->insertRows(1, 1, grandparent));
+    checkPersistent();
+    QVERIFY(model->insertRows(0, 2));
+    checkPersistent();
+}
+
+void tst_QAbstractItemModel::removeColumns_data()
+{
+    QTest::addColumn<Path>("parent");
+    QTest::addColumn<int>("column");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("top middle") << Path() << 1 << 1;
+    QTest::newRow("top end") << Path() << 1 << 2;
+    QTest::newRow("child last") << (Path() << 1) << 2 << 1;
+    QTest::newRow("grandchild first") << (Path() << 1 << 2) << 0 << 1;
+    QTest::newRow("grandchild all") << (Path() << 1 << 2) << 0 << 3;
+}
+
+void tst_QAbstractItemModel::removeColumns()
+{
+    QFETCH(Path, parent);
+    QFETCH(int, column);
+    QFETCH(int, count);
+
+    const QPersistentModelIndex grandparent = model->indexAt(Path() << 1 << 2);
+    QVERIFY(model->removeColumns(column, count, model->indexAt(parent)));
+    checkPersistent();
+
+    QVERIFY(model->removeRows(0, 1, grandparent));
+    checkPersistent();
+    QVERIFY(model->removeRows(0, 1));
+    checkPersistent();
+}
+
+void tst_QAbstractItemModel::moveRows_data()
+{
+    QTest::addColumn<Path>("source");
+    QTest::addColumn<int>("first");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<Path>("destination");
+    QTest::addColumn<int>("child");
+
+    QTest::newRow("forward") << Path() << 0 << 2 << Path() << 4;
+    QTest::newRow("backward") << Path() << 4 << 2 << Path() << 1;
+    QTest::newRow("to the end") << Path() << 0 << 1 << Path() << 6;
+    QTest::newRow("to the front") << Path() << 5 << 1 << Path() << 0;
+    QTest::newRow("rows with children") << Path() << 1 << 4 << Path() << 6;
+    QTest::newRow("nested forward") << (Path() << 1) << 0 << 2 << (Path() << 1) << 5;
+    QTest::newRow("nested backward") << (Path() << 1) << 2 << 3 << (Path() << 1) << 0;
+    QTest::newRow("to another parent") << (Path() << 1) << 1 << 2 << (Path() << 4) << 0;
+    QTest::newRow("to the end of another parent") << (Path() << 4) << 0 << 5 << (Path() << 1) << 5;
+    QTest::newRow("up a level") << (Path() << 1 << 2) << 1 << 2 << Path() << 3;
+    QTest::newRow("down a level") << Path() << 5 << 1 << (Path() << 1 << 2) << 4;
+    QTest::newRow("down before the parent") << Path() << 0 << 1 << (Path() << 4) << 2;
+}
+
+void tst_QAbstractItemModel::moveRows()
+{
+    QFETCH(Path, source);
+    QFETCH(int, first);
+    QFETCH(int, count);
+    QFETCH(Path, destination);
+    QFETCH(int, child);
+
+    const QModelIndex sourceParent = model->indexAt(source);
+    const QPersistentModelIndex destinationParent = model->indexAt(destination);
+    const int last = first + count - 1;
+    const QPersistentModelIndex movedFirst = model->index(first, 0, sourceParent);
+    const QPersistentModelIndex movedLast = model->index(last, 2, sourceParent);
+    const QPersistentModelIndex before = model->index(first - 1, 1, sourceParent);
+    const QPersistentModelIndex after = model->index(last + 1, 0, sourceParent);
+    const QPersistentModelIndex atChild = model->index(child, 0, destinationParent);
+    const QPersistentModelIndex grandparent = model->indexAt(Path() << 1 << 2);
+
+    QVERIFY(model->moveRows(sourceParent, first, count, destinationParent, child));
+    checkPersistent();
+
+    // the rows at the edges of the moved range
+    const bool sameParent = source == destination;
+    const int newFirst = sameParent && child > first ? child - count : child;
+    QCOMPARE(movedFirst.row(), newFirst);
+    QCOMPARE(movedLast.row(), newFirst + count - 1);
+    QCOMPARE(movedLast.column(), 2);
+    QVERIFY(movedFirst.parent() == destinationParent);
+    QVERIFY(movedLast.parent() == destinationParent);
+    if (sameParent) {
+        if (before.isValid())
+            QCOMPARE(before.row(), child <= first - 1 ? first - 1 + count : first - 1);
+        if (after.isValid())
+            QCOMPARE(after.row(), child > last ? first : last + 1);
+    } else {
+        if (before.isValid())
+            QCOMPARE(before.row(), first - 1);
+        if (after.isValid())
+            QCOMPARE(after.row(), first);
+    }
+    if (atChild.isValid() && !(sameParent && child >= first && child <= last + 1))
+        QCOMPARE(atChild.row(), sameParent && child > last ? child - count : child + count);
+
+    if (grandparent.isValid()) {
+        QVERIFY(model->insertRows(0, 1, grandparent));
+        checkPersistent();
+    }
+    QVERIFY(model->removeRows(0, 1));
+    checkPersistent();
+}
+
+void tst_QAbstractItemModel::moveColumns_data()
+{
+    QTest::addColumn<Path>("parent");
+    QTest::addColumn<int>("first");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("child");
+
+    QTest::newRow("forward") << (Path() << 1 << 2) << 0 << 1 << 3;
+    QTest::newRow("backward") << (Path() << 1 << 2) << 1 << 2 << 0;
+    QTest::newRow("top forward") << Path() << 1 << 1 << 3;
+}
+
+void tst_QAbstractItemModel::moveColumns()
+{
+    QFETCH(Path, parent);
+    QFETCH(int, first);
+    QFETCH(int, count);
+    QFETCH(int, child);
+
+    const QModelIndex parentIndex = model->indexAt(parent);
+    const QPersistentModelIndex movedFirst = model->index(2, first, parentIndex);
+    const QPersistentModelIndex movedLast = model->index(2, first + count - 1, parentIndex);
+
+    QVERIFY(model->moveColumns(parentIndex, first, count, parentIndex, child));
+    checkPersistent();
+
+    const int newFirst = child > first ? child - count : child;
+    QCOMPARE(movedFirst.column(), newFirst);
+    QCOMPARE(movedLast.column(), newFirst + count - 1);
+    QCOMPARE(movedFirst.row(), 2);
+}
+
+void tst_QAbstractItemModel::layoutChanged_data()
+{
+    QTest::addColumn<Path>("parent");
+
+    QTest::newRow("top") << Path();
+    QTest::newRow("child") << (Path() << 1);
+    QTest::newRow("grandchild") << (Path() << 1 << 2);
+}
+
+void tst_QAbstractItemModel::layoutChanged()
+{
+    QFETCH(Path, parent);
+
+    const QPersistentModelIndex grandparent = model->indexAt(Path() << 1 << 2);
+    model->reverseRows(model->indexAt(parent));
+    checkPersistent();
+
+    // structural changes after a layout change still find the right indexes
+    QVERIFY(model->insertRows(1, 2, grandparent));
+    checkPersistent();
+    QVERIFY(model->removeRows(0, 1, grandparent.parent()));
+    checkPersistent();
+    QVERIFY(model->moveRows(QModelIndex(), 0, 1, QModelIndex(), 6));
+    checkPersistent();
+    model->reverseRows(grandparent);
+    checkPersistent();
+}
+
+QTEST_MAIN(tst_QAbstractItemModel)
+#include "tst_qabstractitemmodel.moc"
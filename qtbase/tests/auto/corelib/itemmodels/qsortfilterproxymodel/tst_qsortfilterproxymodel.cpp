@@ -149,6 +149,8 @@ private slots:
     void forwardDropApi();
     void canDropMimeData();
     void filterHint();
+    void optimizationFlags_data();
+    void optimizationFlags();
 
 protected:
     void buildHierarchy(const QStringList &data, QAbstractItemModel *model);
@@ -4182,5 +4184,72 @@ void tst_QSortFilterProxyModel::filterHint()
              QAbstractItemModel::NoLayoutChangeHint);
 }
 
+static QStringList proxyContents(const QAbstractItemModel &proxy)
+{
+    QStringList contents;
+    for (int row = 0; row < proxy.rowCount(); ++row)
+        contents << proxy.index(row, 0).data().toString();
+    return contents;
+}
+
+void tst_QSortFilterProxyModel::optimizationFlags_data()
+{
+    QTest::addColumn<int>("flags");
+
+    QTest::newRow("ParallelFiltering") << int(QSortFilterProxyModel::ParallelFiltering);
+    QTest::newRow("CacheSortKeys") << int(QSortFilterProxyModel::CacheSortKeys);
+    QTest::newRow("ParallelFiltering|CacheSortKeys")
+        << int(QSortFilterProxyModel::ParallelFiltering | QSortFilterProxyModel::CacheSortKeys);
+}
+
+void tst_QSortFilterProxyModel::optimizationFlags()
+{
+    // The optimized proxy must end up with the same rows, in the same
+    // order, as a plain proxy on the same source model.
+    QFETCH(int, flags);
+
+    QStringList strings;
+    uint seed = 42;
+    for (int i = 0; i < 5000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        strings << QString::number((seed >> 8) % 100000);
+    }
+    QStringListModel model(strings);
+
+    QSortFilterProxyModel reference;
+    reference.setSourceModel(&model);
+    QSortFilterProxyModel proxy;
+    proxy.setOptimizationFlags(QSortFilterProxyModel::OptimizationFlags(flags));
+    QCOMPARE(int(proxy.optimizationFlags()), flags);
+    proxy.setSourceModel(&model);
+    ModelTest modelTest(&proxy);
+
+    reference.sort(0);
+    proxy.sort(0);
+    QCOMPARE(proxyContents(proxy), proxyContents(reference));
+
+    const QStringList patterns = QStringList() << "1" << "12" << "1" << QString();
+    foreach (const QString &pattern, patterns) {
+        reference.setFilterFixedString(pattern);
+        proxy.setFilterFixedString(pattern);
+        QCOMPARE(proxyContents(proxy), proxyContents(reference));
+    }
+
+    model.insertRows(100, 3000);
+    for (int row = 100; row < 3100; ++row)
+        model.setData(model.index(row), QString::number(row * 7 % 3001));
+    QCOMPARE(proxyContents(proxy), proxyContents(reference));
+
+    reference.sort(0, Qt::DescendingOrder);
+    proxy.sort(0, Qt::DescendingOrder);
+    reference.setFilterRegExp(QStringLiteral("^[2-5]"));
+    proxy.setFilterRegExp(QStringLiteral("^[2-5]"));
+    QCOMPARE(proxyContents(proxy), proxyContents(reference));
+
+    model.removeRows(50, 2500);
+    model.setData(model.index(10), QStringLiteral("99999"));
+    QCOMPARE(proxyContents(proxy), proxyContents(reference));
+}
+
 QTEST_MAIN(tst_QSortFilterProxyModel)
 #include "tst_qsortfilterproxymodel.moc"
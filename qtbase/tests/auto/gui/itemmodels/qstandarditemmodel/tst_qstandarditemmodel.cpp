@@ -37,6 +37,7 @@
 #include <qstandarditemmodel.h>
 #include <QTreeView>
 #include <private/qtreeview_p.h>
+#include <private/qabstractitemmodel_p.h>
 
 class tst_QStandardItemModel : public QObject
 {
@@ -130,6 +131,7 @@ private slots:
 
     void itemRoleNames();
     void getMimeDataWithInvalidModelIndex();
+    void multiData();
 
 private:
     QAbstractItemModel *m_model;
@@ -1680,5 +1682,83 @@ void tst_QStandardItemModel::getMimeDataWithInvalidModelIndex()
     QVERIFY(!data);
 }
 
+class UpperCaseItem : public QStandardItem
+{
+public:
+    explicit UpperCaseItem(const QString &text) : QStandardItem(text) { }
+    QVariant data(int role) const Q_DECL_OVERRIDE
+    {
+        const QVariant value = QStandardItem::data(role);
+        return role == Qt::DisplayRole ? QVariant(value.toString().toUpper()) : value;
+    }
+};
+
+class ToolTipModel : public QStandardItemModel
+{
+    Q_OBJECT
+public:
+    QVariant data(const QModelIndex &index, int role) const Q_DECL_OVERRIDE
+    {
+        if (role == Qt::ToolTipRole)
+            return QStringLiteral("tip");
+        return QStandardItemModel::data(index, role);
+    }
+};
+
+static void compareMultiData(const QAbstractItemModel &model, const QModelIndex &index)
+{
+    static const int roles[] = {
+        Qt::DisplayRole, Qt::EditRole, Qt::ToolTipRole, Qt::FontRole,
+        Qt::CheckStateRole, Qt::BackgroundRole, Qt::UserRole + 1
+    };
+    const int count = int(sizeof(roles) / sizeof(roles[0]));
+    QVariant values[count];
+    QAbstractItemModelPrivate::get(&model)->multiData(index, roles, values, count);
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(values[i], model.data(index, roles[i]));
+}
+
+void tst_QStandardItemModel::multiData()
+{
+    QStandardItemModel model(2, 2);
+    QStandardItem *item = new QStandardItem("text");
+    item->setToolTip("tool tip");
+    item->setCheckState(Qt::Checked);
+    item->setData(42, Qt::UserRole + 1);
+    model.setItem(0, 1, item);
+    model.setItem(1, 0, new UpperCaseItem("upper"));
+    QStandardItem *parent = new QStandardItem("parent");
+    parent->appendRow(new QStandardItem("child"));
+    model.setItem(1, 1, parent);
+
+    compareMultiData(model, model.index(0, 1));
+    compareMultiData(model, model.index(0, 0));
+    compareMultiData(model, model.index(1, 0));
+    compareMultiData(model, parent->child(0)->index());
+    compareMultiData(model, QModelIndex());
+    if (QTest::currentTestFailed())
+        return;
+
+    // items that reimplement data() are asked for every role
+    static const int display = Qt::DisplayRole;
+    QVariant value;
+    QAbstractItemModelPrivate::get(&model)->multiData(model.index(1, 0), &display, &value, 1);
+    QCOMPARE(value.toString(), QString("UPPER"));
+
+    // an index of another model gives no values
+    QStandardItemModel other(1, 1);
+    other.setItem(0, 0, new QStandardItem("other"));
+    QAbstractItemModelPrivate::get(&model)->multiData(other.index(0, 0), &display, &value, 1);
+    QVERIFY(!value.isValid());
+
+    // models that reimplement data() are asked through it
+    ToolTipModel toolTipModel;
+    toolTipModel.appendRow(new QStandardItem("row"));
+    compareMultiData(toolTipModel, toolTipModel.index(0, 0));
+    static const int toolTip = Qt::ToolTipRole;
+    QAbstractItemModelPrivate::get(&toolTipModel)->multiData(toolTipModel.index(0, 0), &toolTip, &value, 1);
+    QCOMPARE(value.toString(), QString("tip"));
+}
+
 QTEST_MAIN(tst_QStandardItemModel)
 #include "tst_qstandarditemmodel.moc"
@@ -0,0 +1,7 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_hpack
+SOURCES  += tst_hpack.cpp
+requires(contains(QT_CONFIG,private_tests))
+
+QT = core network-private testlib
@@ -0,0 +1,553 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+
+#include <QtTest/QtTest>
+#include "private/qhpack_p.h"
+
+// The test vectors are taken from RFC 7541, Appendix C.
+
+Q_DECLARE_METATYPE(QHPackHeaderList)
+
+typedef QList<QByteArray> BlockList;
+typedef QList<QHPackHeaderList> HeaderListList;
+
+class tst_HPack : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void integerRepresentation_data();
+    void integerRepresentation();
+    void integerOverflow();
+    void huffmanCoding_data();
+    void huffmanCoding();
+    void huffmanPadding_data();
+    void huffmanPadding();
+    void literalFields_data();
+    void literalFields();
+    void requestSequence_data();
+    void requestSequence();
+    void responseSequence_data();
+    void responseSequence();
+    void dynamicTableEviction();
+    void tableSizeUpdate();
+    void invalidIndex_data();
+    void invalidIndex();
+    void maxHeaderListSize();
+    void encoderRoundTrip_data();
+    void encoderRoundTrip();
+    void encoderTableSizeChange();
+};
+
+static QHPackHeaderField field(const char *name, const char *value)
+{
+    return qMakePair(QByteArray(name), QByteArray(value));
+}
+
+static QList<QHPackHeaderList> requestHeaders()
+{
+    QList<QHPackHeaderList> requests;
+    QHPackHeaderList headers;
+    headers << field(":method", "GET") << field(":scheme", "http")
+            << field(":path", "/") << field(":authority", "www.example.com");
+    requests << headers;
+    headers << field("cache-control", "no-cache");
+    requests << headers;
+    headers.clear();
+    headers << field(":method", "GET") << field(":scheme", "https")
+            << field(":path", "/index.html") << field(":authority", "www.example.com")
+            << field("custom-key", "custom-value");
+    requests << headers;
+    return requests;
+}
+
+static QList<QHPackHeaderList> responseHeaders()
+{
+    QList<QHPackHeaderList> responses;
+    QHPackHeaderList headers;
+    headers << field(":status", "302") << field("cache-control", "private")
+            << field("date", "Mon, 21 Oct 2013 20:13:21 GMT")
+            << field("location", "https://www.example.com");
+    responses << headers;
+    headers[0] = field(":status", "307");
+    responses << headers;
+    headers.clear();
+    headers << field(":status", "200") << field("cache-control", "private")
+            << field("date", "Mon, 21 Oct 2013 20:13:22 GMT")
+            << field("location", "https://www.example.com")
+            << field("content-encoding", "gzip")
+            << field("set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1");
+    responses << headers;
+    return responses;
+}
+
+void tst_HPack::integerRepresentation_data()
+{
+    QTest::addColumn<uint>("value");
+    QTest::addColumn<int>("prefixBits");
+    QTest::addColumn<QByteArray>("encoded");
+
+    // C.1.1 - C.1.3
+    QTest::newRow("10, 5-bit prefix") << 10u << 5 << QByteArray::fromHex("0a");
+    QTest::newRow("1337, 5-bit prefix") << 1337u << 5 << QByteArray::fromHex("1f9a0a");
+    QTest::newRow("42, 8-bit prefix") << 42u << 8 << QByteArray::fromHex("2a");
+    QTest::newRow("31, 5-bit prefix") << 31u << 5 << QByteArray::fromHex("1f00");
+    QTest::newRow("max, 7-bit prefix") << 0xffffffffu << 7 << QByteArray::fromHex("7f80ffffff0f");
+}
+
+void tst_HPack::integerRepresentation()
+{
+    QFETCH(uint, value);
+    QFETCH(int, prefixBits);
+    QFETCH(QByteArray, encoded);
+
+    QByteArray output;
+    QHPack::encodeInteger(value, prefixBits, 0, &output);
+    QCOMPARE(output.toHex(), encoded.toHex());
+
+    const uchar *data = reinterpret_cast<const uchar *>(encoded.constData());
+    const uchar *end = data + encoded.size();
+    quint32 decoded = 0;
+    QVERIFY(QHPack::decodeInteger(data, end, prefixBits, &decoded));
+    QCOMPARE(decoded, quint32(value));
+    QVERIFY(data == end);
+
+    // the bits above the prefix belong to the representation and are ignored
+    QByteArray flagged = encoded;
+    if (prefixBits < 8) {
+        flagged[0] = char(uchar(flagged.at(0)) | (0xff << prefixBits));
+        data = reinterpret_cast<const uchar *>(flagged.constData());
+        QVERIFY(QHPack::decodeInteger(data, data + flagged.size(), prefixBits, &decoded));
+        QCOMPARE(decoded, quint32(value));
+    }
+
+    // a truncated integer must not decode
+    if (encoded.size() > 1) {
+        data = reinterpret_cast<const uchar *>(encoded.constData());
+        QVERIFY(!QHPack::decodeInteger(data, data + encoded.size() - 1, prefixBits, &decoded));
+    }
+}
+
+void tst_HPack::integerOverflow()
+{
+    quint32 decoded = 0;
+    const QByteArray tooLarge = QByteArray::fromHex("7f80808080807f");
+    const uchar *data = reinterpret_cast<const uchar *>(tooLarge.constData());
+    QVERIFY(!QHPack::decodeInteger(data, data + tooLarge.size(), 7, &decoded));
+
+    const QByteArray justTooLarge = QByteArray::fromHex("7f81ffffff0f");
+    data = reinterpret_cast<const uchar *>(justTooLarge.constData());
+    QVERIFY(!QHPack::decodeInteger(data, data + justTooLarge.size(), 7, &decoded));
+}
+
+void tst_HPack::huffmanCoding_data()
+{
+    QTest::addColumn<QByteArray>("plain");
+    QTest::addColumn<QByteArray>("encoded");
+
+    QTest::newRow("empty") << QByteArray() << QByteArray();
+    QTest::newRow("a") << QByteArray("a") << QByteArray::fromHex("1f");
+    QTest::newRow("www.example.com") << QByteArray("www.example.com")
+                                     << QByteArray::fromHex("f1e3c2e5f23a6ba0ab90f4ff");
+    QTest::newRow("no-cache") << QByteArray("no-cache") << QByteArray::fromHex("a8eb10649cbf");
+    QTest::newRow("custom-key") << QByteArray("custom-key")
+                                << QByteArray::fromHex("25a849e95ba97d7f");
+    QTest::newRow("custom-value") << QByteArray("custom-value")
+                                  << QByteArray::fromHex("25a849e95bb8e8b4bf");
+    QTest::newRow("302") << QByteArray("302") << QByteArray::fromHex("6402");
+    QTest::newRow("private") << QByteArray("private") << QByteArray::fromHex("aec3771a4b");
+    QTest::newRow("date") << QByteArray("Mon, 21 Oct 2013 20:13:21 GMT")
+                          << QByteArray::fromHex("d07abe941054d444a8200595040b8166e082a62d1bff");
+    QTest::newRow("https://www.example.com") << QByteArray("https://www.example.com")
+                                             << QByteArray::fromHex("9d29ad171863c78f0b97c8e9ae82ae43d3");
+}
+
+void tst_HPack::huffmanCoding()
+{
+    QFETCH(QByteArray, plain);
+    QFETCH(QByteArray, encoded);
+
+    QCOMPARE(QHPack::huffmanEncodedSize(plain), encoded.size());
+
+    QByteArray output;
+    QHPack::huffmanEncode(plain, &output);
+    QCOMPARE(output.toHex(), encoded.toHex());
+
+    QByteArray decoded;
+    QVERIFY(QHPack::huffmanDecode(reinterpret_cast<const uchar *>(encoded.constData()),
+                                  encoded.size(), &decoded));
+    QCOMPARE(decoded, plain);
+}
+
+void tst_HPack::huffmanPadding_data()
+{
+    QTest::addColumn<QByteArray>("encoded");
+    QTest::addColumn<bool>("valid");
+
+    // 'a' is the 5-bit code 00011
+    QTest::newRow("EOS prefix") << QByteArray::fromHex("1f") << true;
+    QTest::newRow("zero padding") << QByteArray::fromHex("18") << false;
+    QTest::newRow("padding longer than 7 bits") << QByteArray::fromHex("1fff") << false;
+    // the 30-bit EOS symbol itself must not appear in a string
+    QTest::newRow("EOS symbol") << QByteArray::fromHex("fffffffc") << false;
+}
+
+void tst_HPack::huffmanPadding()
+{
+    QFETCH(QByteArray, encoded);
+    QFETCH(bool, valid);
+
+    QByteArray decoded;
+    QCOMPARE(QHPack::huffmanDecode(reinterpret_cast<const uchar *>(encoded.constData()),
+                                   encoded.size(), &decoded), valid);
+}
+
+void tst_HPack::literalFields_data()
+{
+    QTest::addColumn<QByteArray>("block");
+    QTest::addColumn<QHPackHeaderList>("headers");
+    QTest::addColumn<bool>("indexed");
+
+    // C.2.1 - C.2.4; decoded with a fresh table each
+    QTest::newRow("literal with indexing")
+        << QByteArray::fromHex("400a637573746f6d2d6b65790d637573746f6d2d686561646572")
+        << (QHPackHeaderList() << field("custom-key", "custom-header")) << true;
+    QTest::newRow("literal without indexing")
+        << QByteArray::fromHex("040c2f73616d706c652f70617468")
+        << (QHPackHeaderList() << field(":path", "/sample/path")) << false;
+    QTest::newRow("literal never indexed")
+        << QByteArray::fromHex("100870617373776f726406736563726574")
+        << (QHPackHeaderList() << field("password", "secret")) << false;
+    QTest::newRow("indexed")
+        << QByteArray::fromHex("82")
+        << (QHPackHeaderList() << field(":method", "GET")) << false;
+}
+
+void tst_HPack::literalFields()
+{
+    QFETCH(QByteArray, block);
+    QFETCH(QHPackHeaderList, headers);
+    QFETCH(bool, indexed);
+
+    QHPackDecoder decoder;
+    QHPackHeaderList decoded;
+    QVERIFY(decoder.decode(block, &decoded));
+    QCOMPARE(decoded, headers);
+
+    // only a literal with incremental indexing makes index 62 valid
+    QHPackHeaderList fromTable;
+    QCOMPARE(decoder.decode(QByteArray::fromHex("be"), &fromTable), indexed);
+    if (indexed)
+        QCOMPARE(fromTable, headers);
+}
+
+void tst_HPack::requestSequence_data()
+{
+    QTest::addColumn<BlockList>("blocks");
+
+    // C.3
+    QTest::newRow("without huffman") << (BlockList()
+        << QByteArray::fromHex("828684410f7777772e6578616d706c652e636f6d")
+        << QByteArray::fromHex("828684be58086e6f2d6361636865")
+        << QByteArray::fromHex("828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565"));
+    // C.4
+    QTest::newRow("with huffman") << (BlockList()
+        << QByteArray::fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff")
+        << QByteArray::fromHex("828684be5886a8eb10649cbf")
+        << QByteArray::fromHex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"));
+}
+
+void tst_HPack::requestSequence()
+{
+    QFETCH(BlockList, blocks);
+
+    const QList<QHPackHeaderList> expected = requestHeaders();
+    QHPackDecoder decoder;
+    for (int i = 0; i < blocks.size(); ++i) {
+        QHPackHeaderList decoded;
+        QVERIFY(decoder.decode(blocks.at(i), &decoded));
+        QCOMPARE(decoded, expected.at(i));
+    }
+}
+
+void tst_HPack::responseSequence_data()
+{
+    QTest::addColumn<BlockList>("blocks");
+
+    // C.5; with a 256 byte table the second and third responses evict
+    // entries that earlier blocks added
+    QTest::newRow("without huffman") << (BlockList()
+        << QByteArray::fromHex("4803333032580770726976617465611d4d6f6e2c203231204f63742032303133"
+                               "2032303a31333a323120474d546e1768747470733a2f2f7777772e6578616d70"
+                               "6c652e636f6d")
+        << QByteArray::fromHex("4803333037c1c0bf")
+        << QByteArray::fromHex("88c1611d4d6f6e2c203231204f637420323031332032303a31333a323220474d"
+                               "54c05a04677a69707738666f6f3d4153444a4b48514b425a584f5157454f5049"
+                               "5541585157454f49553b206d61782d6167653d333630303b2076657273696f6e"
+                               "3d31"));
+    // C.6
+    QTest::newRow("with huffman") << (BlockList()
+        << QByteArray::fromHex("488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a6"
+                               "2d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3")
+        << QByteArray::fromHex("4883640effc1c0bf")
+        << QByteArray::fromHex("88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab"
+                               "77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f"
+                               "9587316065c003ed4ee5b1063d5007"));
+}
+
+void tst_HPack::responseSequence()
+{
+    QFETCH(BlockList, blocks);
+
+    const QList<QHPackHeaderList> expected = responseHeaders();
+    QHPackDecoder decoder(256);
+    for (int i = 0; i < blocks.size(); ++i) {
+        QHPackHeaderList decoded;
+        QVERIFY(decoder.decode(blocks.at(i), &decoded));
+        QCOMPARE(decoded, expected.at(i));
+    }
+}
+
+void tst_HPack::dynamicTableEviction()
+{
+    // replays the insertions of C.5 and checks the table state after each response
+    QHPackTable table(256);
+    table.prepend(":status", "302");
+    table.prepend("cache-control", "private");
+    table.prepend("date", "Mon, 21 Oct 2013 20:13:21 GMT");
+    table.prepend("location", "https://www.example.com");
+    QCOMPARE(table.dynamicCount(), 4);
+    QCOMPARE(table.dataSize(), 222u);
+
+    table.prepend(":status", "307");
+    QCOMPARE(table.dynamicCount(), 4);
+    QCOMPARE(table.dataSize(), 222u);
+
+    QHPackHeaderField entry;
+    QVERIFY(table.field(62, &entry));
+    QCOMPARE(entry, field(":status", "307"));
+    QVERIFY(table.field(65, &entry));
+    QCOMPARE(entry, field("cache-control", "private"));
+    QVERIFY(!table.field(66, &entry));
+
+    table.prepend("date", "Mon, 21 Oct 2013 20:13:22 GMT");
+    table.prepend("content-encoding", "gzip");
+    table.prepend("set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1");
+    QCOMPARE(table.dynamicCount(), 3);
+    QCOMPARE(table.dataSize(), 215u);
+
+    bool valueMatches = false;
+    QCOMPARE(table.indexOf("content-encoding", "gzip", &valueMatches), 63u);
+    QVERIFY(valueMatches);
+    QCOMPARE(table.indexOf("location", "https://www.example.com", &valueMatches), 46u);
+    QVERIFY(!valueMatches);
+
+    // shrinking evicts from the oldest end
+    table.setMaxSize(200);
+    QCOMPARE(table.dynamicCount(), 2);
+    QCOMPARE(table.dataSize(), 215u - 65u);
+
+    // an entry larger than the whole table empties it
+    table.prepend("x", QByteArray(200, 'x'));
+    QCOMPARE(table.dynamicCount(), 0);
+    QCOMPARE(table.dataSize(), 0u);
+}
+
+void tst_HPack::tableSizeUpdate()
+{
+    // size update to 4096 followed by an indexed field
+    const QByteArray block = QByteArray::fromHex("3fe11f82");
+    QHPackHeaderList decoded;
+
+    QHPackDecoder decoder;
+    QVERIFY(decoder.decode(block, &decoded));
+    QCOMPARE(decoded, QHPackHeaderList() << field(":method", "GET"));
+
+    // above our own SETTINGS_HEADER_TABLE_SIZE
+    QHPackDecoder limited;
+    limited.setMaxTableSize(100);
+    QVERIFY(!limited.decode(block, &decoded));
+
+    // a size update after the first field is a decoding error
+    QHPackDecoder late;
+    QVERIFY(!late.decode(QByteArray::fromHex("8220"), &decoded));
+
+    // a size of zero evicts everything that was indexed before
+    QHPackDecoder evicting;
+    QVERIFY(evicting.decode(QByteArray::fromHex("400a637573746f6d2d6b65790d637573746f6d2d686561646572"),
+                            &decoded));
+    QVERIFY(evicting.decode(QByteArray::fromHex("be"), &decoded));
+    QVERIFY(evicting.decode(QByteArray::fromHex("20"), &decoded));
+    QVERIFY(!evicting.decode(QByteArray::fromHex("be"), &decoded));
+}
+
+void tst_HPack::invalidIndex_data()
+{
+    QTest::addColumn<QByteArray>("block");
+
+    QTest::newRow("index 0") << QByteArray::fromHex("80");
+    QTest::newRow("empty dynamic table") << QByteArray::fromHex("be");
+    QTest::newRow("name index out of range") << QByteArray::fromHex("7f00") + QByteArray::fromHex("0161");
+    QTest::newRow("truncated string") << QByteArray::fromHex("400a6375");
+    QTest::newRow("truncated integer") << QByteArray::fromHex("ff");
+}
+
+void tst_HPack::invalidIndex()
+{
+    QFETCH(QByteArray, block);
+
+    QHPackDecoder decoder;
+    QHPackHeaderList decoded;
+    QVERIFY(!decoder.decode(block, &decoded));
+}
+
+void tst_HPack::maxHeaderListSize()
+{
+    // each field counts with its name, its value and 32 bytes of overhead
+    const QHPackHeaderList headers = QHPackHeaderList() << field(":status", "200")
+        << field("content-type", "text/html") << field("x-custom", "some value");
+    quint32 size = 0;
+    for (int i = 0; i < headers.size(); ++i)
+        size += QHPackTable::entrySize(headers.at(i).first, headers.at(i).second);
+
+    QHPackEncoder encoder;
+    QByteArray block;
+    encoder.encode(headers, &block);
+
+    bool listTooLarge = true;
+    QHPackDecoder decoder;
+    decoder.setMaxHeaderListSize(size);
+    QHPackHeaderList decoded;
+    QVERIFY(decoder.decode(block, &decoded, &listTooLarge));
+    QVERIFY(!listTooLarge);
+    QCOMPARE(decoded, headers);
+
+    QHPackDecoder smallDecoder;
+    smallDecoder.setMaxHeaderListSize(size - 1);
+    decoded.clear();
+    QVERIFY(!smallDecoder.decode(block, &decoded, &listTooLarge));
+    QVERIFY(listTooLarge);
+
+    // a small block that references a large table entry over and over
+    QByteArray bomb("\x40");
+    QHPack::encodeInteger(5, 7, 0, &bomb);
+    bomb += "x-big";
+    QHPack::encodeInteger(1000, 7, 0, &bomb);
+    bomb += QByteArray(1000, 'v');
+    bomb += QByteArray(1000, char(0x80 | 62));
+    QHPackDecoder limitedDecoder;
+    limitedDecoder.setMaxHeaderListSize(64 * 1024);
+    decoded.clear();
+    QVERIFY(!limitedDecoder.decode(bomb, &decoded, &listTooLarge));
+    QVERIFY(listTooLarge);
+    QVERIFY(decoded.size() < 64);
+
+    // other errors are not reported as a list that is too large
+    QVERIFY(!limitedDecoder.decode(QByteArray::fromHex("80"), &decoded, &listTooLarge));
+    QVERIFY(!listTooLarge);
+
+    // without a limit, as by default, the list is decoded
+    QHPackDecoder unlimitedDecoder;
+    decoded.clear();
+    QVERIFY(unlimitedDecoder.decode(bomb, &decoded));
+    QCOMPARE(decoded.size(), 1001);
+}
+
+void tst_HPack::encoderRoundTrip_data()
+{
+    QTest::addColumn<bool>("compressStrings");
+    QTest::addColumn<uint>("tableSize");
+    QTest::addColumn<HeaderListList>("blocks");
+
+    QTest::newRow("requests") << false << 4096u << requestHeaders();
+    QTest::newRow("requests, huffman") << true << 4096u << requestHeaders();
+    QTest::newRow("responses, small table") << false << 256u << responseHeaders();
+    QTest::newRow("responses, small table, huffman") << true << 256u << responseHeaders();
+    QTest::newRow("responses, no table") << true << 0u << responseHeaders();
+}
+
+void tst_HPack::encoderRoundTrip()
+{
+    QFETCH(bool, compressStrings);
+    QFETCH(uint, tableSize);
+    QFETCH(HeaderListList, blocks);
+
+    QHPackEncoder encoder(tableSize, compressStrings);
+    QHPackDecoder decoder(tableSize);
+    // repeat the sequence so later blocks reference what earlier ones indexed
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < blocks.size(); ++i) {
+            QByteArray block;
+            encoder.encode(blocks.at(i), &block);
+            QHPackHeaderList decoded;
+            QVERIFY(decoder.decode(block, &decoded));
+            QCOMPARE(decoded, blocks.at(i));
+        }
+    }
+}
+
+void tst_HPack::encoderTableSizeChange()
+{
+    const QList<QHPackHeaderList> responses = responseHeaders();
+    QHPackEncoder encoder;
+    QHPackDecoder decoder;
+
+    QByteArray block;
+    QHPackHeaderList decoded;
+    encoder.encode(responses.at(0), &block);
+    QVERIFY(decoder.decode(block, &decoded));
+
+    // the peer shrinks the table; the next block must start with the update
+    encoder.setMaxTableSize(64);
+    block.clear();
+    encoder.encode(responses.at(2), &block);
+    QVERIFY(!block.isEmpty());
+    QCOMPARE(uchar(block.at(0)) & 0xe0, 0x20);
+    decoded.clear();
+    QVERIFY(decoder.decode(block, &decoded));
+    QCOMPARE(decoded, responses.at(2));
+
+    // and only once
+    block.clear();
+    encoder.encode(responses.at(2), &block);
+    QVERIFY((uchar(block.at(0)) & 0xe0) != 0x20);
+    decoded.clear();
+    QVERIFY(decoder.decode(block, &decoded));
+    QCOMPARE(decoded, responses.at(2));
+}
+
+QTEST_APPLESS_MAIN(tst_HPack)
+
+#include "tst_hpack.moc"
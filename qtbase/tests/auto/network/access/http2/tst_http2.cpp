@@ -0,0 +1,873 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qendian.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include "private/qhpack_p.h"
+
+enum FrameType {
+    FrameType_DATA = 0x0,
+    FrameType_HEADERS = 0x1,
+    FrameType_RST_STREAM = 0x3,
+    FrameType_SETTINGS = 0x4,
+    FrameType_PING = 0x6,
+    FrameType_GOAWAY = 0x7,
+    FrameType_WINDOW_UPDATE = 0x8,
+    FrameType_CONTINUATION = 0x9
+};
+
+enum FrameFlag {
+    FrameFlag_END_STREAM = 0x1,
+    FrameFlag_ACK = 0x1,
+    FrameFlag_END_HEADERS = 0x4,
+    FrameFlag_PADDED = 0x8,
+    FrameFlag_PRIORITY = 0x20
+};
+
+enum ErrorCode {
+    ErrorCode_NO_ERROR = 0x0,
+    ErrorCode_PROTOCOL_ERROR = 0x1,
+    ErrorCode_INTERNAL_ERROR = 0x2,
+    ErrorCode_REFUSED_STREAM = 0x7,
+    ErrorCode_CANCEL = 0x8,
+    ErrorCode_ENHANCE_YOUR_CALM = 0xb
+};
+
+static const int DefaultWindowSize = 65535;
+static const int MaxFrameSize = 16384;
+
+struct Frame
+{
+    Frame() : type(0), flags(0), streamID(0) {}
+    Frame(uchar type, uchar flags, quint32 streamID, const QByteArray &payload)
+        : type(type), flags(flags), streamID(streamID), payload(payload) {}
+
+    uchar type;
+    uchar flags;
+    quint32 streamID;
+    QByteArray payload;
+};
+
+// The server side of one h2c connection. Requests are decoded, responses
+// are sent as the client's flow control windows permit.
+struct ServerConnection
+{
+    ServerConnection(QTcpSocket *socket)
+        : socket(socket), prefaceReceived(false), headerBlockStreamID(0),
+          headerBlockEndStream(false), decodingFailed(false),
+          sessionWindow(DefaultWindowSize), initialWindow(DefaultWindowSize)
+    {}
+
+    int framesOfType(uchar type, quint32 streamID = 0) const
+    {
+        int count = 0;
+        for (int i = 0; i < frames.size(); ++i) {
+            if (frames.at(i).type == type && (!streamID || frames.at(i).streamID == streamID))
+                ++count;
+        }
+        return count;
+    }
+
+    QTcpSocket *socket;
+    QByteArray buffer;
+    bool prefaceReceived;
+    QHPackDecoder decoder;
+    QHPackEncoder encoder;
+    quint32 headerBlockStreamID;
+    bool headerBlockEndStream;
+    QByteArray headerBlock;
+    bool decodingFailed;
+    QList<Frame> frames;
+    QList<quint32> requests;
+    QHash<quint32, QHPackHeaderList> requestHeaders;
+    QHash<quint32, QByteArray> uploads;
+    qint64 sessionWindow;
+    qint64 initialWindow;
+    QHash<quint32, qint64> streamWindows;
+    QMap<quint32, QByteArray> pendingBodies;
+};
+
+class Http2Server : public QTcpServer
+{
+    Q_OBJECT
+public:
+    Http2Server()
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    }
+
+    ~Http2Server()
+    {
+        qDeleteAll(m_connections);
+    }
+
+    int connectionCount() const { return m_connections.size(); }
+    ServerConnection *connection(int index) const { return m_connections.at(index); }
+
+    void sendFrame(ServerConnection *connection, uchar type, uchar flags, quint32 streamID,
+                   const QByteArray &payload)
+    {
+        char header[9];
+        header[0] = char(payload.size() >> 16);
+        header[1] = char(payload.size() >> 8);
+        header[2] = char(payload.size());
+        header[3] = char(type);
+        header[4] = char(flags);
+        qToBigEndian<quint32>(streamID, reinterpret_cast<uchar *>(header + 5));
+        connection->socket->write(header, sizeof(header));
+        connection->socket->write(payload);
+    }
+
+    void sendHeaders(ServerConnection *connection, quint32 streamID, const QHPackHeaderList &headers,
+                     bool endStream, int fragmentSize = MaxFrameSize)
+    {
+        QByteArray block;
+        connection->encoder.encode(headers, &block);
+        int offset = qMin(fragmentSize, block.size());
+        uchar flags = endStream ? FrameFlag_END_STREAM : 0;
+        if (offset == block.size())
+            flags |= FrameFlag_END_HEADERS;
+        sendFrame(connection, FrameType_HEADERS, flags, streamID, block.left(offset));
+        while (offset < block.size()) {
+            const QByteArray fragment = block.mid(offset, fragmentSize);
+            offset += fragment.size();
+            sendFrame(connection, FrameType_CONTINUATION,
+                      offset == block.size() ? FrameFlag_END_HEADERS : 0, streamID, fragment);
+        }
+    }
+
+    void sendBody(ServerConnection *connection, quint32 streamID, const QByteArray &body)
+    {
+        connection->pendingBodies.insert(streamID, body);
+        flushBodies(connection);
+    }
+
+    void respond(ServerConnection *connection, quint32 streamID, const QByteArray &body)
+    {
+        QHPackHeaderList headers;
+        headers << qMakePair(QByteArray(":status"), QByteArray("200"))
+                << qMakePair(QByteArray("content-length"), QByteArray::number(body.size()));
+        sendHeaders(connection, streamID, headers, false);
+        sendBody(connection, streamID, body);
+    }
+
+    void sendRST_STREAM(ServerConnection *connection, quint32 streamID, quint32 errorCode)
+    {
+        QByteArray payload(4, 0);
+        qToBigEndian<quint32>(errorCode, reinterpret_cast<uchar *>(payload.data()));
+        sendFrame(connection, FrameType_RST_STREAM, 0, streamID, payload);
+    }
+
+    void sendGOAWAY(ServerConnection *connection, quint32 lastStreamID, quint32 errorCode)
+    {
+        QByteArray payload(8, 0);
+        qToBigEndian<quint32>(lastStreamID, reinterpret_cast<uchar *>(payload.data()));
+        qToBigEndian<quint32>(errorCode, reinterpret_cast<uchar *>(payload.data() + 4));
+        sendFrame(connection, FrameType_GOAWAY, 0, 0, payload);
+    }
+
+    void sendWINDOW_UPDATE(ServerConnection *connection, quint32 streamID, quint32 delta)
+    {
+        QByteArray payload(4, 0);
+        qToBigEndian<quint32>(delta, reinterpret_cast<uchar *>(payload.data()));
+        sendFrame(connection, FrameType_WINDOW_UPDATE, 0, streamID, payload);
+    }
+
+    void sendSETTINGS(ServerConnection *connection, quint16 identifier, quint32 value)
+    {
+        QByteArray payload(6, 0);
+        qToBigEndian<quint16>(identifier, reinterpret_cast<uchar *>(payload.data()));
+        qToBigEndian<quint32>(value, reinterpret_cast<uchar *>(payload.data() + 2));
+        sendFrame(connection, FrameType_SETTINGS, 0, 0, payload);
+    }
+
+signals:
+    // emitted once the client has ended its side of the stream
+    void requestReceived(ServerConnection *connection, quint32 streamID);
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            m_connections.append(new ServerConnection(socket));
+            connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+        }
+    }
+
+    void readClient()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        ServerConnection *connection = 0;
+        for (int i = 0; i < m_connections.size() && !connection; ++i) {
+            if (m_connections.at(i)->socket == socket)
+                connection = m_connections.at(i);
+        }
+        Q_ASSERT(connection);
+        QByteArray &buffer = connection->buffer;
+        buffer.append(socket->readAll());
+
+        if (!connection->prefaceReceived) {
+            static const QByteArray preface("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+            if (buffer.size() < preface.size())
+                return;
+            if (!buffer.startsWith(preface)) {
+                socket->close();
+                return;
+            }
+            buffer.remove(0, preface.size());
+            connection->prefaceReceived = true;
+            sendFrame(connection, FrameType_SETTINGS, 0, 0, QByteArray());
+        }
+
+        int offset = 0;
+        while (buffer.size() - offset >= 9) {
+            const uchar *header = reinterpret_cast<const uchar *>(buffer.constData()) + offset;
+            const int length = (header[0] << 16) | (header[1] << 8) | header[2];
+            if (buffer.size() - offset < 9 + length)
+                break;
+            const Frame frame(header[3], header[4],
+                              qFromBigEndian<quint32>(header + 5) & 0x7fffffff,
+                              buffer.mid(offset + 9, length));
+            offset += 9 + length;
+            connection->frames.append(frame);
+            handleFrame(connection, frame);
+        }
+        buffer.remove(0, offset);
+    }
+
+private:
+    void handleFrame(ServerConnection *connection, const Frame &frame)
+    {
+        switch (frame.type) {
+        case FrameType_DATA:
+            connection->uploads[frame.streamID].append(frame.payload);
+            if (frame.flags & FrameFlag_END_STREAM)
+                emit requestReceived(connection, frame.streamID);
+            break;
+        case FrameType_HEADERS: {
+            QByteArray block = frame.payload;
+            if (frame.flags & FrameFlag_PADDED)
+                block = block.mid(1, block.size() - 1 - uchar(block.at(0)));
+            if (frame.flags & FrameFlag_PRIORITY)
+                block.remove(0, 5);
+            connection->streamWindows.insert(frame.streamID, connection->initialWindow);
+            connection->requests.append(frame.streamID);
+            connection->headerBlock = block;
+            connection->headerBlockStreamID = frame.streamID;
+            connection->headerBlockEndStream = frame.flags & FrameFlag_END_STREAM;
+            if (frame.flags & FrameFlag_END_HEADERS)
+                decodeHeaderBlock(connection);
+            break;
+        }
+        case FrameType_CONTINUATION:
+            if (frame.streamID != connection->headerBlockStreamID) {
+                connection->decodingFailed = true;
+                break;
+            }
+            connection->headerBlock.append(frame.payload);
+            if (frame.flags & FrameFlag_END_HEADERS)
+                decodeHeaderBlock(connection);
+            break;
+        case FrameType_SETTINGS:
+            if (frame.flags & FrameFlag_ACK)
+                break;
+            for (int offset = 0; offset + 6 <= frame.payload.size(); offset += 6) {
+                const uchar *setting = reinterpret_cast<const uchar *>(frame.payload.constData()) + offset;
+                if (qFromBigEndian<quint16>(setting) != 0x4) // SETTINGS_INITIAL_WINDOW_SIZE
+                    continue;
+                const qint64 value = qFromBigEndian<quint32>(setting + 2);
+                QHash<quint32, qint64>::iterator it = connection->streamWindows.begin();
+                for (; it != connection->streamWindows.end(); ++it)
+                    it.value() += value - connection->initialWindow;
+                connection->initialWindow = value;
+            }
+            sendFrame(connection, FrameType_SETTINGS, FrameFlag_ACK, 0, QByteArray());
+            flushBodies(connection);
+            break;
+        case FrameType_PING:
+            if (!(frame.flags & FrameFlag_ACK))
+                sendFrame(connection, FrameType_PING, FrameFlag_ACK, 0, frame.payload);
+            break;
+        case FrameType_WINDOW_UPDATE: {
+            const quint32 delta = qFromBigEndian<quint32>(
+                        reinterpret_cast<const uchar *>(frame.payload.constData())) & 0x7fffffff;
+            if (frame.streamID)
+                connection->streamWindows[frame.streamID] += delta;
+            else
+                connection->sessionWindow += delta;
+            flushBodies(connection);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void decodeHeaderBlock(ServerConnection *connection)
+    {
+        const quint32 streamID = connection->headerBlockStreamID;
+        QHPackHeaderList headers;
+        if (!connection->decoder.decode(connection->headerBlock, &headers))
+            connection->decodingFailed = true;
+        connection->requestHeaders.insert(streamID, headers);
+        connection->headerBlock.clear();
+        connection->headerBlockStreamID = 0;
+        if (connection->headerBlockEndStream)
+            emit requestReceived(connection, streamID);
+    }
+
+    void flushBodies(ServerConnection *connection)
+    {
+        QMap<quint32, QByteArray>::iterator it = connection->pendingBodies.begin();
+        while (it != connection->pendingBodies.end()) {
+            qint64 &streamWindow = connection->streamWindows[it.key()];
+            QByteArray &body = it.value();
+            bool ended = body.isEmpty();
+            if (ended)
+                sendFrame(connection, FrameType_DATA, FrameFlag_END_STREAM, it.key(), QByteArray());
+            while (!ended && streamWindow > 0 && connection->sessionWindow > 0) {
+                const int size = int(qMin(qMin(streamWindow, connection->sessionWindow),
+                                          qint64(qMin(body.size(), MaxFrameSize))));
+                ended = size == body.size();
+                sendFrame(connection, FrameType_DATA, ended ? FrameFlag_END_STREAM : 0,
+                          it.key(), body.left(size));
+                body.remove(0, size);
+                streamWindow -= size;
+                connection->sessionWindow -= size;
+            }
+            if (ended)
+                it = connection->pendingBodies.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    QList<ServerConnection *> m_connections;
+};
+
+static QByteArray headerValue(const QHPackHeaderList &headers, const QByteArray &name)
+{
+    for (int i = 0; i < headers.size(); ++i) {
+        if (headers.at(i).first == name)
+            return headers.at(i).second;
+    }
+    return QByteArray();
+}
+
+class tst_Http2 : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_Http2();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void continuationFrames();
+    void interruptedHeaderBlock_data();
+    void interruptedHeaderBlock();
+    void headerLimits_data();
+    void headerLimits();
+    void clientSettings();
+    void serverHeaderListLimit();
+    void uploadFlowControl();
+    void downloadFlowControl();
+    void resetStream_data();
+    void resetStream();
+    void refusedStream();
+    void goAway_data();
+    void goAway();
+
+protected slots:
+    void handleRequest(ServerConnection *connection, quint32 streamID);
+
+private:
+    enum Scenario {
+        Respond,
+        RespondWithContinuation,
+        InterruptHeaderBlock,
+        ContinuationWithoutBlock,
+        ContinuationOnOtherStream,
+        OversizedHeaderBlock,
+        OversizedHeaderList,
+        LimitHeaderList,
+        ResetStream,
+        RefuseFirstStream,
+        GoAway
+    };
+
+    QNetworkReply *get(const QString &path);
+
+    Http2Server *m_server;
+    QNetworkAccessManager *m_manager;
+    Scenario m_scenario;
+    QByteArray m_responseBody;
+    QHPackHeaderList m_responseHeaders;
+    quint32 m_errorCode;
+};
+
+tst_Http2::tst_Http2()
+    : m_server(0), m_manager(0), m_scenario(Respond), m_errorCode(0)
+{
+}
+
+void tst_Http2::init()
+{
+    m_server = new Http2Server;
+    QVERIFY(m_server->listen(QHostAddress::LocalHost));
+    connect(m_server, SIGNAL(requestReceived(ServerConnection*,quint32)),
+            this, SLOT(handleRequest(ServerConnection*,quint32)));
+    // a fresh manager so no connection survives from an earlier test
+    m_manager = new QNetworkAccessManager;
+    m_scenario = Respond;
+    m_responseBody = "ok";
+    m_responseHeaders.clear();
+    m_errorCode = ErrorCode_NO_ERROR;
+}
+
+void tst_Http2::cleanup()
+{
+    delete m_manager;
+    m_manager = 0;
+    delete m_server;
+    m_server = 0;
+}
+
+QNetworkReply *tst_Http2::get(const QString &path)
+{
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1%2").arg(m_server->serverPort()).arg(path)));
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+    return m_manager->get(request);
+}
+
+void tst_Http2::handleRequest(ServerConnection *connection, quint32 streamID)
+{
+    switch (m_scenario) {
+    case Respond:
+        m_server->respond(connection, streamID, m_responseBody);
+        break;
+    case RespondWithContinuation:
+        m_server->sendHeaders(connection, streamID, m_responseHeaders, false, 1000);
+        m_server->sendBody(connection, streamID, m_responseBody);
+        break;
+    case InterruptHeaderBlock: {
+        // everything but the last fragment, then a frame of another type
+        QByteArray block;
+        connection->encoder.encode(QHPackHeaderList() << qMakePair(QByteArray(":status"),
+                                                                   QByteArray("200")), &block);
+        m_server->sendFrame(connection, FrameType_HEADERS, 0, streamID, block);
+        m_server->sendFrame(connection, FrameType_PING, 0, 0, QByteArray(8, 0));
+        break;
+    }
+    case ContinuationWithoutBlock:
+        m_server->sendFrame(connection, FrameType_CONTINUATION, FrameFlag_END_HEADERS, streamID,
+                            QByteArray::fromHex("88"));
+        break;
+    case ContinuationOnOtherStream:
+        m_server->sendFrame(connection, FrameType_HEADERS, 0, streamID, QByteArray::fromHex("88"));
+        m_server->sendFrame(connection, FrameType_CONTINUATION, FrameFlag_END_HEADERS, streamID + 2,
+                            QByteArray());
+        break;
+    case OversizedHeaderBlock: {
+        // CONTINUATION frames that never end the block
+        m_server->sendFrame(connection, FrameType_HEADERS, 0, streamID, QByteArray::fromHex("88"));
+        for (int i = 0; i < 20; ++i)
+            m_server->sendFrame(connection, FrameType_CONTINUATION, 0, streamID, QByteArray(MaxFrameSize, 'x'));
+        break;
+    }
+    case OversizedHeaderList: {
+        // a small block: one field added to the table, then referenced over
+        // and over by its index
+        QByteArray block("\x40");
+        QHPack::encodeInteger(5, 7, 0, &block);
+        block += "x-big";
+        QHPack::encodeInteger(1500, 7, 0, &block);
+        block += QByteArray(1500, 'v');
+        block += QByteArray(200, char(0x80 | 62));
+        m_server->sendFrame(connection, FrameType_HEADERS, FrameFlag_END_HEADERS, streamID, block);
+        break;
+    }
+    case LimitHeaderList:
+        m_server->sendSETTINGS(connection, 0x6, 1024); // SETTINGS_MAX_HEADER_LIST_SIZE
+        m_server->respond(connection, streamID, m_responseBody);
+        break;
+    case ResetStream:
+        m_server->sendRST_STREAM(connection, streamID, m_errorCode);
+        break;
+    case RefuseFirstStream:
+        if (connection->requests.size() == 1)
+            m_server->sendRST_STREAM(connection, streamID, ErrorCode_REFUSED_STREAM);
+        else
+            m_server->respond(connection, streamID, m_responseBody);
+        break;
+    case GoAway:
+        // the first connection waits for both requests, processes only the
+        // first one and goes away; the second is retried on a new connection
+        if (connection != m_server->connection(0)) {
+            m_server->respond(connection, streamID, m_responseBody);
+        } else if (connection->requests.size() == 2) {
+            const quint32 firstStreamID = connection->requests.first();
+            m_server->sendGOAWAY(connection, firstStreamID, m_errorCode);
+            if (m_errorCode == ErrorCode_NO_ERROR)
+                m_server->respond(connection, firstStreamID, m_responseBody);
+        }
+        break;
+    }
+}
+
+void tst_Http2::continuationFrames()
+{
+    // large enough that both header blocks need CONTINUATION frames
+    const QByteArray largeValue(40000, 'x');
+    m_scenario = RespondWithContinuation;
+    m_responseHeaders << qMakePair(QByteArray(":status"), QByteArray("200"));
+    for (int i = 0; i < 100; ++i) {
+        m_responseHeaders << qMakePair("x-field-" + QByteArray::number(i),
+                                       QByteArray::number(i * 7919) + QByteArray(50, 'v'));
+    }
+
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/").arg(m_server->serverPort())));
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+    request.setRawHeader("x-large", largeValue);
+    QScopedPointer<QNetworkReply> reply(m_manager->get(request));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool());
+    QCOMPARE(reply->readAll(), m_responseBody);
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(reply->rawHeader("x-field-" + QByteArray::number(i)),
+                 QByteArray::number(i * 7919) + QByteArray(50, 'v'));
+    }
+
+    // the request went out as HEADERS followed by CONTINUATION frames
+    QCOMPARE(m_server->connectionCount(), 1);
+    ServerConnection *connection = m_server->connection(0);
+    QVERIFY(!connection->decodingFailed);
+    QVERIFY(connection->framesOfType(FrameType_CONTINUATION, 1) > 0);
+    QCOMPARE(headerValue(connection->requestHeaders.value(1), "x-large"), largeValue);
+
+    // no other frame may appear within the header block
+    bool inBlock = false;
+    for (int i = 0; i < connection->frames.size(); ++i) {
+        const Frame &frame = connection->frames.at(i);
+        if (inBlock)
+            QCOMPARE(int(frame.type), int(FrameType_CONTINUATION));
+        if (frame.type == FrameType_HEADERS || frame.type == FrameType_CONTINUATION)
+            inBlock = !(frame.flags & FrameFlag_END_HEADERS);
+        if (frame.type == FrameType_HEADERS || frame.type == FrameType_CONTINUATION)
+            QVERIFY(frame.payload.size() <= MaxFrameSize);
+    }
+}
+
+void tst_Http2::interruptedHeaderBlock_data()
+{
+    QTest::addColumn<int>("scenario");
+    QTest::addColumn<QString>("warning");
+
+    QTest::newRow("frame inside header block") << int(InterruptHeaderBlock)
+        << QString("HTTP/2 connection error: header block was interrupted");
+    QTest::newRow("continuation without header block") << int(ContinuationWithoutBlock)
+        << QString("HTTP/2 connection error: got unexpected CONTINUATION frame");
+    QTest::newRow("continuation on another stream") << int(ContinuationOnOtherStream)
+        << QString("HTTP/2 connection error: got unexpected CONTINUATION frame");
+}
+
+void tst_Http2::interruptedHeaderBlock()
+{
+    QFETCH(int, scenario);
+    QFETCH(QString, warning);
+
+    m_scenario = Scenario(scenario);
+    QTest::ignoreMessage(QtWarningMsg, warning.toLatin1().constData());
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(reply->error(), QNetworkReply::ProtocolFailure);
+
+    // a connection error is announced with GOAWAY before the client closes
+    ServerConnection *connection = m_server->connection(0);
+    QTRY_COMPARE(connection->framesOfType(FrameType_GOAWAY), 1);
+    for (int i = 0; i < connection->frames.size(); ++i) {
+        const Frame &frame = connection->frames.at(i);
+        if (frame.type != FrameType_GOAWAY)
+            continue;
+        QCOMPARE(frame.payload.size(), 8);
+        QCOMPARE(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(frame.payload.constData()) + 4),
+                 quint32(ErrorCode_PROTOCOL_ERROR));
+    }
+    QTRY_COMPARE(connection->socket->state(), QAbstractSocket::UnconnectedState);
+}
+
+void tst_Http2::headerLimits_data()
+{
+    QTest::addColumn<int>("scenario");
+    QTest::addColumn<QString>("warning");
+
+    QTest::newRow("header block too large") << int(OversizedHeaderBlock)
+        << QString("HTTP/2 connection error: header block is too large");
+    QTest::newRow("header list too large") << int(OversizedHeaderList)
+        << QString("HTTP/2 connection error: header list is too large");
+}
+
+void tst_Http2::headerLimits()
+{
+    QFETCH(int, scenario);
+    QFETCH(QString, warning);
+
+    m_scenario = Scenario(scenario);
+    QTest::ignoreMessage(QtWarningMsg, warning.toLatin1().constData());
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(reply->error(), QNetworkReply::ProtocolFailure);
+    QVERIFY(reply->rawHeaderList().isEmpty());
+
+    ServerConnection *connection = m_server->connection(0);
+    QTRY_COMPARE(connection->framesOfType(FrameType_GOAWAY), 1);
+    for (int i = 0; i < connection->frames.size(); ++i) {
+        const Frame &frame = connection->frames.at(i);
+        if (frame.type != FrameType_GOAWAY)
+            continue;
+        QCOMPARE(frame.payload.size(), 8);
+        QCOMPARE(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(frame.payload.constData()) + 4),
+                 quint32(ErrorCode_ENHANCE_YOUR_CALM));
+    }
+    QTRY_COMPARE(connection->socket->state(), QAbstractSocket::UnconnectedState);
+}
+
+void tst_Http2::clientSettings()
+{
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    // the first frame after the preface announces the client's settings
+    ServerConnection *connection = m_server->connection(0);
+    QVERIFY(!connection->frames.isEmpty());
+    const Frame &settings = connection->frames.first();
+    QCOMPARE(int(settings.type), int(FrameType_SETTINGS));
+    QMap<quint16, quint32> values;
+    for (int offset = 0; offset + 6 <= settings.payload.size(); offset += 6) {
+        const uchar *setting = reinterpret_cast<const uchar *>(settings.payload.constData()) + offset;
+        values.insert(qFromBigEndian<quint16>(setting), qFromBigEndian<quint32>(setting + 2));
+    }
+    QCOMPARE(values.value(0x2, 1), quint32(0)); // SETTINGS_ENABLE_PUSH
+    QVERIFY(values.contains(0x6)); // SETTINGS_MAX_HEADER_LIST_SIZE
+    QVERIFY(values.value(0x6) >= 64 * 1024);
+}
+
+void tst_Http2::serverHeaderListLimit()
+{
+    m_scenario = LimitHeaderList;
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    // headers larger than the server accepts are not sent at all
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/large").arg(m_server->serverPort())));
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+    request.setRawHeader("x-large", QByteArray(2000, 'x'));
+    QScopedPointer<QNetworkReply> large(m_manager->get(request));
+    QTRY_VERIFY_WITH_TIMEOUT(large->isFinished(), 10000);
+    QCOMPARE(large->error(), QNetworkReply::ProtocolFailure);
+
+    // and the connection is still usable
+    QScopedPointer<QNetworkReply> next(get("/next"));
+    QTRY_VERIFY_WITH_TIMEOUT(next->isFinished(), 10000);
+    QCOMPARE(next->error(), QNetworkReply::NoError);
+    QCOMPARE(m_server->connectionCount(), 1);
+    ServerConnection *connection = m_server->connection(0);
+    QVERIFY(!connection->decodingFailed);
+    QCOMPARE(connection->requests.size(), 2);
+    QCOMPARE(headerValue(connection->requestHeaders.value(connection->requests.last()), ":path"),
+             QByteArray("/next"));
+}
+
+void tst_Http2::uploadFlowControl()
+{
+    const QByteArray upload(150000, 'u');
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/upload").arg(m_server->serverPort())));
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    QScopedPointer<QNetworkReply> reply(m_manager->post(request, upload));
+
+    // the initial windows of 65535 bytes stop the upload
+    QTRY_COMPARE(m_server->connectionCount(), 1);
+    ServerConnection *connection = m_server->connection(0);
+    QTRY_COMPARE(connection->uploads.value(1).size(), DefaultWindowSize);
+    QTest::qWait(200);
+    QCOMPARE(connection->uploads.value(1).size(), DefaultWindowSize);
+
+    // opening the session window alone is not enough
+    m_server->sendWINDOW_UPDATE(connection, 0, 200000);
+    QTest::qWait(200);
+    QCOMPARE(connection->uploads.value(1).size(), DefaultWindowSize);
+
+    // a larger initial window also grows the window of the open stream
+    m_server->sendSETTINGS(connection, 0x4, 200000); // SETTINGS_INITIAL_WINDOW_SIZE
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(connection->uploads.value(1), upload);
+    for (int i = 0; i < connection->frames.size(); ++i) {
+        const Frame &frame = connection->frames.at(i);
+        if (frame.type == FrameType_DATA)
+            QVERIFY(frame.payload.size() <= MaxFrameSize);
+    }
+    // the last frame carries END_STREAM
+    int lastData = connection->frames.size() - 1;
+    while (lastData >= 0 && connection->frames.at(lastData).type != FrameType_DATA)
+        --lastData;
+    QVERIFY(lastData >= 0);
+    QVERIFY(connection->frames.at(lastData).flags & FrameFlag_END_STREAM);
+}
+
+void tst_Http2::downloadFlowControl()
+{
+    // more than the stream window of 1 MiB the client announces
+    m_responseBody.resize(3 * 1024 * 1024);
+    for (int i = 0; i < m_responseBody.size(); ++i)
+        m_responseBody[i] = char('a' + i % 26);
+
+    QScopedPointer<QNetworkReply> reply(get("/download"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), m_responseBody);
+
+    ServerConnection *connection = m_server->connection(0);
+    // the client opened its stream window up front and the session window
+    // with an initial WINDOW_UPDATE, then kept both open while reading
+    QVERIFY(connection->initialWindow > DefaultWindowSize);
+    QVERIFY(connection->framesOfType(FrameType_WINDOW_UPDATE, 1) > 0);
+    QVERIFY(connection->pendingBodies.isEmpty());
+}
+
+void tst_Http2::resetStream_data()
+{
+    QTest::addColumn<uint>("errorCode");
+    QTest::addColumn<int>("networkError");
+
+    QTest::newRow("CANCEL") << uint(ErrorCode_CANCEL) << int(QNetworkReply::ProtocolFailure);
+    QTest::newRow("INTERNAL_ERROR") << uint(ErrorCode_INTERNAL_ERROR)
+                                    << int(QNetworkReply::InternalServerError);
+    QTest::newRow("ENHANCE_YOUR_CALM") << uint(ErrorCode_ENHANCE_YOUR_CALM)
+                                       << int(QNetworkReply::ServiceUnavailableError);
+}
+
+void tst_Http2::resetStream()
+{
+    QFETCH(uint, errorCode);
+    QFETCH(int, networkError);
+
+    m_scenario = ResetStream;
+    m_errorCode = errorCode;
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    QCOMPARE(int(reply->error()), networkError);
+
+    // only the stream was reset, the connection is still usable
+    m_scenario = Respond;
+    QScopedPointer<QNetworkReply> next(get("/next"));
+    QTRY_VERIFY_WITH_TIMEOUT(next->isFinished(), 10000);
+    QCOMPARE(next->error(), QNetworkReply::NoError);
+    QCOMPARE(m_server->connectionCount(), 1);
+}
+
+void tst_Http2::refusedStream()
+{
+    m_scenario = RefuseFirstStream;
+    QScopedPointer<QNetworkReply> reply(get("/"));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 10000);
+
+    // the server did not process the request, so it was sent again
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), m_responseBody);
+    QCOMPARE(m_server->connectionCount(), 1);
+    QCOMPARE(m_server->connection(0)->requests, QList<quint32>() << 1 << 3);
+}
+
+void tst_Http2::goAway_data()
+{
+    QTest::addColumn<uint>("errorCode");
+    QTest::addColumn<int>("firstError");
+
+    QTest::newRow("NO_ERROR") << uint(ErrorCode_NO_ERROR) << int(QNetworkReply::NoError);
+    QTest::newRow("INTERNAL_ERROR") << uint(ErrorCode_INTERNAL_ERROR)
+                                    << int(QNetworkReply::InternalServerError);
+}
+
+void tst_Http2::goAway()
+{
+    QFETCH(uint, errorCode);
+    QFETCH(int, firstError);
+
+    m_scenario = GoAway;
+    m_errorCode = errorCode;
+    QScopedPointer<QNetworkReply> first(get("/first"));
+    QScopedPointer<QNetworkReply> second(get("/second"));
+    QTRY_VERIFY_WITH_TIMEOUT(first->isFinished(), 10000);
+    QTRY_VERIFY_WITH_TIMEOUT(second->isFinished(), 10000);
+
+    QCOMPARE(m_server->connectionCount(), 2);
+    ServerConnection *connection = m_server->connection(0);
+    QCOMPARE(connection->requests.size(), 2);
+    QCOMPARE(m_server->connection(1)->requests.size(), 1);
+
+    // the stream up to the last stream ID completes or fails with the error
+    // code, the later one was not processed and went out on the new connection
+    const QByteArray processedPath = headerValue(connection->requestHeaders.value(connection->requests.first()),
+                                                 ":path");
+    QNetworkReply *processed = processedPath == "/first" ? first.data() : second.data();
+    QNetworkReply *retried = processed == first.data() ? second.data() : first.data();
+    QCOMPARE(headerValue(m_server->connection(1)->requestHeaders.value(1), ":path"),
+             retried->url().path().toLatin1());
+    QCOMPARE(int(processed->error()), firstError);
+    QCOMPARE(retried->error(), QNetworkReply::NoError);
+    QCOMPARE(retried->readAll(), m_responseBody);
+}
+
+QTEST_MAIN(tst_Http2)
+
+#include "tst_http2.moc"
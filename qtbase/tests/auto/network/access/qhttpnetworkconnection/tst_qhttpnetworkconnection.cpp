@@ -35,6 +35,7 @@
 #include <QtTest/QtTest>
 #include "private/qhttpnetworkconnection_p.h"
 #include "private/qnoncontiguousbytedevice_p.h"
+#include <QtNetwork/qhttpmultipartreader.h>
 #include <QAuthenticator>
 #include <QTcpServer>
 
@@ -109,6 +110,18 @@ private Q_SLOTS:
     void getAndThenDeleteObject_data();
 
     void overlappingCloseAndWrite();
+
+    void chunkedBody_data();
+    void chunkedBody();
+
+    void boundaryFromContentType_data();
+    void boundaryFromContentType();
+    void multiPartReader_data();
+    void multiPartReader();
+    void multiPartReaderMissingBoundary();
+    void multiPartReaderPrematureEnd();
+    void partContentRange_data();
+    void partContentRange();
 };
 
 tst_QHttpNetworkConnection::tst_QHttpNetworkConnection()
@@ -1167,6 +1180,418 @@ void tst_QHttpNetworkConnection::overlappingCloseAndWrite()
     QTRY_COMPARE(server.errorCodeReports, 10);
 }
 
+// Answers the first request on a connection with the header and the
+// pieces of a chunked body, one piece at a time, so that the client
+// has to put the body together from several reads.
+class ChunkedReplyServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit ChunkedReplyServer(const QList<QByteArray> &pieces)
+        : pieces(pieces), client(0)
+    {
+        connect(this, &QTcpServer::newConnection, this, &ChunkedReplyServer::onNewConnection);
+        QVERIFY(listen(QHostAddress::LocalHost));
+    }
+
+private slots:
+    void onNewConnection()
+    {
+        client = nextPendingConnection();
+        if (client)
+            connect(client, &QTcpSocket::readyRead, this, &ChunkedReplyServer::readRequest);
+    }
+
+    void readRequest()
+    {
+        request += client->readAll();
+        if (!request.contains("\r\n\r\n"))
+            return;
+        disconnect(client, &QTcpSocket::readyRead, this, &ChunkedReplyServer::readRequest);
+        client->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: application/octet-stream\r\n"
+                      "Transfer-Encoding: chunked\r\n"
+                      "\r\n");
+        writeNextPiece();
+    }
+
+    void writeNextPiece()
+    {
+        // the connection stays open, so that a decoder that stalls times out
+        if (pieces.isEmpty() || !client)
+            return;
+        client->write(pieces.takeFirst());
+        client->flush();
+        QTimer::singleShot(pieces.size() > 100 ? 1 : 20, this, SLOT(writeNextPiece()));
+    }
+
+private:
+    QList<QByteArray> pieces;
+    QPointer<QTcpSocket> client;
+    QByteArray request;
+};
+
+static QList<QByteArray> splitEvery(const QByteArray &data, int size)
+{
+    QList<QByteArray> pieces;
+    for (int i = 0; i < data.size(); i += size)
+        pieces << data.mid(i, size);
+    return pieces;
+}
+
+void tst_QHttpNetworkConnection::chunkedBody_data()
+{
+    QTest::addColumn<QList<QByteArray> >("pieces");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addColumn<bool>("ok");
+
+    const QByteArray simple("5\r\nhello\r\n1;name=value\r\n \r\n5\r\nworld\r\n0\r\n\r\n");
+    const QByteArray large(200 * 1024, 'x');
+
+    QTest::newRow("single") << (QList<QByteArray>() << "5\r\nhello\r\n0\r\n\r\n")
+                            << QByteArray("hello") << true;
+    QTest::newRow("several") << (QList<QByteArray>() << simple)
+                             << QByteArray("hello world") << true;
+    QTest::newRow("upper-case") << (QList<QByteArray>() << "A\r\n0123456789\r\n0\r\n\r\n")
+                                << QByteArray("0123456789") << true;
+    QTest::newRow("leading-zeros") << (QList<QByteArray>() << "00000000000000000005\r\nhello\r\n0\r\n\r\n")
+                                   << QByteArray("hello") << true;
+    QTest::newRow("extension-whitespace") << (QList<QByteArray>() << "5 ; name=\"a;b\"\r\nhello\r\n0\r\n\r\n")
+                                          << QByteArray("hello") << true;
+    QTest::newRow("large") << (QList<QByteArray>() << "32000\r\n" + large + "\r\n0\r\n\r\n")
+                           << large << true;
+    QTest::newRow("trailers") << (QList<QByteArray>() << "5\r\nhello\r\n0\r\nExpires: never\r\nX-Checksum: 1\r\n\r\n")
+                              << QByteArray("hello") << true;
+
+    // split reads
+    QTest::newRow("split-size-line") << (QList<QByteArray>() << "1" << "0\r\n0123456789abcdef\r\n0\r\n\r\n")
+                                     << QByteArray("0123456789abcdef") << true;
+    QTest::newRow("split-data-crlf") << (QList<QByteArray>() << "5\r\nhello\r" << "\n0\r\n\r" << "\n")
+                                     << QByteArray("hello") << true;
+    QTest::newRow("split-data") << (QList<QByteArray>() << "a\r\nhello" << "world\r\n0\r\n\r\n")
+                                << QByteArray("helloworld") << true;
+    QTest::newRow("split-trailer") << (QList<QByteArray>() << "5\r\nhello\r\n0\r\nExp" << "ires: never\r" << "\n\r\n")
+                                   << QByteArray("hello") << true;
+    QTest::newRow("byte-by-byte") << splitEvery(simple, 1) << QByteArray("hello world") << true;
+    QTest::newRow("three-bytes") << splitEvery(simple, 3) << QByteArray("hello world") << true;
+
+    // malformed chunk-size lines
+    QTest::newRow("not-hex") << (QList<QByteArray>() << "xyz\r\nhello\r\n0\r\n\r\n")
+                             << QByteArray() << false;
+    QTest::newRow("negative") << (QList<QByteArray>() << "-5\r\nhello\r\n0\r\n\r\n")
+                              << QByteArray() << false;
+    QTest::newRow("plus-sign") << (QList<QByteArray>() << "+5\r\nhello\r\n0\r\n\r\n")
+                               << QByteArray() << false;
+    QTest::newRow("0x-prefix") << (QList<QByteArray>() << "0x5\r\nhello\r\n0\r\n\r\n")
+                               << QByteArray() << false;
+    QTest::newRow("inner-blank") << (QList<QByteArray>() << "1 0\r\n0123456789abcdef\r\n0\r\n\r\n")
+                                 << QByteArray() << false;
+    QTest::newRow("overflow") << (QList<QByteArray>() << "10000000000000000\r\nhello\r\n0\r\n\r\n")
+                              << QByteArray() << false;
+    QTest::newRow("only-extension") << (QList<QByteArray>() << ";name=value\r\nhello\r\n0\r\n\r\n")
+                                    << QByteArray() << false;
+    QTest::newRow("data-too-long") << (QList<QByteArray>() << "5\r\nhelloXX\r\n0\r\n\r\n")
+                                   << QByteArray() << false;
+
+    // overlong lines
+    QTest::newRow("overlong-size-line") << (QList<QByteArray>() << QByteArray(9000, '0') + "5\r\nhello\r\n0\r\n\r\n")
+                                        << QByteArray() << false;
+    QTest::newRow("overlong-extension") << (QList<QByteArray>() << "5;" + QByteArray(9000, 'x') + "\r\nhello\r\n0\r\n\r\n")
+                                        << QByteArray() << false;
+    QTest::newRow("overlong-trailer") << (QList<QByteArray>() << "5\r\nhello\r\n0\r\nX: " + QByteArray(9000, 'x') + "\r\n\r\n")
+                                      << QByteArray() << false;
+    QTest::newRow("overlong-split-line") << splitEvery("5;" + QByteArray(9000, 'x') + "\r\nhello\r\n0\r\n\r\n", 1000)
+                                         << QByteArray() << false;
+}
+
+void tst_QHttpNetworkConnection::chunkedBody()
+{
+    QFETCH(QList<QByteArray>, pieces);
+    QFETCH(QByteArray, expected);
+    QFETCH(bool, ok);
+
+    ChunkedReplyServer server(pieces);
+    QNetworkAccessManager manager;
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(server.serverAddress().toString());
+    url.setPort(server.serverPort());
+
+    QNetworkReply *reply = manager.get(QNetworkRequest(url));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 15000);
+
+    if (ok) {
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), expected);
+    } else {
+        QCOMPARE(reply->error(), QNetworkReply::ProtocolFailure);
+    }
+    delete reply;
+}
+
+// Records what a QHttpMultiPartReader reports.
+class MultiPartRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MultiPartRecorder(QHttpMultiPartReader *reader)
+        : reader(reader), finishedCount(0), inPart(false)
+    {
+        connect(reader, SIGNAL(partStarted()), this, SLOT(partStarted()));
+        connect(reader, SIGNAL(partData(QByteArray)), this, SLOT(partData(QByteArray)));
+        connect(reader, SIGNAL(partFinished()), this, SLOT(partFinished()));
+        connect(reader, SIGNAL(finished()), this, SLOT(finished()));
+    }
+
+    QHttpMultiPartReader *reader;
+    QList<QByteArray> bodies;
+    QList<QByteArray> contentTypes;
+    int finishedCount;
+    bool inPart;
+
+public slots:
+    void partStarted()
+    {
+        QVERIFY(!inPart);
+        inPart = true;
+        bodies << QByteArray();
+        contentTypes << reader->partRawHeader("Content-Type");
+    }
+
+    void partData(const QByteArray &data)
+    {
+        QVERIFY(inPart);
+        QVERIFY(!data.isEmpty());
+        bodies.last() += data;
+    }
+
+    void partFinished()
+    {
+        QVERIFY(inPart);
+        inPart = false;
+    }
+
+    void finished()
+    {
+        ++finishedCount;
+    }
+};
+
+void tst_QHttpNetworkConnection::boundaryFromContentType_data()
+{
+    QTest::addColumn<QByteArray>("contentType");
+    QTest::addColumn<QByteArray>("boundary");
+
+    QTest::newRow("plain") << QByteArray("multipart/mixed; boundary=abc") << QByteArray("abc");
+    QTest::newRow("quoted") << QByteArray("multipart/mixed; boundary=\"a b:c\"") << QByteArray("a b:c");
+    QTest::newRow("case") << QByteArray("multipart/byteranges; BOUNDARY=abc") << QByteArray("abc");
+    QTest::newRow("blanks") << QByteArray("multipart/mixed ; boundary = abc ") << QByteArray("abc");
+    QTest::newRow("other-parameters") << QByteArray("multipart/mixed; charset=utf-8; boundary=abc; x=y")
+                                      << QByteArray("abc");
+    QTest::newRow("suffix") << QByteArray("multipart/mixed; xboundary=abc") << QByteArray();
+    QTest::newRow("missing") << QByteArray("multipart/mixed") << QByteArray();
+    QTest::newRow("empty") << QByteArray() << QByteArray();
+}
+
+void tst_QHttpNetworkConnection::boundaryFromContentType()
+{
+    QFETCH(QByteArray, contentType);
+    QFETCH(QByteArray, boundary);
+
+    QCOMPARE(QHttpMultiPartReader::boundaryFromContentType(contentType), boundary);
+}
+
+void tst_QHttpNetworkConnection::multiPartReader_data()
+{
+    QTest::addColumn<QByteArray>("message");
+    QTest::addColumn<int>("pieceSize");
+    QTest::addColumn<QList<QByteArray> >("bodies");
+    QTest::addColumn<QList<QByteArray> >("contentTypes");
+    QTest::addColumn<int>("error");
+
+    const QByteArray twoParts("preamble\r\n"
+                              "--b\r\n"
+                              "Content-Type: text/plain\r\n"
+                              "\r\n"
+                              "first\r\n"
+                              "--b\r\n"
+                              "Content-Type: text/html\r\n"
+                              "\r\n"
+                              "second\r\n"
+                              "--b--\r\n"
+                              "epilogue\r\n--b\r\n");
+    const QList<QByteArray> twoBodies = QList<QByteArray>() << "first" << "second";
+    const QList<QByteArray> twoTypes = QList<QByteArray>() << "text/plain" << "text/html";
+
+    // each message is also fed in pieces of a single and of a few bytes
+    const int pieceSizes[] = { 0, 1, 3 };
+    for (int i = 0; i < 3; ++i) {
+        const int size = pieceSizes[i];
+        const QByteArray suffix = '-' + QByteArray::number(size);
+
+        QTest::newRow(("two-parts" + suffix).constData()) << twoParts << size << twoBodies << twoTypes
+                                                          << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("no-preamble" + suffix).constData())
+            << QByteArray("--b\r\n\r\nbody\r\n--b--")
+            << size << (QList<QByteArray>() << "body") << (QList<QByteArray>() << QByteArray())
+            << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("transport-padding" + suffix).constData())
+            << QByteArray("--b \t \r\nContent-Type: a\r\n\r\nbody\r\n--b\t\r\n\r\n\r\n--b--")
+            << size << (QList<QByteArray>() << "body" << QByteArray())
+            << (QList<QByteArray>() << "a" << QByteArray())
+            << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("delimiter-look-alikes" + suffix).constData())
+            << QByteArray("--b\r\n\r\n--b\r\r\n-b\n--b\r\n--b\r\n\r\n--\r\n--b--")
+            << size << (QList<QByteArray>() << "--b\r\r\n-b\n--b" << "--")
+            << (QList<QByteArray>() << QByteArray() << QByteArray())
+            << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("cr-at-end" + suffix).constData())
+            << QByteArray("--b\r\n\r\nbody\r\r\n--b--")
+            << size << (QList<QByteArray>() << "body\r") << (QList<QByteArray>() << QByteArray())
+            << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("folded-header" + suffix).constData())
+            << QByteArray("--b\r\nContent-Type: text/plain;\r\n charset=utf-8\r\n\r\nbody\r\n--b--")
+            << size << (QList<QByteArray>() << "body")
+            << (QList<QByteArray>() << "text/plain; charset=utf-8")
+            << int(QHttpMultiPartReader::NoError);
+        QTest::newRow(("malformed-header" + suffix).constData())
+            << QByteArray("--b\r\nno colon\r\n\r\nbody\r\n--b--")
+            << size << QList<QByteArray>() << QList<QByteArray>()
+            << int(QHttpMultiPartReader::MalformedPartError);
+        QTest::newRow(("garbage-after-boundary" + suffix).constData())
+            << QByteArray("--b\r\n\r\nfirst\r\n--bx\r\n\r\nsecond\r\n--b--")
+            << size << (QList<QByteArray>() << "first") << (QList<QByteArray>() << QByteArray())
+            << int(QHttpMultiPartReader::MalformedPartError);
+    }
+
+    QTest::newRow("overlong-delimiter-line")
+        << "--b" + QByteArray(2000, ' ') << 0 << QList<QByteArray>() << QList<QByteArray>()
+        << int(QHttpMultiPartReader::MalformedPartError);
+    QTest::newRow("overlong-headers")
+        << "--b\r\nX: " + QByteArray(70 * 1024, 'x') << 1024 << QList<QByteArray>() << QList<QByteArray>()
+        << int(QHttpMultiPartReader::MalformedPartError);
+}
+
+void tst_QHttpNetworkConnection::multiPartReader()
+{
+    QFETCH(QByteArray, message);
+    QFETCH(int, pieceSize);
+    QFETCH(QList<QByteArray>, bodies);
+    QFETCH(QList<QByteArray>, contentTypes);
+    QFETCH(int, error);
+
+    QHttpMultiPartReader reader;
+    reader.setBoundary("b");
+    QCOMPARE(reader.boundary(), QByteArray("b"));
+    MultiPartRecorder recorder(&reader);
+
+    if (pieceSize == 0) {
+        reader.addData(message);
+    } else {
+        for (int i = 0; i < message.size(); i += pieceSize)
+            reader.addData(message.mid(i, pieceSize));
+    }
+
+    QCOMPARE(int(reader.error()), error);
+    QCOMPARE(recorder.finishedCount, 1);
+    QCOMPARE(recorder.bodies, bodies);
+    QCOMPARE(recorder.contentTypes, contentTypes);
+    if (error == QHttpMultiPartReader::NoError) {
+        QVERIFY(reader.atEnd());
+        QVERIFY(!recorder.inPart);
+        QCOMPARE(reader.partCount(), bodies.size());
+    } else {
+        QVERIFY(!reader.atEnd());
+        QVERIFY(!reader.errorString().isEmpty());
+    }
+
+    // nothing is reported once the reader stopped
+    reader.addData("\r\n--b\r\n\r\nmore\r\n--b--");
+    QCOMPARE(recorder.finishedCount, 1);
+    QCOMPARE(recorder.bodies, bodies);
+}
+
+void tst_QHttpNetworkConnection::multiPartReaderMissingBoundary()
+{
+    QHttpMultiPartReader reader;
+    MultiPartRecorder recorder(&reader);
+
+    reader.addData("--b\r\n\r\nbody\r\n--b--");
+    QCOMPARE(reader.error(), QHttpMultiPartReader::MissingBoundaryError);
+    QCOMPARE(recorder.finishedCount, 1);
+    QVERIFY(recorder.bodies.isEmpty());
+}
+
+void tst_QHttpNetworkConnection::multiPartReaderPrematureEnd()
+{
+    QBuffer buffer;
+    buffer.setData("--b\r\n\r\nfirst\r\n--b\r\n\r\nsecond, cut short");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QHttpMultiPartReader reader(&buffer);
+    reader.setBoundary("b");
+    QCOMPARE(reader.device(), static_cast<QIODevice *>(&buffer));
+    MultiPartRecorder recorder(&reader);
+
+    // the available data is read once the event loop runs
+    QVERIFY(recorder.bodies.isEmpty());
+    QTRY_COMPARE(recorder.bodies.size(), 2);
+    QCOMPARE(recorder.bodies.at(0), QByteArray("first"));
+    QCOMPARE(recorder.finishedCount, 0);
+
+    emit buffer.readChannelFinished();
+    QCOMPARE(reader.error(), QHttpMultiPartReader::PrematureEndError);
+    QCOMPARE(recorder.finishedCount, 1);
+    QCOMPARE(recorder.bodies.at(1), QByteArray("second, cut short"));
+}
+
+void tst_QHttpNetworkConnection::partContentRange_data()
+{
+    QTest::addColumn<QByteArray>("contentRange");
+    QTest::addColumn<bool>("ok");
+    QTest::addColumn<qint64>("first");
+    QTest::addColumn<qint64>("last");
+    QTest::addColumn<qint64>("completeLength");
+
+    QTest::newRow("simple") << QByteArray("bytes 0-99/200") << true << qint64(0) << qint64(99) << qint64(200);
+    QTest::newRow("unknown-length") << QByteArray("bytes 100-199/*") << true << qint64(100) << qint64(199) << qint64(-1);
+    QTest::newRow("blanks") << QByteArray("Bytes  5 - 9 / 10") << true << qint64(5) << qint64(9) << qint64(10);
+    QTest::newRow("large") << QByteArray("bytes 4294967296-4294967297/8589934592") << true
+                           << Q_INT64_C(4294967296) << Q_INT64_C(4294967297) << Q_INT64_C(8589934592);
+    QTest::newRow("reversed") << QByteArray("bytes 100-99/200") << false << qint64(0) << qint64(0) << qint64(0);
+    QTest::newRow("past-end") << QByteArray("bytes 0-200/200") << false << qint64(0) << qint64(0) << qint64(0);
+    QTest::newRow("unsatisfied") << QByteArray("bytes */200") << false << qint64(0) << qint64(0) << qint64(0);
+    QTest::newRow("other-unit") << QByteArray("items 0-1/2") << false << qint64(0) << qint64(0) << qint64(0);
+    QTest::newRow("no-slash") << QByteArray("bytes 0-1") << false << qint64(0) << qint64(0) << qint64(0);
+    QTest::newRow("missing") << QByteArray() << false << qint64(0) << qint64(0) << qint64(0);
+}
+
+void tst_QHttpNetworkConnection::partContentRange()
+{
+    QFETCH(QByteArray, contentRange);
+    QFETCH(bool, ok);
+
+    QByteArray message("--b\r\n");
+    if (!contentRange.isNull())
+        message += "Content-Range: " + contentRange + "\r\n";
+    message += "\r\nbody";
+
+    QHttpMultiPartReader reader;
+    reader.setBoundary("b");
+    reader.addData(message);
+    QCOMPARE(reader.partCount(), 1);
+
+    qint64 first = 0;
+    qint64 last = 0;
+    qint64 completeLength = 0;
+    QCOMPARE(reader.partContentRange(&first, &last, &completeLength), ok);
+    if (ok) {
+        QTEST(first, "first");
+        QTEST(last, "last");
+        QTEST(completeLength, "completeLength");
+    }
+}
+
 
 QTEST_MAIN(tst_QHttpNetworkConnection)
 #include "tst_qhttpnetworkconnection.moc"
@@ -0,0 +1,7 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qnetworkaccessmanager
+SOURCES  += tst_qnetworkaccessmanager.cpp
+TESTDATA += ../../../../shared/certs/*
+
+QT = core network network-private testlib
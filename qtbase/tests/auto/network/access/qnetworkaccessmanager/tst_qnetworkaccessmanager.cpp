@@ -0,0 +1,299 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkReplyMetrics>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#ifndef QT_NO_SSL
+#include <QtNetwork/QSslConfiguration>
+#include <QtNetwork/QSslKey>
+#include <QtNetwork/QSslSocket>
+#endif
+#ifndef QT_NO_OPENSSL
+#include <QtNetwork/private/qsslsessioncache_openssl_p.h>
+#endif
+
+// Answers every request on a persistent connection and counts the
+// connections it accepted. Connections are encrypted when the server has
+// a certificate.
+class MiniHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    MiniHttpServer() : connections(0) { listen(); }
+
+    int connections;
+#ifndef QT_NO_SSL
+    QSslCertificate certificate;
+    QSslKey key;
+#endif
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+#ifndef QT_NO_SSL
+        QSslSocket *socket = new QSslSocket(this);
+#else
+        QTcpSocket *socket = new QTcpSocket(this);
+#endif
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        ++connections;
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+#ifndef QT_NO_SSL
+        if (!certificate.isNull()) {
+            socket->setLocalCertificate(certificate);
+            socket->setPrivateKey(key);
+            socket->setPeerVerifyMode(QSslSocket::VerifyNone);
+            socket->startServerEncryption();
+        }
+#endif
+    }
+
+private slots:
+    void readRequest()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = buffers[socket];
+        buffer += socket->readAll();
+
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            buffer.remove(0, end + 4);
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nhello");
+        }
+    }
+
+private:
+    QHash<QTcpSocket *, QByteArray> buffers;
+};
+
+class tst_QNetworkAccessManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void sharedConnectionPool_data();
+    void sharedConnectionPool();
+#ifndef QT_NO_SSL
+    void encryptedConnectionsPerManager();
+    void ignoredSslErrorsPerManager();
+    void connectionsPerSslConfiguration();
+#endif
+
+private:
+    QNetworkReply *get(QNetworkAccessManager *manager, const QNetworkRequest &request,
+                       bool ignoreSslErrors = false);
+
+    MiniHttpServer server;
+#ifndef QT_NO_SSL
+    MiniHttpServer sslServer;
+    QSslConfiguration trustingConfiguration;
+#endif
+};
+
+QNetworkReply *tst_QNetworkAccessManager::get(QNetworkAccessManager *manager,
+                                              const QNetworkRequest &request,
+                                              bool ignoreSslErrors)
+{
+    QNetworkReply *reply = manager->get(request);
+#ifndef QT_NO_SSL
+    if (ignoreSslErrors)
+        reply->ignoreSslErrors();
+#else
+    Q_UNUSED(ignoreSslErrors);
+#endif
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+    if (!reply->isFinished() && !finishedSpy.wait(10000))
+        qWarning("reply for %s did not finish", qPrintable(request.url().toString()));
+    return reply;
+}
+
+void tst_QNetworkAccessManager::initTestCase()
+{
+    QVERIFY(server.isListening());
+#ifndef QT_NO_SSL
+    QVERIFY(sslServer.isListening());
+    if (!QSslSocket::supportsSsl())
+        return;
+
+    QFile certificateFile(QFINDTESTDATA("../../../../shared/certs/server.pem"));
+    QFile keyFile(QFINDTESTDATA("../../../../shared/certs/server.key"));
+    QVERIFY(certificateFile.open(QIODevice::ReadOnly));
+    QVERIFY(keyFile.open(QIODevice::ReadOnly));
+    sslServer.certificate = QSslCertificate(&certificateFile);
+    sslServer.key = QSslKey(&keyFile, QSsl::Rsa);
+    QVERIFY(!sslServer.certificate.isNull());
+    QVERIFY(!sslServer.key.isNull());
+
+    // the certificate is issued to localhost, so trusting it is all it takes
+    trustingConfiguration = QSslConfiguration::defaultConfiguration();
+    trustingConfiguration.setCaCertificates(QList<QSslCertificate>() << sslServer.certificate);
+#endif
+}
+
+void tst_QNetworkAccessManager::init()
+{
+    server.connections = 0;
+#ifndef QT_NO_SSL
+    sslServer.connections = 0;
+#endif
+#ifndef QT_NO_OPENSSL
+    QSslSessionCache::clear();
+    QSslSessionCache::resetStatistics();
+#endif
+}
+
+void tst_QNetworkAccessManager::sharedConnectionPool_data()
+{
+    QTest::addColumn<bool>("shared");
+    QTest::addColumn<int>("connections");
+
+    QTest::newRow("separate") << false << 2;
+    QTest::newRow("shared") << true << 1;
+}
+
+void tst_QNetworkAccessManager::sharedConnectionPool()
+{
+    QFETCH(bool, shared);
+    QFETCH(int, connections);
+
+    QNetworkAccessManager first;
+    QNetworkAccessManager second;
+    first.setSharedConnectionPoolEnabled(shared);
+    second.setSharedConnectionPoolEnabled(shared);
+    QCOMPARE(second.isSharedConnectionPoolEnabled(), shared);
+
+    const QNetworkRequest request(QUrl(QStringLiteral("http://localhost:%1/").arg(server.serverPort())));
+    QScopedPointer<QNetworkReply> firstReply(get(&first, request));
+    QCOMPARE(firstReply->error(), QNetworkReply::NoError);
+    QScopedPointer<QNetworkReply> secondReply(get(&second, request));
+    QCOMPARE(secondReply->error(), QNetworkReply::NoError);
+    QCOMPARE(secondReply->readAll(), QByteArray("hello"));
+
+    QCOMPARE(secondReply->metrics().isConnectionReused(), shared);
+    QCOMPARE(server.connections, connections);
+}
+
+#ifndef QT_NO_SSL
+void tst_QNetworkAccessManager::encryptedConnectionsPerManager()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+
+    QNetworkAccessManager first;
+    QNetworkAccessManager second;
+    first.setSharedConnectionPoolEnabled(true);
+    second.setSharedConnectionPoolEnabled(true);
+
+    QNetworkRequest request(QUrl(QStringLiteral("https://localhost:%1/").arg(sslServer.serverPort())));
+    request.setSslConfiguration(trustingConfiguration);
+    QScopedPointer<QNetworkReply> firstReply(get(&first, request));
+    QCOMPARE(firstReply->error(), QNetworkReply::NoError);
+    QScopedPointer<QNetworkReply> secondReply(get(&second, request));
+    QCOMPARE(secondReply->error(), QNetworkReply::NoError);
+
+    // the connection stays with its manager, but its session does not
+    QVERIFY(!secondReply->metrics().isConnectionReused());
+    QCOMPARE(sslServer.connections, 2);
+#ifndef QT_NO_OPENSSL
+    const QSslSessionCache::Statistics statistics = QSslSessionCache::statistics();
+    QCOMPARE(statistics.fullHandshakes, Q_INT64_C(1));
+    QCOMPARE(statistics.resumedHandshakes, Q_INT64_C(1));
+#endif
+
+    // requests of the same manager keep using its connection
+    QScopedPointer<QNetworkReply> thirdReply(get(&second, request));
+    QCOMPARE(thirdReply->error(), QNetworkReply::NoError);
+    QVERIFY(thirdReply->metrics().isConnectionReused());
+    QCOMPARE(sslServer.connections, 2);
+}
+
+void tst_QNetworkAccessManager::ignoredSslErrorsPerManager()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+
+    QNetworkAccessManager lenient;
+    QNetworkAccessManager strict;
+    lenient.setSharedConnectionPoolEnabled(true);
+    strict.setSharedConnectionPoolEnabled(true);
+
+    // the default configuration does not trust the test certificate
+    const QNetworkRequest request(QUrl(QStringLiteral("https://localhost:%1/").arg(sslServer.serverPort())));
+    QScopedPointer<QNetworkReply> lenientReply(get(&lenient, request, true));
+    QCOMPARE(lenientReply->error(), QNetworkReply::NoError);
+
+    QScopedPointer<QNetworkReply> strictReply(get(&strict, request));
+    QCOMPARE(strictReply->error(), QNetworkReply::SslHandshakeFailedError);
+    QCOMPARE(sslServer.connections, 2);
+}
+
+void tst_QNetworkAccessManager::connectionsPerSslConfiguration()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+
+    QNetworkAccessManager manager;
+    const QUrl url(QStringLiteral("https://localhost:%1/").arg(sslServer.serverPort()));
+    QNetworkRequest trusting(url);
+    trusting.setSslConfiguration(trustingConfiguration);
+    const QNetworkRequest untrusting(url);
+
+    QScopedPointer<QNetworkReply> first(get(&manager, trusting));
+    QCOMPARE(first->error(), QNetworkReply::NoError);
+
+    // a request that does not accept the certificate gets a connection of its own
+    QScopedPointer<QNetworkReply> second(get(&manager, untrusting));
+    QCOMPARE(second->error(), QNetworkReply::SslHandshakeFailedError);
+    QCOMPARE(sslServer.connections, 2);
+
+    QScopedPointer<QNetworkReply> third(get(&manager, trusting));
+    QCOMPARE(third->error(), QNetworkReply::NoError);
+    QVERIFY(third->metrics().isConnectionReused());
+    QCOMPARE(sslServer.connections, 2);
+}
+#endif // QT_NO_SSL
+
+QTEST_MAIN(tst_QNetworkAccessManager)
+
+#include "tst_qnetworkaccessmanager.moc"
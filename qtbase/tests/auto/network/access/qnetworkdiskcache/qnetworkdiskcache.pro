@@ -0,0 +1,6 @@
+CONFIG += testcase
+CONFIG += parallel_test
+QT -= gui
+QT += network testlib
+TARGET = tst_qnetworkdiskcache
+SOURCES  += tst_qnetworkdiskcache.cpp
@@ -0,0 +1,368 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtNetwork/qnetworkdiskcache.h>
+
+class tst_QNetworkDiskCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void indexReload_data();
+    void indexReload();
+    void rebuildIndex_data();
+    void rebuildIndex();
+    void expireLeastRecentlyUsed();
+    void pendingWrites_data();
+    void pendingWrites();
+    void oldVersionRemoved();
+
+private:
+    QNetworkDiskCache *createCache();
+    void insert(QNetworkDiskCache *cache, const QUrl &url, const QByteArray &data);
+    static QByteArray read(QNetworkDiskCache *cache, const QUrl &url);
+    QString dataDirectory() const;
+    QString cacheFile(const QUrl &url) const;
+    qint64 sizeOnDisk() const;
+
+    QTemporaryDir *m_dir;
+    bool m_compressed;
+};
+
+static QUrl url(int i)
+{
+    return QUrl(QString("http://localhost/%1").arg(i));
+}
+
+void tst_QNetworkDiskCache::init()
+{
+    m_dir = new QTemporaryDir;
+    QVERIFY(m_dir->isValid());
+    m_compressed = false;
+}
+
+void tst_QNetworkDiskCache::cleanup()
+{
+    delete m_dir;
+    m_dir = 0;
+}
+
+QNetworkDiskCache *tst_QNetworkDiskCache::createCache()
+{
+    QNetworkDiskCache *cache = new QNetworkDiskCache;
+    cache->setCacheDirectory(m_dir->path());
+    return cache;
+}
+
+void tst_QNetworkDiskCache::insert(QNetworkDiskCache *cache, const QUrl &url, const QByteArray &data)
+{
+    // small text is compressed and written on the writer thread, everything
+    // else is written to a temporary file first
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(url);
+    QNetworkCacheMetaData::RawHeaderList headers;
+    headers << qMakePair(QByteArray("Content-Type"),
+                         QByteArray(m_compressed ? "text/plain" : "application/octet-stream"))
+            << qMakePair(QByteArray("Content-Length"), QByteArray::number(data.size()));
+    metaData.setRawHeaders(headers);
+
+    QIODevice *device = cache->prepare(metaData);
+    QVERIFY(device);
+    QCOMPARE(device->write(data), qint64(data.size()));
+    cache->insert(device);
+}
+
+QByteArray tst_QNetworkDiskCache::read(QNetworkDiskCache *cache, const QUrl &url)
+{
+    QScopedPointer<QIODevice> device(cache->data(url));
+    return device ? device->readAll() : QByteArray();
+}
+
+QString tst_QNetworkDiskCache::dataDirectory() const
+{
+    return m_dir->path() + "/data9/";
+}
+
+// the file is named after the first 8 bytes of the sha1 of the url
+QString tst_QNetworkDiskCache::cacheFile(const QUrl &url) const
+{
+    const QByteArray id = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).left(8).toHex();
+    return dataDirectory() + id.left(2) + '/' + id + ".d";
+}
+
+qint64 tst_QNetworkDiskCache::sizeOnDisk() const
+{
+    qint64 size = 0;
+    QDirIterator it(dataDirectory(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        if (it.fileName().endsWith(".d"))
+            size += it.fileInfo().size();
+    }
+    return size;
+}
+
+void tst_QNetworkDiskCache::indexReload_data()
+{
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("file") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void tst_QNetworkDiskCache::indexReload()
+{
+    QFETCH(bool, compressed);
+    m_compressed = compressed;
+
+    QNetworkDiskCache *cache = createCache();
+    for (int i = 0; i < 5; ++i)
+        insert(cache, url(i), QByteArray(1000 + i, char('a' + i)));
+    // 0 becomes the most recently used
+    QCOMPARE(read(cache, url(0)), QByteArray(1000, 'a'));
+    delete cache;
+
+    // the index is saved when the cache is destroyed
+    QVERIFY(QFile::exists(dataDirectory() + "index"));
+
+    cache = createCache();
+    // and removed while the cache is in use, so that a crash cannot leave
+    // an outdated one behind
+    QVERIFY(!QFile::exists(dataDirectory() + "index"));
+    QCOMPARE(cache->cacheSize(), sizeOnDisk());
+    // read in reverse, leaving 4 the least recently used
+    for (int i = 4; i >= 0; --i) {
+        QVERIFY(cache->metaData(url(i)).isValid());
+        QCOMPARE(read(cache, url(i)), QByteArray(1000 + i, char('a' + i)));
+    }
+    QVERIFY(!cache->metaData(url(5)).isValid());
+    QVERIFY(!cache->data(url(5)));
+    delete cache;
+
+    // the order of use survives as well; without the index, the oldest
+    // file would be taken for the least recently used one
+    cache = createCache();
+    cache->setMaximumCacheSize(cache->cacheSize());
+    QVERIFY(!cache->metaData(url(4)).isValid());
+    for (int i = 0; i < 4; ++i)
+        QVERIFY(cache->metaData(url(i)).isValid());
+    delete cache;
+}
+
+void tst_QNetworkDiskCache::rebuildIndex_data()
+{
+    QTest::addColumn<QString>("damage");
+
+    QTest::newRow("missing") << "missing";
+    QTest::newRow("corrupt") << "corrupt";
+    QTest::newRow("truncated") << "truncated";
+    QTest::newRow("empty") << "empty";
+}
+
+void tst_QNetworkDiskCache::rebuildIndex()
+{
+    QFETCH(QString, damage);
+
+    QNetworkDiskCache *cache = createCache();
+    for (int i = 0; i < 5; ++i)
+        insert(cache, url(i), QByteArray(1000 + i, char('a' + i)));
+    delete cache;
+
+    QFile index(dataDirectory() + "index");
+    QVERIFY(index.exists());
+    if (damage == "missing") {
+        QVERIFY(index.remove());
+    } else if (damage == "corrupt") {
+        QVERIFY(index.open(QIODevice::WriteOnly));
+        index.write(QByteArray(100, char(0xe9)));
+        index.close();
+    } else if (damage == "truncated") {
+        QVERIFY(index.resize(index.size() / 2));
+    } else if (damage == "empty") {
+        QVERIFY(index.resize(0));
+    }
+    // a file of an insertion that never finished
+    QFile prepared(m_dir->path() + "/prepared/abcdef.d");
+    QVERIFY(prepared.open(QIODevice::WriteOnly));
+    prepared.write("partial");
+    prepared.close();
+
+    cache = createCache();
+    QCOMPARE(cache->cacheSize(), sizeOnDisk());
+    for (int i = 0; i < 5; ++i)
+        QCOMPARE(read(cache, url(i)), QByteArray(1000 + i, char('a' + i)));
+    QVERIFY(!cache->data(url(5)));
+    QVERIFY(!prepared.exists());
+
+    // new insertions are kept with the rebuilt entries
+    insert(cache, url(5), "new");
+    delete cache;
+    cache = createCache();
+    QCOMPARE(read(cache, url(5)), QByteArray("new"));
+    QCOMPARE(read(cache, url(0)), QByteArray(1000, 'a'));
+    delete cache;
+}
+
+void tst_QNetworkDiskCache::expireLeastRecentlyUsed()
+{
+    QScopedPointer<QNetworkDiskCache> cache(createCache());
+    for (int i = 0; i < 10; ++i)
+        insert(cache.data(), url(i), QByteArray(10000, char('a' + i)));
+    QTRY_COMPARE(cache->cacheSize(), sizeOnDisk());
+
+    // reading moves the first half to the end of the order
+    for (int i = 0; i < 5; ++i)
+        QVERIFY(!read(cache.data(), url(i)).isEmpty());
+
+    // expire() removes files until the cache is below 90% of the maximum,
+    // leaving room for just over five of them
+    const qint64 fileSize = cache->cacheSize() / 10;
+    cache->setMaximumCacheSize(fileSize * 6);
+    QVERIFY(cache->cacheSize() < fileSize * 6 * 9 / 10);
+    for (int i = 5; i < 10; ++i) {
+        QVERIFY(!cache->metaData(url(i)).isValid());
+        QTRY_VERIFY(!QFile::exists(cacheFile(url(i))));
+    }
+    for (int i = 0; i < 5; ++i) {
+        QVERIFY(QFile::exists(cacheFile(url(i))));
+        QCOMPARE(read(cache.data(), url(i)), QByteArray(10000, char('a' + i)));
+    }
+    QCOMPARE(cache->cacheSize(), sizeOnDisk());
+
+    // a new insertion evicts the least recently used file
+    read(cache.data(), url(0));
+    insert(cache.data(), url(10), QByteArray(10000, 'x'));
+    QVERIFY(!cache->metaData(url(1)).isValid());
+    QVERIFY(cache->metaData(url(0)).isValid());
+    QVERIFY(cache->metaData(url(10)).isValid());
+}
+
+void tst_QNetworkDiskCache::pendingWrites_data()
+{
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("file") << false;
+    QTest::newRow("compressed") << true;
+}
+
+// the files are moved into place on a background thread; whatever the cache
+// is asked right after an insertion must not depend on how far it got
+void tst_QNetworkDiskCache::pendingWrites()
+{
+    QFETCH(bool, compressed);
+    m_compressed = compressed;
+
+    QScopedPointer<QNetworkDiskCache> cache(createCache());
+    for (int i = 0; i < 50; ++i) {
+        const QByteArray data(100 + i, char('a' + i % 26));
+        insert(cache.data(), url(i), data);
+        switch (i % 4) {
+        case 0:
+            QCOMPARE(read(cache.data(), url(i)), data);
+            break;
+        case 1:
+            QCOMPARE(cache->metaData(url(i)).url(), url(i));
+            break;
+        case 2:
+            QVERIFY(cache->remove(url(i)));
+            QVERIFY(!cache->data(url(i)));
+            QVERIFY(!cache->metaData(url(i)).isValid());
+            QVERIFY(!cache->remove(url(i)));
+            break;
+        case 3:
+            // replaced before the first write is done
+            insert(cache.data(), url(i), "replaced");
+            QCOMPARE(read(cache.data(), url(i)), QByteArray("replaced"));
+            break;
+        }
+    }
+
+    // removed and then inserted again
+    QVERIFY(cache->remove(url(0)));
+    insert(cache.data(), url(0), "again");
+    QCOMPARE(read(cache.data(), url(0)), QByteArray("again"));
+
+    // and all of it as seen by the next cache
+    cache.reset(createCache());
+    QCOMPARE(cache->cacheSize(), sizeOnDisk());
+    for (int i = 1; i < 50; ++i) {
+        const QByteArray data = read(cache.data(), url(i));
+        switch (i % 4) {
+        case 2:
+            QVERIFY(data.isNull());
+            QVERIFY(!QFile::exists(cacheFile(url(i))));
+            break;
+        case 3:
+            QCOMPARE(data, QByteArray("replaced"));
+            break;
+        default:
+            QCOMPARE(data, QByteArray(100 + i, char('a' + i % 26)));
+            break;
+        }
+    }
+    QCOMPARE(read(cache.data(), url(0)), QByteArray("again"));
+}
+
+void tst_QNetworkDiskCache::oldVersionRemoved()
+{
+    QDir dir(m_dir->path());
+    QVERIFY(dir.mkpath("data8/00"));
+    QFile old(m_dir->path() + "/data8/00/0000000000000000.d");
+    QVERIFY(old.open(QIODevice::WriteOnly));
+    old.write("old");
+    old.close();
+    QVERIFY(dir.mkpath("data10"));
+    QVERIFY(dir.mkpath("database"));
+
+    QScopedPointer<QNetworkDiskCache> cache(createCache());
+    QTRY_VERIFY(!dir.exists("data8"));
+    QVERIFY(dir.exists("data9"));
+    // newer versions and other directories are left alone
+    QVERIFY(dir.exists("data10"));
+    QVERIFY(dir.exists("database"));
+
+    insert(cache.data(), url(0), "current");
+    QCOMPARE(read(cache.data(), url(0)), QByteArray("current"));
+}
+
+QTEST_MAIN(tst_QNetworkDiskCache)
+#include "tst_qnetworkdiskcache.moc"
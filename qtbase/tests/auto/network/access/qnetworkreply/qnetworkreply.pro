@@ -0,0 +1,7 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qnetworkreply
+SOURCES  += tst_qnetworkreply.cpp
+TESTDATA += ../../../../shared/certs/*
+
+QT = core network testlib
@@ -0,0 +1,350 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryFile>
+#include <QtNetwork/QAuthenticator>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkProxy>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#ifndef QT_NO_SSL
+#include <QtNetwork/QSslKey>
+#include <QtNetwork/QSslSocket>
+#endif
+
+// Keeps the body of every request it receives and answers it once the
+// body is complete. Depending on the challenge it first asks for server
+// or proxy credentials, or redirects "/upload" to "/target" with a 307.
+// Connections are encrypted when the server has a certificate.
+class UploadServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    UploadServer() { listen(); }
+
+    QByteArray challenge;
+    QList<QByteArray> bodies;
+#ifndef QT_NO_SSL
+    QSslCertificate certificate;
+    QSslKey key;
+#endif
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+#ifndef QT_NO_SSL
+        QSslSocket *socket = new QSslSocket(this);
+#else
+        QTcpSocket *socket = new QTcpSocket(this);
+#endif
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(removeConnection()));
+#ifndef QT_NO_SSL
+        if (!certificate.isNull()) {
+            socket->setLocalCertificate(certificate);
+            socket->setPrivateKey(key);
+            socket->setPeerVerifyMode(QSslSocket::VerifyNone);
+            socket->startServerEncryption();
+        }
+#endif
+    }
+
+private slots:
+    void readRequest()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = buffers[socket];
+        buffer += socket->readAll();
+
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            const QByteArray header = buffer.left(end + 2).toLower();
+            qint64 contentLength = 0;
+            const int field = header.indexOf("\r\ncontent-length:");
+            if (field != -1) {
+                const int valueStart = field + 17;
+                contentLength = header.mid(valueStart, header.indexOf("\r\n", valueStart) - valueStart)
+                        .trimmed().toLongLong();
+            }
+            if (buffer.size() < end + 4 + contentLength)
+                return; // wait for the rest of the body
+
+            bodies << buffer.mid(end + 4, contentLength);
+            buffer.remove(0, end + 4 + contentLength);
+            socket->write(response(header));
+        }
+    }
+
+    void removeConnection()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        buffers.remove(socket);
+        socket->deleteLater();
+    }
+
+private:
+    QByteArray response(const QByteArray &header) const
+    {
+        if (challenge == "401" && !header.contains("\r\nauthorization: basic "))
+            return "HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"upload\"\r\n"
+                   "Content-Length: 0\r\n\r\n";
+        if (challenge == "407" && !header.contains("\r\nproxy-authorization: basic "))
+            return "HTTP/1.1 407 Proxy Authentication Required\r\n"
+                   "Proxy-Authenticate: Basic realm=\"proxy\"\r\nContent-Length: 0\r\n\r\n";
+        if (challenge == "307" && header.contains("/upload "))
+            return "HTTP/1.1 307 Temporary Redirect\r\nLocation: /target\r\nContent-Length: 0\r\n\r\n";
+        return "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+    }
+
+    QHash<QTcpSocket *, QByteArray> buffers;
+};
+
+class tst_QNetworkReply : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void putFile_data();
+    void putFile();
+    void putFileAgain_data();
+    void putFileAgain();
+
+    void authenticate(QNetworkReply *reply, QAuthenticator *authenticator);
+    void authenticateProxy(const QNetworkProxy &proxy, QAuthenticator *authenticator);
+
+private:
+    bool createFile(const QByteArray &data);
+    QNetworkReply *put(QNetworkAccessManager *manager, const QUrl &url, QIODevice *device);
+
+    UploadServer server;
+#ifndef QT_NO_SSL
+    UploadServer sslServer;
+#endif
+    QTemporaryFile temporaryFile;
+};
+
+// Bytes that do not repeat at any power of two, so that a block sent from
+// the wrong offset does not go unnoticed
+static QByteArray uploadData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    quint32 state = 1;
+    for (int i = 0; i < size; ++i) {
+        state = state * 1103515245 + 12345;
+        data[i] = char(state >> 24);
+    }
+    return data;
+}
+
+bool tst_QNetworkReply::createFile(const QByteArray &data)
+{
+    if (!temporaryFile.open() || !temporaryFile.resize(0))
+        return false;
+    const bool written = temporaryFile.write(data) == data.size();
+    temporaryFile.close();
+    return written;
+}
+
+QNetworkReply *tst_QNetworkReply::put(QNetworkAccessManager *manager, const QUrl &url, QIODevice *device)
+{
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("application/octet-stream"));
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+    QNetworkReply *reply = manager->put(request, device);
+#ifndef QT_NO_SSL
+    reply->ignoreSslErrors();
+#endif
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+    if (!reply->isFinished() && !finishedSpy.wait(30000))
+        qWarning("reply for %s did not finish", qPrintable(url.toString()));
+    return reply;
+}
+
+void tst_QNetworkReply::authenticate(QNetworkReply *, QAuthenticator *authenticator)
+{
+    authenticator->setUser(QStringLiteral("user"));
+    authenticator->setPassword(QStringLiteral("secret"));
+}
+
+void tst_QNetworkReply::authenticateProxy(const QNetworkProxy &, QAuthenticator *authenticator)
+{
+    authenticator->setUser(QStringLiteral("proxyuser"));
+    authenticator->setPassword(QStringLiteral("secret"));
+}
+
+void tst_QNetworkReply::initTestCase()
+{
+    QVERIFY(server.isListening());
+#ifndef QT_NO_SSL
+    QVERIFY(sslServer.isListening());
+    if (QSslSocket::supportsSsl()) {
+        QFile certificateFile(QFINDTESTDATA("../../../../shared/certs/server.pem"));
+        QFile keyFile(QFINDTESTDATA("../../../../shared/certs/server.key"));
+        QVERIFY(certificateFile.open(QIODevice::ReadOnly));
+        QVERIFY(keyFile.open(QIODevice::ReadOnly));
+        sslServer.certificate = QSslCertificate(&certificateFile);
+        sslServer.key = QSslKey(&keyFile, QSsl::Rsa);
+        QVERIFY(!sslServer.certificate.isNull());
+        QVERIFY(!sslServer.key.isNull());
+    }
+#endif
+}
+
+void tst_QNetworkReply::init()
+{
+    server.challenge.clear();
+    server.bodies.clear();
+#ifndef QT_NO_SSL
+    sslServer.bodies.clear();
+#endif
+}
+
+void tst_QNetworkReply::putFile_data()
+{
+    QTest::addColumn<bool>("encrypted");
+    QTest::addColumn<bool>("textMode");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("offset");
+
+    // a plain connection sends a binary file with sendfile(), an encrypted
+    // one reads it with pread(); a text mode file is read through QIODevice
+    QTest::newRow("sendfile") << false << false << 1024 * 1024 << 0;
+    QTest::newRow("sendfile-offset") << false << false << 1024 * 1024 << 12345;
+    QTest::newRow("sendfile-socket-full") << false << false << 16 * 1024 * 1024 << 3;
+    QTest::newRow("read") << false << true << 1024 * 1024 << 0;
+    QTest::newRow("read-offset") << false << true << 1024 * 1024 << 12345;
+    QTest::newRow("read-small") << false << false << 1000 << 100;
+#ifndef QT_NO_SSL
+    QTest::newRow("pread") << true << false << 1024 * 1024 << 0;
+    QTest::newRow("pread-offset") << true << false << 1024 * 1024 << 12345;
+#endif
+}
+
+void tst_QNetworkReply::putFile()
+{
+    QFETCH(bool, encrypted);
+    QFETCH(bool, textMode);
+    QFETCH(int, size);
+    QFETCH(int, offset);
+
+    UploadServer *target = &server;
+    QString scheme = QStringLiteral("http");
+#ifndef QT_NO_SSL
+    if (encrypted) {
+        if (!QSslSocket::supportsSsl())
+            QSKIP("No SSL support");
+        target = &sslServer;
+        scheme = QStringLiteral("https");
+    }
+#else
+    Q_UNUSED(encrypted);
+#endif
+
+    const QByteArray data = uploadData(size);
+    QVERIFY(createFile(data));
+    QFile file(temporaryFile.fileName());
+    QVERIFY(file.open(textMode ? QIODevice::ReadOnly | QIODevice::Text : QIODevice::ReadOnly));
+    QVERIFY(file.seek(offset));
+
+    QNetworkAccessManager manager;
+    const QUrl url(QStringLiteral("%1://localhost:%2/upload").arg(scheme).arg(target->serverPort()));
+    QScopedPointer<QNetworkReply> reply(put(&manager, url, &file));
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    QCOMPARE(target->bodies.size(), 1);
+    QCOMPARE(target->bodies.first().size(), size - offset);
+    QVERIFY(target->bodies.first() == data.mid(offset));
+}
+
+void tst_QNetworkReply::putFileAgain_data()
+{
+    QTest::addColumn<QByteArray>("challenge");
+    QTest::addColumn<bool>("textMode");
+
+    const QList<QByteArray> challenges = QList<QByteArray>() << "401" << "407" << "307";
+    foreach (const QByteArray &challenge, challenges) {
+        QTest::newRow(QByteArray(challenge + "-file").constData()) << challenge << false;
+        QTest::newRow(QByteArray(challenge + "-read").constData()) << challenge << true;
+    }
+}
+
+void tst_QNetworkReply::putFileAgain()
+{
+    QFETCH(QByteArray, challenge);
+    QFETCH(bool, textMode);
+
+    const int size = 1024 * 1024;
+    const int offset = 4321;
+    const QByteArray data = uploadData(size);
+    QVERIFY(createFile(data));
+    QFile file(temporaryFile.fileName());
+    QVERIFY(file.open(textMode ? QIODevice::ReadOnly | QIODevice::Text : QIODevice::ReadOnly));
+    QVERIFY(file.seek(offset));
+
+    server.challenge = challenge;
+    QNetworkAccessManager manager;
+    connect(&manager, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)),
+            this, SLOT(authenticate(QNetworkReply*,QAuthenticator*)));
+    connect(&manager, SIGNAL(proxyAuthenticationRequired(QNetworkProxy,QAuthenticator*)),
+            this, SLOT(authenticateProxy(QNetworkProxy,QAuthenticator*)));
+    if (challenge == "407") {
+        // the server answers proxied requests itself
+        manager.setProxy(QNetworkProxy(QNetworkProxy::HttpProxy, QStringLiteral("127.0.0.1"),
+                                       server.serverPort()));
+    }
+
+    const QUrl url(QStringLiteral("http://localhost:%1/upload").arg(server.serverPort()));
+    QScopedPointer<QNetworkReply> reply(put(&manager, url, &file));
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+
+    // the body is sent in full both times
+    QCOMPARE(server.bodies.size(), 2);
+    QVERIFY(server.bodies.at(0) == data.mid(offset));
+    QVERIFY(server.bodies.at(1) == data.mid(offset));
+}
+
+QTEST_MAIN(tst_QNetworkReply)
+
+#include "tst_qnetworkreply.moc"
@@ -0,0 +1,6 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qnetworkreplymetrics
+SOURCES  += tst_qnetworkreplymetrics.cpp
+
+QT = core network testlib
@@ -0,0 +1,251 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkReplyMetrics>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+// Answers every request on a persistent connection; "/404" is not found.
+class MiniHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    MiniHttpServer() : bytesRead(0), bytesWritten(0) { listen(); }
+
+    qint64 bytesRead;
+    qint64 bytesWritten;
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+    }
+
+private slots:
+    void readRequest()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = buffers[socket];
+        buffer += socket->readAll();
+
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            const QByteArray request = buffer.left(end + 4);
+            buffer.remove(0, end + 4);
+            bytesRead += request.size();
+
+            const bool notFound = request.startsWith("GET /404 ");
+            const QByteArray body = notFound ? "not found" : "hello, metrics";
+            QByteArray response = notFound ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 200 OK\r\n";
+            response += "Content-Type: text/plain\r\nContent-Length: ";
+            response += QByteArray::number(body.size());
+            response += "\r\n\r\n";
+            response += body;
+            bytesWritten += socket->write(response);
+        }
+    }
+
+private:
+    QHash<QTcpSocket *, QByteArray> buffers;
+};
+
+class tst_QNetworkReplyMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void timings();
+    void bytes();
+    void connectionReuse();
+    void hostMetrics();
+    void failedRequests();
+    void nonHttpReply();
+
+private:
+    QUrl url(const QString &path = QStringLiteral("/")) const;
+    QNetworkReply *get(QNetworkAccessManager *manager, const QUrl &url);
+
+    MiniHttpServer server;
+};
+
+QUrl tst_QNetworkReplyMetrics::url(const QString &path) const
+{
+    return QUrl(QStringLiteral("http://localhost:%1%2").arg(server.serverPort()).arg(path));
+}
+
+QNetworkReply *tst_QNetworkReplyMetrics::get(QNetworkAccessManager *manager, const QUrl &url)
+{
+    QNetworkReply *reply = manager->get(QNetworkRequest(url));
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+    if (!finishedSpy.wait(10000))
+        qWarning("reply for %s did not finish", qPrintable(url.toString()));
+    return reply;
+}
+
+void tst_QNetworkReplyMetrics::initTestCase()
+{
+    QVERIFY(server.isListening());
+}
+
+void tst_QNetworkReplyMetrics::init()
+{
+    server.bytesRead = 0;
+    server.bytesWritten = 0;
+}
+
+void tst_QNetworkReplyMetrics::timings()
+{
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> reply(get(&manager, url()));
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    const QNetworkReplyMetrics metrics = reply->metrics();
+    QVERIFY(metrics.isValid());
+    QCOMPARE(metrics.protocol(), QByteArray("http/1.1"));
+    QVERIFY(!metrics.isConnectionReused());
+    QVERIFY(metrics.peerAddress().isLoopback());
+    QCOMPARE(metrics.peerPort(), server.serverPort());
+
+    // the first request waits for the host name lookup and the connection
+    QVERIFY(metrics.domainLookupStart() >= 0);
+    QVERIFY(metrics.domainLookupEnd() >= metrics.domainLookupStart());
+    QVERIFY(metrics.connectStart() >= metrics.domainLookupEnd());
+    QCOMPARE(metrics.secureConnectionStart(), Q_INT64_C(-1));
+    QVERIFY(metrics.connectEnd() >= metrics.connectStart());
+    QVERIFY(metrics.requestStart() >= metrics.connectEnd());
+    QVERIFY(metrics.responseStart() >= metrics.requestStart());
+    QVERIFY(metrics.responseEnd() >= metrics.responseStart());
+}
+
+void tst_QNetworkReplyMetrics::bytes()
+{
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> reply(get(&manager, url()));
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->readAll(), QByteArray("hello, metrics"));
+
+    const QNetworkReplyMetrics metrics = reply->metrics();
+    QCOMPARE(metrics.bytesSent(), server.bytesRead);
+    QCOMPARE(metrics.bytesReceived(), server.bytesWritten);
+}
+
+void tst_QNetworkReplyMetrics::connectionReuse()
+{
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> first(get(&manager, url()));
+    QVERIFY(first->isFinished());
+    QScopedPointer<QNetworkReply> second(get(&manager, url()));
+    QVERIFY(second->isFinished());
+
+    const QNetworkReplyMetrics metrics = second->metrics();
+    QVERIFY(metrics.isValid());
+    QVERIFY(metrics.isConnectionReused());
+    QCOMPARE(metrics.domainLookupStart(), Q_INT64_C(-1));
+    QCOMPARE(metrics.connectStart(), Q_INT64_C(-1));
+    QCOMPARE(metrics.connectEnd(), Q_INT64_C(-1));
+    QVERIFY(metrics.requestStart() >= 0);
+    QVERIFY(metrics.responseEnd() >= metrics.responseStart());
+}
+
+void tst_QNetworkReplyMetrics::hostMetrics()
+{
+    QNetworkAccessManager manager;
+    QVERIFY(manager.hostMetrics().isEmpty());
+
+    QScopedPointer<QNetworkReply> first(get(&manager, url()));
+    QScopedPointer<QNetworkReply> second(get(&manager, url()));
+    QVERIFY(second->isFinished());
+
+    const QHash<QString, QNetworkHostMetrics> hosts = manager.hostMetrics();
+    QCOMPARE(hosts.size(), 1);
+    QVERIFY(hosts.contains(QStringLiteral("localhost")));
+
+    const QNetworkHostMetrics host = hosts.value(QStringLiteral("localhost"));
+    QCOMPARE(host.requestCount(), 2);
+    QCOMPARE(host.failedRequestCount(), 0);
+    QCOMPARE(host.connectionCount(), 1);
+    QCOMPARE(host.reusedConnectionCount(), 1);
+    QCOMPARE(host.domainLookupCount(), 1);
+    QCOMPARE(host.bytesSent(), server.bytesRead);
+    QCOMPARE(host.bytesReceived(), server.bytesWritten);
+    QCOMPARE(host.bytesReceived(),
+             first->metrics().bytesReceived() + second->metrics().bytesReceived());
+    QCOMPARE(host.totalSecureConnectionTime(), Q_INT64_C(0));
+    QVERIFY(host.totalTimeToFirstByte() >= 0);
+    QVERIFY(host.totalResponseTime() >= host.totalTimeToFirstByte());
+}
+
+void tst_QNetworkReplyMetrics::failedRequests()
+{
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> reply(get(&manager, url(QStringLiteral("/404"))));
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::ContentNotFoundError);
+    QVERIFY(reply->metrics().isValid());
+    QCOMPARE(reply->metrics().bytesReceived(), server.bytesWritten);
+
+    const QNetworkHostMetrics host = manager.hostMetrics().value(QStringLiteral("localhost"));
+    QCOMPARE(host.requestCount(), 1);
+    QCOMPARE(host.failedRequestCount(), 1);
+
+    manager.clearHostMetrics();
+    QVERIFY(manager.hostMetrics().isEmpty());
+}
+
+void tst_QNetworkReplyMetrics::nonHttpReply()
+{
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> reply(manager.get(QNetworkRequest(QUrl("data:text/plain,metrics"))));
+    QTRY_VERIFY(reply->isFinished());
+
+    const QNetworkReplyMetrics metrics = reply->metrics();
+    QVERIFY(!metrics.isValid());
+    QCOMPARE(metrics.requestStart(), Q_INT64_C(-1));
+    QCOMPARE(metrics.bytesReceived(), Q_INT64_C(0));
+    QVERIFY(metrics.protocol().isEmpty());
+    QVERIFY(manager.hostMetrics().isEmpty());
+}
+
+QTEST_MAIN(tst_QNetworkReplyMetrics)
+
+#include "tst_qnetworkreplymetrics.moc"
@@ -67,7 +67,10 @@
 #endif
 
 #include <qhostinfo.h>
+#include <qendian.h>
+#include <qudpsocket.h>
 #include "private/qhostinfo_p.h"
+#include "private/qdnsresolver_p.h"
 
 #if !defined(QT_NO_GETADDRINFO)
 # if !defined(Q_OS_WINCE)
@@ -126,6 +129,15 @@ private slots:
     void cache();
 
     void abortHostLookup();
+
+    void dnsParseResponse_data();
+    void dnsParseResponse();
+    void dnsBuildQuery();
+    void dnsParseResolvConf_data();
+    void dnsParseResolvConf();
+    void dnsParseHosts();
+    void dnsResolverTransactions();
+    void dnsResolverAbort();
 protected slots:
     void resultsReady(const QHostInfo &);
 
@@ -620,5 +632,469 @@ public:
     int id;
 };
 
+// Helpers that build DNS messages for the built-in resolver tests
+
+static void appendUInt16(QByteArray *message, quint16 value)
+{
+    message->append(char(value >> 8));
+    message->append(char(value & 0xff));
+}
+
+static void appendUInt32(QByteArray *message, quint32 value)
+{
+    appendUInt16(message, quint16(value >> 16));
+    appendUInt16(message, quint16(value & 0xffff));
+}
+
+static QByteArray encodeName(const QByteArray &name)
+{
+    QByteArray encoded;
+    foreach (const QByteArray &label, name.split('.')) {
+        encoded.append(char(label.size()));
+        encoded.append(label);
+    }
+    encoded.append('\0');
+    return encoded;
+}
+
+static QByteArray dnsHeader(quint16 flags, int questions, int answers, int authorities)
+{
+    QByteArray message;
+    appendUInt16(&message, 0x1234);
+    appendUInt16(&message, flags);
+    appendUInt16(&message, quint16(questions));
+    appendUInt16(&message, quint16(answers));
+    appendUInt16(&message, quint16(authorities));
+    appendUInt16(&message, 0);
+    return message;
+}
+
+static void appendQuestion(QByteArray *message, const QByteArray &name, quint16 type)
+{
+    message->append(encodeName(name));
+    appendUInt16(message, type);
+    appendUInt16(message, 1);
+}
+
+static void appendRecord(QByteArray *message, const QByteArray &owner, quint16 type,
+                         quint32 ttl, const QByteArray &data)
+{
+    message->append(owner);
+    appendUInt16(message, type);
+    appendUInt16(message, 1);
+    appendUInt32(message, ttl);
+    appendUInt16(message, quint16(data.size()));
+    message->append(data);
+}
+
+static QByteArray soaData(quint32 minimum)
+{
+    QByteArray data(2, '\0'); // primary name server and mailbox, both the root
+    for (int i = 0; i < 4; ++i)
+        appendUInt32(&data, 3600);
+    appendUInt32(&data, minimum);
+    return data;
+}
+
+// the question name always starts right after the header
+static const QByteArray questionPointer("\xc0\x0c", 2);
+static const QByteArray address1("\x0a\x00\x00\x01", 4);
+static const QByteArray address2("\x0a\x00\x00\x02", 4);
+
+// An answer whose owner name takes \a jumps compression pointers to reach
+// the question name: the first is in the record, the others follow it.
+static QByteArray pointerChain(int jumps)
+{
+    QByteArray message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    const int owner = message.size();
+    appendRecord(&message, QByteArray(2, '\0'), QDnsResolver::A, 300, address1);
+    const int chain = message.size();
+    const int links = jumps - 1;
+    const quint16 first = 0xc000 | (links ? chain : 12);
+    message[owner] = char(first >> 8);
+    message[owner + 1] = char(first & 0xff);
+    for (int i = 0; i < links; ++i)
+        appendUInt16(&message, 0xc000 | (i + 1 < links ? chain + 2 * (i + 1) : 12));
+    return message;
+}
+
+void tst_QHostInfo::dnsParseResponse_data()
+{
+    QTest::addColumn<QByteArray>("message");
+    QTest::addColumn<bool>("ok");
+    QTest::addColumn<int>("rcode");
+    QTest::addColumn<bool>("truncated");
+    QTest::addColumn<QByteArray>("name");
+    QTest::addColumn<QStringList>("addresses");
+    QTest::addColumn<int>("ttl");
+    QTest::addColumn<int>("negativeTtl");
+
+    QByteArray message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, address1);
+    QTest::newRow("a") << message << true << 0 << false << QByteArray("www.example.com")
+                       << (QStringList() << "10.0.0.1") << 300 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "WWW.Example.COM", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, address1);
+    QTest::newRow("mixed-case") << message << true << 0 << false << QByteArray("www.example.com")
+                                << (QStringList() << "10.0.0.1") << 300 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::AAAA);
+    appendRecord(&message, questionPointer, QDnsResolver::AAAA, 60,
+                 QByteArray(15, '\0') + '\1');
+    QTest::newRow("aaaa") << message << true << 0 << false << QByteArray("www.example.com")
+                          << (QStringList() << "::1") << 60 << -1;
+
+    message = dnsHeader(0x8180, 1, 3, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, address1);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 60, address2);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 30, address1);
+    QTest::newRow("lowest-ttl-no-duplicates") << message << true << 0 << false << QByteArray("www.example.com")
+                                              << (QStringList() << "10.0.0.1" << "10.0.0.2") << 30 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::AAAA, 300, QByteArray(16, '\0'));
+    QTest::newRow("other-type") << message << true << 0 << false << QByteArray("www.example.com")
+                                << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, QByteArray(6, '\0'));
+    QTest::newRow("bad-address-length") << message << true << 0 << false << QByteArray("www.example.com")
+                                        << QStringList() << -1 << -1;
+
+    // a.example -> b.example, with the target compressed against the question
+    message = dnsHeader(0x8180, 1, 3, 0);
+    appendQuestion(&message, "a.example", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::CNAME, 100, QByteArray("\x01" "b" "\xc0\x0e", 4));
+    appendRecord(&message, encodeName("c.example"), QDnsResolver::A, 300, address1);
+    appendRecord(&message, encodeName("b.example"), QDnsResolver::A, 300, address2);
+    QTest::newRow("cname") << message << true << 0 << false << QByteArray("a.example")
+                           << (QStringList() << "10.0.0.2") << 100 << -1;
+
+    message = dnsHeader(0x8183, 1, 0, 1);
+    appendQuestion(&message, "missing.example", QDnsResolver::A);
+    appendRecord(&message, encodeName("example"), QDnsResolver::SOA, 600, soaData(30));
+    QTest::newRow("nxdomain") << message << true << 3 << false << QByteArray("missing.example")
+                              << QStringList() << -1 << 30;
+
+    message = dnsHeader(0x8180, 1, 0, 1);
+    appendQuestion(&message, "empty.example", QDnsResolver::AAAA);
+    appendRecord(&message, encodeName("example"), QDnsResolver::SOA, 10, soaData(3600));
+    QTest::newRow("nodata-soa-ttl") << message << true << 0 << false << QByteArray("empty.example")
+                                    << QStringList() << -1 << 10;
+
+    message = dnsHeader(0x8382, 1, 0, 0);
+    appendQuestion(&message, "big.example", QDnsResolver::A);
+    QTest::newRow("truncated-servfail") << message << true << 2 << true << QByteArray("big.example")
+                                        << QStringList() << -1 << -1;
+
+    QTest::newRow("32-jumps") << pointerChain(32) << true << 0 << false << QByteArray("www.example.com")
+                              << (QStringList() << "10.0.0.1") << 300 << -1;
+
+    // malformed messages
+    QTest::newRow("empty") << QByteArray() << false << 0 << false << QByteArray()
+                           << QStringList() << -1 << -1;
+    QTest::newRow("short-header") << dnsHeader(0x8180, 1, 0, 0).left(11) << false << 0 << false << QByteArray()
+                                  << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x0100, 1, 0, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    QTest::newRow("query") << message << false << 0 << false << QByteArray()
+                           << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 2, 0, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendQuestion(&message, "www.example.com", QDnsResolver::AAAA);
+    QTest::newRow("two-questions") << message << false << 0 << false << QByteArray()
+                                   << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 0, 0);
+    message += encodeName("www.example.com").left(8);
+    QTest::newRow("label-overrun") << message << false << 0 << false << QByteArray()
+                                   << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 0, 0);
+    message += QByteArray("\x41" "www", 4);
+    QTest::newRow("reserved-label-type") << message << false << 0 << false << QByteArray()
+                                         << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 0, 0);
+    message += encodeName("www.example.com");
+    appendUInt16(&message, QDnsResolver::A);
+    QTest::newRow("question-overrun") << message << false << 0 << false << QByteArray()
+                                      << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, address1);
+    message.chop(2);
+    QTest::newRow("record-overrun") << message << false << 0 << false << QByteArray()
+                                    << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 2, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, questionPointer, QDnsResolver::A, 300, address1);
+    QTest::newRow("missing-record") << message << false << 0 << false << QByteArray()
+                                    << QStringList() << -1 << -1;
+
+    // a pointer to itself, which must not loop forever
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    const int owner = message.size();
+    appendRecord(&message, QByteArray(2, '\0'), QDnsResolver::A, 300, address1);
+    message[owner] = char(0xc0 | (owner >> 8));
+    message[owner + 1] = char(owner & 0xff);
+    QTest::newRow("pointer-loop") << message << false << 0 << false << QByteArray()
+                                  << QStringList() << -1 << -1;
+
+    message = dnsHeader(0x8180, 1, 1, 0);
+    appendQuestion(&message, "www.example.com", QDnsResolver::A);
+    appendRecord(&message, QByteArray("\xc0", 1), QDnsResolver::A, 300, address1);
+    message.truncate(message.size() - 14);
+    QTest::newRow("truncated-pointer") << message << false << 0 << false << QByteArray()
+                                       << QStringList() << -1 << -1;
+
+    QTest::newRow("33-jumps") << pointerChain(33) << false << 0 << false << QByteArray()
+                              << QStringList() << -1 << -1;
+}
+
+void tst_QHostInfo::dnsParseResponse()
+{
+    QFETCH(QByteArray, message);
+    QFETCH(bool, ok);
+
+    QDnsResolver::Response response;
+    QCOMPARE(QDnsResolver::parseResponse(message, &response), ok);
+    if (!ok)
+        return;
+
+    QFETCH(int, rcode);
+    QFETCH(bool, truncated);
+    QFETCH(QByteArray, name);
+    QFETCH(QStringList, addresses);
+    QFETCH(int, ttl);
+    QFETCH(int, negativeTtl);
+
+    QCOMPARE(response.id, quint16(0x1234));
+    QCOMPARE(response.rcode, rcode);
+    QCOMPARE(response.truncated, truncated);
+    QCOMPARE(response.name, name);
+    QStringList actualAddresses;
+    foreach (const QHostAddress &address, response.addresses)
+        actualAddresses << address.toString();
+    QCOMPARE(actualAddresses, addresses);
+    QCOMPARE(response.ttl, ttl);
+    QCOMPARE(response.negativeTtl, negativeTtl);
+}
+
+void tst_QHostInfo::dnsBuildQuery()
+{
+    QByteArray expected = dnsHeader(0x0100, 1, 0, 0);
+    appendQuestion(&expected, "www.example.com", QDnsResolver::AAAA);
+    QCOMPARE(QDnsResolver::buildQuery(0x1234, "www.example.com", QDnsResolver::AAAA), expected);
+
+    // empty labels are dropped
+    expected = dnsHeader(0x0100, 1, 0, 0);
+    appendQuestion(&expected, "example.com", QDnsResolver::A);
+    QCOMPARE(QDnsResolver::buildQuery(0x1234, "example..com.", QDnsResolver::A), expected);
+}
+
+void tst_QHostInfo::dnsParseResolvConf_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QStringList>("nameservers");
+    QTest::addColumn<QStringList>("searchDomains");
+    QTest::addColumn<int>("ndots");
+    QTest::addColumn<int>("timeout");
+    QTest::addColumn<int>("attempts");
+
+    QTest::newRow("empty") << QByteArray() << QStringList() << QStringList() << 1 << 5000 << 2;
+    QTest::newRow("nameservers")
+        << QByteArray("nameserver 192.0.2.1\n"
+                      "  nameserver\t2001:db8::1  \n"
+                      "nameserver not-an-address\n"
+                      "nameserver\n")
+        << (QStringList() << "192.0.2.1" << "2001:db8::1") << QStringList() << 1 << 5000 << 2;
+    QTest::newRow("comments")
+        << QByteArray("# nameserver 192.0.2.1\n"
+                      "; nameserver 192.0.2.2\n"
+                      "nameserver 192.0.2.3 # trailing\n"
+                      "nameserver 192.0.2.4; trailing\n")
+        << (QStringList() << "192.0.2.3" << "192.0.2.4") << QStringList() << 1 << 5000 << 2;
+    QTest::newRow("search")
+        << QByteArray("search a.example b.example\nsearch c.example d.example\n")
+        << QStringList() << (QStringList() << "c.example" << "d.example") << 1 << 5000 << 2;
+    QTest::newRow("domain")
+        << QByteArray("domain a.example\n")
+        << QStringList() << (QStringList() << "a.example") << 1 << 5000 << 2;
+    QTest::newRow("domain-and-search")
+        << QByteArray("search b.example\ndomain a.example\n")
+        << QStringList() << (QStringList() << "b.example") << 1 << 5000 << 2;
+    QTest::newRow("options")
+        << QByteArray("options ndots:3 timeout:2 attempts:4 rotate\n")
+        << QStringList() << QStringList() << 3 << 2000 << 4;
+    QTest::newRow("options-clamped")
+        << QByteArray("options ndots:20 timeout:0 attempts:9\n")
+        << QStringList() << QStringList() << 15 << 1000 << 5;
+    QTest::newRow("options-invalid")
+        << QByteArray("options ndots:x timeout: attempts\n")
+        << QStringList() << QStringList() << 1 << 5000 << 2;
+}
+
+void tst_QHostInfo::dnsParseResolvConf()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QStringList, nameservers);
+    QFETCH(QStringList, searchDomains);
+
+    QDnsResolver::Configuration configuration;
+    QDnsResolver::parseResolvConf(data, &configuration);
+
+    QStringList actualNameservers;
+    foreach (const QDnsResolver::Nameserver &nameserver, configuration.nameservers) {
+        QCOMPARE(nameserver.port, quint16(53));
+        actualNameservers << nameserver.address.toString();
+    }
+    QCOMPARE(actualNameservers, nameservers);
+    QCOMPARE(configuration.searchDomains, searchDomains);
+    QTEST(configuration.ndots, "ndots");
+    QTEST(configuration.timeout, "timeout");
+    QTEST(configuration.attempts, "attempts");
+}
+
+void tst_QHostInfo::dnsParseHosts()
+{
+    QDnsResolver::Configuration configuration;
+    QDnsResolver::parseHosts("127.0.0.1\tlocalhost\n"
+                             "::1 localhost ip6-localhost # comment\n"
+                             "# 192.0.2.9 commented.example\n"
+                             "192.0.2.1 Host.Example host\n"
+                             "192.0.2.1 host.example\n"
+                             "not-an-address broken.example\n"
+                             "192.0.2.2\n",
+                             &configuration);
+
+    QCOMPARE(configuration.hosts.size(), 4);
+    QCOMPARE(configuration.hosts.value("localhost"),
+             QList<QHostAddress>() << QHostAddress("127.0.0.1") << QHostAddress("::1"));
+    QCOMPARE(configuration.hosts.value("ip6-localhost"), QList<QHostAddress>() << QHostAddress("::1"));
+    QCOMPARE(configuration.hosts.value("host.example"), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+    QCOMPARE(configuration.hosts.value("host"), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+}
+
+static void readDatagrams(QUdpSocket *socket, QVector<QUdpSocket::Datagram> *datagrams)
+{
+    QVector<QUdpSocket::Datagram> batch;
+    const int count = socket->readDatagrams(batch, 16, 512);
+    for (int i = 0; i < count; ++i)
+        *datagrams << batch.at(i);
+}
+
+static QByteArray answerTo(const QByteArray &query, quint16 id, const QByteArray &address)
+{
+    QByteArray message = query;
+    message[0] = char(id >> 8);
+    message[1] = char(id & 0xff);
+    message[2] = char(0x81);
+    message[3] = char(0x80);
+    message[7] = address.isEmpty() ? 0 : 1;
+    if (!address.isEmpty())
+        appendRecord(&message, questionPointer, QDnsResolver::A, 300, address);
+    return message;
+}
+
+void tst_QHostInfo::dnsResolverTransactions()
+{
+    QUdpSocket server;
+    QVERIFY(server.bind(QHostAddress(QHostAddress::LocalHost), 0));
+    QUdpSocket forger;
+    QVERIFY(forger.bind(QHostAddress(QHostAddress::LocalHost), 0));
+
+    QDnsResolver resolver;
+    QDnsResolver::Configuration configuration;
+    configuration.nameservers << QDnsResolver::Nameserver(QHostAddress(QHostAddress::LocalHost),
+                                                          server.localPort());
+    configuration.timeout = 30000;
+    resolver.setConfiguration(configuration);
+
+    QHostInfo info;
+    bool done = false;
+    QHostInfoResult *result = new QHostInfoResult;
+    connect(result, &QHostInfoResult::resultsReady, [&](const QHostInfo &resultInfo) {
+        info = resultInfo;
+        done = true;
+    });
+    resolver.lookup("transactions.example.", 1, result);
+
+    // the A and AAAA queries come from sockets of their own
+    QVector<QUdpSocket::Datagram> queries;
+    QTRY_VERIFY((readDatagrams(&server, &queries), queries.size() >= 2));
+    QCOMPARE(queries.size(), 2);
+    QVERIFY(queries.at(0).port != queries.at(1).port);
+
+    const QByteArray forged("\x06\x06\x06\x06", 4);
+    foreach (const QUdpSocket::Datagram &query, queries) {
+        const quint16 id = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(query.data.constData()));
+        QVERIFY(id != 0);
+        const quint16 type = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(query.data.constData())
+                                                     + query.data.size() - 4);
+        const bool isA = type == QDnsResolver::A;
+
+        // a wrong ID from the server, and the right ID from elsewhere
+        server.writeDatagram(answerTo(query.data, quint16(id + 1), isA ? forged : QByteArray()),
+                             query.address, query.port);
+        forger.writeDatagram(answerTo(query.data, id, isA ? forged : QByteArray()),
+                             query.address, query.port);
+        server.writeDatagram(answerTo(query.data, id, isA ? address1 : QByteArray()),
+                             query.address, query.port);
+    }
+
+    QTRY_VERIFY(done);
+    QCOMPARE(info.lookupId(), 1);
+    QCOMPARE(info.error(), QHostInfo::NoError);
+    QCOMPARE(info.addresses(), QList<QHostAddress>() << QHostAddress("10.0.0.1"));
+}
+
+void tst_QHostInfo::dnsResolverAbort()
+{
+    QDnsResolver resolver;
+    QDnsResolver::Configuration configuration;
+    configuration.nameservers << QDnsResolver::Nameserver(QHostAddress(QHostAddress::LocalHost));
+    configuration.hosts.insert("static.example", QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+    resolver.setConfiguration(configuration);
+
+    // aborting a lookup the resolver does not know of has no lasting effect
+    resolver.abort(4711);
+    QHostInfo info;
+    bool done = false;
+    QHostInfoResult *result = new QHostInfoResult;
+    connect(result, &QHostInfoResult::resultsReady, [&](const QHostInfo &resultInfo) {
+        info = resultInfo;
+        done = true;
+    });
+    resolver.lookup("static.example", 4711, result);
+    QTRY_VERIFY(done);
+    QCOMPARE(info.lookupId(), 4711);
+    QCOMPARE(info.addresses(), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+
+    // an aborted pending lookup is not reported
+    done = false;
+    QPointer<QHostInfoResult> abortedResult = new QHostInfoResult;
+    connect(abortedResult.data(), &QHostInfoResult::resultsReady, [&](const QHostInfo &) {
+        done = true;
+    });
+    resolver.lookup("static.example", 4712, abortedResult);
+    resolver.abort(4712);
+    QTRY_VERIFY(abortedResult.isNull());
+    QVERIFY(!done);
+}
+
 QTEST_MAIN(tst_QHostInfo)
 #include "tst_qhostinfo.moc"
@@ -118,6 +118,11 @@ private slots:
     void readyReadForEmptyDatagram();
     void asyncReadDatagram();
     void writeInHostLookupState();
+    void batchLoop_data();
+    void batchLoop();
+    void readDatagramsTruncated();
+    void readDatagramsArguments();
+    void reusePortHint();
 
 protected slots:
     void empty_readyReadSlot();
@@ -1752,5 +1757,188 @@ void tst_QUdpSocket::writeInHostLookupState()
     QVERIFY(!socket.putChar('0'));
 }
 
+void tst_QUdpSocket::batchLoop_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("maxCount");
+
+    QTest::newRow("one") << 1 << 1;
+    QTest::newRow("fewer-than-maxCount") << 10 << 64;
+    QTest::newRow("several-reads") << 100 << 16;
+    // more than the 64 datagrams one recvmmsg()/sendmmsg() call moves
+    QTest::newRow("several-system-calls") << 150 << 100;
+}
+
+void tst_QUdpSocket::batchLoop()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QFETCH(int, count);
+    QFETCH(int, maxCount);
+
+    QUdpSocket receiver;
+    QUdpSocket sender;
+#ifdef FORCE_SESSION
+    receiver.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    sender.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QVERIFY2(receiver.bind(QHostAddress(QHostAddress::LocalHost), 0), receiver.errorString().toLatin1().constData());
+    QVERIFY2(sender.bind(QHostAddress(QHostAddress::LocalHost), 0), sender.errorString().toLatin1().constData());
+    // make room for the whole batch, nothing reads before it is sent
+    receiver.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 1024 * 1024);
+
+    // distinct payloads of varying sizes, including an empty one
+    QVector<QUdpSocket::Datagram> outgoing;
+    for (int i = 0; i < count; ++i)
+        outgoing << QUdpSocket::Datagram(QByteArray(i % 7 * 100, char('a' + i % 26)) + QByteArray::number(i),
+                                         QHostAddress::LocalHost, receiver.localPort());
+    outgoing[0].data.clear();
+
+    QSignalSpy bytesWrittenSpy(&sender, SIGNAL(bytesWritten(qint64)));
+    QCOMPARE(sender.writeDatagrams(outgoing), count);
+    QCOMPARE(bytesWrittenSpy.count(), 1);
+    qint64 totalSize = 0;
+    foreach (const QUdpSocket::Datagram &datagram, outgoing)
+        totalSize += datagram.data.size();
+    QCOMPARE(bytesWrittenSpy.at(0).at(0).toLongLong(), totalSize);
+
+    QVector<QUdpSocket::Datagram> incoming;
+    int received = 0;
+    while (received < count) {
+        if (!receiver.hasPendingDatagrams())
+            QVERIFY2(receiver.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(receiver).constData());
+        const int n = receiver.readDatagrams(incoming, maxCount, 1024);
+        QVERIFY2(n >= 0, receiver.errorString().toLatin1().constData());
+        QVERIFY(n <= maxCount);
+        QVERIFY(incoming.size() >= maxCount);
+        for (int i = 0; i < n; ++i, ++received) {
+            QCOMPARE(incoming.at(i).data, outgoing.at(received).data);
+            QCOMPARE(incoming.at(i).address, QHostAddress(QHostAddress::LocalHost));
+            QCOMPARE(incoming.at(i).port, sender.localPort());
+        }
+    }
+    QCOMPARE(received, count);
+    QVERIFY(!receiver.hasPendingDatagrams());
+    QCOMPARE(receiver.readDatagrams(incoming, maxCount, 1024), 0);
+}
+
+void tst_QUdpSocket::readDatagramsTruncated()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QUdpSocket receiver;
+    QUdpSocket sender;
+#ifdef FORCE_SESSION
+    receiver.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    sender.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QVERIFY2(receiver.bind(QHostAddress(QHostAddress::LocalHost), 0), receiver.errorString().toLatin1().constData());
+
+    QVector<QUdpSocket::Datagram> outgoing;
+    outgoing << QUdpSocket::Datagram("0123456789", QHostAddress::LocalHost, receiver.localPort())
+             << QUdpSocket::Datagram("abc", QHostAddress::LocalHost, receiver.localPort());
+    QCOMPARE(sender.writeDatagrams(outgoing), 2);
+
+    // the rest of a datagram larger than maxSize is lost, the next one is intact
+    QVector<QUdpSocket::Datagram> incoming;
+    int received = 0;
+    while (received < 2) {
+        if (!receiver.hasPendingDatagrams())
+            QVERIFY2(receiver.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(receiver).constData());
+        const int n = receiver.readDatagrams(incoming, 2 - received, 4);
+        QVERIFY(n >= 0);
+        for (int i = 0; i < n; ++i, ++received)
+            QCOMPARE(incoming.at(i).data, outgoing.at(received).data.left(4));
+    }
+
+    // a huge maxSize is clamped rather than truncated to int
+    QCOMPARE(sender.writeDatagrams(outgoing.mid(0, 1)), 1);
+    QVERIFY2(receiver.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(receiver).constData());
+    QCOMPARE(receiver.readDatagrams(incoming, 1, Q_INT64_C(0x100000010)), 1);
+    QCOMPARE(incoming.at(0).data, outgoing.at(0).data);
+}
+
+void tst_QUdpSocket::readDatagramsArguments()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QVector<QUdpSocket::Datagram> datagrams;
+    QUdpSocket socket;
+#ifdef FORCE_SESSION
+    socket.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QTest::ignoreMessage(QtWarningMsg, "QUdpSocket::readDatagrams() called on a QUdpSocket when not in QUdpSocket::BoundState");
+    QCOMPARE(socket.readDatagrams(datagrams, 1, 1024), -1);
+    QCOMPARE(socket.writeDatagrams(datagrams), 0);
+
+    QVERIFY2(socket.bind(QHostAddress(QHostAddress::LocalHost), 0), socket.errorString().toLatin1().constData());
+    QTest::ignoreMessage(QtWarningMsg, "QUdpSocket::readDatagrams: Called with negative maxSize");
+    QCOMPARE(socket.readDatagrams(datagrams, 1, -1), -1);
+    QCOMPARE(socket.readDatagrams(datagrams, 0, 1024), 0);
+    QVERIFY(datagrams.isEmpty());
+
+    // the vector grows to maxCount, but is never shrunk
+    QCOMPARE(socket.readDatagrams(datagrams, 8, 1024), 0);
+    QCOMPARE(datagrams.size(), 8);
+    QCOMPARE(socket.readDatagrams(datagrams, 2, 1024), 0);
+    QCOMPARE(datagrams.size(), 8);
+}
+
+void tst_QUdpSocket::reusePortHint()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+#ifndef Q_OS_LINUX
+    QSKIP("SO_REUSEPORT is only tested on Linux");
+#else
+    QUdpSocket first;
+    QUdpSocket second;
+    QUdpSocket third;
+#ifdef FORCE_SESSION
+    first.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    second.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    third.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QVERIFY2(first.bind(QHostAddress(QHostAddress::LocalHost), 0, QUdpSocket::ReusePortHint),
+             first.errorString().toLatin1().constData());
+    const quint16 port = first.localPort();
+    QVERIFY2(second.bind(QHostAddress(QHostAddress::LocalHost), port, QUdpSocket::ReusePortHint),
+             second.errorString().toLatin1().constData());
+    QCOMPARE(second.localPort(), port);
+
+    // every socket sharing the port must ask for it
+    QVERIFY(!third.bind(QHostAddress(QHostAddress::LocalHost), port));
+    QCOMPARE(third.error(), QUdpSocket::AddressInUseError);
+
+    // each datagram reaches exactly one of the sockets
+    QUdpSocket sender;
+    const int count = 20;
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(sender.writeDatagram(QByteArray::number(i), QHostAddress::LocalHost, port), qint64(QByteArray::number(i).size()));
+
+    QVector<QUdpSocket::Datagram> incoming;
+    int received = 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (received < count && timer.elapsed() < 5000) {
+        QTest::qWait(10);
+        int n;
+        while ((n = first.readDatagrams(incoming, count, 64)) > 0)
+            received += n;
+        while ((n = second.readDatagrams(incoming, count, 64)) > 0)
+            received += n;
+    }
+    QCOMPARE(received, count);
+#endif
+}
+
 QTEST_MAIN(tst_QUdpSocket)
 #include "tst_qudpsocket.moc"
@@ -230,6 +230,10 @@ private slots:
     void verifyClientCertificate_data();
     void verifyClientCertificate();
     void readBufferMaxSize();
+    void encryptionOffload_data();
+    void encryptionOffload();
+    void encryptionOffloadRemoteClose_data();
+    void encryptionOffloadRemoteClose();
     void setEmptyDefaultConfiguration(); // this test should be last
 
 #ifndef QT_NO_OPENSSL
@@ -3106,6 +3110,137 @@ void tst_QSslSocket::readBufferMaxSize()
 #endif
 }
 
+void tst_QSslSocket::encryptionOffload_data()
+{
+    QTest::addColumn<bool>("offload");
+
+    QTest::newRow("inline") << false;
+    QTest::newRow("offload") << true;
+}
+
+void tst_QSslSocket::encryptionOffload()
+{
+    if (!QSslSocket::supportsSsl())
+        return;
+
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QFETCH(bool, offload);
+
+    SslServer server;
+    QVERIFY(server.listen());
+
+    QSslSocketPtr client(new QSslSocket);
+    socket = client.data();
+    connect(socket, SIGNAL(sslErrors(QList<QSslError>)), this, SLOT(ignoreErrorSlot()));
+    client->setEncryptionOffloadEnabled(offload);
+    client->connectToHostEncrypted(QHostAddress(QHostAddress::LocalHost).toString(),
+                                   server.serverPort());
+
+    QTRY_VERIFY_WITH_TIMEOUT(client->isEncrypted() && server.socket && server.socket->isEncrypted(), 5000);
+    server.socket->setEncryptionOffloadEnabled(offload);
+
+    const QSslCipher cipher = client->sessionCipher();
+    const QSsl::SslProtocol protocol = client->sessionProtocol();
+    QVERIFY(!cipher.isNull());
+    QCOMPARE(protocol, QSsl::TlsV1_0);
+
+    QSignalSpy clientWrittenSpy(client.data(), SIGNAL(bytesWritten(qint64)));
+    QSignalSpy serverWrittenSpy(server.socket, SIGNAL(bytesWritten(qint64)));
+
+    QByteArray payload(1024 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < payload.size(); ++i)
+        payload[i] = char(i % 251);
+    QCOMPARE(client->write(payload), qint64(payload.size()));
+    QCOMPARE(server.socket->write(payload), qint64(payload.size()));
+
+    QByteArray clientReceived;
+    QByteArray serverReceived;
+    QElapsedTimer stopwatch;
+    stopwatch.start();
+    while ((clientReceived.size() < payload.size() || serverReceived.size() < payload.size())
+           && stopwatch.elapsed() < 30000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents | QEventLoop::WaitForMoreEvents, 50);
+        clientReceived += client->readAll();
+        serverReceived += server.socket->readAll();
+
+        // must not race with a worker that is busy with the connection
+        QCOMPARE(client->sessionCipher(), cipher);
+        QCOMPARE(client->sessionProtocol(), protocol);
+        QCOMPARE(server.socket->sessionCipher(), cipher);
+        QCOMPARE(server.socket->sessionProtocol(), protocol);
+    }
+
+    QCOMPARE(client->state(), QAbstractSocket::ConnectedState);
+    QCOMPARE(server.socket->state(), QAbstractSocket::ConnectedState);
+    QVERIFY(clientReceived == payload);
+    QVERIFY(serverReceived == payload);
+
+    qint64 clientWritten = 0;
+    for (int i = 0; i < clientWrittenSpy.count(); ++i)
+        clientWritten += clientWrittenSpy.at(i).at(0).toLongLong();
+    qint64 serverWritten = 0;
+    for (int i = 0; i < serverWrittenSpy.count(); ++i)
+        serverWritten += serverWrittenSpy.at(i).at(0).toLongLong();
+    QCOMPARE(clientWritten, qint64(payload.size()));
+    QCOMPARE(serverWritten, qint64(payload.size()));
+}
+
+void tst_QSslSocket::encryptionOffloadRemoteClose_data()
+{
+    encryptionOffload_data();
+}
+
+void tst_QSslSocket::encryptionOffloadRemoteClose()
+{
+    if (!QSslSocket::supportsSsl())
+        return;
+
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QFETCH(bool, offload);
+
+    SslServer server;
+    QVERIFY(server.listen());
+
+    QSslSocketPtr client(new QSslSocket);
+    socket = client.data();
+    connect(socket, SIGNAL(sslErrors(QList<QSslError>)), this, SLOT(ignoreErrorSlot()));
+    client->setEncryptionOffloadEnabled(offload);
+    client->connectToHostEncrypted(QHostAddress(QHostAddress::LocalHost).toString(),
+                                   server.serverPort());
+
+    QTRY_VERIFY_WITH_TIMEOUT(client->isEncrypted() && server.socket && server.socket->isEncrypted(), 5000);
+    server.socket->setEncryptionOffloadEnabled(offload);
+
+    QSignalSpy errorSpy(client.data(), SIGNAL(error(QAbstractSocket::SocketError)));
+
+    // The close_notify alert follows the data; it has to end the
+    // connection the same way whichever thread decrypts the records.
+    const QByteArray payload(256 * 1024, 'a');
+    QCOMPARE(server.socket->write(payload), qint64(payload.size()));
+    server.socket->disconnectFromHost();
+
+    QByteArray received;
+    QElapsedTimer stopwatch;
+    stopwatch.start();
+    while (client->state() != QAbstractSocket::UnconnectedState && stopwatch.elapsed() < 10000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents | QEventLoop::WaitForMoreEvents, 50);
+        received += client->readAll();
+    }
+    received += client->readAll();
+
+    QCOMPARE(client->state(), QAbstractSocket::UnconnectedState);
+    QCOMPARE(received.size(), payload.size());
+    QVERIFY(received == payload);
+    QVERIFY(errorSpy.count() > 0);
+    QCOMPARE(client->error(), QAbstractSocket::RemoteHostClosedError);
+}
+
 void tst_QSslSocket::setEmptyDefaultConfiguration() // this test should be last, as it has some side effects
 {
     // used to produce a crash in QSslConfigurationPrivate::deepCopyDefaultConfiguration, QTBUG-13265
@@ -0,0 +1,5 @@
+CONFIG += testcase
+TARGET = tst_qpsql
+SOURCES  += tst_qpsql.cpp
+
+QT = core sql testlib
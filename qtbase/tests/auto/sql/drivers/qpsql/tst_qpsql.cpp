@@ -0,0 +1,350 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QBuffer>
+#include <QtSql/QSqlColumnBatch>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlDriver>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+
+/*
+   Runs against the PostgreSQL server that libpq finds through the PGHOST,
+   PGPORT, PGDATABASE, PGUSER and PGPASSWORD environment variables.
+*/
+class tst_QPSQL : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void singleRowMode();
+    void singleRowModeEmpty();
+    void singleRowModeInterrupted();
+    void singleRowModeAbandoned();
+    void singleRowModeAbandonedInTransaction();
+    void singleRowModeBatch();
+    void binaryResults_data();
+    void binaryResults();
+    void copy();
+    void copyFromError();
+
+private:
+    QSqlDatabase open(const QString &name, const QString &options);
+    bool copyFrom(const QSqlDatabase &db, const QString &statement, QIODevice *device);
+    bool copyTo(const QSqlDatabase &db, const QString &statement, QIODevice *device);
+
+    QSqlDatabase textDb;
+    QSqlDatabase streamDb;
+    QString table;
+};
+
+QSqlDatabase tst_QPSQL::open(const QString &name, const QString &options)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QPSQL"), name);
+    db.setConnectOptions(options);
+    if (!db.open())
+        qWarning("%s", qPrintable(db.lastError().text()));
+    return db;
+}
+
+bool tst_QPSQL::copyFrom(const QSqlDatabase &db, const QString &statement, QIODevice *device)
+{
+    bool ok = false;
+    if (!QMetaObject::invokeMethod(db.driver(), "copyFrom", Q_RETURN_ARG(bool, ok),
+                                   Q_ARG(QString, statement), Q_ARG(QIODevice*, device)))
+        return false;
+    return ok;
+}
+
+bool tst_QPSQL::copyTo(const QSqlDatabase &db, const QString &statement, QIODevice *device)
+{
+    bool ok = false;
+    if (!QMetaObject::invokeMethod(db.driver(), "copyTo", Q_RETURN_ARG(bool, ok),
+                                   Q_ARG(QString, statement), Q_ARG(QIODevice*, device)))
+        return false;
+    return ok;
+}
+
+void tst_QPSQL::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QPSQL")))
+        QSKIP("The PostgreSQL driver is not available");
+    if (qEnvironmentVariableIsEmpty("PGDATABASE"))
+        QSKIP("Set PGDATABASE to run the tests against a PostgreSQL server");
+
+    textDb = open(QStringLiteral("text"), QString());
+    QVERIFY(textDb.isOpen());
+    streamDb = open(QStringLiteral("stream"), QStringLiteral("QPSQL_SINGLE_ROW_MODE;QPSQL_BINARY_RESULTS"));
+    QVERIFY(streamDb.isOpen());
+
+    table = QString("qtest_psql_%1").arg(QCoreApplication::applicationPid());
+    QSqlQuery q(textDb);
+    QVERIFY2(q.exec(QString("CREATE TABLE %1 (id INTEGER, name VARCHAR(32))").arg(table)),
+             qPrintable(q.lastError().text()));
+}
+
+void tst_QPSQL::cleanupTestCase()
+{
+    if (textDb.isOpen())
+        QSqlQuery(textDb).exec(QString("DROP TABLE %1").arg(table));
+    textDb = QSqlDatabase();
+    streamDb = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("text"));
+    QSqlDatabase::removeDatabase(QStringLiteral("stream"));
+}
+
+void tst_QPSQL::singleRowMode()
+{
+    QSqlQuery q(streamDb);
+    q.setForwardOnly(true);
+    QVERIFY2(q.exec("SELECT i, i * 0.5::float8, 'row ' || i FROM generate_series(1, 1000) AS i"),
+             qPrintable(q.lastError().text()));
+    QVERIFY(q.isSelect());
+    QCOMPARE(q.size(), -1);
+    QCOMPARE(q.record().count(), 3);
+
+    int row = 0;
+    while (q.next()) {
+        ++row;
+        QCOMPARE(q.value(0).toInt(), row);
+        QCOMPARE(q.value(1).toDouble(), row * 0.5);
+        QCOMPARE(q.value(2).toString(), QString("row %1").arg(row));
+    }
+    QCOMPARE(row, 1000);
+    QVERIFY(!q.lastError().isValid());
+
+    // the connection is usable again
+    QVERIFY(q.exec("SELECT 42"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 42);
+    QVERIFY(!q.next());
+}
+
+void tst_QPSQL::singleRowModeEmpty()
+{
+    QSqlQuery q(streamDb);
+    q.setForwardOnly(true);
+    QVERIFY(q.exec("SELECT i FROM generate_series(1, 0) AS i"));
+    QVERIFY(q.isSelect());
+    QCOMPARE(q.record().count(), 1);
+    QVERIFY(!q.next());
+    QVERIFY(!q.lastError().isValid());
+
+    QVERIFY(!q.exec("SELECT no_such_column FROM generate_series(1, 10) AS i"));
+    QVERIFY(q.lastError().isValid());
+}
+
+void tst_QPSQL::singleRowModeInterrupted()
+{
+    QSqlQuery q(streamDb);
+    q.setForwardOnly(true);
+    QVERIFY(q.exec("SELECT i FROM generate_series(1, 1000) AS i"));
+    QVERIFY(q.next());
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 2);
+
+    // another query on the connection discards the rest of the rows
+    QSqlQuery other(streamDb);
+    QVERIFY(other.exec("SELECT 1"));
+    QVERIFY(other.next());
+
+    QCOMPARE(q.value(0).toInt(), 2);
+    QVERIFY(!q.next());
+    QVERIFY(q.lastError().isValid());
+}
+
+void tst_QPSQL::singleRowModeAbandoned()
+{
+    // the server stops sending the rows instead of the client reading them all
+    {
+        QSqlQuery q(streamDb);
+        q.setForwardOnly(true);
+        QVERIFY(q.exec("SELECT i FROM generate_series(1, 100000000) AS i"));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 1);
+    }
+
+    QSqlQuery other(streamDb);
+    QVERIFY2(other.exec("SELECT 1"), qPrintable(other.lastError().text()));
+    QVERIFY(other.next());
+    QCOMPARE(other.value(0).toInt(), 1);
+}
+
+void tst_QPSQL::singleRowModeAbandonedInTransaction()
+{
+    // cancelling would abort the transaction, so the rest is read instead
+    QVERIFY(streamDb.transaction());
+    {
+        QSqlQuery q(streamDb);
+        q.setForwardOnly(true);
+        QVERIFY(q.exec("SELECT i FROM generate_series(1, 1000) AS i"));
+        QVERIFY(q.next());
+    }
+
+    QSqlQuery other(streamDb);
+    QVERIFY2(other.exec(QString("INSERT INTO %1 VALUES (1, 'kept')").arg(table)),
+             qPrintable(other.lastError().text()));
+    QVERIFY2(streamDb.commit(), qPrintable(streamDb.lastError().text()));
+
+    QSqlQuery check(textDb);
+    QVERIFY(check.exec(QString("SELECT name FROM %1 WHERE name = 'kept'").arg(table)));
+    QVERIFY(check.next());
+    QVERIFY(check.exec(QString("DELETE FROM %1").arg(table)));
+}
+
+void tst_QPSQL::singleRowModeBatch()
+{
+    QSqlQuery q(streamDb);
+    q.setForwardOnly(true);
+    QVERIFY(q.exec("SELECT i::int8, i * 0.25::float8 FROM generate_series(1, 1000) AS i"));
+
+    QSqlColumnBatch batch;
+    int row = 0;
+    while (q.fetchBatch(&batch, 300) > 0) {
+        const QVector<qint64> ids = batch.int64Column(0);
+        const QVector<double> values = batch.doubleColumn(1);
+        for (int i = 0; i < batch.rowCount(); ++i) {
+            ++row;
+            QCOMPARE(ids.at(i), qint64(row));
+            QCOMPARE(values.at(i), row * 0.25);
+        }
+    }
+    QCOMPARE(row, 1000);
+    QVERIFY(!q.lastError().isValid());
+}
+
+void tst_QPSQL::binaryResults_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("bool") << QString("true");
+    QTest::newRow("int2") << QString("(-12)::int2");
+    QTest::newRow("int4") << QString("123456::int4");
+    QTest::newRow("int8") << QString("(-9000000000)::int8");
+    QTest::newRow("oid") << QString("42::oid");
+    QTest::newRow("float4") << QString("1.5::float4");
+    QTest::newRow("float8") << QString("(-2.25)::float8");
+    QTest::newRow("numeric") << QString("12345678.000100::numeric");
+    QTest::newRow("numeric negative") << QString("(-1.5)::numeric");
+    QTest::newRow("numeric zero") << QString("0::numeric");
+    QTest::newRow("numeric small") << QString("0.00001::numeric");
+    QTest::newRow("numeric big") << QString("100000000000000000000::numeric");
+    QTest::newRow("numeric nan") << QString("'NaN'::numeric");
+    QTest::newRow("text") << QString("'h\\u00e9llo'::text");
+    QTest::newRow("varchar") << QString("'abc'::varchar(10)");
+    QTest::newRow("bytea") << QString("'\\\\x00ff10'::bytea");
+    QTest::newRow("date") << QString("'2016-02-29'::date");
+    QTest::newRow("date before 2000") << QString("'1969-07-20'::date");
+    QTest::newRow("time") << QString("'13:14:15.678'::time");
+    QTest::newRow("timestamp") << QString("'2016-02-29 13:14:15.678'::timestamp");
+    QTest::newRow("timestamp before 2000") << QString("'1969-07-20 20:17:40'::timestamp");
+    QTest::newRow("timestamptz") << QString("'2016-02-29 13:14:15.678+02'::timestamptz");
+    QTest::newRow("null") << QString("NULL::int4");
+}
+
+void tst_QPSQL::binaryResults()
+{
+    QFETCH(QString, expression);
+
+    if (!textDb.driver()->hasFeature(QSqlDriver::PreparedQueries))
+        QSKIP("Binary results are only used for prepared queries");
+
+    const QString statement = QString("SELECT %1 WHERE 1 = ?").arg(expression);
+    QSqlQuery text(textDb);
+    QVERIFY(text.prepare(statement));
+    text.addBindValue(1);
+    QVERIFY2(text.exec(), qPrintable(text.lastError().text()));
+    QVERIFY(text.next());
+
+    QSqlQuery binary(streamDb);
+    binary.setForwardOnly(true);
+    QVERIFY(binary.prepare(statement));
+    binary.addBindValue(1);
+    QVERIFY2(binary.exec(), qPrintable(binary.lastError().text()));
+    QVERIFY(binary.next());
+
+    QCOMPARE(binary.isNull(0), text.isNull(0));
+    QCOMPARE(binary.value(0).type(), text.value(0).type());
+    QCOMPARE(binary.value(0), text.value(0));
+}
+
+void tst_QPSQL::copy()
+{
+    QSqlQuery q(textDb);
+    QVERIFY(q.exec(QString("DELETE FROM %1").arg(table)));
+
+    QByteArray data;
+    for (int i = 0; i < 10000; ++i)
+        data += QByteArray::number(i) + "\tname " + QByteArray::number(i) + '\n';
+    QBuffer source(&data);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QVERIFY2(copyFrom(textDb, QString("COPY %1 (id, name) FROM STDIN").arg(table), &source),
+             qPrintable(textDb.driver()->lastError().text()));
+
+    QVERIFY(q.exec(QString("SELECT COUNT(*), MAX(name) FROM %1").arg(table)));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 10000);
+    QCOMPARE(q.value(1).toString(), QString("name 9999"));
+
+    QBuffer target;
+    QVERIFY(target.open(QIODevice::WriteOnly));
+    QVERIFY2(copyTo(textDb, QString("COPY (SELECT id, name FROM %1 ORDER BY id) TO STDOUT").arg(table), &target),
+             qPrintable(textDb.driver()->lastError().text()));
+    QCOMPARE(target.data(), data);
+}
+
+void tst_QPSQL::copyFromError()
+{
+    QByteArray data("1\tone\nnot a number\ttwo\n");
+    QBuffer source(&data);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QVERIFY(!copyFrom(textDb, QString("COPY %1 (id, name) FROM STDIN").arg(table), &source));
+    QVERIFY(textDb.driver()->lastError().isValid());
+
+    // not a COPY statement
+    QVERIFY(!copyFrom(textDb, QString("SELECT 1"), &source));
+
+    // the connection is usable again
+    QSqlQuery q(textDb);
+    QVERIFY(q.exec("SELECT 1"));
+}
+
+QTEST_MAIN(tst_QPSQL)
+
+#include "tst_qpsql.moc"
@@ -0,0 +1,5 @@
+CONFIG += testcase
+TARGET = tst_qsqlite
+SOURCES  += tst_qsqlite.cpp
+
+QT = core sql testlib
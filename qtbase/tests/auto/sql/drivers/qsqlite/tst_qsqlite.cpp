@@ -0,0 +1,398 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlDriver>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+#include <QtSql/QSqlResult>
+
+/*
+   Covers the statement cache and the native execBatch() of the SQLite
+   driver, on in-memory databases.
+*/
+class tst_QSQLite : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void statementCache();
+    void statementCacheDisabled();
+    void sameStatementTwice_data();
+    void sameStatementTwice();
+    void reprepareAfterSchemaChange_data();
+    void reprepareAfterSchemaChange();
+    void execBatch_data();
+    void execBatch();
+    void execBatchMismatch_data();
+    void execBatchMismatch();
+    void execBatchRollback_data();
+    void execBatchRollback();
+    void execBatchInTransaction();
+    void numRowsAffected();
+
+private:
+    bool open(const QString &options);
+    int count(const QString &table);
+
+    QSqlDatabase db;
+};
+
+static void *statementHandle(const QSqlQuery &query)
+{
+    const QVariant handle = query.result()->handle();
+    return handle.isValid() ? *static_cast<void * const *>(handle.constData()) : 0;
+}
+
+bool tst_QSQLite::open(const QString &options)
+{
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("sqlite"));
+    db.setDatabaseName(QStringLiteral(":memory:"));
+    db.setConnectOptions(options);
+    if (!db.open()) {
+        qWarning("%s", qPrintable(db.lastError().text()));
+        return false;
+    }
+    QSqlQuery q(db);
+    return q.exec("CREATE TABLE items (id INTEGER PRIMARY KEY, value INTEGER)");
+}
+
+int tst_QSQLite::count(const QString &table)
+{
+    QSqlQuery q(db);
+    if (!q.exec(QString("SELECT COUNT(*) FROM %1").arg(table)) || !q.next())
+        return -1;
+    return q.value(0).toInt();
+}
+
+void tst_QSQLite::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+}
+
+void tst_QSQLite::cleanup()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("sqlite"));
+}
+
+void tst_QSQLite::statementCache()
+{
+    QVERIFY(open(QString()));
+    const QString select("SELECT value FROM items WHERE id = ?");
+
+    void *handle = 0;
+    {
+        QSqlQuery q(db);
+        QVERIFY(q.prepare(select));
+        handle = statementHandle(q);
+        QVERIFY(handle);
+    }
+
+    // the statement of the destroyed query is taken from the cache
+    QSqlQuery q(db);
+    QVERIFY(q.prepare(select));
+    QCOMPARE(statementHandle(q), handle);
+
+    // and is reset before it is handed out again
+    q.addBindValue(1);
+    QVERIFY(q.exec());
+    QVERIFY(!q.next());
+}
+
+void tst_QSQLite::statementCacheDisabled()
+{
+    QVERIFY(open(QStringLiteral("QSQLITE_STATEMENT_CACHE_SIZE=0")));
+
+    QSqlQuery insert(db);
+    QVERIFY(insert.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    for (int i = 0; i < 10; ++i) {
+        insert.addBindValue(i);
+        insert.addBindValue(i * 10);
+        QVERIFY2(insert.exec(), qPrintable(insert.lastError().text()));
+    }
+
+    // every prepare() compiles the query again
+    for (int i = 0; i < 10; ++i) {
+        QSqlQuery q(db);
+        QVERIFY(q.prepare("SELECT value FROM items WHERE id = ?"));
+        q.addBindValue(i);
+        QVERIFY(q.exec());
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), i * 10);
+        QVERIFY(!q.next());
+    }
+}
+
+void tst_QSQLite::sameStatementTwice_data()
+{
+    QTest::addColumn<QString>("options");
+
+    QTest::newRow("cache") << QString();
+    QTest::newRow("no cache") << QStringLiteral("QSQLITE_STATEMENT_CACHE_SIZE=0");
+}
+
+void tst_QSQLite::sameStatementTwice()
+{
+    QFETCH(QString, options);
+    QVERIFY(open(options));
+
+    QSqlQuery insert(db);
+    QVERIFY(insert.exec("INSERT INTO items (id, value) VALUES (1, 10)"));
+    QVERIFY(insert.exec("INSERT INTO items (id, value) VALUES (2, 20)"));
+
+    // a statement in use is never handed out a second time
+    const QString select("SELECT value FROM items ORDER BY id");
+    QSqlQuery first(db);
+    QSqlQuery second(db);
+    QVERIFY(first.exec(select));
+    QVERIFY(first.next());
+    QVERIFY(second.exec(select));
+    QVERIFY(statementHandle(first) != statementHandle(second));
+    QVERIFY(second.next());
+    QVERIFY(second.next());
+    QCOMPARE(second.value(0).toInt(), 20);
+    QCOMPARE(first.value(0).toInt(), 10);
+    QVERIFY(first.next());
+    QCOMPARE(first.value(0).toInt(), 20);
+}
+
+void tst_QSQLite::reprepareAfterSchemaChange_data()
+{
+    sameStatementTwice_data();
+}
+
+void tst_QSQLite::reprepareAfterSchemaChange()
+{
+    QFETCH(QString, options);
+    QVERIFY(open(options));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE shape (a INTEGER)"));
+    QVERIFY(q.exec("INSERT INTO shape VALUES (1)"));
+
+    const QString select("SELECT * FROM shape");
+    QVERIFY(q.exec(select));
+    QVERIFY(q.next());
+    QCOMPARE(q.record().count(), 1);
+    q.clear();
+
+    // the cached statement recompiles itself for the new schema
+    q = QSqlQuery(db);
+    QVERIFY(q.exec("ALTER TABLE shape ADD COLUMN b INTEGER DEFAULT 7"));
+    QVERIFY2(q.exec(select), qPrintable(q.lastError().text()));
+    QCOMPARE(q.record().count(), 2);
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 1);
+    QCOMPARE(q.value(1).toInt(), 7);
+
+    QVERIFY(q.exec("DROP TABLE shape"));
+    QVERIFY(q.exec("CREATE TABLE shape (x VARCHAR(8), y INTEGER, z INTEGER)"));
+    QVERIFY(q.exec("INSERT INTO shape VALUES ('x', 2, 3)"));
+    QVERIFY2(q.exec(select), qPrintable(q.lastError().text()));
+    QCOMPARE(q.record().count(), 3);
+    QCOMPARE(q.record().fieldName(0), QString("x"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toString(), QString("x"));
+    QCOMPARE(q.value(2).toInt(), 3);
+
+    // a statement that no longer compiles fails cleanly
+    QVERIFY(q.exec("DROP TABLE shape"));
+    QVERIFY(!q.exec(select));
+    QVERIFY(q.lastError().isValid());
+    QVERIFY(!q.isActive());
+}
+
+void tst_QSQLite::execBatch_data()
+{
+    QTest::addColumn<QString>("options");
+
+    QTest::newRow("plain") << QString();
+    QTest::newRow("transactions") << QStringLiteral("QSQLITE_BATCH_TRANSACTIONS");
+}
+
+void tst_QSQLite::execBatch()
+{
+    QFETCH(QString, options);
+    QVERIFY(open(options));
+    QVERIFY(db.driver()->hasFeature(QSqlDriver::BatchOperations));
+
+    QVariantList ids;
+    QVariantList values;
+    for (int i = 0; i < 100; ++i) {
+        ids << i;
+        values << (i % 10 ? QVariant(i * 2) : QVariant(QVariant::Int));
+    }
+
+    QSqlQuery q(db);
+    QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    q.addBindValue(ids);
+    q.addBindValue(values);
+    QVERIFY2(q.execBatch(), qPrintable(q.lastError().text()));
+    QCOMPARE(q.numRowsAffected(), 100);
+
+    QVERIFY(q.exec("SELECT id, value FROM items ORDER BY id"));
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), i);
+        if (i % 10)
+            QCOMPARE(q.value(1).toInt(), i * 2);
+        else
+            QVERIFY(q.isNull(1));
+    }
+    QVERIFY(!q.next());
+}
+
+void tst_QSQLite::execBatchMismatch_data()
+{
+    QTest::addColumn<int>("placeholders");
+    QTest::addColumn<QVariantList>("ids");
+    QTest::addColumn<QVariantList>("values");
+
+    QTest::newRow("shorter list") << 2 << (QVariantList() << 1 << 2 << 3)
+                                  << (QVariantList() << 10 << 20);
+    QTest::newRow("longer list") << 2 << (QVariantList() << 1 << 2)
+                                 << (QVariantList() << 10 << 20 << 30);
+    QTest::newRow("empty list") << 2 << (QVariantList() << 1)
+                                << QVariantList();
+    QTest::newRow("too few lists") << 3 << (QVariantList() << 1 << 2)
+                                   << (QVariantList() << 10 << 20);
+}
+
+void tst_QSQLite::execBatchMismatch()
+{
+    QFETCH(int, placeholders);
+    QFETCH(QVariantList, ids);
+    QFETCH(QVariantList, values);
+    QVERIFY(open(QString()));
+
+    QSqlQuery q(db);
+    if (placeholders == 2)
+        QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    else
+        QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ? + ?)"));
+    q.addBindValue(ids);
+    q.addBindValue(values);
+    QVERIFY(!q.execBatch());
+    QCOMPARE(q.lastError().type(), QSqlError::StatementError);
+    QVERIFY(!q.isActive());
+    QCOMPARE(count("items"), 0);
+}
+
+void tst_QSQLite::execBatchRollback_data()
+{
+    QTest::addColumn<QString>("options");
+    QTest::addColumn<int>("rowsLeft");
+
+    // without the option, the rows before the failing one stay
+    QTest::newRow("plain") << QString() << 2;
+    QTest::newRow("transactions") << QStringLiteral("QSQLITE_BATCH_TRANSACTIONS") << 0;
+}
+
+void tst_QSQLite::execBatchRollback()
+{
+    QFETCH(QString, options);
+    QFETCH(int, rowsLeft);
+    QVERIFY(open(options));
+
+    QSqlQuery q(db);
+    QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    q.addBindValue(QVariantList() << 1 << 2 << 2 << 3);
+    q.addBindValue(QVariantList() << 10 << 20 << 30 << 40);
+    QVERIFY(!q.execBatch());
+    QCOMPARE(q.lastError().type(), QSqlError::StatementError);
+    QCOMPARE(count("items"), rowsLeft);
+
+    // the connection is back in autocommit mode and usable
+    QVERIFY(db.transaction());
+    QVERIFY(q.exec("INSERT INTO items (id, value) VALUES (5, 50)"));
+    QVERIFY(db.commit());
+    QCOMPARE(count("items"), rowsLeft + 1);
+}
+
+void tst_QSQLite::execBatchInTransaction()
+{
+    // a batch inside a transaction of the caller is left to the caller
+    QVERIFY(open(QStringLiteral("QSQLITE_BATCH_TRANSACTIONS")));
+
+    QVERIFY(db.transaction());
+    QSqlQuery q(db);
+    QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    q.addBindValue(QVariantList() << 1 << 2 << 2);
+    q.addBindValue(QVariantList() << 10 << 20 << 30);
+    QVERIFY(!q.execBatch());
+    QCOMPARE(count("items"), 2);
+    QVERIFY(db.rollback());
+    QCOMPARE(count("items"), 0);
+}
+
+void tst_QSQLite::numRowsAffected()
+{
+    QVERIFY(open(QString()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.prepare("INSERT INTO items (id, value) VALUES (?, ?)"));
+    q.addBindValue(QVariantList() << 1 << 2 << 3 << 4 << 5);
+    q.addBindValue(QVariantList() << 1 << 1 << 2 << 2 << 2);
+    QVERIFY(q.execBatch());
+    QCOMPARE(q.numRowsAffected(), 5);
+
+    // the total over all rows of the batch
+    QVERIFY(q.prepare("UPDATE items SET value = value + 1 WHERE value = ?"));
+    q.addBindValue(QVariantList() << 2 << 1 << 7);
+    QVERIFY(q.execBatch());
+    QCOMPARE(q.numRowsAffected(), 5);
+
+    // a single exec() reports its own changes again
+    QVERIFY(q.prepare("DELETE FROM items WHERE id = ?"));
+    q.addBindValue(1);
+    QVERIFY(q.exec());
+    QCOMPARE(q.numRowsAffected(), 1);
+
+    // and so does a batch that changes nothing
+    QVERIFY(q.prepare("DELETE FROM items WHERE id = ?"));
+    q.addBindValue(QVariantList() << 100 << 101);
+    QVERIFY(q.execBatch());
+    QCOMPARE(q.numRowsAffected(), 0);
+}
+
+QTEST_MAIN(tst_QSQLite)
+
+#include "tst_qsqlite.moc"
@@ -0,0 +1,6 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qsqlcolumnbatch
+SOURCES  += tst_qsqlcolumnbatch.cpp
+
+QT = core sql testlib
@@ -0,0 +1,249 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtSql/QSqlColumnBatch>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+class tst_QSqlColumnBatch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void empty();
+    void fetchBatch_data();
+    void fetchBatch();
+    void positioning_data();
+    void positioning();
+    void inactiveQuery();
+    void mixedStorageClasses();
+
+private:
+    QSqlDatabase db;
+};
+
+void tst_QSqlColumnBatch::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("batch"));
+    db.setDatabaseName(QStringLiteral(":memory:"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE items (id INTEGER, price DOUBLE, name VARCHAR(32), data BLOB)"));
+    QVERIFY(q.prepare("INSERT INTO items VALUES (?, ?, ?, ?)"));
+    for (int i = 0; i < 10; ++i) {
+        q.addBindValue(i);
+        q.addBindValue(i * 1.5);
+        q.addBindValue(i % 3 ? QVariant(QString::fromLatin1("item %1").arg(i)) : QVariant(QVariant::String));
+        q.addBindValue(QByteArray(i, 'x'));
+        QVERIFY(q.exec());
+    }
+}
+
+void tst_QSqlColumnBatch::cleanupTestCase()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("batch"));
+}
+
+void tst_QSqlColumnBatch::empty()
+{
+    QSqlColumnBatch batch;
+    QVERIFY(batch.isEmpty());
+    QCOMPARE(batch.rowCount(), 0);
+    QCOMPARE(batch.columnCount(), 0);
+    QVERIFY(batch.isNull(0, 0));
+    QVERIFY(!batch.value(0, 0).isValid());
+    QVERIFY(batch.int64Column(0).isEmpty());
+}
+
+void tst_QSqlColumnBatch::fetchBatch_data()
+{
+    QTest::addColumn<bool>("forwardOnly");
+    QTest::addColumn<int>("batchSize");
+
+    QTest::newRow("scrollable, 3") << false << 3;
+    QTest::newRow("scrollable, 100") << false << 100;
+    QTest::newRow("forward-only, 1") << true << 1;
+    QTest::newRow("forward-only, 4") << true << 4;
+    QTest::newRow("forward-only, 10") << true << 10;
+}
+
+void tst_QSqlColumnBatch::fetchBatch()
+{
+    QFETCH(bool, forwardOnly);
+    QFETCH(int, batchSize);
+
+    QSqlQuery q(db);
+    q.setForwardOnly(forwardOnly);
+    QVERIFY(q.exec("SELECT id, price, name, data FROM items ORDER BY id"));
+
+    QSqlColumnBatch batch;
+    int row = 0;
+    int fetched;
+    while ((fetched = q.fetchBatch(&batch, batchSize)) > 0) {
+        QVERIFY(fetched <= batchSize);
+        QCOMPARE(batch.rowCount(), fetched);
+        QCOMPARE(batch.columnCount(), 4);
+        QCOMPARE(batch.columnName(1), QString("price"));
+        QCOMPARE(batch.indexOf("NAME"), 2);
+        QCOMPARE(batch.columnType(0), QSqlColumnBatch::Int64Column);
+        QCOMPARE(batch.columnType(1), QSqlColumnBatch::DoubleColumn);
+        QCOMPARE(batch.columnType(2), QSqlColumnBatch::StringColumn);
+        QCOMPARE(batch.columnType(3), QSqlColumnBatch::VariantColumn);
+
+        const QVector<qint64> ids = batch.int64Column(0);
+        const QVector<double> prices = batch.doubleColumn(1);
+        const QStringList names = batch.stringColumn(2);
+        const QVector<QVariant> data = batch.variantColumn(3);
+        QCOMPARE(ids.size(), fetched);
+        QCOMPARE(names.size(), fetched);
+        QCOMPARE(batch.nulls(2).size(), fetched);
+        for (int i = 0; i < fetched; ++i, ++row) {
+            QCOMPARE(ids.at(i), qint64(row));
+            QCOMPARE(prices.at(i), row * 1.5);
+            if (row % 3) {
+                QVERIFY(!batch.isNull(i, 2));
+                QCOMPARE(names.at(i), QString("item %1").arg(row));
+            } else {
+                QVERIFY(batch.isNull(i, 2));
+                QVERIFY(names.at(i).isNull());
+                QVERIFY(batch.value(i, 2).isNull());
+            }
+            QCOMPARE(data.at(i).toByteArray(), QByteArray(row, 'x'));
+            QCOMPARE(batch.value(i, 0).toLongLong(), qint64(row));
+        }
+    }
+    QCOMPARE(row, 10);
+    QVERIFY(batch.isEmpty());
+    QCOMPARE(q.at(), int(QSql::AfterLastRow));
+    QVERIFY(!q.next());
+}
+
+void tst_QSqlColumnBatch::positioning_data()
+{
+    QTest::addColumn<bool>("forwardOnly");
+
+    QTest::newRow("scrollable") << false;
+    QTest::newRow("forward-only") << true;
+}
+
+void tst_QSqlColumnBatch::positioning()
+{
+    QFETCH(bool, forwardOnly);
+
+    QSqlQuery q(db);
+    q.setForwardOnly(forwardOnly);
+    QVERIFY(q.exec("SELECT id, name FROM items ORDER BY id"));
+
+    // batches and single rows can be mixed
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 0);
+
+    QSqlColumnBatch batch;
+    QCOMPARE(q.fetchBatch(&batch, 4), 4);
+    QCOMPARE(batch.int64Column(0).first(), qint64(1));
+    QCOMPARE(q.at(), 4);
+    QCOMPARE(q.value(0).toInt(), 4);
+    QCOMPARE(q.value(1).toString(), QString("item 4"));
+
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 5);
+
+    QCOMPARE(q.fetchBatch(&batch, 100), 4);
+    QCOMPARE(batch.int64Column(0).last(), qint64(9));
+    QCOMPARE(q.at(), int(QSql::AfterLastRow));
+    QCOMPARE(q.fetchBatch(&batch, 100), 0);
+}
+
+void tst_QSqlColumnBatch::inactiveQuery()
+{
+    QSqlColumnBatch batch;
+    QSqlQuery q(db);
+    QCOMPARE(q.fetchBatch(&batch, 10), 0);
+
+    QVERIFY(q.exec("SELECT id FROM items"));
+    QCOMPARE(q.fetchBatch(&batch, 0), 0);
+    QCOMPARE(q.fetchBatch(&batch, 2), 2);
+    QVERIFY(q.exec("UPDATE items SET price = price WHERE id < 0"));
+    QCOMPARE(q.fetchBatch(&batch, 2), 0);
+    QCOMPARE(batch.columnCount(), 0);
+}
+
+void tst_QSqlColumnBatch::mixedStorageClasses()
+{
+    // SQLite does not enforce the declared types, so a column can hold
+    // values of another storage class; they have to be converted the way
+    // value() returns them
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE mixed (n INTEGER, f DOUBLE, s VARCHAR(8))"));
+    QVERIFY(q.exec("INSERT INTO mixed VALUES (1, 1.5, 'a')"));
+    QVERIFY(q.exec("INSERT INTO mixed VALUES ('12abc', 'x', 'b')"));
+    QVERIFY(q.exec("INSERT INTO mixed VALUES (2.5, '3.25', X'41')"));
+
+    QList<QVariantList> expected;
+    QVERIFY(q.exec("SELECT n, f, s FROM mixed ORDER BY rowid"));
+    while (q.next()) {
+        expected << (QVariantList() << q.value(0).toLongLong() << q.value(1).toDouble()
+                                    << q.value(2).toString());
+    }
+    QCOMPARE(expected.size(), 3);
+
+    q.setForwardOnly(true);
+    QVERIFY(q.exec("SELECT n, f, s FROM mixed ORDER BY rowid"));
+    QSqlColumnBatch batch;
+    QCOMPARE(q.fetchBatch(&batch, 10), 3);
+    QCOMPARE(batch.columnType(0), QSqlColumnBatch::Int64Column);
+    QCOMPARE(batch.columnType(1), QSqlColumnBatch::DoubleColumn);
+    QCOMPARE(batch.columnType(2), QSqlColumnBatch::StringColumn);
+    for (int row = 0; row < expected.size(); ++row) {
+        for (int column = 0; column < 3; ++column)
+            QCOMPARE(batch.value(row, column), expected.at(row).at(column));
+    }
+
+    QVERIFY(q.exec("DROP TABLE mixed"));
+}
+
+QTEST_MAIN(tst_QSqlColumnBatch)
+
+#include "tst_qsqlcolumnbatch.moc"
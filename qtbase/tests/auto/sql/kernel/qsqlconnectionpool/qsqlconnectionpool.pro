@@ -0,0 +1,6 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qsqlconnectionpool
+SOURCES  += tst_qsqlconnectionpool.cpp
+
+QT = core sql testlib
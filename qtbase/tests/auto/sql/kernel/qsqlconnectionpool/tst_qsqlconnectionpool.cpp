@@ -0,0 +1,338 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlConnectionPool>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlQueryResultSet>
+#include <QtSql/QSqlRecord>
+
+typedef QFuture<QSqlQueryResultSet> ResultFuture;
+
+// takes seconds on the 1000 rows of the items table
+static const char slowQuery[] = "SELECT COUNT(*) FROM items a, items b, items c";
+
+class tst_QSqlConnectionPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void select();
+    void boundValues();
+    void error();
+    void openError();
+    void nonSelect();
+    void concurrent();
+    void order();
+    void maxConnections();
+    void timeoutQueued();
+    void timeoutRunning();
+    void defaultTimeout();
+    void cancel();
+    void destroyPending();
+    void resultSet();
+
+private:
+    QTemporaryDir dir;
+    QSqlDatabase db;
+};
+
+void tst_QSqlConnectionPool::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+    QVERIFY(dir.isValid());
+
+    // the connections of a pool need a database file to share
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("pool"));
+    db.setDatabaseName(dir.path() + QStringLiteral("/pool.db"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE items (id INTEGER, price DOUBLE, name VARCHAR(32))"));
+    QVERIFY(db.transaction());
+    QVERIFY(q.prepare("INSERT INTO items VALUES (?, ?, ?)"));
+    for (int i = 0; i < 1000; ++i) {
+        q.addBindValue(i);
+        q.addBindValue(i * 0.5);
+        q.addBindValue(i % 3 ? QVariant(QString::fromLatin1("item %1").arg(i)) : QVariant(QVariant::String));
+        QVERIFY(q.exec());
+    }
+    QVERIFY(db.commit());
+    QVERIFY(q.exec("CREATE TABLE log (id INTEGER PRIMARY KEY, text VARCHAR(32))"));
+}
+
+void tst_QSqlConnectionPool::cleanupTestCase()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("pool"));
+}
+
+void tst_QSqlConnectionPool::select()
+{
+    QSqlConnectionPool pool(db);
+    ResultFuture future = pool.exec("SELECT id, price, name FROM items WHERE id < 10 ORDER BY id");
+    const QSqlQueryResultSet result = future.result();
+    QVERIFY(future.isFinished());
+
+    QVERIFY2(!result.lastError().isValid(), qPrintable(result.lastError().text()));
+    QVERIFY(result.isSelect());
+    QCOMPARE(result.rowCount(), 10);
+    QCOMPARE(result.columnCount(), 3);
+    QCOMPARE(result.record().fieldName(2), QString("name"));
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(result.value(i, 0).toInt(), i);
+        QCOMPARE(result.value(i, "price").toDouble(), i * 0.5);
+        QCOMPARE(result.isNull(i, 2), i % 3 == 0);
+    }
+    QCOMPARE(pool.connectionCount(), 1);
+}
+
+void tst_QSqlConnectionPool::boundValues()
+{
+    QSqlConnectionPool pool(db);
+    const QSqlQueryResultSet result =
+            pool.exec("SELECT name FROM items WHERE id > ? AND id <= ? ORDER BY id",
+                      QVariantList() << 100 << 102).result();
+    QVERIFY(!result.lastError().isValid());
+    QCOMPARE(result.rowCount(), 2);
+    QCOMPARE(result.value(0, 0).toString(), QString("item 101"));
+    QCOMPARE(result.value(1, 0).toString(), QString("item 102"));
+}
+
+void tst_QSqlConnectionPool::error()
+{
+    QSqlConnectionPool pool(db);
+    const QSqlQueryResultSet result = pool.exec("SELECT no_such_column FROM items").result();
+    QVERIFY(result.lastError().isValid());
+    QCOMPARE(result.rowCount(), 0);
+
+    // the connection is still usable
+    QCOMPARE(pool.exec("SELECT COUNT(*) FROM items").result().value(0, 0).toInt(), 1000);
+}
+
+void tst_QSqlConnectionPool::openError()
+{
+    {
+        QSqlDatabase invalid = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("invalid"));
+        invalid.setDatabaseName(dir.path() + QStringLiteral("/no/such/dir/db"));
+        QSqlConnectionPool pool(invalid);
+        const QSqlQueryResultSet result = pool.exec("SELECT 1").result();
+        QVERIFY(result.lastError().isValid());
+        QCOMPARE(result.lastError().type(), QSqlError::ConnectionError);
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("invalid"));
+}
+
+void tst_QSqlConnectionPool::nonSelect()
+{
+    QSqlConnectionPool pool(db);
+    const QSqlQueryResultSet result =
+            pool.exec("INSERT INTO log (text) VALUES (?)", QVariantList() << QString("insert")).result();
+    QVERIFY(!result.lastError().isValid());
+    QVERIFY(!result.isSelect());
+    QCOMPARE(result.numRowsAffected(), 1);
+    QVERIFY(result.lastInsertId().isValid());
+    QCOMPARE(result.rowCount(), 0);
+}
+
+void tst_QSqlConnectionPool::concurrent()
+{
+    QSqlConnectionPool pool(db);
+    pool.setMaxConnections(4);
+
+    QList<ResultFuture> futures;
+    for (int i = 0; i < 100; ++i)
+        futures << pool.exec("SELECT name FROM items WHERE id = ?", QVariantList() << (i * 7 + 1));
+    QVERIFY(pool.waitForDone());
+    QVERIFY(pool.connectionCount() >= 1 && pool.connectionCount() <= 4);
+
+    for (int i = 0; i < futures.size(); ++i) {
+        QVERIFY(futures.at(i).isFinished());
+        const QSqlQueryResultSet result = futures.at(i).result();
+        QVERIFY2(!result.lastError().isValid(), qPrintable(result.lastError().text()));
+        QCOMPARE(result.value(0, 0).toString(), QString("item %1").arg(i * 7 + 1));
+    }
+}
+
+void tst_QSqlConnectionPool::order()
+{
+    // with one connection, queries run in the order they were queued
+    QSqlConnectionPool pool(db);
+    pool.setMaxConnections(1);
+    pool.exec("DELETE FROM log");
+    for (int i = 0; i < 20; ++i)
+        pool.exec("INSERT INTO log (text) VALUES (?)", QVariantList() << QString::number(i));
+    const QSqlQueryResultSet result = pool.exec("SELECT text FROM log ORDER BY id").result();
+    QCOMPARE(result.rowCount(), 20);
+    for (int i = 0; i < 20; ++i)
+        QCOMPARE(result.value(i, 0).toString(), QString::number(i));
+}
+
+void tst_QSqlConnectionPool::maxConnections()
+{
+    QSqlConnectionPool pool(db);
+    QVERIFY(pool.maxConnections() >= 1);
+    pool.setMaxConnections(0);
+    QCOMPARE(pool.maxConnections(), 1);
+
+    pool.setMaxConnections(3);
+    QList<ResultFuture> futures;
+    for (int i = 0; i < 3; ++i)
+        futures << pool.exec(slowQuery, 100);
+    QTRY_COMPARE(pool.connectionCount(), 3);
+    QVERIFY(pool.waitForDone());
+
+    // surplus connections are closed once they are idle
+    pool.setMaxConnections(1);
+    QTRY_COMPARE(pool.connectionCount(), 1);
+    QCOMPARE(pool.exec("SELECT COUNT(*) FROM items").result().value(0, 0).toInt(), 1000);
+}
+
+void tst_QSqlConnectionPool::timeoutQueued()
+{
+    QSqlConnectionPool pool(db);
+    pool.setMaxConnections(1);
+
+    QElapsedTimer timer;
+    timer.start();
+    ResultFuture slow = pool.exec(slowQuery, 2000);
+    ResultFuture queued = pool.exec("SELECT COUNT(*) FROM items", 100);
+
+    const QSqlQueryResultSet result = queued.result();
+    QVERIFY(result.lastError().isValid());
+    QCOMPARE(result.lastError().type(), QSqlError::StatementError);
+    QVERIFY(timer.elapsed() < 2000);
+    slow.waitForFinished();
+}
+
+void tst_QSqlConnectionPool::timeoutRunning()
+{
+    QSqlConnectionPool pool(db);
+    QElapsedTimer timer;
+    timer.start();
+    const QSqlQueryResultSet result = pool.exec(slowQuery, 100).result();
+    QVERIFY(result.lastError().isValid());
+    QCOMPARE(result.rowCount(), 0);
+    QVERIFY(timer.elapsed() < 5000);
+
+    // the interrupted connection is usable again
+    QVERIFY(pool.waitForDone(5000));
+    QCOMPARE(pool.exec("SELECT COUNT(*) FROM items").result().value(0, 0).toInt(), 1000);
+}
+
+void tst_QSqlConnectionPool::defaultTimeout()
+{
+    QSqlConnectionPool pool(db);
+    QCOMPARE(pool.defaultTimeout(), 0);
+    pool.setDefaultTimeout(100);
+    QCOMPARE(pool.defaultTimeout(), 100);
+    QVERIFY(pool.exec(slowQuery).result().lastError().isValid());
+
+    // an explicit 0 disables the default
+    QVERIFY(!pool.exec("SELECT 1", 0).result().lastError().isValid());
+}
+
+void tst_QSqlConnectionPool::cancel()
+{
+    QSqlConnectionPool pool(db);
+    pool.setMaxConnections(1);
+    pool.exec("DELETE FROM log").waitForFinished();
+
+    ResultFuture slow = pool.exec(slowQuery, 200);
+    ResultFuture canceled = pool.exec("INSERT INTO log (text) VALUES ('canceled')");
+    canceled.cancel();
+    QVERIFY(pool.waitForDone());
+    QVERIFY(canceled.isCanceled());
+    QVERIFY(canceled.isFinished());
+
+    QCOMPARE(pool.exec("SELECT COUNT(*) FROM log").result().value(0, 0).toInt(), 0);
+}
+
+void tst_QSqlConnectionPool::destroyPending()
+{
+    QList<ResultFuture> futures;
+    {
+        QSqlConnectionPool pool(db);
+        pool.setMaxConnections(1);
+        for (int i = 0; i < 3; ++i)
+            futures << pool.exec(slowQuery);
+    }
+    for (int i = 0; i < futures.size(); ++i) {
+        QVERIFY(futures.at(i).isFinished());
+        QVERIFY(futures.at(i).result().lastError().isValid());
+    }
+}
+
+void tst_QSqlConnectionPool::resultSet()
+{
+    QSqlQueryResultSet empty;
+    QVERIFY(!empty.lastError().isValid());
+    QVERIFY(!empty.isSelect());
+    QCOMPARE(empty.rowCount(), 0);
+    QCOMPARE(empty.columnCount(), 0);
+    QCOMPARE(empty.numRowsAffected(), -1);
+    QVERIFY(!empty.value(0, 0).isValid());
+    QVERIFY(empty.record(0).isEmpty());
+
+    QSqlConnectionPool pool(db);
+    const QSqlQueryResultSet result = pool.exec("SELECT id, name FROM items WHERE id = 4").result();
+    QCOMPARE(result.rowCount(), 1);
+    QVERIFY(!result.value(1, 0).isValid());
+    QVERIFY(!result.value(0, 2).isValid());
+    QVERIFY(!result.value(0, "no_such_column").isValid());
+
+    const QSqlRecord record = result.record(0);
+    QCOMPARE(record.count(), 2);
+    QCOMPARE(record.value("id").toInt(), 4);
+    QCOMPARE(record.value("name").toString(), QString("item 4"));
+    QVERIFY(result.record().value(0).isNull());
+
+    QSqlQueryResultSet copy = result;
+    QSqlQueryResultSet other;
+    copy.swap(other);
+    QCOMPARE(other.rowCount(), 1);
+    QCOMPARE(copy.rowCount(), 0);
+}
+
+QTEST_MAIN(tst_QSqlConnectionPool)
+
+#include "tst_qsqlconnectionpool.moc"
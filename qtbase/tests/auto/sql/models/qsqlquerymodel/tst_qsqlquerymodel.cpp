@@ -75,6 +75,10 @@ private slots:
     void setHeaderData();
     void fetchMore_data() { generic_data(); }
     void fetchMore();
+    void windowedQuery_data();
+    void windowedQuery();
+    void windowedQueryErrors_data() { generic_data(); }
+    void windowedQueryErrors();
 
     //problem specific tests
     void withSortFilterProxyModel_data() { generic_data(); }
@@ -495,6 +499,97 @@ void tst_QSqlQueryModel::fetchMore()
     }
 }
 
+void tst_QSqlQueryModel::windowedQuery_data()
+{
+    if (dbs.fillTestTable() == 0)
+        QSKIP("No database drivers are available in this Qt configuration");
+
+    QTest::addColumn<QString>("dbName");
+    QTest::addColumn<bool>("prefetch");
+
+    foreach (const QString &dbName, dbs.dbNames) {
+        QTest::newRow(qPrintable(dbName)) << dbName << false;
+        QTest::newRow(qPrintable(dbName + QLatin1String(", prefetch"))) << dbName << true;
+    }
+}
+
+void tst_QSqlQueryModel::windowedQuery()
+{
+    QFETCH(QString, dbName);
+    QFETCH(bool, prefetch);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlDriver::DbmsType dbType = tst_Databases::getDatabaseType(db);
+    if (dbType != QSqlDriver::SQLite && dbType != QSqlDriver::PostgreSQL && dbType != QSqlDriver::MySqlServer)
+        QSKIP("The database does not support LIMIT and OFFSET");
+
+    QSqlQueryModel model;
+    QSignalSpy modelResetSpy(&model, SIGNAL(modelReset()));
+    QCOMPARE(model.windowSize(), 1024);
+    QVERIFY(model.isPrefetchEnabled());
+    model.setWindowSize(100);
+    model.setPrefetchEnabled(prefetch);
+    model.setWindowedQuery("select id, name from " + qTableName("many", __FILE__, db), "id", db);
+    QVERIFY2(!model.lastError().isValid(), qPrintable(model.lastError().text()));
+    QVERIFY(model.isWindowed());
+    QCOMPARE(modelResetSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 2048);
+    QCOMPARE(model.columnCount(), 2);
+    QVERIFY(!model.canFetchMore());
+
+    // forwards, backwards and jumping around, in key order
+    for (int row = 0; row < 2048; ++row)
+        QCOMPARE(model.data(model.index(row, 0)).toInt(), row);
+    for (int row = 2047; row >= 0; --row)
+        QCOMPARE(model.data(model.index(row, 0)).toInt(), row);
+    const int jumps[] = { 1500, 3, 2047, 999, 1000, 1099, 1100, 0 };
+    for (size_t i = 0; i < sizeof(jumps) / sizeof(jumps[0]); ++i) {
+        QCOMPARE(model.data(model.index(jumps[i], 0)).toInt(), jumps[i]);
+        QCOMPARE(model.record(jumps[i]).value(1).toString(), QString("harry"));
+    }
+    QVERIFY(!model.data(model.index(2048, 0)).isValid());
+
+    // the windows are selected again in the new size
+    model.setWindowSize(7);
+    QCOMPARE(model.data(model.index(2000, 0)).toInt(), 2000);
+    QCOMPARE(model.data(model.index(1993, 0)).toInt(), 1993);
+    QCOMPARE(model.data(model.index(2007, 0)).toInt(), 2007);
+
+    // a filter in the query
+    model.setWindowedQuery("select id from " + qTableName("many", __FILE__, db) + " where id >= 100 and id < 350", "id", db);
+    QCOMPARE(model.rowCount(), 250);
+    QCOMPARE(model.data(model.index(249, 0)).toInt(), 349);
+    QCOMPARE(model.data(model.index(0, 0)).toInt(), 100);
+
+    model.setQuery(QSqlQuery("select * from " + qTableName("test", __FILE__, db), db));
+    QVERIFY(!model.isWindowed());
+    QCOMPARE(model.data(model.index(0, 1)).toString(), QString("harry"));
+}
+
+void tst_QSqlQueryModel::windowedQueryErrors()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    const QString many = qTableName("many", __FILE__, db);
+
+    QSqlQueryModel model;
+    model.setWindowedQuery("select id, name from " + many, "no_such_column", db);
+    QVERIFY(model.lastError().isValid());
+    QVERIFY(!model.isWindowed());
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.columnCount(), 0);
+
+    model.setWindowedQuery("select no_such_column from " + many, "id", db);
+    QVERIFY(model.lastError().isValid());
+    QVERIFY(!model.isWindowed());
+    QCOMPARE(model.rowCount(), 0);
+
+    model.clear();
+    QVERIFY(!model.lastError().isValid());
+    QVERIFY(!model.isWindowed());
+}
+
 // For task 149491: When used with QSortFilterProxyModel, a view and a
 // database that doesn't support the QuerySize feature, blank rows was
 // appended if the query returned more than 256 rows and setQuery()
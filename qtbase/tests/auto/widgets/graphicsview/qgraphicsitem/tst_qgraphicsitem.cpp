@@ -8229,6 +8229,7 @@ void tst_QGraphicsItem::sorting_data()
 
     QTest::newRow("NoIndex") << int(QGraphicsScene::NoIndex);
     QTest::newRow("BspTreeIndex") << int(QGraphicsScene::BspTreeIndex);
+    QTest::newRow("RTreeIndex") << int(QGraphicsScene::RTreeIndex);
 }
 
 void tst_QGraphicsItem::sorting()
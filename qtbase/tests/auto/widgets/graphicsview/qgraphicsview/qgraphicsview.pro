@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qgraphicsview
+QT += widgets testlib
+SOURCES  += tst_qgraphicsview.cpp
@@ -0,0 +1,437 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainter.h>
+#include <QtWidgets/qgraphicsitem.h>
+#include <QtWidgets/qgraphicsscene.h>
+#include <QtWidgets/qgraphicsview.h>
+
+// changes the painter state in paint() without restoring it
+class StateChangingItem : public QGraphicsRectItem
+{
+public:
+    explicit StateChangingItem(const QRectF &rect) : QGraphicsRectItem(rect) {}
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) Q_DECL_OVERRIDE
+    {
+        painter->setPen(QPen(Qt::magenta, 3));
+        painter->setBrush(Qt::yellow);
+        painter->setOpacity(0.5);
+        painter->drawRect(rect());
+    }
+};
+
+// paints the left half of the scene in one color and the right half in another
+class BackgroundView : public QGraphicsView
+{
+public:
+    explicit BackgroundView(QGraphicsScene *scene)
+        : QGraphicsView(scene), left(Qt::red), right(Qt::blue), calls(0)
+    {
+        setFrameStyle(QFrame::NoFrame);
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        setSceneRect(0, 0, 1024, 1024);
+        resize(300, 300);
+    }
+
+    QRgb pixel(const QPointF &scenePos)
+    {
+        return viewport()->grab().toImage().pixel(mapFromScene(scenePos));
+    }
+
+    QColor left;
+    QColor right;
+    int calls;
+    QRectF lastRect;
+
+protected:
+    void drawBackground(QPainter *painter, const QRectF &rect) Q_DECL_OVERRIDE
+    {
+        ++calls;
+        lastRect = rect;
+        painter->fillRect(rect & QRectF(0, 0, 512, 1024), left);
+        painter->fillRect(rect & QRectF(512, 0, 512, 1024), right);
+    }
+};
+
+class tst_QGraphicsView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void optimizationFlags_data();
+    void optimizationFlags();
+    void simplifyTinyItems();
+    void staleTiles_data();
+    void staleTiles();
+    void invalidateTiles();
+    void zoomFallback();
+    void nonScalingTransforms_data();
+    void nonScalingTransforms();
+
+private:
+    static void fillScene(QGraphicsScene *scene, const QString &layout);
+    static QImage grab(QGraphicsScene *scene, int flags, bool antialiased,
+                       const QTransform &transform = QTransform());
+    static void showTiled(BackgroundView *view, const QTransform &transform = QTransform());
+    static void renderTiles(BackgroundView *view);
+};
+
+static QGraphicsItem *standardItem(QGraphicsItem *item)
+{
+    item->setFlag(QGraphicsItem::ItemPaintsStandardShape);
+    return item;
+}
+
+void tst_QGraphicsView::fillScene(QGraphicsScene *scene, const QString &layout)
+{
+    const QPen pen(Qt::darkBlue, 3);
+    const QBrush brush(Qt::red);
+    if (layout == "overlapping") {
+        for (int i = 0; i < 8; ++i) {
+            scene->addItem(standardItem(new QGraphicsRectItem(10 + 12 * i, 10 + 9 * i, 40, 30)));
+            scene->addItem(standardItem(new QGraphicsEllipseItem(20 + 12 * i, 100 - 5 * i, 35, 35)));
+        }
+    } else if (layout == "disjoint") {
+        for (int y = 0; y < 6; ++y) {
+            for (int x = 0; x < 6; ++x)
+                scene->addItem(standardItem(new QGraphicsRectItem(5 + 30 * x, 5 + 30 * y, 20, 20)));
+        }
+    } else if (layout == "touching") {
+        for (int x = 0; x < 10; ++x)
+            scene->addItem(standardItem(new QGraphicsEllipseItem(10 + 15 * x, 50, 15, 15)));
+        for (int x = 0; x < 10; ++x)
+            scene->addItem(standardItem(new QGraphicsRectItem(10 + 15 * x, 100, 15, 15)));
+    } else if (layout == "lines") {
+        for (int i = 0; i < 10; ++i) {
+            scene->addItem(standardItem(new QGraphicsLineItem(10, 10 + 15 * i, 190, 190 - 15 * i)));
+            scene->addItem(standardItem(new QGraphicsRectItem(10 + 17 * i, 80, 12, 12)));
+        }
+    } else if (layout == "mixed") {
+        for (int i = 0; i < 6; ++i) {
+            scene->addItem(standardItem(new QGraphicsRectItem(10 + 25 * i, 20, 40, 40)));
+            scene->addItem(new StateChangingItem(QRectF(20 + 25 * i, 50, 30, 30)));
+            QGraphicsItem *ellipse = new QGraphicsEllipseItem(15 + 25 * i, 90, 30, 30);
+            if (i % 2)
+                standardItem(ellipse);
+            scene->addItem(ellipse);
+            scene->addItem(standardItem(new QGraphicsPolygonItem(
+                QPolygonF() << QPointF(10 + 25 * i, 140) << QPointF(40 + 25 * i, 190) << QPointF(25 * i, 180))));
+        }
+    }
+    foreach (QGraphicsItem *item, scene->items()) {
+        if (QAbstractGraphicsShapeItem *shapeItem = dynamic_cast<QAbstractGraphicsShapeItem *>(item)) {
+            shapeItem->setPen(pen);
+            shapeItem->setBrush(brush);
+        } else if (QGraphicsLineItem *lineItem = dynamic_cast<QGraphicsLineItem *>(item)) {
+            lineItem->setPen(pen);
+        }
+    }
+}
+
+QImage tst_QGraphicsView::grab(QGraphicsScene *scene, int flags, bool antialiased,
+                               const QTransform &transform)
+{
+    QGraphicsView view(scene);
+    view.setFrameStyle(QFrame::NoFrame);
+    view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    view.setSceneRect(0, 0, 200, 200);
+    view.resize(200, 200);
+    view.setOptimizationFlags(QGraphicsView::OptimizationFlags(flags));
+    view.setRenderHint(QPainter::Antialiasing, antialiased);
+    view.setTransform(transform);
+    return view.viewport()->grab().toImage().convertToFormat(QImage::Format_ARGB32);
+}
+
+void tst_QGraphicsView::optimizationFlags_data()
+{
+    QTest::addColumn<QString>("layout");
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<bool>("antialiased");
+
+    const char *layouts[] = { "overlapping", "disjoint", "touching", "lines", "mixed" };
+    const struct { const char *name; int flags; } flags[] = {
+        { "SimplifyTinyItems", QGraphicsView::SimplifyTinyItems },
+        { "BatchSimpleItems", QGraphicsView::BatchSimpleItems },
+        { "ElidePainterState", QGraphicsView::ElidePainterState },
+        { "all", QGraphicsView::SimplifyTinyItems | QGraphicsView::BatchSimpleItems
+                 | QGraphicsView::ElidePainterState }
+    };
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i) {
+        for (size_t j = 0; j < sizeof(flags) / sizeof(flags[0]); ++j) {
+            for (int antialiased = 0; antialiased < 2; ++antialiased) {
+                const QByteArray name = QByteArray(layouts[i]) + ", " + flags[j].name
+                    + (antialiased ? ", antialiased" : "");
+                QTest::newRow(name.constData()) << QString(layouts[i]) << flags[j].flags
+                                                << bool(antialiased);
+            }
+        }
+    }
+}
+
+// the flags make painting cheaper, but must not change what is painted
+void tst_QGraphicsView::optimizationFlags()
+{
+    QFETCH(QString, layout);
+    QFETCH(int, flags);
+    QFETCH(bool, antialiased);
+
+    QGraphicsScene scene;
+    fillScene(&scene, layout);
+
+    const QImage expected = grab(&scene, 0, antialiased);
+    QCOMPARE(grab(&scene, flags, antialiased), expected);
+
+    // also when only part of the items is translated
+    const QTransform scaled = QTransform::fromScale(0.75, 0.75);
+    QCOMPARE(grab(&scene, flags, antialiased, scaled), grab(&scene, 0, antialiased, scaled));
+    scene.items().first()->setRotation(30);
+    QCOMPARE(grab(&scene, flags, antialiased), grab(&scene, 0, antialiased));
+}
+
+void tst_QGraphicsView::simplifyTinyItems()
+{
+    QGraphicsScene scene;
+    QGraphicsRectItem *tiny = new QGraphicsRectItem(0, 0, 40, 40);
+    tiny->setFlag(QGraphicsItem::ItemPaintsStandardShape);
+    tiny->setPen(Qt::NoPen);
+    tiny->setBrush(Qt::red);
+    tiny->setPos(100, 100);
+    scene.addItem(tiny);
+    QGraphicsEllipseItem *custom = new QGraphicsEllipseItem(0, 0, 40, 40);
+    custom->setPen(Qt::NoPen);
+    custom->setBrush(Qt::blue);
+    custom->setPos(20, 20);
+    scene.addItem(custom);
+
+    // at this zoom, the items cover less than two pixels
+    const QTransform zoomedOut = QTransform::fromScale(0.04, 0.04);
+    const QImage simplified = grab(&scene, QGraphicsView::SimplifyTinyItems, true, zoomedOut);
+    const QImage painted = grab(&scene, 0, true, zoomedOut);
+
+    // the opted in item is drawn as a box in its brush color
+    QCOMPARE(simplified.pixel(4, 4), QColor(Qt::red).rgba());
+    // the other item is painted as usual
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x)
+            QCOMPARE(simplified.pixel(x, y), painted.pixel(x, y));
+    }
+
+    // items that are not tiny are left alone
+    QCOMPARE(grab(&scene, QGraphicsView::SimplifyTinyItems, true),
+             grab(&scene, 0, true));
+}
+
+void tst_QGraphicsView::showTiled(BackgroundView *view, const QTransform &transform)
+{
+    view->setCacheMode(QGraphicsView::CacheBackgroundTiles);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+    view->setTransform(transform);
+    view->centerOn(512, 300);
+}
+
+// paints until a short wait renders no more tiles
+void tst_QGraphicsView::renderTiles(BackgroundView *view)
+{
+    int calls;
+    do {
+        calls = view->calls;
+        view->viewport()->grab();
+        QTest::qWait(20);
+    } while (view->calls != calls);
+}
+
+// sample points in the tiles at (1, 1), (2, 1) and (1, 0) of level 0
+static const QPointF leftPoint(480, 300);
+static const QPointF rightPoint(544, 300);
+static const QPointF topPoint(480, 200);
+
+void tst_QGraphicsView::staleTiles_data()
+{
+    QTest::addColumn<int>("how");
+
+    QTest::newRow("invalidate()") << 0;
+    QTest::newRow("invalidate(sceneRect)") << 1;
+    QTest::newRow("invalidateScene()") << 2;
+    QTest::newRow("resetCachedContent()") << 3;
+}
+
+void tst_QGraphicsView::staleTiles()
+{
+    QFETCH(int, how);
+
+    QGraphicsScene scene;
+    BackgroundView view(&scene);
+    showTiled(&view);
+    renderTiles(&view);
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+
+    // the tiles are not rendered again without invalidation
+    view.left = Qt::green;
+    view.right = Qt::yellow;
+    const int calls = view.calls;
+    renderTiles(&view);
+    QCOMPARE(view.calls, calls);
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+
+    switch (how) {
+    case 0:
+        scene.invalidate();
+        break;
+    case 1:
+        scene.invalidate(scene.sceneRect(), QGraphicsScene::BackgroundLayer);
+        break;
+    case 2:
+        view.invalidateScene(QRectF(0, 0, 1024, 1024), QGraphicsScene::BackgroundLayer);
+        break;
+    case 3:
+        view.resetCachedContent();
+        break;
+    }
+
+    // stale tiles are drawn until they have been rendered again
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+    renderTiles(&view);
+    QVERIFY(view.calls > calls);
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::green).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::yellow).rgb());
+    QCOMPARE(view.pixel(topPoint), QColor(Qt::green).rgb());
+}
+
+void tst_QGraphicsView::invalidateTiles()
+{
+    QGraphicsScene scene;
+    BackgroundView view(&scene);
+    showTiled(&view);
+    renderTiles(&view);
+
+    view.left = Qt::green;
+    view.right = Qt::yellow;
+    const int calls = view.calls;
+    scene.invalidate(QRectF(400, 280, 20, 20), QGraphicsScene::BackgroundLayer);
+    renderTiles(&view);
+
+    // only the tile that intersects the rect is rendered again
+    QCOMPARE(view.calls, calls + 1);
+    QCOMPARE(view.lastRect, QRectF(256, 256, 256, 256));
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::green).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+    QCOMPARE(view.pixel(topPoint), QColor(Qt::red).rgb());
+
+    // a second invalidation keeps the other tiles current
+    scene.invalidate(QRectF(600, 280, 20, 20), QGraphicsScene::BackgroundLayer);
+    renderTiles(&view);
+    QCOMPARE(view.calls, calls + 2);
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::yellow).rgb());
+    QCOMPARE(view.pixel(topPoint), QColor(Qt::red).rgb());
+}
+
+void tst_QGraphicsView::zoomFallback()
+{
+    QGraphicsScene scene;
+    BackgroundView view(&scene);
+    showTiled(&view);
+    renderTiles(&view);
+    int calls = view.calls;
+
+    // before the tiles of the new level are rendered, the coarser ones are
+    // scaled up instead of leaving the base brush
+    view.setTransform(QTransform::fromScale(2, 2));
+    view.centerOn(512, 300);
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+    QCOMPARE(view.calls, calls);
+
+    renderTiles(&view);
+    QVERIFY(view.calls > calls);
+    QCOMPARE(view.lastRect.size(), QSizeF(128, 128));
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+
+    // the tiles of the previous level are still cached
+    calls = view.calls;
+    view.setTransform(QTransform());
+    view.centerOn(512, 300);
+    QCOMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QCOMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+    renderTiles(&view);
+    QCOMPARE(view.calls, calls);
+}
+
+void tst_QGraphicsView::nonScalingTransforms_data()
+{
+    QTest::addColumn<QTransform>("transform");
+    QTest::addColumn<bool>("tiled");
+
+    QTest::newRow("rotated") << QTransform().rotate(30) << false;
+    QTest::newRow("sheared") << QTransform().shear(0.2, 0) << false;
+    QTest::newRow("mirrored") << QTransform::fromScale(-1, 1) << false;
+    QTest::newRow("flipped") << QTransform::fromScale(1, -1) << false;
+    QTest::newRow("anisotropic") << QTransform::fromScale(2, 0.5) << true;
+}
+
+void tst_QGraphicsView::nonScalingTransforms()
+{
+    QFETCH(QTransform, transform);
+    QFETCH(bool, tiled);
+
+    QGraphicsScene scene;
+    BackgroundView view(&scene);
+    showTiled(&view, transform);
+    BackgroundView reference(&scene);
+    reference.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&reference));
+    reference.setTransform(transform);
+    reference.centerOn(512, 300);
+
+    if (!tiled) {
+        // the background is drawn directly, as without the cache
+        const int calls = view.calls;
+        QCOMPARE(view.viewport()->grab().toImage(), reference.viewport()->grab().toImage());
+        QVERIFY(view.calls > calls);
+    }
+    QTRY_COMPARE(view.pixel(leftPoint), QColor(Qt::red).rgb());
+    QTRY_COMPARE(view.pixel(rightPoint), QColor(Qt::blue).rgb());
+}
+
+QTEST_MAIN(tst_QGraphicsView)
+#include "tst_qgraphicsview.moc"
@@ -153,6 +153,7 @@ private slots:
     void QTBUG50535_update_on_new_selection_model();
     void testSelectionModelInSyncWithView();
     void testClickToSelect();
+    void renderCache();
 };
 
 class MyAbstractItemDelegate : public QAbstractItemDelegate
@@ -2126,5 +2127,53 @@ void tst_QAbstractItemView::testClickToSelect()
     QCOMPARE(spy.back().front().value<QRect>(), QRect(nearCenterA, QSize(1, 1)));
 }
 
+class PaintCountingDelegate : public QStyledItemDelegate
+{
+public:
+    PaintCountingDelegate() : paintCount(0) {}
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE
+    {
+        ++paintCount;
+        QStyledItemDelegate::paint(painter, option, index);
+    }
+    mutable int paintCount;
+};
+
+void tst_QAbstractItemView::renderCache()
+{
+    QStandardItemModel model(4, 3);
+    for (int row = 0; row < 4; ++row) {
+        for (int column = 0; column < 3; ++column)
+            model.setItem(row, column, new QStandardItem(QString::number(row * 3 + column)));
+    }
+    QTableView view;
+    PaintCountingDelegate delegate;
+    view.setItemDelegate(&delegate);
+    view.setModel(&model);
+    QCOMPARE(view.renderCacheLimit(), 0);
+    view.setRenderCacheLimit(1024);
+    QCOMPARE(view.renderCacheLimit(), 1024);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    view.viewport()->repaint();
+    QVERIFY(delegate.paintCount >= 12);
+
+    // nothing changed, everything comes from the cache
+    delegate.paintCount = 0;
+    view.viewport()->repaint();
+    QCOMPARE(delegate.paintCount, 0);
+
+    // only the changed item is painted again
+    model.item(1, 1)->setText(QStringLiteral("changed"));
+    view.viewport()->repaint();
+    QCOMPARE(delegate.paintCount, 1);
+
+    delegate.paintCount = 0;
+    view.setRenderCacheLimit(0);
+    view.viewport()->repaint();
+    QVERIFY(delegate.paintCount >= 12);
+}
+
 QTEST_MAIN(tst_QAbstractItemView)
 #include "tst_qabstractitemview.moc"
@@ -215,6 +215,7 @@ private slots:
     void QTBUG50171_visualRegionForSwappedItems();
     void ensureNoIndexAtLength();
     void offsetConsistent();
+    void sectionPositionsConsistent();
 
     void initialSortOrderRole();
 
@@ -2340,6 +2341,41 @@ void tst_QHeaderView::offsetConsistent()
     QVERIFY(offset2 > offset1);
 }
 
+void tst_QHeaderView::sectionPositionsConsistent()
+{
+    // The positions are kept incrementally across resizes and removals;
+    // compare them with the sum of the section sizes.
+    QTableView qtv;
+    QStandardItemModel amodel(300, 1);
+    qtv.setModel(&amodel);
+    QHeaderView *hv = qtv.verticalHeader();
+    const int uniformSize = hv->sectionSize(0);
+    QCOMPARE(hv->sectionPosition(299), 299 * uniformSize);
+    QCOMPARE(hv->visualIndexAt(150 * uniformSize + 1), 150);
+
+    for (int u = 7; u < 300; u += 13)
+        hv->resizeSection(u, u % 3 == 0 ? 0 : uniformSize + u % 17);
+    hv->hideSection(42);
+    hv->resizeSection(100, 3);
+    amodel.removeRows(250, 50); // the tail
+    amodel.removeRows(10, 5);
+    amodel.insertRows(20, 3);
+    hv->resizeSection(200, uniformSize * 4);
+
+    int position = 0;
+    for (int visual = 0; visual < hv->count(); ++visual) {
+        QCOMPARE(hv->sectionPosition(hv->logicalIndex(visual)), position);
+        const int size = hv->sectionSize(hv->logicalIndex(visual));
+        if (size > 0) {
+            QCOMPARE(hv->visualIndexAt(position), visual);
+            QCOMPARE(hv->visualIndexAt(position + size - 1), visual);
+        }
+        position += size;
+    }
+    QCOMPARE(hv->length(), position);
+    QCOMPARE(hv->visualIndexAt(position), -1);
+}
+
 void tst_QHeaderView::initialSortOrderRole()
 {
     QTableView view; // ### Shadowing member view (of type QHeaderView)
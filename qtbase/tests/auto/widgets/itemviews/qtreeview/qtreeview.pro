@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qtreeview
+QT += widgets testlib
+SOURCES  += tst_qtreeview.cpp
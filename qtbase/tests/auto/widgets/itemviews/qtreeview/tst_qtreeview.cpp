@@ -0,0 +1,190 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtGui/qstandarditemmodel.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qheaderview.h>
+#include <QtWidgets/qscrollbar.h>
+#include <QtWidgets/qtreeview.h>
+
+class tst_QTreeView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void lazyLayoutExpand();
+    void lazyLayoutSpanning();
+    void lazyLayoutInsertChildren();
+
+private:
+    void populate(QStandardItemModel *model, int rows, int childRows);
+    void setupView(QTreeView *view, QAbstractItemModel *model, bool lazy);
+    void compareLayouts(QTreeView *lazy, QTreeView *flat);
+};
+
+// Enough top level rows that the lazy layout has to evict cached items.
+static const int TopLevelRows = 2000;
+
+void tst_QTreeView::populate(QStandardItemModel *model, int rows, int childRows)
+{
+    for (int i = 0; i < rows; ++i) {
+        QStandardItem *item = new QStandardItem(QString::number(i));
+        for (int j = 0; j < childRows; ++j)
+            item->appendRow(new QStandardItem(QString::number(i) + QLatin1Char('.') + QString::number(j)));
+        model->appendRow(item);
+    }
+}
+
+void tst_QTreeView::setupView(QTreeView *view, QAbstractItemModel *model, bool lazy)
+{
+    view->setUniformRowHeights(true);
+    view->setLazyLayout(lazy);
+    view->setModel(model);
+    view->resize(300, 200);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+    QCOMPARE(view->lazyLayout(), lazy);
+}
+
+// Scrolls through both views and compares the geometry of every visible row.
+void tst_QTreeView::compareLayouts(QTreeView *lazy, QTreeView *flat)
+{
+    QCOMPARE(lazy->verticalScrollBar()->maximum(), flat->verticalScrollBar()->maximum());
+    const int step = lazy->verticalScrollBar()->pageStep();
+    for (int value = 0; value <= lazy->verticalScrollBar()->maximum(); value += step) {
+        lazy->verticalScrollBar()->setValue(value);
+        flat->verticalScrollBar()->setValue(value);
+        QModelIndex lazyIndex = lazy->indexAt(QPoint(1, 1));
+        QModelIndex flatIndex = flat->indexAt(QPoint(1, 1));
+        while (flatIndex.isValid() && flat->visualRect(flatIndex).top() < flat->viewport()->height()) {
+            QCOMPARE(lazyIndex.data().toString(), flatIndex.data().toString());
+            QCOMPARE(lazy->visualRect(lazyIndex), flat->visualRect(flatIndex));
+            QCOMPARE(lazy->isExpanded(lazyIndex), flat->isExpanded(flatIndex));
+            lazyIndex = lazy->indexBelow(lazyIndex);
+            flatIndex = flat->indexBelow(flatIndex);
+        }
+    }
+}
+
+void tst_QTreeView::lazyLayoutExpand()
+{
+    QStandardItemModel lazyModel;
+    QStandardItemModel flatModel;
+    populate(&lazyModel, TopLevelRows, 3);
+    populate(&flatModel, TopLevelRows, 3);
+    QTreeView lazy;
+    QTreeView flat;
+    setupView(&lazy, &lazyModel, true);
+    setupView(&flat, &flatModel, false);
+
+    for (int row = 0; row < TopLevelRows; row += 3) {
+        lazy.expand(lazyModel.index(row, 0));
+        flat.expand(flatModel.index(row, 0));
+    }
+    lazy.scrollToBottom();
+    QTest::qWait(0);
+    lazy.scrollToTop();
+
+    for (int row = 0; row < TopLevelRows; ++row)
+        QCOMPARE(lazy.isExpanded(lazyModel.index(row, 0)), row % 3 == 0);
+    compareLayouts(&lazy, &flat);
+
+    for (int row = 0; row < TopLevelRows; row += 6) {
+        lazy.collapse(lazyModel.index(row, 0));
+        flat.collapse(flatModel.index(row, 0));
+    }
+    for (int row = 0; row < TopLevelRows; ++row)
+        QCOMPARE(lazy.isExpanded(lazyModel.index(row, 0)), row % 3 == 0 && row % 6 != 0);
+    compareLayouts(&lazy, &flat);
+}
+
+void tst_QTreeView::lazyLayoutSpanning()
+{
+    QStandardItemModel model;
+    populate(&model, TopLevelRows, 2);
+    model.setColumnCount(2);
+    QTreeView view;
+    setupView(&view, &model, true);
+    view.expandAll();
+
+    const int columnWidth = view.header()->sectionSize(0);
+    for (int row = 600; row < TopLevelRows; row += 100)
+        view.setFirstColumnSpanned(row, QModelIndex(), true);
+    view.setFirstColumnSpanned(1, model.index(TopLevelRows - 1, 0), true);
+    view.scrollToBottom();
+    QTest::qWait(0);
+    view.scrollToTop();
+
+    for (int row = 0; row < TopLevelRows; ++row) {
+        const bool spanned = row >= 600 && row % 100 == 0;
+        QCOMPARE(view.isFirstColumnSpanned(row, QModelIndex()), spanned);
+        view.scrollTo(model.index(row, 0));
+        QCOMPARE(view.visualRect(model.index(row, 0)).width() > columnWidth, spanned);
+    }
+    QVERIFY(view.isFirstColumnSpanned(1, model.index(TopLevelRows - 1, 0)));
+    QVERIFY(!view.isFirstColumnSpanned(0, model.index(TopLevelRows - 1, 0)));
+
+    view.setFirstColumnSpanned(600, QModelIndex(), false);
+    view.scrollToBottom();
+    QTest::qWait(0);
+    view.scrollToTop();
+    QVERIFY(!view.isFirstColumnSpanned(600, QModelIndex()));
+    QVERIFY(view.isFirstColumnSpanned(700, QModelIndex()));
+}
+
+void tst_QTreeView::lazyLayoutInsertChildren()
+{
+    QStandardItemModel model;
+    populate(&model, TopLevelRows, 0);
+    QTreeView view;
+    setupView(&view, &model, true);
+    view.expand(model.index(0, 0));
+
+    const int row = TopLevelRows - 10;
+    model.item(row)->appendRow(new QStandardItem(QLatin1String("child")));
+    view.scrollToBottom();
+    QTest::qWait(0);
+    view.scrollToTop();
+
+    const QModelIndex parent = model.index(row, 0);
+    view.expand(parent);
+    QVERIFY(view.isExpanded(parent));
+    view.scrollTo(model.index(0, 0, parent));
+    QCOMPARE(view.indexBelow(parent), model.index(0, 0, parent));
+    QCOMPARE(view.visualRect(model.index(0, 0, parent)).top(), view.visualRect(parent).bottom() + 1);
+}
+
+QTEST_MAIN(tst_QTreeView)
+#include "tst_qtreeview.moc"
@@ -52,12 +52,14 @@
 #include <private/qwidget_p.h>
 #include <private/qapplication_p.h>
 #include <private/qhighdpiscaling_p.h>
+#include <private/qwidgetbackingstore_p.h>
 #include <qcalendarwidget.h>
 #include <qmainwindow.h>
 #include <qdockwidget.h>
 #include <qtoolbar.h>
 #include <qtoolbutton.h>
 #include <QtGui/qpaintengine.h>
+#include <QtCore/qthread.h>
 #include <QtGui/qbackingstore.h>
 #include <QtGui/qguiapplication.h>
 #include <QtGui/qscreen.h>
@@ -375,6 +377,7 @@ private slots:
     void doubleRepaint();
     void resizeInPaintEvent();
     void opaqueChildren();
+    void concurrentPaintEvent();
 
     void setMaskInResizeEvent();
     void moveInResizeEvent();
@@ -8078,6 +8081,100 @@ void tst_QWidget::opaqueChildren()
     QCOMPARE(qt_widget_private(&grandChild)->getOpaqueChildren(), QRegion());
 }
 
+class ConcurrentPaintWidget : public QWidget
+{
+public:
+    ConcurrentPaintWidget(const QColor &color, QWidget *parent)
+        : QWidget(parent), color(color), paintEvents(0), paintedOnGuiThread(true)
+    {
+        setAttribute(Qt::WA_ConcurrentPaintEvent);
+        setAttribute(Qt::WA_OpaquePaintEvent);
+    }
+
+    QColor color;
+    int paintEvents;
+    bool paintedOnGuiThread;
+
+protected:
+    void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE
+    {
+        ++paintEvents;
+        paintedOnGuiThread = paintedOnGuiThread && QThread::currentThread() == qApp->thread();
+        QPainter painter(this);
+        painter.fillRect(rect(), color);
+    }
+};
+
+class PaintEventCounter : public QObject
+{
+public:
+    PaintEventCounter() : paintEvents(0) {}
+    int paintEvents;
+
+protected:
+    bool eventFilter(QObject *, QEvent *event) Q_DECL_OVERRIDE
+    {
+        if (event->type() == QEvent::Paint)
+            ++paintEvents;
+        return false;
+    }
+};
+
+void tst_QWidget::concurrentPaintEvent()
+{
+    if (m_platform != QStringLiteral("xcb") && m_platform != QStringLiteral("windows")
+        && m_platform != QStringLiteral("offscreen")) {
+        QSKIP("Requires a raster backing store");
+    }
+
+    QWidget window;
+    window.resize(400, 100);
+    const QColor colors[] = { Qt::red, Qt::green, Qt::blue, Qt::yellow };
+    QVector<ConcurrentPaintWidget *> children;
+    PaintEventCounter counter;
+    for (int i = 0; i < 4; ++i) {
+        ConcurrentPaintWidget *child = new ConcurrentPaintWidget(colors[i], &window);
+        child->setGeometry(i * 100, 0, 100, 100);
+        child->installEventFilter(&counter);
+        children << child;
+    }
+    // Style sheets may draw pixmaps, so this one is always painted normally.
+    children.at(3)->setStyleSheet(QStringLiteral("background: yellow"));
+
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+    QWidgetBackingStore *backingStore = QWidgetPrivate::get(&window)->maybeBackingStore();
+    QVERIFY(backingStore);
+    if (window.backingStore()->paintDevice()->devType() != QInternal::Image)
+        QSKIP("Requires a raster backing store");
+
+    backingStore->setStatisticsEnabled(true);
+    backingStore->resetStatistics();
+    counter.paintEvents = 0;
+    for (int i = 0; i < children.size(); ++i)
+        children.at(i)->update();
+    QTRY_COMPARE(counter.paintEvents, 4);
+
+    // The paint events go through the event filters on the GUI thread.
+    for (int i = 0; i < children.size(); ++i) {
+        QVERIFY(children.at(i)->paintEvents > 0);
+        QVERIFY(children.at(i)->paintedOnGuiThread);
+    }
+    const QWidgetBackingStoreStatistics stats = backingStore->statistics();
+    QCOMPARE(stats.concurrentPaintEvents, 3);
+    QVERIFY(stats.widgets.contains(children.at(0)));
+
+    const QImage image = *static_cast<QImage *>(window.backingStore()->paintDevice());
+    const qreal dpr = image.devicePixelRatio();
+    for (int i = 0; i < 3; ++i)
+        QCOMPARE(image.pixel(QPoint(i * 100 + 50, 50) * dpr), colors[i].rgb());
+
+    // Destroyed widgets are dropped from the statistics.
+    const QWidget *deleted = children.takeFirst();
+    delete deleted;
+    QVERIFY(!backingStore->statistics().widgets.contains(deleted));
+}
+
 
 class MaskSetWidget : public QWidget
 {
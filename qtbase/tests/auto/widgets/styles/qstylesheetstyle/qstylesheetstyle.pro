@@ -0,0 +1,5 @@
+CONFIG += testcase
+CONFIG += parallel_test
+TARGET = tst_qstylesheetstyle
+QT += widgets testlib
+SOURCES  += tst_qstylesheetstyle.cpp
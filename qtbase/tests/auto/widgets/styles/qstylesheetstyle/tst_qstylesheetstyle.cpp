@@ -0,0 +1,193 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+
+#include <QtTest/QtTest>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qframe.h>
+#include <QtWidgets/qlabel.h>
+#include <QtWidgets/qstyle.h>
+
+static QColor textColor(QWidget *w)
+{
+    w->ensurePolished();
+    return w->palette().color(w->foregroundRole());
+}
+
+class tst_QStyleSheetStyle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void attributeSelectors_data();
+    void attributeSelectors();
+    void dynamicPropertyRepolish();
+    void sharedRules_data();
+    void sharedRules();
+    void sharedRulesWithAncestors();
+};
+
+void tst_QStyleSheetStyle::cleanup()
+{
+    qApp->setStyleSheet(QString());
+}
+
+void tst_QStyleSheetStyle::attributeSelectors_data()
+{
+    QTest::addColumn<QString>("styleSheet");
+    QTest::addColumn<QVariant>("value");
+    QTest::addColumn<bool>("matches");
+
+    QTest::newRow("= equal") << "QLabel[prop=\"x\"] { color: red }" << QVariant("x") << true;
+    QTest::newRow("= longer") << "QLabel[prop=\"x\"] { color: red }" << QVariant("xy") << false;
+    QTest::newRow("= word") << "QLabel[prop=\"x\"] { color: red }" << QVariant("x y") << false;
+    QTest::newRow("= unset") << "QLabel[prop=\"x\"] { color: red }" << QVariant() << false;
+    QTest::newRow("= universal") << "[prop=\"x\"] { color: red }" << QVariant("x") << true;
+    QTest::newRow("= other class") << "QFrame#other[prop=\"x\"] { color: red }" << QVariant("x") << false;
+    QTest::newRow("= two attributes")
+        << "[prop~=\"x\"][other=\"y\"] { color: red }" << QVariant("x") << false;
+    QTest::newRow("~= word") << "[prop~=\"b\"] { color: red }" << QVariant("a b c") << true;
+    QTest::newRow("~= repeated word") << "[prop~=\"b\"] { color: red }" << QVariant("b a b") << true;
+    QTest::newRow("~= part of a word") << "[prop~=\"b\"] { color: red }" << QVariant("ab c") << false;
+    QTest::newRow("~= list") << "[prop~=\"b\"] { color: red }"
+                             << QVariant(QStringList() << "a" << "b") << true;
+    QTest::newRow("~= class") << ".QLabel[prop~=\"b\"] { color: red }" << QVariant("b") << true;
+    QTest::newRow("~= other class") << ".QFrame[prop~=\"b\"] { color: red }" << QVariant("b") << false;
+    QTest::newRow("|= prefix") << "QLabel[prop|=\"pre\"] { color: red }" << QVariant("prefix") << true;
+    QTest::newRow("|= equal") << "QLabel[prop|=\"pre\"] { color: red }" << QVariant("pre") << true;
+    QTest::newRow("|= not a prefix") << "QLabel[prop|=\"pre\"] { color: red }" << QVariant("xpre") << false;
+    QTest::newRow("|= with =") << "[prop|=\"pre\"][prop=\"prefix\"] { color: red }"
+                               << QVariant("prefix") << true;
+}
+
+void tst_QStyleSheetStyle::attributeSelectors()
+{
+    QFETCH(QString, styleSheet);
+    QFETCH(QVariant, value);
+    QFETCH(bool, matches);
+
+    qApp->setStyleSheet(styleSheet);
+    QLabel label;
+    label.setProperty("prop", value);
+    QCOMPARE(textColor(&label) == QColor(Qt::red), matches);
+}
+
+void tst_QStyleSheetStyle::dynamicPropertyRepolish()
+{
+    qApp->setStyleSheet("QLabel[state=\"on\"] { color: red } QLabel[state=\"off\"] { color: blue }");
+    QLabel label;
+    QLabel other;
+    label.setProperty("state", "on");
+    other.setProperty("state", "on");
+    QCOMPARE(textColor(&label), QColor(Qt::red));
+    QCOMPARE(textColor(&other), QColor(Qt::red));
+
+    label.setProperty("state", "off");
+    label.style()->unpolish(&label);
+    label.style()->polish(&label);
+    QCOMPARE(textColor(&label), QColor(Qt::blue));
+
+    // the rules of the other label are not affected
+    other.style()->unpolish(&other);
+    other.style()->polish(&other);
+    QCOMPARE(textColor(&other), QColor(Qt::red));
+
+    label.setProperty("state", QVariant());
+    label.style()->unpolish(&label);
+    label.style()->polish(&label);
+    QVERIFY(textColor(&label) != QColor(Qt::red));
+    QVERIFY(textColor(&label) != QColor(Qt::blue));
+}
+
+void tst_QStyleSheetStyle::sharedRules_data()
+{
+    QTest::addColumn<bool>("plainFirst");
+
+    QTest::newRow("attribute first") << false;
+    QTest::newRow("plain first") << true;
+}
+
+// widgets that differ only in an attribute must not share their rules
+void tst_QStyleSheetStyle::sharedRules()
+{
+    QFETCH(bool, plainFirst);
+
+    qApp->setStyleSheet("QLabel { color: green } QLabel[kind=\"warning\"] { color: red }"
+                        " QLabel[kind=\"\"] { color: yellow } #special { color: blue }");
+    QLabel plain;
+    QLabel warning;
+    QLabel special;
+    plain.setObjectName("label");
+    warning.setObjectName("label");
+    special.setObjectName("special");
+    warning.setProperty("kind", "warning");
+
+    if (plainFirst)
+        QCOMPARE(textColor(&plain), QColor(Qt::green));
+    QCOMPARE(textColor(&warning), QColor(Qt::red));
+    QCOMPARE(textColor(&plain), QColor(Qt::green));
+    QCOMPARE(textColor(&special), QColor(Qt::blue));
+
+    // an empty value is not the same as no value
+    QLabel empty;
+    empty.setObjectName("label");
+    empty.setProperty("kind", QString(""));
+    QCOMPARE(textColor(&empty), QColor(Qt::yellow));
+    QCOMPARE(textColor(&plain), QColor(Qt::green));
+    QCOMPARE(textColor(&warning), QColor(Qt::red));
+}
+
+void tst_QStyleSheetStyle::sharedRulesWithAncestors()
+{
+    qApp->setStyleSheet("QLabel { color: green } QFrame[kind=\"warning\"] QLabel { color: red }");
+    QFrame plainFrame;
+    QFrame warningFrame;
+    warningFrame.setProperty("kind", "warning");
+    QLabel *plain = new QLabel(&plainFrame);
+    QLabel *warning = new QLabel(&warningFrame);
+
+    QCOMPARE(textColor(plain), QColor(Qt::green));
+    QCOMPARE(textColor(warning), QColor(Qt::red));
+
+    // widgets with a style sheet of their own are not shared
+    QFrame styledFrame;
+    styledFrame.setStyleSheet("QLabel { color: blue }");
+    QLabel *styled = new QLabel(&styledFrame);
+    QCOMPARE(textColor(styled), QColor(Qt::blue));
+    QCOMPARE(textColor(plain), QColor(Qt::green));
+}
+
+QTEST_MAIN(tst_QStyleSheetStyle)
+#include "tst_qstylesheetstyle.moc"
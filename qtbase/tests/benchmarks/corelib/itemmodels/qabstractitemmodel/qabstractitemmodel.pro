@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qabstractitemmodel
+QT = core testlib
+SOURCES += tst_qabstractitemmodel.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QVector>
+
+// A two level model: groupCount groups with rowCount rows each. The
+// internal id of a row is the number of its group plus one.
+class GroupModel : public QAbstractItemModel
+{
+public:
+    GroupModel(int groupCount, int rowCount)
+        : m_rows(groupCount, rowCount) {}
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        if (row < 0 || column != 0 || row >= rowCount(parent))
+            return QModelIndex();
+        return createIndex(row, column, quintptr(parent.isValid() ? parent.row() + 1 : 0));
+    }
+
+    QModelIndex parent(const QModelIndex &child) const Q_DECL_OVERRIDE
+    {
+        if (!child.isValid() || child.internalId() == 0)
+            return QModelIndex();
+        return createIndex(int(child.internalId()) - 1, 0, quintptr(0));
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        if (!parent.isValid())
+            return m_rows.count();
+        if (parent.internalId() != 0)
+            return 0;
+        return m_rows.at(parent.row());
+    }
+
+    int columnCount(const QModelIndex & = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        return 1;
+    }
+
+    QVariant data(const QModelIndex &, int = Qt::DisplayRole) const Q_DECL_OVERRIDE
+    {
+        return QVariant();
+    }
+
+    void insert(int group, int row, int count)
+    {
+        beginInsertRows(index(group, 0), row, row + count - 1);
+        m_rows[group] += count;
+        endInsertRows();
+    }
+
+    void remove(int group, int row, int count)
+    {
+        beginRemoveRows(index(group, 0), row, row + count - 1);
+        m_rows[group] -= count;
+        endRemoveRows();
+    }
+
+    void move(int group, int first, int last, int destination)
+    {
+        const QModelIndex parent = index(group, 0);
+        beginMoveRows(parent, first, last, parent, destination);
+        endMoveRows();
+    }
+
+private:
+    QVector<int> m_rows;
+};
+
+class tst_QAbstractItemModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void insertRows_data();
+    void insertRows();
+    void removeRows_data();
+    void removeRows();
+    void moveRows_data();
+    void moveRows();
+
+private:
+    void addModelData();
+    void makePersistent(GroupModel *model, QList<QPersistentModelIndex> *indexes);
+};
+
+void tst_QAbstractItemModel::addModelData()
+{
+    QTest::addColumn<int>("groupCount");
+    QTest::addColumn<int>("rowCount");
+
+    QTest::newRow("1x10000") << 1 << 10000;
+    QTest::newRow("1x100000") << 1 << 100000;
+    QTest::newRow("100x1000") << 100 << 1000;
+    QTest::newRow("1000x100") << 1000 << 100;
+}
+
+void tst_QAbstractItemModel::makePersistent(GroupModel *model, QList<QPersistentModelIndex> *indexes)
+{
+    for (int group = 0; group < model->rowCount(); ++group) {
+        const QModelIndex parent = model->index(group, 0);
+        indexes->append(parent);
+        for (int row = 0; row < model->rowCount(parent); ++row)
+            indexes->append(model->index(row, 0, parent));
+    }
+}
+
+void tst_QAbstractItemModel::insertRows_data()
+{
+    addModelData();
+}
+
+// inserts rows near the end of the last group, with every row held
+// by a persistent index
+void tst_QAbstractItemModel::insertRows()
+{
+    QFETCH(int, groupCount);
+    QFETCH(int, rowCount);
+
+    GroupModel model(groupCount, rowCount);
+    QList<QPersistentModelIndex> indexes;
+    makePersistent(&model, &indexes);
+    const int group = groupCount - 1;
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i)
+            model.insert(group, rowCount - 10, 1);
+    }
+    QCOMPARE(indexes.last().row(), model.rowCount(model.index(group, 0)) - 1);
+}
+
+void tst_QAbstractItemModel::removeRows_data()
+{
+    addModelData();
+}
+
+void tst_QAbstractItemModel::removeRows()
+{
+    QFETCH(int, groupCount);
+    QFETCH(int, rowCount);
+
+    GroupModel model(groupCount, rowCount);
+    QList<QPersistentModelIndex> indexes;
+    makePersistent(&model, &indexes);
+    const int group = groupCount - 1;
+
+    QBENCHMARK {
+        for (int i = 0; i < 50; ++i) {
+            model.remove(group, rowCount - 20, 1);
+            model.insert(group, rowCount - 20, 1);
+        }
+    }
+    QCOMPARE(indexes.last().row(), rowCount - 1);
+}
+
+void tst_QAbstractItemModel::moveRows_data()
+{
+    addModelData();
+}
+
+// moves a block of rows back and forth inside the last group
+void tst_QAbstractItemModel::moveRows()
+{
+    QFETCH(int, groupCount);
+    QFETCH(int, rowCount);
+
+    GroupModel model(groupCount, rowCount);
+    QList<QPersistentModelIndex> indexes;
+    makePersistent(&model, &indexes);
+    const int group = groupCount - 1;
+
+    QBENCHMARK {
+        for (int i = 0; i < 50; ++i) {
+            model.move(group, rowCount - 20, rowCount - 11, rowCount - 40);
+            model.move(group, rowCount - 40, rowCount - 31, rowCount - 10);
+        }
+    }
+    QCOMPARE(indexes.last().row(), rowCount - 1);
+}
+
+QTEST_MAIN(tst_QAbstractItemModel)
+
+#include "tst_qabstractitemmodel.moc"
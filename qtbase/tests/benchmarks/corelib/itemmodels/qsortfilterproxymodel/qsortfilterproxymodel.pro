@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qsortfilterproxymodel
+QT = core testlib
+SOURCES += tst_qsortfilterproxymodel.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/QSortFilterProxyModel>
+#include <QtCore/QStringListModel>
+
+// Inserts whole batches of rows with their data, like a model fed from a
+// network or database source would.
+class ListModel : public QAbstractListModel
+{
+public:
+    explicit ListModel(const QStringList &strings) : m_rows(strings) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        return parent.isValid() ? 0 : m_rows.count();
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE
+    {
+        if (role != Qt::DisplayRole || !index.isValid())
+            return QVariant();
+        return m_rows.at(index.row());
+    }
+
+    void insert(int row, const QStringList &strings)
+    {
+        beginInsertRows(QModelIndex(), row, row + strings.count() - 1);
+        for (int i = 0; i < strings.count(); ++i)
+            m_rows.insert(row + i, strings.at(i));
+        endInsertRows();
+    }
+
+    void remove(int row, int count)
+    {
+        beginRemoveRows(QModelIndex(), row, row + count - 1);
+        m_rows.erase(m_rows.begin() + row, m_rows.begin() + row + count);
+        endRemoveRows();
+    }
+
+private:
+    QStringList m_rows;
+};
+
+class tst_QSortFilterProxyModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void filterAsYouType_data();
+    void filterAsYouType();
+    void sort_data();
+    void sort();
+    void bulkInsert_data();
+    void bulkInsert();
+
+private:
+    void addFlagsData();
+
+    QStringList m_strings;
+};
+
+void tst_QSortFilterProxyModel::initTestCase()
+{
+    uint seed = 1;
+    m_strings.reserve(200000);
+    for (int i = 0; i < 200000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        m_strings << QString::fromLatin1("item %1 %2").arg((seed >> 8) % 1000000).arg(i);
+    }
+}
+
+void tst_QSortFilterProxyModel::addFlagsData()
+{
+    QTest::addColumn<int>("flags");
+
+    QTest::newRow("default") << 0;
+    QTest::newRow("ParallelFiltering") << int(QSortFilterProxyModel::ParallelFiltering);
+    QTest::newRow("CacheSortKeys") << int(QSortFilterProxyModel::CacheSortKeys);
+    QTest::newRow("ParallelFiltering|CacheSortKeys")
+        << int(QSortFilterProxyModel::ParallelFiltering | QSortFilterProxyModel::CacheSortKeys);
+}
+
+void tst_QSortFilterProxyModel::filterAsYouType_data()
+{
+    addFlagsData();
+}
+
+void tst_QSortFilterProxyModel::filterAsYouType()
+{
+    QFETCH(int, flags);
+
+    QStringListModel model(m_strings);
+    QSortFilterProxyModel proxy;
+    proxy.setOptimizationFlags(QSortFilterProxyModel::OptimizationFlags(flags));
+    proxy.setSourceModel(&model);
+    proxy.sort(0);
+    QCOMPARE(proxy.rowCount(), m_strings.count());
+
+    const QString typed = QStringLiteral("12345");
+    QBENCHMARK {
+        for (int i = 1; i <= typed.length(); ++i)
+            proxy.setFilterFixedString(typed.left(i));
+        for (int i = typed.length() - 1; i >= 0; --i)
+            proxy.setFilterFixedString(typed.left(i));
+    }
+    QCOMPARE(proxy.rowCount(), m_strings.count());
+}
+
+void tst_QSortFilterProxyModel::sort_data()
+{
+    addFlagsData();
+}
+
+void tst_QSortFilterProxyModel::sort()
+{
+    QFETCH(int, flags);
+
+    QStringListModel model(m_strings);
+    QSortFilterProxyModel proxy;
+    proxy.setOptimizationFlags(QSortFilterProxyModel::OptimizationFlags(flags));
+    proxy.setSourceModel(&model);
+
+    QBENCHMARK {
+        proxy.sort(0, Qt::AscendingOrder);
+        proxy.sort(0, Qt::DescendingOrder);
+    }
+}
+
+void tst_QSortFilterProxyModel::bulkInsert_data()
+{
+    addFlagsData();
+}
+
+void tst_QSortFilterProxyModel::bulkInsert()
+{
+    QFETCH(int, flags);
+
+    ListModel model(m_strings);
+    QSortFilterProxyModel proxy;
+    proxy.setOptimizationFlags(QSortFilterProxyModel::OptimizationFlags(flags));
+    proxy.setSourceModel(&model);
+    proxy.setFilterFixedString(QStringLiteral("1"));
+    proxy.sort(0);
+    const int proxyRowCount = proxy.rowCount();
+
+    const QStringList batch = m_strings.mid(0, 20000);
+    const int row = model.rowCount() / 2;
+    QBENCHMARK {
+        model.insert(row, batch);
+        model.remove(row, batch.count());
+    }
+    QCOMPARE(proxy.rowCount(), proxyRowCount);
+}
+
+QTEST_MAIN(tst_QSortFilterProxyModel)
+
+#include "tst_qsortfilterproxymodel.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qgraphicsscene
+QT += widgets testlib
+SOURCES += tst_qgraphicsscene.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,213 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qgraphicsitem.h>
+#include <QtWidgets/qgraphicsscene.h>
+
+Q_DECLARE_METATYPE(QGraphicsScene::ItemIndexMethod)
+
+class tst_QGraphicsScene : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void populate_data();
+    void populate();
+    void itemAt_data();
+    void itemAt();
+    void itemsInRect_data();
+    void itemsInRect();
+    void rubberBandSelection_data();
+    void rubberBandSelection();
+    void moveItems_data();
+    void moveItems();
+
+private:
+    void addIndexRows(const QList<int> &itemCounts);
+    void populateScene(QGraphicsScene *scene, int itemCount, bool selectable = false);
+};
+
+static const qreal sceneSize = 10000;
+
+void tst_QGraphicsScene::addIndexRows(const QList<int> &itemCounts)
+{
+    QTest::addColumn<QGraphicsScene::ItemIndexMethod>("indexMethod");
+    QTest::addColumn<int>("itemCount");
+
+    foreach (int count, itemCounts) {
+        QTest::newRow(qPrintable(QString::fromLatin1("BspTreeIndex, %1 items").arg(count)))
+            << QGraphicsScene::BspTreeIndex << count;
+        QTest::newRow(qPrintable(QString::fromLatin1("RTreeIndex, %1 items").arg(count)))
+            << QGraphicsScene::RTreeIndex << count;
+        if (count <= 10000) {
+            QTest::newRow(qPrintable(QString::fromLatin1("NoIndex, %1 items").arg(count)))
+                << QGraphicsScene::NoIndex << count;
+        }
+    }
+}
+
+// Scatters small rectangles over the scene, with a fixed seed so that every
+// index method sees the same layout.
+void tst_QGraphicsScene::populateScene(QGraphicsScene *scene, int itemCount, bool selectable)
+{
+    qsrand(1);
+    for (int i = 0; i < itemCount; ++i) {
+        QGraphicsRectItem *item = scene->addRect(0, 0, 5 + qrand() % 20, 5 + qrand() % 20);
+        item->setPos(qrand() % int(sceneSize), qrand() % int(sceneSize));
+        if (selectable)
+            item->setFlag(QGraphicsItem::ItemIsSelectable);
+    }
+}
+
+void tst_QGraphicsScene::populate_data()
+{
+    addIndexRows(QList<int>() << 1000 << 10000 << 100000);
+}
+
+void tst_QGraphicsScene::populate()
+{
+    QFETCH(QGraphicsScene::ItemIndexMethod, indexMethod);
+    QFETCH(int, itemCount);
+
+    QBENCHMARK {
+        QGraphicsScene scene(0, 0, sceneSize, sceneSize);
+        scene.setItemIndexMethod(indexMethod);
+        populateScene(&scene, itemCount);
+        // The first lookup builds the index.
+        scene.items(QPointF(sceneSize / 2, sceneSize / 2));
+    }
+}
+
+void tst_QGraphicsScene::itemAt_data()
+{
+    addIndexRows(QList<int>() << 1000 << 10000 << 100000);
+}
+
+void tst_QGraphicsScene::itemAt()
+{
+    QFETCH(QGraphicsScene::ItemIndexMethod, indexMethod);
+    QFETCH(int, itemCount);
+
+    QGraphicsScene scene(0, 0, sceneSize, sceneSize);
+    scene.setItemIndexMethod(indexMethod);
+    populateScene(&scene, itemCount);
+    scene.items(QPointF(0, 0));
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            scene.itemAt(QPointF((i * 97) % int(sceneSize), (i * 89) % int(sceneSize)), QTransform());
+    }
+}
+
+void tst_QGraphicsScene::itemsInRect_data()
+{
+    addIndexRows(QList<int>() << 1000 << 10000 << 100000);
+}
+
+void tst_QGraphicsScene::itemsInRect()
+{
+    QFETCH(QGraphicsScene::ItemIndexMethod, indexMethod);
+    QFETCH(int, itemCount);
+
+    QGraphicsScene scene(0, 0, sceneSize, sceneSize);
+    scene.setItemIndexMethod(indexMethod);
+    populateScene(&scene, itemCount);
+    scene.items(QPointF(0, 0));
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            const QRectF rect((i * 97) % int(sceneSize), (i * 89) % int(sceneSize), 500, 300);
+            scene.items(rect, Qt::IntersectsItemBoundingRect);
+        }
+    }
+}
+
+void tst_QGraphicsScene::rubberBandSelection_data()
+{
+    addIndexRows(QList<int>() << 10000 << 100000);
+}
+
+// Grows a selection rectangle the way dragging a rubber band does.
+void tst_QGraphicsScene::rubberBandSelection()
+{
+    QFETCH(QGraphicsScene::ItemIndexMethod, indexMethod);
+    QFETCH(int, itemCount);
+
+    QGraphicsScene scene(0, 0, sceneSize, sceneSize);
+    scene.setItemIndexMethod(indexMethod);
+    populateScene(&scene, itemCount, /*selectable=*/true);
+    scene.items(QPointF(0, 0));
+
+    QBENCHMARK {
+        for (int i = 1; i <= 50; ++i) {
+            QPainterPath path;
+            path.addRect(QRectF(1000, 1000, i * 40, i * 30));
+            scene.setSelectionArea(path, Qt::IntersectsItemShape);
+        }
+        scene.clearSelection();
+    }
+}
+
+void tst_QGraphicsScene::moveItems_data()
+{
+    addIndexRows(QList<int>() << 10000 << 100000);
+}
+
+// Moves a tenth of the items a little, then looks items up, as an animated
+// scene does every frame.
+void tst_QGraphicsScene::moveItems()
+{
+    QFETCH(QGraphicsScene::ItemIndexMethod, indexMethod);
+    QFETCH(int, itemCount);
+
+    QGraphicsScene scene(0, 0, sceneSize, sceneSize);
+    scene.setItemIndexMethod(indexMethod);
+    populateScene(&scene, itemCount);
+    scene.items(QPointF(0, 0));
+
+    QList<QGraphicsItem *> moving = scene.items();
+    moving = moving.mid(0, itemCount / 10);
+
+    int frame = 0;
+    QBENCHMARK {
+        const qreal delta = (frame++ & 1) ? -3 : 3;
+        foreach (QGraphicsItem *item, moving)
+            item->moveBy(delta, delta);
+        scene.items(QRectF(4000, 4000, 1000, 1000), Qt::IntersectsItemBoundingRect);
+    }
+}
+
+QTEST_MAIN(tst_QGraphicsScene)
+#include "tst_qgraphicsscene.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qgraphicsview
+QT += widgets testlib
+SOURCES += tst_qgraphicsview.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,236 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/qmath.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainter.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qgraphicsitem.h>
+#include <QtWidgets/qgraphicsscene.h>
+#include <QtWidgets/qgraphicsview.h>
+
+Q_DECLARE_METATYPE(QGraphicsView::OptimizationFlags)
+Q_DECLARE_METATYPE(QGraphicsView::CacheMode)
+
+class tst_QGraphicsView : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGraphicsView();
+
+private slots:
+    void initTestCase();
+    void paintItems_data();
+    void paintItems();
+    void panItems_data();
+    void panItems();
+    void panZoomBackground_data();
+    void panZoomBackground();
+
+private:
+    void addRows();
+
+    QGraphicsScene scene;
+};
+
+static const int itemCount = 50000;
+static const qreal sceneSize = 10000;
+
+tst_QGraphicsView::tst_QGraphicsView()
+    : scene(0, 0, sceneSize, sceneSize)
+{
+}
+
+// Rect and ellipse items in runs that share a pen and brush, as in a map or
+// a schematic, so that batching has something to work with.
+void tst_QGraphicsView::initTestCase()
+{
+    static const Qt::GlobalColor colors[] = { Qt::red, Qt::darkGreen, Qt::blue, Qt::darkYellow };
+    qsrand(1);
+    for (int i = 0; i < itemCount; ++i) {
+        const int run = i / 500;
+        const QBrush brush(colors[run % 4]);
+        const QRectF rect(0, 0, 4 + qrand() % 12, 4 + qrand() % 12);
+        QAbstractGraphicsShapeItem *item;
+        if (run % 2)
+            item = scene.addEllipse(rect, QPen(Qt::black), brush);
+        else
+            item = scene.addRect(rect, QPen(Qt::black), brush);
+        item->setFlag(QGraphicsItem::ItemPaintsStandardShape);
+        item->setPos(qrand() % int(sceneSize), qrand() % int(sceneSize));
+    }
+}
+
+void tst_QGraphicsView::addRows()
+{
+    QTest::addColumn<qreal>("zoom");
+    QTest::addColumn<QGraphicsView::OptimizationFlags>("flags");
+
+    const qreal zooms[] = { 0.05, 0.2, 1.0, 4.0 };
+    const QGraphicsView::OptimizationFlags all = QGraphicsView::SimplifyTinyItems
+        | QGraphicsView::BatchSimpleItems | QGraphicsView::ElidePainterState;
+    for (size_t i = 0; i < sizeof(zooms) / sizeof(zooms[0]); ++i) {
+        const QByteArray zoom = "zoom " + QByteArray::number(zooms[i]);
+        QTest::newRow(zoom + ", no flags") << zooms[i] << QGraphicsView::OptimizationFlags();
+        QTest::newRow(zoom + ", SimplifyTinyItems") << zooms[i]
+            << QGraphicsView::OptimizationFlags(QGraphicsView::SimplifyTinyItems);
+        QTest::newRow(zoom + ", BatchSimpleItems") << zooms[i]
+            << QGraphicsView::OptimizationFlags(QGraphicsView::BatchSimpleItems);
+        QTest::newRow(zoom + ", ElidePainterState") << zooms[i]
+            << QGraphicsView::OptimizationFlags(QGraphicsView::ElidePainterState);
+        QTest::newRow(zoom + ", DontSavePainterState") << zooms[i]
+            << QGraphicsView::OptimizationFlags(QGraphicsView::DontSavePainterState);
+        QTest::newRow(zoom + ", all") << zooms[i] << all;
+    }
+}
+
+void tst_QGraphicsView::paintItems_data()
+{
+    addRows();
+}
+
+void tst_QGraphicsView::paintItems()
+{
+    QFETCH(qreal, zoom);
+    QFETCH(QGraphicsView::OptimizationFlags, flags);
+
+    QGraphicsView view(&scene);
+    view.setOptimizationFlags(flags);
+    view.setFrameStyle(0);
+    view.resize(1000, 800);
+    view.scale(zoom, zoom);
+    view.centerOn(sceneSize / 2, sceneSize / 2);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view.viewport()->render(&image);
+
+    QBENCHMARK {
+        view.viewport()->render(&image);
+    }
+}
+
+void tst_QGraphicsView::panItems_data()
+{
+    addRows();
+}
+
+// Scrolls across the scene, repainting the whole viewport for each step.
+void tst_QGraphicsView::panItems()
+{
+    QFETCH(qreal, zoom);
+    QFETCH(QGraphicsView::OptimizationFlags, flags);
+
+    QGraphicsView view(&scene);
+    view.setOptimizationFlags(flags);
+    view.setFrameStyle(0);
+    view.resize(1000, 800);
+    view.scale(zoom, zoom);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view.viewport()->render(&image);
+
+    QBENCHMARK {
+        for (int i = 0; i < 20; ++i) {
+            view.centerOn(sceneSize * (i + 1) / 22, sceneSize / 2);
+            view.viewport()->render(&image);
+        }
+    }
+}
+
+// A view with an expensive background, like the grid and shading of a map.
+class BackgroundView : public QGraphicsView
+{
+public:
+    BackgroundView(QGraphicsScene *scene) : QGraphicsView(scene) {}
+
+protected:
+    void drawBackground(QPainter *painter, const QRectF &rect) Q_DECL_OVERRIDE
+    {
+        QRadialGradient gradient(QPointF(sceneSize / 2, sceneSize / 2), sceneSize / 2);
+        gradient.setColorAt(0, Qt::white);
+        gradient.setColorAt(1, Qt::darkCyan);
+        painter->fillRect(rect, gradient);
+
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(Qt::gray, 0));
+        const qreal step = 10;
+        for (qreal x = qFloor(rect.left() / step) * step; x < rect.right(); x += step)
+            painter->drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
+        for (qreal y = qFloor(rect.top() / step) * step; y < rect.bottom(); y += step)
+            painter->drawLine(QPointF(rect.left(), y), QPointF(rect.right(), y));
+    }
+};
+
+void tst_QGraphicsView::panZoomBackground_data()
+{
+    QTest::addColumn<QGraphicsView::CacheMode>("cacheMode");
+
+    QTest::newRow("CacheNone") << QGraphicsView::CacheMode(QGraphicsView::CacheNone);
+    QTest::newRow("CacheBackground") << QGraphicsView::CacheMode(QGraphicsView::CacheBackground);
+    QTest::newRow("CacheBackgroundTiles") << QGraphicsView::CacheMode(QGraphicsView::CacheBackgroundTiles);
+}
+
+// Pans and zooms in small steps, as when dragging or pinching a map, and
+// measures the time needed to present each frame. Rendered tiles are
+// delivered between frames.
+void tst_QGraphicsView::panZoomBackground()
+{
+    QFETCH(QGraphicsView::CacheMode, cacheMode);
+
+    QGraphicsScene emptyScene(0, 0, sceneSize, sceneSize);
+    BackgroundView view(&emptyScene);
+    view.setCacheMode(cacheMode);
+    view.setFrameStyle(0);
+    view.resize(1000, 800);
+    view.scale(0.5, 0.5);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view.viewport()->render(&image);
+
+    QBENCHMARK {
+        view.resetTransform();
+        view.scale(0.5, 0.5);
+        for (int i = 0; i < 40; ++i) {
+            if (i % 4 == 3)
+                view.scale(1.1, 1.1);
+            view.centerOn(sceneSize * (i + 10) / 60, sceneSize * (i + 10) / 60);
+            view.viewport()->render(&image);
+            QCoreApplication::processEvents();
+        }
+    }
+}
+
+QTEST_MAIN(tst_QGraphicsView)
+#include "tst_qgraphicsview.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qhttp2
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qhttp2.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,251 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qendian.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+
+// A minimal server answering every request with the same small resource,
+// either over HTTP/1.1 with keep-alive or over cleartext HTTP/2 (prior
+// knowledge). Request headers are not decoded; the response header block
+// only uses the static HPACK table so no compression state is needed.
+class MiniServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit MiniServer(const QByteArray &body)
+        : m_body(body), m_http2Streams(0)
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    }
+
+    int http2Streams() const { return m_http2Streams; }
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            m_buffers[socket].clear(); // the address may belong to an earlier socket
+            connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        }
+    }
+
+    void readClient()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = m_buffers[socket];
+        buffer.append(socket->readAll());
+
+        static const QByteArray preface("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+        if (!socket->property("http2").isValid()) {
+            if (buffer.size() < preface.size())
+                return;
+            const bool http2 = buffer.startsWith(preface);
+            socket->setProperty("http2", http2);
+            if (http2) {
+                buffer.remove(0, preface.size());
+                sendSettings(socket);
+            }
+        }
+
+        if (socket->property("http2").toBool())
+            readHttp2(socket, buffer);
+        else
+            readHttp1(socket, buffer);
+    }
+
+private:
+    void readHttp1(QTcpSocket *socket, QByteArray &buffer)
+    {
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            buffer.remove(0, end + 4);
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: "
+                          + QByteArray::number(m_body.size()) + "\r\n\r\n" + m_body);
+        }
+    }
+
+    void readHttp2(QTcpSocket *socket, QByteArray &buffer)
+    {
+        int offset = 0;
+        while (buffer.size() - offset >= 9) {
+            const uchar *header = reinterpret_cast<const uchar *>(buffer.constData()) + offset;
+            const int length = (header[0] << 16) | (header[1] << 8) | header[2];
+            if (buffer.size() - offset < 9 + length)
+                break;
+            const uchar type = header[3];
+            const uchar flags = header[4];
+            const quint32 streamID = qFromBigEndian<quint32>(header + 5) & 0x7fffffff;
+            const QByteArray payload = buffer.mid(offset + 9, length);
+            offset += 9 + length;
+
+            switch (type) {
+            case 0x1: // HEADERS; a GET request ends the stream right away
+                if (flags & 0x1)
+                    respond(socket, streamID);
+                break;
+            case 0x4: // SETTINGS
+                if (!(flags & 0x1))
+                    sendFrame(socket, 0x4, 0x1, 0, QByteArray());
+                break;
+            case 0x6: // PING
+                if (!(flags & 0x1))
+                    sendFrame(socket, 0x6, 0x1, 0, payload);
+                break;
+            default:
+                break;
+            }
+        }
+        buffer.remove(0, offset);
+    }
+
+    void sendSettings(QTcpSocket *socket)
+    {
+        QByteArray settings(6, 0);
+        qToBigEndian<quint16>(0x3, reinterpret_cast<uchar *>(settings.data())); // MAX_CONCURRENT_STREAMS
+        qToBigEndian<quint32>(100, reinterpret_cast<uchar *>(settings.data() + 2));
+        sendFrame(socket, 0x4, 0, 0, settings);
+    }
+
+    void respond(QTcpSocket *socket, quint32 streamID)
+    {
+        ++m_http2Streams;
+        QByteArray block;
+        block.append(char(0x88)); // :status 200, static index 8
+        block.append(char(0x0f)); // content-length, literal without indexing, static index 28
+        block.append(char(0x0d));
+        const QByteArray length = QByteArray::number(m_body.size());
+        block.append(char(length.size()));
+        block.append(length);
+        sendFrame(socket, 0x1, 0x4, streamID, block); // END_HEADERS
+        sendFrame(socket, 0x0, 0x1, streamID, m_body); // END_STREAM
+    }
+
+    static void sendFrame(QTcpSocket *socket, uchar type, uchar flags, quint32 streamID,
+                          const QByteArray &payload)
+    {
+        char header[9];
+        header[0] = char(payload.size() >> 16);
+        header[1] = char(payload.size() >> 8);
+        header[2] = char(payload.size());
+        header[3] = char(type);
+        header[4] = char(flags);
+        qToBigEndian<quint32>(streamID, reinterpret_cast<uchar *>(header + 5));
+        socket->write(header, sizeof(header));
+        socket->write(payload);
+    }
+
+    QByteArray m_body;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    int m_http2Streams;
+};
+
+class tst_qhttp2 : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fetchSmallResources_data();
+    void fetchSmallResources();
+
+protected slots:
+    void replyFinished();
+
+private:
+    QEventLoop *m_loop;
+    int m_pending;
+    int m_failures;
+    int m_http2Replies;
+};
+
+void tst_qhttp2::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (reply->error() != QNetworkReply::NoError || reply->readAll().isEmpty())
+        ++m_failures;
+    if (reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool())
+        ++m_http2Replies;
+    reply->deleteLater();
+    if (--m_pending == 0)
+        m_loop->quit();
+}
+
+void tst_qhttp2::fetchSmallResources_data()
+{
+    QTest::addColumn<bool>("http2");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("http/1.1, 10000 resources") << false << 10000;
+    QTest::newRow("http/2, 10000 resources") << true << 10000;
+}
+
+void tst_qhttp2::fetchSmallResources()
+{
+    QFETCH(bool, http2);
+    QFETCH(int, count);
+
+    MiniServer server(QByteArray(512, 'x'));
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QString urlTemplate = QString("http://127.0.0.1:%1/resource/%2").arg(server.serverPort());
+
+    QNetworkAccessManager manager;
+    QEventLoop loop;
+    m_loop = &loop;
+
+    QBENCHMARK_ONCE {
+        m_pending = count;
+        m_failures = 0;
+        m_http2Replies = 0;
+        for (int i = 0; i < count; ++i) {
+            QNetworkRequest request(QUrl(urlTemplate.arg(i)));
+            request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, http2);
+            QNetworkReply *reply = manager.get(request);
+            connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+        }
+        loop.exec();
+    }
+
+    QCOMPARE(m_failures, 0);
+    QCOMPARE(m_http2Replies, http2 ? count : 0);
+    QCOMPARE(server.http2Streams(), http2 ? count : 0);
+}
+
+QTEST_MAIN(tst_qhttp2)
+
+#include "tst_qhttp2.moc"
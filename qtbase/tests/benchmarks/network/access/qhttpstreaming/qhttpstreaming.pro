@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_bench_qhttpstreaming
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qhttpstreaming.cpp
+HEADERS += ../../../../shared/networkbenchmark.h
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
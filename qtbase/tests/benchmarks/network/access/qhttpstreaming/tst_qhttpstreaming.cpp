@@ -0,0 +1,257 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtNetwork/qhttpmultipartreader.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include "../../../../shared/networkbenchmark.h"
+
+// The size of every response body, not counting the chunk or part framing.
+static const qint64 TotalBytes = 64 * 1024 * 1024;
+
+static const char Boundary[] = "qhttpstreaming-boundary";
+
+// Writes one response to a socket, a chunk or part at a time, keeping
+// about 1 MB queued, so that the server does not buffer the whole body.
+class ResponseWriter : public QObject
+{
+    Q_OBJECT
+public:
+    ResponseWriter(QTcpSocket *socket, bool multipart, int pieceSize)
+        : QObject(socket), m_socket(socket), m_multipart(multipart),
+          m_piece(pieceSize, 'x'), m_sent(0)
+    {
+        if (m_multipart) {
+            // no Content-Length; the end of the connection ends the body
+            m_socket->write("HTTP/1.1 206 Partial Content\r\n"
+                            "Content-Type: multipart/byteranges; boundary=\"");
+            m_socket->write(Boundary);
+            m_socket->write("\"\r\nConnection: close\r\n\r\n");
+        } else {
+            m_socket->write("HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/octet-stream\r\n"
+                            "Transfer-Encoding: chunked\r\n\r\n");
+        }
+        connect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(fill()));
+        fill();
+    }
+
+private slots:
+    void fill()
+    {
+        while (m_sent < TotalBytes && m_socket->bytesToWrite() < 1024 * 1024) {
+            const int size = int(qMin<qint64>(m_piece.size(), TotalBytes - m_sent));
+            if (m_multipart) {
+                m_socket->write("\r\n--");
+                m_socket->write(Boundary);
+                m_socket->write("\r\nContent-Type: application/octet-stream\r\nContent-Range: bytes "
+                                + QByteArray::number(m_sent) + '-' + QByteArray::number(m_sent + size - 1)
+                                + '/' + QByteArray::number(TotalBytes) + "\r\n\r\n");
+                m_socket->write(m_piece.constData(), size);
+            } else {
+                m_socket->write(QByteArray::number(size, 16) + "\r\n");
+                m_socket->write(m_piece.constData(), size);
+                m_socket->write("\r\n");
+            }
+            m_sent += size;
+        }
+        if (m_sent < TotalBytes)
+            return;
+
+        disconnect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(fill()));
+        if (m_multipart) {
+            m_socket->write("\r\n--");
+            m_socket->write(Boundary);
+            m_socket->write("--\r\n");
+            m_socket->disconnectFromHost();
+        } else {
+            m_socket->write("0\r\n\r\n");
+        }
+        deleteLater();
+    }
+
+private:
+    QTcpSocket *m_socket;
+    bool m_multipart;
+    QByteArray m_piece;
+    qint64 m_sent;
+};
+
+// Answers GET /chunked/<size> with a chunked body of chunks of that size,
+// and GET /multipart/<size> with a multipart/byteranges body of parts of
+// that size.
+class StreamingServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    StreamingServer()
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    }
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        }
+    }
+
+    void readClient()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        while (socket->canReadLine()) {
+            const QByteArray line = socket->readLine().trimmed();
+            if (line.startsWith("GET ")) {
+                socket->setProperty("path", line.split(' ').value(1));
+            } else if (line.isEmpty()) {
+                const QList<QByteArray> path = socket->property("path").toByteArray().split('/');
+                new ResponseWriter(socket, path.value(1) == "multipart", path.value(2).toInt());
+            }
+        }
+    }
+};
+
+class tst_QHttpStreaming : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QHttpStreaming() : m_serverThread(0) {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void chunked_data();
+    void chunked();
+    void multipart_data();
+    void multipart();
+
+private:
+    QUrl url(const QString &path) const;
+
+    ServerThread *m_serverThread;
+};
+
+void tst_QHttpStreaming::initTestCase()
+{
+    m_serverThread = new ServerThread(new StreamingServer);
+    m_serverThread->startServer();
+    QVERIFY(m_serverThread->port);
+}
+
+void tst_QHttpStreaming::cleanupTestCase()
+{
+    delete m_serverThread;
+}
+
+QUrl tst_QHttpStreaming::url(const QString &path) const
+{
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(QStringLiteral("127.0.0.1"));
+    url.setPort(m_serverThread->port);
+    url.setPath(path);
+    return url;
+}
+
+void tst_QHttpStreaming::chunked_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("1KB") << 1024;
+    QTest::newRow("16KB") << 16 * 1024;
+    QTest::newRow("256KB") << 256 * 1024;
+}
+
+void tst_QHttpStreaming::chunked()
+{
+    QFETCH(int, chunkSize);
+
+    QNetworkAccessManager manager;
+    const QNetworkRequest request(url(QStringLiteral("/chunked/%1").arg(chunkSize)));
+    QBENCHMARK {
+        Sink sink;
+        QNetworkReply *reply = manager.get(request);
+        connect(reply, SIGNAL(readyRead()), &sink, SLOT(readReply()));
+        connect(reply, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        sink.readReply();
+        QCOMPARE(sink.bytes, TotalBytes);
+        delete reply;
+    }
+}
+
+void tst_QHttpStreaming::multipart_data()
+{
+    QTest::addColumn<int>("partSize");
+
+    QTest::newRow("64KB") << 64 * 1024;
+    QTest::newRow("1MB") << 1024 * 1024;
+}
+
+void tst_QHttpStreaming::multipart()
+{
+    QFETCH(int, partSize);
+
+    QNetworkAccessManager manager;
+    const QNetworkRequest request(url(QStringLiteral("/multipart/%1").arg(partSize)));
+    QBENCHMARK {
+        Sink sink;
+        QNetworkReply *reply = manager.get(request);
+        QHttpMultiPartReader reader(reply);
+        connect(&reader, SIGNAL(partStarted()), &sink, SLOT(startPart()));
+        connect(&reader, SIGNAL(partData(QByteArray)), &sink, SLOT(addPartData(QByteArray)));
+        connect(&reader, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reader.error(), QHttpMultiPartReader::NoError);
+        QVERIFY(reader.atEnd());
+        QCOMPARE(sink.bytes, TotalBytes);
+        QCOMPARE(qint64(sink.parts), TotalBytes / partSize);
+        delete reply;
+    }
+}
+
+QTEST_MAIN(tst_QHttpStreaming)
+
+#include "tst_qhttpstreaming.moc"
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qtemporaryfile.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include "../../../../shared/networkbenchmark.h"
+
+// A server discarding request bodies as fast as it can and answering each
+// request once its Content-Length has been received. It runs in a thread
+// of its own so that it does not compete with the client for the event loop.
+class SinkServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    SinkServer()
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    }
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            socket->setReadBufferSize(0);
+            connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        }
+    }
+
+    void readClient()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        char sink[256 * 1024];
+        qint64 remaining = socket->property("remaining").toLongLong();
+        while (socket->bytesAvailable()) {
+            if (remaining > 0) {
+                const qint64 read = socket->read(sink, qMin(remaining, qint64(sizeof sink)));
+                if (read <= 0)
+                    break;
+                remaining -= read;
+                if (remaining == 0)
+                    socket->write("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+                continue;
+            }
+            if (!socket->canReadLine())
+                break;
+            // headers; a blank line starts the body
+            const QByteArray line = socket->readLine().trimmed();
+            if (line.toLower().startsWith("content-length:"))
+                socket->setProperty("length", line.mid(15).trimmed().toLongLong());
+            else if (line.isEmpty())
+                remaining = socket->property("length").toLongLong();
+        }
+        socket->setProperty("remaining", remaining);
+    }
+};
+
+// Forwards to a file without being a QFile, which makes QNetworkAccessManager
+// take the generic QIODevice upload path: read into QByteArrays and copy
+// them to the HTTP thread.
+class FileProxyDevice : public QIODevice
+{
+public:
+    explicit FileProxyDevice(QFile *file) : m_file(file) { open(QIODevice::ReadOnly); }
+    bool isSequential() const Q_DECL_OVERRIDE { return false; }
+    qint64 size() const Q_DECL_OVERRIDE { return m_file->size(); }
+    bool seek(qint64 pos) Q_DECL_OVERRIDE { return QIODevice::seek(pos) && m_file->seek(pos); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE { return m_file->read(data, maxSize); }
+    qint64 writeData(const char *, qint64) Q_DECL_OVERRIDE { return -1; }
+
+private:
+    QFile *m_file;
+};
+
+class tst_QHttpUpload : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QHttpUpload() : m_serverThread(0) {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void upload_data();
+    void upload();
+
+private:
+    ServerThread *m_serverThread;
+    QTemporaryFile m_file;
+};
+
+void tst_QHttpUpload::initTestCase()
+{
+    // 256 MB of data, written in 1 MB blocks
+    QVERIFY(m_file.open());
+    const QByteArray block(1024 * 1024, 'x');
+    for (int i = 0; i < 256; ++i)
+        QCOMPARE(m_file.write(block), qint64(block.size()));
+    QVERIFY(m_file.flush());
+
+    m_serverThread = new ServerThread(new SinkServer);
+    m_serverThread->startServer();
+    QVERIFY(m_serverThread->port);
+}
+
+void tst_QHttpUpload::cleanupTestCase()
+{
+    delete m_serverThread;
+}
+
+void tst_QHttpUpload::upload_data()
+{
+    QTest::addColumn<bool>("mapped");
+
+    QTest::newRow("QFile") << true;
+    QTest::newRow("generic-QIODevice") << false;
+}
+
+void tst_QHttpUpload::upload()
+{
+    QFETCH(bool, mapped);
+
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(QStringLiteral("127.0.0.1"));
+    url.setPort(m_serverThread->port);
+    url.setPath(QStringLiteral("/upload"));
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArrayLiteral("application/octet-stream"));
+
+    QNetworkAccessManager manager;
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    int uploads = 0;
+
+    QBENCHMARK {
+        QFile file(m_file.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        FileProxyDevice proxy(&file);
+        QIODevice *device = mapped ? static_cast<QIODevice *>(&file) : &proxy;
+
+        timer.start();
+        QScopedPointer<QNetworkReply> reply(manager.put(request, device));
+        connect(reply.data(), SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(120);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        elapsed += timer.elapsed();
+        ++uploads;
+    }
+
+    if (elapsed)
+        qDebug("%.1f MB/s", double(m_file.size()) * uploads / (1024 * 1024) / (elapsed / 1000.0));
+}
+
+QTEST_MAIN(tst_QHttpUpload)
+
+#include "tst_qhttpupload.moc"
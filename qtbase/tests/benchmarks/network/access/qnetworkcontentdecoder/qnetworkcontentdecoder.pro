@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_bench_qnetworkcontentdecoder
+
+QT -= gui
+QT += core-private network-private testlib
+
+CONFIG += release
+
+SOURCES += tst_qnetworkcontentdecoder.cpp
+HEADERS += ../../../../shared/networkbenchmark.h
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,302 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/private/qringbuffer_p.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkcontentdecoder.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtNetwork/private/qnetworkcontentdecoder_p.h>
+
+#include "../../../../shared/networkbenchmark.h"
+
+// A content coding that is not compressed at all, to measure the cost of
+// the pluggable decoder path itself.
+static const char CopyCoding[] = "x-copy";
+
+class CopyDecoder : public QNetworkContentDecoder
+{
+public:
+    bool decode(const char *input, qint64 inputSize, qint64 *inputUsed,
+                char *output, qint64 outputSize, qint64 *outputUsed) Q_DECL_OVERRIDE
+    {
+        const qint64 size = qMin(inputSize, outputSize);
+        memcpy(output, input, size);
+        *inputUsed = size;
+        *outputUsed = size;
+        return true;
+    }
+
+    bool atEnd() const Q_DECL_OVERRIDE { return false; }
+
+    static QNetworkContentDecoder *create() { return new CopyDecoder; }
+};
+
+// About 32 MB of JSON records, which compresses roughly ten to one.
+static QByteArray createJson()
+{
+    QByteArray json;
+    json.reserve(33 * 1024 * 1024);
+    json += '[';
+    for (int i = 0; json.size() < 32 * 1024 * 1024; ++i) {
+        if (i)
+            json += ',';
+        json += "{\"id\":" + QByteArray::number(i)
+                + ",\"name\":\"item " + QByteArray::number(i)
+                + "\",\"tags\":[\"network\",\"benchmark\",\"json\"],\"value\":"
+                + QByteArray::number(i * 0.25) + ",\"active\":"
+                + (i % 3 ? "true" : "false") + '}';
+    }
+    json += ']';
+    return json;
+}
+
+static QByteArray compress(const QByteArray &coding, const QByteArray &data)
+{
+    QZlibContentEncoder encoder(coding);
+    QRingBuffer buffer;
+    if (!encoder.encode(data.constData(), data.size(), &buffer) || !encoder.finish(&buffer))
+        return QByteArray();
+    return buffer.read();
+}
+
+// Serves GET /<coding> with the JSON body in that content coding, and
+// answers POST requests with the number of body bytes it received.
+class ContentServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit ContentServer(const QHash<QByteArray, QByteArray> &bodies)
+        : m_bodies(bodies)
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    }
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+            connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        }
+    }
+
+    void readClient()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+        forever {
+            qint64 bodyLeft = socket->property("bodyLeft").toLongLong();
+            if (bodyLeft > 0) {
+                const qint64 skipped = socket->read(qMin<qint64>(bodyLeft, 64 * 1024)).size();
+                if (!skipped)
+                    return;
+                bodyLeft -= skipped;
+                socket->setProperty("bodyLeft", bodyLeft);
+                if (!bodyLeft)
+                    respond(socket, "200 OK", QByteArray(),
+                            QByteArray::number(socket->property("bodySize").toLongLong()));
+                continue;
+            }
+            if (!socket->canReadLine())
+                return;
+
+            const QByteArray line = socket->readLine().trimmed();
+            if (line.startsWith("GET ") || line.startsWith("POST ")) {
+                socket->setProperty("request", line);
+                socket->setProperty("bodySize", 0);
+            } else if (line.toLower().startsWith("content-length:")) {
+                socket->setProperty("bodySize", line.mid(15).trimmed().toLongLong());
+            } else if (line.isEmpty()) {
+                const QList<QByteArray> request = socket->property("request").toByteArray().split(' ');
+                if (request.value(0) == "POST") {
+                    const qint64 bodySize = socket->property("bodySize").toLongLong();
+                    if (bodySize > 0)
+                        socket->setProperty("bodyLeft", bodySize);
+                    else
+                        respond(socket, "200 OK", QByteArray(), "0");
+                } else {
+                    const QByteArray coding = request.value(1).mid(1);
+                    if (m_bodies.contains(coding))
+                        respond(socket, "200 OK", coding == "identity" ? QByteArray() : coding,
+                                m_bodies.value(coding));
+                    else
+                        respond(socket, "404 Not Found", QByteArray(), QByteArray());
+                }
+            }
+        }
+    }
+
+private:
+    static void respond(QTcpSocket *socket, const char *status, const QByteArray &coding,
+                        const QByteArray &body)
+    {
+        QByteArray header = "HTTP/1.1 " + QByteArray(status) + "\r\n"
+                "Content-Type: application/json\r\n"
+                "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        if (!coding.isEmpty())
+            header += "Content-Encoding: " + coding + "\r\n";
+        header += "\r\n";
+        socket->write(header);
+        socket->write(body);
+    }
+
+    const QHash<QByteArray, QByteArray> m_bodies;
+};
+
+class tst_QNetworkContentDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QNetworkContentDecoder() : m_serverThread(0) {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void download_data();
+    void download();
+    void upload_data();
+    void upload();
+
+private:
+    QUrl url(const QString &path) const;
+
+    QByteArray m_json;
+    ServerThread *m_serverThread;
+};
+
+void tst_QNetworkContentDecoder::initTestCase()
+{
+    m_json = createJson();
+
+    QHash<QByteArray, QByteArray> bodies;
+    bodies.insert("identity", m_json);
+    bodies.insert(CopyCoding, m_json);
+    bodies.insert("gzip", compress("gzip", m_json));
+    bodies.insert("deflate", compress("deflate", m_json));
+    QVERIFY(!bodies.value("gzip").isEmpty());
+    QVERIFY(!bodies.value("deflate").isEmpty());
+
+    QNetworkContentDecoder::registerContentCoding(CopyCoding, &CopyDecoder::create);
+
+    m_serverThread = new ServerThread(new ContentServer(bodies));
+    m_serverThread->startServer();
+    QVERIFY(m_serverThread->port);
+}
+
+void tst_QNetworkContentDecoder::cleanupTestCase()
+{
+    QNetworkContentDecoder::unregisterContentCoding(CopyCoding);
+    delete m_serverThread;
+}
+
+QUrl tst_QNetworkContentDecoder::url(const QString &path) const
+{
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(QStringLiteral("127.0.0.1"));
+    url.setPort(m_serverThread->port);
+    url.setPath(path);
+    return url;
+}
+
+void tst_QNetworkContentDecoder::download_data()
+{
+    QTest::addColumn<QString>("coding");
+
+    QTest::newRow("identity") << QStringLiteral("identity");
+    QTest::newRow("registered") << QString::fromLatin1(CopyCoding);
+    QTest::newRow("gzip") << QStringLiteral("gzip");
+    QTest::newRow("deflate") << QStringLiteral("deflate");
+}
+
+void tst_QNetworkContentDecoder::download()
+{
+    QFETCH(QString, coding);
+
+    QNetworkAccessManager manager;
+    const QNetworkRequest request(url(QLatin1Char('/') + coding));
+    QBENCHMARK {
+        Sink sink;
+        QNetworkReply *reply = manager.get(request);
+        connect(reply, SIGNAL(readyRead()), &sink, SLOT(readReply()));
+        connect(reply, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        sink.readReply();
+        QCOMPARE(sink.bytes, qint64(m_json.size()));
+        delete reply;
+    }
+}
+
+void tst_QNetworkContentDecoder::upload_data()
+{
+    QTest::addColumn<QByteArray>("coding");
+
+    QTest::newRow("identity") << QByteArray();
+    QTest::newRow("gzip") << QByteArray("gzip");
+    QTest::newRow("deflate") << QByteArray("deflate");
+}
+
+void tst_QNetworkContentDecoder::upload()
+{
+    QFETCH(QByteArray, coding);
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(url(QStringLiteral("/upload")));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QByteArray("application/json"));
+    if (!coding.isEmpty())
+        request.setAttribute(QNetworkRequest::UploadContentEncodingAttribute, coding);
+    QBENCHMARK {
+        QNetworkReply *reply = manager.post(request, m_json);
+        connect(reply, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        const qint64 received = reply->readAll().toLongLong();
+        if (coding.isEmpty())
+            QCOMPARE(received, qint64(m_json.size()));
+        else
+            QVERIFY(received > 0 && received < m_json.size());
+        delete reply;
+    }
+}
+
+QTEST_MAIN(tst_QNetworkContentDecoder)
+
+#include "tst_qnetworkcontentdecoder.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qnetworkdiskcache
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qnetworkdiskcache.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qtemporarydir.h>
+#include <QtNetwork/qnetworkdiskcache.h>
+
+class tst_qnetworkdiskcache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void insert_data();
+    void insert();
+    void lookup_data();
+    void lookup();
+    void expire_data();
+    void expire();
+    void reopen_data();
+    void reopen();
+
+private:
+    void addEntryCountRows();
+    static QUrl urlFor(int i);
+    static void populate(QNetworkDiskCache *cache, int count);
+};
+
+void tst_qnetworkdiskcache::addEntryCountRows()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10k entries") << 10000;
+    QTest::newRow("100k entries") << 100000;
+    QTest::newRow("1M entries") << 1000000;
+}
+
+QUrl tst_qnetworkdiskcache::urlFor(int i)
+{
+    return QUrl(QString("http://tiles.example.com/%1/%2/%3.png").arg(i % 19).arg(i / 1000).arg(i));
+}
+
+void tst_qnetworkdiskcache::populate(QNetworkDiskCache *cache, int count)
+{
+    static const QByteArray payload(200, 'x');
+    QNetworkCacheMetaData::RawHeaderList headers;
+    headers << qMakePair(QByteArray("Content-Type"), QByteArray("text/plain"))
+            << qMakePair(QByteArray("Content-Length"), QByteArray::number(payload.size()));
+
+    for (int i = 0; i < count; ++i) {
+        QNetworkCacheMetaData metaData;
+        metaData.setUrl(urlFor(i));
+        metaData.setRawHeaders(headers);
+        metaData.setSaveToDisk(true);
+        QIODevice *device = cache->prepare(metaData);
+        device->write(payload);
+        cache->insert(device);
+    }
+}
+
+void tst_qnetworkdiskcache::insert_data()
+{
+    addEntryCountRows();
+}
+
+void tst_qnetworkdiskcache::insert()
+{
+    QFETCH(int, count);
+
+    QTemporaryDir dir;
+    QNetworkDiskCache cache;
+    cache.setMaximumCacheSize(qint64(count) * 4096);
+    cache.setCacheDirectory(dir.path());
+
+    // measures the cost on the calling thread; files are written in the background
+    QBENCHMARK_ONCE {
+        populate(&cache, count);
+    }
+}
+
+void tst_qnetworkdiskcache::lookup_data()
+{
+    addEntryCountRows();
+}
+
+void tst_qnetworkdiskcache::lookup()
+{
+    QFETCH(int, count);
+
+    QTemporaryDir dir;
+    QNetworkDiskCache cache;
+    cache.setMaximumCacheSize(qint64(count) * 4096);
+    cache.setCacheDirectory(dir.path());
+    populate(&cache, count);
+    // waits for the background writes to finish
+    QVERIFY(cache.metaData(urlFor(count - 1)).isValid());
+
+    // half of the lookups are misses
+    QBENCHMARK {
+        for (int i = 0; i < 2000; ++i) {
+            const int n = (i * 7919) % (count * 2);
+            const bool cached = cache.metaData(urlFor(n)).isValid();
+            if (cached != (n < count))
+                QFAIL("unexpected lookup result");
+        }
+    }
+}
+
+void tst_qnetworkdiskcache::expire_data()
+{
+    addEntryCountRows();
+}
+
+void tst_qnetworkdiskcache::expire()
+{
+    QFETCH(int, count);
+
+    QTemporaryDir dir;
+    QNetworkDiskCache cache;
+    cache.setMaximumCacheSize(qint64(count) * 4096);
+    cache.setCacheDirectory(dir.path());
+    populate(&cache, count);
+    const qint64 size = cache.cacheSize();
+
+    QBENCHMARK_ONCE {
+        cache.setMaximumCacheSize(size / 2);
+    }
+    QVERIFY(cache.cacheSize() < size / 2);
+}
+
+void tst_qnetworkdiskcache::reopen_data()
+{
+    addEntryCountRows();
+}
+
+void tst_qnetworkdiskcache::reopen()
+{
+    QFETCH(int, count);
+
+    QTemporaryDir dir;
+    qint64 size;
+    {
+        QNetworkDiskCache cache;
+        cache.setMaximumCacheSize(qint64(count) * 4096);
+        cache.setCacheDirectory(dir.path());
+        populate(&cache, count);
+        size = cache.cacheSize();
+    }
+
+    // loads the index saved by the previous cache
+    QNetworkDiskCache cache;
+    cache.setMaximumCacheSize(qint64(count) * 4096);
+    QBENCHMARK_ONCE {
+        cache.setCacheDirectory(dir.path());
+    }
+    QCOMPARE(cache.cacheSize(), size);
+}
+
+QTEST_MAIN(tst_qnetworkdiskcache)
+
+#include "tst_qnetworkdiskcache.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qhostinfo
+
+QT -= gui
+QT += network network-private testlib
+
+CONFIG += release
+
+SOURCES += tst_qhostinfo.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
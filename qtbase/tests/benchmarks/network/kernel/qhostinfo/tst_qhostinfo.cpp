@@ -0,0 +1,263 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <qendian.h>
+#include <qeventloop.h>
+#include <qhostinfo.h>
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qudpsocket.h>
+#include <private/qdnsresolver_p.h>
+
+// A stand-in name server on the loopback interface. It answers A queries
+// for any name with an address derived from the name, has no AAAA records,
+// and reports names starting with "missing" as nonexistent.
+class StubDnsServer : public QThread
+{
+public:
+    StubDnsServer() : port(0), stop(false)
+    {
+        start();
+        ready.acquire();
+    }
+
+    ~StubDnsServer()
+    {
+        stop.store(true);
+        wait();
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QUdpSocket socket;
+        socket.bind(QHostAddress(QHostAddress::LocalHost), 0);
+        socket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+        port = socket.localPort();
+        ready.release();
+
+        QVector<QUdpSocket::Datagram> queries;
+        QVector<QUdpSocket::Datagram> answers;
+        while (!stop.load()) {
+            if (!socket.hasPendingDatagrams() && !socket.waitForReadyRead(50))
+                continue;
+            const int count = socket.readDatagrams(queries, 64, 512);
+            answers.clear();
+            for (int i = 0; i < count; ++i) {
+                const QUdpSocket::Datagram &query = queries.at(i);
+                answers << QUdpSocket::Datagram(answer(query.data), query.address, query.port);
+            }
+            if (!answers.isEmpty())
+                socket.writeDatagrams(answers);
+        }
+    }
+
+    quint16 port;
+
+private:
+    static void appendUInt16(QByteArray *message, quint16 value)
+    {
+        message->append(char(value >> 8));
+        message->append(char(value & 0xff));
+    }
+
+    static void appendUInt32(QByteArray *message, quint32 value)
+    {
+        appendUInt16(message, quint16(value >> 16));
+        appendUInt16(message, quint16(value & 0xffff));
+    }
+
+    static QByteArray answer(const QByteArray &query)
+    {
+        // header and a single question; the question ends with type and class
+        int end = 12;
+        while (end < query.size() && query.at(end))
+            end += 1 + uchar(query.at(end));
+        end += 5;
+        if (end > query.size())
+            return QByteArray();
+        const quint16 type = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(query.constData()) + end - 4);
+        const bool missing = query.mid(13, 7) == "missing";
+
+        QByteArray message = query.left(end);
+        const bool hasAddress = !missing && type == QDnsResolver::A;
+        message[2] = char(0x81); // response, recursion desired
+        message[3] = char(missing ? 0x83 : 0x80); // recursion available, NXDOMAIN
+        message[6] = 0;
+        message[7] = hasAddress ? 1 : 0;
+        message[8] = 0;
+        message[9] = hasAddress ? 0 : 1;
+
+        appendUInt16(&message, 0xc00c); // the question name
+        if (hasAddress) {
+            appendUInt16(&message, QDnsResolver::A);
+            appendUInt16(&message, 1);
+            appendUInt32(&message, 300);
+            appendUInt16(&message, 4);
+            appendUInt32(&message, 0x0a000000 | (qHash(query.mid(12, end - 16)) & 0xffffff));
+        } else {
+            appendUInt16(&message, QDnsResolver::SOA);
+            appendUInt16(&message, 1);
+            appendUInt32(&message, 300);
+            appendUInt16(&message, 22);
+            message.append('\0'); // primary name server
+            message.append('\0'); // mailbox
+            for (int i = 0; i < 4; ++i)
+                appendUInt32(&message, 3600);
+            appendUInt32(&message, 30); // negative caching TTL
+        }
+        return message;
+    }
+
+    QSemaphore ready;
+    QAtomicInt stop;
+};
+
+class LookupCounter : public QObject
+{
+    Q_OBJECT
+public:
+    LookupCounter() : expected(0), received(0), failed(0) {}
+
+    int expected;
+    int received;
+    int failed;
+    QEventLoop loop;
+
+public slots:
+    void resultsReady(const QHostInfo &info)
+    {
+        if (info.error() != QHostInfo::NoError)
+            ++failed;
+        if (++received == expected)
+            loop.quit();
+    }
+};
+
+class tst_QHostInfo : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void lookupHost_data();
+    void lookupHost();
+    void fromName();
+
+private:
+    StubDnsServer *server;
+};
+
+void tst_QHostInfo::initTestCase()
+{
+    server = new StubDnsServer;
+    QVERIFY(server->port);
+
+    QDnsResolver *resolver = QDnsResolver::instance();
+    QVERIFY(resolver);
+    QDnsResolver::Configuration configuration;
+    configuration.nameservers << QDnsResolver::Nameserver(QHostAddress(QHostAddress::LocalHost), server->port);
+    configuration.timeout = 1000;
+    resolver->setConfiguration(configuration);
+
+    QHostInfo::setResolverBackend(QHostInfo::BuiltInResolver);
+    QHostInfo::setCacheSize(100000);
+    QHostInfo::setNegativeCacheAge(60);
+}
+
+void tst_QHostInfo::cleanupTestCase()
+{
+    QHostInfo::setResolverBackend(QHostInfo::SystemResolver);
+    delete server;
+}
+
+void tst_QHostInfo::lookupHost_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("missing");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("resolve-1000") << 1000 << false << false;
+    QTest::newRow("resolve-10000") << 10000 << false << false;
+    QTest::newRow("resolve-10000-cached") << 10000 << false << true;
+    QTest::newRow("nonexistent-1000") << 1000 << true << false;
+    QTest::newRow("nonexistent-1000-cached") << 1000 << true << true;
+}
+
+void tst_QHostInfo::lookupHost()
+{
+    QFETCH(int, count);
+    QFETCH(bool, missing);
+    QFETCH(bool, cached);
+
+    QStringList names;
+    for (int i = 0; i < count; ++i)
+        names << QString::fromLatin1("%1%2.bench.test").arg(missing ? "missing" : "host").arg(i);
+
+    LookupCounter counter;
+    counter.expected = count;
+    if (cached) {
+        foreach (const QString &name, names)
+            QHostInfo::lookupHost(name, &counter, SLOT(resultsReady(QHostInfo)));
+        counter.loop.exec();
+    }
+
+    QBENCHMARK {
+        if (!cached) {
+            // empty the cache
+            QHostInfo::setCacheSize(0);
+            QHostInfo::setCacheSize(100000);
+        }
+        counter.received = counter.failed = 0;
+        foreach (const QString &name, names)
+            QHostInfo::lookupHost(name, &counter, SLOT(resultsReady(QHostInfo)));
+        counter.loop.exec();
+    }
+
+    QCOMPARE(counter.failed, missing ? count : 0);
+}
+
+void tst_QHostInfo::fromName()
+{
+    int i = 0;
+    QBENCHMARK {
+        const QHostInfo info = QHostInfo::fromName(QString::fromLatin1("blocking%1.bench.test").arg(i++));
+        QCOMPARE(info.error(), QHostInfo::NoError);
+    }
+}
+
+QTEST_MAIN(tst_QHostInfo)
+
+#include "tst_qhostinfo.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qudpsocket
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qudpsocket.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,309 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <qatomic.h>
+#include <qelapsedtimer.h>
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qudpsocket.h>
+#include <qtcpserver.h>
+#include <qtcpsocket.h>
+
+// Batch size used by the batched calls, and the number of datagrams each
+// benchmark iteration moves over the loopback interface.
+static const int batchSize = 64;
+static const int datagramCount = 20000;
+
+class tst_QUdpSocket : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void receive_data();
+    void receive();
+    void send_data();
+    void send();
+    void reusePort_data();
+    void reusePort();
+    void tcpWrite_data();
+    void tcpWrite();
+};
+
+static bool bindLoopback(QUdpSocket *socket, quint16 port = 0,
+                         QAbstractSocket::BindMode mode = QAbstractSocket::DefaultForPlatform)
+{
+    if (!socket->bind(QHostAddress::LocalHost, port, mode))
+        return false;
+    socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+    return true;
+}
+
+void tst_QUdpSocket::receive_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("64-single") << 64 << false;
+    QTest::newRow("64-batched") << 64 << true;
+    QTest::newRow("512-single") << 512 << false;
+    QTest::newRow("512-batched") << 512 << true;
+    QTest::newRow("1400-single") << 1400 << false;
+    QTest::newRow("1400-batched") << 1400 << true;
+}
+
+void tst_QUdpSocket::receive()
+{
+    QFETCH(int, size);
+    QFETCH(bool, batched);
+
+    QUdpSocket receiver;
+    QUdpSocket sender;
+    QVERIFY(bindLoopback(&receiver));
+    QVERIFY(bindLoopback(&sender));
+
+    // send in rounds small enough to fit in the receive buffer, so that
+    // nothing is dropped and every round can be drained completely
+    QVector<QUdpSocket::Datagram> outgoing(batchSize * 4,
+        QUdpSocket::Datagram(QByteArray(size, 'a'), QHostAddress::LocalHost, receiver.localPort()));
+    QVector<QUdpSocket::Datagram> incoming;
+    QByteArray buffer(size, Qt::Uninitialized);
+
+    QBENCHMARK {
+        int received = 0;
+        while (received < datagramCount) {
+            const int round = received + outgoing.size();
+            QCOMPARE(sender.writeDatagrams(outgoing), outgoing.size());
+            while (received < round) {
+                if (!receiver.hasPendingDatagrams())
+                    QVERIFY(receiver.waitForReadyRead(5000));
+                if (batched) {
+                    const int n = receiver.readDatagrams(incoming, batchSize, size);
+                    QVERIFY(n >= 0);
+                    received += n;
+                } else {
+                    while (receiver.hasPendingDatagrams()) {
+                        QCOMPARE(receiver.readDatagram(buffer.data(), size), qint64(size));
+                        ++received;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void tst_QUdpSocket::send_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("64-single") << 64 << false;
+    QTest::newRow("64-batched") << 64 << true;
+    QTest::newRow("1400-single") << 1400 << false;
+    QTest::newRow("1400-batched") << 1400 << true;
+}
+
+void tst_QUdpSocket::send()
+{
+    QFETCH(int, size);
+    QFETCH(bool, batched);
+
+    // nobody reads; the kernel drops what does not fit, which is fine
+    // since only the sending side is measured
+    QUdpSocket receiver;
+    QUdpSocket sender;
+    QVERIFY(bindLoopback(&receiver));
+    QVERIFY(bindLoopback(&sender));
+
+    const QByteArray payload(size, 'a');
+    const QVector<QUdpSocket::Datagram> outgoing(batchSize,
+        QUdpSocket::Datagram(payload, QHostAddress::LocalHost, receiver.localPort()));
+
+    QBENCHMARK {
+        if (batched) {
+            for (int sent = 0; sent < datagramCount; sent += outgoing.size())
+                QVERIFY(sender.writeDatagrams(outgoing) > 0);
+        } else {
+            for (int sent = 0; sent < datagramCount; ++sent)
+                QCOMPARE(sender.writeDatagram(payload, QHostAddress::LocalHost, receiver.localPort()),
+                         qint64(size));
+        }
+    }
+}
+
+class ReceiverThread : public QThread
+{
+public:
+    ReceiverThread(quint16 port, QAtomicInt *total, int target)
+        : port(port), total(total), target(target), bound(false) {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QUdpSocket socket;
+        bound = bindLoopback(&socket, port, QAbstractSocket::ReusePortHint);
+        ready.release();
+        if (!bound)
+            return;
+        QVector<QUdpSocket::Datagram> incoming;
+        while (total->load() < target) {
+            if (!socket.hasPendingDatagrams() && !socket.waitForReadyRead(100))
+                continue;
+            const int n = socket.readDatagrams(incoming, batchSize, 2048);
+            if (n > 0)
+                total->fetchAndAddRelaxed(n);
+        }
+    }
+
+    quint16 port;
+    QAtomicInt *total;
+    int target;
+    bool bound;
+    QSemaphore ready;
+};
+
+void tst_QUdpSocket::reusePort_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+}
+
+void tst_QUdpSocket::reusePort()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("SO_REUSEPORT load balancing is only available on Linux");
+#else
+    QFETCH(int, threads);
+
+    // find a free port, then let every receiver bind it
+    quint16 port;
+    {
+        QUdpSocket probe;
+        QVERIFY(probe.bind(QHostAddress(QHostAddress::LocalHost), 0));
+        port = probe.localPort();
+    }
+
+    // the kernel picks a receiver by hashing the source port, so use
+    // several senders to spread the load
+    QList<QUdpSocket *> senders;
+    for (int i = 0; i < 8; ++i) {
+        QUdpSocket *sender = new QUdpSocket;
+        QVERIFY(bindLoopback(sender));
+        senders << sender;
+    }
+    const QVector<QUdpSocket::Datagram> outgoing(batchSize,
+        QUdpSocket::Datagram(QByteArray(256, 'a'), QHostAddress::LocalHost, port));
+
+    QBENCHMARK {
+        QAtomicInt total;
+        QList<ReceiverThread *> receivers;
+        for (int i = 0; i < threads; ++i) {
+            ReceiverThread *receiver = new ReceiverThread(port, &total, datagramCount);
+            receiver->start();
+            receiver->ready.acquire();
+            QVERIFY(receiver->bound);
+            receivers << receiver;
+        }
+
+        // keep sending until the receivers have seen enough; some
+        // datagrams may be dropped when a receiver falls behind
+        QElapsedTimer timer;
+        timer.start();
+        while (total.load() < datagramCount && timer.elapsed() < 30000) {
+            foreach (QUdpSocket *sender, senders)
+                sender->writeDatagrams(outgoing);
+            QThread::yieldCurrentThread();
+        }
+
+        foreach (ReceiverThread *receiver, receivers)
+            receiver->wait();
+        qDeleteAll(receivers);
+        QVERIFY(total.load() >= datagramCount);
+    }
+
+    qDeleteAll(senders);
+#endif
+}
+
+void tst_QUdpSocket::tcpWrite_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("512") << 512;
+    QTest::newRow("4096") << 4096;
+    QTest::newRow("65536") << 65536;
+}
+
+void tst_QUdpSocket::tcpWrite()
+{
+    // many small writes pile up several blocks in the write buffer, which
+    // the next flush hands to the kernel in one gathering write
+    QFETCH(int, chunkSize);
+    const qint64 totalSize = 64 * 1024 * 1024;
+
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    QTcpSocket client;
+    client.connectToHost(server.serverAddress(), server.serverPort());
+    QVERIFY(client.waitForConnected(5000));
+    QVERIFY(server.waitForNewConnection(5000));
+    QTcpSocket *peer = server.nextPendingConnection();
+    QVERIFY(peer);
+
+    const QByteArray chunk(chunkSize, 'a');
+    QByteArray sink(1024 * 1024, Qt::Uninitialized);
+
+    QBENCHMARK {
+        qint64 written = 0;
+        qint64 read = 0;
+        while (read < totalSize) {
+            while (written < totalSize && client.bytesToWrite() < 1024 * 1024) {
+                client.write(chunk);
+                written += chunkSize;
+            }
+            client.flush();
+            if (!peer->bytesAvailable())
+                peer->waitForReadyRead(5000);
+            read += peer->read(sink.data(), sink.size());
+        }
+    }
+
+    delete peer;
+}
+
+QTEST_MAIN(tst_QUdpSocket)
+
+#include "tst_qudpsocket.moc"
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = tst_bench_qsslsessioncache
+
+QT -= gui
+QT += network network-private testlib
+
+CONFIG += release
+
+SOURCES += tst_qsslsessioncache.cpp
+HEADERS += ../../../../shared/networkbenchmark.h
+TESTDATA += ../../../../shared/certs/*
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,246 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qsslconfiguration.h>
+#include <QtNetwork/qsslkey.h>
+#include <QtNetwork/qsslsocket.h>
+#include <QtNetwork/qtcpserver.h>
+#ifndef QT_NO_OPENSSL
+#include <QtNetwork/private/qsslsessioncache_openssl_p.h>
+#endif
+
+#include "../../../../shared/networkbenchmark.h"
+
+// A TLS server answering every HTTP/1.1 request with the same small
+// resource, keeping connections alive. It counts the connections it
+// accepted, so the effect of connection reuse shows next to the effect
+// of session resumption.
+class TlsServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    TlsServer(const QSslCertificate &certificate, const QSslKey &key)
+        : m_certificate(certificate), m_key(key)
+    {
+    }
+
+    QAtomicInt connections;
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+        QSslSocket *socket = new QSslSocket(this);
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        connections.ref();
+        socket->setLocalCertificate(m_certificate);
+        socket->setPrivateKey(m_key);
+        socket->setPeerVerifyMode(QSslSocket::VerifyNone);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        socket->startServerEncryption();
+    }
+
+private slots:
+    void readClient()
+    {
+        QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+        QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            buffer.remove(0, end + 4);
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\n\r\nok");
+        }
+        socket->setProperty("buffer", buffer);
+    }
+
+private:
+    QSslCertificate m_certificate;
+    QSslKey m_key;
+};
+
+class tst_QSslSessionCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSslSessionCache() : m_server(0), m_serverThread(0) {}
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void handshake_data();
+    void handshake();
+    void managers_data();
+    void managers();
+
+private:
+    void reportHandshakes();
+
+    TlsServer *m_server; // owned by m_serverThread
+    ServerThread *m_serverThread;
+    QSslConfiguration m_clientConfiguration;
+};
+
+void tst_QSslSessionCache::initTestCase()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+
+    QFile certificateFile(QFINDTESTDATA("../../../../shared/certs/server.pem"));
+    QFile keyFile(QFINDTESTDATA("../../../../shared/certs/server.key"));
+    QVERIFY(certificateFile.open(QIODevice::ReadOnly));
+    QVERIFY(keyFile.open(QIODevice::ReadOnly));
+    const QSslCertificate certificate(&certificateFile);
+    const QSslKey key(&keyFile, QSsl::Rsa);
+    QVERIFY(!certificate.isNull());
+    QVERIFY(!key.isNull());
+
+    m_clientConfiguration = QSslConfiguration::defaultConfiguration();
+    m_clientConfiguration.setCaCertificates(QList<QSslCertificate>() << certificate);
+
+    m_server = new TlsServer(certificate, key);
+    m_serverThread = new ServerThread(m_server);
+    m_serverThread->startServer();
+    QVERIFY(m_serverThread->port);
+}
+
+void tst_QSslSessionCache::cleanupTestCase()
+{
+    delete m_serverThread;
+}
+
+void tst_QSslSessionCache::init()
+{
+#ifndef QT_NO_OPENSSL
+    QSslSessionCache::clear();
+    QSslSessionCache::resetStatistics();
+#endif
+    m_server->connections.store(0);
+}
+
+void tst_QSslSessionCache::reportHandshakes()
+{
+#ifndef QT_NO_OPENSSL
+    const QSslSessionCache::Statistics statistics = QSslSessionCache::statistics();
+    qDebug("%lld full and %lld resumed handshakes, %d connections",
+           statistics.fullHandshakes, statistics.resumedHandshakes,
+           m_server->connections.load());
+#else
+    qDebug("%d connections", m_server->connections.load());
+#endif
+}
+
+void tst_QSslSessionCache::handshake_data()
+{
+    QTest::addColumn<bool>("resume");
+
+    QTest::newRow("full") << false;
+    QTest::newRow("resumed") << true;
+}
+
+// Connects a fresh socket per iteration; with resumption enabled every
+// handshake but the first one resumes the session cached by the previous
+// socket.
+void tst_QSslSessionCache::handshake()
+{
+    QFETCH(bool, resume);
+
+    QSslConfiguration configuration = m_clientConfiguration;
+    configuration.setSslOption(QSsl::SslOptionDisableSessionSharing, !resume);
+
+    QBENCHMARK {
+        QSslSocket socket;
+        socket.setSslConfiguration(configuration);
+        socket.connectToHostEncrypted(QStringLiteral("localhost"), m_serverThread->port);
+        QVERIFY2(socket.waitForEncrypted(10000), qPrintable(socket.errorString()));
+        socket.disconnectFromHost();
+    }
+
+    reportHandshakes();
+}
+
+void tst_QSslSessionCache::managers_data()
+{
+    QTest::addColumn<bool>("sharedPool");
+
+    QTest::newRow("separate") << false;
+    QTest::newRow("shared-pool") << true;
+}
+
+// Several managers fetching from the same host one after another, as
+// independent components of an application would. Separate managers each
+// open a connection of their own, which can still resume the TLS session;
+// with the shared pool later managers reuse the connection of the first.
+void tst_QSslSessionCache::managers()
+{
+    QFETCH(bool, sharedPool);
+
+    const int managerCount = 10;
+    const int requestsPerManager = 10;
+    QUrl url;
+    url.setScheme(QStringLiteral("https"));
+    url.setHost(QStringLiteral("localhost"));
+    url.setPort(m_serverThread->port);
+    url.setPath(QStringLiteral("/resource"));
+    QNetworkRequest request(url);
+    request.setSslConfiguration(m_clientConfiguration);
+
+    QBENCHMARK {
+        for (int i = 0; i < managerCount; ++i) {
+            QNetworkAccessManager manager;
+            manager.setSharedConnectionPoolEnabled(sharedPool);
+            for (int j = 0; j < requestsPerManager; ++j) {
+                QScopedPointer<QNetworkReply> reply(manager.get(request));
+                connect(reply.data(), SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+                QTestEventLoop::instance().enterLoop(10);
+                QVERIFY(!QTestEventLoop::instance().timeout());
+                QCOMPARE(reply->error(), QNetworkReply::NoError);
+            }
+        }
+    }
+
+    reportHandshakes();
+}
+
+QTEST_MAIN(tst_QSslSessionCache)
+
+#include "tst_qsslsessioncache.moc"
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = tst_bench_qsslsocket_throughput
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qsslsocket_throughput.cpp
+HEADERS += ../../../../shared/networkbenchmark.h
+TESTDATA += ../../../../shared/certs/*
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
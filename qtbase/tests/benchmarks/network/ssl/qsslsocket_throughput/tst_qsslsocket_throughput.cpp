@@ -0,0 +1,225 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qelapsedtimer.h>
+#include <QtNetwork/qsslconfiguration.h>
+#include <QtNetwork/qsslkey.h>
+#include <QtNetwork/qsslsocket.h>
+#include <QtNetwork/qtcpserver.h>
+
+#include "../../../../shared/networkbenchmark.h"
+
+// The amount of data downloaded in every run, split evenly between the
+// connections.
+static const qint64 TotalBytes = 64 * 1024 * 1024;
+
+// A TLS server that sends bytesPerConnection bytes on every connection
+// as soon as the client sends anything. It always offloads its own
+// encryption, so that the server thread does not limit the throughput
+// of the client.
+class DataServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    DataServer(const QSslCertificate &certificate, const QSslKey &key)
+        : m_certificate(certificate), m_key(key)
+    {
+    }
+
+    QAtomicInt bytesPerConnection;
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+        QSslSocket *socket = new QSslSocket(this);
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        socket->setLocalCertificate(m_certificate);
+        socket->setPrivateKey(m_key);
+        socket->setPeerVerifyMode(QSslSocket::VerifyNone);
+        socket->setEncryptionOffloadEnabled(true);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(sendData()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        socket->startServerEncryption();
+    }
+
+private slots:
+    void sendData()
+    {
+        QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+        socket->readAll();
+        const QByteArray chunk(64 * 1024, 'q');
+        for (qint64 left = bytesPerConnection.load(); left > 0; left -= chunk.size())
+            socket->write(chunk.constData(), qMin<qint64>(left, chunk.size()));
+    }
+
+private:
+    QSslCertificate m_certificate;
+    QSslKey m_key;
+};
+
+class tst_QSslSocketThroughput : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSslSocketThroughput()
+        : m_server(0), m_serverThread(0), m_connections(0), m_encrypted(0), m_received(0), m_expected(0)
+    {
+    }
+
+public slots:
+    void socketEncrypted();
+    void socketReadyRead();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void download_data();
+    void download();
+
+private:
+    DataServer *m_server; // owned by m_serverThread
+    ServerThread *m_serverThread;
+    QSslConfiguration m_clientConfiguration;
+    int m_connections;
+    int m_encrypted;
+    qint64 m_received;
+    qint64 m_expected;
+};
+
+void tst_QSslSocketThroughput::initTestCase()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+
+    QFile certificateFile(QFINDTESTDATA("../../../../shared/certs/server.pem"));
+    QFile keyFile(QFINDTESTDATA("../../../../shared/certs/server.key"));
+    QVERIFY(certificateFile.open(QIODevice::ReadOnly));
+    QVERIFY(keyFile.open(QIODevice::ReadOnly));
+    const QSslCertificate certificate(&certificateFile);
+    const QSslKey key(&keyFile, QSsl::Rsa);
+    QVERIFY(!certificate.isNull());
+    QVERIFY(!key.isNull());
+
+    m_clientConfiguration = QSslConfiguration::defaultConfiguration();
+    m_clientConfiguration.setCaCertificates(QList<QSslCertificate>() << certificate);
+
+    m_server = new DataServer(certificate, key);
+    m_serverThread = new ServerThread(m_server);
+    m_serverThread->startServer();
+    QVERIFY(m_serverThread->port);
+}
+
+void tst_QSslSocketThroughput::cleanupTestCase()
+{
+    delete m_serverThread;
+}
+
+void tst_QSslSocketThroughput::download_data()
+{
+    QTest::addColumn<int>("connections");
+    QTest::addColumn<bool>("offload");
+
+    for (int connections = 1; connections <= 32; connections *= 2) {
+        QTest::newRow(qPrintable(QString::fromLatin1("%1-inline").arg(connections)))
+            << connections << false;
+        QTest::newRow(qPrintable(QString::fromLatin1("%1-offload").arg(connections)))
+            << connections << true;
+    }
+}
+
+// All client connections are served by the main thread; the result is the
+// rate at which it receives decrypted data, handshakes excluded.
+void tst_QSslSocketThroughput::download()
+{
+    QFETCH(int, connections);
+    QFETCH(bool, offload);
+
+    m_server->bytesPerConnection.store(int(TotalBytes / connections));
+    m_connections = connections;
+    m_encrypted = 0;
+    m_received = 0;
+    m_expected = TotalBytes;
+
+    QObject owner;
+    QList<QSslSocket *> sockets;
+    for (int i = 0; i < connections; ++i) {
+        QSslSocket *socket = new QSslSocket(&owner);
+        socket->setSslConfiguration(m_clientConfiguration);
+        socket->setEncryptionOffloadEnabled(offload);
+        connect(socket, SIGNAL(encrypted()), this, SLOT(socketEncrypted()));
+        connect(socket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
+        socket->connectToHostEncrypted(QStringLiteral("localhost"), m_serverThread->port);
+        sockets << socket;
+    }
+    QTestEventLoop::instance().enterLoop(30);
+    QVERIFY(!QTestEventLoop::instance().timeout());
+    QCOMPARE(m_encrypted, connections);
+
+    QElapsedTimer timer;
+    timer.start();
+    foreach (QSslSocket *socket, sockets)
+        socket->write("g", 1);
+    QTestEventLoop::instance().enterLoop(120);
+    const qint64 elapsed = qMax<qint64>(timer.nsecsElapsed(), 1);
+    QVERIFY(!QTestEventLoop::instance().timeout());
+    QCOMPARE(m_received, m_expected);
+
+    QTest::setBenchmarkResult(qreal(TotalBytes) * 1000000000 / elapsed, QTest::BytesPerSecond);
+}
+
+void tst_QSslSocketThroughput::socketEncrypted()
+{
+    if (++m_encrypted == m_connections)
+        QTestEventLoop::instance().exitLoop();
+}
+
+void tst_QSslSocketThroughput::socketReadyRead()
+{
+    QSslSocket *socket = qobject_cast<QSslSocket *>(sender());
+    char data[64 * 1024];
+    qint64 readBytes;
+    while ((readBytes = socket->read(data, sizeof data)) > 0)
+        m_received += readBytes;
+    if (m_received == m_expected)
+        QTestEventLoop::instance().exitLoop();
+}
+
+QTEST_MAIN(tst_QSslSocketThroughput)
+
+#include "tst_qsslsocket_throughput.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qpsql
+
+QT -= gui
+QT += sql testlib
+
+CONFIG += release
+
+SOURCES += tst_qpsql.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,289 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtSql/QSqlColumnBatch>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlDriver>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+/*
+   Runs against the PostgreSQL server that libpq finds through the PGHOST,
+   PGPORT, PGDATABASE, PGUSER and PGPASSWORD environment variables.
+*/
+
+static const int rowCount = 1000000;
+static const int insertRowCount = 200000;
+
+enum SelectMode {
+    Buffered,
+    SingleRow,
+    SingleRowBatch,
+    SingleRowBinaryBatch
+};
+Q_DECLARE_METATYPE(SelectMode)
+
+class tst_QPSQL : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void select_data();
+    void select();
+    void selectPeakMemory_data();
+    void selectPeakMemory();
+    void insert_data();
+    void insert();
+
+private:
+    bool runSelect(SelectMode mode);
+
+    QSqlDatabase db;
+    QString table;
+};
+
+static QString connectOptions(SelectMode mode)
+{
+    switch (mode) {
+    case Buffered:
+        break;
+    case SingleRow:
+    case SingleRowBatch:
+        return QStringLiteral("QPSQL_SINGLE_ROW_MODE");
+    case SingleRowBinaryBatch:
+        return QStringLiteral("QPSQL_SINGLE_ROW_MODE;QPSQL_BINARY_RESULTS");
+    }
+    return QString();
+}
+
+// the peak resident set size of the process in bytes, or -1
+static qint64 peakResidentSize()
+{
+#ifdef Q_OS_LINUX
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+    }
+#endif
+    return -1;
+}
+
+static bool resetPeakResidentSize()
+{
+#ifdef Q_OS_LINUX
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+#else
+    return false;
+#endif
+}
+
+void tst_QPSQL::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QPSQL")))
+        QSKIP("The PostgreSQL driver is not available");
+    if (qEnvironmentVariableIsEmpty("PGDATABASE"))
+        QSKIP("Set PGDATABASE to run the benchmark against a PostgreSQL server");
+
+    db = QSqlDatabase::addDatabase(QStringLiteral("QPSQL"), QStringLiteral("bench"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    table = QString("qbench_psql_%1").arg(QCoreApplication::applicationPid());
+    QSqlQuery q(db);
+    QVERIFY(q.exec(QString("CREATE TABLE %1 (id INTEGER, price DOUBLE PRECISION, name VARCHAR(32))").arg(table)));
+}
+
+void tst_QPSQL::cleanupTestCase()
+{
+    if (db.isOpen())
+        QSqlQuery(db).exec(QString("DROP TABLE %1").arg(table));
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("bench"));
+}
+
+bool tst_QPSQL::runSelect(SelectMode mode)
+{
+    bool ok = false;
+    {
+        QSqlDatabase selectDb = QSqlDatabase::addDatabase(QStringLiteral("QPSQL"), QStringLiteral("select"));
+        selectDb.setConnectOptions(connectOptions(mode));
+        if (!selectDb.open())
+            return false;
+
+        QSqlQuery q(selectDb);
+        q.setForwardOnly(true);
+        // prepared, so that QPSQL_BINARY_RESULTS applies
+        q.prepare(QString("SELECT i, i * 0.25::float8, 'item ' || i FROM generate_series(1, ?) AS i"));
+        q.addBindValue(rowCount);
+        if (q.exec()) {
+            qint64 ids = 0;
+            double prices = 0;
+            int names = 0;
+            int rows = 0;
+            if (mode == Buffered || mode == SingleRow) {
+                while (q.next()) {
+                    ids += q.value(0).toLongLong();
+                    prices += q.value(1).toDouble();
+                    names += q.value(2).toString().size();
+                    ++rows;
+                }
+            } else {
+                QSqlColumnBatch batch;
+                while (q.fetchBatch(&batch, 4096) > 0) {
+                    const QVector<qint64> idColumn = batch.int64Column(0);
+                    const QVector<double> priceColumn = batch.doubleColumn(1);
+                    const QStringList nameColumn = batch.stringColumn(2);
+                    for (int i = 0; i < batch.rowCount(); ++i) {
+                        ids += idColumn.at(i);
+                        prices += priceColumn.at(i);
+                        names += nameColumn.at(i).size();
+                    }
+                    rows += batch.rowCount();
+                }
+            }
+            ok = rows == rowCount && ids > 0 && prices > 0 && names > 0
+                 && !q.lastError().isValid();
+        }
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("select"));
+    return ok;
+}
+
+void tst_QPSQL::select_data()
+{
+    QTest::addColumn<SelectMode>("mode");
+
+    QTest::newRow("buffered") << Buffered;
+    QTest::newRow("single row, next()") << SingleRow;
+    QTest::newRow("single row, fetchBatch()") << SingleRowBatch;
+    QTest::newRow("single row, binary, fetchBatch()") << SingleRowBinaryBatch;
+}
+
+void tst_QPSQL::select()
+{
+    QFETCH(SelectMode, mode);
+
+    QBENCHMARK {
+        QVERIFY(runSelect(mode));
+    }
+}
+
+void tst_QPSQL::selectPeakMemory_data()
+{
+    select_data();
+}
+
+void tst_QPSQL::selectPeakMemory()
+{
+    QFETCH(SelectMode, mode);
+
+    if (!resetPeakResidentSize())
+        QSKIP("The peak resident set size cannot be measured on this platform");
+    const qint64 before = peakResidentSize();
+    QVERIFY(runSelect(mode));
+    const qint64 after = peakResidentSize();
+    QVERIFY(before >= 0 && after >= before);
+    QTest::setBenchmarkResult(after - before, QTest::BytesAllocated);
+}
+
+void tst_QPSQL::insert_data()
+{
+    QTest::addColumn<bool>("copy");
+
+    QTest::newRow("execBatch()") << false;
+    QTest::newRow("COPY FROM STDIN") << true;
+}
+
+void tst_QPSQL::insert()
+{
+    QFETCH(bool, copy);
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec(QString("TRUNCATE %1").arg(table)));
+
+    QVariantList ids, prices, names;
+    QByteArray data;
+    if (copy) {
+        for (int i = 0; i < insertRowCount; ++i)
+            data += QByteArray::number(i) + '\t' + QByteArray::number(i * 0.25) + "\titem " + QByteArray::number(i) + '\n';
+    } else {
+        ids.reserve(insertRowCount);
+        prices.reserve(insertRowCount);
+        names.reserve(insertRowCount);
+        for (int i = 0; i < insertRowCount; ++i) {
+            ids << i;
+            prices << i * 0.25;
+            names << QString::fromLatin1("item %1").arg(i);
+        }
+    }
+
+    QBENCHMARK_ONCE {
+        if (copy) {
+            QBuffer source(&data);
+            QVERIFY(source.open(QIODevice::ReadOnly));
+            bool ok = false;
+            QVERIFY(QMetaObject::invokeMethod(db.driver(), "copyFrom", Q_RETURN_ARG(bool, ok),
+                                              Q_ARG(QString, QString("COPY %1 FROM STDIN").arg(table)),
+                                              Q_ARG(QIODevice*, &source)));
+            QVERIFY2(ok, qPrintable(db.driver()->lastError().text()));
+        } else {
+            QVERIFY(db.transaction());
+            QVERIFY(q.prepare(QString("INSERT INTO %1 VALUES (?, ?, ?)").arg(table)));
+            q.addBindValue(ids);
+            q.addBindValue(prices);
+            q.addBindValue(names);
+            QVERIFY2(q.execBatch(), qPrintable(q.lastError().text()));
+            QVERIFY(db.commit());
+        }
+    }
+
+    QVERIFY(q.exec(QString("SELECT COUNT(*) FROM %1").arg(table)));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), insertRowCount);
+}
+
+QTEST_MAIN(tst_QPSQL)
+
+#include "tst_qpsql.moc"
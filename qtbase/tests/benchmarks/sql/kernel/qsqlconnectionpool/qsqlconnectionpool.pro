@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qsqlconnectionpool
+
+QT -= gui
+QT += sql testlib
+
+CONFIG += release
+
+SOURCES += tst_qsqlconnectionpool.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
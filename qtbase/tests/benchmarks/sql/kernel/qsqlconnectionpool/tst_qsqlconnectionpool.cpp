@@ -0,0 +1,152 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlConnectionPool>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlQueryResultSet>
+
+static const int rowCount = 100000;
+static const int queryCount = 200;
+
+class tst_QSqlConnectionPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sequential();
+    void read_data();
+    void read();
+
+private:
+    QTemporaryDir dir;
+    QSqlDatabase db;
+};
+
+// a range scan of about 1000 rows, aggregated so that the result is small
+static const char query[] = "SELECT COUNT(*), SUM(price), MAX(name) FROM items WHERE id >= ? AND id < ?";
+
+static QVariantList bounds(int i)
+{
+    const int first = (i * 7919) % (rowCount - 1000);
+    return QVariantList() << first << first + 1000;
+}
+
+void tst_QSqlConnectionPool::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+    QVERIFY(dir.isValid());
+
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("bench"));
+    db.setDatabaseName(dir.path() + QStringLiteral("/bench.db"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE items (id INTEGER, price DOUBLE, name VARCHAR(32))"));
+    QVERIFY(db.transaction());
+    QVERIFY(q.prepare("INSERT INTO items VALUES (?, ?, ?)"));
+    for (int i = 0; i < rowCount; ++i) {
+        q.addBindValue(i);
+        q.addBindValue(i * 0.25);
+        q.addBindValue(QString::fromLatin1("item %1").arg(i));
+        QVERIFY(q.exec());
+    }
+    QVERIFY(db.commit());
+}
+
+void tst_QSqlConnectionPool::cleanupTestCase()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("bench"));
+}
+
+// the baseline: the same queries, blocking, on one connection
+void tst_QSqlConnectionPool::sequential()
+{
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    QBENCHMARK {
+        for (int i = 0; i < queryCount; ++i) {
+            QVERIFY(q.prepare(query));
+            const QVariantList values = bounds(i);
+            q.addBindValue(values.at(0));
+            q.addBindValue(values.at(1));
+            QVERIFY(q.exec());
+            QVERIFY(q.next());
+            QCOMPARE(q.value(0).toInt(), 1000);
+        }
+    }
+}
+
+void tst_QSqlConnectionPool::read_data()
+{
+    QTest::addColumn<int>("connections");
+
+    QTest::newRow("1 connection") << 1;
+    QTest::newRow("2 connections") << 2;
+    QTest::newRow("4 connections") << 4;
+    QTest::newRow("8 connections") << 8;
+}
+
+void tst_QSqlConnectionPool::read()
+{
+    QFETCH(int, connections);
+
+    QSqlConnectionPool pool(db);
+    pool.setMaxConnections(connections);
+    // open the connections outside of the measurement
+    for (int i = 0; i < connections; ++i)
+        pool.exec("SELECT 1");
+    QVERIFY(pool.waitForDone());
+
+    QVector<QFuture<QSqlQueryResultSet> > futures(queryCount);
+    QBENCHMARK {
+        for (int i = 0; i < queryCount; ++i)
+            futures[i] = pool.exec(query, bounds(i));
+        for (int i = 0; i < queryCount; ++i)
+            QCOMPARE(futures.at(i).result().value(0, 0).toInt(), 1000);
+    }
+}
+
+QTEST_MAIN(tst_QSqlConnectionPool)
+
+#include "tst_qsqlconnectionpool.moc"
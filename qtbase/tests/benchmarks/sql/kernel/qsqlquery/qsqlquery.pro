@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qsqlquery
+
+QT -= gui
+QT += sql testlib
+
+CONFIG += release
+
+SOURCES += tst_qsqlquery.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
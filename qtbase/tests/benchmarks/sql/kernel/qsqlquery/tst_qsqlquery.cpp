@@ -0,0 +1,272 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtSql/QSqlColumnBatch>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+static const int rowCount = 200000;
+static const int insertRowCount = 1000000;
+
+enum InsertMode {
+    ExecPerRow,
+    ExecInTransaction,
+    ExecBatch,
+    ExecBatchInTransaction
+};
+Q_DECLARE_METATYPE(InsertMode)
+
+class tst_QSqlQuery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void next_data();
+    void next();
+    void fetchBatch_data();
+    void fetchBatch();
+    void prepare_data();
+    void prepare();
+    void insert_data();
+    void insert();
+
+private:
+    QSqlDatabase db;
+};
+
+void tst_QSqlQuery::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("bench"));
+    db.setDatabaseName(QStringLiteral(":memory:"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE items (id INTEGER, price DOUBLE, name VARCHAR(32))"));
+    QVERIFY(db.transaction());
+    QVERIFY(q.prepare("INSERT INTO items VALUES (?, ?, ?)"));
+    for (int i = 0; i < rowCount; ++i) {
+        q.addBindValue(i);
+        q.addBindValue(i * 0.25);
+        q.addBindValue(i % 7 ? QVariant(QString::fromLatin1("item %1").arg(i)) : QVariant(QVariant::String));
+        QVERIFY(q.exec());
+    }
+    QVERIFY(db.commit());
+}
+
+void tst_QSqlQuery::cleanupTestCase()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("bench"));
+}
+
+void tst_QSqlQuery::next_data()
+{
+    QTest::addColumn<bool>("forwardOnly");
+
+    QTest::newRow("scrollable") << false;
+    QTest::newRow("forward-only") << true;
+}
+
+void tst_QSqlQuery::next()
+{
+    QFETCH(bool, forwardOnly);
+
+    QBENCHMARK {
+        QSqlQuery q(db);
+        q.setForwardOnly(forwardOnly);
+        QVERIFY(q.exec("SELECT id, price, name FROM items"));
+        qint64 ids = 0;
+        double prices = 0;
+        int names = 0;
+        while (q.next()) {
+            ids += q.value(0).toLongLong();
+            prices += q.value(1).toDouble();
+            names += q.value(2).toString().size();
+        }
+        QVERIFY(ids > 0 && prices > 0 && names > 0);
+    }
+}
+
+void tst_QSqlQuery::fetchBatch_data()
+{
+    QTest::addColumn<bool>("forwardOnly");
+    QTest::addColumn<int>("batchSize");
+
+    QTest::newRow("scrollable, 1024") << false << 1024;
+    QTest::newRow("forward-only, 64") << true << 64;
+    QTest::newRow("forward-only, 1024") << true << 1024;
+    QTest::newRow("forward-only, 16384") << true << 16384;
+}
+
+void tst_QSqlQuery::fetchBatch()
+{
+    QFETCH(bool, forwardOnly);
+    QFETCH(int, batchSize);
+
+    QSqlColumnBatch batch;
+    QBENCHMARK {
+        QSqlQuery q(db);
+        q.setForwardOnly(forwardOnly);
+        QVERIFY(q.exec("SELECT id, price, name FROM items"));
+        qint64 ids = 0;
+        double prices = 0;
+        int names = 0;
+        while (q.fetchBatch(&batch, batchSize) > 0) {
+            const QVector<qint64> idColumn = batch.int64Column(0);
+            const QVector<double> priceColumn = batch.doubleColumn(1);
+            const QStringList nameColumn = batch.stringColumn(2);
+            for (int i = 0; i < batch.rowCount(); ++i) {
+                ids += idColumn.at(i);
+                prices += priceColumn.at(i);
+                names += nameColumn.at(i).size();
+            }
+        }
+        QVERIFY(ids > 0 && prices > 0 && names > 0);
+    }
+}
+
+void tst_QSqlQuery::prepare_data()
+{
+    QTest::addColumn<QString>("options");
+
+    QTest::newRow("no statement cache") << QString("QSQLITE_STATEMENT_CACHE_SIZE=0");
+    QTest::newRow("statement cache") << QString();
+}
+
+void tst_QSqlQuery::prepare()
+{
+    QFETCH(QString, options);
+
+    {
+        QSqlDatabase prepareDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("prepare"));
+        prepareDb.setDatabaseName(QStringLiteral(":memory:"));
+        prepareDb.setConnectOptions(options);
+        QVERIFY2(prepareDb.open(), qPrintable(prepareDb.lastError().text()));
+        QSqlQuery q(prepareDb);
+        QVERIFY(q.exec("CREATE TABLE t (id INTEGER PRIMARY KEY, a INTEGER, b VARCHAR(32), c DOUBLE)"));
+        QVERIFY(q.exec("INSERT INTO t VALUES (1, 2, 'three', 4.0)"));
+
+        QBENCHMARK {
+            for (int i = 0; i < 10000; ++i) {
+                QVERIFY(q.prepare("SELECT a, b, c FROM t WHERE id = ? AND a > ?"));
+                q.addBindValue(1);
+                q.addBindValue(i % 2);
+                QVERIFY(q.exec());
+                QVERIFY(q.next());
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("prepare"));
+}
+
+void tst_QSqlQuery::insert_data()
+{
+    QTest::addColumn<InsertMode>("mode");
+
+    QTest::newRow("exec() per row") << ExecPerRow;
+    QTest::newRow("exec() in transaction") << ExecInTransaction;
+    QTest::newRow("execBatch()") << ExecBatch;
+    QTest::newRow("execBatch(), QSQLITE_BATCH_TRANSACTIONS") << ExecBatchInTransaction;
+}
+
+void tst_QSqlQuery::insert()
+{
+    QFETCH(InsertMode, mode);
+
+    QVariantList ids, prices, names;
+    if (mode == ExecBatch || mode == ExecBatchInTransaction) {
+        ids.reserve(insertRowCount);
+        prices.reserve(insertRowCount);
+        names.reserve(insertRowCount);
+        for (int i = 0; i < insertRowCount; ++i) {
+            ids << i;
+            prices << i * 0.25;
+            names << QString::fromLatin1("item %1").arg(i);
+        }
+    }
+
+    {
+        QSqlDatabase insertDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("insert"));
+        insertDb.setDatabaseName(QStringLiteral(":memory:"));
+        if (mode == ExecBatchInTransaction)
+            insertDb.setConnectOptions(QStringLiteral("QSQLITE_BATCH_TRANSACTIONS"));
+        QVERIFY2(insertDb.open(), qPrintable(insertDb.lastError().text()));
+        QSqlQuery q(insertDb);
+        QVERIFY(q.exec("CREATE TABLE items (id INTEGER, price DOUBLE, name VARCHAR(32))"));
+
+        QBENCHMARK_ONCE {
+            QVERIFY(q.prepare("INSERT INTO items VALUES (?, ?, ?)"));
+            switch (mode) {
+            case ExecPerRow:
+            case ExecInTransaction:
+                if (mode == ExecInTransaction)
+                    QVERIFY(insertDb.transaction());
+                for (int i = 0; i < insertRowCount; ++i) {
+                    q.addBindValue(i);
+                    q.addBindValue(i * 0.25);
+                    q.addBindValue(QString::fromLatin1("item %1").arg(i));
+                    QVERIFY(q.exec());
+                }
+                if (mode == ExecInTransaction)
+                    QVERIFY(insertDb.commit());
+                break;
+            case ExecBatch:
+            case ExecBatchInTransaction:
+                q.addBindValue(ids);
+                q.addBindValue(prices);
+                q.addBindValue(names);
+                QVERIFY2(q.execBatch(), qPrintable(q.lastError().text()));
+                break;
+            }
+        }
+
+        QVERIFY(q.exec("SELECT COUNT(*) FROM items"));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), insertRowCount);
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("insert"));
+}
+
+QTEST_MAIN(tst_QSqlQuery)
+
+#include "tst_qsqlquery.moc"
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = tst_bench_qsqlquerymodel
+
+QT -= gui
+QT += sql testlib
+
+CONFIG += release
+
+SOURCES += tst_qsqlquerymodel.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
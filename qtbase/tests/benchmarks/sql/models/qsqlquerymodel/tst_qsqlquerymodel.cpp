@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlQueryModel>
+
+static const int rowCount = 500000;
+// the rows a view shows at a time
+static const int screenRows = 40;
+
+enum Mode {
+    Plain,
+    Windowed,
+    WindowedPrefetch
+};
+Q_DECLARE_METATYPE(Mode)
+
+class tst_QSqlQueryModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void scroll_data();
+    void scroll();
+    void jump_data();
+    void jump();
+
+private:
+    void setUp(QSqlQueryModel *model, Mode mode);
+    void modes();
+
+    QTemporaryDir dir;
+    QSqlDatabase db;
+};
+
+void tst_QSqlQueryModel::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable(QStringLiteral("QSQLITE")))
+        QSKIP("The SQLite driver is not available");
+    QVERIFY(dir.isValid());
+
+    // a file, so that the prefetching connection sees the same database
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("bench"));
+    db.setDatabaseName(dir.path() + QStringLiteral("/bench.db"));
+    QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("CREATE TABLE audit (id INTEGER PRIMARY KEY, time INTEGER, user VARCHAR(32), action VARCHAR(64))"));
+    QVERIFY(db.transaction());
+    QVERIFY(q.prepare("INSERT INTO audit VALUES (?, ?, ?, ?)"));
+    for (int i = 0; i < rowCount; ++i) {
+        q.addBindValue(i);
+        q.addBindValue(1450000000 + i);
+        q.addBindValue(QString::fromLatin1("user %1").arg(i % 100));
+        q.addBindValue(QString::fromLatin1("action %1 on item %2").arg(i % 7).arg(i));
+        QVERIFY(q.exec());
+    }
+    QVERIFY(db.commit());
+}
+
+void tst_QSqlQueryModel::cleanupTestCase()
+{
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("bench"));
+}
+
+void tst_QSqlQueryModel::setUp(QSqlQueryModel *model, Mode mode)
+{
+    const QString query = QStringLiteral("SELECT id, time, user, action FROM audit");
+    switch (mode) {
+    case Plain:
+        model->setQuery(query, db);
+        break;
+    case Windowed:
+    case WindowedPrefetch:
+        model->setWindowSize(1024);
+        model->setPrefetchEnabled(mode == WindowedPrefetch);
+        model->setWindowedQuery(query, QStringLiteral("id"), db);
+        break;
+    }
+}
+
+void tst_QSqlQueryModel::modes()
+{
+    QTest::addColumn<Mode>("mode");
+
+    QTest::newRow("setQuery()") << Plain;
+    QTest::newRow("setWindowedQuery()") << Windowed;
+    QTest::newRow("setWindowedQuery(), prefetch") << WindowedPrefetch;
+}
+
+void tst_QSqlQueryModel::scroll_data()
+{
+    modes();
+}
+
+// scrolls from the top to the bottom and back, a screen at a time
+void tst_QSqlQueryModel::scroll()
+{
+    QFETCH(Mode, mode);
+
+    QBENCHMARK {
+        QSqlQueryModel model;
+        setUp(&model, mode);
+        QVERIFY2(!model.lastError().isValid(), qPrintable(model.lastError().text()));
+
+        qint64 sum = 0;
+        int top = 0;
+        for (; top + screenRows <= rowCount; top += screenRows) {
+            while (model.canFetchMore() && top + screenRows > model.rowCount())
+                model.fetchMore();
+            for (int row = top; row < top + screenRows; ++row) {
+                for (int column = 0; column < 4; ++column)
+                    sum += model.data(model.index(row, column)).toString().size();
+            }
+        }
+        for (top -= screenRows; top >= 0; top -= screenRows) {
+            for (int row = top; row < top + screenRows; ++row) {
+                for (int column = 0; column < 4; ++column)
+                    sum += model.data(model.index(row, column)).toString().size();
+            }
+        }
+        QCOMPARE(model.rowCount(), rowCount);
+        QVERIFY(sum > 0);
+    }
+}
+
+void tst_QSqlQueryModel::jump_data()
+{
+    modes();
+}
+
+// shows a screen at the end, in the middle and at the start, as
+// dragging the scroll bar does
+void tst_QSqlQueryModel::jump()
+{
+    QFETCH(Mode, mode);
+
+    QBENCHMARK {
+        QSqlQueryModel model;
+        setUp(&model, mode);
+        QVERIFY2(!model.lastError().isValid(), qPrintable(model.lastError().text()));
+
+        while (model.canFetchMore())
+            model.fetchMore();
+        const int tops[] = { rowCount - screenRows, rowCount / 2, 0 };
+        for (int i = 0; i < 3; ++i) {
+            for (int row = tops[i]; row < tops[i] + screenRows; ++row)
+                QCOMPARE(model.data(model.index(row, 0)).toInt(), row);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QSqlQueryModel)
+
+#include "tst_qsqlquerymodel.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qtableview
+QT += widgets testlib
+SOURCES += tst_qtableview.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
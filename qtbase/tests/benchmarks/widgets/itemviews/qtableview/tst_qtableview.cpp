@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/qabstractitemmodel.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qheaderview.h>
+#include <QtWidgets/qscrollbar.h>
+#include <QtWidgets/qtableview.h>
+
+// A table with cheap data and any number of rows.
+class TableModel : public QAbstractTableModel
+{
+public:
+    TableModel(int rows, int columns)
+        : rows(rows), columns(columns) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : rows;
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : columns;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid() || role != Qt::DisplayRole)
+            return QVariant();
+        return index.row();
+    }
+
+private:
+    int rows;
+    int columns;
+};
+
+// A table whose items have text, alignment, colors and a check state.
+class StyledTableModel : public TableModel
+{
+public:
+    StyledTableModel(int rows, int columns)
+        : TableModel(rows, columns) {}
+
+    QVariant data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid())
+            return QVariant();
+        switch (role) {
+        case Qt::DisplayRole:
+            return QString(QString::number(index.row()) + QLatin1Char(':') + QString::number(index.column()));
+        case Qt::TextAlignmentRole:
+            return int(index.column() % 2 ? Qt::AlignRight | Qt::AlignVCenter : Qt::AlignLeft | Qt::AlignVCenter);
+        case Qt::ForegroundRole:
+            return index.row() % 7 ? QVariant() : QVariant(QBrush(Qt::red));
+        case Qt::BackgroundRole:
+            return index.row() % 5 ? QVariant() : QVariant(QBrush(Qt::yellow));
+        case Qt::CheckStateRole:
+            return index.column() == 0 ? QVariant(index.row() % 2 ? Qt::Checked : Qt::Unchecked) : QVariant();
+        default:
+            return QVariant();
+        }
+    }
+};
+
+class tst_QTableView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void setModel();
+    void scroll_data();
+    void scroll();
+    void resizeRows_data();
+    void resizeRows();
+    void visualIndexAt_data();
+    void visualIndexAt();
+    void scrollWideTable_data();
+    void scrollWideTable();
+};
+
+enum { RowCount = 10000000 };
+
+// a few rows are given their own height, like rows resized by the user
+static void resizeSomeRows(QHeaderView *header, int count)
+{
+    uint seed = 1;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        header->resizeSection((seed >> 8) % RowCount, 20 + i % 40);
+    }
+}
+
+static void addRowSizeData()
+{
+    QTest::addColumn<int>("resizedRows");
+    QTest::newRow("uniform") << 0;
+    QTest::newRow("100 resized") << 100;
+    QTest::newRow("10000 resized") << 10000;
+}
+
+void tst_QTableView::setModel()
+{
+    TableModel model(RowCount, 10);
+    QBENCHMARK {
+        QTableView view;
+        view.setModel(&model);
+        QCOMPARE(view.verticalHeader()->count(), int(RowCount));
+    }
+}
+
+void tst_QTableView::scroll_data()
+{
+    addRowSizeData();
+}
+
+void tst_QTableView::scroll()
+{
+    QFETCH(int, resizedRows);
+    TableModel model(RowCount, 10);
+    QTableView view;
+    view.setModel(&model);
+    resizeSomeRows(view.verticalHeader(), resizedRows);
+    view.resize(600, 600);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QScrollBar *bar = view.verticalScrollBar();
+    const int step = bar->maximum() / 100;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            bar->setValue(i * step);
+            view.viewport()->repaint();
+        }
+    }
+}
+
+void tst_QTableView::resizeRows_data()
+{
+    addRowSizeData();
+}
+
+// resizes rows all over the table, looking up a position after each
+// resize the way painting the view does
+void tst_QTableView::resizeRows()
+{
+    QFETCH(int, resizedRows);
+    TableModel model(RowCount, 10);
+    QTableView view;
+    view.setModel(&model);
+    QHeaderView *header = view.verticalHeader();
+    resizeSomeRows(header, resizedRows);
+
+    int row = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            row = (row + 99991) % RowCount;
+            header->resizeSection(row, header->sectionSize(row) == 25 ? 35 : 25);
+            header->sectionPosition(RowCount - 1);
+        }
+    }
+}
+
+void tst_QTableView::visualIndexAt_data()
+{
+    addRowSizeData();
+}
+
+void tst_QTableView::visualIndexAt()
+{
+    QFETCH(int, resizedRows);
+    TableModel model(RowCount, 10);
+    QTableView view;
+    view.setModel(&model);
+    QHeaderView *header = view.verticalHeader();
+    resizeSomeRows(header, resizedRows);
+    header->hideSection(RowCount / 2);
+
+    const int length = header->length();
+    QBENCHMARK {
+        for (int position = 0; position < length; position += length / 10000)
+            header->visualIndexAt(position);
+    }
+}
+
+void tst_QTableView::scrollWideTable_data()
+{
+    QTest::addColumn<int>("renderCacheLimit");
+    QTest::newRow("no cache") << 0;
+    QTest::newRow("64MB cache") << 64 * 1024;
+}
+
+// scrolls a 50 column table one page down and back up, so that every row
+// comes into view again
+void tst_QTableView::scrollWideTable()
+{
+    QFETCH(int, renderCacheLimit);
+    StyledTableModel model(10000, 50);
+    QTableView view;
+    view.setModel(&model);
+    view.setRenderCacheLimit(renderCacheLimit);
+    view.horizontalHeader()->setDefaultSectionSize(60);
+    view.resize(3000, 1600);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QScrollBar *bar = view.verticalScrollBar();
+    QBENCHMARK {
+        for (int i = 0; i < 20; ++i) {
+            bar->setValue(i);
+            view.viewport()->repaint();
+        }
+        for (int i = 20; i > 0; --i) {
+            bar->setValue(i);
+            view.viewport()->repaint();
+        }
+    }
+}
+
+QTEST_MAIN(tst_QTableView)
+#include "tst_qtableview.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qtreeview
+QT += widgets testlib
+SOURCES += tst_qtreeview.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
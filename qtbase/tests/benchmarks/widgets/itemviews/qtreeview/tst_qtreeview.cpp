@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/qabstractitemmodel.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qscrollbar.h>
+#include <QtWidgets/qtreeview.h>
+
+// A two level model with cheap indexes: topLevelRows parents with childRows leaves each.
+class TreeModel : public QAbstractItemModel
+{
+public:
+    TreeModel(int topLevelRows, int childRows)
+        : children(topLevelRows, childRows) {}
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const
+    {
+        if (row < 0 || column != 0)
+            return QModelIndex();
+        if (!parent.isValid())
+            return row < children.count() ? createIndex(row, column, quintptr(0)) : QModelIndex();
+        if (parent.internalId() != 0 || row >= children.at(parent.row()))
+            return QModelIndex();
+        return createIndex(row, column, quintptr(parent.row() + 1));
+    }
+
+    QModelIndex parent(const QModelIndex &child) const
+    {
+        if (!child.isValid() || child.internalId() == 0)
+            return QModelIndex();
+        return createIndex(int(child.internalId() - 1), 0, quintptr(0));
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        if (!parent.isValid())
+            return children.count();
+        return parent.internalId() == 0 ? children.at(parent.row()) : 0;
+    }
+
+    int columnCount(const QModelIndex & = QModelIndex()) const
+    {
+        return 1;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid() || role != Qt::DisplayRole)
+            return QVariant();
+        if (index.internalId() == 0)
+            return QString::number(index.row());
+        return QString(QString::number(index.internalId() - 1) + QLatin1Char('.') + QString::number(index.row()));
+    }
+
+    Qt::ItemFlags flags(const QModelIndex &index) const
+    {
+        Qt::ItemFlags f = QAbstractItemModel::flags(index);
+        if (index.internalId() != 0)
+            f |= Qt::ItemNeverHasChildren;
+        return f;
+    }
+
+    void insertChildren(int parentRow, int row, int count)
+    {
+        beginInsertRows(index(parentRow, 0), row, row + count - 1);
+        children[parentRow] += count;
+        endInsertRows();
+    }
+
+private:
+    QVector<int> children;
+};
+
+class tst_QTreeView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void expandAll_data();
+    void expandAll();
+    void scroll_data();
+    void scroll();
+    void insertRows_data();
+    void insertRows();
+};
+
+static void addLayoutData()
+{
+    QTest::addColumn<bool>("lazy");
+    QTest::newRow("flat") << false;
+    QTest::newRow("lazy") << true;
+}
+
+void tst_QTreeView::expandAll_data()
+{
+    addLayoutData();
+}
+
+// 1000 x 1000 rows, about one million visible rows once expanded
+void tst_QTreeView::expandAll()
+{
+    QFETCH(bool, lazy);
+    TreeModel model(1000, 1000);
+    QTreeView view;
+    view.setUniformRowHeights(true);
+    view.setLazyLayout(lazy);
+    view.setModel(&model);
+
+    QBENCHMARK {
+        view.collapseAll();
+        view.expandAll();
+    }
+}
+
+void tst_QTreeView::scroll_data()
+{
+    addLayoutData();
+}
+
+void tst_QTreeView::scroll()
+{
+    QFETCH(bool, lazy);
+    TreeModel model(1000, 1000);
+    QTreeView view;
+    view.setUniformRowHeights(true);
+    view.setLazyLayout(lazy);
+    view.setModel(&model);
+    view.resize(400, 600);
+    view.expandAll();
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QScrollBar *bar = view.verticalScrollBar();
+    const int step = bar->maximum() / 100;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            bar->setValue(i * step);
+            view.viewport()->repaint();
+        }
+    }
+}
+
+void tst_QTreeView::insertRows_data()
+{
+    addLayoutData();
+}
+
+void tst_QTreeView::insertRows()
+{
+    QFETCH(bool, lazy);
+    TreeModel model(1000, 1000);
+    QTreeView view;
+    view.setUniformRowHeights(true);
+    view.setLazyLayout(lazy);
+    view.setModel(&model);
+    view.expandAll();
+
+    int parent = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 10; ++i) {
+            model.insertChildren(parent, 0, 1);
+            QCoreApplication::processEvents(); // let the view catch up
+            parent = (parent + 1) % 1000;
+        }
+    }
+}
+
+QTEST_MAIN(tst_QTreeView)
+#include "tst_qtreeview.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qwidgetbackingstore
+QT += widgets testlib
+SOURCES += tst_qwidgetbackingstore.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtCore/qmath.h>
+#include <QtGui/qpainter.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qgridlayout.h>
+#include <QtWidgets/qwidget.h>
+
+// A live chart: an opaque widget that draws a long antialiased polyline
+// from its own data, and nothing else.
+class ChartWidget : public QWidget
+{
+public:
+    ChartWidget(int seed) : phase(seed)
+    {
+        setAttribute(Qt::WA_OpaquePaintEvent);
+        setMinimumSize(160, 120);
+    }
+
+    void advance() { ++phase; update(); }
+
+protected:
+    void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE
+    {
+        QPainter p(this);
+        p.fillRect(rect(), Qt::white);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setPen(QPen(Qt::darkBlue, 1.5));
+
+        const int count = 2000;
+        QPolygonF line(count);
+        const qreal h = height() / 2.0;
+        for (int i = 0; i < count; ++i) {
+            const qreal x = i * width() / qreal(count);
+            line[i] = QPointF(x, h + h * 0.8 * qSin((i + phase * 10) * 0.02) * qCos(i * 0.003));
+        }
+        p.drawPolyline(line);
+    }
+
+private:
+    int phase;
+};
+
+class tst_QWidgetBackingStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void updateCharts_data();
+    void updateCharts();
+};
+
+void tst_QWidgetBackingStore::updateCharts_data()
+{
+    QTest::addColumn<int>("chartCount");
+    QTest::addColumn<bool>("concurrent");
+
+    QTest::newRow("16 charts") << 16 << false;
+    QTest::newRow("16 charts, concurrent") << 16 << true;
+    QTest::newRow("64 charts") << 64 << false;
+    QTest::newRow("64 charts, concurrent") << 64 << true;
+}
+
+// Updates all charts of a dashboard and repaints the window, as a timer
+// driven live view does for each frame.
+void tst_QWidgetBackingStore::updateCharts()
+{
+    QFETCH(int, chartCount);
+    QFETCH(bool, concurrent);
+
+    QWidget window;
+    QGridLayout *layout = new QGridLayout(&window);
+    const int columns = qCeil(qSqrt(qreal(chartCount)));
+    QList<ChartWidget *> charts;
+    for (int i = 0; i < chartCount; ++i) {
+        ChartWidget *chart = new ChartWidget(i);
+        chart->setAttribute(Qt::WA_ConcurrentPaintEvent, concurrent);
+        layout->addWidget(chart, i / columns, i % columns);
+        charts << chart;
+    }
+    window.resize(columns * 170, columns * 130);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    QBENCHMARK {
+        for (int i = 0; i < charts.size(); ++i)
+            charts.at(i)->advance();
+        QApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(tst_QWidgetBackingStore)
+#include "tst_qwidgetbackingstore.moc"
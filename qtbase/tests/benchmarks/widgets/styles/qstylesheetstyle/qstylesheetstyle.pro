@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qstylesheetstyle
+QT += widgets testlib
+SOURCES += tst_qstylesheetstyle.cpp
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QtWidgets/qapplication.h>
+#include <QtWidgets/qcheckbox.h>
+#include <QtWidgets/qgroupbox.h>
+#include <QtWidgets/qlabel.h>
+#include <QtWidgets/qlineedit.h>
+#include <QtWidgets/qpushbutton.h>
+#include <QtWidgets/qboxlayout.h>
+
+class tst_QStyleSheetStyle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void createWidgets_data();
+    void createWidgets();
+};
+
+// An application style sheet as it grows in a large application: rules for
+// named widgets, for roles set as dynamic properties, for classes and for
+// widgets in particular containers.
+static QString largeStyleSheet(int ruleCount)
+{
+    static const char * const colors[] = { "red", "green", "blue", "gray", "navy", "teal" };
+    QString styleSheet;
+    for (int i = 0; i < ruleCount; ++i) {
+        const char *color = colors[i % 6];
+        switch (i % 5) {
+        case 0:
+            styleSheet += QString::fromLatin1("QPushButton#button%1 { color: %2; }\n").arg(i).arg(color);
+            break;
+        case 1:
+            styleSheet += QString::fromLatin1("QLabel[role=\"role%1\"] { color: %2; }\n").arg(i).arg(color);
+            break;
+        case 2:
+            styleSheet += QString::fromLatin1(".QLineEdit[role=\"role%1\"] { border: 1px solid %2; }\n").arg(i).arg(color);
+            break;
+        case 3:
+            styleSheet += QString::fromLatin1("QGroupBox#group%1 QCheckBox { color: %2; }\n").arg(i).arg(color);
+            break;
+        case 4:
+            styleSheet += QString::fromLatin1("*[state=\"state%1\"] { background: %2; }\n").arg(i).arg(color);
+            break;
+        }
+    }
+    return styleSheet;
+}
+
+void tst_QStyleSheetStyle::cleanup()
+{
+    qApp->setStyleSheet(QString());
+}
+
+void tst_QStyleSheetStyle::createWidgets_data()
+{
+    QTest::addColumn<int>("ruleCount");
+    QTest::addColumn<int>("groupCount");
+
+    QTest::newRow("100 rules, 10 groups") << 100 << 10;
+    QTest::newRow("100 rules, 100 groups") << 100 << 100;
+    QTest::newRow("2000 rules, 10 groups") << 2000 << 10;
+    QTest::newRow("2000 rules, 100 groups") << 2000 << 100;
+}
+
+// Creates and polishes a dialog-like tree of groups with a label, a line
+// edit, a check box and a button each, most of them alike.
+void tst_QStyleSheetStyle::createWidgets()
+{
+    QFETCH(int, ruleCount);
+    QFETCH(int, groupCount);
+
+    qApp->setStyleSheet(largeStyleSheet(ruleCount));
+
+    QBENCHMARK {
+        QWidget dialog;
+        QVBoxLayout *layout = new QVBoxLayout(&dialog);
+        for (int i = 0; i < groupCount; ++i) {
+            QGroupBox *group = new QGroupBox(&dialog);
+            group->setObjectName(QString::fromLatin1("group%1").arg(i % 20));
+            QHBoxLayout *groupLayout = new QHBoxLayout(group);
+            QLabel *label = new QLabel(QLatin1String("Label"), group);
+            label->setProperty("role", QString::fromLatin1("role%1").arg(i % 10));
+            QLineEdit *edit = new QLineEdit(group);
+            edit->setProperty("role", QString::fromLatin1("role%1").arg(i % 10));
+            QCheckBox *check = new QCheckBox(QLatin1String("Check"), group);
+            QPushButton *button = new QPushButton(QLatin1String("Button"), group);
+            button->setObjectName(QString::fromLatin1("button%1").arg(i % 20));
+            if (i % 7 == 0)
+                button->setProperty("state", QLatin1String("state4"));
+            groupLayout->addWidget(label);
+            groupLayout->addWidget(edit);
+            groupLayout->addWidget(check);
+            groupLayout->addWidget(button);
+            layout->addWidget(group);
+        }
+        dialog.ensurePolished();
+        layout->activate();
+    }
+}
+
+QTEST_MAIN(tst_QStyleSheetStyle)
+#include "tst_qstylesheetstyle.moc"
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QT_TESTS_SHARED_NETWORKBENCHMARK_H_INCLUDED
+#define QT_TESTS_SHARED_NETWORKBENCHMARK_H_INCLUDED
+
+#include <QtCore/qiodevice.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthread.h>
+#include <QtNetwork/qtcpserver.h>
+
+// Runs a server in a thread of its own, so that it does not compete with
+// the client for the event loop. The thread takes ownership of the server,
+// which must not be listening yet; it listens on the loopback interface
+// once the thread has started.
+class ServerThread : public QThread
+{
+public:
+    explicit ServerThread(QTcpServer *server)
+        : port(0), m_server(server)
+    {
+        m_server->moveToThread(this);
+    }
+
+    ~ServerThread()
+    {
+        quit();
+        wait();
+        delete m_server; // only if the thread never ran
+    }
+
+    void startServer()
+    {
+        start();
+        m_ready.acquire();
+    }
+
+    quint16 port;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        m_server->listen(QHostAddress::LocalHost);
+        port = m_server->serverPort();
+        m_ready.release();
+        exec();
+        delete m_server;
+        m_server = 0;
+    }
+
+private:
+    QTcpServer *m_server;
+    QSemaphore m_ready;
+};
+
+// Counts what arrives, without keeping it.
+class Sink : public QObject
+{
+    Q_OBJECT
+public:
+    Sink() : bytes(0), parts(0) {}
+
+    qint64 bytes;
+    int parts;
+
+public slots:
+    void readReply()
+    {
+        QIODevice *device = qobject_cast<QIODevice *>(sender());
+        char data[64 * 1024];
+        qint64 readBytes;
+        while ((readBytes = device->read(data, sizeof data)) > 0)
+            bytes += readBytes;
+    }
+
+    void startPart() { ++parts; }
+    void addPartData(const QByteArray &data) { bytes += data.size(); }
+};
+
+#endif // QT_TESTS_SHARED_NETWORKBENCHMARK_H_INCLUDED